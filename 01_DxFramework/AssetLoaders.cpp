@@ -0,0 +1,243 @@
+//**********************************************************************
+//
+// AssetLoaders.cpp
+//
+// The loaders behind every sample's LoadShader/LoadModel/LoadTexture.
+// Each goes through the asset registry (see AssetRegistry.h): a source
+// already loaded is shared, and the processed form is read from and
+// written to the shared cache.
+//
+//**********************************************************************
+
+#include "AssetLoaders.h"
+#include "AssetRegistry.h"
+#include "FileUtil.h"
+#include <stdio.h>
+#include <string.h>
+
+
+//----------------------------------------------------------------------
+// effects
+//----------------------------------------------------------------------
+
+// what a D3DX call left in errors goes to the output window if the call
+// failed; the warnings of one that succeeded are dropped
+static void ReportEffectErrors(LPD3DXBUFFER* errors, bool failed)
+{
+    if (!*errors)
+    {
+        return;
+    }
+
+    if (failed && (*errors)->GetBufferPointer())
+    {
+        OutputDebugString((const char*)(*errors)->GetBufferPointer());
+    }
+    (*errors)->Release();
+    *errors = NULL;
+}
+
+// compiled effects are kept in the shared asset cache, keyed by the
+// source contents and the compile flags.
+LPD3DXEFFECT LoadCachedEffect(LPDIRECT3DDEVICE9 device, const char* filename)
+{
+    LPD3DXEFFECT ret = NULL;
+
+    LPD3DXBUFFER pError = NULL;
+    DWORD shaderFlags = 0;
+
+#if _DEBUG
+    shaderFlags |= D3DXSHADER_DEBUG;
+#endif
+
+    AssetLoad load;
+    ret = (LPD3DXEFFECT)BeginAssetLoad(filename, ASSET_SHADER, shaderFlags, &load);
+    if (ret)
+    {
+        return ret;
+    }
+
+    char tempPath[MAX_PATH];
+    const char* opened = NULL;      // tempPath, once opened
+
+    if (IsAssetCached(&load))
+    {
+        size_t size = 0;
+        unsigned char* compiled = ReadWholeFile(load.cachePath, &size);
+        if (compiled)
+        {
+            D3DXCreateEffect(device, compiled, (UINT)size,
+                NULL, NULL, shaderFlags, NULL, &ret, NULL);
+            delete[] compiled;
+        }
+        load.fromCache = (ret != NULL);
+    }
+
+    if (!ret && GetAssetCacheTempPath(&load, tempPath, sizeof(tempPath)))
+    {
+        // compile once, keep the binary and create the effect from it
+        LPD3DXEFFECTCOMPILER pCompiler = NULL;
+        LPD3DXBUFFER pCompiled = NULL;
+
+        HRESULT hr = D3DXCreateEffectCompilerFromFile(filename, NULL, NULL, shaderFlags, &pCompiler, &pError);
+        ReportEffectErrors(&pError, FAILED(hr));
+        if (SUCCEEDED(hr))
+        {
+            hr = pCompiler->CompileEffect(shaderFlags, &pCompiled, &pError);
+            ReportEffectErrors(&pError, FAILED(hr));
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            D3DXCreateEffect(device, pCompiled->GetBufferPointer(), pCompiled->GetBufferSize(),
+                NULL, NULL, shaderFlags, NULL, &ret, &pError);
+            ReportEffectErrors(&pError, !ret);
+
+            FILE* fp = ret ? fopen(tempPath, "wb") : NULL;
+            if (fp)
+            {
+                opened = tempPath;
+                bool written = fwrite(pCompiled->GetBufferPointer(), 1, pCompiled->GetBufferSize(), fp) == pCompiled->GetBufferSize();
+                load.saved = (fclose(fp) == 0) && written;
+            }
+        }
+
+        if (pCompiled)
+        {
+            pCompiled->Release();
+        }
+
+        if (pCompiler)
+        {
+            pCompiler->Release();
+        }
+    }
+    else if (!ret)
+    {
+        D3DXCreateEffectFromFile(device, filename,
+            NULL, NULL, shaderFlags, NULL, &ret, &pError);
+        ReportEffectErrors(&pError, !ret);
+    }
+
+    EndAssetLoad(&load, ret, opened);
+
+    return ret;
+}
+
+//----------------------------------------------------------------------
+// meshes
+//----------------------------------------------------------------------
+
+// text .x files are kept in the shared asset cache as compressed binary .x
+LPD3DXMESH LoadCachedMesh(LPDIRECT3DDEVICE9 device, const char* filename)
+{
+    LPD3DXMESH ret = NULL;
+
+    AssetLoad load;
+    ret = (LPD3DXMESH)BeginAssetLoad(filename, ASSET_MODEL, 0, &load);
+    if (ret)
+    {
+        return ret;
+    }
+
+    char tempPath[MAX_PATH];
+    const char* opened = NULL;      // tempPath, once opened
+
+    if (IsAssetCached(&load) &&
+        SUCCEEDED(D3DXLoadMeshFromX(load.cachePath, D3DXMESH_SYSTEMMEM, device, NULL, NULL, NULL, NULL, &ret)))
+    {
+        load.fromCache = true;
+    }
+
+    if (!ret)
+    {
+        if (FAILED(D3DXLoadMeshFromX(filename, D3DXMESH_SYSTEMMEM, device, NULL, NULL, NULL, NULL, &ret)))
+        {
+            ret = NULL;
+        }
+        else if (GetAssetCacheTempPath(&load, tempPath, sizeof(tempPath)))
+        {
+            opened = tempPath;
+            load.saved = SUCCEEDED(D3DXSaveMeshToX(tempPath, ret, NULL, NULL, NULL, 0,
+                D3DXF_FILEFORMAT_BINARY | D3DXF_FILEFORMAT_COMPRESSED));
+        }
+    }
+
+    EndAssetLoad(&load, ret, opened);
+
+    if (!ret)
+    {
+        OutputDebugString("failed at loading a model: ");
+        OutputDebugString(filename);
+        OutputDebugString("\n");
+    }
+
+    return ret;
+}
+
+//----------------------------------------------------------------------
+// textures
+//----------------------------------------------------------------------
+
+static LPDIRECT3DTEXTURE9 ReadTexture(LPDIRECT3DDEVICE9 device, const char* filename, TextureReader reader)
+{
+    if (reader)
+    {
+        return reader(filename);
+    }
+
+    LPDIRECT3DTEXTURE9 ret = NULL;
+    if (FAILED(D3DXCreateTextureFromFile(device, filename, &ret)))
+    {
+        ret = NULL;
+    }
+    return ret;
+}
+
+// whatever the source format, the finished texture (with its mips) is
+// kept in the shared asset cache as a DDS
+LPDIRECT3DTEXTURE9 LoadCachedTexture(LPDIRECT3DDEVICE9 device, const char* filename, TextureReader reader)
+{
+    LPDIRECT3DTEXTURE9 ret = NULL;
+
+    AssetLoad load;
+    ret = (LPDIRECT3DTEXTURE9)BeginAssetLoad(filename, ASSET_TEXTURE, 0, &load);
+    if (ret)
+    {
+        return ret;
+    }
+
+    char tempPath[MAX_PATH];
+    const char* opened = NULL;      // tempPath, once opened
+
+    if (IsAssetCached(&load))
+    {
+        ret = ReadTexture(device, load.cachePath, reader);
+        load.fromCache = (ret != NULL);
+    }
+
+    if (!ret)
+    {
+        // DDSs already are in their final form
+        const char* ext = strrchr(filename, '.');
+        bool isDds = ext && _stricmp(ext, ".dds") == 0;
+
+        ret = ReadTexture(device, filename, reader);
+        if (ret && !isDds && GetAssetCacheTempPath(&load, tempPath, sizeof(tempPath)))
+        {
+            opened = tempPath;
+            load.saved = SUCCEEDED(D3DXSaveTextureToFile(tempPath, D3DXIFF_DDS, ret, NULL));
+        }
+    }
+
+    EndAssetLoad(&load, ret, opened);
+
+    if (!ret)
+    {
+        OutputDebugString("failed at loading a texture: ");
+        OutputDebugString(filename);
+        OutputDebugString("\n");
+    }
+
+    return ret;
+}
@@ -0,0 +1,36 @@
+//**********************************************************************
+//
+// AssetLoaders.h
+//
+// The loaders behind every sample's LoadShader/LoadModel/LoadTexture.
+// Each goes through the asset registry (see AssetRegistry.h): a source
+// already loaded is shared, and the processed form is read from and
+// written to the shared cache.
+//
+//   effects    compiled once, the binary kept in the cache
+//   meshes     text .x kept as compressed binary .x
+//   textures   kept with their mips as a DDS; DDS sources as they are
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <d3d9.h>
+#include <d3dx9.h>
+
+// ---------- types ------------------------------------
+
+// reads a texture file, the cached DDS or the source; NULL if it failed
+typedef LPDIRECT3DTEXTURE9 (*TextureReader)(const char* filename);
+
+// ---------------- function prototype  ------------------------
+
+// debug builds compile with D3DXSHADER_DEBUG; compile errors go to the
+// output window
+LPD3DXEFFECT LoadCachedEffect(LPDIRECT3DDEVICE9 device, const char* filename);
+
+LPD3DXMESH LoadCachedMesh(LPDIRECT3DDEVICE9 device, const char* filename);
+
+// reader NULL reads through D3DX
+LPDIRECT3DTEXTURE9 LoadCachedTexture(LPDIRECT3DDEVICE9 device, const char* filename, TextureReader reader);
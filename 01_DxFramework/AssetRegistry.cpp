@@ -0,0 +1,311 @@
+//**********************************************************************
+//
+// AssetRegistry.cpp
+//
+// Content-addressed asset registry. Assets are keyed by a hash of the
+// file contents, so the copies of Fieldstone_DM.tga, TeapotWithTangent.x
+// etc. that every sample folder carries resolve to the same entry.
+//
+//**********************************************************************
+
+#include "AssetRegistry.h"
+#include "FileUtil.h"
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+
+#define MAX_ASSETS 64
+
+// one loaded resource, shared by every load of the same content
+struct AssetEntry
+{
+    char filename[MAX_PATH];    // the file it was first loaded from
+    unsigned long long hash;
+    AssetType type;
+    IUnknown* resource;
+    size_t sourceBytes;
+    double loadMs;
+};
+
+static AssetEntry gAssets[MAX_ASSETS];
+static int gNumAssets = 0;
+
+static char gCacheDir[MAX_PATH] = "";
+
+// assets may be loaded from several threads at once
+static std::mutex gLock;
+
+// statistics
+static int gDuplicateHits = 0;
+static size_t gDuplicateBytes = 0;
+static double gDuplicateMs = 0;
+static int gCacheHits = 0;
+static double gCacheMsAvoided = 0;
+static int gMisses = 0;
+static int gReloads = 0;
+
+static const char* gCacheExtensions[ASSET_TYPE_COUNT] = { "dds", "dds", "fxo", "x" };
+
+
+//----------------------------------------------------------------------
+// hashing
+//----------------------------------------------------------------------
+
+static unsigned long long Mix(unsigned long long k)
+{
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDULL;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// 8 bytes at a time; not cryptographic, but plenty for telling a few
+// dozen asset files apart
+static unsigned long long HashBytes(const unsigned char* data, size_t size, unsigned int salt)
+{
+    unsigned long long h = 0x9E3779B97F4A7C15ULL ^ size ^ ((unsigned long long)salt << 32);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        unsigned long long word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ Mix(word)) * 0x100000001B3ULL;
+    }
+
+    unsigned long long tail = 0;
+    for (size_t j = 0; i + j < size; ++j)
+    {
+        tail |= (unsigned long long)data[i + j] << (8 * j);
+    }
+
+    return Mix(h ^ Mix(tail));
+}
+
+static double GetElapsedMs(const LARGE_INTEGER& start)
+{
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+
+    return (now.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+//----------------------------------------------------------------------
+// registry
+//----------------------------------------------------------------------
+void InitAssetRegistry()
+{
+    char dir[MAX_PATH];
+    DWORD length = GetEnvironmentVariable(ASSET_CACHE_ENV, dir, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH)
+    {
+        strcpy(dir, ASSET_CACHE_DIR);
+    }
+
+    // a read-only cache that already exists is fine; only reads will work
+    CreateDirectory(dir, NULL);
+
+    if (GetFileAttributes(dir) != INVALID_FILE_ATTRIBUTES)
+    {
+        strcpy(gCacheDir, dir);
+    }
+}
+
+IUnknown* BeginAssetLoad(const char* filename, AssetType type, unsigned int salt, AssetLoad* load)
+{
+    ZeroMemory(load, sizeof(AssetLoad));
+    strncpy(load->filename, filename, MAX_PATH - 1);
+    load->type = type;
+    QueryPerformanceCounter(&load->start);
+
+    unsigned char* data = ReadWholeFile(filename, &load->sourceBytes);
+    if (!data)
+    {
+        return NULL;
+    }
+
+    load->hash = HashBytes(data, load->sourceBytes, salt);
+    load->hashed = true;
+    delete[] data;
+
+    std::lock_guard<std::mutex> lock(gLock);
+
+    for (int i = 0; i < gNumAssets; ++i)
+    {
+        if (gAssets[i].hash == load->hash && gAssets[i].type == type)
+        {
+            ++gDuplicateHits;
+            gDuplicateBytes += gAssets[i].sourceBytes;
+            gDuplicateMs += gAssets[i].loadMs;
+
+            gAssets[i].resource->AddRef();
+            return gAssets[i].resource;
+        }
+    }
+
+    if (gCacheDir[0])
+    {
+        _snprintf(load->cachePath, MAX_PATH, "%s\\%016llx.%s", gCacheDir, load->hash, gCacheExtensions[type]);
+        load->cachePath[MAX_PATH - 1] = '\0';
+    }
+
+    return NULL;
+}
+
+bool IsAssetCached(const AssetLoad* load)
+{
+    return load->cachePath[0] && GetFileAttributes(load->cachePath) != INVALID_FILE_ATTRIBUTES;
+}
+
+bool GetAssetCacheTempPath(const AssetLoad* load, char* path, size_t size)
+{
+    if (!load->cachePath[0])
+    {
+        return false;
+    }
+
+    _snprintf(path, size, "%s.%lu.%lu.tmp", load->cachePath, GetCurrentProcessId(), GetCurrentThreadId());
+    path[size - 1] = '\0';
+
+    return true;
+}
+
+// the time it took to load an asset from source, stored next to its
+// cached copy so later cache hits can tell how much time they saved
+static double ReadSourceLoadMs(const char* cachePath)
+{
+    char path[MAX_PATH];
+    _snprintf(path, MAX_PATH, "%s.ms", cachePath);
+    path[MAX_PATH - 1] = '\0';
+
+    double ms = 0;
+    FILE* fp = fopen(path, "r");
+    if (fp)
+    {
+        if (fscanf(fp, "%lf", &ms) != 1)
+        {
+            ms = 0;
+        }
+        fclose(fp);
+    }
+
+    return ms;
+}
+
+static void WriteSourceLoadMs(const char* cachePath, double ms)
+{
+    char path[MAX_PATH];
+    _snprintf(path, MAX_PATH, "%s.ms", cachePath);
+    path[MAX_PATH - 1] = '\0';
+
+    FILE* fp = fopen(path, "w");
+    if (fp)
+    {
+        fprintf(fp, "%f\n", ms);
+        fclose(fp);
+    }
+}
+
+void EndAssetLoad(AssetLoad* load, IUnknown* resource, const char* tempPath)
+{
+    double ms = GetElapsedMs(load->start);
+
+    if (tempPath)
+    {
+        // another process may have published the same asset first
+        if (resource && load->saved && MoveFile(tempPath, load->cachePath))
+        {
+            WriteSourceLoadMs(load->cachePath, ms);
+        }
+        else
+        {
+            DeleteFile(tempPath);
+        }
+    }
+
+    if (!resource || !load->hashed)
+    {
+        return;
+    }
+
+    double sourceMs = load->fromCache ? ReadSourceLoadMs(load->cachePath) : 0;
+
+    std::lock_guard<std::mutex> lock(gLock);
+
+    if (load->fromCache)
+    {
+        ++gCacheHits;
+        gCacheMsAvoided += (sourceMs > ms) ? sourceMs - ms : 0;
+
+        // later duplicates avoid the full source load, not just the cache load
+        ms = (sourceMs > ms) ? sourceMs : ms;
+    }
+    else
+    {
+        ++gMisses;
+    }
+
+    // the file changed since it was loaded; its old content is no
+    // longer what anyone asks for, so it gives up its entry
+    AssetEntry* entry = NULL;
+    for (int i = 0; i < gNumAssets; ++i)
+    {
+        if (gAssets[i].type == load->type && _stricmp(gAssets[i].filename, load->filename) == 0)
+        {
+            entry = &gAssets[i];
+            entry->resource->Release();
+            ++gReloads;
+            break;
+        }
+    }
+
+    if (!entry && gNumAssets < MAX_ASSETS)
+    {
+        entry = &gAssets[gNumAssets++];
+    }
+
+    if (entry)
+    {
+        strcpy(entry->filename, load->filename);
+        entry->hash = load->hash;
+        entry->type = load->type;
+        entry->resource = resource;
+        entry->sourceBytes = load->sourceBytes;
+        entry->loadMs = ms;
+
+        resource->AddRef();
+    }
+}
+
+void ReportAssetStats()
+{
+    char str[256];
+
+    sprintf(str, "assets: %d unique, %d loaded from source, %d from the shared cache (%s)\n",
+        gNumAssets, gMisses, gCacheHits, gCacheDir[0] ? gCacheDir : "no cache");
+    OutputDebugString(str);
+
+    sprintf(str, "assets: %d duplicate loads shared, %u KB and %.2f ms saved\n",
+        gDuplicateHits, (unsigned int)(gDuplicateBytes / 1024), gDuplicateMs);
+    OutputDebugString(str);
+
+    sprintf(str, "assets: %.2f ms saved by the shared cache\n", gCacheMsAvoided);
+    OutputDebugString(str);
+
+    sprintf(str, "assets: %d reloaded in place\n", gReloads);
+    OutputDebugString(str);
+}
+
+void ReleaseAssetRegistry()
+{
+    for (int i = 0; i < gNumAssets; ++i)
+    {
+        gAssets[i].resource->Release();
+        gAssets[i].resource = NULL;
+    }
+
+    gNumAssets = 0;
+}
@@ -0,0 +1,84 @@
+//**********************************************************************
+//
+// AssetRegistry.h
+//
+// Content-addressed asset registry. Assets are keyed by a hash of the
+// file contents, so the copies of Fieldstone_DM.tga, TeapotWithTangent.x
+// etc. that every sample folder carries resolve to the same entry.
+//
+// - within a process, loading the same content twice returns the
+//   resource that is already loaded
+// - across samples and processes, the processed form (textures with
+//   mips, compiled effects, binary meshes) is kept in a shared cache
+//   directory and loaded from there instead of the source
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <windows.h>
+#include <stddef.h>
+
+// ---------- constants ------------------------------------
+
+// environment variable that overrides the cache directory
+#define ASSET_CACHE_ENV		"SHADERPRIMER_ASSET_CACHE"
+
+// shared by all sample folders, relative to a sample's working directory
+#define ASSET_CACHE_DIR		"..\\AssetCache"
+
+enum AssetType
+{
+    ASSET_TEXTURE = 0,
+    ASSET_CUBE_TEXTURE,
+    ASSET_SHADER,
+    ASSET_MODEL,
+    ASSET_TYPE_COUNT
+};
+
+// ---------- types ------------------------------------
+
+// state of one LoadTexture/LoadShader/LoadModel call
+struct AssetLoad
+{
+    char filename[MAX_PATH];    // the source; a reload of it replaces its entry
+    AssetType type;
+    bool hashed;                // false if the source could not be read
+    unsigned long long hash;
+    size_t sourceBytes;
+    char cachePath[MAX_PATH];   // processed copy in the shared cache, "" if there is no cache
+    bool fromCache;             // set by the caller when it loaded cachePath
+    bool saved;                 // set by the caller when it wrote all of its temp path
+    LARGE_INTEGER start;
+};
+
+// ---------------- function prototype  ------------------------
+
+// picks the cache directory. call once before loading assets.
+void InitAssetRegistry();
+
+// hashes the source file (salted with e.g. compile flags). returns an
+// already loaded resource with the same content, AddRef'ed, or NULL if
+// the caller has to load it.
+IUnknown* BeginAssetLoad(const char* filename, AssetType type, unsigned int salt, AssetLoad* load);
+
+// true if the shared cache holds a processed copy at load->cachePath
+bool IsAssetCached(const AssetLoad* load);
+
+// path the caller should write the processed copy to. it is moved into
+// place by EndAssetLoad, so readers never see a half-written file.
+bool GetAssetCacheTempPath(const AssetLoad* load, char* path, size_t size);
+
+// records the loaded resource (NULL if loading failed) and its timings.
+// tempPath, once the caller has opened it, is moved into the cache if
+// the resource loaded and load->saved is set, and deleted otherwise.
+// a resource loaded again from the same file (a hot reload) takes the
+// place of the one loaded before, which the registry releases.
+void EndAssetLoad(AssetLoad* load, IUnknown* resource, const char* tempPath);
+
+// prints dedup and cache statistics to the output window
+void ReportAssetStats();
+
+// drops the registry's references
+void ReleaseAssetRegistry();
@@ -0,0 +1,238 @@
+//**********************************************************************
+//
+// AsyncLoader.cpp
+//
+// Prioritized asynchronous asset loading. Worker threads read and
+// decode assets (file reads of all queued assets are in flight at once),
+// finished assets are handed back to the main thread between frames.
+//
+//**********************************************************************
+
+#include "AsyncLoader.h"
+#include <stdio.h>
+#include <string.h>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// one queued asset
+struct AsyncJob
+{
+    char filename[MAX_PATH];
+    char fallback[MAX_PATH];
+    AsyncLoadFunction load;
+    AsyncLoadPriority priority;
+    unsigned int order;
+    AsyncLoadCallback callback;
+    void* userData;
+
+    IUnknown* resource;
+    const char* loadedFrom;
+    LARGE_INTEGER queued;
+    LARGE_INTEGER started;
+    LARGE_INTEGER finished;
+};
+
+// highest priority first, then queue order
+struct AsyncJobOrder
+{
+    bool operator()(const AsyncJob* a, const AsyncJob* b) const
+    {
+        if (a->priority != b->priority)
+        {
+            return a->priority < b->priority;
+        }
+        return a->order > b->order;
+    }
+};
+
+static std::vector<std::thread> gWorkers;
+static std::mutex gLock;
+static std::condition_variable gWorkAvailable;
+static std::condition_variable gWorkFinished;
+
+static std::priority_queue<AsyncJob*, std::vector<AsyncJob*>, AsyncJobOrder> gQueued;
+static std::vector<AsyncJob*> gFinished;
+static int gNumPending = 0;             // queued + loading + finished but not delivered
+static unsigned int gNextOrder = 0;
+static bool gQuit = false;
+
+
+static double GetMs(const LARGE_INTEGER& from, const LARGE_INTEGER& to)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    return (to.QuadPart - from.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+static void WorkerMain()
+{
+    for (;;)
+    {
+        AsyncJob* job = NULL;
+        {
+            std::unique_lock<std::mutex> lock(gLock);
+            while (!gQuit && gQueued.empty())
+            {
+                gWorkAvailable.wait(lock);
+            }
+
+            if (gQuit)
+            {
+                return;
+            }
+
+            job = gQueued.top();
+            gQueued.pop();
+        }
+
+        QueryPerformanceCounter(&job->started);
+
+        job->loadedFrom = job->filename;
+        job->resource = job->load(job->filename);
+
+        if (!job->resource && job->fallback[0])
+        {
+            job->loadedFrom = job->fallback;
+            job->resource = job->load(job->fallback);
+        }
+
+        QueryPerformanceCounter(&job->finished);
+
+        {
+            std::lock_guard<std::mutex> lock(gLock);
+            gFinished.push_back(job);
+        }
+        gWorkFinished.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------
+// loader
+//----------------------------------------------------------------------
+void InitAsyncLoader(int numThreads)
+{
+    gQuit = false;
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        gWorkers.push_back(std::thread(WorkerMain));
+    }
+}
+
+void LoadAsync(const char* filename, const char* fallback, AsyncLoadFunction load,
+    AsyncLoadPriority priority, AsyncLoadCallback callback, void* userData)
+{
+    AsyncJob* job = new AsyncJob;
+    ZeroMemory(job, sizeof(AsyncJob));
+
+    strncpy(job->filename, filename, MAX_PATH - 1);
+    if (fallback)
+    {
+        strncpy(job->fallback, fallback, MAX_PATH - 1);
+    }
+    job->load = load;
+    job->priority = priority;
+    job->callback = callback;
+    job->userData = userData;
+    QueryPerformanceCounter(&job->queued);
+
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+        job->order = gNextOrder++;
+        gQueued.push(job);
+        ++gNumPending;
+    }
+    gWorkAvailable.notify_one();
+}
+
+// callbacks run without the lock held so they are free to queue more work
+static int DeliverFinished(std::vector<AsyncJob*>& finished)
+{
+    for (size_t i = 0; i < finished.size(); ++i)
+    {
+        AsyncJob* job = finished[i];
+
+        char str[MAX_PATH + 128];
+        sprintf(str, "async: %s %s in %.2f ms (queued %.2f ms)\n",
+            job->loadedFrom, job->resource ? "loaded" : "failed",
+            GetMs(job->started, job->finished), GetMs(job->queued, job->started));
+        OutputDebugString(str);
+
+        job->callback(job->loadedFrom, job->resource, job->userData);
+        delete job;
+    }
+
+    std::lock_guard<std::mutex> lock(gLock);
+    gNumPending -= (int)finished.size();
+    return gNumPending;
+}
+
+int PumpAsyncLoads()
+{
+    std::vector<AsyncJob*> finished;
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+        finished.swap(gFinished);
+    }
+
+    return DeliverFinished(finished);
+}
+
+void WaitForAsyncLoads()
+{
+    for (;;)
+    {
+        std::vector<AsyncJob*> finished;
+        {
+            std::unique_lock<std::mutex> lock(gLock);
+            while (gFinished.empty() && gNumPending > 0)
+            {
+                gWorkFinished.wait(lock);
+            }
+            finished.swap(gFinished);
+        }
+
+        if (DeliverFinished(finished) == 0)
+        {
+            return;
+        }
+    }
+}
+
+void ReleaseAsyncLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+        gQuit = true;
+
+        while (!gQueued.empty())
+        {
+            delete gQueued.top();
+            gQueued.pop();
+        }
+    }
+    gWorkAvailable.notify_all();
+
+    for (size_t i = 0; i < gWorkers.size(); ++i)
+    {
+        gWorkers[i].join();
+    }
+    gWorkers.clear();
+
+    // loaded, but nobody is going to pick them up
+    for (size_t i = 0; i < gFinished.size(); ++i)
+    {
+        if (gFinished[i]->resource)
+        {
+            gFinished[i]->resource->Release();
+        }
+        delete gFinished[i];
+    }
+    gFinished.clear();
+
+    gNumPending = 0;
+}
@@ -0,0 +1,55 @@
+//**********************************************************************
+//
+// AsyncLoader.h
+//
+// Prioritized asynchronous asset loading. Worker threads read and
+// decode assets (file reads of all queued assets are in flight at once),
+// finished assets are handed back to the main thread between frames.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <windows.h>
+
+// ---------- constants ------------------------------------
+
+#define ASYNC_LOADER_THREADS	4
+
+// higher priorities are picked up first, equal ones in queue order
+enum AsyncLoadPriority
+{
+    ASYNC_PRIORITY_LOW = 0,
+    ASYNC_PRIORITY_NORMAL,
+    ASYNC_PRIORITY_HIGH
+};
+
+// ---------- types ------------------------------------
+
+// loads one asset; runs on a worker thread
+typedef IUnknown* (*AsyncLoadFunction)(const char* filename);
+
+// called on the main thread from PumpAsyncLoads. resource is NULL if
+// loading failed; otherwise the callback owns the reference.
+typedef void (*AsyncLoadCallback)(const char* filename, IUnknown* resource, void* userData);
+
+// ---------------- function prototype  ------------------------
+
+// starts the worker threads. the D3D device has to be created with
+// D3DCREATE_MULTITHREADED.
+void InitAsyncLoader(int numThreads);
+
+// queues an asset. fallback (may be NULL) is tried if filename fails.
+void LoadAsync(const char* filename, const char* fallback, AsyncLoadFunction load,
+    AsyncLoadPriority priority, AsyncLoadCallback callback, void* userData);
+
+// delivers finished assets to their callbacks. returns the number of
+// assets still queued or loading.
+int PumpAsyncLoads();
+
+// blocks until every queued asset is delivered
+void WaitForAsyncLoads();
+
+// drops queued assets, waits for the ones in flight and stops the workers
+void ReleaseAsyncLoader();
@@ -0,0 +1,91 @@
+//**********************************************************************
+//
+// CpuFeatures.cpp
+//
+// Runtime detection of the SIMD instruction sets the loaders use.
+//
+//**********************************************************************
+
+#include "CpuFeatures.h"
+
+#if CPU_X86_SIMD
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#define CPU_FEATURE_SSSE3	0x1
+#define CPU_FEATURE_AVX2	0x2
+
+#if CPU_X86_SIMD
+
+static void CpuId(int leaf, int subLeaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex((int*)regs, leaf, subLeaf);
+#else
+    __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long ReadXcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+#endif // CPU_X86_SIMD
+
+static int GetCpuFeatures()
+{
+    static int features = -1;
+
+    if (features < 0)
+    {
+        int detected = 0;
+
+#if CPU_X86_SIMD
+        unsigned int regs[4];
+        CpuId(0, 0, regs);
+        unsigned int maxLeaf = regs[0];
+
+        CpuId(1, 0, regs);
+        bool osxsave = (regs[2] & (1 << 27)) != 0;
+        if (regs[2] & (1 << 9))
+        {
+            detected |= CPU_FEATURE_SSSE3;
+        }
+
+        // AVX2 also needs the OS to save the YMM registers
+        if (maxLeaf >= 7 && osxsave && (ReadXcr0() & 0x6) == 0x6)
+        {
+            CpuId(7, 0, regs);
+            if (regs[1] & (1 << 5))
+            {
+                detected |= CPU_FEATURE_AVX2;
+            }
+        }
+#endif
+
+        features = detected;
+    }
+
+    return features;
+}
+
+bool CpuHasSsse3()
+{
+    return (GetCpuFeatures() & CPU_FEATURE_SSSE3) != 0;
+}
+
+bool CpuHasAvx2()
+{
+    return (GetCpuFeatures() & CPU_FEATURE_AVX2) != 0;
+}
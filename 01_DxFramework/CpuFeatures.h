@@ -0,0 +1,27 @@
+//**********************************************************************
+//
+// CpuFeatures.h
+//
+// Runtime detection of the SIMD instruction sets the loaders use.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CPU_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define CPU_TARGET(isa)
+#else
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define CPU_X86_SIMD 0
+#define CPU_TARGET(isa)
+#endif
+
+// ---------------- function prototype  ------------------------
+bool CpuHasSsse3();
+bool CpuHasAvx2();
@@ -0,0 +1,189 @@
+//**********************************************************************
+//
+// CpuProfiler.cpp
+//
+// Scoped CPU timers. Every thread records into its own ring buffer;
+// the buffers can be written out as a Chrome trace (chrome://tracing).
+//
+//**********************************************************************
+
+#include "CpuProfiler.h"
+#include <windows.h>
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILER_THREAD_LOCAL __thread
+#endif
+
+struct ProfileEvent
+{
+    const char* name;
+    unsigned long long start;
+    unsigned long long end;
+};
+
+// written only by its own thread
+struct ProfileBuffer
+{
+    DWORD threadId;
+    std::atomic<unsigned int> count;    // total recorded, the ring index is count % size
+    ProfileEvent events[PROFILER_EVENTS_PER_THREAD];
+};
+
+bool gCpuProfilerEnabled = false;
+
+static PROFILER_THREAD_LOCAL ProfileBuffer* tBuffer = NULL;
+static std::vector<ProfileBuffer*> gBuffers;
+static std::mutex gLock;
+
+static DWORD gMainThreadId = 0;
+
+// trace start, on both clocks, to convert cycles to microseconds
+static unsigned long long gTraceStartTicks = 0;
+static LARGE_INTEGER gTraceStartTime;
+
+
+//----------------------------------------------------------------------
+// recording
+//----------------------------------------------------------------------
+void InitCpuProfiler()
+{
+    gMainThreadId = GetCurrentThreadId();
+    gTraceStartTicks = __rdtsc();
+    QueryPerformanceCounter(&gTraceStartTime);
+}
+
+void SetCpuProfilerEnabled(bool enabled)
+{
+    if (enabled && !gCpuProfilerEnabled)
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+
+        // a scope still open from the last capture may end after this and
+        // bump its thread's count back up; its event starts before the
+        // trace does, and the export leaves it out
+        for (size_t i = 0; i < gBuffers.size(); ++i)
+        {
+            gBuffers[i]->count.store(0, std::memory_order_relaxed);
+        }
+
+        gTraceStartTicks = __rdtsc();
+        QueryPerformanceCounter(&gTraceStartTime);
+    }
+
+    gCpuProfilerEnabled = enabled;
+}
+
+bool IsCpuProfilerEnabled()
+{
+    return gCpuProfilerEnabled;
+}
+
+void RecordCpuProfileEvent(const char* name, unsigned long long start, unsigned long long end)
+{
+    ProfileBuffer* buffer = tBuffer;
+    if (!buffer)
+    {
+        buffer = new ProfileBuffer;
+        buffer->threadId = GetCurrentThreadId();
+        buffer->count = 0;
+
+        std::lock_guard<std::mutex> lock(gLock);
+        gBuffers.push_back(buffer);
+        tBuffer = buffer;
+    }
+
+    unsigned int index = buffer->count.load(std::memory_order_relaxed);
+
+    ProfileEvent& event = buffer->events[index % PROFILER_EVENTS_PER_THREAD];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------
+// chrome trace export
+//----------------------------------------------------------------------
+
+// the TSC rate is measured over the whole trace, so there is no
+// calibration wait at startup
+static double GetTicksPerMicrosecond()
+{
+    unsigned long long ticks = __rdtsc();
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+
+    double us = (now.QuadPart - gTraceStartTime.QuadPart) * 1000000.0 / frequency.QuadPart;
+    return (us > 0) ? (ticks - gTraceStartTicks) / us : 1.0;
+}
+
+bool WriteChromeTrace(const char* filename)
+{
+    FILE* fp = fopen(filename, "w");
+    if (!fp)
+    {
+        return false;
+    }
+
+    double ticksPerUs = GetTicksPerMicrosecond();
+    bool first = true;
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+
+    std::lock_guard<std::mutex> lock(gLock);
+
+    for (size_t i = 0; i < gBuffers.size(); ++i)
+    {
+        ProfileBuffer* buffer = gBuffers[i];
+
+        fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", buffer->threadId, (buffer->threadId == gMainThreadId) ? "main" : "worker");
+        first = false;
+
+        unsigned int count = buffer->count.load(std::memory_order_acquire);
+        unsigned int begin = (count > PROFILER_EVENTS_PER_THREAD) ? count - PROFILER_EVENTS_PER_THREAD : 0;
+
+        for (unsigned int j = begin; j < count; ++j)
+        {
+            const ProfileEvent& event = buffer->events[j % PROFILER_EVENTS_PER_THREAD];
+            if (event.start < gTraceStartTicks)
+            {
+                continue;
+            }
+
+            fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+                event.name, buffer->threadId,
+                (double)(long long)(event.start - gTraceStartTicks) / ticksPerUs,
+                (double)(event.end - event.start) / ticksPerUs);
+        }
+    }
+
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    return true;
+}
+
+void ReleaseCpuProfiler()
+{
+    gCpuProfilerEnabled = false;
+
+    std::lock_guard<std::mutex> lock(gLock);
+
+    for (size_t i = 0; i < gBuffers.size(); ++i)
+    {
+        delete gBuffers[i];
+    }
+    gBuffers.clear();
+
+    // only this thread's pointer can be reset; the others have exited
+    tBuffer = NULL;
+}
@@ -0,0 +1,80 @@
+//**********************************************************************
+//
+// CpuProfiler.h
+//
+// Scoped CPU timers. Every thread records into its own ring buffer;
+// the buffers can be written out as a Chrome trace (chrome://tracing).
+//
+//**********************************************************************
+
+
+#pragma once
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// ---------- constants ------------------------------------
+
+// set to 0 to compile every PROFILE_SCOPE out
+#define ENABLE_CPU_PROFILER			1
+
+// the oldest events are overwritten once a thread records more
+#define PROFILER_EVENTS_PER_THREAD	16384
+
+// ---------------- function prototype  ------------------------
+
+// remembers the start of the trace. call before anything is recorded.
+void InitCpuProfiler();
+
+// recording is off until enabled. enabling it begins a new capture:
+// the events recorded before are dropped and the trace starts over.
+void SetCpuProfilerEnabled(bool enabled);
+bool IsCpuProfilerEnabled();
+
+// writes the recorded events of every thread as Chrome trace_event JSON
+bool WriteChromeTrace(const char* filename);
+
+// frees the per-thread buffers. no thread may be recording.
+void ReleaseCpuProfiler();
+
+void RecordCpuProfileEvent(const char* name, unsigned long long start, unsigned long long end);
+
+// ---------- scoped timer ------------------------------------
+
+extern bool gCpuProfilerEnabled;
+
+// times the enclosing scope. name has to be a string literal. while
+// recording is off this costs a load and a branch.
+class CpuProfileScope
+{
+public:
+    CpuProfileScope(const char* name)
+    {
+        mName = gCpuProfilerEnabled ? name : NULL;
+        mStart = mName ? __rdtsc() : 0;
+    }
+
+    ~CpuProfileScope()
+    {
+        if (mName)
+        {
+            RecordCpuProfileEvent(mName, mStart, __rdtsc());
+        }
+    }
+
+private:
+    const char* mName;
+    unsigned long long mStart;
+};
+
+#define PROFILE_SCOPE_NAME(line) profileScope##line
+#define PROFILE_SCOPE_LINE(name, line) CpuProfileScope PROFILE_SCOPE_NAME(line)(name)
+
+#if ENABLE_CPU_PROFILER
+#define PROFILE_SCOPE(name) PROFILE_SCOPE_LINE(name, __LINE__)
+#else
+#define PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,561 @@
+//**********************************************************************
+//
+// DdsLoader.cpp
+//
+// Native DDS container reader (2D textures and cube maps with mips)
+// and BC1-BC5 block decoders for CPU-side sampling.
+//
+//**********************************************************************
+
+#include "DdsLoader.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include <string.h>
+#include <mutex>
+
+#define DDS_MAGIC				0x20534444	// "DDS "
+#define DDS_HEADER_SIZE			128			// magic + DDS_HEADER
+
+#define DDSD_MIPMAPCOUNT		0x20000
+#define DDPF_ALPHAPIXELS		0x1
+#define DDPF_FOURCC				0x4
+#define DDPF_RGB				0x40
+#define DDSCAPS2_CUBEMAP		0x200
+#define DDSCAPS2_CUBEMAP_ALL	0xFC00
+
+// block rows per job when a surface is decoded on all cores
+#define DDS_DECODE_GRAIN_ROWS	16
+
+#define DDS_FOURCC(a, b, c, d) \
+    ((unsigned int)(a) | ((unsigned int)(b) << 8) | ((unsigned int)(c) << 16) | ((unsigned int)(d) << 24))
+
+
+static unsigned int ReadU32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+//----------------------------------------------------------------------
+// container
+//----------------------------------------------------------------------
+bool ReadDdsHeader(const unsigned char* file, size_t fileSize, DdsInfo* info)
+{
+    if (!file || fileSize < DDS_HEADER_SIZE || ReadU32(file) != DDS_MAGIC)
+    {
+        return false;
+    }
+
+    unsigned int flags = ReadU32(file + 8);
+    unsigned int pfFlags = ReadU32(file + 80);
+    unsigned int fourCC = ReadU32(file + 84);
+    unsigned int bitCount = ReadU32(file + 88);
+    unsigned int caps2 = ReadU32(file + 112);
+
+    DdsFormat format = DDS_FORMAT_UNKNOWN;
+
+    if (pfFlags & DDPF_FOURCC)
+    {
+        if (fourCC == DDS_FOURCC('D', 'X', 'T', '1'))
+        {
+            format = DDS_FORMAT_BC1;
+        }
+        else if (fourCC == DDS_FOURCC('D', 'X', 'T', '2') || fourCC == DDS_FOURCC('D', 'X', 'T', '3'))
+        {
+            format = DDS_FORMAT_BC2;
+        }
+        else if (fourCC == DDS_FOURCC('D', 'X', 'T', '4') || fourCC == DDS_FOURCC('D', 'X', 'T', '5'))
+        {
+            format = DDS_FORMAT_BC3;
+        }
+        else if (fourCC == DDS_FOURCC('A', 'T', 'I', '1') || fourCC == DDS_FOURCC('B', 'C', '4', 'U'))
+        {
+            format = DDS_FORMAT_BC4;
+        }
+        else if (fourCC == DDS_FOURCC('A', 'T', 'I', '2') || fourCC == DDS_FOURCC('B', 'C', '5', 'U'))
+        {
+            format = DDS_FORMAT_BC5;
+        }
+    }
+    else if ((pfFlags & DDPF_RGB) && bitCount == 32 &&
+        ReadU32(file + 92) == 0x00FF0000 && ReadU32(file + 96) == 0x0000FF00 && ReadU32(file + 100) == 0x000000FF)
+    {
+        bool hasAlpha = (pfFlags & DDPF_ALPHAPIXELS) && ReadU32(file + 104) == 0xFF000000;
+        format = hasAlpha ? DDS_FORMAT_BGRA8 : DDS_FORMAT_BGRX8;
+    }
+
+    if (format == DDS_FORMAT_UNKNOWN)
+    {
+        return false;
+    }
+
+    // partial cube maps are not supported
+    bool isCubeMap = (caps2 & DDSCAPS2_CUBEMAP) != 0;
+    if (isCubeMap && (caps2 & DDSCAPS2_CUBEMAP_ALL) != DDSCAPS2_CUBEMAP_ALL)
+    {
+        return false;
+    }
+
+    int mipCount = (flags & DDSD_MIPMAPCOUNT) ? (int)ReadU32(file + 28) : 1;
+
+    info->height = (int)ReadU32(file + 12);
+    info->width = (int)ReadU32(file + 16);
+    info->mipCount = (mipCount > 0) ? mipCount : 1;
+    info->faceCount = isCubeMap ? 6 : 1;
+    info->isCubeMap = isCubeMap;
+    info->format = format;
+    info->dataOffset = DDS_HEADER_SIZE;
+
+    return info->width > 0 && info->height > 0 && info->mipCount <= DDS_MAX_MIPS;
+}
+
+bool IsBlockCompressed(DdsFormat format)
+{
+    return format >= DDS_FORMAT_BC1 && format <= DDS_FORMAT_BC5;
+}
+
+// bytes per 4x4 block, or per pixel for uncompressed formats
+int GetBlockSize(DdsFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_BC1:
+    case DDS_FORMAT_BC4:
+        return 8;
+    case DDS_FORMAT_BC2:
+    case DDS_FORMAT_BC3:
+    case DDS_FORMAT_BC5:
+        return 16;
+    case DDS_FORMAT_BGRA8:
+    case DDS_FORMAT_BGRX8:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static void GetSurfaceLayout(const DdsInfo& info, int mip, DdsSurface* surface)
+{
+    int width = info.width >> mip;
+    int height = info.height >> mip;
+    surface->width = (width > 0) ? width : 1;
+    surface->height = (height > 0) ? height : 1;
+
+    if (IsBlockCompressed(info.format))
+    {
+        surface->blocksWide = (surface->width + 3) / 4;
+        surface->blocksHigh = (surface->height + 3) / 4;
+    }
+    else
+    {
+        surface->blocksWide = surface->width;
+        surface->blocksHigh = surface->height;
+    }
+
+    surface->rowPitch = surface->blocksWide * GetBlockSize(info.format);
+    surface->size = (size_t)surface->rowPitch * surface->blocksHigh;
+}
+
+bool GetDdsSurface(const unsigned char* file, size_t fileSize, const DdsInfo& info,
+    int face, int mip, DdsSurface* surface)
+{
+    if (face < 0 || face >= info.faceCount || mip < 0 || mip >= info.mipCount)
+    {
+        return false;
+    }
+
+    // faces are stored one after another, each with its full mip chain
+    size_t faceSize = 0;
+    size_t mipOffset = 0;
+    for (int i = 0; i < info.mipCount; ++i)
+    {
+        GetSurfaceLayout(info, i, surface);
+        if (i < mip)
+        {
+            mipOffset += surface->size;
+        }
+        faceSize += surface->size;
+    }
+
+    GetSurfaceLayout(info, mip, surface);
+
+    size_t offset = info.dataOffset + faceSize * face + mipOffset;
+    if (offset + surface->size > fileSize)
+    {
+        return false;
+    }
+
+    surface->data = file + offset;
+
+    return true;
+}
+
+//----------------------------------------------------------------------
+// block decoding
+//----------------------------------------------------------------------
+
+// 565 -> 888, replicating the high bits into the low ones
+static void Unpack565(unsigned int c, unsigned int* r, unsigned int* g, unsigned int* b)
+{
+    unsigned int r5 = (c >> 11) & 0x1F;
+    unsigned int g6 = (c >> 5) & 0x3F;
+    unsigned int b5 = c & 0x1F;
+
+    *r = (r5 << 3) | (r5 >> 2);
+    *g = (g6 << 2) | (g6 >> 4);
+    *b = (b5 << 3) | (b5 >> 2);
+}
+
+static unsigned int PackBgra(unsigned int r, unsigned int g, unsigned int b, unsigned int a)
+{
+    return b | (g << 8) | (r << 16) | (a << 24);
+}
+
+// four BGRA colors of an 8-byte color block. BC1 blocks with c0 <= c1
+// use the 3-color mode with transparent black as the fourth entry;
+// BC2/BC3 color blocks are always 4-color. alpha is 0xFF for BC1 and 0
+// for BC2/BC3 so the explicit alpha can be OR'ed in.
+static void BuildColorPalette(const unsigned char* block, bool isBc1, unsigned int palette[4])
+{
+    unsigned int c0 = block[0] | (block[1] << 8);
+    unsigned int c1 = block[2] | (block[3] << 8);
+
+    unsigned int r0, g0, b0, r1, g1, b1;
+    Unpack565(c0, &r0, &g0, &b0);
+    Unpack565(c1, &r1, &g1, &b1);
+
+    unsigned int a = isBc1 ? 0xFF : 0;
+
+    palette[0] = PackBgra(r0, g0, b0, a);
+    palette[1] = PackBgra(r1, g1, b1, a);
+
+    if (!isBc1 || c0 > c1)
+    {
+        palette[2] = PackBgra((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, a);
+        palette[3] = PackBgra((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, a);
+    }
+    else
+    {
+        palette[2] = PackBgra((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, a);
+        palette[3] = 0;
+    }
+}
+
+// eight values of a BC3 alpha / BC4 / BC5 channel block
+static void BuildAlphaPalette(const unsigned char* block, unsigned char palette[8])
+{
+    unsigned int a0 = block[0];
+    unsigned int a1 = block[1];
+
+    palette[0] = (unsigned char)a0;
+    palette[1] = (unsigned char)a1;
+
+    if (a0 > a1)
+    {
+        for (unsigned int i = 1; i < 7; ++i)
+        {
+            palette[i + 1] = (unsigned char)(((7 - i) * a0 + i * a1) / 7);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 1; i < 5; ++i)
+        {
+            palette[i + 1] = (unsigned char)(((5 - i) * a0 + i * a1) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// 3-bit indices of a BC3 alpha / BC4 / BC5 channel block, one byte per pixel
+static void UnpackAlphaIndices(const unsigned char* block, unsigned char indices[16])
+{
+    for (int half = 0; half < 2; ++half)
+    {
+        const unsigned char* p = block + 2 + half * 3;
+        unsigned int bits = p[0] | (p[1] << 8) | (p[2] << 16);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            indices[half * 8 + i] = (unsigned char)((bits >> (3 * i)) & 0x7);
+        }
+    }
+}
+
+// 16 values of a single-channel block
+static void DecodeChannelBlock(const unsigned char* block, unsigned char values[16])
+{
+    unsigned char palette[8];
+    unsigned char indices[16];
+    BuildAlphaPalette(block, palette);
+    UnpackAlphaIndices(block, indices);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        values[i] = palette[indices[i]];
+    }
+}
+
+// BC4 fills red, BC5 red and green from its second block
+static void DecodeChannelBlockScalar(DdsFormat format, const unsigned char* block,
+    unsigned char* dest, int destPitch)
+{
+    unsigned char red[16];
+    unsigned char green[16];
+    DecodeChannelBlock(block, red);
+
+    if (format == DDS_FORMAT_BC5)
+    {
+        DecodeChannelBlock(block + 8, green);
+    }
+    else
+    {
+        memset(green, 0, sizeof(green));
+    }
+
+    for (int y = 0; y < 4; ++y)
+    {
+        unsigned int* row = (unsigned int*)(dest + y * destPitch);
+        for (int x = 0; x < 4; ++x)
+        {
+            row[x] = PackBgra(red[y * 4 + x], green[y * 4 + x], 0, 0xFF);
+        }
+    }
+}
+
+static void DecodeBlockScalar(DdsFormat format, const unsigned char* block,
+    unsigned char* dest, int destPitch)
+{
+    if (format == DDS_FORMAT_BC4 || format == DDS_FORMAT_BC5)
+    {
+        DecodeChannelBlockScalar(format, block, dest, destPitch);
+        return;
+    }
+
+    const unsigned char* colorBlock = (format == DDS_FORMAT_BC1) ? block : block + 8;
+
+    unsigned int colors[4];
+    BuildColorPalette(colorBlock, format == DDS_FORMAT_BC1, colors);
+
+    unsigned char alphas[16];
+    if (format == DDS_FORMAT_BC2)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            alphas[i * 2] = (unsigned char)((block[i] & 0x0F) * 17);
+            alphas[i * 2 + 1] = (unsigned char)((block[i] >> 4) * 17);
+        }
+    }
+    else if (format == DDS_FORMAT_BC3)
+    {
+        DecodeChannelBlock(block, alphas);
+    }
+
+    for (int y = 0; y < 4; ++y)
+    {
+        unsigned int* row = (unsigned int*)(dest + y * destPitch);
+        unsigned int bits = colorBlock[4 + y];
+
+        for (int x = 0; x < 4; ++x)
+        {
+            unsigned int color = colors[(bits >> (2 * x)) & 0x3];
+            if (format != DDS_FORMAT_BC1)
+            {
+                color |= (unsigned int)alphas[y * 4 + x] << 24;
+            }
+            row[x] = color;
+        }
+    }
+}
+
+#if CPU_X86_SIMD
+
+// pshufb masks that turn one byte of 2-bit color indices (one block row)
+// into 4 BGRA pixels picked from a 16-byte palette
+static unsigned char gColorRowMasks[256][16];
+
+// pshufb masks that move alpha bytes 4*row .. 4*row+3 into the alpha
+// channel of 4 pixels
+static unsigned char gAlphaRowMasks[4][16];
+
+// built by the first decode; DecodeBlockRow is called from the job
+// system's workers and the async loader's threads at once
+static std::once_flag gBlockMasksBuilt;
+
+static void BuildBlockMasks()
+{
+    for (int v = 0; v < 256; ++v)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            int index = (v >> (2 * x)) & 0x3;
+            for (int c = 0; c < 4; ++c)
+            {
+                gColorRowMasks[v][x * 4 + c] = (unsigned char)(index * 4 + c);
+            }
+        }
+    }
+
+    for (int y = 0; y < 4; ++y)
+    {
+        memset(gAlphaRowMasks[y], 0x80, 16);
+        for (int x = 0; x < 4; ++x)
+        {
+            gAlphaRowMasks[y][x * 4 + 3] = (unsigned char)(y * 4 + x);
+        }
+    }
+}
+
+// each block row is one pshufb of the palette; explicit alpha (BC2) is
+// widened from nibbles to bytes with SIMD math and interpolated alpha
+// (BC3) is looked up with a second pshufb, then OR'ed into place.
+CPU_TARGET("ssse3")
+static void DecodeBlockRowSsse3(DdsFormat format, const unsigned char* blocks, int numBlocks,
+    unsigned char* dest, int destPitch)
+{
+    const int blockSize = GetBlockSize(format);
+    const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        const unsigned char* block = blocks + i * blockSize;
+        const unsigned char* colorBlock = (format == DDS_FORMAT_BC1) ? block : block + 8;
+        unsigned char* out = dest + i * 16;
+
+        unsigned int colors[4];
+        BuildColorPalette(colorBlock, format == DDS_FORMAT_BC1, colors);
+        __m128i palette = _mm_loadu_si128((const __m128i*)colors);
+
+        __m128i alphas = _mm_setzero_si128();
+        if (format == DDS_FORMAT_BC2)
+        {
+            __m128i packed = _mm_loadl_epi64((const __m128i*)block);
+            __m128i lo = _mm_and_si128(packed, lowNibbles);
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), lowNibbles);
+            alphas = _mm_unpacklo_epi8(lo, hi);
+            alphas = _mm_or_si128(alphas, _mm_slli_epi16(alphas, 4));
+        }
+        else if (format == DDS_FORMAT_BC3)
+        {
+            unsigned char alphaPalette[16];
+            unsigned char indices[16];
+            BuildAlphaPalette(block, alphaPalette);
+            UnpackAlphaIndices(block, indices);
+
+            alphas = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)alphaPalette),
+                _mm_loadu_si128((const __m128i*)indices));
+        }
+
+        for (int y = 0; y < 4; ++y)
+        {
+            __m128i row = _mm_shuffle_epi8(palette, _mm_loadu_si128((const __m128i*)gColorRowMasks[colorBlock[4 + y]]));
+            if (format != DDS_FORMAT_BC1)
+            {
+                row = _mm_or_si128(row, _mm_shuffle_epi8(alphas, _mm_loadu_si128((const __m128i*)gAlphaRowMasks[y])));
+            }
+            _mm_storeu_si128((__m128i*)(out + y * destPitch), row);
+        }
+    }
+}
+
+#endif // CPU_X86_SIMD
+
+void DecodeBlockRow(DdsFormat format, const unsigned char* blocks, int numBlocks,
+    unsigned char* dest, int destPitch, bool useSimd)
+{
+    if (!IsBlockCompressed(format))
+    {
+        return;
+    }
+
+#if CPU_X86_SIMD
+    if (useSimd && format <= DDS_FORMAT_BC3 && CpuHasSsse3())
+    {
+        std::call_once(gBlockMasksBuilt, BuildBlockMasks);
+        DecodeBlockRowSsse3(format, blocks, numBlocks, dest, destPitch);
+        return;
+    }
+#endif
+
+    const int blockSize = GetBlockSize(format);
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        DecodeBlockScalar(format, blocks + i * blockSize, dest + i * 16, destPitch);
+    }
+}
+
+struct DecodeRowsJob
+{
+    DdsFormat format;
+    const DdsSurface* surface;
+    unsigned char* dest;
+    int destPitch;
+    bool useSimd;
+};
+
+static void DecodeBlockRows(void* data, int begin, int end)
+{
+    DecodeRowsJob* job = (DecodeRowsJob*)data;
+
+    for (int by = begin; by < end; ++by)
+    {
+        DecodeBlockRow(job->format, job->surface->data + by * job->surface->rowPitch, job->surface->blocksWide,
+            job->dest + by * 4 * job->destPitch, job->destPitch, job->useSimd);
+    }
+}
+
+bool DecodeDdsSurface(DdsFormat format, const DdsSurface& surface,
+    unsigned char* dest, int destPitch, bool useSimd)
+{
+    if (!surface.data || destPitch < surface.width * 4)
+    {
+        return false;
+    }
+
+    if (!IsBlockCompressed(format))
+    {
+        for (int y = 0; y < surface.height; ++y)
+        {
+            unsigned char* row = dest + y * destPitch;
+            memcpy(row, surface.data + y * surface.rowPitch, surface.width * 4);
+
+            if (format == DDS_FORMAT_BGRX8)
+            {
+                for (int x = 0; x < surface.width; ++x)
+                {
+                    row[x * 4 + 3] = 0xFF;
+                }
+            }
+        }
+        return true;
+    }
+
+    // whole blocks go straight to dest, split across the job system
+    if ((surface.width % 4) == 0 && (surface.height % 4) == 0)
+    {
+        DecodeRowsJob job = { format, &surface, dest, destPitch, useSimd };
+        ParallelFor(0, surface.blocksHigh, DDS_DECODE_GRAIN_ROWS, DecodeBlockRows, &job);
+        return true;
+    }
+
+    // only surfaces whose size is not a multiple of 4 (the smallest mips)
+    // need a scratch row
+    int scratchPitch = surface.blocksWide * 16;
+    unsigned char* scratch = new unsigned char[scratchPitch * 4];
+
+    for (int by = 0; by < surface.blocksHigh; ++by)
+    {
+        const unsigned char* blocks = surface.data + by * surface.rowPitch;
+
+        DecodeBlockRow(format, blocks, surface.blocksWide, scratch, scratchPitch, useSimd);
+
+        for (int y = 0; y < 4 && by * 4 + y < surface.height; ++y)
+        {
+            memcpy(dest + (by * 4 + y) * destPitch, scratch + y * scratchPitch, surface.width * 4);
+        }
+    }
+
+    delete[] scratch;
+
+    return true;
+}
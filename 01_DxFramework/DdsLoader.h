@@ -0,0 +1,76 @@
+//**********************************************************************
+//
+// DdsLoader.h
+//
+// Native DDS container reader (2D textures and cube maps with mips)
+// and BC1-BC5 block decoders for CPU-side sampling.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <stddef.h>
+
+// ---------- constants ------------------------------------
+#define DDS_MAX_FACES	6
+#define DDS_MAX_MIPS	16
+
+enum DdsFormat
+{
+    DDS_FORMAT_UNKNOWN = 0,
+    DDS_FORMAT_BC1,         // DXT1
+    DDS_FORMAT_BC2,         // DXT2/DXT3
+    DDS_FORMAT_BC3,         // DXT4/DXT5
+    DDS_FORMAT_BC4,         // ATI1, single channel
+    DDS_FORMAT_BC5,         // ATI2, two channels
+    DDS_FORMAT_BGRA8,       // A8R8G8B8
+    DDS_FORMAT_BGRX8        // X8R8G8B8
+};
+
+// ---------- types ------------------------------------
+struct DdsInfo
+{
+    int width;
+    int height;
+    int mipCount;
+    int faceCount;          // 6 for cube maps, 1 otherwise
+    bool isCubeMap;
+    DdsFormat format;
+    size_t dataOffset;      // offset of face 0, mip 0 from the start of the file
+};
+
+// one mip level of one face, pointing into the file buffer
+struct DdsSurface
+{
+    int width;
+    int height;
+    int blocksWide;         // 4x4 blocks per row (pixels per row if uncompressed)
+    int blocksHigh;         // rows of blocks (pixel rows if uncompressed)
+    int rowPitch;           // bytes per row of blocks
+    const unsigned char* data;
+    size_t size;
+};
+
+// ---------------- function prototype  ------------------------
+
+// parses the 128-byte header. fails on formats this reader cannot handle.
+bool ReadDdsHeader(const unsigned char* file, size_t fileSize, DdsInfo* info);
+
+// locates the given face/mip inside the file. the blocks are left as-is.
+bool GetDdsSurface(const unsigned char* file, size_t fileSize, const DdsInfo& info,
+    int face, int mip, DdsSurface* surface);
+
+bool IsBlockCompressed(DdsFormat format);
+int GetBlockSize(DdsFormat format);
+
+// decodes one row of numBlocks 4x4 blocks into 4 rows of 32-bit BGRA
+// pixels, destPitch bytes apart. useSimd picks the SSSE3 path if the
+// CPU has it (BC1-BC3 only). like the hardware, BC4 decodes to (r, 0, 0, 1)
+// and BC5 to (r, g, 0, 1).
+void DecodeBlockRow(DdsFormat format, const unsigned char* blocks, int numBlocks,
+    unsigned char* dest, int destPitch, bool useSimd = true);
+
+// decodes a whole surface into 32-bit BGRA rows, destPitch bytes apart
+bool DecodeDdsSurface(DdsFormat format, const DdsSurface& surface,
+    unsigned char* dest, int destPitch, bool useSimd = true);
@@ -0,0 +1,308 @@
+//**********************************************************************
+//
+// DrawQueue.cpp
+//
+// Sorted draw submission. The sort key, from the highest bits down:
+//
+//   layer 4 | effect 10 | textures 16 | mesh 10 | depth 24
+//
+// Effects and meshes are numbered in the order they are first added,
+// the textures of an item are hashed, and the depth is the top of the
+// float's bits, which order like the value for positive floats. Keys
+// are sorted with eight 8-bit counting passes, skipping the passes
+// where every key has the same byte.
+//
+//**********************************************************************
+
+#include "DrawQueue.h"
+#include <string.h>
+#include <vector>
+
+#define EFFECT_BITS     10
+#define TEXTURE_BITS    16
+#define MESH_BITS       10
+#define DEPTH_BITS      24
+
+struct SortEntry
+{
+    unsigned long long key;
+    int index;
+};
+
+static std::vector<DrawItem> gItems;
+static std::vector<SortEntry> gOrder;
+static std::vector<SortEntry> gScratch;
+
+// ids of the effects and meshes in this frame's items
+static std::vector<const void*> gEffects;
+static std::vector<const void*> gMeshes;
+
+
+//----------------------------------------------------------------------
+// keys
+//----------------------------------------------------------------------
+
+// index of pointer in ids, added if new; the last id is shared by
+// everything beyond the key's capacity
+static unsigned long long GetId(std::vector<const void*>& ids, const void* pointer, int bits)
+{
+    for (size_t i = ids.size(); i > 0; --i)
+    {
+        if (ids[i - 1] == pointer)
+        {
+            return i - 1;
+        }
+    }
+
+    unsigned long long maxId = (1ull << bits) - 1;
+    if (ids.size() > maxId)
+    {
+        return maxId;
+    }
+
+    ids.push_back(pointer);
+    return ids.size() - 1;
+}
+
+static unsigned long long HashTextures(const DrawItem& item)
+{
+    // FNV-1a over the pointers; equal sets get equal keys, which is all
+    // the grouping needs
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < DRAW_QUEUE_MAX_TEXTURES; ++i)
+    {
+        size_t pointer = (size_t)item.textures[i];
+        for (size_t b = 0; b < sizeof(pointer); ++b)
+        {
+            hash = (hash ^ ((pointer >> (b * 8)) & 0xFF)) * 16777619u;
+        }
+    }
+
+    return (hash ^ (hash >> TEXTURE_BITS)) & ((1u << TEXTURE_BITS) - 1);
+}
+
+static unsigned long long DepthBits(float depth)
+{
+    if (!(depth > 0.0f))
+    {
+        return 0;
+    }
+
+    unsigned int bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return bits >> (32 - DEPTH_BITS);
+}
+
+static unsigned long long MakeKey(const DrawItem& item)
+{
+    unsigned long long layer = (unsigned long long)(item.layer & 0xF);
+    unsigned long long key = layer;
+    key = (key << EFFECT_BITS) | GetId(gEffects, item.effect, EFFECT_BITS);
+    key = (key << TEXTURE_BITS) | HashTextures(item);
+    key = (key << MESH_BITS) | GetId(gMeshes, item.mesh, MESH_BITS);
+    key = (key << DEPTH_BITS) | DepthBits(item.depth);
+    return key;
+}
+
+//----------------------------------------------------------------------
+// submission
+//----------------------------------------------------------------------
+
+static bool SameTexture(const DrawItem& a, const DrawItem& b, int slot)
+{
+    return a.textures[slot] == b.textures[slot] && a.textureNames[slot] == b.textureNames[slot];
+}
+
+// walks the items in order; with draw false only counts
+static DrawQueueStats Issue(bool draw)
+{
+    DrawQueueStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    const DrawItem* lastMesh = NULL;
+    size_t begin = 0;
+    while (begin < gOrder.size())
+    {
+        // the run of items sharing an effect
+        LPD3DXEFFECT effect = gItems[gOrder[begin].index].effect;
+        size_t end = begin + 1;
+        while (end < gOrder.size() && gItems[gOrder[end].index].effect == effect)
+        {
+            ++end;
+        }
+
+        UINT numPasses = 1;
+        if (draw)
+        {
+            effect->Begin(&numPasses, 0);
+        }
+        ++stats.effectChanges;
+
+        for (UINT pass = 0; pass < numPasses; ++pass)
+        {
+            if (draw)
+            {
+                effect->BeginPass(pass);
+            }
+            ++stats.passChanges;
+
+            const DrawItem* previous = NULL;
+            for (size_t i = begin; i < end; ++i)
+            {
+                const DrawItem& item = gItems[gOrder[i].index];
+                bool changed = false;
+
+                for (int t = 0; t < DRAW_QUEUE_MAX_TEXTURES; ++t)
+                {
+                    if (item.textureNames[t] && (!previous || !SameTexture(item, *previous, t)))
+                    {
+                        if (draw)
+                        {
+                            effect->SetTexture(item.textureNames[t], item.textures[t]);
+                        }
+                        ++stats.textureChanges;
+                        changed = true;
+                    }
+                }
+
+                if (item.setup)
+                {
+                    if (draw)
+                    {
+                        item.setup(effect, item.data);
+                    }
+                    changed = true;
+                }
+
+                // parameters set inside a pass only reach the device this way
+                if (changed)
+                {
+                    if (draw)
+                    {
+                        effect->CommitChanges();
+                    }
+                    ++stats.commits;
+                }
+
+                if (!lastMesh || lastMesh->mesh != item.mesh)
+                {
+                    ++stats.meshChanges;
+                }
+                lastMesh = &item;
+
+                if (draw)
+                {
+                    item.mesh->DrawSubset(item.subset);
+                }
+                ++stats.draws;
+
+                previous = &item;
+            }
+
+            if (draw)
+            {
+                effect->EndPass();
+            }
+        }
+
+        if (draw)
+        {
+            effect->End();
+        }
+
+        begin = end;
+    }
+
+    return stats;
+}
+
+//----------------------------------------------------------------------
+// interface
+//----------------------------------------------------------------------
+void ClearDrawQueue()
+{
+    gItems.clear();
+    gOrder.clear();
+    gEffects.clear();
+    gMeshes.clear();
+}
+
+void AddDrawItem(const DrawItem& item)
+{
+    SortEntry entry;
+    entry.key = MakeKey(item);
+    entry.index = (int)gItems.size();
+
+    gItems.push_back(item);
+    gOrder.push_back(entry);
+}
+
+int GetDrawQueueSize()
+{
+    return (int)gItems.size();
+}
+
+void SortDrawQueue()
+{
+    size_t count = gOrder.size();
+    gScratch.resize(count);
+
+    SortEntry* from = count ? &gOrder[0] : NULL;
+    SortEntry* to = count ? &gScratch[0] : NULL;
+
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t offsets[256];
+        memset(offsets, 0, sizeof(offsets));
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++offsets[(from[i].key >> shift) & 0xFF];
+        }
+
+        // all in one bucket; this byte does not change the order
+        if (count == 0 || offsets[(from[0].key >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        size_t total = 0;
+        for (int b = 0; b < 256; ++b)
+        {
+            size_t bucket = offsets[b];
+            offsets[b] = total;
+            total += bucket;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            to[offsets[(from[i].key >> shift) & 0xFF]++] = from[i];
+        }
+
+        SortEntry* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (count && from != &gOrder[0])
+    {
+        memcpy(&gOrder[0], from, count * sizeof(SortEntry));
+    }
+}
+
+DrawQueueStats SubmitDrawQueue()
+{
+    return Issue(true);
+}
+
+DrawQueueStats CountDrawQueueChanges()
+{
+    return Issue(false);
+}
+
+void ReleaseDrawQueue()
+{
+    ClearDrawQueue();
+    std::vector<DrawItem>().swap(gItems);
+    std::vector<SortEntry>().swap(gOrder);
+    std::vector<SortEntry>().swap(gScratch);
+}
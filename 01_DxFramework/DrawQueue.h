@@ -0,0 +1,73 @@
+//**********************************************************************
+//
+// DrawQueue.h
+//
+// Sorted draw submission. Instead of beginning an effect and setting
+// its textures for every mesh, a pass adds draw items to the queue;
+// each gets a 64-bit key made of its layer, effect, textures, mesh and
+// depth, the queue radix-sorts the keys, and submitting then only
+// begins an effect or sets a texture when it differs from the item
+// before.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <d3d9.h>
+#include <d3dx9.h>
+
+// ---------- constants ------------------------------------
+
+#define DRAW_QUEUE_MAX_TEXTURES     4
+
+// ---------- types ------------------------------------
+
+// sets what differs per item (world matrix, colour, ...) on effect;
+// CommitChanges is called afterwards
+typedef void (*DrawItemFunction)(LPD3DXEFFECT effect, const void* data);
+
+struct DrawItem
+{
+    int layer;                  // drawn in increasing order, 0 to 15
+    LPD3DXEFFECT effect;
+    const char* textureNames[DRAW_QUEUE_MAX_TEXTURES];      // NULL for unused slots
+    LPDIRECT3DBASETEXTURE9 textures[DRAW_QUEUE_MAX_TEXTURES];
+    LPD3DXMESH mesh;
+    DWORD subset;
+    float depth;                // view-space; nearer items are drawn first
+    DrawItemFunction setup;     // may be NULL
+    const void* data;           // has to stay valid until submitted
+};
+
+// calls the device would get for the items in their current order
+struct DrawQueueStats
+{
+    int draws;
+    int effectChanges;          // Begin/End pairs
+    int passChanges;            // BeginPass/EndPass pairs
+    int textureChanges;         // SetTexture calls
+    int meshChanges;
+    int commits;
+};
+
+// ---------------- function prototype  ------------------------
+
+void ClearDrawQueue();
+
+void AddDrawItem(const DrawItem& item);
+
+int GetDrawQueueSize();
+
+// orders the items by key
+void SortDrawQueue();
+
+// draws the items in their current order
+DrawQueueStats SubmitDrawQueue();
+
+// what SubmitDrawQueue would issue, without touching the device;
+// effects are counted as having one pass
+DrawQueueStats CountDrawQueueChanges();
+
+// frees the queue's memory
+void ReleaseDrawQueue();
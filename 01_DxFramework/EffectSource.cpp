@@ -0,0 +1,1335 @@
+//**********************************************************************
+//
+// EffectSource.cpp
+//
+// A tokenizer and recursive descent parser for the HLSL of the samples'
+// effects. Expressions are parsed straight into graph nodes; a variable
+// read returns the node last assigned to it, so the graph of a function
+// is built in one pass over its statements.
+//
+// Instruction estimates count one per arithmetic operator and
+// vector-matrix column, a few for the longer intrinsics; they are for
+// comparing shaders, not exact.
+//
+//**********************************************************************
+
+#include "EffectSource.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//----------------------------------------------------------------------
+// tokens
+//----------------------------------------------------------------------
+
+// nesting of macros expanding to macros before giving up
+#define MAX_MACRO_DEPTH 16
+
+// an #if, #ifdef or #ifndef block around the text being read
+struct Condition
+{
+    bool active;                // the current branch is read
+    bool taken;                 // one of the block's branches was
+};
+
+// object-like #defines and #if blocks; function-like macros and
+// #include are not understood and are skipped
+struct Preprocessor
+{
+    std::map<std::string, std::string> macros;
+    std::vector<Condition> conditions;
+};
+
+static void Tokenize(const std::string& source, std::vector<Token>& tokens, Preprocessor* preprocessor);
+
+static bool IsActive(const Preprocessor* preprocessor)
+{
+    return !preprocessor || preprocessor->conditions.empty() || preprocessor->conditions.back().active;
+}
+
+// token, or what it expands to as a macro, which keeps its offset
+static void AddToken(const Token& token, std::vector<Token>& tokens, const Preprocessor* preprocessor, int depth)
+{
+    std::map<std::string, std::string>::const_iterator macro;
+    if (!preprocessor || !token.identifier || depth > MAX_MACRO_DEPTH ||
+        (macro = preprocessor->macros.find(token.text)) == preprocessor->macros.end())
+    {
+        tokens.push_back(token);
+        return;
+    }
+
+    std::vector<Token> expansion;
+    Tokenize(macro->second, expansion, NULL);
+    for (size_t i = 0; i < expansion.size(); ++i)
+    {
+        expansion[i].offset = token.offset;
+        AddToken(expansion[i], tokens, preprocessor, depth + 1);
+    }
+}
+
+// the integer expression of an #if or #elif
+struct Expression
+{
+    const Preprocessor* preprocessor;
+    std::vector<Token> tokens;
+    size_t at;
+    int depth;
+};
+
+static long EvaluateBinary(Expression& expression, int level);
+
+static long EvaluateExpression(const Preprocessor* preprocessor, const std::string& text, int depth)
+{
+    Expression expression = { preprocessor, std::vector<Token>(), 0, depth };
+    Tokenize(text, expression.tokens, NULL);
+    return (depth > MAX_MACRO_DEPTH) ? 0 : EvaluateBinary(expression, 0);
+}
+
+static long EvaluateUnary(Expression& expression)
+{
+    const std::vector<Token>& tokens = expression.tokens;
+    if (expression.at >= tokens.size())
+    {
+        return 0;
+    }
+
+    const Token& token = tokens[expression.at++];
+    if (token.text == "!" || token.text == "-" || token.text == "+")
+    {
+        long value = EvaluateUnary(expression);
+        return (token.text == "!") ? !value : (token.text == "-") ? -value : value;
+    }
+    if (token.text == "(")
+    {
+        long value = EvaluateBinary(expression, 0);
+        expression.at += (expression.at < tokens.size() && tokens[expression.at].text == ")") ? 1 : 0;
+        return value;
+    }
+    if (token.text == "defined")
+    {
+        bool parenthesized = expression.at < tokens.size() && tokens[expression.at].text == "(";
+        expression.at += parenthesized ? 1 : 0;
+        std::string name = (expression.at < tokens.size()) ? tokens[expression.at++].text : "";
+        expression.at += (parenthesized && expression.at < tokens.size()) ? 1 : 0;
+        return expression.preprocessor->macros.count(name) ? 1 : 0;
+    }
+    if (token.identifier)
+    {
+        // an undefined name is 0, as in C
+        std::map<std::string, std::string>::const_iterator macro = expression.preprocessor->macros.find(token.text);
+        return (macro == expression.preprocessor->macros.end()) ? 0 :
+            EvaluateExpression(expression.preprocessor, macro->second, expression.depth + 1);
+    }
+    return strtol(token.text.c_str(), NULL, 0);
+}
+
+// lowest precedence first
+static const char* gPreprocessorOperators[][4] =
+{
+    { "||" },
+    { "&&" },
+    { "==", "!=" },
+    { "<", ">", "<=", ">=" },
+    { "+", "-" },
+    { "*", "/", "%" }
+};
+
+#define NUM_OPERATOR_LEVELS (sizeof(gPreprocessorOperators) / sizeof(gPreprocessorOperators[0]))
+
+static long EvaluateBinary(Expression& expression, int level)
+{
+    if (level == NUM_OPERATOR_LEVELS)
+    {
+        return EvaluateUnary(expression);
+    }
+
+    long value = EvaluateBinary(expression, level + 1);
+    while (expression.at < expression.tokens.size())
+    {
+        const std::string op = expression.tokens[expression.at].text;
+        bool found = false;
+        for (int o = 0; o < 4 && gPreprocessorOperators[level][o]; ++o)
+        {
+            found = found || op == gPreprocessorOperators[level][o];
+        }
+        if (!found)
+        {
+            break;
+        }
+
+        ++expression.at;
+        long right = EvaluateBinary(expression, level + 1);
+        value = (op == "||") ? (value || right) : (op == "&&") ? (value && right) :
+            (op == "==") ? (value == right) : (op == "!=") ? (value != right) :
+            (op == "<") ? (value < right) : (op == ">") ? (value > right) :
+            (op == "<=") ? (value <= right) : (op == ">=") ? (value >= right) :
+            (op == "+") ? value + right : (op == "-") ? value - right :
+            (op == "*") ? value * right : (right == 0) ? 0 : (op == "/") ? value / right : value % right;
+    }
+    return value;
+}
+
+// line is what follows the '#'
+static void RunDirective(Preprocessor* preprocessor, const std::string& line)
+{
+    std::vector<Token> words;
+    Tokenize(line, words, NULL);
+    if (words.empty())
+    {
+        return;
+    }
+
+    const std::string& directive = words[0].text;
+    std::string name = (words.size() > 1) ? words[1].text : "";
+    std::vector<Condition>& conditions = preprocessor->conditions;
+    bool active = IsActive(preprocessor);
+    bool enclosing = conditions.size() < 2 || conditions[conditions.size() - 2].active;
+
+    if (directive == "ifdef" || directive == "ifndef" || directive == "if")
+    {
+        bool value = (directive == "if") ? EvaluateExpression(preprocessor, line.substr(words[0].offset + directive.size()), 0) != 0 :
+            (preprocessor->macros.count(name) != 0) == (directive == "ifdef");
+        Condition condition = { active && value, value };
+        conditions.push_back(condition);
+    }
+    else if (directive == "elif" && !conditions.empty())
+    {
+        bool value = !conditions.back().taken && EvaluateExpression(preprocessor, line.substr(words[0].offset + directive.size()), 0) != 0;
+        conditions.back().active = enclosing && value;
+        conditions.back().taken = conditions.back().taken || value;
+    }
+    else if (directive == "else" && !conditions.empty())
+    {
+        conditions.back().active = enclosing && !conditions.back().taken;
+        conditions.back().taken = true;
+    }
+    else if (directive == "endif" && !conditions.empty())
+    {
+        conditions.pop_back();
+    }
+    else if (directive == "define" && active && words.size() > 1 && words[1].identifier)
+    {
+        size_t value = words[1].offset + name.size();
+        if (value >= line.size() || line[value] != '(')
+        {
+            preprocessor->macros[name] = line.substr(value);
+        }
+    }
+    else if (directive == "undef" && active)
+    {
+        preprocessor->macros.erase(name);
+    }
+}
+
+static void Tokenize(const std::string& source, std::vector<Token>& tokens, Preprocessor* preprocessor)
+{
+    static const char* operators[] =
+    {
+        "==", "!=", "<=", ">=", "&&", "||", "+=", "-=", "*=", "/=", "++", "--"
+    };
+
+    size_t i = 0;
+    while (i < source.size())
+    {
+        char c = source[i];
+        Token token;
+        token.identifier = false;
+        token.offset = i;
+
+        if (isspace((unsigned char)c))
+        {
+            ++i;
+            continue;
+        }
+        else if (c == '/' && i + 1 < source.size() && source[i + 1] == '/')
+        {
+            i = source.find('\n', i);
+            i = (i == std::string::npos) ? source.size() : i;
+            continue;
+        }
+        else if (c == '/' && i + 1 < source.size() && source[i + 1] == '*')
+        {
+            i = source.find("*/", i + 2);
+            i = (i == std::string::npos) ? source.size() : i + 2;
+            continue;
+        }
+        else if (c == '#')
+        {
+            size_t end = source.find('\n', i);
+            end = (end == std::string::npos) ? source.size() : end;
+            if (preprocessor)
+            {
+                RunDirective(preprocessor, source.substr(i + 1, end - i - 1));
+            }
+            i = end;
+            continue;
+        }
+        else if (c == '"')
+        {
+            size_t end = i + 1;
+            while (end < source.size() && source[end] != '"')
+            {
+                end += (source[end] == '\\') ? 2 : 1;
+            }
+            token.text = source.substr(i, end + 1 - i);
+        }
+        else if (isalpha((unsigned char)c) || c == '_')
+        {
+            size_t end = i;
+            while (end < source.size() && (isalnum((unsigned char)source[end]) || source[end] == '_'))
+            {
+                ++end;
+            }
+            token.text = source.substr(i, end - i);
+            token.identifier = true;
+        }
+        else if (isdigit((unsigned char)c) || (c == '.' && i + 1 < source.size() && isdigit((unsigned char)source[i + 1])))
+        {
+            size_t end = i;
+            while (end < source.size() && (isalnum((unsigned char)source[end]) || source[end] == '.'))
+            {
+                ++end;
+            }
+            token.text = source.substr(i, end - i);
+        }
+        else
+        {
+            token.text = std::string(1, c);
+            for (size_t o = 0; o < sizeof(operators) / sizeof(operators[0]); ++o)
+            {
+                if (source.compare(i, 2, operators[o]) == 0)
+                {
+                    token.text = operators[o];
+                    break;
+                }
+            }
+        }
+
+        if (IsActive(preprocessor))
+        {
+            AddToken(token, tokens, preprocessor, 0);
+        }
+        i += token.text.size();
+    }
+}
+
+size_t SkipBalanced(const std::vector<Token>& tokens, size_t at, const char* open, const char* close)
+{
+    int depth = 0;
+    for (; at < tokens.size(); ++at)
+    {
+        if (tokens[at].text == open)
+        {
+            ++depth;
+        }
+        else if (tokens[at].text == close && --depth == 0)
+        {
+            return at + 1;
+        }
+    }
+    return at;
+}
+
+size_t FindStatementEnd(const std::vector<Token>& tokens, size_t at, size_t end)
+{
+    int depth = 0;
+    for (; at < end; ++at)
+    {
+        const std::string& text = tokens[at].text;
+        depth += (text == "(" || text == "[") ? 1 : (text == ")" || text == "]") ? -1 : 0;
+        if (depth == 0 && text == ";")
+        {
+            return at;
+        }
+    }
+    return end;
+}
+
+//----------------------------------------------------------------------
+// types
+//----------------------------------------------------------------------
+
+bool ParseType(const std::string& name, Type* type)
+{
+    static const char* scalars[] = { "float", "half", "int", "bool", "double", "uint" };
+
+    for (size_t s = 0; s < sizeof(scalars) / sizeof(scalars[0]); ++s)
+    {
+        size_t length = strlen(scalars[s]);
+        if (name.compare(0, length, scalars[s]) != 0)
+        {
+            continue;
+        }
+
+        std::string rest = name.substr(length);
+        if (rest.empty())
+        {
+            type->rows = 1;
+            type->columns = 1;
+            return true;
+        }
+        if (rest.size() == 1 && rest[0] >= '1' && rest[0] <= '4')
+        {
+            type->rows = 1;
+            type->columns = rest[0] - '0';
+            return true;
+        }
+        if (rest.size() == 3 && rest[1] == 'x')
+        {
+            type->rows = rest[0] - '0';
+            type->columns = rest[2] - '0';
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------
+// expressions
+//----------------------------------------------------------------------
+
+static Node* NewNode(EffectSource& effect, NodeKind kind, const std::string& text)
+{
+    Node* node = new Node;
+    node->kind = kind;
+    node->text = text;
+    node->type.rows = 1;
+    node->type.columns = 4;
+    node->uniform = (kind == NODE_UNIFORM || kind == NODE_LITERAL);
+    node->cost = 0;
+    effect.nodes.push_back(node);
+    return node;
+}
+
+static bool IsTextureFunction(const std::string& name)
+{
+    return name.compare(0, 3, "tex") == 0;
+}
+
+static bool IsUniformChildren(const Node* node)
+{
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+        if (!node->children[i]->uniform)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Node* MakeOpaque(EffectSource& effect, const std::vector<Node*>& children, const Type& type)
+{
+    Node* node = NewNode(effect, NODE_OPAQUE, "?");
+    node->children = children;
+    node->type = type;
+    node->uniform = IsUniformChildren(node);
+    return node;
+}
+
+static int CallCost(const std::string& name, const std::vector<Node*>& arguments)
+{
+    if (name == "mul" && arguments.size() == 2)
+    {
+        const Type& a = arguments[0]->type;
+        const Type& b = arguments[1]->type;
+        if (a.rows == 1 && a.columns == 1)
+        {
+            return 1;
+        }
+        if (a.rows == 1)
+        {
+            return b.columns;               // vector times matrix, one per column
+        }
+        if (b.rows == 1)
+        {
+            return a.rows;                  // matrix times vector, one per row
+        }
+        return a.rows * b.columns;
+    }
+
+    if (name == "normalize" || name == "reflect" || name == "pow" || name == "lerp")
+    {
+        return 3;
+    }
+    if (name == "length" || name == "distance" || name == "cross")
+    {
+        return 2;
+    }
+    if (name == "sin" || name == "cos" || name == "tan")
+    {
+        return 8;
+    }
+    if (name == "transpose" || name == "saturate" || name == "abs")
+    {
+        return 0;                           // free: register swizzles and modifiers
+    }
+    return 1;
+}
+
+static Type CallType(const std::string& name, const std::vector<Node*>& arguments)
+{
+    Type type = { 1, 4 };
+    if (arguments.empty())
+    {
+        return type;
+    }
+
+    type = arguments[0]->type;
+    if (name == "mul" && arguments.size() == 2)
+    {
+        const Type& a = arguments[0]->type;
+        const Type& b = arguments[1]->type;
+        if (a.rows == 1 && a.columns == 1)
+        {
+            type = b;
+        }
+        else if (a.rows == 1)
+        {
+            type.rows = 1;
+            type.columns = b.columns;
+        }
+        else if (b.rows == 1)
+        {
+            type.rows = 1;
+            type.columns = a.rows;
+        }
+        else
+        {
+            type.rows = a.rows;
+            type.columns = b.columns;
+        }
+    }
+    else if (name == "dot" || name == "length" || name == "distance")
+    {
+        type.rows = 1;
+        type.columns = 1;
+    }
+    else if (name == "transpose")
+    {
+        type.rows = arguments[0]->type.columns;
+        type.columns = arguments[0]->type.rows;
+    }
+    else if (IsTextureFunction(name))
+    {
+        type.rows = 1;
+        type.columns = 4;
+    }
+
+    return type;
+}
+
+// a recursive descent parser over the tokens of one expression; reads
+// variables from the values the statements before it assigned
+struct Parser
+{
+    EffectSource* effect;
+    ShaderGraph* graph;
+    size_t at;
+    size_t end;
+
+    bool Is(const char* text) const
+    {
+        return at < end && effect->tokens[at].text == text;
+    }
+
+    const Token& Next()
+    {
+        return effect->tokens[at++];
+    }
+
+    Node* Primary();
+    Node* Postfix();
+    Node* Unary();
+    Node* Binary(int level);
+    Node* Expression() { return Binary(0); }
+};
+
+Node* Parser::Primary()
+{
+    if (at >= end)
+    {
+        return NewNode(*effect, NODE_OPAQUE, "?");
+    }
+
+    const std::vector<Token>& tokens = effect->tokens;
+    const Token& token = Next();
+
+    if (token.text == "(")
+    {
+        // a cast, or an expression in parentheses
+        Type castType;
+        if (at + 1 < end && tokens[at].identifier && ParseType(tokens[at].text, &castType) &&
+            tokens[at + 1].text == ")")
+        {
+            std::string typeName = Next().text;
+            Next();
+            Node* node = NewNode(*effect, NODE_CAST, typeName);
+            node->children.push_back(Unary());
+            node->type = castType;
+            node->uniform = IsUniformChildren(node);
+            return node;
+        }
+
+        Node* inner = Expression();
+        if (Is(")"))
+        {
+            Next();
+        }
+        return inner;
+    }
+
+    if (!token.identifier)
+    {
+        Node* node = NewNode(*effect, NODE_LITERAL, token.text);
+        node->type.rows = 1;
+        node->type.columns = 1;
+        return node;
+    }
+
+    if (Is("("))
+    {
+        // a call or a constructor
+        Next();
+        std::vector<Node*> arguments;
+        while (at < end && !Is(")"))
+        {
+            arguments.push_back(Expression());
+            if (Is(","))
+            {
+                Next();
+            }
+            else if (!Is(")"))
+            {
+                break;
+            }
+        }
+        if (Is(")"))
+        {
+            Next();
+        }
+
+        Type type;
+        bool construct = ParseType(token.text, &type);
+        Node* node = NewNode(*effect, construct ? NODE_CONSTRUCT : NODE_CALL, token.text);
+        node->children = arguments;
+        node->type = construct ? type : CallType(token.text, arguments);
+        node->uniform = IsUniformChildren(node) && !IsTextureFunction(token.text);
+        node->cost = construct ? 0 : CallCost(token.text, arguments);
+        return node;
+    }
+
+    if (graph->values.count(token.text))
+    {
+        return graph->values[token.text];
+    }
+
+    if (graph->inputs.count(token.text))
+    {
+        Node* node = NewNode(*effect, NODE_INPUT, token.text);
+        node->uniform = false;
+        return node;
+    }
+
+    const Global* global = FindEffectGlobal(*effect, token.text);
+    if (global)
+    {
+        Node* node = NewNode(*effect, NODE_UNIFORM, token.text);
+        node->type = global->type;
+        return node;
+    }
+
+    if (graph->locals.count(token.text))
+    {
+        // declared but never assigned
+        Node* node = NewNode(*effect, NODE_OPAQUE, token.text);
+        node->type = graph->locals[token.text];
+        node->uniform = false;
+        return node;
+    }
+
+    // true, false and the like
+    return NewNode(*effect, NODE_LITERAL, token.text);
+}
+
+Node* Parser::Postfix()
+{
+    Node* node = Primary();
+
+    while (at < end)
+    {
+        if (Is(".") && at + 1 < end)
+        {
+            Next();
+            std::string member = Next().text;
+
+            // Input.mPosition reads a value assigned as a whole
+            std::string path = (node->kind == NODE_INPUT || node->kind == NODE_OPAQUE) ? node->text + "." + member : "";
+            if (!path.empty() && graph->values.count(path))
+            {
+                node = graph->values[path];
+                continue;
+            }
+
+            Node* access = NewNode(*effect, NODE_MEMBER, member);
+            access->children.push_back(node);
+            access->uniform = node->uniform;
+            access->type.rows = 1;
+            access->type.columns = (member.size() <= 4) ? (int)member.size() : 4;
+            if (node->kind == NODE_INPUT)
+            {
+                access->kind = NODE_INPUT;
+                access->text = path;
+                access->children.clear();
+                access->type.columns = 4;
+            }
+            node = access;
+        }
+        else if (Is("["))
+        {
+            Next();
+            Node* index = Expression();
+            if (Is("]"))
+            {
+                Next();
+            }
+            Node* access = NewNode(*effect, NODE_INDEX, "[]");
+            access->children.push_back(node);
+            access->children.push_back(index);
+            access->uniform = IsUniformChildren(access);
+            access->type.rows = 1;
+            access->type.columns = node->type.columns;
+            node = access;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return node;
+}
+
+Node* Parser::Unary()
+{
+    if (Is("-") || Is("!") || Is("+"))
+    {
+        std::string op = Next().text;
+        Node* operand = Unary();
+        if (op == "+")
+        {
+            return operand;
+        }
+
+        Node* node = NewNode(*effect, NODE_UNARY, op);
+        node->children.push_back(operand);
+        node->type = operand->type;
+        node->uniform = operand->uniform;
+        node->cost = (op == "-") ? 0 : 1;     // negation is a source modifier
+        return node;
+    }
+
+    return Postfix();
+}
+
+static int Precedence(const std::string& op)
+{
+    if (op == "||") return 1;
+    if (op == "&&") return 2;
+    if (op == "==" || op == "!=") return 3;
+    if (op == "<" || op == ">" || op == "<=" || op == ">=") return 4;
+    if (op == "+" || op == "-") return 5;
+    if (op == "*" || op == "/" || op == "%") return 6;
+    return 0;
+}
+
+Node* Parser::Binary(int level)
+{
+    Node* left = Unary();
+
+    while (at < end)
+    {
+        std::string op = effect->tokens[at].text;
+        int precedence = Precedence(op);
+        if (precedence == 0 || precedence <= level)
+        {
+            break;
+        }
+
+        Next();
+        Node* right = Binary(precedence);
+
+        Node* node = NewNode(*effect, NODE_BINARY, op);
+        node->children.push_back(left);
+        node->children.push_back(right);
+        node->type = (left->type.columns >= right->type.columns) ? left->type : right->type;
+        node->uniform = left->uniform && right->uniform;
+        node->cost = (op == "/") ? 2 : 1;   // a reciprocal and a multiply
+        left = node;
+    }
+
+    return left;
+}
+
+//----------------------------------------------------------------------
+// file scope
+//----------------------------------------------------------------------
+
+static void ParseTechnique(EffectSource& effect, size_t at, size_t end)
+{
+    const std::vector<Token>& tokens = effect.tokens;
+    std::string technique = tokens[at + 1].text;
+    std::string pass;
+
+    for (size_t i = at; i < end; ++i)
+    {
+        if (tokens[i].text == "pass" && i + 1 < end)
+        {
+            pass = tokens[i + 1].text;
+        }
+        else if (tokens[i].text == "compile" && i + 2 < end)
+        {
+            ShaderUse use;
+            use.technique = technique;
+            use.pass = pass;
+            use.stage = tokens[i + 1].text.substr(0, 2);
+            use.function = tokens[i + 2].text;
+
+            bool seen = false;
+            for (size_t u = 0; u < effect.shaders.size(); ++u)
+            {
+                const ShaderUse& other = effect.shaders[u];
+                seen = seen || (other.technique == use.technique && other.pass == use.pass && other.stage == use.stage);
+            }
+            if (!seen)
+            {
+                effect.shaders.push_back(use);
+            }
+        }
+    }
+
+    effect.techniqueBegins.push_back(at);
+    effect.techniqueEnds.push_back(end);
+}
+
+static void ParseStruct(EffectSource& effect, size_t at, size_t end)
+{
+    const std::vector<Token>& tokens = effect.tokens;
+
+    StructDecl decl;
+    decl.name = tokens[at + 1].text;
+    decl.begin = at;
+    decl.end = end;
+
+    // type name [: semantic] ;
+    size_t i = at + 3;
+    while (i + 1 < end && tokens[i].text != "}")
+    {
+        size_t memberEnd = FindStatementEnd(tokens, i, end);
+
+        StructMember member;
+        member.name = tokens[i + 1].text;
+        member.begin = i;
+        member.end = memberEnd + 1;
+        if (!ParseType(tokens[i].text, &member.type))
+        {
+            member.type.rows = 1;
+            member.type.columns = 0;
+        }
+        if (i + 3 < memberEnd && tokens[i + 2].text == ":")
+        {
+            member.semantic = tokens[i + 3].text;
+        }
+
+        decl.members.push_back(member);
+        i = memberEnd + 1;
+    }
+
+    effect.structs.push_back(decl);
+}
+
+static void ParseEffect(EffectSource& effect)
+{
+    const std::vector<Token>& tokens = effect.tokens;
+
+    size_t at = 0;
+    while (at < tokens.size())
+    {
+        const std::string& word = tokens[at].text;
+
+        if (word == "struct" && at + 1 < tokens.size())
+        {
+            size_t end = SkipBalanced(tokens, at, "{", "}");
+            end += (end < tokens.size() && tokens[end].text == ";") ? 1 : 0;
+            ParseStruct(effect, at, end);
+            at = end;
+        }
+        else if (word == "technique" || word == "technique9")
+        {
+            size_t end = SkipBalanced(tokens, at, "{", "}");
+            ParseTechnique(effect, at, end);
+            at = end;
+        }
+        else if (tokens[at].identifier && at + 2 < tokens.size() && tokens[at + 1].identifier &&
+            tokens[at + 2].text == "(")
+        {
+            Function function;
+            function.name = tokens[at + 1].text;
+            function.returnType = word;
+            function.begin = at;
+
+            // type name [, type name ...]
+            size_t close = SkipBalanced(tokens, at + 2, "(", ")");
+            for (size_t i = at + 3; i + 1 < close; ++i)
+            {
+                const Token& token = tokens[i];
+                const Token& next = tokens[i + 1];
+                if (token.identifier && next.identifier && token.text != "in" && token.text != "out" &&
+                    token.text != "uniform")
+                {
+                    function.parameters[next.text] = token.text;
+                }
+            }
+
+            size_t open = close;
+            while (open < tokens.size() && tokens[open].text != "{")
+            {
+                ++open;
+            }
+            function.end = SkipBalanced(tokens, open, "{", "}");
+            function.bodyBegin = open + 1;
+            function.bodyEnd = function.end - 1;
+
+            effect.functions.push_back(function);
+            at = function.end;
+        }
+        else if (tokens[at].identifier)
+        {
+            // a global: type name [: semantic] [< annotations >] [= value] ;
+            Global global;
+            global.begin = at;
+
+            size_t nameAt = at + 1;
+            while (nameAt < tokens.size() && (tokens[nameAt - 1].text == "static" ||
+                tokens[nameAt - 1].text == "uniform" || tokens[nameAt - 1].text == "const"))
+            {
+                ++nameAt;
+            }
+            if (nameAt >= tokens.size())
+            {
+                break;
+            }
+
+            global.name = tokens[nameAt].text;
+            global.typeName = tokens[nameAt - 1].text;
+            if (!ParseType(global.typeName, &global.type))
+            {
+                global.type.rows = 1;
+                global.type.columns = 0;
+            }
+
+            // skip to the end of the declaration
+            size_t i = nameAt;
+            while (i < tokens.size() && tokens[i].text != ";")
+            {
+                if (tokens[i].text == "<")
+                {
+                    i = SkipBalanced(tokens, i, "<", ">");
+                }
+                else if (tokens[i].text == "{")
+                {
+                    i = SkipBalanced(tokens, i, "{", "}");
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            global.end = i + 1;
+
+            effect.globals.push_back(global);
+            at = global.end;
+        }
+        else
+        {
+            ++at;
+        }
+    }
+}
+
+static bool ReadFile(const char* filename, std::string* text)
+{
+    FILE* fp = fopen(filename, "rb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        text->append(buffer, read);
+    }
+    fclose(fp);
+    return true;
+}
+
+//----------------------------------------------------------------------
+// shader graphs
+//----------------------------------------------------------------------
+
+static Node* ParseRange(EffectSource& effect, ShaderGraph& graph, size_t at, size_t end)
+{
+    Parser parser = { &effect, &graph, at, end };
+    return parser.Expression();
+}
+
+// the lvalue at tokens[at]: a name and its members
+static std::string ReadTarget(const std::vector<Token>& tokens, size_t& at, size_t end)
+{
+    std::string target = tokens[at++].text;
+    while (at + 1 < end && tokens[at].text == ".")
+    {
+        target += "." + tokens[at + 1].text;
+        at += 2;
+    }
+    return target;
+}
+
+// records value as what target holds from here on; partial and
+// conditional writes are kept, but not followed through
+static Node* Assign(EffectSource& effect, ShaderGraph& graph, const std::string& target, const std::string& op,
+    Node* value, bool conditional)
+{
+    // a swizzle or a member written in part, e.g. uv.y = ...
+    std::string base = target;
+    size_t dot = target.rfind('.');
+    bool partial = false;
+    if (dot != std::string::npos)
+    {
+        std::string head = target.substr(0, dot);
+
+        // struct locals are recorded with no columns
+        bool structMember = graph.inputs.count(head) ||
+            (graph.locals.count(head) && graph.locals[head].columns == 0);
+        if (!structMember)
+        {
+            base = head;
+            partial = true;
+        }
+    }
+
+    Node* old = graph.values.count(base) ? graph.values[base] : NULL;
+    if (!old && graph.inputs.count(target.substr(0, target.find('.'))))
+    {
+        Node* input = NewNode(effect, NODE_INPUT, base);
+        input->uniform = false;
+        old = input;
+    }
+
+    Node* result = value;
+    if (op != "=")
+    {
+        Node* binary = NewNode(effect, NODE_BINARY, op.substr(0, 1));
+        binary->children.push_back(old ? old : value);
+        binary->children.push_back(value);
+        binary->type = value->type;
+        binary->uniform = IsUniformChildren(binary);
+        binary->cost = 1;
+        result = binary;
+    }
+
+    if (partial || conditional)
+    {
+        // follow it no further, but keep what it reads alive
+        std::vector<Node*> children;
+        if (old)
+        {
+            children.push_back(old);
+        }
+        children.push_back(result);
+        Type type = old ? old->type : result->type;
+        result = MakeOpaque(effect, children, type);
+        result->text = base;
+        if (conditional)
+        {
+            result->uniform = false;
+        }
+    }
+
+    if (result->variable.empty())
+    {
+        result->variable = base;
+    }
+    graph.values[base] = result;
+    return result;
+}
+
+static void AddStatement(ShaderGraph& graph, size_t begin, size_t end, const std::string& target, Node* value)
+{
+    Statement statement;
+    statement.begin = begin;
+    statement.end = end;
+    statement.target = target;
+    statement.value = value;
+    graph.statements.push_back(statement);
+}
+
+static void BuildStatements(EffectSource& effect, ShaderGraph& graph, size_t at, size_t end, bool conditional)
+{
+    const std::vector<Token>& tokens = effect.tokens;
+
+    while (at < end)
+    {
+        const Token& token = tokens[at];
+
+        if (token.text == "{")
+        {
+            size_t close = SkipBalanced(tokens, at, "{", "}");
+            BuildStatements(effect, graph, at + 1, close - 1, conditional);
+            at = close;
+        }
+        else if (token.text == "if" || token.text == "for" || token.text == "while")
+        {
+            size_t close = SkipBalanced(tokens, at + 1, "(", ")");
+            Type counterType;
+            if (token.text == "for" && tokens[at + 2].identifier && ParseType(tokens[at + 2].text, &counterType))
+            {
+                // the counter changes every iteration
+                std::string counter = tokens[at + 3].text;
+                Node* value = NewNode(effect, NODE_OPAQUE, counter);
+                value->type = counterType;
+                value->uniform = false;
+                graph.locals[counter] = counterType;
+                graph.values[counter] = value;
+            }
+            else
+            {
+                graph.conditions.push_back(ParseRange(effect, graph, at + 2, close - 1));
+            }
+
+            size_t bodyEnd = (close < end && tokens[close].text == "{") ?
+                SkipBalanced(tokens, close, "{", "}") : FindStatementEnd(tokens, close, end) + 1;
+            BuildStatements(effect, graph, close, bodyEnd, true);
+            at = bodyEnd;
+        }
+        else if (token.text == "else")
+        {
+            size_t bodyEnd = (at + 1 < end && tokens[at + 1].text == "{") ?
+                SkipBalanced(tokens, at + 1, "{", "}") : FindStatementEnd(tokens, at + 1, end) + 1;
+            BuildStatements(effect, graph, at + 1, bodyEnd, true);
+            at = bodyEnd;
+        }
+        else if (token.text == "return")
+        {
+            size_t statementEnd = FindStatementEnd(tokens, at, end);
+            size_t value = at + 1;
+            size_t valueEnd = statementEnd;
+            if (value < valueEnd && tokens[value].text == "(" && SkipBalanced(tokens, value, "(", ")") == valueEnd)
+            {
+                ++value;
+                --valueEnd;
+            }
+
+            if (valueEnd == value + 1 && tokens[value].text == graph.outputName)
+            {
+                // return Output; every member assigned is an output
+                std::string prefix = graph.outputName + ".";
+                for (std::map<std::string, Node*>::iterator i = graph.values.begin(); i != graph.values.end(); ++i)
+                {
+                    if (i->first.compare(0, prefix.size(), prefix) == 0)
+                    {
+                        graph.outputs[i->first.substr(prefix.size())] = i->second;
+                    }
+                }
+            }
+            else
+            {
+                graph.results.push_back(ParseRange(effect, graph, value, valueEnd));
+            }
+            at = statementEnd + 1;
+        }
+        else
+        {
+            size_t statementEnd = FindStatementEnd(tokens, at, end);
+
+            Type type;
+            if (token.identifier && ParseType(token.text, &type) && at + 1 < statementEnd)
+            {
+                // declaration
+                std::string name = tokens[at + 1].text;
+                graph.locals[name] = type;
+                if (at + 2 < statementEnd && tokens[at + 2].text == "=")
+                {
+                    Node* value = ParseRange(effect, graph, at + 3, statementEnd);
+                    Node* result = Assign(effect, graph, name, "=", value, conditional);
+                    AddStatement(graph, at, statementEnd + 1, name, result);
+                }
+            }
+            else if (token.identifier && at + 1 < statementEnd && tokens[at + 1].identifier &&
+                FindEffectStruct(effect, token.text))
+            {
+                // VS_OUTPUT Output;
+                graph.outputName = tokens[at + 1].text;
+                Type structType = { 1, 0 };
+                graph.locals[graph.outputName] = structType;
+            }
+            else if (token.identifier)
+            {
+                size_t i = at;
+                std::string target = ReadTarget(tokens, i, statementEnd);
+                if (i < statementEnd && (tokens[i].text == "=" || tokens[i].text == "+=" ||
+                    tokens[i].text == "-=" || tokens[i].text == "*=" || tokens[i].text == "/="))
+                {
+                    std::string op = tokens[i].text;
+                    Node* value = ParseRange(effect, graph, i + 1, statementEnd);
+                    Node* result = Assign(effect, graph, target, op, value, conditional);
+                    AddStatement(graph, at, statementEnd + 1, target, result);
+                }
+            }
+            at = statementEnd + 1;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// interface
+//----------------------------------------------------------------------
+bool LoadEffectSource(const char* filename, EffectSource* effect, const std::map<std::string, std::string>* defines)
+{
+    if (!ReadFile(filename, &effect->text))
+    {
+        return false;
+    }
+
+    Preprocessor preprocessor;
+    if (defines)
+    {
+        preprocessor.macros = *defines;
+    }
+    Tokenize(effect->text, effect->tokens, &preprocessor);
+    ParseEffect(*effect);
+    return true;
+}
+
+void ReleaseEffectSource(EffectSource* effect)
+{
+    for (size_t i = 0; i < effect->nodes.size(); ++i)
+    {
+        delete effect->nodes[i];
+    }
+    effect->nodes.clear();
+}
+
+const Function* FindEffectFunction(const EffectSource& effect, const std::string& name)
+{
+    for (size_t i = 0; i < effect.functions.size(); ++i)
+    {
+        if (effect.functions[i].name == name)
+        {
+            return &effect.functions[i];
+        }
+    }
+    return NULL;
+}
+
+const StructDecl* FindEffectStruct(const EffectSource& effect, const std::string& name)
+{
+    for (size_t i = 0; i < effect.structs.size(); ++i)
+    {
+        if (effect.structs[i].name == name)
+        {
+            return &effect.structs[i];
+        }
+    }
+    return NULL;
+}
+
+const Global* FindEffectGlobal(const EffectSource& effect, const std::string& name)
+{
+    for (size_t i = 0; i < effect.globals.size(); ++i)
+    {
+        if (effect.globals[i].name == name)
+        {
+            return &effect.globals[i];
+        }
+    }
+    return NULL;
+}
+
+void BuildShaderGraph(EffectSource& effect, const Function& function, ShaderGraph* graph)
+{
+    graph->function = &function;
+    graph->outputName = "\x01";
+
+    // parameters differ per vertex or pixel
+    for (std::map<std::string, std::string>::const_iterator i = function.parameters.begin();
+        i != function.parameters.end(); ++i)
+    {
+        graph->inputs.insert(i->first);
+    }
+
+    BuildStatements(effect, *graph, function.bodyBegin, function.bodyEnd, false);
+}
+
+void GetShaderRoots(const ShaderGraph& graph, std::vector<Node*>* roots)
+{
+    for (std::map<std::string, Node*>::const_iterator i = graph.outputs.begin(); i != graph.outputs.end(); ++i)
+    {
+        roots->push_back(i->second);
+    }
+    roots->insert(roots->end(), graph.results.begin(), graph.results.end());
+    roots->insert(roots->end(), graph.conditions.begin(), graph.conditions.end());
+}
+
+int GetNodeCost(Node* node, std::set<Node*>& counted)
+{
+    if (!counted.insert(node).second)
+    {
+        return 0;
+    }
+    int cost = node->cost;
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+        cost += GetNodeCost(node->children[i], counted);
+    }
+    return cost;
+}
+
+std::string PrintNode(const Node* node, bool expand)
+{
+    if (!expand && !node->variable.empty())
+    {
+        return node->variable;
+    }
+
+    switch (node->kind)
+    {
+    case NODE_CALL:
+    case NODE_CONSTRUCT:
+    {
+        std::string text = node->text + "(";
+        for (size_t i = 0; i < node->children.size(); ++i)
+        {
+            text += (i ? ", " : "") + PrintNode(node->children[i], false);
+        }
+        return text + ")";
+    }
+    case NODE_CAST:
+        return "(" + node->text + ")" + PrintNode(node->children[0], false);
+    case NODE_MEMBER:
+        return PrintNode(node->children[0], false) + "." + node->text;
+    case NODE_INDEX:
+        return PrintNode(node->children[0], false) + "[" + PrintNode(node->children[1], false) + "]";
+    case NODE_UNARY:
+        return node->text + PrintNode(node->children[0], false);
+    case NODE_BINARY:
+        return "(" + PrintNode(node->children[0], false) + " " + node->text + " " + PrintNode(node->children[1], false) + ")";
+    default:
+        return node->text;
+    }
+}
@@ -0,0 +1,185 @@
+//**********************************************************************
+//
+// EffectSource.h
+//
+// Reads the HLSL of an .fx file for the offline effect tools: its
+// globals, structs, functions and the shaders each technique compiles.
+// A shader function can then be turned into a graph of the values it
+// computes, where every variable read points at the node of the value
+// last assigned to it, so what an output depends on can be followed
+// back to uniforms and vertex or pixel inputs.
+//
+// Only the subset of HLSL the RenderMonkey exports use is understood.
+// Writes the graph cannot follow (swizzles, writes inside if and for)
+// become opaque nodes that keep everything they read alive.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// ---------- types ------------------------------------
+
+struct Token
+{
+    std::string text;
+    bool identifier;
+    size_t offset;              // in the source text
+};
+
+struct Type
+{
+    int rows;                   // 1 for scalars and vectors
+    int columns;                // components of a vector; 0 if not numeric
+};
+
+enum NodeKind
+{
+    NODE_UNIFORM,               // a global
+    NODE_LITERAL,
+    NODE_INPUT,                 // differs per vertex or pixel
+    NODE_CALL,
+    NODE_CONSTRUCT,             // float4(...)
+    NODE_CAST,                  // (float3x3)m
+    NODE_MEMBER,                // swizzle
+    NODE_INDEX,
+    NODE_UNARY,
+    NODE_BINARY,
+    NODE_OPAQUE                 // a value the graph does not follow
+};
+
+struct Node
+{
+    NodeKind kind;
+    std::string text;           // name, literal, function, operator or member
+    std::vector<Node*> children;
+    Type type;
+    std::string variable;       // the variable it was assigned to, for printing
+    bool uniform;               // the same for every vertex or pixel
+    int cost;                   // estimated instructions of this node alone
+};
+
+struct StructMember
+{
+    std::string name;
+    std::string semantic;
+    Type type;
+    size_t begin;               // tokens, end is one past the ';'
+    size_t end;
+};
+
+struct StructDecl
+{
+    std::string name;
+    std::vector<StructMember> members;
+    size_t begin;
+    size_t end;
+};
+
+// a uniform, texture, sampler or string at file scope
+struct Global
+{
+    std::string name;
+    std::string typeName;
+    Type type;
+    size_t begin;
+    size_t end;
+};
+
+struct Function
+{
+    std::string name;
+    std::string returnType;
+    std::map<std::string, std::string> parameters;      // name to type
+    size_t begin;
+    size_t bodyBegin;           // first token inside the braces
+    size_t bodyEnd;             // the closing brace
+    size_t end;
+};
+
+struct ShaderUse
+{
+    std::string technique;
+    std::string pass;
+    std::string stage;          // vs or ps
+    std::string function;
+};
+
+struct EffectSource
+{
+    std::string text;
+    std::vector<Token> tokens;
+    std::vector<Global> globals;
+    std::vector<StructDecl> structs;
+    std::vector<Function> functions;
+    std::vector<ShaderUse> shaders;     // in technique and pass order
+    std::vector<size_t> techniqueBegins;
+    std::vector<size_t> techniqueEnds;
+    std::vector<Node*> nodes;           // every node made, to free them
+};
+
+// a statement of a shader function that assigns something
+struct Statement
+{
+    size_t begin;               // tokens, end is one past the ';'
+    size_t end;
+    std::string target;         // variable, or struct variable and member
+    Node* value;                // what the target holds afterwards
+};
+
+struct ShaderGraph
+{
+    const Function* function;
+    std::map<std::string, Node*> values;        // what each variable holds
+    std::map<std::string, Type> locals;
+    std::set<std::string> inputs;               // parameters
+    std::string outputName;                     // the struct returned, if any
+    std::map<std::string, Node*> outputs;       // its members at the return
+    std::vector<Node*> conditions;              // of if, for and while
+    std::vector<Node*> results;                 // returned, other than outputs
+    std::vector<Statement> statements;
+};
+
+// ---------------- function prototype  ------------------------
+
+// the token after the one closing the open at tokens[at]
+size_t SkipBalanced(const std::vector<Token>& tokens, size_t at, const char* open, const char* close);
+
+// the ';' ending the statement at tokens[at], or end
+size_t FindStatementEnd(const std::vector<Token>& tokens, size_t at, size_t end);
+
+// float, float3, float4x4 and the like; false for other type names
+bool ParseType(const std::string& name, Type* type);
+
+// defines (may be NULL) are names and values as given to the compiler.
+// #define and #if blocks are followed; the tokens of the branches not
+// taken are left out, and a macro's expansion has the offset of its name.
+bool LoadEffectSource(const char* filename, EffectSource* effect,
+    const std::map<std::string, std::string>* defines = NULL);
+
+// frees the nodes of every graph built from effect
+void ReleaseEffectSource(EffectSource* effect);
+
+const Function* FindEffectFunction(const EffectSource& effect, const std::string& name);
+
+const StructDecl* FindEffectStruct(const EffectSource& effect, const std::string& name);
+
+const Global* FindEffectGlobal(const EffectSource& effect, const std::string& name);
+
+void BuildShaderGraph(EffectSource& effect, const Function& function, ShaderGraph* graph);
+
+// what the shader computes: the outputs, the other returned values and
+// the conditions of its branches
+void GetShaderRoots(const ShaderGraph& graph, std::vector<Node*>* roots);
+
+// estimated instructions of node and what it reads, skipping nodes
+// already in counted
+int GetNodeCost(Node* node, std::set<Node*>& counted);
+
+// node as HLSL; variables by name unless expand
+std::string PrintNode(const Node* node, bool expand);
@@ -137,9 +137,9 @@ struct PS_INPUT
 
 float4 EnvironmentMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
 {
-   float3 tangentNormal = tex2D(NormalSampler, Input.mUV).xyz;
-   
-   tangentNormal = normalize(tangentNormal * 2 - 1);
+   // the normal map only stores X and Y (BC5), so rebuild Z
+   float2 tangentNormalXY = tex2D(NormalSampler, Input.mUV).xy * 2 - 1;
+   float3 tangentNormal = float3(tangentNormalXY, sqrt(saturate(1 - dot(tangentNormalXY, tangentNormalXY))));
    // tangentNormal = float3(0, 0, 1);
    
    
@@ -165,7 +165,8 @@ float4 EnvironmentMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
       specular = pow(specular, 20.0f);
       
       float4 specularIntensity = tex2D(SpecularSampler, Input.mUV);
-      specular *= specularIntensity.rgb * gLightColor;
+      // the specular map is single-channel (BC4)
+      specular *= specularIntensity.r * gLightColor;
    }
    
    float3 viewReflect = reflect(viewDir, worldNormal);
@@ -0,0 +1,45 @@
+//**********************************************************************
+//
+// FileUtil.cpp
+//
+// Small file helpers shared by the native asset loaders.
+//
+//**********************************************************************
+
+#include "FileUtil.h"
+#include <stdio.h>
+
+
+unsigned char* ReadWholeFile(const char* filename, size_t* size)
+{
+    FILE* fp = fopen(filename, "rb");
+    if (!fp)
+    {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (length <= 0)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    unsigned char* data = new unsigned char[length];
+    if (fread(data, 1, length, fp) != (size_t)length)
+    {
+        delete[] data;
+        data = NULL;
+    }
+    fclose(fp);
+
+    if (data && size)
+    {
+        *size = (size_t)length;
+    }
+
+    return data;
+}
@@ -0,0 +1,18 @@
+//**********************************************************************
+//
+// FileUtil.h
+//
+// Small file helpers shared by the native asset loaders.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <stddef.h>
+
+// ---------------- function prototype  ------------------------
+
+// reads a whole file into a buffer allocated with new[]. caller deletes it.
+// returns NULL if the file cannot be read.
+unsigned char* ReadWholeFile(const char* filename, size_t* size);
@@ -0,0 +1,196 @@
+//**********************************************************************
+//
+// FrameBenchmark.cpp
+//
+// Headless benchmark mode shared by every sample. Started with
+//
+//   BasicFramework.exe -benchmark [frames] [-warmup frames] [-out file.json]
+//
+// the sample renders a fixed number of frames with a fixed timestep,
+// without vsync and without showing its window, writes the frame time
+// percentiles, throughput and peak memory use as JSON and quits.
+// Tools/SampleBench runs every sample this way.
+//
+//**********************************************************************
+
+#include "FrameBenchmark.h"
+#include "SimulationClock.h"
+#include <psapi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#pragma comment(lib, "psapi.lib")
+
+BenchmarkSettings gBenchmark;
+
+
+//----------------------------------------------------------------------
+// settings
+//----------------------------------------------------------------------
+
+// next whitespace separated token of the command line
+static const char* NextToken(const char* cmdLine, char* token, size_t size)
+{
+    while (*cmdLine == ' ' || *cmdLine == '\t')
+    {
+        ++cmdLine;
+    }
+
+    size_t length = 0;
+    while (*cmdLine && *cmdLine != ' ' && *cmdLine != '\t')
+    {
+        if (length + 1 < size)
+        {
+            token[length++] = *cmdLine;
+        }
+        ++cmdLine;
+    }
+    token[length] = '\0';
+
+    return cmdLine;
+}
+
+void InitBenchmark(const char* cmdLine)
+{
+    ZeroMemory(&gBenchmark, sizeof(gBenchmark));
+    gBenchmark.frames = BENCHMARK_DEFAULT_FRAMES;
+    gBenchmark.warmupFrames = BENCHMARK_WARMUP_FRAMES;
+    strcpy(gBenchmark.output, BENCHMARK_DEFAULT_OUTPUT);
+
+    char token[MAX_PATH];
+    cmdLine = NextToken(cmdLine ? cmdLine : "", token, sizeof(token));
+
+    while (token[0])
+    {
+        if (strcmp(token, "-benchmark") == 0)
+        {
+            gBenchmark.enabled = true;
+
+            // the frame count is optional
+            char count[MAX_PATH];
+            const char* next = NextToken(cmdLine, count, sizeof(count));
+            if (atoi(count) > 0)
+            {
+                gBenchmark.frames = atoi(count);
+                cmdLine = next;
+            }
+        }
+        else if (strcmp(token, "-warmup") == 0)
+        {
+            cmdLine = NextToken(cmdLine, token, sizeof(token));
+            gBenchmark.warmupFrames = atoi(token);
+        }
+        else if (strcmp(token, "-out") == 0)
+        {
+            cmdLine = NextToken(cmdLine, gBenchmark.output, sizeof(gBenchmark.output));
+        }
+
+        cmdLine = NextToken(cmdLine, token, sizeof(token));
+    }
+}
+
+//----------------------------------------------------------------------
+// measuring
+//----------------------------------------------------------------------
+
+// nearest-rank percentile of sorted frame times
+static double Percentile(const std::vector<double>& sorted, double percent)
+{
+    size_t rank = (size_t)(percent / 100.0 * sorted.size() + 0.5);
+    rank = (rank < 1) ? 1 : ((rank > sorted.size()) ? sorted.size() : rank);
+
+    return sorted[rank - 1];
+}
+
+// the folder the sample runs in, e.g. 09_UVAnimation
+static void GetSampleName(char* name, size_t size)
+{
+    char directory[MAX_PATH];
+    GetCurrentDirectory(MAX_PATH, directory);
+
+    const char* slash = strrchr(directory, '\\');
+    strncpy(name, slash ? slash + 1 : directory, size - 1);
+    name[size - 1] = '\0';
+}
+
+bool RunBenchmark(void (*renderFrame)())
+{
+    std::vector<double> frameMs;
+    frameMs.reserve(gBenchmark.frames);
+
+    LARGE_INTEGER frequency, start, last;
+    QueryPerformanceFrequency(&frequency);
+
+    int totalFrames = gBenchmark.warmupFrames + gBenchmark.frames;
+    for (int frameIndex = 0; frameIndex < totalFrames; ++frameIndex)
+    {
+        // keep the window responsive; the sample sees no input
+        MSG msg;
+        while (PeekMessage(&msg, NULL, 0U, 0U, PM_REMOVE))
+        {
+            if (msg.message == WM_QUIT)
+            {
+                return false;
+            }
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+
+        if (frameIndex == gBenchmark.warmupFrames)
+        {
+            QueryPerformanceCounter(&start);
+            last = start;
+        }
+
+        renderFrame();
+
+        if (frameIndex >= gBenchmark.warmupFrames)
+        {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            frameMs.push_back((now.QuadPart - last.QuadPart) * 1000.0 / frequency.QuadPart);
+            last = now;
+        }
+    }
+
+    if (frameMs.empty())
+    {
+        return false;
+    }
+
+    double totalMs = (last.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart;
+
+    std::vector<double> sorted(frameMs);
+    std::sort(sorted.begin(), sorted.end());
+
+    PROCESS_MEMORY_COUNTERS memory;
+    ZeroMemory(&memory, sizeof(memory));
+    GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory));
+
+    char sampleName[MAX_PATH];
+    GetSampleName(sampleName, sizeof(sampleName));
+
+    FILE* fp = fopen(gBenchmark.output, "w");
+    if (!fp)
+    {
+        OutputDebugString("failed at writing benchmark results\n");
+        return false;
+    }
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"sample\": \"%s\",\n", sampleName);
+    fprintf(fp, "  \"frames\": %d,\n", (int)frameMs.size());
+    fprintf(fp, "  \"warmupFrames\": %d,\n", gBenchmark.warmupFrames);
+    fprintf(fp, "  \"timestepMs\": %.3f,\n", SIMULATION_TIMESTEP * 1000.0f);
+    fprintf(fp, "  \"frameMs\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+        totalMs / frameMs.size(), Percentile(sorted, 50), Percentile(sorted, 95), Percentile(sorted, 99), sorted.back());
+    fprintf(fp, "  \"framesPerSecond\": %.2f,\n", frameMs.size() * 1000.0 / totalMs);
+    fprintf(fp, "  \"peakRssKB\": %u\n", (unsigned int)(memory.PeakWorkingSetSize / 1024));
+    fprintf(fp, "}\n");
+    fclose(fp);
+
+    return true;
+}
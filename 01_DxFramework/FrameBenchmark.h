@@ -0,0 +1,46 @@
+//**********************************************************************
+//
+// FrameBenchmark.h
+//
+// Headless benchmark mode shared by every sample. Started with
+//
+//   BasicFramework.exe -benchmark [frames] [-warmup frames] [-out file.json]
+//
+// the sample renders a fixed number of frames with a fixed timestep,
+// without vsync and without showing its window, writes the frame time
+// percentiles, throughput and peak memory use as JSON and quits.
+// Tools/SampleBench runs every sample this way.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <windows.h>
+
+// ---------- constants ------------------------------------
+
+#define BENCHMARK_DEFAULT_FRAMES	1000
+#define BENCHMARK_WARMUP_FRAMES		30
+#define BENCHMARK_DEFAULT_OUTPUT	"benchmark.json"
+
+// ---------- types ------------------------------------
+
+struct BenchmarkSettings
+{
+    bool enabled;
+    int frames;                 // measured frames
+    int warmupFrames;           // rendered before measuring
+    char output[MAX_PATH];
+};
+
+extern BenchmarkSettings gBenchmark;
+
+// ---------------- function prototype  ------------------------
+
+// fills gBenchmark from the command line
+void InitBenchmark(const char* cmdLine);
+
+// renders the warmup and measured frames, pumping window messages in
+// between, then writes the results to gBenchmark.output
+bool RunBenchmark(void (*renderFrame)());
@@ -0,0 +1,442 @@
+//**********************************************************************
+//
+// FrameGraph.cpp
+//
+// Declarative frame graph. Every frame the renderer lists its passes and
+// the render targets each one reads and writes; the graph then drops the
+// passes whose output nothing uses, works out how long every target
+// lives, and hands targets whose lifetimes do not overlap the same
+// D3D9 surface.
+//
+// D3D9 cannot place two resources in one piece of memory, so aliasing
+// here means sharing a surface: a target whose last pass has run gives
+// its surface to the next target of the same size, format and usage.
+// The surfaces come from the render target pool (see RenderTargetPool.h),
+// which keeps them from frame to frame.
+//
+//**********************************************************************
+
+#include "FrameGraph.h"
+#include "RenderTargetPool.h"
+#include <windows.h>
+#include <stdio.h>
+
+struct FrameResourceNode
+{
+    const char* name;
+    UINT width;
+    UINT height;
+    D3DFORMAT format;
+    DWORD usage;                // D3DUSAGE_RENDERTARGET or D3DUSAGE_DEPTHSTENCIL; 0 for the device's own
+    int firstPass;              // lifetime among the passes that are run
+    int lastPass;
+    bool needed;                // read by a pass that is run
+    RenderTarget* target;       // NULL while it has none
+};
+
+struct FramePassNode
+{
+    const char* name;
+    FramePassFunction execute;
+    void* data;
+    FrameResource reads[FRAME_GRAPH_MAX_PASS_IO];
+    FrameResource writes[FRAME_GRAPH_MAX_PASS_IO];
+    int numReads;
+    int numWrites;
+    bool live;
+};
+
+static LPDIRECT3DDEVICE9 gpDevice = NULL;
+
+// this frame
+static FrameResourceNode gResources[FRAME_GRAPH_MAX_RESOURCES];
+static FramePassNode gPasses[FRAME_GRAPH_MAX_PASSES];
+static int gNumResources = 0;
+static int gNumPasses = 0;
+
+// render targets bound after the last pass
+static int gNumBoundTargets = 1;
+
+// statistics
+static long long gNumFrames = 0;
+static long long gNumCulledPasses = 0;
+static UINT gPeakDeclaredBytes = 0;     // as if every target had its own surface
+static UINT gPeakAllocatedBytes = 0;    // surfaces one frame used
+
+
+//----------------------------------------------------------------------
+// compiling
+//----------------------------------------------------------------------
+
+static bool IsDeviceResource(FrameResource resource)
+{
+    return resource == FRAME_BACK_BUFFER || resource == FRAME_DEPTH_BUFFER;
+}
+
+// a pass runs when it writes the back buffer or something a running
+// pass reads; walking backwards sees every reader before its writers
+static void CullPasses()
+{
+    for (int i = gNumPasses - 1; i >= 0; --i)
+    {
+        FramePassNode& pass = gPasses[i];
+        pass.live = false;
+
+        for (int w = 0; w < pass.numWrites; ++w)
+        {
+            FrameResource resource = pass.writes[w];
+            if (resource == FRAME_BACK_BUFFER || gResources[resource].needed)
+            {
+                pass.live = true;
+            }
+        }
+
+        if (!pass.live)
+        {
+            ++gNumCulledPasses;
+            continue;
+        }
+
+        for (int r = 0; r < pass.numReads; ++r)
+        {
+            gResources[pass.reads[r]].needed = true;
+        }
+    }
+}
+
+static void Use(FrameResource resource, int pass)
+{
+    FrameResourceNode& node = gResources[resource];
+    if (node.firstPass < 0)
+    {
+        node.firstPass = pass;
+    }
+    node.lastPass = pass;
+}
+
+// gives every target that is used a surface
+static bool AllocateTargets()
+{
+    for (int i = 0; i < gNumPasses; ++i)
+    {
+        FramePassNode& pass = gPasses[i];
+        if (pass.live)
+        {
+            for (int r = 0; r < pass.numReads; ++r)
+            {
+                Use(pass.reads[r], i);
+            }
+            for (int w = 0; w < pass.numWrites; ++w)
+            {
+                Use(pass.writes[w], i);
+            }
+        }
+    }
+
+    // walking the passes in order, a target taken at its first pass and
+    // given back after its last can go to any target first used later
+    bool succeeded = true;
+    UINT allocatedBytes = 0;
+    for (int pass = 0; pass < gNumPasses; ++pass)
+    {
+        for (int i = 0; i < gNumResources; ++i)
+        {
+            FrameResourceNode& resource = gResources[i];
+            if (IsDeviceResource(i) || resource.firstPass != pass)
+            {
+                continue;
+            }
+
+            resource.target = AcquireRenderTarget(resource.width, resource.height, resource.format, resource.usage);
+            if (!resource.target)
+            {
+                succeeded = false;
+                continue;
+            }
+
+            // a target acquired again is already counted
+            bool counted = false;
+            for (int j = 0; j < gNumResources; ++j)
+            {
+                counted = counted || (j != i && gResources[j].target == resource.target);
+            }
+            if (!counted)
+            {
+                allocatedBytes += GetRenderTargetBytes(resource.target->width, resource.target->height, resource.target->format);
+            }
+        }
+
+        for (int i = 0; i < gNumResources; ++i)
+        {
+            if (!IsDeviceResource(i) && gResources[i].lastPass == pass)
+            {
+                ReleaseRenderTarget(gResources[i].target);
+            }
+        }
+    }
+
+    UINT declaredBytes = 0;
+    for (int i = 0; i < gNumResources; ++i)
+    {
+        if (!IsDeviceResource(i))
+        {
+            declaredBytes += GetRenderTargetBytes(gResources[i].width, gResources[i].height, gResources[i].format);
+        }
+    }
+
+    gPeakDeclaredBytes = (declaredBytes > gPeakDeclaredBytes) ? declaredBytes : gPeakDeclaredBytes;
+    gPeakAllocatedBytes = (allocatedBytes > gPeakAllocatedBytes) ? allocatedBytes : gPeakAllocatedBytes;
+
+    return succeeded;
+}
+
+//----------------------------------------------------------------------
+// interface
+//----------------------------------------------------------------------
+bool InitFrameGraph(LPDIRECT3DDEVICE9 device)
+{
+    gpDevice = device;
+    gNumBoundTargets = 1;
+    gNumFrames = 0;
+    gNumCulledPasses = 0;
+    gPeakDeclaredBytes = 0;
+    gPeakAllocatedBytes = 0;
+
+    BeginFrameGraph();
+    return InitRenderTargetPool(device);
+}
+
+void BeginFrameGraph()
+{
+    gNumPasses = 0;
+    gNumResources = 0;
+
+    // FRAME_BACK_BUFFER and FRAME_DEPTH_BUFFER
+    CreateFrameTarget("back buffer", 0, 0, D3DFMT_UNKNOWN);
+    CreateFrameDepth("depth buffer", 0, 0, D3DFMT_UNKNOWN);
+    gResources[FRAME_BACK_BUFFER].usage = 0;
+    gResources[FRAME_DEPTH_BUFFER].usage = 0;
+}
+
+static FrameResource CreateResource(const char* name, UINT width, UINT height, D3DFORMAT format, DWORD usage)
+{
+    if (gNumResources == FRAME_GRAPH_MAX_RESOURCES)
+    {
+        OutputDebugString("frame graph: too many resources\n");
+        return -1;
+    }
+
+    FrameResourceNode& resource = gResources[gNumResources];
+    resource.name = name;
+    resource.width = width;
+    resource.height = height;
+    resource.format = format;
+    resource.usage = usage;
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    resource.needed = false;
+    resource.target = NULL;
+
+    return gNumResources++;
+}
+
+FrameResource CreateFrameTarget(const char* name, UINT width, UINT height, D3DFORMAT format)
+{
+    return CreateResource(name, width, height, format, D3DUSAGE_RENDERTARGET);
+}
+
+FrameResource CreateFrameDepth(const char* name, UINT width, UINT height, D3DFORMAT format)
+{
+    return CreateResource(name, width, height, format, D3DUSAGE_DEPTHSTENCIL);
+}
+
+int AddFramePass(const char* name, FramePassFunction execute, void* data)
+{
+    if (gNumPasses == FRAME_GRAPH_MAX_PASSES)
+    {
+        OutputDebugString("frame graph: too many passes\n");
+        return -1;
+    }
+
+    FramePassNode& pass = gPasses[gNumPasses];
+    pass.name = name;
+    pass.execute = execute;
+    pass.data = data;
+    pass.numReads = 0;
+    pass.numWrites = 0;
+    pass.live = false;
+
+    return gNumPasses++;
+}
+
+void ReadFrameResource(int pass, FrameResource resource)
+{
+    if (pass < 0 || resource < 0 || gPasses[pass].numReads == FRAME_GRAPH_MAX_PASS_IO)
+    {
+        return;
+    }
+
+    gPasses[pass].reads[gPasses[pass].numReads++] = resource;
+}
+
+void WriteFrameResource(int pass, FrameResource resource)
+{
+    if (pass < 0 || resource < 0 || gPasses[pass].numWrites == FRAME_GRAPH_MAX_PASS_IO)
+    {
+        return;
+    }
+
+    gPasses[pass].writes[gPasses[pass].numWrites++] = resource;
+}
+
+bool ExecuteFrameGraph()
+{
+    CullPasses();
+    bool succeeded = AllocateTargets();
+
+    LPDIRECT3DSURFACE9 pHWBackBuffer = NULL;
+    LPDIRECT3DSURFACE9 pHWDepthStencilBuffer = NULL;
+    gpDevice->GetRenderTarget(0, &pHWBackBuffer);
+    gpDevice->GetDepthStencilSurface(&pHWDepthStencilBuffer);
+
+    for (int i = 0; i < gNumPasses; ++i)
+    {
+        FramePassNode& pass = gPasses[i];
+        if (!pass.live)
+        {
+            continue;
+        }
+
+        LPDIRECT3DSURFACE9 targets[FRAME_GRAPH_MAX_PASS_IO];
+        LPDIRECT3DSURFACE9 depth = pHWDepthStencilBuffer;
+        const FrameResourceNode* firstTarget = NULL;
+        int numTargets = 0;
+        bool complete = true;
+
+        for (int w = 0; w < pass.numWrites; ++w)
+        {
+            const FrameResourceNode& resource = gResources[pass.writes[w]];
+            if (pass.writes[w] == FRAME_BACK_BUFFER)
+            {
+                targets[numTargets++] = pHWBackBuffer;
+            }
+            else if (pass.writes[w] == FRAME_DEPTH_BUFFER)
+            {
+                depth = pHWDepthStencilBuffer;
+            }
+            else if (!resource.target)
+            {
+                complete = false;
+            }
+            else if (resource.usage == D3DUSAGE_DEPTHSTENCIL)
+            {
+                depth = resource.target->surface;
+            }
+            else
+            {
+                firstTarget = firstTarget ? firstTarget : &resource;
+                targets[numTargets++] = resource.target->surface;
+            }
+        }
+
+        for (int r = 0; r < pass.numReads; ++r)
+        {
+            complete = complete && (IsDeviceResource(pass.reads[r]) || gResources[pass.reads[r]].target);
+        }
+
+        // a pass missing one of its surfaces would draw garbage
+        if (!complete)
+        {
+            continue;
+        }
+
+        if (numTargets == 0)
+        {
+            targets[numTargets++] = pHWBackBuffer;
+        }
+
+        // setting target 0 also resets the viewport to its size
+        for (int t = 0; t < numTargets; ++t)
+        {
+            gpDevice->SetRenderTarget(t, targets[t]);
+        }
+        for (int t = numTargets; t < gNumBoundTargets; ++t)
+        {
+            gpDevice->SetRenderTarget(t, NULL);
+        }
+        gNumBoundTargets = numTargets;
+        gpDevice->SetDepthStencilSurface(depth);
+
+        // a pooled target larger than asked for is drawn into at its top left
+        if (firstTarget && (firstTarget->target->width != firstTarget->width ||
+            firstTarget->target->height != firstTarget->height))
+        {
+            D3DVIEWPORT9 viewport = { 0, 0, firstTarget->width, firstTarget->height, 0.0f, 1.0f };
+            gpDevice->SetViewport(&viewport);
+        }
+
+        pass.execute(pass.data);
+    }
+
+    // use hardware backbuffer and depth buffer again
+    gpDevice->SetRenderTarget(0, pHWBackBuffer);
+    for (int t = 1; t < gNumBoundTargets; ++t)
+    {
+        gpDevice->SetRenderTarget(t, NULL);
+    }
+    gNumBoundTargets = 1;
+    gpDevice->SetDepthStencilSurface(pHWDepthStencilBuffer);
+
+    pHWBackBuffer->Release();
+    pHWBackBuffer = NULL;
+    pHWDepthStencilBuffer->Release();
+    pHWDepthStencilBuffer = NULL;
+
+    AdvanceRenderTargetPool();
+
+    ++gNumFrames;
+    return succeeded;
+}
+
+LPDIRECT3DTEXTURE9 GetFrameTexture(FrameResource resource)
+{
+    if (resource < 0 || resource >= gNumResources || !gResources[resource].target)
+    {
+        return NULL;
+    }
+
+    return gResources[resource].target->texture;
+}
+
+void GetFrameTextureScale(FrameResource resource, float* u, float* v)
+{
+    *u = 1.0f;
+    *v = 1.0f;
+
+    if (resource >= 0 && resource < gNumResources && gResources[resource].target)
+    {
+        const FrameResourceNode& node = gResources[resource];
+        *u = node.width / (float)node.target->width;
+        *v = node.height / (float)node.target->height;
+    }
+}
+
+void ReleaseFrameGraph()
+{
+    if (gNumFrames > 0)
+    {
+        UINT savedBytes = (gPeakDeclaredBytes > gPeakAllocatedBytes) ? gPeakDeclaredBytes - gPeakAllocatedBytes : 0;
+
+        char str[256];
+        sprintf(str, "frame graph: %lld frames, %lld passes culled, render targets %u KB "
+            "(%u KB if each had its own, %u KB saved)\n",
+            gNumFrames, gNumCulledPasses, gPeakAllocatedBytes / 1024, gPeakDeclaredBytes / 1024,
+            savedBytes / 1024);
+        OutputDebugString(str);
+    }
+
+    ReleaseRenderTargetPool();
+
+    gNumFrames = 0;
+    gpDevice = NULL;
+}
@@ -0,0 +1,82 @@
+//**********************************************************************
+//
+// FrameGraph.h
+//
+// Declarative frame graph. Every frame the renderer lists its passes and
+// the render targets each one reads and writes; the graph then drops the
+// passes whose output nothing uses, works out how long every target
+// lives, and hands targets whose lifetimes do not overlap the same
+// D3D9 surface. Passes only draw: binding and restoring render targets
+// and depth buffers is done by the graph.
+//
+// Target surfaces come from the render target pool (RenderTargetPool.h)
+// and may be larger than asked for; the graph then limits the viewport
+// to the requested size.
+//
+// Targets created in the graph are transient: their contents are
+// undefined when the first pass that writes them starts, so that pass
+// has to clear them.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <d3d9.h>
+
+// ---------- constants ------------------------------------
+
+#define FRAME_GRAPH_MAX_PASSES      16
+#define FRAME_GRAPH_MAX_RESOURCES   16
+#define FRAME_GRAPH_MAX_PASS_IO     8       // reads or writes of one pass
+
+// the device's own back buffer and depth buffer; passes that write the
+// back buffer are the graph's output and are never dropped
+#define FRAME_BACK_BUFFER           0
+#define FRAME_DEPTH_BUFFER          1
+
+// ---------- types ------------------------------------
+
+// handle of a render target in the current frame, -1 if invalid
+typedef int FrameResource;
+
+// draws one pass; its targets are already bound
+typedef void (*FramePassFunction)(void* data);
+
+// ---------------- function prototype  ------------------------
+
+bool InitFrameGraph(LPDIRECT3DDEVICE9 device);
+
+// starts describing a new frame
+void BeginFrameGraph();
+
+// a colour target that later passes can sample as a texture
+FrameResource CreateFrameTarget(const char* name, UINT width, UINT height, D3DFORMAT format);
+
+// a depth-stencil surface
+FrameResource CreateFrameDepth(const char* name, UINT width, UINT height, D3DFORMAT format);
+
+// returns the pass index, or -1. data has to stay valid until
+// ExecuteFrameGraph returns.
+int AddFramePass(const char* name, FramePassFunction execute, void* data);
+
+void ReadFrameResource(int pass, FrameResource resource);
+
+// colour targets are bound in the order they are written. a pass that
+// writes no depth uses the device's depth buffer, one that writes no
+// colour target draws into the back buffer.
+void WriteFrameResource(int pass, FrameResource resource);
+
+// culls, allocates and runs the passes in the order they were added;
+// the back buffer and depth buffer are bound again afterwards
+bool ExecuteFrameGraph();
+
+// the texture behind a colour target; valid inside the passes that read it
+LPDIRECT3DTEXTURE9 GetFrameTexture(FrameResource resource);
+
+// what texture coordinates are scaled by to sample the target; below 1
+// when the pool served it with a larger surface
+void GetFrameTextureScale(FrameResource resource, float* u, float* v);
+
+// releases the surfaces and writes the memory statistics
+void ReleaseFrameGraph();
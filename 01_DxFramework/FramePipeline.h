@@ -0,0 +1,50 @@
+//**********************************************************************
+//
+// FramePipeline.h
+//
+// Two-stage frame pipeline. A worker thread builds frame N+1 (runs the
+// simulation and computes what the frame draws) while the render thread
+// draws and presents frame N. The frame data is double-buffered, so the
+// worker is never more than one frame ahead, and GPU event queries keep
+// at most MAX_FRAMES_IN_FLIGHT presented frames queued on the GPU.
+//
+// The samples run serially unless started with -pipelined. Pipelining
+// adds about one frame of latency, and PipelineBench shows it gaining
+// no throughput while both stages keep the CPU busy (160 fps either
+// way, 6 ms of latency serial against 12 ms pipelined); it only gains
+// when a stage waits, and that has not been measured with a device. The
+// statistics written on release show what it costs and gains.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <d3d9.h>
+#include <stddef.h>
+
+// ---------- constants ------------------------------------
+
+// frames the GPU may lag behind the render thread
+#define MAX_FRAMES_IN_FLIGHT	2
+
+// ---------- types ------------------------------------
+
+// fills in the data for one frame; runs on the worker thread, so it
+// must not touch the device
+typedef void (*BuildFrameFunction)(void* frame);
+
+// ---------------- function prototype  ------------------------
+
+// frames of frameSize bytes are built by build. with pipelined false
+// every stage runs on the render thread, one after another.
+bool InitFramePipeline(LPDIRECT3DDEVICE9 device, BuildFrameFunction build, size_t frameSize, bool pipelined);
+
+// returns the data of the frame to render and starts building the next
+const void* BeginPipelinedFrame();
+
+// call after Present; waits while too many frames are queued on the GPU
+void EndPipelinedFrame();
+
+// stops the worker and writes the statistics
+void ReleaseFramePipeline();
@@ -0,0 +1,865 @@
+//**********************************************************************
+//
+// GlBackend.cpp
+//
+// Render backend on OpenGL 3.3 core with no window: the context is made
+// through EGL on Mesa's surfaceless platform, so on a machine without a
+// GPU it runs on llvmpipe, and the frame is drawn into a framebuffer
+// object of its own.
+//
+//   pipelines  the pass's shaders translated to GLSL (see
+//              GlslTranslator.h), from the cache GLSL_CACHE names when it
+//              has them, linked at load with their samplers set to units
+//   meshes     one vertex array each, set up at load; every semantic has
+//              a location of its own in every program
+//   uniforms   one uniform buffer, mapped once and kept mapped, holds
+//              the rings of three frames; AllocateRenderUniforms hands
+//              out the buffer's own memory, so a draw only binds its
+//              range. a fence after each frame's draws is waited for
+//              before its ring is written again. on llvmpipe, which
+//              draws slower from a mapped buffer than a copy costs, or
+//              where the driver cannot keep a buffer mapped, the ring is
+//              copied in at each draw instead. GL_UNIFORMS set to
+//              "mapped" or "copied" picks one either way.
+//   readback   the frame is read into one of two pixel buffers when it
+//              ends, and only the previous frame's is waited for, so
+//              reading one frame back overlaps drawing the next
+//
+// Triangles are counted as submitted, as OpenGL does not say how many it
+// culled (the software backend counts them the same way); pixels are the
+// samples that passed the depth test.
+//
+// Only built where there is EGL; on Windows the samples have D3D9 and
+// GetGlRenderBackend is NULL.
+//
+//**********************************************************************
+
+#include "RenderBackend.h"
+
+#ifdef _WIN32
+
+const RenderBackend* GetGlRenderBackend()
+{
+    return NULL;
+}
+
+#else
+
+#include "GlslTranslator.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---------- constants ------------------------------------
+
+// floats in the frame's uniform buffer; with every draw's uniforms
+// starting on 256 bytes, room for some 30000 draws
+#define GL_UNIFORM_RING             (2 * 1024 * 1024)
+
+// frames whose uniforms may be in flight
+#define GL_UNIFORM_FRAMES           3
+
+// environment variable that, set to "mapped" or "copied", picks how the
+// ring reaches the buffer whatever the driver, to compare the two
+#define GL_UNIFORMS_ENV             "GL_UNIFORMS"
+
+// renderer the ring is copied in for by default
+#define GL_COPY_UNIFORMS_RENDERER   "llvmpipe"
+
+// frames whose readback may be in flight
+#define GL_READBACK_FRAMES          2
+
+// nanoseconds glClientWaitSync waits
+#define GL_WAIT_FOREVER             (~(GLuint64)0)
+
+// ---------- types ------------------------------------
+
+struct GlMesh : RenderMesh
+{
+    GLuint vertexArray;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+};
+
+struct GlTexture : RenderTexture
+{
+    GLuint texture;
+    GLuint depth;                       // render targets only
+    GLuint framebuffer;
+};
+
+struct GlPipeline : RenderPipeline
+{
+    GLuint program;
+    GLenum samplerTargets[RENDER_MAX_SAMPLERS];
+};
+
+// ---------- globals ------------------------------------
+
+static EGLDisplay gDisplay = EGL_NO_DISPLAY;
+static EGLContext gContext = EGL_NO_CONTEXT;
+
+static GlTexture* gpFrame = NULL;
+static GlTexture* gpWhite = NULL;
+static GlTexture* gpWhiteCube = NULL;
+static const char* gpCacheDir = NULL;
+
+static GLuint gUniformBuffer = 0;
+static float* gpMappedUniforms = NULL;  // every frame's ring; NULL if not kept mapped
+static GLsync gUniformFences[GL_UNIFORM_FRAMES];
+static std::vector<float> gUniforms;    // the ring, when it is copied in
+static int gUniformsBegin = 0;          // the frame's ring, in floats
+static int gUniformsUsed = 0;
+static int gUniformsUploaded = 0;
+static int gUniformAlignment = 4;       // floats
+
+static GLuint gReadBuffers[GL_READBACK_FRAMES];
+static GLsync gReadFences[GL_READBACK_FRAMES];
+static GLuint gPixelQueries[GL_READBACK_FRAMES];
+static int gFrameCount = 0;
+
+// what is bound, so draws only change what differs
+static const GlPipeline* gpBoundPipeline = NULL;
+static RenderStates gStates;
+
+static RenderStats gStats;
+
+//----------------------------------------------------------------------
+// resources
+//----------------------------------------------------------------------
+
+static RenderMesh* CreateMesh(const RenderMeshDesc& desc)
+{
+    GlMesh* mesh = new GlMesh;
+    mesh->numVertices = desc.numVertices;
+    mesh->numIndices = desc.numIndices;
+
+    glGenVertexArrays(1, &mesh->vertexArray);
+    glGenBuffers(1, &mesh->vertexBuffer);
+    glGenBuffers(1, &mesh->indexBuffer);
+    glBindVertexArray(mesh->vertexArray);
+
+    // the attributes one after another in one buffer
+    size_t size = 0;
+    for (int a = 0; a < desc.numAttributes; ++a)
+    {
+        size += desc.attributes[a].components * desc.numVertices * sizeof(float);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STATIC_DRAW);
+
+    size_t offset = 0;
+    for (int a = 0; a < desc.numAttributes; ++a)
+    {
+        const RenderAttribute& attribute = desc.attributes[a];
+        size_t bytes = attribute.components * desc.numVertices * sizeof(float);
+        int location = GetGlslAttributeLocation(attribute.semantic);
+        if (location >= 0)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, attribute.values);
+            glVertexAttribPointer(location, attribute.components, GL_FLOAT, GL_FALSE, 0, (const void*)offset);
+            glEnableVertexAttribArray(location);
+        }
+        offset += bytes;
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, desc.numIndices * sizeof(unsigned int), desc.indices, GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    return mesh;
+}
+
+// tex2D wraps and both filter bilinearly, with no mips, as the shader
+// interpreter does
+static void SetSampling(GLenum target)
+{
+    GLenum wrap = (target == GL_TEXTURE_CUBE_MAP) ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
+}
+
+static GlTexture* NewTexture(int width, int height, bool cube, bool target, RenderFormat format)
+{
+    GlTexture* texture = new GlTexture;
+    texture->width = width;
+    texture->height = height;
+    texture->cube = cube;
+    texture->target = target;
+    texture->format = format;
+    texture->depth = 0;
+    texture->framebuffer = 0;
+    glGenTextures(1, &texture->texture);
+    return texture;
+}
+
+static RenderTexture* CreateTexture(int width, int height, bool cube, const unsigned char* rgba)
+{
+    GlTexture* texture = NewTexture(width, height, cube, false, RENDER_FORMAT_RGBA8);
+    GLenum target = cube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    glBindTexture(target, texture->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // rows top first, as they are sampled; the faces in D3DCUBEMAP_FACES
+    // order are OpenGL's too
+    size_t face = (size_t)width * height * 4;
+    for (int f = 0; f < (cube ? 6 : 1); ++f)
+    {
+        glTexImage2D(cube ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + f : GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, rgba + f * face);
+    }
+    SetSampling(target);
+    return texture;
+}
+
+static RenderTexture* CreateTarget(int width, int height, RenderFormat format)
+{
+    GlTexture* texture = NewTexture(width, height, false, true, format);
+    glBindTexture(GL_TEXTURE_2D, texture->texture);
+    if (format == RENDER_FORMAT_R32F)
+    {
+        // read as (r, 1, 1, 1), as D3D9 samples D3DFMT_R32F
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+    SetSampling(GL_TEXTURE_2D);
+
+    glGenRenderbuffers(1, &texture->depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, texture->depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &texture->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, texture->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, texture->depth);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        fprintf(stderr, "render: gl: a %dx%d target is not complete\n", width, height);
+        glDeleteFramebuffers(1, &texture->framebuffer);
+        glDeleteRenderbuffers(1, &texture->depth);
+        glDeleteTextures(1, &texture->texture);
+        delete texture;
+        return NULL;
+    }
+    return texture;
+}
+
+static void ReleaseMesh(RenderMesh* mesh)
+{
+    GlMesh* gl = (GlMesh*)mesh;
+    glDeleteVertexArrays(1, &gl->vertexArray);
+    glDeleteBuffers(1, &gl->vertexBuffer);
+    glDeleteBuffers(1, &gl->indexBuffer);
+    delete gl;
+}
+
+static void ReleaseTexture(RenderTexture* texture)
+{
+    GlTexture* gl = (GlTexture*)texture;
+    if (gl->framebuffer)
+    {
+        glDeleteFramebuffers(1, &gl->framebuffer);
+        glDeleteRenderbuffers(1, &gl->depth);
+    }
+    glDeleteTextures(1, &gl->texture);
+    delete gl;
+}
+
+//----------------------------------------------------------------------
+// pipelines
+//----------------------------------------------------------------------
+
+static GLuint CompileStage(GLenum stage, const std::string& source, const std::string& name)
+{
+    GLuint shader = glCreateShader(stage);
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, NULL);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled)
+    {
+        char log[2048];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "render: %s: %s shader: %s\n", name.c_str(),
+            (stage == GL_VERTEX_SHADER) ? "vertex" : "pixel", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint LinkProgram(const GlslProgram& glsl, const std::string& name)
+{
+    GLuint vertexShader = CompileStage(GL_VERTEX_SHADER, glsl.vertexSource, name);
+    GLuint pixelShader = CompileStage(GL_FRAGMENT_SHADER, glsl.pixelSource, name);
+    if (!vertexShader || !pixelShader)
+    {
+        glDeleteShader(vertexShader);
+        glDeleteShader(pixelShader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, pixelShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(pixelShader);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        char log[2048];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "render: %s: %s\n", name.c_str(), log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static RenderPipeline* CreatePipeline(const RenderPipeline& compiled)
+{
+    GlslProgram glsl;
+    unsigned long long key = GetGlslKey(compiled);
+    if (!gpCacheDir || !LoadGlslCache(gpCacheDir, key, &glsl))
+    {
+        if (!TranslateToGlsl(compiled, &glsl))
+        {
+            fprintf(stderr, "render: %s: %s\n", compiled.name.c_str(), glsl.error.c_str());
+            return NULL;
+        }
+        if (gpCacheDir)
+        {
+            StoreGlslCache(gpCacheDir, key, glsl);
+        }
+    }
+
+    GLuint program = LinkProgram(glsl, compiled.name);
+    if (!program)
+    {
+        return NULL;
+    }
+
+    // the block and the samplers are bound once, here
+    GLuint block = glGetUniformBlockIndex(program, "Uniforms");
+    if (block != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(program, block, 0);
+    }
+    glUseProgram(program);
+    gpBoundPipeline = NULL;
+
+    GlPipeline* pipeline = new GlPipeline;
+    *(RenderPipeline*)pipeline = compiled;
+    pipeline->program = program;
+    for (size_t s = 0; s < compiled.layout.samplers.size(); ++s)
+    {
+        char name[32];
+        sprintf(name, "gSampler%d", (int)s);
+        glUniform1i(glGetUniformLocation(program, name), (int)s);
+        pipeline->samplerTargets[s] = compiled.layout.samplers[s].cube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    }
+    return pipeline;
+}
+
+static void ReleasePipeline(RenderPipeline* pipeline)
+{
+    GlPipeline* gl = (GlPipeline*)pipeline;
+    if (gpBoundPipeline == gl)
+    {
+        gpBoundPipeline = NULL;
+    }
+    glDeleteProgram(gl->program);
+    delete gl;
+}
+
+//----------------------------------------------------------------------
+// backend
+//----------------------------------------------------------------------
+
+static bool CreateContext()
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    gDisplay = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL) :
+        eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (gDisplay == EGL_NO_DISPLAY || !eglInitialize(gDisplay, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API))
+    {
+        fprintf(stderr, "render: gl: no EGL display\n");
+        return false;
+    }
+
+    // nothing is drawn to a surface, but configs without one may not exist
+    const EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    const EGLint contextAttributes[] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(gDisplay, configAttributes, &config, 1, &numConfigs) || numConfigs < 1)
+    {
+        fprintf(stderr, "render: gl: no EGL config for OpenGL\n");
+        return false;
+    }
+
+    gContext = eglCreateContext(gDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+    if (gContext == EGL_NO_CONTEXT || !eglMakeCurrent(gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, gContext))
+    {
+        fprintf(stderr, "render: gl: no OpenGL 3.3 core context without a surface\n");
+        return false;
+    }
+    return true;
+}
+
+static bool HasExtension(const char* name)
+{
+    GLint numExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+    for (GLint i = 0; i < numExtensions; ++i)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension && strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the rings of every frame in one buffer, mapped for good if the driver
+// has GL_ARB_buffer_storage, otherwise one frame's, copied into.
+// llvmpipe draws slower from a mapped buffer than the copy costs, so it
+// gets the copy unless GL_UNIFORMS says otherwise
+static void CreateUniformRing()
+{
+    const char* uniforms = getenv(GL_UNIFORMS_ENV);
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    bool copied = renderer && strstr(renderer, GL_COPY_UNIFORMS_RENDERER);
+    if (uniforms)
+    {
+        copied = strcmp(uniforms, "mapped") != 0;
+    }
+
+    GLint alignment = 16;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    gUniformAlignment = (alignment > 16) ? alignment / 4 : 4;
+    gUniformsBegin = 0;
+    gUniformsUsed = 0;
+    gUniformsUploaded = 0;
+    for (int i = 0; i < GL_UNIFORM_FRAMES; ++i)
+    {
+        gUniformFences[i] = NULL;
+    }
+
+    glGenBuffers(1, &gUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, gUniformBuffer);
+
+    PFNGLBUFFERSTORAGEPROC bufferStorage = (!copied && HasExtension("GL_ARB_buffer_storage")) ?
+        (PFNGLBUFFERSTORAGEPROC)eglGetProcAddress("glBufferStorage") : NULL;
+    if (bufferStorage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLsizeiptr size = (GLsizeiptr)GL_UNIFORM_FRAMES * GL_UNIFORM_RING * sizeof(float);
+        bufferStorage(GL_UNIFORM_BUFFER, size, NULL, flags);
+        gpMappedUniforms = (float*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+    }
+    if (!gpMappedUniforms)
+    {
+        if (bufferStorage)
+        {
+            glDeleteBuffers(1, &gUniformBuffer);
+            glGenBuffers(1, &gUniformBuffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, gUniformBuffer);
+        }
+        gUniforms.resize(GL_UNIFORM_RING);
+        glBufferData(GL_UNIFORM_BUFFER, GL_UNIFORM_RING * sizeof(float), NULL, GL_STREAM_DRAW);
+    }
+}
+
+static void Release();
+
+static bool Init(int width, int height)
+{
+    if (!CreateContext())
+    {
+        Release();
+        return false;
+    }
+
+    gpCacheDir = getenv(GLSL_CACHE_ENV);
+
+    gpFrame = (GlTexture*)CreateTarget(width, height, RENDER_FORMAT_RGBA8);
+    const unsigned char white[6 * 4] =
+    {
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+    };
+    gpWhite = (GlTexture*)CreateTexture(1, 1, false, white);
+    gpWhiteCube = (GlTexture*)CreateTexture(1, 1, true, white);
+    if (!gpFrame)
+    {
+        Release();
+        return false;
+    }
+
+    CreateUniformRing();
+
+    glGenBuffers(GL_READBACK_FRAMES, gReadBuffers);
+    glGenQueries(GL_READBACK_FRAMES, gPixelQueries);
+    for (int i = 0; i < GL_READBACK_FRAMES; ++i)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, gReadBuffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ);
+        gReadFences[i] = NULL;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    gFrameCount = 0;
+
+    // D3D9's defaults: counterclockwise triangles culled, depth tested
+    // and written. the shaders flip y, so those are OpenGL's clockwise.
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    glFrontFace(GL_CCW);
+    glCullFace(GL_BACK);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_TRUE);
+    gStates.cull = RENDER_CULL_CCW;
+    gStates.depthTest = true;
+    gStates.depthWrite = true;
+    gpBoundPipeline = NULL;
+
+    memset(&gStats, 0, sizeof(gStats));
+    return true;
+}
+
+static void Release()
+{
+    if (gContext != EGL_NO_CONTEXT)
+    {
+        for (int i = 0; i < GL_READBACK_FRAMES; ++i)
+        {
+            if (gReadFences[i])
+            {
+                glDeleteSync(gReadFences[i]);
+                gReadFences[i] = NULL;
+            }
+        }
+        for (int i = 0; i < GL_UNIFORM_FRAMES; ++i)
+        {
+            if (gUniformFences[i])
+            {
+                glDeleteSync(gUniformFences[i]);
+                gUniformFences[i] = NULL;
+            }
+        }
+        glDeleteQueries(GL_READBACK_FRAMES, gPixelQueries);
+        glDeleteBuffers(GL_READBACK_FRAMES, gReadBuffers);
+        if (gpMappedUniforms)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, gUniformBuffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            gpMappedUniforms = NULL;
+        }
+        glDeleteBuffers(1, &gUniformBuffer);
+        gUniformBuffer = 0;
+
+        GlTexture** textures[] = { &gpFrame, &gpWhite, &gpWhiteCube };
+        for (size_t i = 0; i < sizeof(textures) / sizeof(textures[0]); ++i)
+        {
+            if (*textures[i])
+            {
+                ReleaseTexture(*textures[i]);
+                *textures[i] = NULL;
+            }
+        }
+
+        eglMakeCurrent(gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(gDisplay, gContext);
+        gContext = EGL_NO_CONTEXT;
+    }
+    if (gDisplay != EGL_NO_DISPLAY)
+    {
+        eglTerminate(gDisplay);
+        gDisplay = EGL_NO_DISPLAY;
+    }
+    gUniforms.clear();
+    gpBoundPipeline = NULL;
+}
+
+static void BeginFrame()
+{
+    if (gpMappedUniforms)
+    {
+        // the ring was last read by the draws of GL_UNIFORM_FRAMES frames ago
+        int ring = gFrameCount % GL_UNIFORM_FRAMES;
+        if (gUniformFences[ring])
+        {
+            glClientWaitSync(gUniformFences[ring], GL_SYNC_FLUSH_COMMANDS_BIT, GL_WAIT_FOREVER);
+            glDeleteSync(gUniformFences[ring]);
+            gUniformFences[ring] = NULL;
+        }
+        gUniformsBegin = ring * GL_UNIFORM_RING;
+    }
+    else
+    {
+        // the driver gives the buffer new memory if the last frame's
+        // draws still read the old
+        glBindBuffer(GL_UNIFORM_BUFFER, gUniformBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, GL_UNIFORM_RING * sizeof(float), NULL, GL_STREAM_DRAW);
+    }
+    gUniformsUsed = gUniformsBegin;
+    gUniformsUploaded = gUniformsBegin;
+
+    memset(&gStats, 0, sizeof(gStats));
+    glBeginQuery(GL_SAMPLES_PASSED, gPixelQueries[gFrameCount % GL_READBACK_FRAMES]);
+}
+
+// every range starts where a uniform buffer binding may
+static float* AllocateUniforms(int size, int* offset)
+{
+    int start = (gUniformsUsed + gUniformAlignment - 1) / gUniformAlignment * gUniformAlignment;
+    if (start + size > gUniformsBegin + GL_UNIFORM_RING)
+    {
+        return NULL;
+    }
+    *offset = start;
+    gUniformsUsed = start + size;
+    return gpMappedUniforms ? gpMappedUniforms + start : &gUniforms[start];
+}
+
+static void BeginPass(RenderTexture* target, const float* clearColor, bool clearDepth)
+{
+    GlTexture* texture = target ? (GlTexture*)target : gpFrame;
+    glBindFramebuffer(GL_FRAMEBUFFER, texture->framebuffer);
+    glViewport(0, 0, texture->width, texture->height);
+
+    GLbitfield clear = 0;
+    if (clearColor)
+    {
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        clear |= GL_COLOR_BUFFER_BIT;
+    }
+    if (clearDepth)
+    {
+        if (!gStates.depthWrite)
+        {
+            glDepthMask(GL_TRUE);
+            gStates.depthWrite = true;
+        }
+        glClearDepth(1.0);
+        clear |= GL_DEPTH_BUFFER_BIT;
+    }
+    if (clear)
+    {
+        glClear(clear);
+    }
+    ++gStats.passes;
+}
+
+static void SetStates(const RenderStates& states)
+{
+    if (states.cull != gStates.cull)
+    {
+        if (states.cull == RENDER_CULL_NONE)
+        {
+            glDisable(GL_CULL_FACE);
+        }
+        else
+        {
+            glEnable(GL_CULL_FACE);
+            glCullFace((states.cull == RENDER_CULL_CCW) ? GL_BACK : GL_FRONT);
+        }
+    }
+    if (states.depthTest != gStates.depthTest)
+    {
+        if (states.depthTest)
+        {
+            glEnable(GL_DEPTH_TEST);
+        }
+        else
+        {
+            glDisable(GL_DEPTH_TEST);
+        }
+    }
+    if (states.depthWrite != gStates.depthWrite)
+    {
+        glDepthMask(states.depthWrite ? GL_TRUE : GL_FALSE);
+    }
+    gStates = states;
+}
+
+static void Draw(const RenderDraw& draw)
+{
+    const GlPipeline* pipeline = (const GlPipeline*)draw.pipeline;
+    const GlMesh* mesh = (const GlMesh*)draw.mesh;
+    const RenderLayout& layout = pipeline->layout;
+
+    if (pipeline != gpBoundPipeline)
+    {
+        glUseProgram(pipeline->program);
+        gpBoundPipeline = pipeline;
+    }
+    SetStates(pipeline->states);
+
+    for (size_t s = 0; s < layout.samplers.size(); ++s)
+    {
+        GLenum target = pipeline->samplerTargets[s];
+        const GlTexture* texture = (const GlTexture*)draw.textures[s];
+        if (!texture || texture->cube != (target == GL_TEXTURE_CUBE_MAP))
+        {
+            texture = (target == GL_TEXTURE_CUBE_MAP) ? gpWhiteCube : gpWhite;
+        }
+        glActiveTexture(GL_TEXTURE0 + (GLenum)s);
+        glBindTexture(target, texture->texture);
+    }
+
+    if (layout.size > 0)
+    {
+        if (draw.uniforms < gUniformsBegin || draw.uniforms + layout.size > gUniformsUsed)
+        {
+            return;
+        }
+        if (!gpMappedUniforms && gUniformsUploaded < gUniformsUsed)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, gUniformBuffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, gUniformsUploaded * sizeof(float),
+                (gUniformsUsed - gUniformsUploaded) * sizeof(float), &gUniforms[gUniformsUploaded]);
+            gUniformsUploaded = gUniformsUsed;
+        }
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, gUniformBuffer, draw.uniforms * sizeof(float),
+            layout.size * sizeof(float));
+    }
+
+    glBindVertexArray(mesh->vertexArray);
+    glDrawElements(GL_TRIANGLES, mesh->numIndices, GL_UNSIGNED_INT, NULL);
+
+    ++gStats.draws;
+    gStats.triangles += mesh->numIndices / 3;
+    gStats.uniformBytes += layout.size * sizeof(float);
+}
+
+static void EndPass()
+{
+}
+
+// the frame is copied into this frame's pixel buffer without waiting;
+// the previous frame's copy is waited for, so one frame is in flight
+static void EndFrame()
+{
+    int slot = gFrameCount % GL_READBACK_FRAMES;
+    glEndQuery(GL_SAMPLES_PASSED);
+
+    if (gpMappedUniforms)
+    {
+        gUniformFences[gFrameCount % GL_UNIFORM_FRAMES] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, gpFrame->framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, gReadBuffers[slot]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, gpFrame->width, gpFrame->height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (gReadFences[slot])
+    {
+        glDeleteSync(gReadFences[slot]);
+    }
+    gReadFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    int previous = (gFrameCount + GL_READBACK_FRAMES - 1) % GL_READBACK_FRAMES;
+    if (gFrameCount > 0 && gReadFences[previous])
+    {
+        glClientWaitSync(gReadFences[previous], GL_SYNC_FLUSH_COMMANDS_BIT, GL_WAIT_FOREVER);
+    }
+    ++gFrameCount;
+}
+
+// rows come out top first, as the shaders draw upside down
+static bool ReadFrame(unsigned char* rgba)
+{
+    if (gFrameCount == 0)
+    {
+        return false;
+    }
+
+    int slot = (gFrameCount - 1) % GL_READBACK_FRAMES;
+    glClientWaitSync(gReadFences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, GL_WAIT_FOREVER);
+
+    size_t size = (size_t)gpFrame->width * gpFrame->height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, gReadBuffers[slot]);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (pixels)
+    {
+        memcpy(rgba, pixels, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return pixels != NULL;
+}
+
+// the pixels are the last ended frame's, waited for
+static RenderStats GetStats()
+{
+    if (gFrameCount > 0)
+    {
+        GLuint64 samples = 0;
+        glGetQueryObjectui64v(gPixelQueries[(gFrameCount - 1) % GL_READBACK_FRAMES], GL_QUERY_RESULT, &samples);
+        gStats.pixels = (long long)samples;
+    }
+    return gStats;
+}
+
+const RenderBackend* GetGlRenderBackend()
+{
+    static const RenderBackend backend =
+    {
+        "gl",
+        Init,
+        Release,
+        CreateMesh,
+        CreateTexture,
+        CreateTarget,
+        CreatePipeline,
+        ReleaseMesh,
+        ReleaseTexture,
+        ReleasePipeline,
+        BeginFrame,
+        AllocateUniforms,
+        BeginPass,
+        Draw,
+        EndPass,
+        EndFrame,
+        ReadFrame,
+        GetStats
+    };
+    return &backend;
+}
+
+#endif
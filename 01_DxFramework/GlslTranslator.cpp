@@ -0,0 +1,788 @@
+//**********************************************************************
+//
+// GlslTranslator.cpp
+//
+// Translates the interpreter's bytecode of a pipeline into GLSL 3.30
+// and keeps the translations in a cache directory.
+//
+//**********************************************************************
+
+#include "GlslTranslator.h"
+#include "FileUtil.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <functional>
+#include <thread>
+
+#ifndef _WIN32
+#define _snprintf snprintf
+#endif
+
+// the semantics vertex shaders read, at their locations; as many as
+// OpenGL 3.3 promises
+static const char* gAttributes[] =
+{
+    "POSITION0",
+    "NORMAL0",
+    "TEXCOORD0",
+    "TANGENT0",
+    "BINORMAL0",
+    "COLOR0",
+    "COLOR1",
+    "TEXCOORD1",
+    "TEXCOORD2",
+    "TEXCOORD3",
+    "TEXCOORD4",
+    "TEXCOORD5",
+    "TEXCOORD6",
+    "TEXCOORD7",
+    "BLENDWEIGHT0",
+    "BLENDINDICES0"
+};
+
+#define NUM_ATTRIBUTES (sizeof(gAttributes) / sizeof(gAttributes[0]))
+
+static std::string Format(const char* format, int value)
+{
+    char text[64];
+    _snprintf(text, sizeof(text), format, value);
+    return text;
+}
+
+// TEXCOORD and TEXCOORD0 are the same
+static std::string NormalizeSemantic(const std::string& semantic)
+{
+    std::string normalized;
+    for (size_t i = 0; i < semantic.size(); ++i)
+    {
+        normalized += (char)toupper((unsigned char)semantic[i]);
+    }
+    if (!normalized.empty() && !isdigit((unsigned char)normalized[normalized.size() - 1]))
+    {
+        normalized += '0';
+    }
+    return normalized;
+}
+
+int GetGlslAttributeLocation(const std::string& semantic)
+{
+    std::string normalized = NormalizeSemantic(semantic);
+    for (size_t i = 0; i < NUM_ATTRIBUTES; ++i)
+    {
+        if (normalized == gAttributes[i])
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static const ShaderVariable* FindVariable(const std::vector<ShaderVariable>& variables, const std::string& semantic)
+{
+    for (size_t i = 0; i < variables.size(); ++i)
+    {
+        if (NormalizeSemantic(variables[i].semantic) == semantic)
+        {
+            return &variables[i];
+        }
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// hashing
+//----------------------------------------------------------------------
+
+static unsigned long long Mix(unsigned long long k)
+{
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDULL;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// as AssetRegistry hashes files
+static unsigned long long HashBytes(const unsigned char* data, size_t size)
+{
+    unsigned long long h = 0x9E3779B97F4A7C15ULL ^ size ^ ((unsigned long long)GLSL_TRANSLATOR_VERSION << 32);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        unsigned long long word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ Mix(word)) * 0x100000001B3ULL;
+    }
+
+    unsigned long long tail = 0;
+    for (size_t j = 0; i + j < size; ++j)
+    {
+        tail |= (unsigned long long)data[i + j] << (8 * j);
+    }
+
+    return Mix(h ^ Mix(tail));
+}
+
+static void AppendBytes(std::string* key, const void* data, size_t size)
+{
+    key->append((const char*)data, size);
+}
+
+static void AppendInt(std::string* key, int value)
+{
+    AppendBytes(key, &value, sizeof(value));
+}
+
+static void AppendString(std::string* key, const std::string& text)
+{
+    AppendInt(key, (int)text.size());
+    key->append(text);
+}
+
+static void AppendVariables(std::string* key, const std::vector<ShaderVariable>& variables)
+{
+    AppendInt(key, (int)variables.size());
+    for (size_t i = 0; i < variables.size(); ++i)
+    {
+        const ShaderVariable& variable = variables[i];
+        AppendString(key, variable.name);
+        AppendString(key, variable.semantic);
+        AppendInt(key, variable.rows);
+        AppendInt(key, variable.columns);
+        AppendInt(key, (int)variable.registers.size());
+        AppendBytes(key, variable.registers.data(), variable.registers.size() * sizeof(int));
+    }
+}
+
+static void AppendSamplers(std::string* key, const std::vector<ShaderSampler>& samplers)
+{
+    AppendInt(key, (int)samplers.size());
+    for (size_t i = 0; i < samplers.size(); ++i)
+    {
+        AppendString(key, samplers[i].name);
+        AppendString(key, samplers[i].texture);
+        AppendInt(key, samplers[i].cube ? 1 : 0);
+    }
+}
+
+static void AppendProgram(std::string* key, const ShaderProgram& program)
+{
+    AppendInt(key, (int)program.code.size());
+    AppendBytes(key, program.code.data(), program.code.size() * sizeof(ShaderInstruction));
+    AppendInt(key, program.registerCount);
+    AppendInt(key, program.constantRegister);
+    AppendInt(key, (int)program.constants.size());
+    AppendBytes(key, program.constants.data(), program.constants.size() * sizeof(float));
+    AppendVariables(key, program.uniforms);
+    AppendVariables(key, program.inputs);
+    AppendVariables(key, program.outputs);
+    AppendSamplers(key, program.samplers);
+}
+
+unsigned long long GetGlslKey(const RenderPipeline& pipeline)
+{
+    std::string key;
+    AppendProgram(&key, pipeline.vertexShader);
+    AppendProgram(&key, pipeline.pixelShader);
+
+    const RenderLayout& layout = pipeline.layout;
+    AppendInt(&key, layout.size);
+    AppendInt(&key, (int)layout.uniforms.size());
+    for (size_t i = 0; i < layout.uniforms.size(); ++i)
+    {
+        AppendString(&key, layout.uniforms[i].name);
+        AppendInt(&key, layout.uniforms[i].offset);
+        AppendInt(&key, layout.uniforms[i].rows);
+        AppendInt(&key, layout.uniforms[i].columns);
+    }
+    AppendSamplers(&key, layout.samplers);
+
+    return HashBytes((const unsigned char*)key.data(), key.size());
+}
+
+//----------------------------------------------------------------------
+// shaders
+//----------------------------------------------------------------------
+
+static std::string FloatLiteral(float value)
+{
+    if (value != value)
+    {
+        return "uintBitsToFloat(0x7FC00000u)";
+    }
+    if (value > 3.4e38f || value < -3.4e38f)
+    {
+        return (value > 0.0f) ? "uintBitsToFloat(0x7F800000u)" : "uintBitsToFloat(0xFF800000u)";
+    }
+
+    char text[64];
+    _snprintf(text, sizeof(text), "%.9g", value);
+    std::string literal = text;
+    if (literal.find_first_of(".e") == std::string::npos)
+    {
+        literal += ".0";
+    }
+    return (literal[0] == '-') ? "(" + literal + ")" : literal;
+}
+
+// one shader's main being written. a register is read as what it held
+// when the shader started, an input, uniform or constant, until it is
+// first written; from then on it is a float of its own.
+struct GlslWriter
+{
+    const ShaderProgram* program;
+    std::vector<std::string> initial;   // of each register, "" for none
+    std::vector<bool> declared;
+    std::string text;
+    int depth;
+};
+
+static std::string Operand(const GlslWriter& writer, int reg)
+{
+    if (writer.declared[reg])
+    {
+        return Format("r%d", reg);
+    }
+    if (reg >= writer.program->constantRegister)
+    {
+        return FloatLiteral(writer.program->constants[reg - writer.program->constantRegister]);
+    }
+    return writer.initial[reg].empty() ? "0.0" : writer.initial[reg];
+}
+
+static std::string Indent(const GlslWriter& writer)
+{
+    return std::string(4 * (writer.depth + 1), ' ');
+}
+
+static void WriteRegister(GlslWriter* writer, int reg, const std::string& expression)
+{
+    writer->text += Indent(*writer) + (writer->declared[reg] ? "" : "float ") + Format("r%d = ", reg) +
+        expression + ";\n";
+    writer->declared[reg] = true;
+}
+
+// the value instruction computes, from its operands
+static std::string Expression(const GlslWriter& writer, const ShaderInstruction& instruction)
+{
+    int sources = GetShaderOpSources(instruction.op);
+    std::string a = Operand(writer, instruction.a);
+    std::string b = (sources >= 2) ? Operand(writer, instruction.b) : "";
+    std::string c = (sources >= 3) ? Operand(writer, instruction.c) : "";
+
+    switch (instruction.op)
+    {
+    case SHADER_OP_MOV:     return a;
+    case SHADER_OP_ADD:     return a + " + " + b;
+    case SHADER_OP_SUB:     return a + " - " + b;
+    case SHADER_OP_MUL:     return a + " * " + b;
+    case SHADER_OP_DIV:     return a + " / " + b;
+    case SHADER_OP_MAD:     return a + " * " + b + " + " + c;
+    case SHADER_OP_MIN:     return "min(" + a + ", " + b + ")";
+    case SHADER_OP_MAX:     return "max(" + a + ", " + b + ")";
+    case SHADER_OP_NEG:     return "-" + a;
+    case SHADER_OP_ABS:     return "abs(" + a + ")";
+    case SHADER_OP_SAT:     return "clamp(" + a + ", 0.0, 1.0)";
+    case SHADER_OP_FLOOR:   return "floor(" + a + ")";
+    case SHADER_OP_CEIL:    return "ceil(" + a + ")";
+    case SHADER_OP_FRAC:    return "fract(" + a + ")";
+    case SHADER_OP_SQRT:    return "sqrt(" + a + ")";
+    case SHADER_OP_RSQ:     return "inversesqrt(" + a + ")";
+    case SHADER_OP_RCP:     return "1.0 / " + a;
+    case SHADER_OP_EXP:     return "exp(" + a + ")";
+    case SHADER_OP_LOG:     return "log(" + a + ")";
+    case SHADER_OP_POW:     return "pow(" + a + ", " + b + ")";
+    case SHADER_OP_SIN:     return "sin(" + a + ")";
+    case SHADER_OP_COS:     return "cos(" + a + ")";
+    case SHADER_OP_LT:      return "float(" + a + " < " + b + ")";
+    case SHADER_OP_LE:      return "float(" + a + " <= " + b + ")";
+    case SHADER_OP_EQ:      return "float(" + a + " == " + b + ")";
+    case SHADER_OP_NE:      return "float(" + a + " != " + b + ")";
+    case SHADER_OP_AND:     return "float(" + a + " != 0.0 && " + b + " != 0.0)";
+    case SHADER_OP_OR:      return "float(" + a + " != 0.0 || " + b + " != 0.0)";
+    case SHADER_OP_NOT:     return "float(" + a + " == 0.0)";
+    case SHADER_OP_SEL:     return "(" + a + " != 0.0) ? " + b + " : " + c;
+    default:                return "0.0";
+    }
+}
+
+// the instructions of writer's program into writer->text. samplerUnits
+// is the texture unit of each of the program's samplers.
+static void WriteCode(GlslWriter* writer, const std::vector<int>& samplerUnits)
+{
+    const std::vector<ShaderInstruction>& code = writer->program->code;
+
+    // the skips that nest become ifs; one that does not is dropped, which
+    // costs time but changes nothing, as the lanes it skips are not used
+    std::vector<bool> opens(code.size(), false);
+    std::vector<int> closes(code.size() + 1, 0);
+    std::vector<int> depths(code.size(), 0);
+    std::vector<int> ends;
+    for (size_t i = 0; i <= code.size(); ++i)
+    {
+        while (!ends.empty() && ends.back() == (int)i)
+        {
+            ends.pop_back();
+            ++closes[i];
+        }
+        if (i == code.size())
+        {
+            break;
+        }
+        depths[i] = (int)ends.size();
+        if (code[i].op == SHADER_OP_SKIP && code[i].dst > i + 1 && (ends.empty() || code[i].dst <= ends.back()))
+        {
+            opens[i] = true;
+            ends.push_back(code[i].dst);
+        }
+    }
+
+    // what is written in an if is declared before it
+    std::vector<bool> inside(writer->program->registerCount, false);
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        int written = (code[i].op == SHADER_OP_SKIP) ? 0 :
+            (code[i].op == SHADER_OP_TEX2D || code[i].op == SHADER_OP_TEXCUBE) ? 4 : 1;
+        for (int w = 0; w < written && depths[i] > 0; ++w)
+        {
+            inside[code[i].dst + w] = true;
+        }
+    }
+    for (int r = 0; r < writer->program->registerCount; ++r)
+    {
+        if (inside[r])
+        {
+            WriteRegister(writer, r, Operand(*writer, r));
+        }
+    }
+
+    for (size_t i = 0; i <= code.size(); ++i)
+    {
+        for (int c = 0; c < closes[i]; ++c)
+        {
+            --writer->depth;
+            writer->text += Indent(*writer) + "}\n";
+        }
+        if (i == code.size())
+        {
+            break;
+        }
+
+        const ShaderInstruction& instruction = code[i];
+        if (instruction.op == SHADER_OP_SKIP)
+        {
+            if (opens[i])
+            {
+                writer->text += Indent(*writer) + "if (" + Operand(*writer, instruction.a) + " != 0.0)\n" +
+                    Indent(*writer) + "{\n";
+                ++writer->depth;
+            }
+        }
+        else if (instruction.op == SHADER_OP_TEX2D || instruction.op == SHADER_OP_TEXCUBE)
+        {
+            bool cube = (instruction.op == SHADER_OP_TEXCUBE);
+            std::string texel = Format("t%d", (int)i);
+            writer->text += Indent(*writer) + "vec4 " + texel + Format(" = texture(gSampler%d, ",
+                samplerUnits[instruction.sampler]) + (cube ? "vec3(" : "vec2(") + Operand(*writer, instruction.a) +
+                ", " + Operand(*writer, instruction.b) + (cube ? ", " + Operand(*writer, instruction.c) : "") + "));\n";
+            for (int w = 0; w < 4; ++w)
+            {
+                WriteRegister(writer, instruction.dst + w, texel + "." + "xyzw"[w]);
+            }
+        }
+        else
+        {
+            WriteRegister(writer, instruction.dst, Expression(*writer, instruction));
+        }
+    }
+}
+
+// "vec4(a, b, c, d)" of the variable's components, what is missing as
+// in a vertex, or one of them
+static std::string Vector(const GlslWriter& writer, const ShaderVariable& variable)
+{
+    std::string components[4] = { "0.0", "0.0", "0.0", "1.0" };
+    for (size_t c = 0; c < variable.registers.size() && c < 4; ++c)
+    {
+        components[c] = Operand(writer, variable.registers[c]);
+    }
+    return "vec4(" + components[0] + ", " + components[1] + ", " + components[2] + ", " + components[3] + ")";
+}
+
+static std::string Header(const RenderPipeline& pipeline, const ShaderProgram& program, const char* stage)
+{
+    std::string text = "#version 330 core\n\n";
+    text += "// " + pipeline.name + ", " + stage + " shader " + program.function + "\n\n";
+    if (pipeline.layout.size > 0)
+    {
+        text += "layout(std140) uniform Uniforms\n{\n" + Format("    vec4 gUniforms[%d];\n};\n\n",
+            pipeline.layout.size / 4);
+    }
+    for (size_t s = 0; s < pipeline.layout.samplers.size(); ++s)
+    {
+        text += (pipeline.layout.samplers[s].cube ? "uniform samplerCube " : "uniform sampler2D ") +
+            Format("gSampler%d;\n", (int)s);
+    }
+    return text;
+}
+
+// registers of the program's uniforms read from the block, and the
+// texture unit of each of its samplers
+static void BindLayout(const RenderLayout& layout, GlslWriter* writer, std::vector<int>* samplerUnits)
+{
+    const ShaderProgram& program = *writer->program;
+    for (size_t u = 0; u < program.uniforms.size(); ++u)
+    {
+        const ShaderVariable& variable = program.uniforms[u];
+        int offset = -1;
+        for (size_t i = 0; i < layout.uniforms.size(); ++i)
+        {
+            offset = (layout.uniforms[i].name == variable.name) ? layout.uniforms[i].offset : offset;
+        }
+
+        for (size_t r = 0; r < variable.registers.size() && offset >= 0; ++r)
+        {
+            int at = offset + (int)r / variable.columns * 4 + (int)r % variable.columns;
+            writer->initial[variable.registers[r]] = Format("gUniforms[%d].", at / 4) + "xyzw"[at % 4];
+        }
+    }
+
+    for (size_t s = 0; s < program.samplers.size(); ++s)
+    {
+        int unit = 0;
+        for (size_t i = 0; i < layout.samplers.size(); ++i)
+        {
+            unit = (layout.samplers[i].name == program.samplers[s].name) ? (int)i : unit;
+        }
+        samplerUnits->push_back(unit);
+    }
+}
+
+static void InitWriter(const ShaderProgram& program, GlslWriter* writer)
+{
+    writer->program = &program;
+    writer->initial.assign(program.registerCount, "");
+    writer->declared.assign(program.registerCount, false);
+    writer->text.clear();
+    writer->depth = 0;
+}
+
+// the name of the varying with a vertex shader output's semantic, and
+// how it is declared
+static std::string VaryingType(const ShaderVariable& output)
+{
+    return (output.registers.size() > 4) ? "float" : "vec4";
+}
+
+static std::string VaryingSize(const ShaderVariable& output)
+{
+    return (output.registers.size() > 4) ? Format("[%d]", (int)output.registers.size()) : "";
+}
+
+static bool TranslateVertexShader(const RenderPipeline& pipeline, GlslProgram* glsl)
+{
+    const ShaderProgram& program = pipeline.vertexShader;
+    GlslWriter writer;
+    InitWriter(program, &writer);
+    std::vector<int> samplerUnits;
+    BindLayout(pipeline.layout, &writer, &samplerUnits);
+
+    std::string text = Header(pipeline, program, "vertex");
+    text += "\n";
+    for (size_t i = 0; i < program.inputs.size(); ++i)
+    {
+        const ShaderVariable& input = program.inputs[i];
+        std::string semantic = NormalizeSemantic(input.semantic);
+        int location = GetGlslAttributeLocation(semantic);
+        if (input.registers.size() > 4 || location < 0)
+        {
+            glsl->error = "input " + input.name + ((location < 0) ? " has no attribute location for " + semantic :
+                " has more than four components");
+            return false;
+        }
+        text += Format("layout(location = %d) in vec4 a", location) + semantic + ";\n";
+        for (size_t c = 0; c < input.registers.size(); ++c)
+        {
+            writer.initial[input.registers[c]] = "a" + semantic + "." + "xyzw"[c];
+        }
+        glsl->attributes.push_back(semantic);
+    }
+
+    const ShaderVariable* position = FindVariable(program.outputs, "POSITION0");
+    if (!position || position->registers.size() != 4)
+    {
+        glsl->error = "the vertex shader writes no float4 POSITION";
+        return false;
+    }
+    text += "\n";
+    for (size_t i = 0; i < program.outputs.size(); ++i)
+    {
+        const ShaderVariable& output = program.outputs[i];
+        if (&output != position)
+        {
+            text += "out " + VaryingType(output) + " v" + NormalizeSemantic(output.semantic) +
+                VaryingSize(output) + ";\n";
+        }
+    }
+
+    WriteCode(&writer, samplerUnits);
+
+    text += "\nvoid main()\n{\n" + writer.text;
+    text += "    gl_Position = vec4(" + Operand(writer, position->registers[0]) + ", -" +
+        Operand(writer, position->registers[1]) + ", 2.0 * " + Operand(writer, position->registers[2]) + " - " +
+        Operand(writer, position->registers[3]) + ", " + Operand(writer, position->registers[3]) + ");\n";
+    for (size_t i = 0; i < program.outputs.size(); ++i)
+    {
+        const ShaderVariable& output = program.outputs[i];
+        std::string name = "v" + NormalizeSemantic(output.semantic);
+        if (&output == position)
+        {
+        }
+        else if (output.registers.size() > 4)
+        {
+            for (size_t c = 0; c < output.registers.size(); ++c)
+            {
+                text += "    " + name + Format("[%d] = ", (int)c) + Operand(writer, output.registers[c]) + ";\n";
+            }
+        }
+        else
+        {
+            text += "    " + name + " = " + Vector(writer, output) + ";\n";
+        }
+    }
+    text += "}\n";
+
+    glsl->vertexSource = text;
+    return true;
+}
+
+static bool TranslatePixelShader(const RenderPipeline& pipeline, GlslProgram* glsl)
+{
+    const ShaderProgram& program = pipeline.pixelShader;
+    GlslWriter writer;
+    InitWriter(program, &writer);
+    std::vector<int> samplerUnits;
+    BindLayout(pipeline.layout, &writer, &samplerUnits);
+
+    // the inputs the vertex shader does not write are zero
+    std::string text = Header(pipeline, program, "pixel");
+    text += "\n";
+    for (size_t i = 0; i < program.inputs.size(); ++i)
+    {
+        const ShaderVariable& input = program.inputs[i];
+        std::string semantic = NormalizeSemantic(input.semantic);
+        const ShaderVariable* from = FindVariable(pipeline.vertexShader.outputs, semantic);
+        if (!from || semantic == "POSITION0")
+        {
+            continue;
+        }
+        text += "in " + VaryingType(*from) + " v" + semantic + VaryingSize(*from) + ";\n";
+        for (size_t c = 0; c < input.registers.size() && c < from->registers.size(); ++c)
+        {
+            writer.initial[input.registers[c]] = "v" + semantic +
+                ((from->registers.size() > 4) ? Format("[%d]", (int)c) : std::string(".") + "xyzw"[c]);
+        }
+    }
+
+    text += "\n";
+    bool color = false;
+    for (size_t i = 0; i < program.outputs.size(); ++i)
+    {
+        std::string semantic = NormalizeSemantic(program.outputs[i].semantic);
+        if (semantic.compare(0, 5, "COLOR") == 0)
+        {
+            text += "layout(location = " + semantic.substr(5) + ") out vec4 o" + semantic + ";\n";
+            color = color || semantic == "COLOR0";
+        }
+    }
+    if (!color)
+    {
+        glsl->error = "the pixel shader writes no COLOR";
+        return false;
+    }
+
+    WriteCode(&writer, samplerUnits);
+
+    text += "\nvoid main()\n{\n" + writer.text;
+    for (size_t i = 0; i < program.outputs.size(); ++i)
+    {
+        const ShaderVariable& output = program.outputs[i];
+        std::string semantic = NormalizeSemantic(output.semantic);
+        if (semantic.compare(0, 5, "COLOR") == 0)
+        {
+            text += "    o" + semantic + " = " + Vector(writer, output) + ";\n";
+        }
+        else if (semantic == "DEPTH0" && !output.registers.empty())
+        {
+            text += "    gl_FragDepth = " + Operand(writer, output.registers[0]) + ";\n";
+        }
+    }
+    text += "}\n";
+
+    glsl->pixelSource = text;
+    return true;
+}
+
+bool TranslateToGlsl(const RenderPipeline& pipeline, GlslProgram* glsl)
+{
+    glsl->name = pipeline.name;
+    glsl->vertexSource.clear();
+    glsl->pixelSource.clear();
+    glsl->attributes.clear();
+    glsl->samplers = pipeline.layout.samplers;
+    glsl->uniforms = pipeline.layout.uniforms;
+    glsl->uniformSize = pipeline.layout.size;
+    glsl->error.clear();
+
+    return TranslateVertexShader(pipeline, glsl) && TranslatePixelShader(pipeline, glsl);
+}
+
+//----------------------------------------------------------------------
+// cache
+//----------------------------------------------------------------------
+
+static std::string CachePath(const char* directory, unsigned long long key, const char* extension)
+{
+    char path[1024];
+    _snprintf(path, sizeof(path), "%s/%016llx.%s", directory, key, extension);
+    path[sizeof(path) - 1] = '\0';
+    return path;
+}
+
+static bool ReadText(const std::string& filename, std::string* text)
+{
+    size_t size = 0;
+    unsigned char* data = ReadWholeFile(filename.c_str(), &size);
+    if (!data)
+    {
+        return false;
+    }
+    text->assign((const char*)data, size);
+    delete[] data;
+    return true;
+}
+
+// written beside it first, then renamed, so a reader never sees half of
+// it; another process may have published the same entry first
+static bool WriteCacheFile(const std::string& filename, const std::string& text)
+{
+    char suffix[32];
+    _snprintf(suffix, sizeof(suffix), ".%08x.tmp",
+        (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::string temporary = filename + suffix;
+
+    FILE* fp = fopen(temporary.c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+    bool written = fwrite(text.data(), 1, text.size(), fp) == text.size();
+    written = fclose(fp) == 0 && written;
+
+    if (!written || rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        remove(temporary.c_str());
+    }
+    return written;
+}
+
+bool LoadGlslCache(const char* directory, unsigned long long key, GlslProgram* glsl)
+{
+    std::string reflection;
+    if (!ReadText(CachePath(directory, key, "txt"), &reflection) ||
+        !ReadText(CachePath(directory, key, "vert"), &glsl->vertexSource) ||
+        !ReadText(CachePath(directory, key, "frag"), &glsl->pixelSource))
+    {
+        return false;
+    }
+
+    glsl->name.clear();
+    glsl->attributes.clear();
+    glsl->samplers.clear();
+    glsl->uniforms.clear();
+    glsl->uniformSize = -1;
+    glsl->error.clear();
+
+    // a line each, a word saying what it is first
+    size_t begin = 0;
+    while (begin < reflection.size())
+    {
+        size_t end = reflection.find('\n', begin);
+        end = (end == std::string::npos) ? reflection.size() : end;
+        std::string line = reflection.substr(begin, end - begin);
+        begin = end + 1;
+
+        char word[256];
+        char text[256];
+        char type[16];
+        int a = 0;
+        int b = 0;
+        int c = 0;
+        if (line.compare(0, 5, "name ") == 0)
+        {
+            glsl->name = line.substr(5);
+        }
+        else if (sscanf(line.c_str(), "size %d", &a) == 1)
+        {
+            glsl->uniformSize = a;
+        }
+        else if (sscanf(line.c_str(), "uniform %255s %d %d %d", word, &a, &b, &c) == 4)
+        {
+            RenderUniform uniform;
+            uniform.name = word;
+            uniform.offset = a;
+            uniform.rows = b;
+            uniform.columns = c;
+            glsl->uniforms.push_back(uniform);
+        }
+        else if (sscanf(line.c_str(), "sampler %d %255s %255s %15s", &a, word, text, type) == 4 &&
+            a == (int)glsl->samplers.size())
+        {
+            ShaderSampler sampler;
+            sampler.name = word;
+            sampler.texture = (strcmp(text, "-") == 0) ? "" : text;
+            sampler.cube = (strcmp(type, "cube") == 0);
+            glsl->samplers.push_back(sampler);
+        }
+        else if (sscanf(line.c_str(), "attribute %d %255s", &a, word) == 2 && a == GetGlslAttributeLocation(word))
+        {
+            glsl->attributes.push_back(word);
+        }
+        else if (!line.empty() && line[0] != '/')
+        {
+            return false;
+        }
+    }
+    return glsl->uniformSize >= 0;
+}
+
+bool StoreGlslCache(const char* directory, unsigned long long key, const GlslProgram& glsl)
+{
+    std::string reflection = "// written by GlslTranslator; the uniforms are in floats, four to a vec4\n";
+    reflection += "name " + glsl.name + "\n";
+    reflection += Format("size %d\n", glsl.uniformSize);
+    for (size_t i = 0; i < glsl.uniforms.size(); ++i)
+    {
+        const RenderUniform& uniform = glsl.uniforms[i];
+        reflection += "uniform " + uniform.name + Format(" %d", uniform.offset) + Format(" %d", uniform.rows) +
+            Format(" %d\n", uniform.columns);
+    }
+    for (size_t i = 0; i < glsl.samplers.size(); ++i)
+    {
+        const ShaderSampler& sampler = glsl.samplers[i];
+        reflection += Format("sampler %d ", (int)i) + sampler.name + " " +
+            (sampler.texture.empty() ? "-" : sampler.texture) + (sampler.cube ? " cube\n" : " 2d\n");
+    }
+    for (size_t i = 0; i < glsl.attributes.size(); ++i)
+    {
+        reflection += Format("attribute %d ", GetGlslAttributeLocation(glsl.attributes[i])) + glsl.attributes[i] + "\n";
+    }
+
+    // the reflection last, as loading starts with it
+    return WriteCacheFile(CachePath(directory, key, "vert"), glsl.vertexSource) &&
+        WriteCacheFile(CachePath(directory, key, "frag"), glsl.pixelSource) &&
+        WriteCacheFile(CachePath(directory, key, "txt"), reflection);
+}
@@ -0,0 +1,74 @@
+//**********************************************************************
+//
+// GlslTranslator.h
+//
+// Translates a pipeline of the render backend (see RenderBackend.h), its
+// vertex and pixel shaders as the shader interpreter compiles them, into
+// GLSL 3.30, so an OpenGL backend runs the samples' effects without
+// D3DX. Every bytecode instruction becomes a line of GLSL over named
+// floats; the skips around an if become real branches.
+//
+// The uniforms of both shaders are one std140 block of float4s laid out
+// as RenderLayout lays them out, so the values a draw writes through
+// AllocateRenderUniforms go into a uniform buffer as they are, and a
+// pipeline's samplers are texture units in the layout's order. What a
+// translation needs at run time besides the sources, the uniform
+// offsets, the units and the attributes read, is kept with it. Every
+// semantic has a location of its own in every program, so a mesh's
+// vertex array is set up once whatever draws it.
+//
+// Positions are written with y negated and z from D3D9's 0..w to
+// OpenGL's -w..w: drawn that way, rows in memory are top first and the
+// depth buffer holds the same values as under D3D9.
+//
+// Translations are kept in a cache directory under a hash of what they
+// are translated from, so an effect that has not changed is not
+// translated again and the same pass in two samples is kept once.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include "RenderBackend.h"
+
+// ---------- constants ------------------------------------
+
+// part of every key; raise it when the GLSL written changes
+#define GLSL_TRANSLATOR_VERSION     2
+
+// environment variable naming the directory an OpenGL backend keeps its
+// translations in; none are kept if it is not set
+#define GLSL_CACHE_ENV              "GLSL_CACHE"
+
+// ---------- types ------------------------------------
+
+struct GlslProgram
+{
+    std::string name;                       // the pipeline's
+    std::string vertexSource;
+    std::string pixelSource;
+    std::vector<std::string> attributes;    // semantics read, e.g. TEXCOORD0
+    std::vector<ShaderSampler> samplers;    // at each texture unit, named gSampler0...
+    std::vector<RenderUniform> uniforms;    // in the block Uniforms, vec4 gUniforms[]
+    int uniformSize;                        // floats
+    std::string error;                      // why TranslateToGlsl failed
+};
+
+// ---------------- function prototype  ------------------------
+
+// where the attribute with semantic is in every program, or -1 for a
+// semantic there is no room for
+int GetGlslAttributeLocation(const std::string& semantic);
+
+// the cache key of pipeline: its shaders' bytecode and layout hashed
+unsigned long long GetGlslKey(const RenderPipeline& pipeline);
+
+// on failure glsl->error says why
+bool TranslateToGlsl(const RenderPipeline& pipeline, GlslProgram* glsl);
+
+// key.vert, key.frag and key.txt in directory, the last the rest of glsl
+bool LoadGlslCache(const char* directory, unsigned long long key, GlslProgram* glsl);
+
+// the directory must exist
+bool StoreGlslCache(const char* directory, unsigned long long key, const GlslProgram& glsl);
@@ -0,0 +1,271 @@
+//**********************************************************************
+//
+// GoldenTest.cpp
+//
+// Golden-image regression test mode shared by every sample. Started with
+//
+//   BasicFramework.exe -golden          compares against Golden\*.png
+//   BasicFramework.exe -golden update   writes Golden\*.png
+//
+// the sample renders a few fixed rotations (and a fixed time for
+// animated samples) with its window hidden, compares every frame with
+// the stored golden image (see ImageDiff.h) and quits with exit code 1
+// if any of them differ. Failed frames leave *_actual.png and
+// *_diff.png next to the golden images.
+//
+//**********************************************************************
+
+#include "GoldenTest.h"
+#include "ImageDiff.h"
+#include <d3dx9.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+GoldenTestSettings gGoldenTest;
+
+// rotations checked, in degrees
+static const int gPoses[] = { 0, 30, 120, 250 };
+static int gPoseIndex = 0;
+
+#define NUM_POSES (sizeof(gPoses) / sizeof(gPoses[0]))
+
+
+void InitGoldenTest(const char* cmdLine)
+{
+    ZeroMemory(&gGoldenTest, sizeof(gGoldenTest));
+
+    if (cmdLine && strstr(cmdLine, "-golden"))
+    {
+        gGoldenTest.enabled = true;
+        gGoldenTest.update = (strstr(cmdLine, "-golden update") != NULL);
+    }
+}
+
+float GetGoldenRotation()
+{
+    return gPoses[gPoseIndex] * 3.14159265f / 180.0f;
+}
+
+int GetGoldenTestExitCode()
+{
+    if (gGoldenTest.failed)
+    {
+        return 1;
+    }
+    return (gGoldenTest.skipped > 0) ? GOLDEN_EXIT_NO_BASELINES : 0;
+}
+
+//----------------------------------------------------------------------
+// images
+//----------------------------------------------------------------------
+
+// copies the back buffer into a tightly packed BGRA8 image
+static bool CaptureBackBuffer(LPDIRECT3DDEVICE9 device, std::vector<unsigned char>& image, int* width, int* height)
+{
+    LPDIRECT3DSURFACE9 backBuffer = NULL;
+    LPDIRECT3DSURFACE9 copy = NULL;
+    bool ok = false;
+
+    if (SUCCEEDED(device->GetBackBuffer(0, 0, D3DBACKBUFFER_TYPE_MONO, &backBuffer)))
+    {
+        D3DSURFACE_DESC desc;
+        backBuffer->GetDesc(&desc);
+
+        if (SUCCEEDED(device->CreateOffscreenPlainSurface(desc.Width, desc.Height, desc.Format, D3DPOOL_SYSTEMMEM, &copy, NULL)) &&
+            SUCCEEDED(device->GetRenderTargetData(backBuffer, copy)))
+        {
+            D3DLOCKED_RECT lockedRect;
+            if (SUCCEEDED(copy->LockRect(&lockedRect, NULL, D3DLOCK_READONLY)))
+            {
+                *width = desc.Width;
+                *height = desc.Height;
+                image.resize(desc.Width * desc.Height * 4);
+
+                for (UINT y = 0; y < desc.Height; ++y)
+                {
+                    memcpy(&image[y * desc.Width * 4], (unsigned char*)lockedRect.pBits + y * lockedRect.Pitch, desc.Width * 4);
+                    for (UINT x = 0; x < desc.Width; ++x)
+                    {
+                        image[(y * desc.Width + x) * 4 + 3] = 255;     // X8R8G8B8
+                    }
+                }
+
+                copy->UnlockRect();
+                ok = true;
+            }
+        }
+    }
+
+    if (copy)
+    {
+        copy->Release();
+    }
+
+    if (backBuffer)
+    {
+        backBuffer->Release();
+    }
+
+    return ok;
+}
+
+// a BGRA8 image goes through a system memory surface to and from PNG
+static LPDIRECT3DSURFACE9 CreateImageSurface(LPDIRECT3DDEVICE9 device, int width, int height)
+{
+    LPDIRECT3DSURFACE9 surface = NULL;
+
+    if (FAILED(device->CreateOffscreenPlainSurface(width, height, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, &surface, NULL)))
+    {
+        return NULL;
+    }
+
+    return surface;
+}
+
+static bool SavePng(LPDIRECT3DDEVICE9 device, const char* filename, const std::vector<unsigned char>& image, int width, int height)
+{
+    LPDIRECT3DSURFACE9 surface = CreateImageSurface(device, width, height);
+    if (!surface)
+    {
+        return false;
+    }
+
+    bool ok = false;
+    D3DLOCKED_RECT lockedRect;
+    if (SUCCEEDED(surface->LockRect(&lockedRect, NULL, 0)))
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy((unsigned char*)lockedRect.pBits + y * lockedRect.Pitch, &image[y * width * 4], width * 4);
+        }
+        surface->UnlockRect();
+
+        ok = SUCCEEDED(D3DXSaveSurfaceToFile(filename, D3DXIFF_PNG, surface, NULL, NULL));
+    }
+
+    surface->Release();
+    return ok;
+}
+
+static bool LoadPng(LPDIRECT3DDEVICE9 device, const char* filename, std::vector<unsigned char>& image, int width, int height)
+{
+    D3DXIMAGE_INFO info;
+    if (FAILED(D3DXGetImageInfoFromFile(filename, &info)) || (int)info.Width != width || (int)info.Height != height)
+    {
+        return false;
+    }
+
+    LPDIRECT3DSURFACE9 surface = CreateImageSurface(device, width, height);
+    if (!surface)
+    {
+        return false;
+    }
+
+    bool ok = false;
+    if (SUCCEEDED(D3DXLoadSurfaceFromFile(surface, NULL, NULL, filename, NULL, D3DX_FILTER_NONE, 0, NULL)))
+    {
+        D3DLOCKED_RECT lockedRect;
+        if (SUCCEEDED(surface->LockRect(&lockedRect, NULL, D3DLOCK_READONLY)))
+        {
+            image.resize(width * height * 4);
+            for (int y = 0; y < height; ++y)
+            {
+                memcpy(&image[y * width * 4], (unsigned char*)lockedRect.pBits + y * lockedRect.Pitch, width * 4);
+            }
+            surface->UnlockRect();
+            ok = true;
+        }
+    }
+
+    surface->Release();
+    return ok;
+}
+
+//----------------------------------------------------------------------
+// test
+//----------------------------------------------------------------------
+bool RunGoldenTest(LPDIRECT3DDEVICE9 device, void (*renderFrame)())
+{
+    CreateDirectory(GOLDEN_DIRECTORY, NULL);
+
+    for (gPoseIndex = 0; gPoseIndex < (int)NUM_POSES; ++gPoseIndex)
+    {
+        renderFrame();
+
+        char name[MAX_PATH];
+        char path[MAX_PATH];
+        char str[MAX_PATH + 128];
+        _snprintf(name, MAX_PATH, "%s\\rot_%03d", GOLDEN_DIRECTORY, gPoses[gPoseIndex]);
+        _snprintf(path, MAX_PATH, "%s.png", name);
+
+        std::vector<unsigned char> actual;
+        int width = 0, height = 0;
+        if (!CaptureBackBuffer(device, actual, &width, &height))
+        {
+            OutputDebugString("golden: failed at reading the back buffer\n");
+            gGoldenTest.failed = true;
+            return false;
+        }
+
+        if (gGoldenTest.update)
+        {
+            bool saved = SavePng(device, path, actual, width, height);
+            if (!saved)
+            {
+                gGoldenTest.failed = true;
+            }
+            sprintf(str, "golden: %s %s\n", path, saved ? "written" : "could not be written");
+            OutputDebugString(str);
+            continue;
+        }
+
+        if (GetFileAttributes(path) == INVALID_FILE_ATTRIBUTES)
+        {
+            sprintf(str, "golden: skip %s, no baseline\n", path);
+            OutputDebugString(str);
+            ++gGoldenTest.skipped;
+            continue;
+        }
+
+        std::vector<unsigned char> expected;
+        if (!LoadPng(device, path, expected, width, height))
+        {
+            sprintf(str, "golden: FAIL %s cannot be read or has the wrong size; run with -golden update\n", path);
+            OutputDebugString(str);
+            gGoldenTest.failed = true;
+            continue;
+        }
+
+        std::vector<unsigned char> diff(actual.size());
+        ImageDiffResult result;
+        CompareImages(&expected[0], &actual[0], width, height, GOLDEN_DELTA_E, &result, &diff[0]);
+
+        bool passed = result.failedPixels <= width * height * GOLDEN_MAX_FAILED_FRACTION;
+
+        sprintf(str, "golden: %s %s (%d failed, %d tolerated pixels, max dE %.2f, mean dE %.3f)\n",
+            passed ? "pass" : "FAIL", path, result.failedPixels, result.toleratedPixels,
+            result.maxDeltaE, result.meanDeltaE);
+        OutputDebugString(str);
+
+        if (!passed)
+        {
+            gGoldenTest.failed = true;
+
+            _snprintf(path, MAX_PATH, "%s_actual.png", name);
+            SavePng(device, path, actual, width, height);
+            _snprintf(path, MAX_PATH, "%s_diff.png", name);
+            SavePng(device, path, diff, width, height);
+        }
+    }
+
+    if (gGoldenTest.skipped > 0)
+    {
+        char str[MAX_PATH + 128];
+        sprintf(str, "golden: no baselines for %d of %d frames in %s; run with -golden update on the reference configuration\n",
+            gGoldenTest.skipped, (int)NUM_POSES, GOLDEN_DIRECTORY);
+        OutputDebugString(str);
+    }
+
+    return !gGoldenTest.failed;
+}
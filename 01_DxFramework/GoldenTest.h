@@ -0,0 +1,69 @@
+//**********************************************************************
+//
+// GoldenTest.h
+//
+// Golden-image regression test mode shared by every sample. Started with
+//
+//   BasicFramework.exe -golden          compares against Golden\*.png
+//   BasicFramework.exe -golden update   writes Golden\*.png
+//
+// the sample renders a few fixed rotations (and a fixed time for
+// animated samples) with its window hidden, compares every frame with
+// the stored golden image (see ImageDiff.h) and quits with exit code 1
+// if any of them differ. Failed frames leave *_actual.png and
+// *_diff.png next to the golden images.
+//
+// No golden images are committed: they have to be written with -golden
+// update on the reference configuration, a D3D9 device. Until then a
+// frame without one is skipped rather than failed, and the sample says
+// there are no baselines and quits with GOLDEN_EXIT_NO_BASELINES.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <d3d9.h>
+
+// ---------- constants ------------------------------------
+
+#define GOLDEN_DIRECTORY			"Golden"
+
+// delta E above which a pixel counts as different
+#define GOLDEN_DELTA_E				3.0f
+
+// share of pixels that may differ before a frame fails
+#define GOLDEN_MAX_FAILED_FRACTION	0.001f
+
+// seconds, for samples animated by time
+#define GOLDEN_TIME					1.25f
+
+// exit code when no frame failed but some had no golden image
+#define GOLDEN_EXIT_NO_BASELINES	2
+
+// ---------- types ------------------------------------
+
+struct GoldenTestSettings
+{
+    bool enabled;
+    bool update;                // write new golden images instead of comparing
+    bool failed;
+    int skipped;                // frames with no golden image
+};
+
+extern GoldenTestSettings gGoldenTest;
+
+// ---------------- function prototype  ------------------------
+
+// fills gGoldenTest from the command line
+void InitGoldenTest(const char* cmdLine);
+
+// renders and checks every pose. the device has to be created with
+// D3DSWAPEFFECT_COPY so the back buffer survives Present.
+bool RunGoldenTest(LPDIRECT3DDEVICE9 device, void (*renderFrame)());
+
+// rotation of the pose being rendered, in radians
+float GetGoldenRotation();
+
+// exit code for WinMain
+int GetGoldenTestExitCode();
@@ -0,0 +1,270 @@
+//**********************************************************************
+//
+// HotReload.cpp
+//
+// Hot-reload of shaders, textures and models. A watcher thread listens
+// for changes in the sample folder; only the assets whose files changed
+// are reloaded, on the async loader, and swapped in between frames.
+//
+//**********************************************************************
+
+#include "HotReload.h"
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <thread>
+
+// one watched asset
+struct WatchedAsset
+{
+    char filename[MAX_PATH];
+    AsyncLoadFunction load;
+    IUnknown** asset;
+
+    bool changed;               // set by the watcher thread
+    LARGE_INTEGER changedAt;    // last change seen
+    bool loading;
+    LARGE_INTEGER reloadFrom;   // change the running reload picked up
+    bool swapped;               // swapped in, not presented yet
+};
+
+static WatchedAsset gWatched[MAX_WATCHED_ASSETS];
+static int gNumWatched = 0;
+
+static HANDLE gDirectory = INVALID_HANDLE_VALUE;
+static HANDLE gChangeEvent = NULL;
+static HANDLE gStopEvent = NULL;
+static std::thread gWatcher;
+static std::mutex gLock;
+
+
+static double GetMs(const LARGE_INTEGER& from, const LARGE_INTEGER& to)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    return (to.QuadPart - from.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+static void MarkChanged(const char* filename, const LARGE_INTEGER& now)
+{
+    std::lock_guard<std::mutex> lock(gLock);
+
+    for (int i = 0; i < gNumWatched; ++i)
+    {
+        if (_stricmp(gWatched[i].filename, filename) == 0)
+        {
+            gWatched[i].changed = true;
+            gWatched[i].changedAt = now;
+        }
+    }
+}
+
+static void WatcherMain()
+{
+    // ReadDirectoryChangesW needs a DWORD-aligned buffer
+    DWORD buffer[4096];
+
+    OVERLAPPED overlapped;
+    ZeroMemory(&overlapped, sizeof(overlapped));
+    overlapped.hEvent = gChangeEvent;
+
+    for (;;)
+    {
+        if (!ReadDirectoryChangesW(gDirectory, buffer, sizeof(buffer), FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, NULL, &overlapped, NULL))
+        {
+            OutputDebugString("hot reload: failed to watch for changes\n");
+            return;
+        }
+
+        DWORD bytes = 0;
+        HANDLE events[2] = { gStopEvent, gChangeEvent };
+
+        if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+        {
+            // the read has to be finished before the buffer goes away
+            CancelIo(gDirectory);
+            GetOverlappedResult(gDirectory, &overlapped, &bytes, TRUE);
+            return;
+        }
+
+        if (!GetOverlappedResult(gDirectory, &overlapped, &bytes, FALSE))
+        {
+            return;
+        }
+
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+
+        // bytes is 0 if the buffer overflowed; those changes are lost
+        const unsigned char* entry = (const unsigned char*)buffer;
+        while (bytes > 0)
+        {
+            const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)entry;
+
+            if (info->Action == FILE_ACTION_MODIFIED ||
+                info->Action == FILE_ACTION_ADDED ||
+                info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+            {
+                char filename[MAX_PATH];
+                int length = WideCharToMultiByte(CP_ACP, 0, info->FileName, info->FileNameLength / sizeof(WCHAR),
+                    filename, MAX_PATH - 1, NULL, NULL);
+                filename[length] = '\0';
+
+                MarkChanged(filename, now);
+            }
+
+            if (info->NextEntryOffset == 0)
+            {
+                break;
+            }
+            entry += info->NextEntryOffset;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// hot reload
+//----------------------------------------------------------------------
+bool InitHotReload(const char* directory)
+{
+    gDirectory = CreateFile(directory, FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+
+    if (gDirectory == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    gChangeEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    gStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+    gWatcher = std::thread(WatcherMain);
+
+    return true;
+}
+
+void WatchAsset(const char* filename, AsyncLoadFunction load, IUnknown** asset)
+{
+    std::lock_guard<std::mutex> lock(gLock);
+
+    if (gNumWatched >= MAX_WATCHED_ASSETS)
+    {
+        return;
+    }
+
+    WatchedAsset& watched = gWatched[gNumWatched++];
+    ZeroMemory(&watched, sizeof(WatchedAsset));
+    strncpy(watched.filename, filename, MAX_PATH - 1);
+    watched.load = load;
+    watched.asset = asset;
+}
+
+// swaps the reloaded resource in; a failed reload keeps the old one
+static void OnAssetReloaded(const char* filename, IUnknown* resource, void* userData)
+{
+    WatchedAsset* watched = (WatchedAsset*)userData;
+
+    if (resource)
+    {
+        if (*watched->asset)
+        {
+            (*watched->asset)->Release();
+        }
+
+        *watched->asset = resource;
+        watched->swapped = true;
+    }
+    else
+    {
+        OutputDebugString("hot reload: keeping the old version of ");
+        OutputDebugString(filename);
+        OutputDebugString("\n");
+    }
+
+    std::lock_guard<std::mutex> lock(gLock);
+    watched->loading = false;
+}
+
+void UpdateHotReload()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    WatchedAsset* reloads[MAX_WATCHED_ASSETS];
+    int numReloads = 0;
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+
+        for (int i = 0; i < gNumWatched; ++i)
+        {
+            WatchedAsset& watched = gWatched[i];
+
+            // a change during a reload is picked up after it finishes
+            if (watched.changed && !watched.loading && GetMs(watched.changedAt, now) >= HOT_RELOAD_SETTLE_MS)
+            {
+                watched.changed = false;
+                watched.loading = true;
+                watched.reloadFrom = watched.changedAt;
+                reloads[numReloads++] = &watched;
+            }
+        }
+    }
+
+    for (int i = 0; i < numReloads; ++i)
+    {
+        LoadAsync(reloads[i]->filename, NULL, reloads[i]->load, ASYNC_PRIORITY_HIGH, OnAssetReloaded, reloads[i]);
+    }
+}
+
+void EndHotReloadFrame()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    for (int i = 0; i < gNumWatched; ++i)
+    {
+        WatchedAsset& watched = gWatched[i];
+
+        if (watched.swapped)
+        {
+            watched.swapped = false;
+
+            char str[MAX_PATH + 64];
+            sprintf(str, "hot reload: %s on screen %.2f ms after saving\n",
+                watched.filename, GetMs(watched.reloadFrom, now));
+            OutputDebugString(str);
+        }
+    }
+}
+
+void ReleaseHotReload()
+{
+    if (gWatcher.joinable())
+    {
+        SetEvent(gStopEvent);
+        gWatcher.join();
+    }
+
+    if (gDirectory != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(gDirectory);
+        gDirectory = INVALID_HANDLE_VALUE;
+    }
+
+    if (gChangeEvent)
+    {
+        CloseHandle(gChangeEvent);
+        gChangeEvent = NULL;
+    }
+
+    if (gStopEvent)
+    {
+        CloseHandle(gStopEvent);
+        gStopEvent = NULL;
+    }
+
+    gNumWatched = 0;
+}
@@ -0,0 +1,42 @@
+//**********************************************************************
+//
+// HotReload.h
+//
+// Hot-reload of shaders, textures and models. A watcher thread listens
+// for changes in the sample folder; only the assets whose files changed
+// are reloaded, on the async loader, and swapped in between frames.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <windows.h>
+#include "AsyncLoader.h"
+
+// ---------- constants ------------------------------------
+
+// editors touch a file several times while saving; a change is picked
+// up once the file has been quiet this long
+#define HOT_RELOAD_SETTLE_MS	50
+
+#define MAX_WATCHED_ASSETS		32
+
+// ---------------- function prototype  ------------------------
+
+// starts watching the given folder
+bool InitHotReload(const char* directory);
+
+// reloads asset with load whenever filename changes. the reloaded
+// resource replaces the one in asset.
+void WatchAsset(const char* filename, AsyncLoadFunction load, IUnknown** asset);
+
+// queues reloads for the files that changed. call once per frame.
+void UpdateHotReload();
+
+// reports how long it took from saving a file to presenting the first
+// frame that uses it. call after Present.
+void EndHotReloadFrame();
+
+// stops the watcher thread
+void ReleaseHotReload();
@@ -0,0 +1,157 @@
+//**********************************************************************
+//
+// ImageDiff.cpp
+//
+// Perceptual image comparison for the golden-image tests. Colors are
+// compared in CIELAB, where a distance (delta E) of about 2.3 is just
+// noticeable, and a pixel that matches a direct neighbour in the other
+// image is tolerated, so a rasterization difference along an edge does
+// not fail a test.
+//
+//**********************************************************************
+
+#include "ImageDiff.h"
+#include <math.h>
+#include <vector>
+
+struct Lab
+{
+    float l, a, b;
+};
+
+
+//----------------------------------------------------------------------
+// color conversion
+//----------------------------------------------------------------------
+
+static float LabCurve(float t)
+{
+    return (t > 0.008856f) ? powf(t, 1.0f / 3.0f) : 7.787f * t + 16.0f / 116.0f;
+}
+
+// sRGB BGRA8 -> CIELAB (D65 white)
+static void ConvertToLab(const unsigned char* image, int numPixels, std::vector<Lab>& lab)
+{
+    static float toLinear[256];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            float c = i / 255.0f;
+            toLinear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        initialized = true;
+    }
+
+    lab.resize(numPixels);
+
+    for (int i = 0; i < numPixels; ++i)
+    {
+        float b = toLinear[image[i * 4 + 0]];
+        float g = toLinear[image[i * 4 + 1]];
+        float r = toLinear[image[i * 4 + 2]];
+
+        float x = (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f;
+        float y = (0.2126f * r + 0.7152f * g + 0.0722f * b);
+        float z = (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f;
+
+        float fx = LabCurve(x);
+        float fy = LabCurve(y);
+        float fz = LabCurve(z);
+
+        lab[i].l = 116.0f * fy - 16.0f;
+        lab[i].a = 500.0f * (fx - fy);
+        lab[i].b = 200.0f * (fy - fz);
+    }
+}
+
+static float DeltaE(const Lab& p, const Lab& q)
+{
+    float dl = p.l - q.l;
+    float da = p.a - q.a;
+    float db = p.b - q.b;
+    return sqrtf(dl * dl + da * da + db * db);
+}
+
+// smallest delta E between color and the 3x3 neighbourhood of (x, y)
+static float NearestInNeighbourhood(const Lab& color, const std::vector<Lab>& image, int x, int y, int width, int height)
+{
+    float nearest = 1e30f;
+
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+    {
+        for (int nx = x - 1; nx <= x + 1; ++nx)
+        {
+            if (nx >= 0 && nx < width && ny >= 0 && ny < height)
+            {
+                float d = DeltaE(color, image[ny * width + nx]);
+                nearest = (d < nearest) ? d : nearest;
+            }
+        }
+    }
+
+    return nearest;
+}
+
+//----------------------------------------------------------------------
+// comparison
+//----------------------------------------------------------------------
+void CompareImages(const unsigned char* expected, const unsigned char* actual, int width, int height,
+    float threshold, ImageDiffResult* result, unsigned char* diff)
+{
+    int numPixels = width * height;
+
+    std::vector<Lab> expectedLab, actualLab;
+    ConvertToLab(expected, numPixels, expectedLab);
+    ConvertToLab(actual, numPixels, actualLab);
+
+    result->failedPixels = 0;
+    result->toleratedPixels = 0;
+    result->maxDeltaE = 0;
+
+    double sum = 0;
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            int i = y * width + x;
+            float d = DeltaE(expectedLab[i], actualLab[i]);
+            sum += d;
+
+            // 0: same, 1: tolerated, 2: failed
+            int state = 0;
+
+            if (d > threshold)
+            {
+                // an edge that moved by a pixel matches a neighbour in both directions
+                if (NearestInNeighbourhood(actualLab[i], expectedLab, x, y, width, height) <= threshold &&
+                    NearestInNeighbourhood(expectedLab[i], actualLab, x, y, width, height) <= threshold)
+                {
+                    ++result->toleratedPixels;
+                    state = 1;
+                }
+                else
+                {
+                    ++result->failedPixels;
+                    result->maxDeltaE = (d > result->maxDeltaE) ? d : result->maxDeltaE;
+                    state = 2;
+                }
+            }
+
+            if (diff)
+            {
+                unsigned char grey = (unsigned char)(expectedLab[i].l * 0.3f * 2.55f);
+                unsigned char* out = &diff[i * 4];
+
+                out[0] = (state == 0) ? grey : 0;
+                out[1] = (state == 0) ? grey : ((state == 1) ? 255 : 0);
+                out[2] = (state == 0) ? grey : 255;
+                out[3] = 255;
+            }
+        }
+    }
+
+    result->meanDeltaE = (numPixels > 0) ? (float)(sum / numPixels) : 0;
+}
@@ -0,0 +1,32 @@
+//**********************************************************************
+//
+// ImageDiff.h
+//
+// Perceptual image comparison for the golden-image tests. Colors are
+// compared in CIELAB, where a distance (delta E) of about 2.3 is just
+// noticeable, and a pixel that matches a direct neighbour in the other
+// image is tolerated, so a rasterization difference along an edge does
+// not fail a test.
+//
+//**********************************************************************
+
+
+#pragma once
+
+// ---------- types ------------------------------------
+
+struct ImageDiffResult
+{
+    int failedPixels;           // no match within the threshold, even among neighbours
+    int toleratedPixels;        // different, but matching a neighbour
+    float maxDeltaE;            // over the failed pixels
+    float meanDeltaE;           // over all pixels
+};
+
+// ---------------- function prototype  ------------------------
+
+// compares two tightly packed BGRA8 images of the same size. diff (may
+// be NULL) receives a BGRA8 image: the expected image in dim grey,
+// failed pixels in red, tolerated ones in yellow.
+void CompareImages(const unsigned char* expected, const unsigned char* actual, int width, int height,
+    float threshold, ImageDiffResult* result, unsigned char* diff);
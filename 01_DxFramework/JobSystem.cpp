@@ -0,0 +1,473 @@
+//**********************************************************************
+//
+// JobSystem.cpp
+//
+// Work-stealing job scheduler. Every worker thread owns a deque: it
+// pushes and pops jobs at one end without locking, idle workers steal
+// from the other end of someone else's. A job can signal a counter when
+// it finishes; waiting on the counter is how later work depends on
+// earlier jobs, and a thread that waits runs other jobs meanwhile.
+//
+// The deques follow Chase and Lev, "Dynamic Circular Work-Stealing
+// Deque" (2005), with a fixed size: the owner only touches bottom, and
+// takes part in the race for top only for the last job in its deque.
+//
+//**********************************************************************
+
+#include "JobSystem.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define JOB_THREAD_LOCAL __declspec(thread)
+#else
+#define JOB_THREAD_LOCAL __thread
+#endif
+
+// a worker that finds nothing to do yields this often before sleeping
+#define JOB_SPINS_BEFORE_SLEEP	64
+
+#define JOB_DEQUE_MASK			(JOB_DEQUE_SIZE - 1)
+
+struct Job
+{
+    JobFunction function;
+    void* data;
+    int begin;
+    int end;
+    JobCounter* counter;
+};
+
+// a deque entry; thieves may read one while its owner rewrites it, the
+// failed compare-exchange on top then throws the read away
+struct QueuedJob
+{
+    std::atomic<JobFunction> function;
+    std::atomic<void*> data;
+    std::atomic<int> begin;
+    std::atomic<int> end;
+    std::atomic<JobCounter*> counter;
+};
+
+struct JobDeque
+{
+    std::atomic<long long> top;             // thieves take from here
+    char padding0[64];
+    std::atomic<long long> bottom;          // the owner pushes and pops here
+    char padding1[64];
+
+    // written only by the owner
+    std::atomic<long long> jobsRun;
+    std::atomic<long long> jobsStolen;
+    std::atomic<long long> jobsInline;
+    unsigned int random;                    // picks whom to steal from
+
+    QueuedJob jobs[JOB_DEQUE_SIZE];
+};
+
+static JobDeque* gDeques = NULL;
+static std::vector<std::thread> gWorkers;
+static int gNumWorkers = 0;
+static std::atomic<bool> gQuit(false);
+
+// jobs started by threads that are not workers, and their counts
+static std::mutex gSharedLock;
+static std::deque<Job> gSharedJobs;
+static std::atomic<int> gNumSharedJobs(0);
+static std::atomic<long long> gNonWorkerJobsRun(0);
+static std::atomic<long long> gNonWorkerJobsStolen(0);
+
+// sleeping workers
+static std::mutex gSleepLock;
+static std::condition_variable gWakeUp;
+static std::atomic<int> gNumSleeping(0);
+
+// NULL on threads that are not workers
+static JOB_THREAD_LOCAL JobDeque* tDeque = NULL;
+
+
+//----------------------------------------------------------------------
+// deque
+//----------------------------------------------------------------------
+
+static void Increment(std::atomic<long long>& value)
+{
+    value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+static bool Push(JobDeque* deque, const Job& job)
+{
+    long long bottom = deque->bottom.load(std::memory_order_relaxed);
+    long long top = deque->top.load(std::memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_SIZE)
+    {
+        return false;
+    }
+
+    QueuedJob& slot = deque->jobs[bottom & JOB_DEQUE_MASK];
+    slot.function.store(job.function, std::memory_order_relaxed);
+    slot.data.store(job.data, std::memory_order_relaxed);
+    slot.begin.store(job.begin, std::memory_order_relaxed);
+    slot.end.store(job.end, std::memory_order_relaxed);
+    slot.counter.store(job.counter, std::memory_order_relaxed);
+
+    // sequentially consistent, so a worker going to sleep either sees
+    // this job or is seen sleeping by WakeWorker
+    deque->bottom.store(bottom + 1);
+    return true;
+}
+
+static void ReadJob(const QueuedJob& slot, Job* job)
+{
+    job->function = slot.function.load(std::memory_order_relaxed);
+    job->data = slot.data.load(std::memory_order_relaxed);
+    job->begin = slot.begin.load(std::memory_order_relaxed);
+    job->end = slot.end.load(std::memory_order_relaxed);
+    job->counter = slot.counter.load(std::memory_order_relaxed);
+}
+
+static bool Pop(JobDeque* deque, Job* job)
+{
+    long long bottom = deque->bottom.load(std::memory_order_relaxed) - 1;
+    deque->bottom.store(bottom);
+    long long top = deque->top.load();
+
+    if (top > bottom)
+    {
+        // empty
+        deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ReadJob(deque->jobs[bottom & JOB_DEQUE_MASK], job);
+
+    if (top == bottom)
+    {
+        // the last job; a thief may be after it too
+        bool won = deque->top.compare_exchange_strong(top, top + 1);
+        deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    return true;
+}
+
+static bool Steal(JobDeque* deque, Job* job)
+{
+    long long top = deque->top.load();
+    long long bottom = deque->bottom.load();
+    if (top >= bottom)
+    {
+        return false;
+    }
+
+    ReadJob(deque->jobs[top & JOB_DEQUE_MASK], job);
+    return deque->top.compare_exchange_strong(top, top + 1);
+}
+
+//----------------------------------------------------------------------
+// scheduling
+//----------------------------------------------------------------------
+
+static bool HasQueuedJobs()
+{
+    if (gNumSharedJobs.load() > 0)
+    {
+        return true;
+    }
+
+    for (int i = 0; i < gNumWorkers; ++i)
+    {
+        if (gDeques[i].bottom.load() > gDeques[i].top.load())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool FindJob(Job* job)
+{
+    if (tDeque && Pop(tDeque, job))
+    {
+        return true;
+    }
+
+    if (gNumSharedJobs.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(gSharedLock);
+        if (!gSharedJobs.empty())
+        {
+            *job = gSharedJobs.front();
+            gSharedJobs.pop_front();
+            --gNumSharedJobs;
+            return true;
+        }
+    }
+
+    // start at a random victim, so thieves spread out
+    unsigned int random = tDeque ? tDeque->random : (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id());
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    if (tDeque)
+    {
+        tDeque->random = random;
+    }
+
+    for (int i = 0; i < gNumWorkers; ++i)
+    {
+        JobDeque* victim = &gDeques[(random + i) % gNumWorkers];
+        if (victim != tDeque && Steal(victim, job))
+        {
+            if (tDeque)
+            {
+                Increment(tDeque->jobsStolen);
+            }
+            else
+            {
+                ++gNonWorkerJobsStolen;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void Execute(const Job& job)
+{
+    job.function(job.data, job.begin, job.end);
+
+    if (job.counter)
+    {
+        job.counter->count.fetch_sub(1, std::memory_order_release);
+    }
+
+    if (tDeque)
+    {
+        Increment(tDeque->jobsRun);
+    }
+    else
+    {
+        ++gNonWorkerJobsRun;
+    }
+}
+
+static void WakeWorker()
+{
+    if (gNumSleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(gSleepLock);
+        gWakeUp.notify_one();
+    }
+}
+
+static void WorkerMain(int index)
+{
+    tDeque = &gDeques[index];
+
+    int idleSpins = 0;
+    while (true)
+    {
+        Job job;
+        if (FindJob(&job))
+        {
+            Execute(job);
+            idleSpins = 0;
+            continue;
+        }
+
+        if (gQuit.load())
+        {
+            break;
+        }
+
+        if (++idleSpins < JOB_SPINS_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(gSleepLock);
+        ++gNumSleeping;
+        gWakeUp.wait(lock, [] { return gQuit.load() || HasQueuedJobs(); });
+        --gNumSleeping;
+        idleSpins = 0;
+    }
+
+    tDeque = NULL;
+}
+
+//----------------------------------------------------------------------
+// interface
+//----------------------------------------------------------------------
+void InitJobSystem(int numWorkers)
+{
+    if (numWorkers <= 0)
+    {
+        numWorkers = (int)std::thread::hardware_concurrency() - 1;
+        numWorkers = (numWorkers < 1) ? 1 : numWorkers;
+    }
+
+    gNumWorkers = numWorkers;
+    gQuit = false;
+    gNonWorkerJobsRun = 0;
+    gNonWorkerJobsStolen = 0;
+
+    gDeques = new JobDeque[numWorkers];
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        gDeques[i].top = 0;
+        gDeques[i].bottom = 0;
+        gDeques[i].jobsRun = 0;
+        gDeques[i].jobsStolen = 0;
+        gDeques[i].jobsInline = 0;
+        gDeques[i].random = 2463534242u + i * 7919u;
+    }
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        gWorkers.push_back(std::thread(WorkerMain, i));
+    }
+}
+
+int GetJobWorkerCount()
+{
+    return gNumWorkers;
+}
+
+void RunJob(JobFunction function, void* data, int begin, int end, JobCounter* counter)
+{
+    Job job = { function, data, begin, end, counter };
+
+    if (counter)
+    {
+        counter->count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (tDeque)
+    {
+        if (!Push(tDeque, job))
+        {
+            // a full deque means there is plenty to steal already
+            Increment(tDeque->jobsInline);
+            Execute(job);
+            return;
+        }
+    }
+    else if (gNumWorkers > 0)
+    {
+        std::lock_guard<std::mutex> lock(gSharedLock);
+        gSharedJobs.push_back(job);
+        ++gNumSharedJobs;
+    }
+    else
+    {
+        Execute(job);
+        return;
+    }
+
+    WakeWorker();
+}
+
+void WaitForCounter(JobCounter* counter)
+{
+    while (counter->count.load(std::memory_order_acquire) > 0)
+    {
+        Job job;
+        if (FindJob(&job))
+        {
+            Execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+struct ParallelForData
+{
+    JobFunction function;
+    void* data;
+    int grainSize;
+    JobCounter* counter;
+};
+
+// hands the upper halves of the range to thieves and runs the rest
+static void ParallelForJob(void* data, int begin, int end)
+{
+    ParallelForData* parallelFor = (ParallelForData*)data;
+
+    while (end - begin > parallelFor->grainSize)
+    {
+        int middle = begin + (end - begin) / 2;
+        RunJob(ParallelForJob, parallelFor, middle, end, parallelFor->counter);
+        end = middle;
+    }
+
+    parallelFor->function(parallelFor->data, begin, end);
+}
+
+void ParallelFor(int begin, int end, int grainSize, JobFunction function, void* data)
+{
+    grainSize = (grainSize < 1) ? 1 : grainSize;
+
+    if (gNumWorkers == 0 || end - begin <= grainSize)
+    {
+        if (end > begin)
+        {
+            function(data, begin, end);
+        }
+        return;
+    }
+
+    JobCounter counter;
+    counter.count = 0;
+
+    ParallelForData parallelFor = { function, data, grainSize, &counter };
+    ParallelForJob(&parallelFor, begin, end);
+    WaitForCounter(&counter);
+}
+
+JobSystemStats GetJobSystemStats()
+{
+    JobSystemStats stats;
+    stats.jobsRun = gNonWorkerJobsRun.load();
+    stats.jobsStolen = gNonWorkerJobsStolen.load();
+    stats.jobsInline = 0;
+
+    for (int i = 0; i < gNumWorkers; ++i)
+    {
+        stats.jobsRun += gDeques[i].jobsRun.load(std::memory_order_relaxed);
+        stats.jobsStolen += gDeques[i].jobsStolen.load(std::memory_order_relaxed);
+        stats.jobsInline += gDeques[i].jobsInline.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+void ReleaseJobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(gSleepLock);
+        gQuit = true;
+        gWakeUp.notify_all();
+    }
+
+    for (size_t i = 0; i < gWorkers.size(); ++i)
+    {
+        gWorkers[i].join();
+    }
+    gWorkers.clear();
+
+    delete[] gDeques;
+    gDeques = NULL;
+    gNumWorkers = 0;
+}
@@ -0,0 +1,68 @@
+//**********************************************************************
+//
+// JobSystem.h
+//
+// Work-stealing job scheduler. Every worker thread owns a deque: it
+// pushes and pops jobs at one end without locking, idle workers steal
+// from the other end of someone else's. A job can signal a counter when
+// it finishes; waiting on the counter is how later work depends on
+// earlier jobs, and a thread that waits runs other jobs meanwhile.
+//
+// Threads that are not workers (the window thread, the asset loaders)
+// can start jobs and wait on counters too; their jobs go through one
+// shared, locked queue.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <atomic>
+
+// ---------- constants ------------------------------------
+
+// jobs a worker's deque holds; a worker that spawns more runs them inline
+#define JOB_DEQUE_SIZE		4096
+
+// ---------- types ------------------------------------
+
+// runs items [begin, end) of whatever data points to
+typedef void (*JobFunction)(void* data, int begin, int end);
+
+// number of unfinished jobs; zero it before starting jobs on it
+struct JobCounter
+{
+    std::atomic<int> count;
+};
+
+struct JobSystemStats
+{
+    long long jobsRun;          // by every thread, including waiting ones
+    long long jobsStolen;       // taken from another worker's deque
+    long long jobsInline;       // run by their spawner because a deque was full
+};
+
+// ---------------- function prototype  ------------------------
+
+// starts numWorkers threads; 0 picks one per hardware thread but the
+// caller's. with no workers every job runs inline.
+void InitJobSystem(int numWorkers);
+
+int GetJobWorkerCount();
+
+// queues function(data, begin, end); counter (may be NULL) is
+// decremented when it has run
+void RunJob(JobFunction function, void* data, int begin, int end, JobCounter* counter);
+
+// runs other jobs until counter reaches zero
+void WaitForCounter(JobCounter* counter);
+
+// runs function over [begin, end) split into pieces of at least
+// grainSize items, and returns when all of them are done
+void ParallelFor(int begin, int end, int grainSize, JobFunction function, void* data);
+
+// totals since InitJobSystem
+JobSystemStats GetJobSystemStats();
+
+// waits for the queued jobs and stops the workers
+void ReleaseJobSystem();
@@ -0,0 +1,476 @@
+//**********************************************************************
+//
+// RenderBackend.cpp
+//
+// The calls every backend shares: loading meshes and textures from
+// files, compiling a pass into a pipeline and laying out its uniforms,
+// then handing each to the backend picked at InitRenderBackend.
+//
+//**********************************************************************
+
+#include "RenderBackend.h"
+#include "DdsLoader.h"
+#include "FileUtil.h"
+#include "TgaLoader.h"
+#include "XMeshLoader.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+static const RenderBackend* gpBackend = NULL;
+
+
+//----------------------------------------------------------------------
+// resources
+//----------------------------------------------------------------------
+
+bool InitRenderBackend(const RenderBackend* backend, int width, int height)
+{
+    gpBackend = NULL;
+    if (!backend || !backend->init(width, height))
+    {
+        return false;
+    }
+
+    gpBackend = backend;
+    return true;
+}
+
+const RenderBackend* GetRenderBackend()
+{
+    return gpBackend;
+}
+
+RenderMesh* CreateRenderMesh(const RenderMeshDesc& desc)
+{
+    if (desc.numVertices <= 0 || desc.numIndices <= 0 || desc.numIndices % 3 != 0 ||
+        desc.numAttributes > RENDER_MAX_ATTRIBUTES)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < desc.numIndices; ++i)
+    {
+        if (desc.indices[i] >= (unsigned int)desc.numVertices)
+        {
+            return NULL;
+        }
+    }
+
+    return gpBackend->createMesh(desc);
+}
+
+RenderMesh* LoadRenderMesh(const char* filename)
+{
+    XMesh mesh;
+    if (!LoadXMesh(filename, &mesh))
+    {
+        fprintf(stderr, "render: cannot load %s\n", filename);
+        return NULL;
+    }
+
+    RenderMeshDesc desc;
+    desc.numVertices = mesh.numVertices;
+    desc.numIndices = (int)mesh.indices.size();
+    desc.indices = &mesh.indices[0];
+    desc.numAttributes = 0;
+
+    const char* semantics[] = { "POSITION", "NORMAL", "TEXCOORD0", "TANGENT", "BINORMAL" };
+    const std::vector<float>* values[] = { &mesh.positions, &mesh.normals, &mesh.texCoords, &mesh.tangents, &mesh.binormals };
+    for (int i = 0; i < 5; ++i)
+    {
+        if (!values[i]->empty())
+        {
+            RenderAttribute& attribute = desc.attributes[desc.numAttributes++];
+            attribute.semantic = semantics[i];
+            attribute.components = (int)values[i]->size() / mesh.numVertices;
+            attribute.values = &(*values[i])[0];
+        }
+    }
+
+    return CreateRenderMesh(desc);
+}
+
+RenderTexture* CreateRenderTexture(int width, int height, bool cube, const unsigned char* rgba)
+{
+    return (width > 0 && height > 0) ? gpBackend->createTexture(width, height, cube, rgba) : NULL;
+}
+
+// the loaders decode to BGRA
+static void SwapRedAndBlue(std::vector<unsigned char>& pixels)
+{
+    for (size_t i = 0; i + 3 < pixels.size(); i += 4)
+    {
+        unsigned char blue = pixels[i];
+        pixels[i] = pixels[i + 2];
+        pixels[i + 2] = blue;
+    }
+}
+
+RenderTexture* LoadRenderTexture(const char* filename)
+{
+    size_t size = 0;
+    unsigned char* file = ReadWholeFile(filename, &size);
+    if (!file)
+    {
+        fprintf(stderr, "render: cannot read %s\n", filename);
+        return NULL;
+    }
+
+    RenderTexture* texture = NULL;
+    std::vector<unsigned char> pixels;
+    size_t length = strlen(filename);
+    bool isDds = length > 4 && (strcmp(filename + length - 4, ".dds") == 0 || strcmp(filename + length - 4, ".DDS") == 0);
+
+    TgaInfo tga;
+    DdsInfo dds;
+    if (isDds && ReadDdsHeader(file, size, &dds))
+    {
+        int faceSize = dds.width * dds.height * 4;
+        pixels.resize((size_t)faceSize * dds.faceCount);
+
+        bool decoded = true;
+        for (int face = 0; face < dds.faceCount && decoded; ++face)
+        {
+            DdsSurface surface;
+            decoded = GetDdsSurface(file, size, dds, face, 0, &surface) &&
+                DecodeDdsSurface(dds.format, surface, &pixels[(size_t)face * faceSize], dds.width * 4);
+        }
+        if (decoded)
+        {
+            SwapRedAndBlue(pixels);
+            texture = CreateRenderTexture(dds.width, dds.height, dds.isCubeMap, &pixels[0]);
+        }
+    }
+    else if (!isDds && ReadTgaHeader(file, size, &tga))
+    {
+        pixels.resize((size_t)tga.width * tga.height * 4);
+        if (DecodeTga(file, size, tga, &pixels[0], tga.width * 4))
+        {
+            SwapRedAndBlue(pixels);
+            texture = CreateRenderTexture(tga.width, tga.height, false, &pixels[0]);
+        }
+    }
+
+    delete[] file;
+    if (!texture)
+    {
+        fprintf(stderr, "render: cannot decode %s\n", filename);
+    }
+    return texture;
+}
+
+RenderTexture* CreateRenderTarget(int width, int height, RenderFormat format)
+{
+    return (width > 0 && height > 0) ? gpBackend->createTarget(width, height, format) : NULL;
+}
+
+void ReleaseRenderMesh(RenderMesh* mesh)
+{
+    if (mesh)
+    {
+        gpBackend->releaseMesh(mesh);
+    }
+}
+
+void ReleaseRenderTexture(RenderTexture* texture)
+{
+    if (texture)
+    {
+        gpBackend->releaseTexture(texture);
+    }
+}
+
+//----------------------------------------------------------------------
+// pipelines
+//----------------------------------------------------------------------
+
+static bool IsState(const std::string& name, const char* state)
+{
+    if (name.size() != strlen(state))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        if (toupper((unsigned char)name[i]) != state[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// CullMode, ZEnable and ZWriteEnable as the pass sets them
+static void ReadPassStates(const EffectSource& effect, const std::string& technique, const std::string& pass,
+    RenderStates* states)
+{
+    states->cull = RENDER_CULL_CCW;
+    states->depthTest = true;
+    states->depthWrite = true;
+
+    const std::vector<Token>& tokens = effect.tokens;
+    for (size_t t = 0; t < effect.techniqueBegins.size(); ++t)
+    {
+        size_t begin = effect.techniqueBegins[t];
+        size_t end = effect.techniqueEnds[t];
+        if (begin + 1 >= end || tokens[begin + 1].text != technique)
+        {
+            continue;
+        }
+
+        std::string current;
+        for (size_t i = begin; i + 2 < end; ++i)
+        {
+            if (tokens[i].text == "pass")
+            {
+                current = tokens[i + 1].text;
+                continue;
+            }
+            if (current != pass || tokens[i + 1].text != "=")
+            {
+                continue;
+            }
+
+            const std::string& value = tokens[i + 2].text;
+            bool on = IsState(value, "TRUE") || value == "1";
+            if (IsState(tokens[i].text, "CULLMODE"))
+            {
+                states->cull = IsState(value, "NONE") ? RENDER_CULL_NONE : IsState(value, "CW") ? RENDER_CULL_CW : RENDER_CULL_CCW;
+            }
+            else if (IsState(tokens[i].text, "ZENABLE"))
+            {
+                states->depthTest = on;
+            }
+            else if (IsState(tokens[i].text, "ZWRITEENABLE"))
+            {
+                states->depthWrite = on;
+            }
+        }
+    }
+}
+
+// the uniforms of both shaders, the vertex shader's first, a float4 per
+// row; and their samplers
+static void BuildLayout(const ShaderProgram& vertexShader, const ShaderProgram& pixelShader, RenderLayout* layout)
+{
+    layout->size = 0;
+    const ShaderProgram* shaders[] = { &vertexShader, &pixelShader };
+    for (int s = 0; s < 2; ++s)
+    {
+        for (size_t u = 0; u < shaders[s]->uniforms.size(); ++u)
+        {
+            const ShaderVariable& variable = shaders[s]->uniforms[u];
+            bool seen = false;
+            for (size_t i = 0; i < layout->uniforms.size(); ++i)
+            {
+                seen = seen || layout->uniforms[i].name == variable.name;
+            }
+            if (seen)
+            {
+                continue;
+            }
+
+            RenderUniform uniform;
+            uniform.name = variable.name;
+            uniform.offset = layout->size;
+            uniform.rows = variable.rows;
+            uniform.columns = variable.columns;
+            layout->uniforms.push_back(uniform);
+
+            layout->size += variable.rows * 4;
+            layout->defaults.resize(layout->size, 0.0f);
+            for (size_t v = 0; v < variable.values.size(); ++v)
+            {
+                int row = (int)v / variable.columns;
+                int column = (int)v % variable.columns;
+                layout->defaults[uniform.offset + row * 4 + column] = variable.values[v];
+            }
+        }
+
+        for (size_t i = 0; i < shaders[s]->samplers.size(); ++i)
+        {
+            bool seen = false;
+            for (size_t j = 0; j < layout->samplers.size(); ++j)
+            {
+                seen = seen || layout->samplers[j].name == shaders[s]->samplers[i].name;
+            }
+            if (!seen)
+            {
+                layout->samplers.push_back(shaders[s]->samplers[i]);
+            }
+        }
+    }
+}
+
+static bool CompilePassShader(const EffectSource& effect, const ShaderUse& use, ShaderProgram* program,
+    const std::string& name)
+{
+    const Function* function = FindEffectFunction(effect, use.function);
+    if (!function || !CompileShader(effect, *function, program))
+    {
+        fprintf(stderr, "render: %s: %s %s: %s\n", name.c_str(), use.stage.c_str(), use.function.c_str(),
+            function ? program->error.c_str() : "not found");
+        return false;
+    }
+    return true;
+}
+
+bool CompileRenderPipeline(const RenderPipelineDesc& desc, RenderPipeline* compiled)
+{
+    EffectSource effect;
+    if (!LoadEffectSource(desc.effect, &effect, desc.defines))
+    {
+        fprintf(stderr, "render: cannot read %s\n", desc.effect);
+        return false;
+    }
+
+    // the first pass that matches, and its shaders
+    const ShaderUse* vertexUse = NULL;
+    const ShaderUse* pixelUse = NULL;
+    for (size_t i = 0; i < effect.shaders.size(); ++i)
+    {
+        const ShaderUse& use = effect.shaders[i];
+        const ShaderUse* chosen = vertexUse ? vertexUse : pixelUse;
+        bool matches = chosen ? (use.technique == chosen->technique && use.pass == chosen->pass) :
+            (!desc.technique || use.technique == desc.technique) && (!desc.pass || use.pass == desc.pass);
+        if (matches && use.stage == "vs" && !vertexUse)
+        {
+            vertexUse = &use;
+        }
+        else if (matches && use.stage == "ps" && !pixelUse)
+        {
+            pixelUse = &use;
+        }
+    }
+
+    compiled->name = desc.effect;
+    compiled->format = desc.format;
+    if (!vertexUse || !pixelUse)
+    {
+        fprintf(stderr, "render: %s has no pass %s/%s with both shaders\n", desc.effect,
+            desc.technique ? desc.technique : "*", desc.pass ? desc.pass : "*");
+        ReleaseEffectSource(&effect);
+        return false;
+    }
+    compiled->name += " " + vertexUse->technique + "/" + vertexUse->pass;
+
+    bool succeeded = CompilePassShader(effect, *vertexUse, &compiled->vertexShader, compiled->name) &&
+        CompilePassShader(effect, *pixelUse, &compiled->pixelShader, compiled->name);
+    if (succeeded)
+    {
+        ReadPassStates(effect, vertexUse->technique, vertexUse->pass, &compiled->states);
+        BuildLayout(compiled->vertexShader, compiled->pixelShader, &compiled->layout);
+    }
+    ReleaseEffectSource(&effect);
+
+    if (succeeded && compiled->layout.samplers.size() > RENDER_MAX_SAMPLERS)
+    {
+        fprintf(stderr, "render: %s uses more than %d samplers\n", compiled->name.c_str(), RENDER_MAX_SAMPLERS);
+        succeeded = false;
+    }
+    return succeeded;
+}
+
+RenderPipeline* CreateRenderPipeline(const RenderPipelineDesc& desc)
+{
+    RenderPipeline compiled;
+    bool succeeded = CompileRenderPipeline(desc, &compiled);
+    RenderPipeline* pipeline = succeeded ? gpBackend->createPipeline(compiled) : NULL;
+    if (succeeded && !pipeline)
+    {
+        fprintf(stderr, "render: %s: the %s backend cannot build it\n", compiled.name.c_str(), gpBackend->name);
+    }
+    return pipeline;
+}
+
+int GetRenderUniform(const RenderPipeline* pipeline, const char* name)
+{
+    for (size_t i = 0; i < pipeline->layout.uniforms.size(); ++i)
+    {
+        if (pipeline->layout.uniforms[i].name == name)
+        {
+            return pipeline->layout.uniforms[i].offset;
+        }
+    }
+    return -1;
+}
+
+int GetRenderSampler(const RenderPipeline* pipeline, const char* name)
+{
+    for (size_t i = 0; i < pipeline->layout.samplers.size(); ++i)
+    {
+        const ShaderSampler& sampler = pipeline->layout.samplers[i];
+        if (sampler.name == name || sampler.texture == name)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void ReleaseRenderPipeline(RenderPipeline* pipeline)
+{
+    if (pipeline)
+    {
+        gpBackend->releasePipeline(pipeline);
+    }
+}
+
+//----------------------------------------------------------------------
+// frames
+//----------------------------------------------------------------------
+
+void BeginRenderFrame()
+{
+    gpBackend->beginFrame();
+}
+
+float* AllocateRenderUniforms(const RenderPipeline* pipeline, int* offset)
+{
+    const RenderLayout& layout = pipeline->layout;
+    float* uniforms = gpBackend->allocateUniforms(layout.size, offset);
+    if (uniforms && layout.size > 0)
+    {
+        memcpy(uniforms, &layout.defaults[0], layout.size * sizeof(float));
+    }
+    return uniforms;
+}
+
+void BeginRenderPass(RenderTexture* target, const float* clearColor, bool clearDepth)
+{
+    gpBackend->beginPass(target, clearColor, clearDepth);
+}
+
+void SubmitRenderDraw(const RenderDraw& draw)
+{
+    gpBackend->draw(draw);
+}
+
+void EndRenderPass()
+{
+    gpBackend->endPass();
+}
+
+void EndRenderFrame()
+{
+    gpBackend->endFrame();
+}
+
+bool ReadRenderFrame(unsigned char* rgba)
+{
+    return gpBackend->readFrame(rgba);
+}
+
+RenderStats GetRenderStats()
+{
+    return gpBackend->getStats();
+}
+
+void ReleaseRenderBackend()
+{
+    if (gpBackend)
+    {
+        gpBackend->release();
+    }
+    gpBackend = NULL;
+}
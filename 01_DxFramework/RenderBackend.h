@@ -0,0 +1,233 @@
+//**********************************************************************
+//
+// RenderBackend.h
+//
+// What the samples' scenes need from a graphics API, without D3D9, so
+// they can be drawn where there is no Windows or no GPU. A backend is a
+// table of functions behind the calls below, picked at InitRenderBackend.
+//
+// Everything a draw needs is built at load: meshes, textures, render
+// targets and pipelines. A pipeline is one pass of an .fx file, its
+// vertex and pixel shader compiled with the shader interpreter (see
+// ShaderInterpreter.h) and the render states the pass sets. Uniforms
+// and samplers are looked up by name once, at load, too; every frame a
+// draw writes its uniforms into memory handed out from the backend's
+// per-frame ring and refers to them by offset.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include "ShaderInterpreter.h"
+
+// ---------- constants ------------------------------------
+
+#define RENDER_MAX_ATTRIBUTES   8
+#define RENDER_MAX_SAMPLERS     4
+
+// ---------- types ------------------------------------
+
+enum RenderFormat
+{
+    RENDER_FORMAT_RGBA8,
+    RENDER_FORMAT_R32F
+};
+
+enum RenderCull
+{
+    RENDER_CULL_NONE,
+    RENDER_CULL_CW,
+    RENDER_CULL_CCW             // D3D9's default
+};
+
+// what the vertex shader inputs with semantic read
+struct RenderAttribute
+{
+    const char* semantic;       // POSITION, NORMAL, TEXCOORD0...
+    int components;
+    const float* values;        // components per vertex
+};
+
+struct RenderMeshDesc
+{
+    int numVertices;
+    int numAttributes;
+    RenderAttribute attributes[RENDER_MAX_ATTRIBUTES];
+    int numIndices;
+    const unsigned int* indices;        // triangle list
+};
+
+// one pass of an effect
+struct RenderPipelineDesc
+{
+    const char* effect;         // .fx file
+    const char* technique;      // NULL for the first
+    const char* pass;           // NULL for the technique's first
+    const std::map<std::string, std::string>* defines;     // may be NULL
+    RenderFormat format;        // of the targets it draws into
+};
+
+// the render states a pass sets; the rest are D3D9's defaults
+struct RenderStates
+{
+    RenderCull cull;
+    bool depthTest;             // less or equal
+    bool depthWrite;
+};
+
+// a uniform of either shader. every uniform starts on a float4 and has
+// one per row, so a D3DXMATRIX or D3DXVECTOR4 is copied in as it is.
+struct RenderUniform
+{
+    std::string name;
+    int offset;                 // in floats
+    int rows;
+    int columns;
+};
+
+// how a pipeline's uniforms are laid out and its samplers numbered
+struct RenderLayout
+{
+    std::vector<RenderUniform> uniforms;
+    std::vector<ShaderSampler> samplers;
+    int size;                   // floats
+    std::vector<float> defaults;        // the initial values in the .fx
+};
+
+// what every backend's objects begin with
+struct RenderMesh
+{
+    int numVertices;
+    int numIndices;
+};
+
+struct RenderTexture
+{
+    int width;
+    int height;
+    bool cube;
+    bool target;
+    RenderFormat format;
+};
+
+struct RenderPipeline
+{
+    std::string name;           // effect, technique and pass, for messages
+    ShaderProgram vertexShader;
+    ShaderProgram pixelShader;
+    RenderLayout layout;
+    RenderStates states;
+    RenderFormat format;
+};
+
+struct RenderDraw
+{
+    const RenderPipeline* pipeline;
+    const RenderMesh* mesh;
+    const RenderTexture* textures[RENDER_MAX_SAMPLERS];     // by GetRenderSampler
+    int uniforms;               // from AllocateRenderUniforms
+};
+
+// since the frame began
+struct RenderStats
+{
+    int passes;
+    int draws;
+    int triangles;              // submitted, before clipping and culling
+    long long pixels;           // shaded
+    long long uniformBytes;     // written by the draws
+};
+
+// a backend's functions; see the prototypes below. createPipeline gets
+// a pipeline with the shaders compiled and returns its own, or NULL.
+struct RenderBackend
+{
+    const char* name;
+    bool (*init)(int width, int height);
+    void (*release)();
+    RenderMesh* (*createMesh)(const RenderMeshDesc& desc);
+    RenderTexture* (*createTexture)(int width, int height, bool cube, const unsigned char* rgba);
+    RenderTexture* (*createTarget)(int width, int height, RenderFormat format);
+    RenderPipeline* (*createPipeline)(const RenderPipeline& compiled);
+    void (*releaseMesh)(RenderMesh* mesh);
+    void (*releaseTexture)(RenderTexture* texture);
+    void (*releasePipeline)(RenderPipeline* pipeline);
+    void (*beginFrame)();
+    float* (*allocateUniforms)(int size, int* offset);
+    void (*beginPass)(RenderTexture* target, const float* clearColor, bool clearDepth);
+    void (*draw)(const RenderDraw& draw);
+    void (*endPass)();
+    void (*endFrame)();
+    bool (*readFrame)(unsigned char* rgba);
+    RenderStats (*getStats)();
+};
+
+// ---------------- function prototype  ------------------------
+
+// the backends there are; NULL where one is not built
+const RenderBackend* GetSoftwareRenderBackend();
+const RenderBackend* GetGlRenderBackend();
+
+// makes backend the one the calls below go to; the frame is width x height
+bool InitRenderBackend(const RenderBackend* backend, int width, int height);
+
+const RenderBackend* GetRenderBackend();
+
+// the attributes are copied; the mesh can be freed afterwards
+RenderMesh* CreateRenderMesh(const RenderMeshDesc& desc);
+
+// positions, normals, texture coordinates, tangents and binormals of a
+// text .x file (see XMeshLoader.h)
+RenderMesh* LoadRenderMesh(const char* filename);
+
+// rgba is width x height pixels, six faces of them for a cube
+RenderTexture* CreateRenderTexture(int width, int height, bool cube, const unsigned char* rgba);
+
+// the top mip of a .tga or .dds, 2D or cube
+RenderTexture* LoadRenderTexture(const char* filename);
+
+// drawn into, then read by later passes; has a depth buffer of its own
+RenderTexture* CreateRenderTarget(int width, int height, RenderFormat format);
+
+// NULL if the effect cannot be read or the pass compiled; says why on stderr
+RenderPipeline* CreateRenderPipeline(const RenderPipelineDesc& desc);
+
+// what CreateRenderPipeline hands the backend, without one: the pass's
+// shaders compiled, its states and its layout
+bool CompileRenderPipeline(const RenderPipelineDesc& desc, RenderPipeline* compiled);
+
+// where the uniform is in the pipeline's uniforms, in floats, or -1
+int GetRenderUniform(const RenderPipeline* pipeline, const char* name);
+
+// the index in RenderDraw::textures of a sampler, found by its name or
+// its texture's, or -1
+int GetRenderSampler(const RenderPipeline* pipeline, const char* name);
+
+void ReleaseRenderMesh(RenderMesh* mesh);
+void ReleaseRenderTexture(RenderTexture* texture);
+void ReleaseRenderPipeline(RenderPipeline* pipeline);
+
+// the uniforms allocated in a frame stay valid until it ends
+void BeginRenderFrame();
+
+// room for pipeline's uniforms in the frame's ring, filled with their
+// initial values; *offset is what RenderDraw::uniforms takes
+float* AllocateRenderUniforms(const RenderPipeline* pipeline, int* offset);
+
+// target NULL is the frame. clearColor (may be NULL) is RGBA.
+void BeginRenderPass(RenderTexture* target, const float* clearColor, bool clearDepth);
+
+void SubmitRenderDraw(const RenderDraw& draw);
+
+void EndRenderPass();
+
+void EndRenderFrame();
+
+// the last frame drawn, width x height RGBA rows top first
+bool ReadRenderFrame(unsigned char* rgba);
+
+RenderStats GetRenderStats();
+
+// frees nothing the scene created; release those first
+void ReleaseRenderBackend();
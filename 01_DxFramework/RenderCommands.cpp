@@ -0,0 +1,127 @@
+//**********************************************************************
+//
+// RenderCommands.cpp
+//
+// Recording and submitting command buffers (see RenderCommands.h).
+//
+//**********************************************************************
+
+#include "RenderCommands.h"
+#include <string.h>
+
+// where each command's uniforms went in the ring, while a buffer is submitted
+static std::vector<int> gRingOffsets;
+
+void ResetRenderCommands(RenderCommandBuffer* buffer)
+{
+    buffer->commands.clear();
+    buffer->uniforms.clear();
+}
+
+void RecordRenderPass(RenderCommandBuffer* buffer, RenderTexture* target, const float* clearColor,
+    bool clearDepth)
+{
+    RenderCommand command;
+    memset(&command, 0, sizeof(command));
+    command.type = RENDER_COMMAND_PASS;
+    command.target = target;
+    command.clear = (clearColor != NULL);
+    if (clearColor)
+    {
+        memcpy(command.clearColor, clearColor, sizeof(command.clearColor));
+    }
+    command.clearDepth = clearDepth;
+    buffer->commands.push_back(command);
+}
+
+float* RecordRenderUniforms(RenderCommandBuffer* buffer, const RenderPipeline* pipeline, int* offset)
+{
+    const RenderLayout& layout = pipeline->layout;
+    *offset = (int)buffer->uniforms.size();
+    if (layout.size == 0)
+    {
+        return NULL;
+    }
+
+    buffer->uniforms.insert(buffer->uniforms.end(), layout.defaults.begin(), layout.defaults.end());
+    return &buffer->uniforms[*offset];
+}
+
+void RecordRenderDraw(RenderCommandBuffer* buffer, const RenderDraw& draw)
+{
+    RenderCommand command;
+    memset(&command, 0, sizeof(command));
+    command.type = RENDER_COMMAND_DRAW;
+    command.draw = draw;
+    buffer->commands.push_back(command);
+}
+
+RenderCommandStats SubmitRenderCommands(RenderCommandBuffer* const* buffers, int numBuffers)
+{
+    const RenderBackend* backend = GetRenderBackend();
+
+    RenderCommandStats stats;
+    memset(&stats, 0, sizeof(stats));
+    bool inPass = false;
+
+    for (int b = 0; b < numBuffers; ++b)
+    {
+        const RenderCommandBuffer& buffer = *buffers[b];
+
+        // the ring's offsets are the backend's to align, so every draw's
+        // uniforms are allocated there on their own; all of them before
+        // the first draw, so a backend that uploads what was written
+        // since its last draw uploads the buffer's at once
+        gRingOffsets.assign(buffer.commands.size(), 0);
+        for (size_t c = 0; c < buffer.commands.size(); ++c)
+        {
+            const RenderCommand& command = buffer.commands[c];
+            if (command.type != RENDER_COMMAND_DRAW)
+            {
+                continue;
+            }
+
+            int size = command.draw.pipeline->layout.size;
+            float* uniforms = backend->allocateUniforms(size, &gRingOffsets[c]);
+            if (!uniforms && size > 0)
+            {
+                gRingOffsets[c] = -1;
+                continue;
+            }
+            if (size > 0)
+            {
+                memcpy(uniforms, &buffer.uniforms[command.draw.uniforms], size * sizeof(float));
+                stats.uniformBytes += size * sizeof(float);
+            }
+        }
+
+        for (size_t c = 0; c < buffer.commands.size(); ++c)
+        {
+            const RenderCommand& command = buffer.commands[c];
+            if (command.type == RENDER_COMMAND_PASS)
+            {
+                if (inPass)
+                {
+                    backend->endPass();
+                }
+                backend->beginPass(command.target, command.clear ? command.clearColor : NULL,
+                    command.clearDepth);
+                inPass = true;
+                ++stats.passes;
+            }
+            else if (gRingOffsets[c] >= 0)
+            {
+                RenderDraw draw = command.draw;
+                draw.uniforms = gRingOffsets[c];
+                backend->draw(draw);
+                ++stats.draws;
+            }
+        }
+    }
+
+    if (inPass)
+    {
+        backend->endPass();
+    }
+    return stats;
+}
@@ -0,0 +1,77 @@
+//**********************************************************************
+//
+// RenderCommands.h
+//
+// Command buffers for the render backend (see RenderBackend.h), so a
+// frame's draws can be recorded on many threads at once. Recording does
+// not touch the backend: a command buffer keeps the passes and draws
+// recorded into it, and the uniforms of every draw in memory of its own.
+// Any thread may record into a buffer no other thread is recording into.
+//
+// The thread the backend belongs to then submits the buffers, in the
+// order it is given them, copying each draw's uniforms into the frame's
+// ring as it goes. A pass begun in one buffer goes on in the buffers
+// after it until another is begun, so a pass can be split over as many
+// buffers as threads record it, and what is drawn, and in what order,
+// does not depend on which thread finished first.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include "RenderBackend.h"
+
+// ---------- types ------------------------------------
+
+enum RenderCommandType
+{
+    RENDER_COMMAND_PASS,
+    RENDER_COMMAND_DRAW
+};
+
+struct RenderCommand
+{
+    RenderCommandType type;
+    RenderTexture* target;      // a pass's; NULL is the frame
+    float clearColor[4];
+    bool clear;                 // the color
+    bool clearDepth;
+    RenderDraw draw;            // uniforms is an offset in the buffer's
+};
+
+struct RenderCommandBuffer
+{
+    std::vector<RenderCommand> commands;
+    std::vector<float> uniforms;
+};
+
+// what submitting buffers did
+struct RenderCommandStats
+{
+    int passes;
+    int draws;                  // not those there was no room in the ring for
+    long long uniformBytes;     // copied into the ring
+};
+
+// ---------------- function prototype  ------------------------
+
+// empties buffer, keeping its memory for the next frame
+void ResetRenderCommands(RenderCommandBuffer* buffer);
+
+// ends the pass going on when submitted, if any, and begins one.
+// target NULL is the frame; clearColor (may be NULL) is RGBA.
+void RecordRenderPass(RenderCommandBuffer* buffer, RenderTexture* target, const float* clearColor,
+    bool clearDepth);
+
+// room for pipeline's uniforms in buffer, filled with their initial
+// values; *offset is what RenderDraw::uniforms takes. the pointer is
+// only valid until the next call on the same buffer.
+float* RecordRenderUniforms(RenderCommandBuffer* buffer, const RenderPipeline* pipeline, int* offset);
+
+void RecordRenderDraw(RenderCommandBuffer* buffer, const RenderDraw& draw);
+
+// between BeginRenderFrame and EndRenderFrame, on the backend's thread;
+// the last pass begun is ended. a draw there is no room in the frame's
+// uniform ring for is left out.
+RenderCommandStats SubmitRenderCommands(RenderCommandBuffer* const* buffers, int numBuffers);
@@ -0,0 +1,233 @@
+//**********************************************************************
+//
+// RenderTargetPool.cpp
+//
+// Render targets and depth-stencil surfaces handed out by width,
+// height, format and usage. A request takes the smallest free target
+// it fits, and creates one of exactly the requested size only when
+// none does; so once the largest size has been seen, changing the
+// resolution stops allocating.
+//
+//**********************************************************************
+
+#include "RenderTargetPool.h"
+#include <windows.h>
+#include <stdio.h>
+#include <vector>
+
+static LPDIRECT3DDEVICE9 gpDevice = NULL;
+static std::vector<RenderTarget*> gTargets;
+static long long gFrame = 0;
+static RenderTargetPoolStats gStats;
+
+
+//----------------------------------------------------------------------
+// helpers
+//----------------------------------------------------------------------
+
+static UINT BytesPerPixel(D3DFORMAT format)
+{
+    switch (format)
+    {
+    case D3DFMT_R5G6B5:
+    case D3DFMT_R16F:
+    case D3DFMT_D16:
+        return 2;
+    case D3DFMT_A16B16G16R16:
+    case D3DFMT_A16B16G16R16F:
+    case D3DFMT_G32R32F:
+        return 8;
+    case D3DFMT_A32B32G32R32F:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+static bool Fits(const RenderTarget* target, UINT width, UINT height, D3DFORMAT format, DWORD usage)
+{
+    if (target->inUse || target->format != format || target->usage != usage ||
+        target->width < width || target->height < height)
+    {
+        return false;
+    }
+
+    // a much larger target is better spent on a larger request
+    double area = (double)target->width * target->height;
+    return area <= (double)width * height * RENDER_TARGET_POOL_MAX_WASTE;
+}
+
+static RenderTarget* CreateTarget(UINT width, UINT height, D3DFORMAT format, DWORD usage)
+{
+    RenderTarget* target = new RenderTarget;
+    target->width = width;
+    target->height = height;
+    target->format = format;
+    target->usage = usage;
+    target->texture = NULL;
+    target->surface = NULL;
+    target->inUse = false;
+    target->lastUsedFrame = gFrame;
+
+    if (usage == D3DUSAGE_DEPTHSTENCIL)
+    {
+        if (FAILED(gpDevice->CreateDepthStencilSurface(width, height, format,
+            D3DMULTISAMPLE_NONE, 0, TRUE, &target->surface, NULL)))
+        {
+            OutputDebugString("render target pool: failed at creating a depth-stencil surface\n");
+            delete target;
+            return NULL;
+        }
+    }
+    else
+    {
+        if (FAILED(gpDevice->CreateTexture(width, height, 1, D3DUSAGE_RENDERTARGET,
+            format, D3DPOOL_DEFAULT, &target->texture, NULL)))
+        {
+            OutputDebugString("render target pool: failed at creating a render target\n");
+            delete target;
+            return NULL;
+        }
+        target->texture->GetSurfaceLevel(0, &target->surface);
+    }
+
+    return target;
+}
+
+static void DestroyTarget(RenderTarget* target)
+{
+    if (target->surface)
+    {
+        target->surface->Release();
+    }
+    if (target->texture)
+    {
+        target->texture->Release();
+    }
+    delete target;
+}
+
+static void UpdateResidentBytes()
+{
+    gStats.numTargets = (int)gTargets.size();
+    gStats.bytesResident = 0;
+    for (size_t i = 0; i < gTargets.size(); ++i)
+    {
+        gStats.bytesResident += GetRenderTargetBytes(gTargets[i]->width, gTargets[i]->height, gTargets[i]->format);
+    }
+
+    if (gStats.bytesResident > gStats.peakBytesResident)
+    {
+        gStats.peakBytesResident = gStats.bytesResident;
+    }
+}
+
+//----------------------------------------------------------------------
+// interface
+//----------------------------------------------------------------------
+bool InitRenderTargetPool(LPDIRECT3DDEVICE9 device)
+{
+    gpDevice = device;
+    gFrame = 0;
+    ZeroMemory(&gStats, sizeof(gStats));
+    return true;
+}
+
+RenderTarget* AcquireRenderTarget(UINT width, UINT height, D3DFORMAT format, DWORD usage)
+{
+    RenderTarget* best = NULL;
+    for (size_t i = 0; i < gTargets.size(); ++i)
+    {
+        RenderTarget* target = gTargets[i];
+        if (Fits(target, width, height, format, usage) &&
+            (!best || target->width * target->height < best->width * best->height))
+        {
+            best = target;
+        }
+    }
+
+    if (best)
+    {
+        ++gStats.hits;
+    }
+    else
+    {
+        best = CreateTarget(width, height, format, usage);
+        if (!best)
+        {
+            return NULL;
+        }
+
+        ++gStats.misses;
+        gTargets.push_back(best);
+        UpdateResidentBytes();
+    }
+
+    best->inUse = true;
+    best->lastUsedFrame = gFrame;
+    return best;
+}
+
+void ReleaseRenderTarget(RenderTarget* target)
+{
+    if (target)
+    {
+        target->inUse = false;
+    }
+}
+
+void AdvanceRenderTargetPool()
+{
+    ++gFrame;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < gTargets.size(); ++i)
+    {
+        RenderTarget* target = gTargets[i];
+        if (!target->inUse && gFrame - target->lastUsedFrame > RENDER_TARGET_POOL_MAX_IDLE_FRAMES)
+        {
+            DestroyTarget(target);
+            ++gStats.freed;
+        }
+        else
+        {
+            gTargets[kept++] = target;
+        }
+    }
+
+    if (kept != gTargets.size())
+    {
+        gTargets.resize(kept);
+        UpdateResidentBytes();
+    }
+}
+
+UINT GetRenderTargetBytes(UINT width, UINT height, D3DFORMAT format)
+{
+    return width * height * BytesPerPixel(format);
+}
+
+RenderTargetPoolStats GetRenderTargetPoolStats()
+{
+    return gStats;
+}
+
+void ReleaseRenderTargetPool()
+{
+    if (gStats.hits + gStats.misses > 0)
+    {
+        char str[256];
+        sprintf(str, "render target pool: %lld hits, %lld misses, %lld freed idle, peak %u KB resident\n",
+            gStats.hits, gStats.misses, gStats.freed, gStats.peakBytesResident / 1024);
+        OutputDebugString(str);
+    }
+
+    for (size_t i = 0; i < gTargets.size(); ++i)
+    {
+        DestroyTarget(gTargets[i]);
+    }
+    gTargets.clear();
+    UpdateResidentBytes();
+
+    gpDevice = NULL;
+}
@@ -0,0 +1,73 @@
+//**********************************************************************
+//
+// RenderTargetPool.h
+//
+// Render targets and depth-stencil surfaces handed out by width,
+// height, format and usage. A released target goes back to the pool and
+// is given to the next request it fits, in the same frame or a later
+// one; targets nobody asked for in a while are freed.
+//
+// A request may be served by a larger target of the same format, so
+// lowering the resolution never allocates. The caller then draws into
+// the top-left width x height of it and scales texture coordinates by
+// the ratio of the two sizes when sampling.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <d3d9.h>
+
+// ---------- constants ------------------------------------
+
+// a free target serves a request down to this fraction of its area
+#define RENDER_TARGET_POOL_MAX_WASTE        4
+
+// frames a free target is kept without being used
+#define RENDER_TARGET_POOL_MAX_IDLE_FRAMES  120
+
+// ---------- types ------------------------------------
+
+struct RenderTarget
+{
+    UINT width;                 // allocated size, at least the requested one
+    UINT height;
+    D3DFORMAT format;
+    DWORD usage;                // D3DUSAGE_RENDERTARGET or D3DUSAGE_DEPTHSTENCIL
+    LPDIRECT3DTEXTURE9 texture; // NULL for depth-stencil surfaces
+    LPDIRECT3DSURFACE9 surface;
+    bool inUse;
+    long long lastUsedFrame;
+};
+
+struct RenderTargetPoolStats
+{
+    long long hits;             // requests served by a pooled target
+    long long misses;           // requests that created one
+    long long freed;            // targets freed for being idle
+    int numTargets;
+    UINT bytesResident;
+    UINT peakBytesResident;
+};
+
+// ---------------- function prototype  ------------------------
+
+bool InitRenderTargetPool(LPDIRECT3DDEVICE9 device);
+
+// a free target of at least width x height, or NULL if one cannot be created
+RenderTarget* AcquireRenderTarget(UINT width, UINT height, D3DFORMAT format, DWORD usage);
+
+// gives target back to the pool; it stays valid until the pool frees it
+void ReleaseRenderTarget(RenderTarget* target);
+
+// call once per frame; frees the targets idle for too long
+void AdvanceRenderTargetPool();
+
+// estimated video memory of a surface
+UINT GetRenderTargetBytes(UINT width, UINT height, D3DFORMAT format);
+
+RenderTargetPoolStats GetRenderTargetPoolStats();
+
+// frees every target and writes the statistics
+void ReleaseRenderTargetPool();
@@ -10,7 +10,21 @@
 //**********************************************************************
 
 #include "ShaderFramework.h"
+#include "AssetLoaders.h"
+#include "AssetRegistry.h"
+#include "AsyncLoader.h"
+#include "CpuProfiler.h"
+#include "DdsLoader.h"
+#include "FileUtil.h"
+#include "FrameBenchmark.h"
+#include "FramePipeline.h"
+#include "GoldenTest.h"
+#include "HotReload.h"
+#include "JobSystem.h"
+#include "SimulationClock.h"
+#include "TgaLoader.h"
 #include <stdio.h>
+#include <string.h>
 
 
 //----------------------------------------------------------------------
@@ -23,6 +37,7 @@
 #define ASPECT_RATIO (WIN_WIDTH/(float)WIN_HEIGHT)
 #define NEAR_PLANE 1
 #define FAR_PLANE 10000
+#define ROTATION_SPEED (24.0f * PI / 180.0f) // radians per second
 
 // D3D-related
 LPDIRECT3D9             gpD3D = NULL;					// D3D
@@ -59,6 +74,17 @@ LPDIRECT3DTEXTURE9      gpTeapotNM = NULL;
 LPDIRECT3DTEXTURE9      gpTeapotSM = NULL;
 LPDIRECT3DCUBETEXTURE9  gpSnowENV = NULL;
 
+// stand-ins for the textures until they finish loading
+LPDIRECT3DTEXTURE9      gpPlaceholderDM = NULL;
+LPDIRECT3DTEXTURE9      gpPlaceholderNM = NULL;
+LPDIRECT3DTEXTURE9      gpPlaceholderSM = NULL;
+LPDIRECT3DCUBETEXTURE9  gpPlaceholderENV = NULL;
+
+// startup timings
+LARGE_INTEGER           gStartTime;
+bool                    gFirstFramePresented = false;
+bool                    gFullyLoaded = false;
+
 // scene render target
 LPDIRECT3DTEXTURE9      gpSceneRenderTarget = NULL;
 
@@ -67,17 +93,39 @@ const char*				gAppName = "Super Simple Shader Demo Framework";
 
 // Rotation
 float gRotY = 0.0f;
+float gPrevRotY = 0.0f;     // at the previous simulation step
 
 // index of postprocess shader to use
 int gPostProcessIndex = 0;
 
+// build the next frame on a worker thread while this one renders
+bool gPipelineFrames = false;
+
+// record a CPU trace from startup, so loading shows up in it
+bool gTraceFromStartup = false;
+
 //-----------------------------------------------------------------------
 // Application entry point/message loop
 //-----------------------------------------------------------------------
 
 // entry point
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+    // -benchmark and -golden run headless and quit
+    InitBenchmark(lpCmdLine);
+    InitGoldenTest(lpCmdLine);
+
+    // -record and -replay capture and play back frame times
+    InitSimulationClock(lpCmdLine, gBenchmark.enabled || gGoldenTest.enabled);
+
+    // -pipelined builds the next frame while this one renders (see
+    // FramePipeline.h). golden images need every frame built right
+    // before it is drawn.
+    gPipelineFrames = strstr(lpCmdLine, "-pipelined") && !gGoldenTest.enabled;
+
+    // -trace records from startup; P (or quitting) writes the trace out
+    gTraceFromStartup = strstr(lpCmdLine, "-trace") != NULL;
+
     // register windows class
     WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, MsgProc, 0L, 0L,
         GetModuleHandle(NULL), NULL, NULL, NULL, NULL,
@@ -100,12 +148,22 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
     ptDiff.y = (rcWindow.bottom - rcWindow.top) - rcClient.bottom;
     MoveWindow(hWnd, rcWindow.left, rcWindow.top, WIN_WIDTH + ptDiff.x, WIN_HEIGHT + ptDiff.y, TRUE);
 
-    ShowWindow(hWnd, SW_SHOWDEFAULT);
+    ShowWindow(hWnd, (gBenchmark.enabled || gGoldenTest.enabled) ? SW_HIDE : SW_SHOWDEFAULT);
     UpdateWindow(hWnd);
 
     // Initialize everything including D3D
     if (!InitEverything(hWnd))
         PostQuitMessage(1);
+    else if (gBenchmark.enabled)
+    {
+        RunBenchmark(PlayDemo);
+        PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+    }
+    else if (gGoldenTest.enabled)
+    {
+        RunGoldenTest(gpD3DDevice, PlayDemo);
+        PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+    }
 
     // Message loop
     MSG msg;
@@ -124,7 +182,7 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
     }
 
     UnregisterClass(gAppName, wc.hInstance);
-    return 0;
+    return GetGoldenTestExitCode();
 }
 
 // Message handler
@@ -155,6 +213,19 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
     case '3':
         gPostProcessIndex = keyPress - '0' - 1;
         break;
+        // P starts a CPU trace, pressing it again writes it out
+    case 'P':
+        if (IsCpuProfilerEnabled())
+        {
+            SetCpuProfilerEnabled(false);
+            WriteChromeTrace(CPU_TRACE_FILE);
+            OutputDebugString("CPU trace written to " CPU_TRACE_FILE "\n");
+        }
+        else
+        {
+            SetCpuProfilerEnabled(true);
+        }
+        break;
         // when ESC key is pressed, quit the demo
     case VK_ESCAPE:
         PostMessage(hWnd, WM_DESTROY, 0L, 0L);
@@ -167,58 +238,65 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 //------------------------------------------------------------
 void PlayDemo()
 {
-    Update();
-    RenderFrame();
-}
+    PROFILE_SCOPE("Frame");
 
-// Game logic update
-void Update()
-{
-}
+    int numLoading = 0;
+    {
+        PROFILE_SCOPE("AssetUpdate");
 
-//------------------------------------------------------------
-// Rendering
-//------------------------------------------------------------
+        // swap in the assets that finished loading since the last frame
+        numLoading = PumpAsyncLoads();
 
-void RenderFrame()
-{
-    D3DCOLOR bgColor = 0xFF0000FF;	// background color - blue
+        // start reloading the assets that were edited
+        UpdateHotReload();
+    }
 
-    gpD3DDevice->Clear(0, NULL, (D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER), bgColor, 1.0f, 0);
+    // the next frame starts building while this one renders
+    const FrameData* frame = (const FrameData*)BeginPipelinedFrame();
+    RenderFrame(frame);
+    EndPipelinedFrame();
 
-    gpD3DDevice->BeginScene();
+    EndHotReloadFrame();
+
+    char str[64];
+    if (!gFirstFramePresented)
     {
-        RenderScene();				// draw 3D objects and so on
-        RenderInfo();				// show debug info
+        gFirstFramePresented = true;
+        sprintf(str, "time to first frame: %.2f ms\n", GetMsSinceStart());
+        OutputDebugString(str);
     }
-    gpD3DDevice->EndScene();
 
-    gpD3DDevice->Present(NULL, NULL, NULL, NULL);
+    if (!gFullyLoaded && numLoading == 0)
+    {
+        gFullyLoaded = true;
+        sprintf(str, "time to fully loaded: %.2f ms\n", GetMsSinceStart());
+        OutputDebugString(str);
+    }
 }
 
+// milliseconds since InitEverything started
+double GetMsSinceStart()
+{
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+
+    return (now.QuadPart - gStartTime.QuadPart) * 1000.0 / frequency.QuadPart;
+}
 
-// draw 3D objects and so on
-void RenderScene()
+// runs the simulation up to the next frame and works out what it
+// draws; called on the frame pipeline's worker thread
+void BuildFrame(void* data)
 {
-    // create light-view matrix
-    D3DXMATRIXA16 matLightView;
-    {
-        D3DXVECTOR3 vEyePt(gWorldCameraPosition.x, gWorldCameraPosition.y, gWorldCameraPosition.z);
-        D3DXVECTOR3 vLookatPt(0.0f, 0.0f, 0.0f);
-        D3DXVECTOR3 vUpVec(0.0f, 1.0f, 0.0f);
-        D3DXMatrixLookAtLH(&matLightView, &vEyePt, &vLookatPt, &vUpVec);
-    }
+    FrameData* frame = (FrameData*)data;
 
-    // create light-projection matrix
-    D3DXMATRIXA16 matLightProjection;
+    // run as many fixed steps as the elapsed time covers
+    int numSteps = AdvanceSimulationClock();
+    for (int i = 0; i < numSteps; ++i)
     {
-        D3DXMatrixPerspectiveFovLH(&matLightProjection, D3DX_PI / 4.0f, 1, 1, 1000);
+        Update();
     }
 
-    // projection matrix
-    D3DXMATRIXA16 matProjection;
-    D3DXMatrixPerspectiveFovLH(&matProjection, FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
-
     D3DXMATRIXA16 matViewProjection;
     {
         // View Matrix
@@ -236,19 +314,64 @@ void RenderScene()
         D3DXMatrixMultiply(&matViewProjection, &matView, &matProjection);
     }
 
-    gRotY += 0.4f * PI / 180.0f;
+    // interpolate between the last two simulation steps
+    float rotationY = gPrevRotY + (gRotY - gPrevRotY) * GetSimulationAlpha();
+
+    // golden image tests render fixed rotations
+    if (gGoldenTest.enabled)
+    {
+        rotationY = GetGoldenRotation();
+    }
+
+    // World Matrix
+    D3DXMatrixRotationY(&frame->world, rotationY);
+    D3DXMatrixMultiply(&frame->worldViewProjection, &matViewProjection, &frame->world);
+}
+
+// Game logic update, run once per simulation step
+void Update()
+{
+    PROFILE_SCOPE("Update");
 
+    // rotate 24 degrees per second
+    gPrevRotY = gRotY;
+    gRotY += ROTATION_SPEED * SIMULATION_TIMESTEP;
     if (gRotY > 2 * PI)
     {
+        // wrap both, so interpolating between them stays smooth
         gRotY -= 2 * PI;
+        gPrevRotY -= 2 * PI;
     }
+}
 
-    // World Matrix
-    D3DXMATRIXA16 matWorld;
-    D3DXMatrixRotationY(&matWorld, gRotY);
+//------------------------------------------------------------
+// Rendering
+//------------------------------------------------------------
 
-    D3DXMATRIXA16 matWorldViewProjection;
-    D3DXMatrixMultiply(&matWorldViewProjection, &matViewProjection, &matWorld);
+void RenderFrame(const FrameData* frame)
+{
+    D3DCOLOR bgColor = 0xFF0000FF;	// background color - blue
+
+    gpD3DDevice->Clear(0, NULL, (D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER), bgColor, 1.0f, 0);
+
+    gpD3DDevice->BeginScene();
+    {
+        RenderScene(frame);			// draw 3D objects and so on
+        RenderInfo();				// show debug info
+    }
+    gpD3DDevice->EndScene();
+
+    {
+        PROFILE_SCOPE("Present");
+        gpD3DDevice->Present(NULL, NULL, NULL, NULL);
+    }
+}
+
+
+// draw 3D objects and so on
+void RenderScene(const FrameData* frame)
+{
+    PROFILE_SCOPE("RenderScene");
 
     // 1. draw the scene into the render target
     // current hardware backbuffer
@@ -270,34 +393,41 @@ void RenderScene()
     // clears the shadow map from the last frame
     gpD3DDevice->Clear(0, NULL, (D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER), 0xFFFFFFFF, 1.0f, 0);
 
-    // Vectors
-    gpEnvironmentMappingShader->SetVector("gLightColor", &gLightColor);
-    gpEnvironmentMappingShader->SetVector("gWorldLightPosition", &gWorldLightPosition);
-    gpEnvironmentMappingShader->SetVector("gWorldCameraPosition", &gWorldCameraPosition);
+    // nothing to draw with until the shader and the model are in
+    if (gpEnvironmentMappingShader && gpTeapot)
+    {
+        PROFILE_SCOPE("ScenePass");
+
+        // Vectors
+        gpEnvironmentMappingShader->SetVector("gLightColor", &gLightColor);
+        gpEnvironmentMappingShader->SetVector("gWorldLightPosition", &gWorldLightPosition);
+        gpEnvironmentMappingShader->SetVector("gWorldCameraPosition", &gWorldCameraPosition);
     
-    // Matrices
-    gpEnvironmentMappingShader->SetMatrix("gWorldMatrix", &matWorld);
-    gpEnvironmentMappingShader->SetMatrix("gWorldViewProjectionMatrix", &matWorldViewProjection);
+        // Matrices
+        gpEnvironmentMappingShader->SetMatrix("gWorldMatrix", &frame->world);
+        gpEnvironmentMappingShader->SetMatrix("gWorldViewProjectionMatrix", &frame->worldViewProjection);
     
-    // Textures
-    gpEnvironmentMappingShader->SetTexture("DiffuseMap_Tex", gpTeapotDM);
-    gpEnvironmentMappingShader->SetTexture("NormalMap_Tex", gpTeapotNM);
-    gpEnvironmentMappingShader->SetTexture("SpecularMap_Tex", gpTeapotSM);
-    gpEnvironmentMappingShader->SetTexture("EnvironmentMap_Tex", gpSnowENV);
+        // Textures
+        gpEnvironmentMappingShader->SetTexture("DiffuseMap_Tex", gpTeapotDM);
+        gpEnvironmentMappingShader->SetTexture("NormalMap_Tex", gpTeapotNM);
+        gpEnvironmentMappingShader->SetTexture("SpecularMap_Tex", gpTeapotSM);
+        gpEnvironmentMappingShader->SetTexture("EnvironmentMap_Tex", gpSnowENV);
 
-    UINT numPasses = 0;
-    gpEnvironmentMappingShader->Begin(&numPasses, NULL);
+        UINT numPasses = 0;
+        gpEnvironmentMappingShader->Begin(&numPasses, NULL);
 
-    for (UINT i = 0; i < numPasses; ++i)
-    {
-        gpEnvironmentMappingShader->BeginPass(i);
-        gpTeapot->DrawSubset(0);
-        gpEnvironmentMappingShader->EndPass();
-    }
+        for (UINT i = 0; i < numPasses; ++i)
+        {
+            gpEnvironmentMappingShader->BeginPass(i);
+            gpTeapot->DrawSubset(0);
+            gpEnvironmentMappingShader->EndPass();
+        }
 
-    gpEnvironmentMappingShader->End();
+        gpEnvironmentMappingShader->End();
+    }
 
     // 2. apply post-processing
+    PROFILE_SCOPE("PostProcess");
 
     // use hardware backbuffer
     gpD3DDevice->SetRenderTarget(0, pHWBackBuffer);
@@ -316,7 +446,12 @@ void RenderScene()
         effectToUse = gpSepia;
     }
 
-    numPasses = 0;
+    if (!effectToUse)
+    {
+        return;
+    }
+
+    UINT numPasses = 0;
     effectToUse->SetTexture("SceneTexture_Tex", gpSceneRenderTarget);
     effectToUse->Begin(&numPasses, NULL);
     {
@@ -340,6 +475,8 @@ void RenderScene()
 // show debug info
 void RenderInfo()
 {
+    PROFILE_SCOPE("RenderInfo");
+
     // text color
     D3DCOLOR fontColor = D3DCOLOR_ARGB(255, 255, 255, 255);
 
@@ -351,7 +488,7 @@ void RenderInfo()
     rct.bottom = WIN_HEIGHT / 3;
 
     // show debug keys
-    gpFont->DrawText(NULL, "Demo Framework\n\nESC: Quit demo\n1: Color \n2: Black and White\n3: Sepia", -1, &rct, 0, fontColor);
+    gpFont->DrawText(NULL, "Demo Framework\n\nESC: Quit demo\n1: Color \n2: Black and White\n3: Sepia\nP: Start/stop CPU trace", -1, &rct, 0, fontColor);
 }
 
 //------------------------------------------------------------
@@ -359,6 +496,10 @@ void RenderInfo()
 //------------------------------------------------------------
 bool InitEverything(HWND hWnd)
 {
+    QueryPerformanceCounter(&gStartTime);
+    InitCpuProfiler();
+    SetCpuProfilerEnabled(gTraceFromStartup);
+
     // init D3D
     if (!InitD3D(hWnd))
     {
@@ -378,13 +519,37 @@ bool InitEverything(HWND hWnd)
         return false;
     }
 
+    // build each frame on a worker thread while the previous one renders
+    InitFramePipeline(gpD3DDevice, BuildFrame, sizeof(FrameData), gPipelineFrames);
+
     // loading models, shaders and textures
+    InitAssetRegistry();
+    InitJobSystem(0);                       // decoding splits across all cores
+    InitAsyncLoader(ASYNC_LOADER_THREADS);
+
+    if (!InitHotReload("."))
+    {
+        OutputDebugString("hot reload is not available\n");
+    }
+
     if (!LoadAssets())
     {
         OutputDebugString("Failed to load assets.");
         return false;
     }
 
+    // benchmarks and golden image tests need the fully loaded scene
+    if (gBenchmark.enabled || gGoldenTest.enabled)
+    {
+        WaitForAsyncLoads();
+    }
+
+#if BENCHMARK_TEXTURE_LOADING
+    WaitForAsyncLoads();
+    BenchmarkTextureLoading();
+    BenchmarkBlockDecoding();
+#endif
+
     // load fonts
     if (FAILED(D3DXCreateFont(gpD3DDevice, 20, 10, FW_BOLD, 1, FALSE, DEFAULT_CHARSET,
         OUT_DEFAULT_PRECIS, DEFAULT_QUALITY, (DEFAULT_PITCH | FF_DONTCARE),
@@ -416,18 +581,18 @@ bool InitD3D(HWND hWnd)
     d3dpp.BackBufferCount = 1;
     d3dpp.MultiSampleType = D3DMULTISAMPLE_NONE;
     d3dpp.MultiSampleQuality = 0;
-    d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+    d3dpp.SwapEffect = gGoldenTest.enabled ? D3DSWAPEFFECT_COPY : D3DSWAPEFFECT_DISCARD;
     d3dpp.hDeviceWindow = hWnd;
     d3dpp.Windowed = TRUE;
     d3dpp.EnableAutoDepthStencil = TRUE;
     d3dpp.AutoDepthStencilFormat = D3DFMT_D24X8;
     d3dpp.Flags = D3DPRESENTFLAG_DISCARD_DEPTHSTENCIL;
     d3dpp.FullScreen_RefreshRateInHz = 0;
-    d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_ONE;
+    d3dpp.PresentationInterval = gBenchmark.enabled ? D3DPRESENT_INTERVAL_IMMEDIATE : D3DPRESENT_INTERVAL_ONE;
 
     // create D3D device
     if (FAILED(gpD3D->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, hWnd,
-        D3DCREATE_HARDWARE_VERTEXPROCESSING,
+        D3DCREATE_HARDWARE_VERTEXPROCESSING | D3DCREATE_MULTITHREADED,
         &d3dpp, &gpD3DDevice)))
     {
         return false;
@@ -436,140 +601,590 @@ bool InitD3D(HWND hWnd)
     return true;
 }
 
-bool LoadAssets()
+// the loaders in the shape the async loader wants
+static IUnknown* LoadShaderJob(const char * filename)
 {
-    // cubemap
-    D3DXCreateCubeTextureFromFile(gpD3DDevice, "Snow_ENV.dds", &gpSnowENV);
+    return LoadShader(filename);
+}
 
-    if (!gpSnowENV)
+static IUnknown* LoadTextureJob(const char * filename)
+{
+    return LoadTexture(filename);
+}
+
+static IUnknown* LoadCubeTextureJob(const char * filename)
+{
+    return LoadCubeTexture(filename);
+}
+
+static IUnknown* LoadModelJob(const char * filename)
+{
+    return LoadModel(filename);
+}
+
+// puts a finished asset into the global userData points to, replacing
+// its placeholder. runs between frames.
+static void OnAssetLoaded(const char * filename, IUnknown* resource, void* userData)
+{
+    if (!resource)
     {
-        return false;
+        OutputDebugString("Failed to load assets.");
+        PostQuitMessage(1);
+        return;
     }
 
-    // shader loading
-    gpEnvironmentMappingShader = LoadShader("EnvironmentMapping.fx");
+    IUnknown** asset = (IUnknown**)userData;
 
-    if (!gpEnvironmentMappingShader)
+    if (*asset)
     {
-        return false;
+        (*asset)->Release();
     }
-    
-    gpNoEffect = LoadShader("NoEffect.fx");
 
-    if (!gpNoEffect)
+    *asset = resource;
+}
+
+// 1x1 texture of a single color
+static LPDIRECT3DTEXTURE9 CreatePlaceholderTexture(D3DCOLOR color)
+{
+    LPDIRECT3DTEXTURE9 ret = NULL;
+
+    if (FAILED(gpD3DDevice->CreateTexture(1, 1, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &ret, NULL)))
     {
-        return false;
+        return NULL;
     }
 
-    gpGrayScale = LoadShader("Grayscale.fx");
+    D3DLOCKED_RECT lockedRect;
+    if (SUCCEEDED(ret->LockRect(0, &lockedRect, NULL, 0)))
+    {
+        *(D3DCOLOR*)lockedRect.pBits = color;
+        ret->UnlockRect(0);
+    }
+
+    return ret;
+}
+
+static LPDIRECT3DCUBETEXTURE9 CreatePlaceholderCubeTexture(D3DCOLOR color)
+{
+    LPDIRECT3DCUBETEXTURE9 ret = NULL;
+
+    if (FAILED(gpD3DDevice->CreateCubeTexture(1, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &ret, NULL)))
+    {
+        return NULL;
+    }
 
-    if (!gpGrayScale)
+    for (int face = 0; face < 6; ++face)
     {
-        return false;
+        D3DLOCKED_RECT lockedRect;
+        if (SUCCEEDED(ret->LockRect((D3DCUBEMAP_FACES)face, 0, &lockedRect, NULL, 0)))
+        {
+            *(D3DCOLOR*)lockedRect.pBits = color;
+            ret->UnlockRect((D3DCUBEMAP_FACES)face, 0);
+        }
     }
 
-    gpSepia = LoadShader("Sepia.fx");
+    return ret;
+}
+
+// queues every asset on the async loader. the first frames render with
+// placeholder textures; the shaders and the model go first since
+// nothing is drawn without them.
+bool LoadAssets()
+{
+    PROFILE_SCOPE("LoadAssets");
+
+    // placeholders: grey diffuse, flat normal, no specular, grey sky
+    gpPlaceholderDM = CreatePlaceholderTexture(D3DCOLOR_ARGB(255, 128, 128, 128));
+    gpPlaceholderNM = CreatePlaceholderTexture(D3DCOLOR_ARGB(255, 128, 128, 255));
+    gpPlaceholderSM = CreatePlaceholderTexture(D3DCOLOR_ARGB(255, 0, 0, 0));
+    gpPlaceholderENV = CreatePlaceholderCubeTexture(D3DCOLOR_ARGB(255, 128, 128, 128));
 
-    if (!gpSepia)
+    if (!gpPlaceholderDM || !gpPlaceholderNM || !gpPlaceholderSM || !gpPlaceholderENV)
     {
         return false;
     }
 
+    gpTeapotDM = gpPlaceholderDM;
+    gpTeapotDM->AddRef();
+    gpTeapotNM = gpPlaceholderNM;
+    gpTeapotNM->AddRef();
+    gpTeapotSM = gpPlaceholderSM;
+    gpTeapotSM->AddRef();
+    gpSnowENV = gpPlaceholderENV;
+    gpSnowENV->AddRef();
+
+    // shader loading
+    LoadAsync("EnvironmentMapping.fx", NULL, LoadShaderJob, ASYNC_PRIORITY_HIGH, OnAssetLoaded, &gpEnvironmentMappingShader);
+    LoadAsync("NoEffect.fx", NULL, LoadShaderJob, ASYNC_PRIORITY_HIGH, OnAssetLoaded, &gpNoEffect);
+    LoadAsync("Grayscale.fx", NULL, LoadShaderJob, ASYNC_PRIORITY_NORMAL, OnAssetLoaded, &gpGrayScale);
+    LoadAsync("Sepia.fx", NULL, LoadShaderJob, ASYNC_PRIORITY_NORMAL, OnAssetLoaded, &gpSepia);
+
+    // model loading
+    LoadAsync("TeapotWithTangent.x", NULL, LoadModelJob, ASYNC_PRIORITY_HIGH, OnAssetLoaded, &gpTeapot);
+
     // textures
-    gpTeapotDM = LoadTexture("Fieldstone_DM.tga");
-    
-    if (!gpTeapotDM)
+    // the DDSs are baked from the TGAs by Tools/TextureBaker (BC1 diffuse,
+    // BC5 normal, BC4 specular). the TGAs are the fallback for devices
+    // without ATI1/ATI2 support; the shader reads them the same way.
+    LoadAsync("Fieldstone_DM.dds", "Fieldstone_DM.tga", LoadTextureJob, ASYNC_PRIORITY_NORMAL, OnAssetLoaded, &gpTeapotDM);
+    LoadAsync("Fieldstone_NM.dds", "Fieldstone_NM.tga", LoadTextureJob, ASYNC_PRIORITY_NORMAL, OnAssetLoaded, &gpTeapotNM);
+    LoadAsync("Fieldstone_SM.dds", "Fieldstone_SM.tga", LoadTextureJob, ASYNC_PRIORITY_NORMAL, OnAssetLoaded, &gpTeapotSM);
+
+    // cubemap
+    LoadAsync("Snow_ENV.dds", NULL, LoadCubeTextureJob, ASYNC_PRIORITY_LOW, OnAssetLoaded, &gpSnowENV);
+
+    // reload whatever gets edited while the demo runs. saving a TGA
+    // replaces the baked DDS until the next run.
+    WatchAsset("EnvironmentMapping.fx", LoadShaderJob, (IUnknown**)&gpEnvironmentMappingShader);
+    WatchAsset("NoEffect.fx", LoadShaderJob, (IUnknown**)&gpNoEffect);
+    WatchAsset("Grayscale.fx", LoadShaderJob, (IUnknown**)&gpGrayScale);
+    WatchAsset("Sepia.fx", LoadShaderJob, (IUnknown**)&gpSepia);
+    WatchAsset("TeapotWithTangent.x", LoadModelJob, (IUnknown**)&gpTeapot);
+    WatchAsset("Fieldstone_DM.dds", LoadTextureJob, (IUnknown**)&gpTeapotDM);
+    WatchAsset("Fieldstone_DM.tga", LoadTextureJob, (IUnknown**)&gpTeapotDM);
+    WatchAsset("Fieldstone_NM.dds", LoadTextureJob, (IUnknown**)&gpTeapotNM);
+    WatchAsset("Fieldstone_NM.tga", LoadTextureJob, (IUnknown**)&gpTeapotNM);
+    WatchAsset("Fieldstone_SM.dds", LoadTextureJob, (IUnknown**)&gpTeapotSM);
+    WatchAsset("Fieldstone_SM.tga", LoadTextureJob, (IUnknown**)&gpTeapotSM);
+    WatchAsset("Snow_ENV.dds", LoadCubeTextureJob, (IUnknown**)&gpSnowENV);
+
+    return true;
+}
+
+// shader loading, through the shared asset cache (see AssetLoaders.h)
+LPD3DXEFFECT LoadShader(const char * filename)
+{
+    PROFILE_SCOPE("LoadShader");
+
+    return LoadCachedEffect(gpD3DDevice, filename);
+}
+
+// loading models.
+LPD3DXMESH LoadModel(const char * filename)
+{
+    PROFILE_SCOPE("LoadModel");
+
+    return LoadCachedMesh(gpD3DDevice, filename);
+}
+
+// TGAs and DDSs go through the native loaders, everything else through D3DX
+static LPDIRECT3DTEXTURE9 ReadTextureFile(const char * filename)
+{
+    const char* ext = strrchr(filename, '.');
+    if (ext && _stricmp(ext, ".tga") == 0)
     {
-        return false;
+        return LoadTgaTexture(filename, TGA_KERNEL_AUTO);
+    }
+    if (ext && _stricmp(ext, ".dds") == 0)
+    {
+        return LoadDdsTexture(filename);
     }
-    
-    gpTeapotNM = LoadTexture("Fieldstone_NM.tga");
 
-    if (!gpTeapotNM)
+    LPDIRECT3DTEXTURE9 ret = NULL;
+    if (FAILED(D3DXCreateTextureFromFile(gpD3DDevice, filename, &ret)))
     {
-        return false;
+        ret = NULL;
     }
+    return ret;
+}
 
-    gpTeapotSM = LoadTexture("Fieldstone_SM.tga");
+// loading textures.
+LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
+{
+    PROFILE_SCOPE("LoadTexture");
+
+    return LoadCachedTexture(gpD3DDevice, filename, ReadTextureFile);
+}
+
+// loading cube maps. only shared within the process; the source DDS is
+// already what would go into the cache.
+LPDIRECT3DCUBETEXTURE9 LoadCubeTexture(const char * filename)
+{
+    PROFILE_SCOPE("LoadCubeTexture");
+
+    LPDIRECT3DCUBETEXTURE9 ret = NULL;
 
-    if (!gpTeapotSM)
+    AssetLoad load;
+    ret = (LPDIRECT3DCUBETEXTURE9)BeginAssetLoad(filename, ASSET_CUBE_TEXTURE, 0, &load);
+    if (ret)
     {
-        return false;
+        return ret;
     }
 
-    // model loading
-    gpTeapot = LoadModel("TeapotWithTangent.x");
+    ret = LoadDdsCubeTexture(filename);
+
+    EndAssetLoad(&load, ret, NULL);
 
-    if (!gpTeapot)
+    if (!ret)
     {
-        return false;
+        OutputDebugString("failed at loading a cube map: ");
+        OutputDebugString(filename);
+        OutputDebugString("\n");
     }
 
-    return true;
+    return ret;
 }
 
-// shader loading
-LPD3DXEFFECT LoadShader(const char * filename)
+// loading TGA textures without D3DX.
+// the image is decoded straight into the locked top mip of a managed
+// texture (the system memory copy D3D uploads from), then the rest of
+// the mip chain is filtered the same way D3DXCreateTextureFromFile does.
+LPDIRECT3DTEXTURE9 LoadTgaTexture(const char * filename, TgaExpandKernel kernel)
 {
-    LPD3DXEFFECT ret = NULL;
+    size_t size = 0;
+    unsigned char* file = ReadWholeFile(filename, &size);
+    if (!file)
+    {
+        return NULL;
+    }
 
-    LPD3DXBUFFER pError = NULL;
-    DWORD dwShaderFlags = 0;
+    LPDIRECT3DTEXTURE9 ret = NULL;
 
-#if _DEBUG
-    dwShaderFlags |= D3DXSHADER_DEBUG;
-#endif
+    TgaInfo info;
+    if (ReadTgaHeader(file, size, &info))
+    {
+        D3DFORMAT format = (info.bitsPerPixel == 32) ? D3DFMT_A8R8G8B8 : D3DFMT_X8R8G8B8;
+        gpD3DDevice->CreateTexture(info.width, info.height, 0, 0, format, D3DPOOL_MANAGED, &ret, NULL);
+    }
+
+    if (ret)
+    {
+        D3DLOCKED_RECT lockedRect;
+        bool decoded = false;
+
+        if (SUCCEEDED(ret->LockRect(0, &lockedRect, NULL, 0)))
+        {
+            decoded = DecodeTga(file, size, info, (unsigned char*)lockedRect.pBits, lockedRect.Pitch, kernel);
+            ret->UnlockRect(0);
+        }
+
+        if (!decoded || FAILED(D3DXFilterTexture(ret, NULL, 0, D3DX_DEFAULT)))
+        {
+            ret->Release();
+            ret = NULL;
+        }
+    }
+
+    delete[] file;
+
+    return ret;
+}
+
+static D3DFORMAT GetD3DFormat(DdsFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_BC1:
+        return D3DFMT_DXT1;
+    case DDS_FORMAT_BC2:
+        return D3DFMT_DXT3;
+    case DDS_FORMAT_BC3:
+        return D3DFMT_DXT5;
+    case DDS_FORMAT_BC4:
+        return (D3DFORMAT)MAKEFOURCC('A', 'T', 'I', '1');
+    case DDS_FORMAT_BC5:
+        return (D3DFORMAT)MAKEFOURCC('A', 'T', 'I', '2');
+    case DDS_FORMAT_BGRA8:
+        return D3DFMT_A8R8G8B8;
+    case DDS_FORMAT_BGRX8:
+        return D3DFMT_X8R8G8B8;
+    default:
+        return D3DFMT_UNKNOWN;
+    }
+}
+
+// copies one face/mip of a DDS file into a locked surface as-is.
+// compressed blocks stay compressed; rows are rows of 4x4 blocks.
+static void CopyDdsSurface(const DdsSurface& surface, const D3DLOCKED_RECT& lockedRect)
+{
+    unsigned char* dest = (unsigned char*)lockedRect.pBits;
+
+    if (lockedRect.Pitch == surface.rowPitch)
+    {
+        memcpy(dest, surface.data, surface.size);
+        return;
+    }
+
+    for (int y = 0; y < surface.blocksHigh; ++y)
+    {
+        memcpy(dest + y * lockedRect.Pitch, surface.data + y * surface.rowPitch, surface.rowPitch);
+    }
+}
+
+// loading 2D DDS textures without D3DX. all mips stored in the file are
+// uploaded; nothing is decompressed.
+LPDIRECT3DTEXTURE9 LoadDdsTexture(const char * filename)
+{
+    size_t size = 0;
+    unsigned char* file = ReadWholeFile(filename, &size);
+    if (!file)
+    {
+        return NULL;
+    }
+
+    LPDIRECT3DTEXTURE9 ret = NULL;
 
-    D3DXCreateEffectFromFile(gpD3DDevice, filename,
-        NULL, NULL, dwShaderFlags, NULL, &ret, &pError);
+    DdsInfo info;
+    if (ReadDdsHeader(file, size, &info) && !info.isCubeMap)
+    {
+        gpD3DDevice->CreateTexture(info.width, info.height, info.mipCount, 0, GetD3DFormat(info.format), D3DPOOL_MANAGED, &ret, NULL);
+    }
 
-    // if failed at loading shaders, display compile error
-    // to output window
-    if (!ret && pError)
+    for (int mip = 0; ret && mip < info.mipCount; ++mip)
     {
-        int size = pError->GetBufferSize();
-        void *ack = pError->GetBufferPointer();
+        DdsSurface surface;
+        D3DLOCKED_RECT lockedRect;
 
-        if (ack)
+        if (!GetDdsSurface(file, size, info, 0, mip, &surface) ||
+            FAILED(ret->LockRect(mip, &lockedRect, NULL, 0)))
         {
-            char* str = new char[size];
-            sprintf(str, (const char*)ack, size);
-            OutputDebugString(str);
-            delete[] str;
+            ret->Release();
+            ret = NULL;
+            break;
         }
+
+        CopyDdsSurface(surface, lockedRect);
+        ret->UnlockRect(mip);
     }
 
+    delete[] file;
+
     return ret;
 }
 
-// loading models
-LPD3DXMESH LoadModel(const char * filename)
+// loading cube maps without D3DX. the compressed blocks of every face
+// and mip are copied straight into the managed texture.
+LPDIRECT3DCUBETEXTURE9 LoadDdsCubeTexture(const char * filename)
 {
-    LPD3DXMESH ret = NULL;
-    if (FAILED(D3DXLoadMeshFromX(filename, D3DXMESH_SYSTEMMEM, gpD3DDevice, NULL, NULL, NULL, NULL, &ret)))
+    size_t size = 0;
+    unsigned char* file = ReadWholeFile(filename, &size);
+    if (!file)
     {
-        OutputDebugString("failed at loading a model: ");
-        OutputDebugString(filename);
-        OutputDebugString("\n");
-    };
+        return NULL;
+    }
+
+    LPDIRECT3DCUBETEXTURE9 ret = NULL;
+
+    DdsInfo info;
+    if (ReadDdsHeader(file, size, &info) && info.isCubeMap && info.width == info.height)
+    {
+        gpD3DDevice->CreateCubeTexture(info.width, info.mipCount, 0, GetD3DFormat(info.format), D3DPOOL_MANAGED, &ret, NULL);
+    }
+
+    for (int face = 0; ret && face < info.faceCount; ++face)
+    {
+        for (int mip = 0; mip < info.mipCount; ++mip)
+        {
+            DdsSurface surface;
+            D3DLOCKED_RECT lockedRect;
+
+            if (!GetDdsSurface(file, size, info, face, mip, &surface) ||
+                FAILED(ret->LockRect((D3DCUBEMAP_FACES)face, mip, &lockedRect, NULL, 0)))
+            {
+                ret->Release();
+                ret = NULL;
+                break;
+            }
+
+            CopyDdsSurface(surface, lockedRect);
+            ret->UnlockRect((D3DCUBEMAP_FACES)face, mip);
+        }
+    }
+
+    delete[] file;
 
     return ret;
 }
 
-// loading textures
-LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
+#if BENCHMARK_TEXTURE_LOADING
+
+// the naive path: scalar decode into a temporary image, then copy it
+// row by row into the texture
+static LPDIRECT3DTEXTURE9 LoadTgaTextureNaive(const char * filename)
 {
+    size_t size = 0;
+    unsigned char* file = ReadWholeFile(filename, &size);
+    if (!file)
+    {
+        return NULL;
+    }
+
     LPDIRECT3DTEXTURE9 ret = NULL;
-    if (FAILED(D3DXCreateTextureFromFile(gpD3DDevice, filename, &ret)))
+
+    TgaInfo info;
+    if (ReadTgaHeader(file, size, &info))
     {
-        OutputDebugString("failed at loading a texture: ");
-        OutputDebugString(filename);
-        OutputDebugString("\n");
+        int pitch = info.width * 4;
+        unsigned char* image = new unsigned char[pitch * info.height];
+
+        if (DecodeTga(file, size, info, image, pitch, TGA_KERNEL_SCALAR))
+        {
+            gpD3DDevice->CreateTexture(info.width, info.height, 0, 0, D3DFMT_X8R8G8B8, D3DPOOL_MANAGED, &ret, NULL);
+        }
+
+        D3DLOCKED_RECT lockedRect;
+        if (ret && SUCCEEDED(ret->LockRect(0, &lockedRect, NULL, 0)))
+        {
+            for (int y = 0; y < info.height; ++y)
+            {
+                memcpy((unsigned char*)lockedRect.pBits + y * lockedRect.Pitch, image + y * pitch, pitch);
+            }
+            ret->UnlockRect(0);
+            D3DXFilterTexture(ret, NULL, 0, D3DX_DEFAULT);
+        }
+
+        delete[] image;
     }
 
+    delete[] file;
+
     return ret;
 }
 
+// prints the average load time per texture of every TGA loading path
+// to the output window
+void BenchmarkTextureLoading()
+{
+    const char* textures[] = { "Fieldstone_DM.tga", "Fieldstone_NM.tga", "Fieldstone_SM.tga" };
+    const char* paths[] = { "D3DX", "naive scalar", "native scalar", "native SSSE3", "native AVX2" };
+    const int numTextures = sizeof(textures) / sizeof(textures[0]);
+    const int numPaths = sizeof(paths) / sizeof(paths[0]);
+    const int numRuns = 20;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    for (int t = 0; t < numTextures; ++t)
+    {
+        for (int p = 0; p < numPaths; ++p)
+        {
+            // skip kernels this CPU cannot run
+            if (p >= 3 && (TgaExpandKernel)(p - 2) > GetBestTgaExpandKernel())
+            {
+                continue;
+            }
+
+            LARGE_INTEGER start, end;
+            QueryPerformanceCounter(&start);
+
+            for (int i = 0; i < numRuns; ++i)
+            {
+                LPDIRECT3DTEXTURE9 texture = NULL;
+
+                if (p == 0)
+                {
+                    D3DXCreateTextureFromFile(gpD3DDevice, textures[t], &texture);
+                }
+                else if (p == 1)
+                {
+                    texture = LoadTgaTextureNaive(textures[t]);
+                }
+                else
+                {
+                    texture = LoadTgaTexture(textures[t], (TgaExpandKernel)(p - 2));
+                }
+
+                if (texture)
+                {
+                    texture->Release();
+                }
+            }
+
+            QueryPerformanceCounter(&end);
+
+            double ms = (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart / numRuns;
+
+            char str[256];
+            sprintf(str, "%-20s %-14s %8.3f ms\n", textures[t], paths[p], ms);
+            OutputDebugString(str);
+        }
+    }
+}
+
+// prints cube map load times and the BC decode throughput of the
+// scalar and SSSE3 block decoders to the output window
+void BenchmarkBlockDecoding()
+{
+    const char* filename = "Snow_ENV.dds";
+    const int numRuns = 20;
+
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+
+    char str[256];
+
+    // loading: D3DX versus the native reader
+    for (int p = 0; p < 2; ++p)
+    {
+        QueryPerformanceCounter(&start);
+        for (int i = 0; i < numRuns; ++i)
+        {
+            LPDIRECT3DCUBETEXTURE9 texture = NULL;
+            if (p == 0)
+            {
+                D3DXCreateCubeTextureFromFile(gpD3DDevice, filename, &texture);
+            }
+            else
+            {
+                texture = LoadDdsCubeTexture(filename);
+            }
+
+            if (texture)
+            {
+                texture->Release();
+            }
+        }
+        QueryPerformanceCounter(&end);
+
+        double ms = (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart / numRuns;
+        sprintf(str, "%-20s %-14s %8.3f ms\n", filename, (p == 0) ? "D3DX" : "native", ms);
+        OutputDebugString(str);
+    }
+
+    // decoding every face and mip to BGRA
+    size_t size = 0;
+    unsigned char* file = ReadWholeFile(filename, &size);
+    DdsInfo info;
+    if (!file || !ReadDdsHeader(file, size, &info) || !IsBlockCompressed(info.format))
+    {
+        delete[] file;
+        return;
+    }
+
+    unsigned char* pixels = new unsigned char[info.width * info.height * 4];
+
+    for (int simd = 0; simd < 2; ++simd)
+    {
+        double numBlocks = 0;
+
+        QueryPerformanceCounter(&start);
+        for (int i = 0; i < numRuns; ++i)
+        {
+            for (int face = 0; face < info.faceCount; ++face)
+            {
+                for (int mip = 0; mip < info.mipCount; ++mip)
+                {
+                    DdsSurface surface;
+                    if (GetDdsSurface(file, size, info, face, mip, &surface))
+                    {
+                        DecodeDdsSurface(info.format, surface, pixels, surface.width * 4, simd != 0);
+                        numBlocks += surface.blocksWide * surface.blocksHigh;
+                    }
+                }
+            }
+        }
+        QueryPerformanceCounter(&end);
+
+        double seconds = (end.QuadPart - start.QuadPart) / (double)frequency.QuadPart;
+        sprintf(str, "%-20s %-14s %8.2f Mblocks/s\n", filename, simd ? "decode SSSE3" : "decode scalar", numBlocks / seconds / 1000000.0);
+        OutputDebugString(str);
+    }
+
+    delete[] pixels;
+    delete[] file;
+}
+
+#endif // BENCHMARK_TEXTURE_LOADING
+
 //------------------------------------------------------------
 // fullscreen quad
 //------------------------------------------------------------
@@ -678,6 +1293,19 @@ void InitFullScreenQuad()
 
 void Cleanup()
 {
+    // stop building frames; the worker runs the simulation
+    ReleaseFramePipeline();
+
+    // write the recorded frame times
+    ReleaseSimulationClock();
+
+    // stop loading before anything the loaders use goes away
+    ReleaseHotReload();
+    ReleaseAsyncLoader();
+    ReleaseJobSystem();
+
+    ReportAssetStats();
+
     if (gpFullscreenQuadDecl)
     {
         gpFullscreenQuadDecl->Release();
@@ -743,6 +1371,57 @@ void Cleanup()
         gpSceneRenderTarget = NULL;
     }
 
+    if (gpTeapotDM)
+    {
+        gpTeapotDM->Release();
+        gpTeapotDM = NULL;
+    }
+
+    if (gpTeapotNM)
+    {
+        gpTeapotNM->Release();
+        gpTeapotNM = NULL;
+    }
+
+    if (gpTeapotSM)
+    {
+        gpTeapotSM->Release();
+        gpTeapotSM = NULL;
+    }
+
+    if (gpSnowENV)
+    {
+        gpSnowENV->Release();
+        gpSnowENV = NULL;
+    }
+
+    if (gpPlaceholderDM)
+    {
+        gpPlaceholderDM->Release();
+        gpPlaceholderDM = NULL;
+    }
+
+    if (gpPlaceholderNM)
+    {
+        gpPlaceholderNM->Release();
+        gpPlaceholderNM = NULL;
+    }
+
+    if (gpPlaceholderSM)
+    {
+        gpPlaceholderSM->Release();
+        gpPlaceholderSM = NULL;
+    }
+
+    if (gpPlaceholderENV)
+    {
+        gpPlaceholderENV->Release();
+        gpPlaceholderENV = NULL;
+    }
+
+    // release the registry's references to shared assets
+    ReleaseAssetRegistry();
+
     // release D3D
     if (gpD3DDevice)
     {
@@ -755,5 +1434,13 @@ void Cleanup()
         gpD3D->Release();
         gpD3D = NULL;
     }
+
+    // a trace still recording at exit is written out, e.g. one begun by -trace
+    if (IsCpuProfilerEnabled())
+    {
+        SetCpuProfilerEnabled(false);
+        WriteChromeTrace(CPU_TRACE_FILE);
+    }
+    ReleaseCpuProfiler();
 }
 
@@ -14,11 +14,27 @@
 
 #include <d3d9.h>
 #include <d3dx9.h>
+#include "TgaLoader.h"
 
 // ---------- constants ------------------------------------
 #define WIN_WIDTH		800
 #define WIN_HEIGHT		600
 
+// set to 1 to print texture load and decode timings to the output window on startup
+#define BENCHMARK_TEXTURE_LOADING	0
+
+// where P writes the CPU trace
+#define CPU_TRACE_FILE	"CpuTrace.json"
+
+// ---------- types ------------------------------------
+
+// what RenderScene needs from the simulation; built a frame ahead
+struct FrameData
+{
+    D3DXMATRIX world;
+    D3DXMATRIX worldViewProjection;
+};
+
 // ---------------- function prototype  ------------------------
 
 // Message procedure related
@@ -31,17 +47,25 @@ bool InitD3D(HWND hWnd);
 bool LoadAssets();
 LPD3DXEFFECT LoadShader(const char * filename);
 LPDIRECT3DTEXTURE9 LoadTexture(const char * filename);
+LPDIRECT3DTEXTURE9 LoadTgaTexture(const char * filename, TgaExpandKernel kernel);
+LPDIRECT3DTEXTURE9 LoadDdsTexture(const char * filename);
+LPDIRECT3DCUBETEXTURE9 LoadCubeTexture(const char * filename);
+LPDIRECT3DCUBETEXTURE9 LoadDdsCubeTexture(const char * filename);
+void BenchmarkTextureLoading();
+void BenchmarkBlockDecoding();
 LPD3DXMESH LoadModel(const char * filename);
 
 // game loop related
 void PlayDemo();
+double GetMsSinceStart();
+void BuildFrame(void* data);
 void Update();
 void InitFullScreenQuad();
 
 
 // Rendering related
-void RenderFrame();
-void RenderScene();
+void RenderFrame(const FrameData* frame);
+void RenderScene(const FrameData* frame);
 void RenderInfo();
 
 // cleanup related
@@ -0,0 +1,2654 @@
+//**********************************************************************
+//
+// ShaderInterpreter.cpp
+//
+// Compiles a shader function straight from its tokens: statements are
+// compiled in order, expressions into instructions as they are parsed.
+// Every value is a list of scalar registers, one per component, so
+// swizzles, casts and transposes only reorder the list and cost
+// nothing. A variable keeps its registers for as long as it is in scope;
+// the temporaries of a statement are free again after it.
+//
+// While a variable holds a value known when compiling it has no code,
+// which is what lets loops unroll: the counter stays a constant, and so
+// do the offsets and matrix elements indexed by it.
+//
+// Inside an if, a write to a variable declared outside it selects
+// between the new and the old value by the lanes that take the branch.
+//
+//**********************************************************************
+
+#include "ShaderInterpreter.h"
+#include <algorithm>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#define _snprintf snprintf
+#endif
+
+// while compiling, registers from here on are constants; they are moved
+// after the others once the program is done
+#define CONSTANT_BASE       0x8000
+
+#define NO_REGISTER         -1
+
+// iterations of a loop that are unrolled before giving up
+#define MAX_UNROLL          256
+
+struct Value
+{
+    int rows;                   // 1 for scalars and vectors
+    int columns;
+    std::vector<int> regs;      // rows * columns, row by row
+};
+
+struct Variable
+{
+    Value storage;
+    Value constant;             // what it holds, while that is known
+    bool isConstant;
+    size_t maskDepth;           // masks active where it was declared
+    const StructDecl* structDecl;   // for a struct; its members are "name.member"
+};
+
+static const char* gOpNames[SHADER_OP_COUNT] =
+{
+    "mov", "add", "sub", "mul", "div", "mad", "min", "max", "neg", "abs", "sat", "floor", "ceil",
+    "frac", "sqrt", "rsq", "rcp", "exp", "log", "pow", "sin", "cos", "lt", "le", "eq", "ne", "and",
+    "or", "not", "sel", "tex2d", "texcube", "skip"
+};
+
+// registers each op reads
+static const int gOpSources[SHADER_OP_COUNT] =
+{
+    1, 2, 2, 2, 2, 3, 2, 2, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 2, 1, 1, 2, 2, 2, 2, 2,
+    2, 1, 3, 2, 3, 1
+};
+
+
+//----------------------------------------------------------------------
+// scalar operations
+//----------------------------------------------------------------------
+
+static float Saturate(float x)
+{
+    return (x < 0.0f) ? 0.0f : (x > 1.0f) ? 1.0f : x;
+}
+
+// an op on one lane; folds constants the way RunShader would compute them
+static float Evaluate(int op, float a, float b, float c)
+{
+    switch (op)
+    {
+    case SHADER_OP_MOV:   return a;
+    case SHADER_OP_ADD:   return a + b;
+    case SHADER_OP_SUB:   return a - b;
+    case SHADER_OP_MUL:   return a * b;
+    case SHADER_OP_DIV:   return a / b;
+    case SHADER_OP_MAD:   return a * b + c;
+    case SHADER_OP_MIN:   return (a < b) ? a : b;
+    case SHADER_OP_MAX:   return (a > b) ? a : b;
+    case SHADER_OP_NEG:   return -a;
+    case SHADER_OP_ABS:   return fabsf(a);
+    case SHADER_OP_SAT:   return Saturate(a);
+    case SHADER_OP_FLOOR: return floorf(a);
+    case SHADER_OP_CEIL:  return ceilf(a);
+    case SHADER_OP_FRAC:  return a - floorf(a);
+    case SHADER_OP_SQRT:  return sqrtf(a);
+    case SHADER_OP_RSQ:   return 1.0f / sqrtf(a);
+    case SHADER_OP_RCP:   return 1.0f / a;
+    case SHADER_OP_EXP:   return expf(a);
+    case SHADER_OP_LOG:   return logf(a);
+    case SHADER_OP_POW:   return powf(a, b);
+    case SHADER_OP_SIN:   return sinf(a);
+    case SHADER_OP_COS:   return cosf(a);
+    case SHADER_OP_LT:    return (a < b) ? 1.0f : 0.0f;
+    case SHADER_OP_LE:    return (a <= b) ? 1.0f : 0.0f;
+    case SHADER_OP_EQ:    return (a == b) ? 1.0f : 0.0f;
+    case SHADER_OP_NE:    return (a != b) ? 1.0f : 0.0f;
+    case SHADER_OP_AND:   return (a != 0.0f && b != 0.0f) ? 1.0f : 0.0f;
+    case SHADER_OP_OR:    return (a != 0.0f || b != 0.0f) ? 1.0f : 0.0f;
+    case SHADER_OP_NOT:   return (a == 0.0f) ? 1.0f : 0.0f;
+    case SHADER_OP_SEL:   return (a != 0.0f) ? b : c;
+    default:              return 0.0f;
+    }
+}
+
+//----------------------------------------------------------------------
+// textures
+//----------------------------------------------------------------------
+
+// x - floor(x) without calling floorf, which shows in the texture
+// fetches; 0 for NaN and for floats too large to have a fraction
+static float Fraction(float x)
+{
+    if (!(fabsf(x) < 8388608.0f))
+    {
+        return 0.0f;
+    }
+    float fraction = x - (float)(int)x;
+    return (fraction < 0.0f) ? fraction + 1.0f : fraction;
+}
+
+// bilinear between the four texels around (x, y) of a face, wrapping or
+// clamping at its edges
+static void SampleFace(const ShaderTexture* texture, const float* texels, float u, float v, bool wrap,
+    float* rgba)
+{
+    int width = texture->width;
+    int height = texture->height;
+
+    if (wrap)
+    {
+        u = Fraction(u);
+        v = Fraction(v);
+    }
+    u = (u == u) ? u : 0.0f;    // NaN
+    v = (v == v) ? v : 0.0f;
+    u = (u < 0.0f) ? 0.0f : (u > 1.0f) ? 1.0f : u;
+    v = (v < 0.0f) ? 0.0f : (v > 1.0f) ? 1.0f : v;
+
+    // x and y are at least -0.5, so truncating x + 1 rounds down
+    float x = u * width - 0.5f;
+    float y = v * height - 0.5f;
+    int x0 = (int)(x + 1.0f) - 1;
+    int y0 = (int)(y + 1.0f) - 1;
+    float ax = x - (float)x0;
+    float ay = y - (float)y0;
+
+    int x1 = x0 + 1;
+    int y1 = y0 + 1;
+    if (wrap)
+    {
+        // u and v are in [0, 1], so each is at most one texel outside
+        x0 = (x0 < 0) ? width - 1 : x0;
+        y0 = (y0 < 0) ? height - 1 : y0;
+        x1 = (x1 >= width) ? x1 - width : x1;
+        y1 = (y1 >= height) ? y1 - height : y1;
+    }
+    else
+    {
+        x0 = (x0 < 0) ? 0 : x0;
+        y0 = (y0 < 0) ? 0 : y0;
+        x1 = (x1 >= width) ? width - 1 : x1;
+        y1 = (y1 >= height) ? height - 1 : y1;
+    }
+
+    const float* t00 = texels + (y0 * width + x0) * 4;
+    const float* t10 = texels + (y0 * width + x1) * 4;
+    const float* t01 = texels + (y1 * width + x0) * 4;
+    const float* t11 = texels + (y1 * width + x1) * 4;
+    for (int i = 0; i < 4; ++i)
+    {
+        float top = t00[i] + (t10[i] - t00[i]) * ax;
+        float bottom = t01[i] + (t11[i] - t01[i]) * ax;
+        rgba[i] = top + (bottom - top) * ay;
+    }
+}
+
+void SampleTexture2D(const ShaderTexture* texture, float u, float v, float* rgba)
+{
+    if (!texture || texture->cube)
+    {
+        rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0.0f;
+        return;
+    }
+    SampleFace(texture, texture->texels, u, v, true, rgba);
+}
+
+// the face is picked by the largest component, as Direct3D does
+void SampleTextureCube(const ShaderTexture* texture, float x, float y, float z, float* rgba)
+{
+    if (!texture || !texture->cube)
+    {
+        rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0.0f;
+        return;
+    }
+
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float az = fabsf(z);
+    int face;
+    float s, t, major;
+    if (ax >= ay && ax >= az)
+    {
+        face = (x >= 0.0f) ? 0 : 1;
+        s = (x >= 0.0f) ? -z : z;
+        t = -y;
+        major = ax;
+    }
+    else if (ay >= az)
+    {
+        face = (y >= 0.0f) ? 2 : 3;
+        s = x;
+        t = (y >= 0.0f) ? z : -z;
+        major = ay;
+    }
+    else
+    {
+        face = (z >= 0.0f) ? 4 : 5;
+        s = (z >= 0.0f) ? x : -x;
+        t = -y;
+        major = az;
+    }
+
+    float scale = (major > 0.0f) ? 0.5f / major : 0.0f;
+    const float* texels = texture->texels + (size_t)face * texture->width * texture->height * 4;
+    SampleFace(texture, texels, s * scale + 0.5f, t * scale + 0.5f, false, rgba);
+}
+
+//----------------------------------------------------------------------
+// compiler
+//----------------------------------------------------------------------
+
+struct Compiler
+{
+    const EffectSource* effect;
+    const std::vector<Token>* tokens;
+    ShaderProgram* program;
+
+    std::vector<std::map<std::string, Variable> > scopes;
+    std::vector<int> scopeMarks;                // next when each scope began
+    std::map<std::string, int> uniforms;        // global to program->uniforms
+    const std::set<std::string>* baked;         // globals compiled in as constants
+    std::map<std::string, Value> bakedValues;
+    std::map<unsigned int, int> constants;      // bits of a float to its register
+    std::vector<int> masks;                     // lanes that run, innermost last
+
+    int next;                   // first free register
+    int registerCount;
+    int statementMark;          // first temporary of the statement
+    size_t statementCode;       // its first instruction
+    size_t at;                  // the expression being parsed
+    size_t end;
+    bool failed;
+    bool returned;
+    Type returnType;
+    std::string returnSemantic;
+
+    // ---- errors and tokens ----
+    void Fail(size_t where, const std::string& message);
+    bool Is(const char* text) const { return at < end && (*tokens)[at].text == text; }
+    bool Expect(const char* text);
+
+    // ---- registers and instructions ----
+    int Constant(float value);
+    bool IsConstant(int reg) const { return reg >= CONSTANT_BASE; }
+    float ConstantValue(int reg) const { return program->constants[reg - CONSTANT_BASE]; }
+    bool IsConstantValue(int reg, float value) const { return IsConstant(reg) && ConstantValue(reg) == value; }
+    int Allocate(int count);
+    void EmitTo(int op, int dst, int a, int b, int c);
+    int Emit(int op, int a, int b = NO_REGISTER, int c = NO_REGISTER);
+
+    // ---- values ----
+    Value MakeValue(int rows, int columns);
+    Value Constants(int rows, int columns, const std::vector<float>& values);
+    Value Convert(const Value& value, int rows, int columns, bool cast);
+    Value Map(int op, const Value& a);
+    Value Map(int op, const Value& a, const Value& b);
+    Value Map(int op, const Value& a, const Value& b, const Value& c);
+    int Dot(const Value& a, const Value& b);
+    Value Multiply(const Value& a, const Value& b);
+
+    // ---- variables ----
+    Variable* Find(const std::string& name);
+    Variable* Declare(const std::string& name, int rows, int columns);
+    Value Read(const Variable& variable);
+    void Materialize(Variable& variable);
+    void Store(Variable& variable, const std::vector<int>& indices, const Value& value);
+    bool Uniform(const Global& global, Value* value);
+    int Sampler(const std::string& name, bool cube);
+
+    // ---- expressions ----
+    Value Expression() { return Binary(0); }
+    Value Binary(int level);
+    Value Unary();
+    Value Postfix();
+    Value Primary();
+    Value Call(const std::string& name, size_t where);
+    bool Swizzle(const std::string& text, int columns, std::vector<int>* components);
+    Value Range(size_t begin, size_t finish);
+
+    // ---- statements ----
+    void PushScope();
+    void PopScope();
+    void DeclareStruct(const std::string& name, const StructDecl& decl);
+    void CollectAssigned(size_t begin, size_t finish, std::set<std::string>& names);
+    size_t BodyEnd(size_t begin, size_t finish);
+    void Statements(size_t begin, size_t finish);
+    size_t Statement(size_t begin, size_t finish);
+    size_t Body(size_t begin, size_t finish, int mask);
+    void Branch(int mask, size_t begin, size_t finish);
+    size_t If(size_t begin, size_t finish);
+    size_t For(size_t begin, size_t finish);
+    size_t Return(size_t begin, size_t finish);
+    void Simple(size_t begin, size_t finish);
+    void Declaration(size_t begin, size_t finish, const Type& type);
+    void Assignment(size_t begin, size_t finish);
+};
+
+void Compiler::Fail(size_t where, const std::string& message)
+{
+    if (failed)
+    {
+        return;
+    }
+    failed = true;
+
+    size_t offset = (where < tokens->size()) ? (*tokens)[where].offset : effect->text.size();
+    int line = 1;
+    for (size_t i = 0; i < offset && i < effect->text.size(); ++i)
+    {
+        line += (effect->text[i] == '\n') ? 1 : 0;
+    }
+
+    char text[512];
+    _snprintf(text, sizeof(text), "line %d: %s", line, message.c_str());
+    text[sizeof(text) - 1] = '\0';
+    program->error = text;
+}
+
+bool Compiler::Expect(const char* text)
+{
+    if (!Is(text))
+    {
+        Fail(at, std::string("expected ") + text);
+        return false;
+    }
+    ++at;
+    return true;
+}
+
+int Compiler::Constant(float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    std::map<unsigned int, int>::iterator found = constants.find(bits);
+    if (found != constants.end())
+    {
+        return found->second;
+    }
+
+    int reg = CONSTANT_BASE + (int)program->constants.size();
+    program->constants.push_back(value);
+    constants[bits] = reg;
+    return reg;
+}
+
+int Compiler::Allocate(int count)
+{
+    if (next + count > CONSTANT_BASE)
+    {
+        Fail(at, "out of registers");
+        return 0;
+    }
+    int first = next;
+    next += count;
+    registerCount = (next > registerCount) ? next : registerCount;
+    return first;
+}
+
+void Compiler::EmitTo(int op, int dst, int a, int b, int c)
+{
+    ShaderInstruction instruction;
+    instruction.op = (unsigned char)op;
+    instruction.sampler = 0;
+    instruction.dst = (unsigned short)dst;
+    instruction.a = (unsigned short)((a == NO_REGISTER) ? 0 : a);
+    instruction.b = (unsigned short)((b == NO_REGISTER) ? 0 : b);
+    instruction.c = (unsigned short)((c == NO_REGISTER) ? 0 : c);
+    program->code.push_back(instruction);
+}
+
+// the register holding op of a, b and c; folds what is known when compiling
+int Compiler::Emit(int op, int a, int b, int c)
+{
+    int sources = gOpSources[op];
+    bool known = IsConstant(a) && (sources < 2 || IsConstant(b)) && (sources < 3 || IsConstant(c));
+    if (known)
+    {
+        float vb = (sources >= 2) ? ConstantValue(b) : 0.0f;
+        float vc = (sources >= 3) ? ConstantValue(c) : 0.0f;
+        return Constant(Evaluate(op, ConstantValue(a), vb, vc));
+    }
+
+    switch (op)
+    {
+    case SHADER_OP_MOV:
+        break;
+    case SHADER_OP_ADD:
+        if (IsConstantValue(a, 0.0f)) return b;
+        if (IsConstantValue(b, 0.0f)) return a;
+        break;
+    case SHADER_OP_SUB:
+        if (IsConstantValue(b, 0.0f)) return a;
+        if (IsConstantValue(a, 0.0f)) return Emit(SHADER_OP_NEG, b);
+        break;
+    case SHADER_OP_MUL:
+        if (IsConstantValue(a, 0.0f) || IsConstantValue(b, 0.0f)) return Constant(0.0f);
+        if (IsConstantValue(a, 1.0f)) return b;
+        if (IsConstantValue(b, 1.0f)) return a;
+        if (IsConstantValue(a, -1.0f)) return Emit(SHADER_OP_NEG, b);
+        if (IsConstantValue(b, -1.0f)) return Emit(SHADER_OP_NEG, a);
+        break;
+    case SHADER_OP_DIV:
+        if (IsConstantValue(b, 1.0f)) return a;
+        if (IsConstant(b)) return Emit(SHADER_OP_MUL, a, Constant(1.0f / ConstantValue(b)));
+        break;
+    case SHADER_OP_MAD:
+        if (IsConstantValue(a, 0.0f) || IsConstantValue(b, 0.0f)) return c;
+        if (IsConstantValue(a, 1.0f)) return Emit(SHADER_OP_ADD, b, c);
+        if (IsConstantValue(b, 1.0f)) return Emit(SHADER_OP_ADD, a, c);
+        if (IsConstantValue(c, 0.0f)) return Emit(SHADER_OP_MUL, a, b);
+        break;
+    case SHADER_OP_POW:
+        if (IsConstantValue(b, 1.0f)) return a;
+        break;
+    case SHADER_OP_SEL:
+        if (IsConstant(a)) return (ConstantValue(a) != 0.0f) ? b : c;
+        if (b == c) return b;
+        break;
+    }
+
+    int dst = Allocate(1);
+    EmitTo(op, dst, a, b, c);
+    return dst;
+}
+
+Value Compiler::MakeValue(int rows, int columns)
+{
+    Value value;
+    value.rows = rows;
+    value.columns = columns;
+    value.regs.resize(rows * columns, 0);
+    return value;
+}
+
+Value Compiler::Constants(int rows, int columns, const std::vector<float>& values)
+{
+    Value value = MakeValue(rows, columns);
+    for (size_t i = 0; i < value.regs.size(); ++i)
+    {
+        value.regs[i] = Constant((i < values.size()) ? values[i] : 0.0f);
+    }
+    return value;
+}
+
+// value as rows x columns: scalars are repeated, larger vectors and
+// matrices lose their last components
+Value Compiler::Convert(const Value& value, int rows, int columns, bool cast)
+{
+    if (value.rows == rows && value.columns == columns)
+    {
+        return value;
+    }
+
+    Value result = MakeValue(rows, columns);
+    if (value.regs.size() == 1)
+    {
+        for (size_t i = 0; i < result.regs.size(); ++i)
+        {
+            result.regs[i] = value.regs[0];
+        }
+        return result;
+    }
+
+    bool vectors = (value.rows == 1 && rows == 1);
+    bool matrices = (value.rows > 1 && rows > 1);
+    if ((!vectors && !matrices && !(cast && rows * columns == 1)) || value.rows < rows || value.columns < columns)
+    {
+        char text[128];
+        _snprintf(text, sizeof(text), "cannot convert %dx%d to %dx%d", value.rows, value.columns, rows, columns);
+        Fail(at, text);
+        return result;
+    }
+
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < columns; ++c)
+        {
+            result.regs[r * columns + c] = value.regs[r * value.columns + c];
+        }
+    }
+    return result;
+}
+
+Value Compiler::Map(int op, const Value& a)
+{
+    Value result = a;
+    for (size_t i = 0; i < a.regs.size(); ++i)
+    {
+        result.regs[i] = Emit(op, a.regs[i]);
+    }
+    return result;
+}
+
+Value Compiler::Map(int op, const Value& a, const Value& b)
+{
+    return Map(op, a, b, b);
+}
+
+// component by component; scalars are repeated, and a longer vector is
+// cut to the shorter one as HLSL does
+Value Compiler::Map(int op, const Value& a, const Value& b, const Value& c)
+{
+    const Value* shape = NULL;
+    const Value* operands[3] = { &a, &b, &c };
+    for (int i = 0; i < 3; ++i)
+    {
+        const Value* operand = operands[i];
+        if (operand->regs.size() > 1 && (!shape || operand->regs.size() < shape->regs.size()))
+        {
+            shape = operand;
+        }
+    }
+    int rows = shape ? shape->rows : 1;
+    int columns = shape ? shape->columns : 1;
+
+    Value ca = Convert(a, rows, columns, false);
+    Value cb = Convert(b, rows, columns, false);
+    Value cc = Convert(c, rows, columns, false);
+    Value result = MakeValue(rows, columns);
+    for (size_t i = 0; i < result.regs.size() && !failed; ++i)
+    {
+        result.regs[i] = Emit(op, ca.regs[i], cb.regs[i], cc.regs[i]);
+    }
+    return result;
+}
+
+int Compiler::Dot(const Value& a, const Value& b)
+{
+    size_t count = (a.regs.size() < b.regs.size()) ? a.regs.size() : b.regs.size();
+    int sum = Emit(SHADER_OP_MUL, a.regs[0], b.regs[0]);
+    for (size_t i = 1; i < count; ++i)
+    {
+        sum = Emit(SHADER_OP_MAD, a.regs[i], b.regs[i], sum);
+    }
+    return sum;
+}
+
+// mul(): a vector on the left is a row, on the right a column
+Value Compiler::Multiply(const Value& a, const Value& b)
+{
+    if (a.regs.size() == 1 || b.regs.size() == 1)
+    {
+        return Map(SHADER_OP_MUL, a, b);
+    }
+
+    bool rowVector = (a.rows == 1);
+    bool columnVector = (b.rows == 1);
+    int rows = rowVector ? 1 : a.rows;
+    int columns = columnVector ? 1 : b.columns;
+    int inner = a.columns;
+    int innerB = columnVector ? b.columns : b.rows;
+    inner = (inner < innerB) ? inner : innerB;
+
+    Value result = MakeValue(rows, columns);
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < columns; ++c)
+        {
+            int sum = NO_REGISTER;
+            for (int k = 0; k < inner; ++k)
+            {
+                int left = a.regs[r * a.columns + k];
+                int right = columnVector ? b.regs[k] : b.regs[k * b.columns + c];
+                sum = (k == 0) ? Emit(SHADER_OP_MUL, left, right) : Emit(SHADER_OP_MAD, left, right, sum);
+            }
+            result.regs[r * columns + c] = sum;
+        }
+    }
+
+    if (columnVector)
+    {
+        result.columns = result.rows;
+        result.rows = 1;
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------
+// variables
+//----------------------------------------------------------------------
+
+Variable* Compiler::Find(const std::string& name)
+{
+    for (size_t i = scopes.size(); i-- > 0; )
+    {
+        std::map<std::string, Variable>::iterator found = scopes[i].find(name);
+        if (found != scopes[i].end())
+        {
+            return &found->second;
+        }
+    }
+    return NULL;
+}
+
+// a new variable, holding zero until written
+Variable* Compiler::Declare(const std::string& name, int rows, int columns)
+{
+    Variable variable;
+    variable.storage = MakeValue(rows, columns);
+    int first = Allocate(rows * columns);
+    for (size_t i = 0; i < variable.storage.regs.size(); ++i)
+    {
+        variable.storage.regs[i] = first + (int)i;
+    }
+    variable.constant = Constants(rows, columns, std::vector<float>());
+    variable.isConstant = true;
+    variable.maskDepth = masks.size();
+    variable.structDecl = NULL;
+
+    scopes.back()[name] = variable;
+    return &scopes.back()[name];
+}
+
+Value Compiler::Read(const Variable& variable)
+{
+    return variable.isConstant ? variable.constant : variable.storage;
+}
+
+// copies the constant a variable holds into its registers, before a
+// write to part of it or a write only some lanes make
+void Compiler::Materialize(Variable& variable)
+{
+    if (!variable.isConstant)
+    {
+        return;
+    }
+    for (size_t i = 0; i < variable.storage.regs.size(); ++i)
+    {
+        EmitTo(SHADER_OP_MOV, variable.storage.regs[i], variable.constant.regs[i], NO_REGISTER, NO_REGISTER);
+    }
+    variable.isConstant = false;
+}
+
+// writes value to the components indices of variable
+void Compiler::Store(Variable& variable, const std::vector<int>& indices, const Value& value)
+{
+    if (failed)
+    {
+        return;
+    }
+
+    bool masked = masks.size() > variable.maskDepth;
+    bool whole = (indices.size() == variable.storage.regs.size());
+
+    bool known = true;
+    for (size_t i = 0; i < value.regs.size(); ++i)
+    {
+        known = known && IsConstant(value.regs[i]);
+    }
+    if (known && whole && !masked)
+    {
+        // indices of a whole write are in order
+        variable.constant = value;
+        variable.constant.rows = variable.storage.rows;
+        variable.constant.columns = variable.storage.columns;
+        variable.isConstant = true;
+        return;
+    }
+
+    if (whole && !masked)
+    {
+        variable.isConstant = false;
+    }
+    Materialize(variable);
+
+    std::vector<int> targets(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        targets[i] = variable.storage.regs[indices[i]];
+    }
+
+    // a component read from a register written before it, as in
+    // v = v.yx, is copied out first
+    std::vector<int> sources = value.regs;
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        for (size_t j = 0; j < targets.size(); ++j)
+        {
+            if (j != i && sources[i] == targets[j])
+            {
+                int copy = Allocate(1);
+                EmitTo(SHADER_OP_MOV, copy, sources[i], NO_REGISTER, NO_REGISTER);
+                sources[i] = copy;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        int source = sources[i];
+        int target = targets[i];
+        if (source == target && !masked)
+        {
+            continue;
+        }
+        if (masked)
+        {
+            EmitTo(SHADER_OP_SEL, target, masks.back(), source, target);
+            continue;
+        }
+
+        // point the instruction computing a temporary at the variable,
+        // when nothing after it reads either of them
+        bool retargeted = false;
+        if (source >= statementMark && !IsConstant(source) &&
+            std::count(sources.begin(), sources.end(), source) == 1 &&
+            std::find(sources.begin(), sources.end(), target) == sources.end())
+        {
+            size_t k = program->code.size();
+            while (k-- > statementCode && program->code[k].dst != source)
+            {
+            }
+            bool usable = (k >= statementCode && k < program->code.size() &&
+                program->code[k].op != SHADER_OP_TEX2D && program->code[k].op != SHADER_OP_TEXCUBE &&
+                program->code[k].op != SHADER_OP_SKIP);
+            for (size_t j = k + 1; usable && j < program->code.size(); ++j)
+            {
+                const ShaderInstruction& later = program->code[j];
+                int count = gOpSources[later.op];
+                int read[3] = { later.a, later.b, later.c };
+                for (int s = 0; s < count; ++s)
+                {
+                    usable = usable && read[s] != source && read[s] != target;
+                }
+                usable = usable && later.op != SHADER_OP_SKIP &&
+                    (later.op == SHADER_OP_TEX2D || later.op == SHADER_OP_TEXCUBE ||
+                    later.dst != target);
+            }
+            if (usable)
+            {
+                program->code[k].dst = (unsigned short)target;
+                retargeted = true;
+            }
+        }
+        if (!retargeted)
+        {
+            EmitTo(SHADER_OP_MOV, target, source, NO_REGISTER, NO_REGISTER);
+        }
+    }
+}
+
+// the registers of a global, given to the program the first time it is read
+bool Compiler::Uniform(const Global& global, Value* value)
+{
+    std::map<std::string, Value>::iterator constant = bakedValues.find(global.name);
+    if (constant != bakedValues.end())
+    {
+        *value = constant->second;
+        return true;
+    }
+
+    std::map<std::string, int>::iterator found = uniforms.find(global.name);
+    if (found != uniforms.end())
+    {
+        const ShaderVariable& uniform = program->uniforms[found->second];
+        *value = MakeValue(uniform.rows, uniform.columns);
+        value->regs = uniform.registers;
+        return true;
+    }
+    return false;
+}
+
+int Compiler::Sampler(const std::string& name, bool cube)
+{
+    for (size_t i = 0; i < program->samplers.size(); ++i)
+    {
+        if (program->samplers[i].name == name)
+        {
+            return (int)i;
+        }
+    }
+
+    const Global* global = FindEffectGlobal(*effect, name);
+    if (!global || global->typeName.compare(0, 7, "sampler") != 0)
+    {
+        Fail(at, "unknown sampler " + name);
+        return 0;
+    }
+    if (program->samplers.size() >= SHADER_MAX_SAMPLERS)
+    {
+        Fail(at, "too many samplers");
+        return 0;
+    }
+
+    // Texture = (Name); or Texture = <Name>;
+    ShaderSampler sampler;
+    sampler.name = name;
+    sampler.cube = cube;
+    for (size_t i = global->begin; i + 3 < global->end; ++i)
+    {
+        if ((*tokens)[i].text == "Texture" && (*tokens)[i + 1].text == "=")
+        {
+            size_t t = i + 2;
+            t += ((*tokens)[t].text == "(" || (*tokens)[t].text == "<") ? 1 : 0;
+            sampler.texture = (*tokens)[t].text;
+            break;
+        }
+    }
+
+    program->samplers.push_back(sampler);
+    return (int)program->samplers.size() - 1;
+}
+
+//----------------------------------------------------------------------
+// expressions
+//----------------------------------------------------------------------
+
+static int Precedence(const std::string& op)
+{
+    if (op == "||") return 1;
+    if (op == "&&") return 2;
+    if (op == "==" || op == "!=") return 3;
+    if (op == "<" || op == ">" || op == "<=" || op == ">=") return 4;
+    if (op == "+" || op == "-") return 5;
+    if (op == "*" || op == "/" || op == "%") return 6;
+    return 0;
+}
+
+Value Compiler::Binary(int level)
+{
+    Value left = Unary();
+
+    while (at < end && !failed)
+    {
+        std::string op = (*tokens)[at].text;
+        int precedence = Precedence(op);
+        if (precedence == 0 || precedence <= level)
+        {
+            break;
+        }
+
+        size_t where = at++;
+        Value right = Binary(precedence);
+
+        if (op == "+")       left = Map(SHADER_OP_ADD, left, right);
+        else if (op == "-")  left = Map(SHADER_OP_SUB, left, right);
+        else if (op == "*")  left = Map(SHADER_OP_MUL, left, right);
+        else if (op == "/")  left = Map(SHADER_OP_DIV, left, right);
+        else if (op == "<")  left = Map(SHADER_OP_LT, left, right);
+        else if (op == ">")  left = Map(SHADER_OP_LT, right, left);
+        else if (op == "<=") left = Map(SHADER_OP_LE, left, right);
+        else if (op == ">=") left = Map(SHADER_OP_LE, right, left);
+        else if (op == "==") left = Map(SHADER_OP_EQ, left, right);
+        else if (op == "!=") left = Map(SHADER_OP_NE, left, right);
+        else if (op == "&&") left = Map(SHADER_OP_AND, left, right);
+        else if (op == "||") left = Map(SHADER_OP_OR, left, right);
+        else Fail(where, "unsupported operator " + op);
+    }
+
+    return left;
+}
+
+Value Compiler::Unary()
+{
+    if (Is("-") || Is("!") || Is("+"))
+    {
+        std::string op = (*tokens)[at++].text;
+        Value operand = Unary();
+        if (op == "-")
+        {
+            return Map(SHADER_OP_NEG, operand);
+        }
+        if (op == "!")
+        {
+            return Map(SHADER_OP_NOT, operand);
+        }
+        return operand;
+    }
+
+    return Postfix();
+}
+
+// the components a swizzle picks, e.g. "zyx" is 2, 1, 0
+bool Compiler::Swizzle(const std::string& text, int columns, std::vector<int>* components)
+{
+    static const char* sets[] = { "xyzw", "rgba" };
+
+    components->clear();
+    if (text.empty() || text.size() > 4)
+    {
+        return false;
+    }
+    for (int s = 0; s < 2; ++s)
+    {
+        components->clear();
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const char* found = strchr(sets[s], text[i]);
+            if (!found || found - sets[s] >= columns)
+            {
+                break;
+            }
+            components->push_back((int)(found - sets[s]));
+        }
+        if (components->size() == text.size())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+Value Compiler::Postfix()
+{
+    Value value = Primary();
+
+    while (at < end && !failed)
+    {
+        if (Is("."))
+        {
+            ++at;
+            size_t where = at;
+            std::string member = (at < end) ? (*tokens)[at++].text : "";
+            std::vector<int> components;
+            if (value.rows != 1 || !Swizzle(member, value.columns, &components))
+            {
+                Fail(where, "unsupported member ." + member);
+                break;
+            }
+
+            Value picked = MakeValue(1, (int)components.size());
+            for (size_t i = 0; i < components.size(); ++i)
+            {
+                picked.regs[i] = value.regs[components[i]];
+            }
+            value = picked;
+        }
+        else if (Is("["))
+        {
+            size_t where = at++;
+            Value index = Expression();
+            Expect("]");
+            if (failed)
+            {
+                break;
+            }
+            if (index.regs.size() != 1 || !IsConstant(index.regs[0]))
+            {
+                Fail(where, "an index must be known when compiling");
+                break;
+            }
+
+            int i = (int)ConstantValue(index.regs[0]);
+            int count = (value.rows > 1) ? value.rows : value.columns;
+            if (i < 0 || i >= count || value.regs.size() == 1)
+            {
+                Fail(where, "index out of range");
+                break;
+            }
+
+            Value picked = MakeValue(1, (value.rows > 1) ? value.columns : 1);
+            for (int c = 0; c < picked.columns; ++c)
+            {
+                picked.regs[c] = (value.rows > 1) ? value.regs[i * value.columns + c] : value.regs[i];
+            }
+            value = picked;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return value;
+}
+
+Value Compiler::Primary()
+{
+    Value zero = Constants(1, 1, std::vector<float>());
+    if (at >= end)
+    {
+        Fail(at, "expected an expression");
+        return zero;
+    }
+
+    const Token& token = (*tokens)[at];
+    size_t where = at++;
+
+    if (token.text == "(")
+    {
+        // a cast, or an expression in parentheses
+        Type type;
+        if (at + 1 < end && ParseType((*tokens)[at].text, &type) && (*tokens)[at + 1].text == ")")
+        {
+            at += 2;
+            Value operand = Unary();
+            return Convert(operand, type.rows, type.columns, true);
+        }
+
+        Value inner = Expression();
+        Expect(")");
+        return inner;
+    }
+
+    if (!token.identifier)
+    {
+        if (!isdigit((unsigned char)token.text[0]) && token.text[0] != '.')
+        {
+            Fail(where, "unexpected " + token.text);
+            return zero;
+        }
+        return Constants(1, 1, std::vector<float>(1, (float)strtod(token.text.c_str(), NULL)));
+    }
+
+    if (Is("("))
+    {
+        return Call(token.text, where);
+    }
+
+    if (token.text == "true" || token.text == "false")
+    {
+        return Constants(1, 1, std::vector<float>(1, (token.text == "true") ? 1.0f : 0.0f));
+    }
+
+    Variable* variable = Find(token.text);
+    if (variable && variable->structDecl)
+    {
+        // Input.mPosition
+        if (!Is(".") || at + 1 >= end)
+        {
+            Fail(where, "a struct can only be read by member");
+            return zero;
+        }
+        std::string member = (*tokens)[at + 1].text;
+        at += 2;
+        variable = Find(token.text + "." + member);
+        if (!variable)
+        {
+            Fail(where, token.text + " has no member " + member);
+            return zero;
+        }
+    }
+    if (variable)
+    {
+        return Read(*variable);
+    }
+
+    const Global* global = FindEffectGlobal(*effect, token.text);
+    Value value;
+    if (global && Uniform(*global, &value))
+    {
+        return value;
+    }
+
+    Fail(where, "unknown name " + token.text);
+    return zero;
+}
+
+Value Compiler::Call(const std::string& name, size_t where)
+{
+    Value zero = Constants(1, 1, std::vector<float>());
+    ++at;   // (
+
+    // tex2D(sampler, uv), texCUBE(sampler, direction)
+    if (name == "tex2D" || name == "texCUBE")
+    {
+        bool cube = (name == "texCUBE");
+        if (at >= end || !(*tokens)[at].identifier)
+        {
+            Fail(where, name + " needs a sampler");
+            return zero;
+        }
+        int sampler = Sampler((*tokens)[at++].text, cube);
+        Expect(",");
+        Value coords = Expression();
+        Expect(")");
+        int needed = cube ? 3 : 2;
+        if (failed || (int)coords.regs.size() < needed)
+        {
+            Fail(where, name + " needs more coordinates");
+            return zero;
+        }
+
+        Value result = MakeValue(1, 4);
+        int dst = Allocate(4);
+        EmitTo(cube ? SHADER_OP_TEXCUBE : SHADER_OP_TEX2D, dst, coords.regs[0], coords.regs[1],
+            cube ? coords.regs[2] : NO_REGISTER);
+        program->code.back().sampler = (unsigned char)sampler;
+        for (int i = 0; i < 4; ++i)
+        {
+            result.regs[i] = dst + i;
+        }
+        return result;
+    }
+
+    std::vector<Value> arguments;
+    while (at < end && !Is(")") && !failed)
+    {
+        arguments.push_back(Expression());
+        if (!Is(")"))
+        {
+            Expect(",");
+        }
+    }
+    Expect(")");
+    if (failed)
+    {
+        return zero;
+    }
+
+    // float4(v, 1), float3x3(a, b, c)
+    Type type;
+    if (ParseType(name, &type))
+    {
+        Value result = MakeValue(type.rows, type.columns);
+        std::vector<int> components;
+        for (size_t i = 0; i < arguments.size(); ++i)
+        {
+            components.insert(components.end(), arguments[i].regs.begin(), arguments[i].regs.end());
+        }
+        if (components.size() == 1)
+        {
+            return Convert(arguments[0], type.rows, type.columns, false);
+        }
+        if (components.size() != result.regs.size())
+        {
+            Fail(where, "wrong number of components for " + name);
+            return zero;
+        }
+        result.regs = components;
+        return result;
+    }
+
+    struct Intrinsic
+    {
+        const char* name;
+        int arguments;
+        int op;                 // for the ones done component by component
+    };
+    static const Intrinsic intrinsics[] =
+    {
+        { "saturate", 1, SHADER_OP_SAT }, { "abs", 1, SHADER_OP_ABS }, { "floor", 1, SHADER_OP_FLOOR },
+        { "ceil", 1, SHADER_OP_CEIL }, { "frac", 1, SHADER_OP_FRAC }, { "sqrt", 1, SHADER_OP_SQRT },
+        { "rsqrt", 1, SHADER_OP_RSQ }, { "exp", 1, SHADER_OP_EXP }, { "log", 1, SHADER_OP_LOG },
+        { "sin", 1, SHADER_OP_SIN }, { "cos", 1, SHADER_OP_COS }, { "pow", 2, SHADER_OP_POW },
+        { "min", 2, SHADER_OP_MIN }, { "max", 2, SHADER_OP_MAX },
+        { "mul", 2, -1 }, { "dot", 2, -1 }, { "normalize", 1, -1 }, { "length", 1, -1 },
+        { "distance", 2, -1 }, { "reflect", 2, -1 }, { "cross", 2, -1 }, { "transpose", 1, -1 },
+        { "lerp", 3, -1 }, { "clamp", 3, -1 }, { "step", 2, -1 }, { "exp2", 1, -1 }, { "log2", 1, -1 }
+    };
+
+    const Intrinsic* intrinsic = NULL;
+    for (size_t i = 0; i < sizeof(intrinsics) / sizeof(intrinsics[0]); ++i)
+    {
+        intrinsic = (name == intrinsics[i].name) ? &intrinsics[i] : intrinsic;
+    }
+    if (!intrinsic)
+    {
+        Fail(where, "unsupported function " + name);
+        return zero;
+    }
+    if ((int)arguments.size() != intrinsic->arguments)
+    {
+        Fail(where, "wrong number of arguments for " + name);
+        return zero;
+    }
+
+    const Value& a = arguments[0];
+    if (intrinsic->op >= 0)
+    {
+        return (intrinsic->arguments == 1) ? Map(intrinsic->op, a) : Map(intrinsic->op, a, arguments[1]);
+    }
+
+    if (name == "mul")
+    {
+        return Multiply(a, arguments[1]);
+    }
+
+    Value result = MakeValue(1, 1);
+    if (name == "dot")
+    {
+        result.regs[0] = Dot(a, arguments[1]);
+        return result;
+    }
+    if (name == "length" || name == "distance")
+    {
+        Value v = (name == "distance") ? Map(SHADER_OP_SUB, a, arguments[1]) : a;
+        result.regs[0] = Emit(SHADER_OP_SQRT, Dot(v, v));
+        return result;
+    }
+    if (name == "normalize")
+    {
+        result.regs[0] = Emit(SHADER_OP_RSQ, Dot(a, a));
+        return Map(SHADER_OP_MUL, a, result);
+    }
+    if (name == "reflect")
+    {
+        // i - 2 * dot(n, i) * n
+        const Value& n = arguments[1];
+        result.regs[0] = Emit(SHADER_OP_MUL, Dot(n, a), Constant(-2.0f));
+        return Map(SHADER_OP_MAD, result, n, a);
+    }
+    if (name == "cross")
+    {
+        const Value& b = arguments[1];
+        if (a.regs.size() < 3 || b.regs.size() < 3)
+        {
+            Fail(where, "cross needs 3 components");
+            return zero;
+        }
+        result = MakeValue(1, 3);
+        for (int i = 0; i < 3; ++i)
+        {
+            int j = (i + 1) % 3;
+            int k = (i + 2) % 3;
+            result.regs[i] = Emit(SHADER_OP_SUB, Emit(SHADER_OP_MUL, a.regs[j], b.regs[k]),
+                Emit(SHADER_OP_MUL, a.regs[k], b.regs[j]));
+        }
+        return result;
+    }
+    if (name == "transpose")
+    {
+        result = MakeValue(a.columns, a.rows);
+        for (int r = 0; r < a.rows; ++r)
+        {
+            for (int c = 0; c < a.columns; ++c)
+            {
+                result.regs[c * a.rows + r] = a.regs[r * a.columns + c];
+            }
+        }
+        return result;
+    }
+    if (name == "lerp")
+    {
+        // a + t * (b - a)
+        return Map(SHADER_OP_MAD, arguments[2], Map(SHADER_OP_SUB, arguments[1], a), a);
+    }
+    if (name == "clamp")
+    {
+        return Map(SHADER_OP_MIN, Map(SHADER_OP_MAX, a, arguments[1]), arguments[2]);
+    }
+    if (name == "step")
+    {
+        return Map(SHADER_OP_LE, a, arguments[1]);
+    }
+    if (name == "exp2")
+    {
+        return Map(SHADER_OP_EXP, Map(SHADER_OP_MUL, a, Constants(1, 1, std::vector<float>(1, 0.693147181f))));
+    }
+    // log2
+    return Map(SHADER_OP_MUL, Map(SHADER_OP_LOG, a), Constants(1, 1, std::vector<float>(1, 1.44269504f)));
+}
+
+Value Compiler::Range(size_t begin, size_t finish)
+{
+    at = begin;
+    end = finish;
+    Value value = Expression();
+    if (!failed && at != end)
+    {
+        Fail(at, "unexpected " + (*tokens)[at].text);
+    }
+    return value;
+}
+
+//----------------------------------------------------------------------
+// statements
+//----------------------------------------------------------------------
+
+void Compiler::PushScope()
+{
+    scopes.push_back(std::map<std::string, Variable>());
+    scopeMarks.push_back(next);
+}
+
+// the registers of the scope's variables are free again
+void Compiler::PopScope()
+{
+    next = scopeMarks.back();
+    scopeMarks.pop_back();
+    scopes.pop_back();
+}
+
+// a holder for the struct, and a variable for each member
+void Compiler::DeclareStruct(const std::string& name, const StructDecl& decl)
+{
+    Variable holder;
+    holder.storage = MakeValue(0, 0);
+    holder.constant = holder.storage;
+    holder.isConstant = false;
+    holder.maskDepth = masks.size();
+    holder.structDecl = &decl;
+    scopes.back()[name] = holder;
+
+    for (size_t i = 0; i < decl.members.size(); ++i)
+    {
+        const StructMember& member = decl.members[i];
+        if (member.type.columns == 0)
+        {
+            Fail(member.begin, "unsupported member type in " + decl.name);
+            return;
+        }
+        Declare(name + "." + member.name, member.type.rows, member.type.columns);
+    }
+}
+
+// the variables written between begin and finish; they are put in their
+// registers before code only some lanes run
+void Compiler::CollectAssigned(size_t begin, size_t finish, std::set<std::string>& names)
+{
+    const std::vector<Token>& t = *tokens;
+    for (size_t i = begin; i < finish; ++i)
+    {
+        if (!t[i].identifier || (i > 0 && t[i - 1].text == "."))
+        {
+            continue;
+        }
+
+        size_t j = i + 1;
+        while (j < finish && (t[j].text == "." || t[j].text == "["))
+        {
+            j = (t[j].text == ".") ? j + 2 : SkipBalanced(t, j, "[", "]");
+        }
+        const std::string& op = (j < finish) ? t[j].text : t[i].text;
+        if (op == "=" || op == "+=" || op == "-=" || op == "*=" || op == "/=" || op == "++" || op == "--" ||
+            (i > 0 && (t[i - 1].text == "++" || t[i - 1].text == "--")))
+        {
+            names.insert(t[i].text);
+        }
+    }
+}
+
+// the token after the statement or block at begin
+size_t Compiler::BodyEnd(size_t begin, size_t finish)
+{
+    const std::vector<Token>& t = *tokens;
+    if (begin >= finish)
+    {
+        return finish;
+    }
+    if (t[begin].text == "{")
+    {
+        return SkipBalanced(t, begin, "{", "}");
+    }
+    if (t[begin].text == "if" || t[begin].text == "for" || t[begin].text == "while")
+    {
+        size_t after = BodyEnd(SkipBalanced(t, begin + 1, "(", ")"), finish);
+        if (t[begin].text == "if" && after < finish && t[after].text == "else")
+        {
+            after = BodyEnd(after + 1, finish);
+        }
+        return after;
+    }
+    return FindStatementEnd(t, begin, finish) + 1;
+}
+
+void Compiler::Statements(size_t begin, size_t finish)
+{
+    size_t i = begin;
+    while (i < finish && !failed)
+    {
+        if (returned)
+        {
+            Fail(i, "code after the return");
+            break;
+        }
+        i = Statement(i, finish);
+    }
+}
+
+// compiles the statement at begin, returning the token after it
+size_t Compiler::Statement(size_t begin, size_t finish)
+{
+    const std::vector<Token>& t = *tokens;
+    const std::string& word = t[begin].text;
+
+    if (word == "{")
+    {
+        return Body(begin, finish, NO_REGISTER);
+    }
+    if (word == "if")
+    {
+        return If(begin, finish);
+    }
+    if (word == "for")
+    {
+        return For(begin, finish);
+    }
+    if (word == "return")
+    {
+        return Return(begin, finish);
+    }
+    if (word == ";")
+    {
+        return begin + 1;
+    }
+    if (word == "while" || word == "do" || word == "switch" || word == "break" || word == "continue" ||
+        word == "discard" || word == "else")
+    {
+        Fail(begin, "unsupported statement " + word);
+        return finish;
+    }
+
+    size_t semicolon = FindStatementEnd(t, begin, finish);
+    Simple(begin, semicolon);
+    return semicolon + 1;
+}
+
+// the statement or block at begin in a scope of its own, run by the
+// lanes in mask if it is not NO_REGISTER
+size_t Compiler::Body(size_t begin, size_t finish, int mask)
+{
+    const std::vector<Token>& t = *tokens;
+
+    PushScope();
+    if (mask != NO_REGISTER)
+    {
+        masks.push_back(mask);
+    }
+
+    size_t after;
+    if (begin < finish && t[begin].text == "{")
+    {
+        after = SkipBalanced(t, begin, "{", "}");
+        Statements(begin + 1, after - 1);
+    }
+    else
+    {
+        after = (begin < finish) ? Statement(begin, finish) : finish;
+    }
+
+    if (mask != NO_REGISTER)
+    {
+        masks.pop_back();
+    }
+    PopScope();
+    return after;
+}
+
+// a body the lanes in mask run, jumped over when there are none
+void Compiler::Branch(int mask, size_t begin, size_t finish)
+{
+    size_t skip = program->code.size();
+    EmitTo(SHADER_OP_SKIP, 0, mask, NO_REGISTER, NO_REGISTER);
+    Body(begin, finish, mask);
+    program->code[skip].dst = (unsigned short)program->code.size();
+}
+
+size_t Compiler::If(size_t begin, size_t finish)
+{
+    const std::vector<Token>& t = *tokens;
+    size_t close = SkipBalanced(t, begin + 1, "(", ")");
+    size_t thenEnd = BodyEnd(close, finish);
+    bool hasElse = (thenEnd < finish && t[thenEnd].text == "else");
+    size_t elseEnd = hasElse ? BodyEnd(thenEnd + 1, finish) : thenEnd;
+
+    int mark = next;
+    statementMark = next;
+    statementCode = program->code.size();
+    Value condition = Range(begin + 2, close - 1);
+    if (failed)
+    {
+        return finish;
+    }
+
+    int c = condition.regs[0];
+    if (IsConstant(c))
+    {
+        // only the side taken is compiled
+        if (ConstantValue(c) != 0.0f)
+        {
+            Body(close, thenEnd, NO_REGISTER);
+        }
+        else if (hasElse)
+        {
+            Body(thenEnd + 1, elseEnd, NO_REGISTER);
+        }
+        next = mark;
+        return elseEnd;
+    }
+
+    std::set<std::string> assigned;
+    CollectAssigned(close, elseEnd, assigned);
+    for (std::set<std::string>::iterator i = assigned.begin(); i != assigned.end(); ++i)
+    {
+        Variable* variable = Find(*i);
+        if (variable && variable->structDecl)
+        {
+            for (size_t m = 0; m < variable->structDecl->members.size(); ++m)
+            {
+                Materialize(*Find(*i + "." + variable->structDecl->members[m].name));
+            }
+        }
+        else if (variable)
+        {
+            Materialize(*variable);
+        }
+    }
+
+    // keep the condition where the branch cannot change it
+    if (c < mark)
+    {
+        int copy = Allocate(1);
+        EmitTo(SHADER_OP_MOV, copy, c, NO_REGISTER, NO_REGISTER);
+        c = copy;
+    }
+
+    int outer = masks.empty() ? NO_REGISTER : masks.back();
+    Branch((outer == NO_REGISTER) ? c : Emit(SHADER_OP_AND, outer, c), close, thenEnd);
+    if (hasElse)
+    {
+        int taken = Emit(SHADER_OP_NOT, c);
+        Branch((outer == NO_REGISTER) ? taken : Emit(SHADER_OP_AND, outer, taken), thenEnd + 1, elseEnd);
+    }
+
+    next = mark;
+    return elseEnd;
+}
+
+// unrolled: the counter is a constant in every iteration
+size_t Compiler::For(size_t begin, size_t finish)
+{
+    const std::vector<Token>& t = *tokens;
+    size_t close = SkipBalanced(t, begin + 1, "(", ")");
+    size_t first = FindStatementEnd(t, begin + 2, close - 1);
+    size_t second = FindStatementEnd(t, first + 1, close - 1);
+    size_t bodyEnd = BodyEnd(close, finish);
+
+    PushScope();
+    Simple(begin + 2, first);
+
+    for (int iteration = 0; !failed; ++iteration)
+    {
+        if (iteration == MAX_UNROLL)
+        {
+            Fail(begin, "the loop runs too long to unroll");
+            break;
+        }
+
+        int mark = next;
+        statementMark = next;
+        statementCode = program->code.size();
+        Value condition = Range(first + 1, second);
+        next = mark;
+        if (failed)
+        {
+            break;
+        }
+        if (!IsConstant(condition.regs[0]))
+        {
+            Fail(begin, "the loop bounds must be known when compiling");
+            break;
+        }
+        if (ConstantValue(condition.regs[0]) == 0.0f)
+        {
+            break;
+        }
+
+        Body(close, bodyEnd, NO_REGISTER);
+        Simple(second + 1, close - 1);
+    }
+
+    PopScope();
+    return bodyEnd;
+}
+
+size_t Compiler::Return(size_t begin, size_t finish)
+{
+    const std::vector<Token>& t = *tokens;
+    size_t semicolon = FindStatementEnd(t, begin, finish);
+    if (!masks.empty())
+    {
+        Fail(begin, "return inside an if");
+        return finish;
+    }
+
+    // return(Output);
+    size_t value = begin + 1;
+    size_t valueEnd = semicolon;
+    while (value < valueEnd && t[value].text == "(" && SkipBalanced(t, value, "(", ")") == valueEnd)
+    {
+        ++value;
+        --valueEnd;
+    }
+
+    statementMark = next;
+    statementCode = program->code.size();
+
+    Variable* variable = (valueEnd == value + 1) ? Find(t[value].text) : NULL;
+    if (variable && variable->structDecl)
+    {
+        const StructDecl& decl = *variable->structDecl;
+        for (size_t i = 0; i < decl.members.size(); ++i)
+        {
+            const StructMember& member = decl.members[i];
+            ShaderVariable output;
+            output.name = member.name;
+            output.semantic = member.semantic;
+            output.rows = member.type.rows;
+            output.columns = member.type.columns;
+            output.registers = Read(*Find(t[value].text + "." + member.name)).regs;
+            program->outputs.push_back(output);
+        }
+    }
+    else
+    {
+        Value result = Convert(Range(value, valueEnd), returnType.rows, returnType.columns, false);
+        ShaderVariable output;
+        output.name = "return";
+        output.semantic = returnSemantic;
+        output.rows = returnType.rows;
+        output.columns = returnType.columns;
+        output.registers = result.regs;
+        program->outputs.push_back(output);
+    }
+
+    returned = true;
+    return semicolon + 1;
+}
+
+// a declaration or an assignment, ending at finish
+void Compiler::Simple(size_t begin, size_t finish)
+{
+    const std::vector<Token>& t = *tokens;
+    if (begin >= finish || failed)
+    {
+        return;
+    }
+
+    statementMark = next;
+    statementCode = program->code.size();
+
+    size_t i = begin;
+    while (i < finish && (t[i].text == "const" || t[i].text == "static"))
+    {
+        ++i;
+    }
+
+    Type type;
+    const StructDecl* decl = FindEffectStruct(*effect, t[i].text);
+    if (i + 1 < finish && t[i + 1].identifier && ParseType(t[i].text, &type))
+    {
+        Declaration(i, finish, type);
+    }
+    else if (i + 1 < finish && t[i + 1].identifier && decl)
+    {
+        if (i + 2 < finish)
+        {
+            Fail(i + 2, "a struct cannot be initialized");
+            return;
+        }
+        DeclareStruct(t[i + 1].text, *decl);
+        statementMark = next;
+    }
+    else
+    {
+        Assignment(i, finish);
+    }
+
+    next = statementMark;
+}
+
+// type name [= value] [, name [= value] ...]
+void Compiler::Declaration(size_t begin, size_t finish, const Type& type)
+{
+    const std::vector<Token>& t = *tokens;
+
+    size_t i = begin + 1;
+    while (i < finish && !failed)
+    {
+        size_t itemEnd = i;
+        int depth = 0;
+        while (itemEnd < finish && !(depth == 0 && t[itemEnd].text == ","))
+        {
+            const std::string& text = t[itemEnd].text;
+            depth += (text == "(" || text == "[") ? 1 : (text == ")" || text == "]") ? -1 : 0;
+            ++itemEnd;
+        }
+
+        if (!t[i].identifier || (i + 1 < itemEnd && t[i + 1].text != "="))
+        {
+            Fail(i, "unsupported declaration");
+            return;
+        }
+
+        std::string name = t[i].text;
+        Variable* variable = Declare(name, type.rows, type.columns);
+        statementMark = next;
+        statementCode = program->code.size();
+        if (i + 1 < itemEnd)
+        {
+            Value value = Convert(Range(i + 2, itemEnd), type.rows, type.columns, false);
+            std::vector<int> indices(variable->storage.regs.size());
+            for (size_t c = 0; c < indices.size(); ++c)
+            {
+                indices[c] = (int)c;
+            }
+            Store(*variable, indices, value);
+        }
+        next = statementMark;
+        i = itemEnd + 1;
+    }
+}
+
+// target op value, or ++target, target++ and the like
+void Compiler::Assignment(size_t begin, size_t finish)
+{
+    const std::vector<Token>& t = *tokens;
+
+    at = begin;
+    end = finish;
+
+    std::string op;
+    if (Is("++") || Is("--"))
+    {
+        op = (t[at].text == "++") ? "+=" : "-=";
+        ++at;
+    }
+
+    if (at >= end || !t[at].identifier)
+    {
+        Fail(at, "unsupported statement");
+        return;
+    }
+
+    size_t where = at;
+    std::string name = t[at++].text;
+    Variable* variable = Find(name);
+    if (!variable)
+    {
+        Fail(where, FindEffectGlobal(*effect, name) ? "cannot write the uniform " + name : "unknown name " + name);
+        return;
+    }
+    if (variable->structDecl)
+    {
+        std::string member = (at + 1 < end && t[at].text == ".") ? t[at + 1].text : "";
+        at += 2;
+        variable = Find(name + "." + member);
+        if (!variable)
+        {
+            Fail(where, name + " has no member " + member);
+            return;
+        }
+    }
+
+    // the components written
+    int rows = variable->storage.rows;
+    int columns = variable->storage.columns;
+    std::vector<int> indices(variable->storage.regs.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = (int)i;
+    }
+    while (!failed && (Is(".") || Is("[")))
+    {
+        if (Is("."))
+        {
+            ++at;
+            std::vector<int> components;
+            std::string member = (at < end) ? t[at++].text : "";
+            std::set<int> unique;
+            if (rows != 1 || !Swizzle(member, columns, &components))
+            {
+                Fail(where, "unsupported member ." + member);
+                return;
+            }
+            std::vector<int> picked;
+            for (size_t i = 0; i < components.size(); ++i)
+            {
+                picked.push_back(indices[components[i]]);
+                unique.insert(components[i]);
+            }
+            if (unique.size() != components.size())
+            {
+                Fail(where, "a component is written twice");
+                return;
+            }
+            indices = picked;
+            columns = (int)indices.size();
+        }
+        else
+        {
+            ++at;
+            size_t indexEnd = SkipBalanced(t, at - 1, "[", "]") - 1;
+            size_t after = indexEnd + 1;
+            Value index = Range(at, indexEnd);
+            at = after;
+            end = finish;
+            if (failed || index.regs.size() != 1 || !IsConstant(index.regs[0]))
+            {
+                Fail(where, "an index must be known when compiling");
+                return;
+            }
+            int i = (int)ConstantValue(index.regs[0]);
+            if (i < 0 || i >= ((rows > 1) ? rows : columns) || indices.size() == 1)
+            {
+                Fail(where, "index out of range");
+                return;
+            }
+            std::vector<int> picked;
+            for (int c = 0; c < ((rows > 1) ? columns : 1); ++c)
+            {
+                picked.push_back((rows > 1) ? indices[i * columns + c] : indices[i]);
+            }
+            indices = picked;
+            columns = (int)indices.size();
+            rows = 1;
+        }
+    }
+
+    Value value;
+    if (!op.empty() || Is("++") || Is("--"))
+    {
+        op = !op.empty() ? op : (t[at].text == "++") ? "+=" : "-=";
+        at += Is("++") || Is("--") ? 1 : 0;
+        if (at != end)
+        {
+            Fail(at, "unexpected " + t[at].text);
+            return;
+        }
+        value = Constants(1, 1, std::vector<float>(1, 1.0f));
+    }
+    else
+    {
+        op = (at < end) ? t[at].text : "";
+        if (op != "=" && op != "+=" && op != "-=" && op != "*=" && op != "/=")
+        {
+            Fail(at, "unsupported statement");
+            return;
+        }
+        value = Range(at + 1, finish);
+    }
+    if (failed)
+    {
+        return;
+    }
+
+    if (op != "=")
+    {
+        Value current = MakeValue(rows, columns);
+        Value whole = Read(*variable);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            current.regs[i] = whole.regs[indices[i]];
+        }
+        int opcode = (op == "+=") ? SHADER_OP_ADD : (op == "-=") ? SHADER_OP_SUB :
+            (op == "*=") ? SHADER_OP_MUL : SHADER_OP_DIV;
+        value = Map(opcode, current, value);
+    }
+
+    Store(*variable, indices, Convert(value, rows, columns, false));
+}
+
+//----------------------------------------------------------------------
+// setup and optimization
+//----------------------------------------------------------------------
+
+// the value after = in a global's declaration, e.g. = float3(0, 1, 0) or
+// = { -1, 0, 1, ... }; zeros if it has none
+static void ReadDefault(const std::vector<Token>& tokens, const Global& global, ShaderVariable* uniform)
+{
+    size_t equals = 0;
+    int depth = 0;
+    for (size_t i = global.begin; i < global.end && equals == 0; ++i)
+    {
+        const std::string& text = tokens[i].text;
+        depth += (text == "<") ? 1 : (text == ">") ? -1 : 0;
+        equals = (depth == 0 && text == "=") ? i : 0;
+    }
+
+    size_t count = (size_t)(uniform->rows * uniform->columns);
+    float sign = 1.0f;
+    for (size_t i = equals + 1; equals != 0 && i < global.end; ++i)
+    {
+        const std::string& text = tokens[i].text;
+        if (text == "-")
+        {
+            sign = -1.0f;
+        }
+        else if (!tokens[i].identifier && (isdigit((unsigned char)text[0]) || text[0] == '.'))
+        {
+            uniform->values.push_back(sign * (float)strtod(text.c_str(), NULL));
+            sign = 1.0f;
+        }
+    }
+
+    if (uniform->values.size() == 1)
+    {
+        uniform->values.resize(count, uniform->values[0]);
+    }
+    uniform->values.resize(count, 0.0f);
+}
+
+// the parameters of the function, and the uniforms it reads
+static void DeclareInputs(Compiler& compiler, const Function& function)
+{
+    const std::vector<Token>& t = *compiler.tokens;
+    ShaderProgram* program = compiler.program;
+
+    // [in] type name [: semantic], ...
+    size_t close = SkipBalanced(t, function.begin + 2, "(", ")") - 1;
+    size_t i = function.begin + 3;
+    while (i < close && !compiler.failed)
+    {
+        size_t parameterEnd = i;
+        while (parameterEnd < close && t[parameterEnd].text != ",")
+        {
+            ++parameterEnd;
+        }
+
+        size_t j = (t[i].text == "in") ? i + 1 : i;
+        if (j + 1 >= parameterEnd || t[j].text == "out" || t[j].text == "inout" || t[j].text == "uniform")
+        {
+            compiler.Fail(i, "unsupported parameter");
+            return;
+        }
+        std::string name = t[j + 1].text;
+        std::string semantic = (j + 3 < parameterEnd && t[j + 2].text == ":") ? t[j + 3].text : "";
+
+        const StructDecl* decl = FindEffectStruct(*compiler.effect, t[j].text);
+        std::vector<std::string> names;
+        std::vector<ShaderVariable> inputs;
+        Type type;
+        if (decl)
+        {
+            compiler.DeclareStruct(name, *decl);
+            for (size_t m = 0; m < decl->members.size(); ++m)
+            {
+                ShaderVariable input;
+                input.name = decl->members[m].name;
+                input.semantic = decl->members[m].semantic;
+                names.push_back(name + "." + input.name);
+                inputs.push_back(input);
+            }
+        }
+        else if (ParseType(t[j].text, &type))
+        {
+            compiler.Declare(name, type.rows, type.columns);
+            ShaderVariable input;
+            input.name = name;
+            input.semantic = semantic;
+            names.push_back(name);
+            inputs.push_back(input);
+        }
+        else
+        {
+            compiler.Fail(j, "unsupported parameter type " + t[j].text);
+            return;
+        }
+
+        for (size_t n = 0; n < names.size() && !compiler.failed; ++n)
+        {
+            Variable* variable = compiler.Find(names[n]);
+            variable->isConstant = false;
+            inputs[n].rows = variable->storage.rows;
+            inputs[n].columns = variable->storage.columns;
+            inputs[n].registers = variable->storage.regs;
+            program->inputs.push_back(inputs[n]);
+        }
+        i = parameterEnd + 1;
+    }
+
+    // every global the body names gets registers, in the order first named
+    for (size_t k = function.bodyBegin; k < function.bodyEnd && !compiler.failed; ++k)
+    {
+        const Global* global = t[k].identifier ? FindEffectGlobal(*compiler.effect, t[k].text) : NULL;
+        if (!global || global->type.columns == 0 || compiler.uniforms.count(global->name) ||
+            compiler.bakedValues.count(global->name))
+        {
+            continue;
+        }
+
+        ShaderVariable uniform;
+        uniform.name = global->name;
+        uniform.rows = global->type.rows;
+        uniform.columns = global->type.columns;
+        if (compiler.baked && compiler.baked->count(global->name))
+        {
+            ReadDefault(t, *global, &uniform);
+            compiler.bakedValues[global->name] = compiler.Constants(uniform.rows, uniform.columns, uniform.values);
+            continue;
+        }
+
+        int first = compiler.Allocate(uniform.rows * uniform.columns);
+        for (int r = 0; r < uniform.rows * uniform.columns; ++r)
+        {
+            uniform.registers.push_back(first + r);
+        }
+        ReadDefault(t, *global, &uniform);
+
+        compiler.uniforms[global->name] = (int)program->uniforms.size();
+        program->uniforms.push_back(uniform);
+    }
+}
+
+static void CollectOutputRegisters(ShaderProgram* program)
+{
+    program->inputRegisters.clear();
+    program->outputRegisters.clear();
+    for (size_t i = 0; i < program->inputs.size(); ++i)
+    {
+        const std::vector<int>& registers = program->inputs[i].registers;
+        program->inputRegisters.insert(program->inputRegisters.end(), registers.begin(), registers.end());
+    }
+    for (size_t i = 0; i < program->outputs.size(); ++i)
+    {
+        const std::vector<int>& registers = program->outputs[i].registers;
+        program->outputRegisters.insert(program->outputRegisters.end(), registers.begin(), registers.end());
+    }
+}
+
+static int WrittenCount(const ShaderInstruction& instruction)
+{
+    switch (instruction.op)
+    {
+    case SHADER_OP_TEX2D:
+    case SHADER_OP_TEXCUBE:
+        return 4;
+    case SHADER_OP_SKIP:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+// drops the instructions whose results are never read, and the skips
+// over code that is all gone, until there are none left to drop
+static void RemoveDeadCode(ShaderProgram* program)
+{
+    std::vector<ShaderInstruction>& code = program->code;
+    std::vector<char> live(0x10000);
+
+    bool changed = true;
+    while (changed)
+    {
+        std::fill(live.begin(), live.end(), 0);
+        for (size_t i = 0; i < program->outputRegisters.size(); ++i)
+        {
+            live[program->outputRegisters[i]] = 1;
+        }
+
+        // backwards; a write inside an if is a sel that reads the old
+        // value, so what is live before the if is found without
+        // following the skips
+        std::vector<char> keep(code.size(), 0);
+        for (size_t i = code.size(); i-- > 0; )
+        {
+            const ShaderInstruction& instruction = code[i];
+            bool needed = false;
+            if (instruction.op == SHADER_OP_SKIP)
+            {
+                for (size_t k = i + 1; k < instruction.dst; ++k)
+                {
+                    needed = needed || keep[k];
+                }
+            }
+            for (int w = 0; w < WrittenCount(instruction); ++w)
+            {
+                needed = needed || live[instruction.dst + w];
+            }
+            if (!needed)
+            {
+                continue;
+            }
+
+            keep[i] = 1;
+            for (int w = 0; w < WrittenCount(instruction); ++w)
+            {
+                live[instruction.dst + w] = 0;
+            }
+            int reads[3] = { instruction.a, instruction.b, instruction.c };
+            for (int s = 0; s < gOpSources[instruction.op]; ++s)
+            {
+                live[reads[s]] = 1;
+            }
+        }
+
+        std::vector<size_t> renumbered(code.size() + 1);
+        size_t kept = 0;
+        for (size_t i = 0; i < code.size(); ++i)
+        {
+            renumbered[i] = kept;
+            if (keep[i])
+            {
+                code[kept++] = code[i];
+            }
+        }
+        renumbered[code.size()] = kept;
+
+        changed = (kept != code.size());
+        code.resize(kept);
+        for (size_t i = 0; i < code.size(); ++i)
+        {
+            if (code[i].op == SHADER_OP_SKIP)
+            {
+                code[i].dst = (unsigned short)renumbered[code[i].dst];
+            }
+        }
+    }
+}
+
+static bool IsConstantValue(const ShaderProgram& program, int reg, float value)
+{
+    return reg >= CONSTANT_BASE && program.constants[reg - CONSTANT_BASE] == value;
+}
+
+// turns what propagated constants make trivial, such as x + 0 once x's
+// offset is known to be 0, into a mov
+static void SimplifyInstruction(ShaderProgram* program, ShaderInstruction& instruction)
+{
+    int sources = gOpSources[instruction.op];
+    if (instruction.op == SHADER_OP_SKIP || instruction.op == SHADER_OP_TEX2D ||
+        instruction.op == SHADER_OP_TEXCUBE || instruction.op == SHADER_OP_MOV)
+    {
+        return;
+    }
+
+    int from = NO_REGISTER;
+    bool known = instruction.a >= CONSTANT_BASE && (sources < 2 || instruction.b >= CONSTANT_BASE) &&
+        (sources < 3 || instruction.c >= CONSTANT_BASE);
+    if (known)
+    {
+        const std::vector<float>& k = program->constants;
+        float value = Evaluate(instruction.op, k[instruction.a - CONSTANT_BASE],
+            (sources >= 2) ? k[instruction.b - CONSTANT_BASE] : 0.0f,
+            (sources >= 3) ? k[instruction.c - CONSTANT_BASE] : 0.0f);
+        from = CONSTANT_BASE + (int)k.size();
+        program->constants.push_back(value);
+    }
+    else if (instruction.op == SHADER_OP_ADD && IsConstantValue(*program, instruction.b, 0.0f))
+    {
+        from = instruction.a;
+    }
+    else if (instruction.op == SHADER_OP_ADD && IsConstantValue(*program, instruction.a, 0.0f))
+    {
+        from = instruction.b;
+    }
+    else if ((instruction.op == SHADER_OP_SUB && IsConstantValue(*program, instruction.b, 0.0f)) ||
+        (instruction.op == SHADER_OP_MUL && IsConstantValue(*program, instruction.b, 1.0f)))
+    {
+        from = instruction.a;
+    }
+    else if (instruction.op == SHADER_OP_MUL && IsConstantValue(*program, instruction.a, 1.0f))
+    {
+        from = instruction.b;
+    }
+    else if (instruction.op == SHADER_OP_MAD &&
+        (IsConstantValue(*program, instruction.a, 0.0f) || IsConstantValue(*program, instruction.b, 0.0f)))
+    {
+        from = instruction.c;
+    }
+    else if (instruction.op == SHADER_OP_SEL && instruction.b == instruction.c)
+    {
+        from = instruction.b;
+    }
+
+    if (from != NO_REGISTER)
+    {
+        instruction.op = SHADER_OP_MOV;
+        instruction.a = (unsigned short)from;
+        instruction.b = 0;
+        instruction.c = 0;
+    }
+}
+
+// reads the source of a mov instead of its copy, leaving the mov to be
+// dropped. what is known about copies is forgotten at every skip and
+// every instruction a skip lands on, since a skipped body may or may
+// not have run.
+static void PropagateCopies(ShaderProgram* program)
+{
+    std::vector<ShaderInstruction>& code = program->code;
+    std::vector<int> copyOf(0x10000, NO_REGISTER);
+    std::vector<int> copies;                    // registers with a copyOf
+
+    std::vector<char> landing(code.size() + 1, 0);
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        if (code[i].op == SHADER_OP_SKIP)
+        {
+            landing[code[i].dst] = 1;
+        }
+    }
+
+    for (size_t i = 0; i <= code.size(); ++i)
+    {
+        if (landing[i] || (i < code.size() && code[i].op == SHADER_OP_SKIP))
+        {
+            for (size_t c = 0; c < copies.size(); ++c)
+            {
+                copyOf[copies[c]] = NO_REGISTER;
+            }
+            copies.clear();
+        }
+        if (i == code.size())
+        {
+            break;
+        }
+
+        ShaderInstruction& instruction = code[i];
+        unsigned short* reads[3] = { &instruction.a, &instruction.b, &instruction.c };
+        for (int s = 0; s < gOpSources[instruction.op]; ++s)
+        {
+            if (copyOf[*reads[s]] != NO_REGISTER)
+            {
+                *reads[s] = (unsigned short)copyOf[*reads[s]];
+            }
+        }
+        SimplifyInstruction(program, instruction);
+
+        // what was a copy of, or copied into, a register written is not any more
+        for (int w = 0; w < WrittenCount(instruction); ++w)
+        {
+            int written = instruction.dst + w;
+            for (size_t c = 0; c < copies.size(); )
+            {
+                if (copies[c] == written || copyOf[copies[c]] == written)
+                {
+                    copyOf[copies[c]] = NO_REGISTER;
+                    copies[c] = copies.back();
+                    copies.pop_back();
+                }
+                else
+                {
+                    ++c;
+                }
+            }
+        }
+
+        if (instruction.op == SHADER_OP_MOV && instruction.a != instruction.dst)
+        {
+            copyOf[instruction.dst] = instruction.a;
+            copies.push_back(instruction.dst);
+        }
+    }
+
+    for (size_t i = 0; i < program->outputs.size(); ++i)
+    {
+        std::vector<int>& registers = program->outputs[i].registers;
+        for (size_t r = 0; r < registers.size(); ++r)
+        {
+            registers[r] = (copyOf[registers[r]] != NO_REGISTER) ? copyOf[registers[r]] : registers[r];
+        }
+    }
+}
+
+// moves the constants still read after the other registers
+static void PlaceConstants(ShaderProgram* program, int registerCount)
+{
+    std::vector<int> placed(program->constants.size(), -1);
+    std::vector<float> constants;
+
+    std::vector<int*> operands;
+    for (size_t i = 0; i < program->outputs.size(); ++i)
+    {
+        std::vector<int>& registers = program->outputs[i].registers;
+        for (size_t r = 0; r < registers.size(); ++r)
+        {
+            operands.push_back(&registers[r]);
+        }
+    }
+
+    std::vector<int> reads(program->code.size() * 3);
+    for (size_t i = 0; i < program->code.size(); ++i)
+    {
+        const ShaderInstruction& instruction = program->code[i];
+        reads[i * 3] = instruction.a;
+        reads[i * 3 + 1] = instruction.b;
+        reads[i * 3 + 2] = instruction.c;
+        for (int s = 0; s < gOpSources[instruction.op]; ++s)
+        {
+            operands.push_back(&reads[i * 3 + s]);
+        }
+    }
+
+    for (size_t i = 0; i < operands.size(); ++i)
+    {
+        int& reg = *operands[i];
+        if (reg < CONSTANT_BASE)
+        {
+            continue;
+        }
+        // the same value may have been added twice when simplifying
+        int index = reg - CONSTANT_BASE;
+        for (size_t c = 0; c < constants.size() && placed[index] < 0; ++c)
+        {
+            placed[index] = (memcmp(&constants[c], &program->constants[index], sizeof(float)) == 0) ?
+                registerCount + (int)c : -1;
+        }
+        if (placed[index] < 0)
+        {
+            placed[index] = registerCount + (int)constants.size();
+            constants.push_back(program->constants[index]);
+        }
+        reg = placed[index];
+    }
+
+    for (size_t i = 0; i < program->code.size(); ++i)
+    {
+        ShaderInstruction& instruction = program->code[i];
+        instruction.a = (unsigned short)reads[i * 3];
+        instruction.b = (unsigned short)reads[i * 3 + 1];
+        instruction.c = (unsigned short)reads[i * 3 + 2];
+    }
+
+    program->constants = constants;
+    program->constantRegister = registerCount;
+    program->registerCount = registerCount + (int)constants.size();
+}
+
+//----------------------------------------------------------------------
+// interpreter
+//----------------------------------------------------------------------
+
+#define FOR_LANES(statement)    for (int l = 0; l < SHADER_LANES; ++l) { statement; }
+
+static void Execute(const ShaderProgram& program, ShaderContext* context)
+{
+    float* r = context->registers;
+    const ShaderInstruction* code = &program.code[0];
+    size_t count = program.code.size();
+
+    for (size_t pc = 0; pc < count; ++pc)
+    {
+        const ShaderInstruction& instruction = code[pc];
+        const float* a = r + instruction.a * SHADER_LANES;
+        const float* b = r + instruction.b * SHADER_LANES;
+        const float* c = r + instruction.c * SHADER_LANES;
+
+        if (instruction.op == SHADER_OP_SKIP)
+        {
+            bool any = false;
+            FOR_LANES(any = any || a[l] != 0.0f);
+            pc = any ? pc : instruction.dst - 1;
+            continue;
+        }
+
+        float* d = r + instruction.dst * SHADER_LANES;
+        switch (instruction.op)
+        {
+        case SHADER_OP_MOV:   FOR_LANES(d[l] = a[l]); break;
+        case SHADER_OP_ADD:   FOR_LANES(d[l] = a[l] + b[l]); break;
+        case SHADER_OP_SUB:   FOR_LANES(d[l] = a[l] - b[l]); break;
+        case SHADER_OP_MUL:   FOR_LANES(d[l] = a[l] * b[l]); break;
+        case SHADER_OP_DIV:   FOR_LANES(d[l] = a[l] / b[l]); break;
+        case SHADER_OP_MAD:   FOR_LANES(d[l] = a[l] * b[l] + c[l]); break;
+        case SHADER_OP_MIN:   FOR_LANES(d[l] = (a[l] < b[l]) ? a[l] : b[l]); break;
+        case SHADER_OP_MAX:   FOR_LANES(d[l] = (a[l] > b[l]) ? a[l] : b[l]); break;
+        case SHADER_OP_NEG:   FOR_LANES(d[l] = -a[l]); break;
+        case SHADER_OP_ABS:   FOR_LANES(d[l] = fabsf(a[l])); break;
+        case SHADER_OP_SAT:   FOR_LANES(d[l] = (a[l] < 0.0f) ? 0.0f : (a[l] > 1.0f) ? 1.0f : a[l]); break;
+        case SHADER_OP_FLOOR: FOR_LANES(d[l] = floorf(a[l])); break;
+        case SHADER_OP_CEIL:  FOR_LANES(d[l] = ceilf(a[l])); break;
+        case SHADER_OP_FRAC:  FOR_LANES(d[l] = a[l] - floorf(a[l])); break;
+        case SHADER_OP_SQRT:  FOR_LANES(d[l] = sqrtf(a[l])); break;
+        case SHADER_OP_RSQ:   FOR_LANES(d[l] = 1.0f / sqrtf(a[l])); break;
+        case SHADER_OP_RCP:   FOR_LANES(d[l] = 1.0f / a[l]); break;
+        case SHADER_OP_EXP:   FOR_LANES(d[l] = expf(a[l])); break;
+        case SHADER_OP_LOG:   FOR_LANES(d[l] = logf(a[l])); break;
+        case SHADER_OP_POW:   FOR_LANES(d[l] = powf(a[l], b[l])); break;
+        case SHADER_OP_SIN:   FOR_LANES(d[l] = sinf(a[l])); break;
+        case SHADER_OP_COS:   FOR_LANES(d[l] = cosf(a[l])); break;
+        case SHADER_OP_LT:    FOR_LANES(d[l] = (a[l] < b[l]) ? 1.0f : 0.0f); break;
+        case SHADER_OP_LE:    FOR_LANES(d[l] = (a[l] <= b[l]) ? 1.0f : 0.0f); break;
+        case SHADER_OP_EQ:    FOR_LANES(d[l] = (a[l] == b[l]) ? 1.0f : 0.0f); break;
+        case SHADER_OP_NE:    FOR_LANES(d[l] = (a[l] != b[l]) ? 1.0f : 0.0f); break;
+        case SHADER_OP_AND:   FOR_LANES(d[l] = (a[l] != 0.0f && b[l] != 0.0f) ? 1.0f : 0.0f); break;
+        case SHADER_OP_OR:    FOR_LANES(d[l] = (a[l] != 0.0f || b[l] != 0.0f) ? 1.0f : 0.0f); break;
+        case SHADER_OP_NOT:   FOR_LANES(d[l] = (a[l] == 0.0f) ? 1.0f : 0.0f); break;
+        case SHADER_OP_SEL:   FOR_LANES(d[l] = (a[l] != 0.0f) ? b[l] : c[l]); break;
+        case SHADER_OP_TEX2D:
+        {
+            const ShaderTexture* texture = context->textures[instruction.sampler];
+            for (int l = 0; l < SHADER_LANES; ++l)
+            {
+                float rgba[4];
+                SampleTexture2D(texture, a[l], b[l], rgba);
+                d[l] = rgba[0];
+                d[SHADER_LANES + l] = rgba[1];
+                d[SHADER_LANES * 2 + l] = rgba[2];
+                d[SHADER_LANES * 3 + l] = rgba[3];
+            }
+            break;
+        }
+        case SHADER_OP_TEXCUBE:
+        {
+            const ShaderTexture* texture = context->textures[instruction.sampler];
+            for (int l = 0; l < SHADER_LANES; ++l)
+            {
+                float rgba[4];
+                SampleTextureCube(texture, a[l], b[l], c[l], rgba);
+                d[l] = rgba[0];
+                d[SHADER_LANES + l] = rgba[1];
+                d[SHADER_LANES * 2 + l] = rgba[2];
+                d[SHADER_LANES * 3 + l] = rgba[3];
+            }
+            break;
+        }
+        }
+    }
+}
+
+static void Broadcast(float* reg, float value)
+{
+    FOR_LANES(reg[l] = value);
+}
+
+//----------------------------------------------------------------------
+// interface
+//----------------------------------------------------------------------
+bool CompileShader(const EffectSource& effect, const Function& function, ShaderProgram* program,
+    const std::set<std::string>* baked)
+{
+    *program = ShaderProgram();
+    program->function = function.name;
+    program->registerCount = 0;
+    program->constantRegister = 0;
+
+    Compiler compiler;
+    compiler.effect = &effect;
+    compiler.tokens = &effect.tokens;
+    compiler.program = program;
+    compiler.baked = baked;
+    compiler.next = 0;
+    compiler.registerCount = 0;
+    compiler.statementMark = 0;
+    compiler.statementCode = 0;
+    compiler.at = 0;
+    compiler.end = 0;
+    compiler.failed = false;
+    compiler.returned = false;
+    compiler.PushScope();
+
+    // float4 name(...) : COLOR
+    const std::vector<Token>& t = effect.tokens;
+    if (!ParseType(function.returnType, &compiler.returnType))
+    {
+        compiler.returnType.rows = 1;
+        compiler.returnType.columns = 4;
+    }
+    size_t close = SkipBalanced(t, function.begin + 2, "(", ")");
+    if (close + 1 < function.bodyBegin && t[close].text == ":")
+    {
+        compiler.returnSemantic = t[close + 1].text;
+    }
+
+    DeclareInputs(compiler, function);
+    compiler.Statements(function.bodyBegin, function.bodyEnd);
+    if (!compiler.failed && !compiler.returned)
+    {
+        compiler.Fail(function.bodyEnd, "no return");
+    }
+    if (compiler.failed)
+    {
+        return false;
+    }
+
+    PropagateCopies(program);
+    CollectOutputRegisters(program);
+    RemoveDeadCode(program);
+    PlaceConstants(program, compiler.registerCount);
+    CollectOutputRegisters(program);
+
+    if (program->code.size() > 0xFFFF || program->registerCount > 0xFFFF)
+    {
+        program->error = "the shader is too long";
+        return false;
+    }
+    return true;
+}
+
+int GetShaderOpSources(int op)
+{
+    return gOpSources[op];
+}
+
+std::string DisassembleShader(const ShaderProgram& program)
+{
+    std::string text;
+    char line[256];
+
+    for (size_t i = 0; i < program.code.size(); ++i)
+    {
+        const ShaderInstruction& instruction = program.code[i];
+        int reads[3] = { instruction.a, instruction.b, instruction.c };
+
+        if (instruction.op == SHADER_OP_SKIP)
+        {
+            _snprintf(line, sizeof(line), "%4d  skip to %d if r%d is 0\n", (int)i, instruction.dst, instruction.a);
+            text += line;
+            continue;
+        }
+
+        int length = _snprintf(line, sizeof(line), "%4d  %-7s r%d", (int)i, gOpNames[instruction.op], instruction.dst);
+        if (instruction.op == SHADER_OP_TEX2D || instruction.op == SHADER_OP_TEXCUBE)
+        {
+            length += _snprintf(line + length, sizeof(line) - length, "-%d, s%d", instruction.dst + 3,
+                instruction.sampler);
+        }
+        for (int s = 0; s < gOpSources[instruction.op]; ++s)
+        {
+            if (reads[s] >= program.constantRegister)
+            {
+                length += _snprintf(line + length, sizeof(line) - length, ", %g",
+                    program.constants[reads[s] - program.constantRegister]);
+            }
+            else
+            {
+                length += _snprintf(line + length, sizeof(line) - length, ", r%d", reads[s]);
+            }
+        }
+        text += line;
+        text += "\n";
+    }
+
+    return text;
+}
+
+bool CreateShaderContext(const ShaderProgram& program, ShaderContext* context)
+{
+    size_t bytes = (size_t)program.registerCount * SHADER_LANES * sizeof(float);
+
+    context->program = &program;
+    context->allocation = malloc(bytes + 64);
+    if (!context->allocation)
+    {
+        context->registers = NULL;
+        return false;
+    }
+    context->registers = (float*)(((size_t)context->allocation + 63) & ~(size_t)63);
+    memset(context->registers, 0, bytes);
+    for (int i = 0; i < SHADER_MAX_SAMPLERS; ++i)
+    {
+        context->textures[i] = NULL;
+    }
+
+    for (size_t i = 0; i < program.constants.size(); ++i)
+    {
+        Broadcast(context->registers + (program.constantRegister + i) * SHADER_LANES, program.constants[i]);
+    }
+    for (size_t i = 0; i < program.uniforms.size(); ++i)
+    {
+        const ShaderVariable& uniform = program.uniforms[i];
+        SetShaderUniform(context, uniform.name.c_str(), &uniform.values[0], (int)uniform.values.size());
+    }
+    return true;
+}
+
+void ReleaseShaderContext(ShaderContext* context)
+{
+    free(context->allocation);
+    context->allocation = NULL;
+    context->registers = NULL;
+}
+
+bool SetShaderUniform(ShaderContext* context, const char* name, const float* values, int count)
+{
+    const ShaderProgram& program = *context->program;
+    for (size_t i = 0; i < program.uniforms.size(); ++i)
+    {
+        const ShaderVariable& uniform = program.uniforms[i];
+        if (uniform.name != name)
+        {
+            continue;
+        }
+
+        for (size_t r = 0; r < uniform.registers.size() && (int)r < count; ++r)
+        {
+            Broadcast(context->registers + uniform.registers[r] * SHADER_LANES, values[r]);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool SetShaderTexture(ShaderContext* context, const char* sampler, const ShaderTexture* texture)
+{
+    const ShaderProgram& program = *context->program;
+    for (size_t i = 0; i < program.samplers.size(); ++i)
+    {
+        if (program.samplers[i].name == sampler)
+        {
+            context->textures[i] = texture;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RunShader(ShaderContext* context, const float* inputs, float* outputs, int count)
+{
+    const ShaderProgram& program = *context->program;
+    float* r = context->registers;
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        // a last, partial batch repeats its last item in the spare lanes
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+
+        for (size_t i = 0; i < program.inputRegisters.size(); ++i)
+        {
+            float* reg = r + program.inputRegisters[i] * SHADER_LANES;
+            const float* source = inputs + i * count + base;
+            for (int l = 0; l < SHADER_LANES; ++l)
+            {
+                reg[l] = source[(l < lanes) ? l : lanes - 1];
+            }
+        }
+
+        if (!program.code.empty())
+        {
+            Execute(program, context);
+        }
+
+        for (size_t i = 0; i < program.outputRegisters.size(); ++i)
+        {
+            const float* reg = r + program.outputRegisters[i] * SHADER_LANES;
+            float* dest = outputs + i * count + base;
+            for (int l = 0; l < lanes; ++l)
+            {
+                dest[l] = reg[l];
+            }
+        }
+    }
+}
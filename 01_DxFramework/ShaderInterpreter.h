@@ -0,0 +1,188 @@
+//**********************************************************************
+//
+// ShaderInterpreter.h
+//
+// Runs the vertex and pixel shaders of the samples' effects on the CPU.
+// A shader function is compiled from its HLSL (see EffectSource.h) into
+// a bytecode of scalar operations on numbered registers; every register
+// holds one float for each of SHADER_LANES vertices or pixels, so one
+// instruction does the same step for all of them at once.
+//
+// The compiler takes the subset of HLSL the samples use: the float and
+// matrix types, structs for inputs and outputs, the usual intrinsics,
+// tex2D and texCUBE. Loops need bounds known when compiling and are
+// unrolled, as ps_2_0 would; an if runs both ways for the lanes that
+// take it, and is jumped over when none does.
+//
+// Constants are folded and the instructions whose results are never
+// read are dropped, so the bytecode is roughly what fxc would emit.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include "EffectSource.h"
+
+// ---------- constants ------------------------------------
+
+// vertices or pixels run by one instruction
+#define SHADER_LANES            16
+
+#define SHADER_MAX_SAMPLERS     16
+
+// ---------- types ------------------------------------
+
+enum ShaderOp
+{
+    SHADER_OP_MOV,
+    SHADER_OP_ADD,
+    SHADER_OP_SUB,
+    SHADER_OP_MUL,
+    SHADER_OP_DIV,
+    SHADER_OP_MAD,              // a * b + c
+    SHADER_OP_MIN,
+    SHADER_OP_MAX,
+    SHADER_OP_NEG,
+    SHADER_OP_ABS,
+    SHADER_OP_SAT,
+    SHADER_OP_FLOOR,
+    SHADER_OP_CEIL,
+    SHADER_OP_FRAC,
+    SHADER_OP_SQRT,
+    SHADER_OP_RSQ,
+    SHADER_OP_RCP,
+    SHADER_OP_EXP,
+    SHADER_OP_LOG,
+    SHADER_OP_POW,
+    SHADER_OP_SIN,
+    SHADER_OP_COS,
+    SHADER_OP_LT,               // 1 or 0
+    SHADER_OP_LE,
+    SHADER_OP_EQ,
+    SHADER_OP_NE,
+    SHADER_OP_AND,
+    SHADER_OP_OR,
+    SHADER_OP_NOT,
+    SHADER_OP_SEL,              // a != 0 ? b : c
+    SHADER_OP_TEX2D,            // dst..dst+3 from sampler at (a, b)
+    SHADER_OP_TEXCUBE,          // dst..dst+3 from sampler at (a, b, c)
+    SHADER_OP_SKIP,             // to instruction dst if a is 0 in every lane
+    SHADER_OP_COUNT
+};
+
+struct ShaderInstruction
+{
+    unsigned char op;
+    unsigned char sampler;
+    unsigned short dst;
+    unsigned short a;
+    unsigned short b;
+    unsigned short c;
+};
+
+// an input, output or uniform of a shader
+struct ShaderVariable
+{
+    std::string name;           // struct member or global
+    std::string semantic;
+    int rows;
+    int columns;
+    std::vector<int> registers; // rows * columns, row by row
+    std::vector<float> values;  // initial value of a uniform
+};
+
+struct ShaderSampler
+{
+    std::string name;
+    std::string texture;        // from Texture = (...) in its sampler_state
+    bool cube;
+};
+
+struct ShaderProgram
+{
+    std::string function;
+    std::vector<ShaderInstruction> code;
+    int registerCount;
+    int constantRegister;       // the constants are registers from here on
+    std::vector<float> constants;
+    std::vector<ShaderVariable> uniforms;
+    std::vector<ShaderVariable> inputs;
+    std::vector<ShaderVariable> outputs;
+    std::vector<ShaderSampler> samplers;
+    std::vector<int> inputRegisters;    // every input component in order
+    std::vector<int> outputRegisters;   // every output component in order
+    std::string error;          // why CompileShader failed
+};
+
+// RGBA texels as floats, rows top first; a cube has six faces of
+// width x height one after another, in D3DCUBEMAP_FACES order
+struct ShaderTexture
+{
+    int width;
+    int height;
+    bool cube;
+    const float* texels;
+};
+
+// the registers one thread runs a program in
+struct ShaderContext
+{
+    const ShaderProgram* program;
+    float* registers;           // registerCount * SHADER_LANES
+    void* allocation;
+    const ShaderTexture* textures[SHADER_MAX_SAMPLERS];
+};
+
+// a shader translated to C++ ahead of time by the FxKernel tool. Its
+// uniforms are the values of the named ones one after another, its
+// textures one per named sampler, and inputs and outputs are as for
+// RunShader.
+typedef void (*ShaderKernelFunction)(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count);
+
+struct ShaderKernel
+{
+    const char* effect;                 // sample folder and file, e.g. 11_ColorConversion/Sepia.fx
+    const char* function;
+    const char* const* uniforms;        // NULL terminated
+    const char* const* samplers;        // NULL terminated
+    int inputCount;                     // components
+    int outputCount;
+    ShaderKernelFunction run;
+};
+
+// ---------------- function prototype  ------------------------
+
+// compiles function of effect; on failure program->error says why. the
+// globals named in baked are compiled in with their initial values
+// instead of being uniforms.
+bool CompileShader(const EffectSource& effect, const Function& function, ShaderProgram* program,
+    const std::set<std::string>* baked = NULL);
+
+// how many of a, b and c op reads
+int GetShaderOpSources(int op);
+
+// readable listing of the bytecode
+std::string DisassembleShader(const ShaderProgram& program);
+
+// a context with the constants and the uniforms' initial values loaded
+bool CreateShaderContext(const ShaderProgram& program, ShaderContext* context);
+
+void ReleaseShaderContext(ShaderContext* context);
+
+// values are row by row, as a D3DXMATRIX; false if the shader has no
+// such uniform
+bool SetShaderUniform(ShaderContext* context, const char* name, const float* values, int count);
+
+bool SetShaderTexture(ShaderContext* context, const char* sampler, const ShaderTexture* texture);
+
+// what tex2D, wrapping, and texCUBE sample in the shaders; bilinear
+void SampleTexture2D(const ShaderTexture* texture, float u, float v, float* rgba);
+
+void SampleTextureCube(const ShaderTexture* texture, float x, float y, float z, float* rgba);
+
+// runs the shader for count vertices or pixels. inputs and outputs are
+// one row of count floats for every component of inputRegisters and
+// outputRegisters.
+void RunShader(ShaderContext* context, const float* inputs, float* outputs, int count);
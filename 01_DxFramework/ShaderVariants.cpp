@@ -0,0 +1,428 @@
+//**********************************************************************
+//
+// ShaderVariants.cpp
+//
+// Effects compiled once per combination of feature toggles. The
+// compiler thread only runs fxc (D3DXCreateEffectCompilerFromFile),
+// which needs no device; the effect is created from the compiled
+// buffer on the main thread, so the device does not have to be
+// D3DCREATE_MULTITHREADED.
+//
+//**********************************************************************
+
+#include "ShaderVariants.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// only the main thread changes it; the compiler thread hands a variant
+// back through gCompiled
+enum VariantState
+{
+    VARIANT_QUEUED,             // or compiling, or compiled but not created
+    VARIANT_BUILT,
+    VARIANT_FAILED
+};
+
+struct VariantEffect;
+
+struct Variant
+{
+    const VariantEffect* effect;
+    int values[SHADER_VARIANT_MAX_FEATURES];
+    std::string name;           // file and defines, for messages
+    VariantState state;
+    LPD3DXBUFFER compiled;
+    LPD3DXEFFECT d3dEffect;
+    double compileMs;
+};
+
+// an effect file and the variants of it built or asked for
+struct VariantEffect
+{
+    std::string filename;
+    std::vector<std::string> features;
+    std::vector<int> numValues;
+    std::map<int, Variant*> variants;   // by the values as one number
+};
+
+static LPDIRECT3DDEVICE9 gpDevice = NULL;
+static std::vector<VariantEffect*> gEffects;
+
+static std::thread gCompiler;
+static std::mutex gLock;
+static std::condition_variable gWorkAvailable;
+static std::condition_variable gWorkFinished;
+static std::deque<Variant*> gQueued;
+static std::vector<Variant*> gCompiled;     // waiting for PumpShaderVariants
+static bool gQuit = false;
+
+
+static double GetMs(const LARGE_INTEGER& from, const LARGE_INTEGER& to)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    return (to.QuadPart - from.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+static DWORD GetShaderFlags()
+{
+    DWORD flags = 0;
+#if _DEBUG
+    flags |= D3DXSHADER_DEBUG;
+#endif
+    return flags;
+}
+
+static void PrintErrors(const char* what, const std::string& name, LPD3DXBUFFER errors)
+{
+    char str[512];
+    _snprintf(str, sizeof(str) - 1, "shader variants: failed at %s %s\n", what, name.c_str());
+    str[sizeof(str) - 1] = '\0';
+    OutputDebugString(str);
+
+    if (errors)
+    {
+        OutputDebugString((const char*)errors->GetBufferPointer());
+        errors->Release();
+    }
+}
+
+//----------------------------------------------------------------------
+// compiler thread
+//----------------------------------------------------------------------
+
+// runs fxc with the variant's defines; variant->compiled is NULL if it failed
+static void CompileVariant(Variant* variant)
+{
+    const VariantEffect* effect = variant->effect;
+
+    char values[SHADER_VARIANT_MAX_FEATURES][16];
+    D3DXMACRO macros[SHADER_VARIANT_MAX_FEATURES + 1];
+    for (size_t i = 0; i < effect->features.size(); ++i)
+    {
+        sprintf(values[i], "%d", variant->values[i]);
+        macros[i].Name = effect->features[i].c_str();
+        macros[i].Definition = values[i];
+    }
+    macros[effect->features.size()].Name = NULL;
+    macros[effect->features.size()].Definition = NULL;
+
+    LARGE_INTEGER start, end;
+    QueryPerformanceCounter(&start);
+
+    LPD3DXEFFECTCOMPILER compiler = NULL;
+    LPD3DXBUFFER errors = NULL;
+    variant->compiled = NULL;
+    if (SUCCEEDED(D3DXCreateEffectCompilerFromFile(effect->filename.c_str(), macros, NULL,
+        GetShaderFlags(), &compiler, &errors)))
+    {
+        compiler->CompileEffect(GetShaderFlags(), &variant->compiled, &errors);
+        compiler->Release();
+    }
+
+    QueryPerformanceCounter(&end);
+    variant->compileMs = GetMs(start, end);
+
+    if (!variant->compiled)
+    {
+        PrintErrors("compiling", variant->name, errors);
+    }
+    else if (errors)
+    {
+        errors->Release();      // warnings
+    }
+}
+
+static void CompilerMain()
+{
+    for (;;)
+    {
+        Variant* variant = NULL;
+        {
+            std::unique_lock<std::mutex> lock(gLock);
+            while (!gQuit && gQueued.empty())
+            {
+                gWorkAvailable.wait(lock);
+            }
+
+            if (gQuit)
+            {
+                return;
+            }
+
+            variant = gQueued.front();
+            gQueued.pop_front();
+        }
+
+        CompileVariant(variant);
+
+        {
+            std::lock_guard<std::mutex> lock(gLock);
+            gCompiled.push_back(variant);
+        }
+        gWorkFinished.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------
+// variants
+//----------------------------------------------------------------------
+
+bool InitShaderVariants(LPDIRECT3DDEVICE9 device)
+{
+    gpDevice = device;
+    gQuit = false;
+    gCompiler = std::thread(CompilerMain);
+    return true;
+}
+
+int AddShaderVariants(const char* filename, const ShaderFeature* features, int numFeatures)
+{
+    if (numFeatures < 0 || numFeatures > SHADER_VARIANT_MAX_FEATURES)
+    {
+        return -1;
+    }
+
+    VariantEffect* effect = new VariantEffect;
+    effect->filename = filename;
+    for (int i = 0; i < numFeatures; ++i)
+    {
+        effect->features.push_back(features[i].name);
+        effect->numValues.push_back(features[i].numValues);
+    }
+
+    gEffects.push_back(effect);
+    return (int)gEffects.size() - 1;
+}
+
+// the variant of effect with values, queued if it is new; NULL if the
+// values are out of range
+static Variant* RequestVariant(int effectIndex, const int* values, bool urgent)
+{
+    if (effectIndex < 0 || effectIndex >= (int)gEffects.size())
+    {
+        return NULL;
+    }
+
+    VariantEffect* effect = gEffects[effectIndex];
+    int key = 0;
+    for (size_t i = 0; i < effect->features.size(); ++i)
+    {
+        if (values[i] < 0 || values[i] >= effect->numValues[i])
+        {
+            return NULL;
+        }
+        key = key * effect->numValues[i] + values[i];
+    }
+
+    std::map<int, Variant*>::iterator found = effect->variants.find(key);
+    if (found != effect->variants.end())
+    {
+        // an urgent variant still queued goes ahead of the others
+        if (urgent && found->second->state == VARIANT_QUEUED)
+        {
+            std::lock_guard<std::mutex> lock(gLock);
+            std::deque<Variant*>::iterator queued = std::find(gQueued.begin(), gQueued.end(), found->second);
+            if (queued != gQueued.end())
+            {
+                gQueued.erase(queued);
+                gQueued.push_front(found->second);
+            }
+        }
+        return found->second;
+    }
+
+    Variant* variant = new Variant;
+    ZeroMemory(variant->values, sizeof(variant->values));
+    variant->effect = effect;
+    variant->name = effect->filename;
+    for (size_t i = 0; i < effect->features.size(); ++i)
+    {
+        char value[32];
+        sprintf(value, "=%d", values[i]);
+        variant->name += " " + effect->features[i] + value;
+        variant->values[i] = values[i];
+    }
+    variant->state = VARIANT_QUEUED;
+    variant->compiled = NULL;
+    variant->d3dEffect = NULL;
+    variant->compileMs = 0.0;
+    effect->variants[key] = variant;
+
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+        if (urgent)
+        {
+            gQueued.push_front(variant);
+        }
+        else
+        {
+            gQueued.push_back(variant);
+        }
+    }
+    gWorkAvailable.notify_one();
+    return variant;
+}
+
+LPD3DXEFFECT GetShaderVariant(int effect, const int* values)
+{
+    Variant* variant = RequestVariant(effect, values, false);
+    return (variant && variant->state == VARIANT_BUILT) ? variant->d3dEffect : NULL;
+}
+
+LPD3DXEFFECT LoadShaderVariant(int effect, const int* values)
+{
+    Variant* variant = RequestVariant(effect, values, true);
+    if (!variant)
+    {
+        return NULL;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(gLock);
+        while (variant->state == VARIANT_QUEUED &&
+            std::find(gCompiled.begin(), gCompiled.end(), variant) == gCompiled.end())
+        {
+            gWorkFinished.wait(lock);
+        }
+    }
+
+    PumpShaderVariants();
+    return (variant->state == VARIANT_BUILT) ? variant->d3dEffect : NULL;
+}
+
+void PumpShaderVariants()
+{
+    std::vector<Variant*> compiled;
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+        compiled.swap(gCompiled);
+    }
+
+    for (size_t i = 0; i < compiled.size(); ++i)
+    {
+        Variant* variant = compiled[i];
+        if (!variant->compiled)
+        {
+            variant->state = VARIANT_FAILED;
+            continue;
+        }
+
+        LARGE_INTEGER start, end;
+        QueryPerformanceCounter(&start);
+
+        LPD3DXBUFFER errors = NULL;
+        D3DXCreateEffect(gpDevice, variant->compiled->GetBufferPointer(), variant->compiled->GetBufferSize(),
+            NULL, NULL, GetShaderFlags(), NULL, &variant->d3dEffect, &errors);
+        variant->compiled->Release();
+        variant->compiled = NULL;
+
+        QueryPerformanceCounter(&end);
+        variant->compileMs += GetMs(start, end);
+
+        variant->state = variant->d3dEffect ? VARIANT_BUILT : VARIANT_FAILED;
+        if (!variant->d3dEffect)
+        {
+            PrintErrors("creating", variant->name, errors);
+            continue;
+        }
+        if (errors)
+        {
+            errors->Release();
+        }
+
+        char str[512];
+        _snprintf(str, sizeof(str) - 1, "shader variants: built %s in %.2f ms\n",
+            variant->name.c_str(), variant->compileMs);
+        str[sizeof(str) - 1] = '\0';
+        OutputDebugString(str);
+    }
+}
+
+ShaderVariantStats GetShaderVariantStats()
+{
+    ShaderVariantStats stats;
+    ZeroMemory(&stats, sizeof(stats));
+
+    for (size_t e = 0; e < gEffects.size(); ++e)
+    {
+        const VariantEffect* effect = gEffects[e];
+        int possible = 1;
+        for (size_t i = 0; i < effect->numValues.size(); ++i)
+        {
+            possible *= effect->numValues[i];
+        }
+        stats.numPossible += possible;
+
+        std::map<int, Variant*>::const_iterator it;
+        for (it = effect->variants.begin(); it != effect->variants.end(); ++it)
+        {
+            const Variant* variant = it->second;
+            stats.numRequested++;
+            stats.numBuilt += (variant->state == VARIANT_BUILT) ? 1 : 0;
+            stats.numFailed += (variant->state == VARIANT_FAILED) ? 1 : 0;
+            if (variant->state == VARIANT_BUILT || variant->state == VARIANT_FAILED)
+            {
+                stats.compileMs += variant->compileMs;
+                stats.maxCompileMs = (variant->compileMs > stats.maxCompileMs) ? variant->compileMs : stats.maxCompileMs;
+            }
+        }
+    }
+    return stats;
+}
+
+void ReleaseShaderVariants()
+{
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+        gQuit = true;
+        gQueued.clear();
+    }
+    gWorkAvailable.notify_all();
+    if (gCompiler.joinable())
+    {
+        gCompiler.join();
+    }
+    gCompiled.clear();
+
+    ShaderVariantStats stats = GetShaderVariantStats();
+    if (stats.numRequested > 0)
+    {
+        char str[256];
+        sprintf(str, "shader variants: %d of %d possible requested, %d built, %d failed, "
+            "%.2f ms compiling (%.2f ms at most)\n", stats.numRequested, stats.numPossible,
+            stats.numBuilt, stats.numFailed, stats.compileMs, stats.maxCompileMs);
+        OutputDebugString(str);
+    }
+
+    for (size_t e = 0; e < gEffects.size(); ++e)
+    {
+        std::map<int, Variant*>::iterator it;
+        for (it = gEffects[e]->variants.begin(); it != gEffects[e]->variants.end(); ++it)
+        {
+            Variant* variant = it->second;
+            if (variant->compiled)
+            {
+                variant->compiled->Release();
+            }
+            if (variant->d3dEffect)
+            {
+                variant->d3dEffect->Release();
+            }
+            delete variant;
+        }
+        delete gEffects[e];
+    }
+    gEffects.clear();
+
+    gpDevice = NULL;
+}
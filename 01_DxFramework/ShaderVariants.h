@@ -0,0 +1,66 @@
+//**********************************************************************
+//
+// ShaderVariants.h
+//
+// Effects compiled once for each combination of feature toggles a scene
+// asks for. A toggle is a #define the .fx tests with #if, so a variant
+// carries only the code of the features it has on; shadows, PCF
+// filtering and the like cost nothing where they are off.
+//
+// A variant is built the first time it is asked for: fxc runs on a
+// background thread and the effect is created from its output between
+// frames, and until then the caller keeps drawing with what it had.
+// Built variants stay in a cache until ReleaseShaderVariants.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <d3dx9.h>
+
+// ---------- constants ------------------------------------
+
+#define SHADER_VARIANT_MAX_FEATURES     8
+
+// ---------- types ------------------------------------
+
+// a toggle; the .fx sees NAME defined to 0 .. numValues - 1
+struct ShaderFeature
+{
+    const char* name;
+    int numValues;
+};
+
+struct ShaderVariantStats
+{
+    int numPossible;            // every combination of every effect's features
+    int numRequested;           // asked for at least once
+    int numBuilt;
+    int numFailed;
+    double compileMs;           // compiling and creating the variants so far
+    double maxCompileMs;        // of one variant
+};
+
+// ---------------- function prototype  ------------------------
+
+// starts the compiler thread
+bool InitShaderVariants(LPDIRECT3DDEVICE9 device);
+
+// an effect file and its toggles; returns its index, or -1
+int AddShaderVariants(const char* filename, const ShaderFeature* features, int numFeatures);
+
+// the variant with values[i] for feature i, or NULL until it is built;
+// the first call queues it. the cache owns the effect.
+LPD3DXEFFECT GetShaderVariant(int effect, const int* values);
+
+// builds the variant now if it is not already; for the first frame
+LPD3DXEFFECT LoadShaderVariant(int effect, const int* values);
+
+// call between frames; creates the effects of the finished compiles
+void PumpShaderVariants();
+
+ShaderVariantStats GetShaderVariantStats();
+
+// writes the statistics, stops the thread and frees every variant
+void ReleaseShaderVariants();
@@ -0,0 +1,214 @@
+//**********************************************************************
+//
+// SimulationClock.cpp
+//
+// Fixed-timestep simulation clock shared by every sample. Update() runs
+// in steps of SIMULATION_TIMESTEP however fast frames are rendered, and
+// rendering interpolates between the last two steps, so animation speed
+// does not depend on the frame rate.
+//
+// The frame times driving the clock come from one of three sources:
+//
+//   real      the performance counter (default)
+//   fixed     exactly one step per frame (benchmarks, golden images)
+//   replay    the frame times of an earlier run, recorded with
+//
+//   BasicFramework.exe -record frames.txt
+//   BasicFramework.exe -replay frames.txt
+//
+// so a replayed run takes the same steps and renders the same frames.
+//
+//**********************************************************************
+
+#include "SimulationClock.h"
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+enum TimeSource
+{
+    TIME_SOURCE_REAL,
+    TIME_SOURCE_FIXED,
+    TIME_SOURCE_REPLAY
+};
+
+static TimeSource gTimeSource = TIME_SOURCE_REAL;
+
+// simulation state
+static long long gNumSteps = 0;
+static double gAccumulator = 0;
+
+// real time
+static LARGE_INTEGER gFrequency;
+static LARGE_INTEGER gLastCounter;
+
+// recording and replaying; frame times in seconds
+static char gRecordFile[MAX_PATH] = "";
+static std::vector<double> gFrameTimes;
+static size_t gReplayIndex = 0;
+
+
+//----------------------------------------------------------------------
+// time sources
+//----------------------------------------------------------------------
+
+// the file name following option on the command line, or false
+static bool FindFileOption(const char* cmdLine, const char* option, char* filename)
+{
+    const char* found = cmdLine ? strstr(cmdLine, option) : NULL;
+    if (!found)
+    {
+        return false;
+    }
+
+    char format[32];
+    _snprintf(format, sizeof(format), "%s %%%ds", option, MAX_PATH - 1);
+    return sscanf(found, format, filename) == 1;
+}
+
+static bool LoadFrameTimes(const char* filename)
+{
+    FILE* fp = fopen(filename, "r");
+    if (!fp)
+    {
+        return false;
+    }
+
+    double frameTime;
+    while (fscanf(fp, "%lf", &frameTime) == 1)
+    {
+        gFrameTimes.push_back(frameTime);
+    }
+    fclose(fp);
+
+    return true;
+}
+
+// seconds since the last frame, from the current time source
+static double GetFrameTime()
+{
+    if (gTimeSource == TIME_SOURCE_FIXED)
+    {
+        return SIMULATION_TIMESTEP;
+    }
+
+    if (gTimeSource == TIME_SOURCE_REPLAY)
+    {
+        if (gReplayIndex < gFrameTimes.size())
+        {
+            return gFrameTimes[gReplayIndex++];
+        }
+
+        // the recording ran out; carry on deterministically
+        OutputDebugString("simulation clock: end of replay, continuing with fixed steps\n");
+        gTimeSource = TIME_SOURCE_FIXED;
+        return SIMULATION_TIMESTEP;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    double frameTime = (now.QuadPart - gLastCounter.QuadPart) / (double)gFrequency.QuadPart;
+    gLastCounter = now;
+
+    frameTime = (frameTime > SIMULATION_MAX_FRAME_TIME) ? SIMULATION_MAX_FRAME_TIME : frameTime;
+
+    if (gRecordFile[0])
+    {
+        gFrameTimes.push_back(frameTime);
+    }
+
+    return frameTime;
+}
+
+//----------------------------------------------------------------------
+// clock
+//----------------------------------------------------------------------
+void InitSimulationClock(const char* cmdLine, bool fixedStep)
+{
+    gTimeSource = TIME_SOURCE_REAL;
+    gNumSteps = 0;
+    gAccumulator = 0;
+    gRecordFile[0] = '\0';
+    gFrameTimes.clear();
+    gReplayIndex = 0;
+
+    char filename[MAX_PATH];
+    if (fixedStep)
+    {
+        gTimeSource = TIME_SOURCE_FIXED;
+    }
+    else if (FindFileOption(cmdLine, "-replay", filename))
+    {
+        if (LoadFrameTimes(filename))
+        {
+            gTimeSource = TIME_SOURCE_REPLAY;
+        }
+        else
+        {
+            OutputDebugString("simulation clock: failed at loading the replay, using real time\n");
+        }
+    }
+    else if (FindFileOption(cmdLine, "-record", gRecordFile))
+    {
+        gFrameTimes.reserve(60 * 60);
+    }
+
+    QueryPerformanceFrequency(&gFrequency);
+    QueryPerformanceCounter(&gLastCounter);
+}
+
+int AdvanceSimulationClock()
+{
+    gAccumulator += GetFrameTime();
+
+    int numSteps = 0;
+    while (gAccumulator >= SIMULATION_TIMESTEP)
+    {
+        gAccumulator -= SIMULATION_TIMESTEP;
+        ++numSteps;
+    }
+
+    gNumSteps += numSteps;
+    return numSteps;
+}
+
+double GetSimulationTime()
+{
+    return gNumSteps * (double)SIMULATION_TIMESTEP;
+}
+
+float GetSimulationAlpha()
+{
+    return (float)(gAccumulator / SIMULATION_TIMESTEP);
+}
+
+float GetRenderTime()
+{
+    // the frame lies between the previous step and the latest one
+    return (float)(GetSimulationTime() + (GetSimulationAlpha() - 1.0f) * SIMULATION_TIMESTEP);
+}
+
+void ReleaseSimulationClock()
+{
+    if (!gRecordFile[0])
+    {
+        return;
+    }
+
+    FILE* fp = fopen(gRecordFile, "w");
+    if (!fp)
+    {
+        OutputDebugString("simulation clock: failed at writing the recording\n");
+        return;
+    }
+
+    // %.17g keeps every bit, so a replay takes exactly the same steps
+    for (size_t i = 0; i < gFrameTimes.size(); ++i)
+    {
+        fprintf(fp, "%.17g\n", gFrameTimes[i]);
+    }
+    fclose(fp);
+
+    gRecordFile[0] = '\0';
+}
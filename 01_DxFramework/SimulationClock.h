@@ -0,0 +1,53 @@
+//**********************************************************************
+//
+// SimulationClock.h
+//
+// Fixed-timestep simulation clock shared by every sample. Update() runs
+// in steps of SIMULATION_TIMESTEP however fast frames are rendered, and
+// rendering interpolates between the last two steps, so animation speed
+// does not depend on the frame rate.
+//
+// The frame times driving the clock come from one of three sources:
+//
+//   real      the performance counter (default)
+//   fixed     exactly one step per frame (benchmarks, golden images)
+//   replay    the frame times of an earlier run, recorded with
+//
+//   BasicFramework.exe -record frames.txt
+//   BasicFramework.exe -replay frames.txt
+//
+// so a replayed run takes the same steps and renders the same frames.
+//
+//**********************************************************************
+
+
+#pragma once
+
+// ---------- constants ------------------------------------
+
+// seconds per simulation step
+#define SIMULATION_TIMESTEP			(1.0f / 60.0f)
+
+// longer frames (a breakpoint, dragging the window) are cut to this,
+// so the simulation never has to catch up more than a few steps
+#define SIMULATION_MAX_FRAME_TIME	0.25
+
+// ---------------- function prototype  ------------------------
+
+// picks the time source; fixedStep forces one step per frame
+void InitSimulationClock(const char* cmdLine, bool fixedStep);
+
+// starts a frame. returns how many times Update() has to run.
+int AdvanceSimulationClock();
+
+// time of the latest step, in seconds
+double GetSimulationTime();
+
+// where the frame lies between the previous and the latest step, 0..1
+float GetSimulationAlpha();
+
+// simulation time to render the frame at, in seconds
+float GetRenderTime();
+
+// writes the recorded frame times
+void ReleaseSimulationClock();
@@ -0,0 +1,928 @@
+//**********************************************************************
+//
+// SoftwareBackend.cpp
+//
+// A render backend (see RenderBackend.h) that runs on the CPU alone, so
+// the samples can be drawn on build machines with no GPU. The shaders
+// run in the shader interpreter; triangles are clipped to the near
+// plane, culled and rasterized with D3D9's top-left rule and pixel
+// centres half a pixel in, and the pixels that pass the depth test are
+// shaded in batches.
+//
+// A draw is done when SubmitRenderDraw returns. The vertex shader runs
+// on the calling thread; the target is then split into bands of rows
+// that the job system (see JobSystem.h) rasterizes and shades in
+// parallel, every band with a pixel shader context of its own, so no
+// two threads ever write the same pixel and the image does not depend
+// on the number of threads.
+//
+//**********************************************************************
+
+#include "RenderBackend.h"
+#include "JobSystem.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+// bands of rows a target is split into for the job system
+#define SOFTWARE_BANDS              32
+
+// pixels shaded by one RunShader call
+#define SOFTWARE_PIXEL_BATCH        (SHADER_LANES * 8)
+
+// interpolated pixel shader input components
+#define SOFTWARE_MAX_VARYINGS       64
+
+// floats in every block of the uniform ring; a block never moves, so
+// what AllocateRenderUniforms handed out stays valid all frame
+#define SOFTWARE_UNIFORM_BLOCK      (64 * 1024)
+
+struct SoftwareMesh : RenderMesh
+{
+    std::vector<std::string> semantics;
+    std::vector<int> components;
+    std::vector<std::vector<float> > values;    // per attribute, components per vertex
+    std::vector<unsigned int> indices;
+
+    // the vertex shader inputs of every input layout drawn with so far,
+    // by the layout's signature; made at the first draw
+    std::map<std::string, std::vector<float> > inputs;
+};
+
+struct SoftwareTexture : RenderTexture
+{
+    std::vector<float> texels;  // RGBA
+    std::vector<float> depth;   // targets only
+    ShaderTexture shaderTexture;
+};
+
+// a uniform register and where its value is in the draw's uniforms
+struct UniformBinding
+{
+    int shaderRegister;
+    int offset;
+};
+
+struct SoftwarePipeline : RenderPipeline
+{
+    std::string inputSignature;         // semantics and sizes of the vertex shader's inputs
+    int positionOutput;                 // the vertex shader's POSITION among its output components
+    std::vector<int> varyings;          // for each pixel shader input component, the vertex shader
+                                        // output component it is, or -1
+    int colorOutput;                    // COLOR among the pixel shader's output components
+    std::vector<UniformBinding> vertexUniforms;
+    std::vector<UniformBinding> pixelUniforms;
+    std::vector<int> vertexSamplers;    // layout sampler of each of the program's
+    std::vector<int> pixelSamplers;
+    ShaderContext vertexContext;
+    ShaderContext pixelContexts[SOFTWARE_BANDS];
+};
+
+// a triangle ready to rasterize, in pixels
+struct SetupTriangle
+{
+    float x[3];
+    float y[3];
+    float z[3];
+    float invW[3];
+    float area;
+    int top;                    // rows it covers
+    int bottom;
+    int varyings;               // first of its 3 * numVaryings in gDraw.varyings
+};
+
+// what the band jobs of the draw being done read
+struct SoftwareDraw
+{
+    const SoftwarePipeline* pipeline;
+    const RenderDraw* draw;
+    const float* uniforms;
+    SoftwareTexture* target;
+    std::vector<SetupTriangle> triangles;
+    std::vector<float> varyings;
+    int numVaryings;
+    int bandHeight;
+    std::atomic<long long> pixels;
+};
+
+// a pixel waiting for the pixel shader
+struct QueuedPixel
+{
+    int x;
+    int y;
+    int triangle;
+    float b[3];                 // perspective-correct weights of the corners
+};
+
+struct ClearJob
+{
+    SoftwareTexture* target;
+    const float* color;
+    bool depth;
+    int bandHeight;
+};
+
+static const ShaderTexture* gpWhite = NULL;     // for samplers given no texture
+static float gWhiteTexel[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+static ShaderTexture gWhite;
+
+static SoftwareTexture* gpFrame = NULL;
+static SoftwareTexture* gpTarget = NULL;        // of the pass
+static std::vector<float*> gUniformBlocks;
+static int gUniformsUsed = 0;                   // in floats, across the blocks
+static RenderStats gStats;
+static SoftwareDraw gDraw;
+static std::vector<float> gVertexOutputs;
+
+
+//----------------------------------------------------------------------
+// resources
+//----------------------------------------------------------------------
+
+// TEXCOORD and TEXCOORD0 are the same
+static std::string NormalizeSemantic(const std::string& semantic)
+{
+    std::string normalized;
+    for (size_t i = 0; i < semantic.size(); ++i)
+    {
+        normalized += (char)toupper((unsigned char)semantic[i]);
+    }
+    if (!normalized.empty() && !isdigit((unsigned char)normalized[normalized.size() - 1]))
+    {
+        normalized += '0';
+    }
+    return normalized;
+}
+
+static RenderMesh* CreateMesh(const RenderMeshDesc& desc)
+{
+    SoftwareMesh* mesh = new SoftwareMesh;
+    mesh->numVertices = desc.numVertices;
+    mesh->numIndices = desc.numIndices;
+    mesh->indices.assign(desc.indices, desc.indices + desc.numIndices);
+    for (int i = 0; i < desc.numAttributes; ++i)
+    {
+        const RenderAttribute& attribute = desc.attributes[i];
+        mesh->semantics.push_back(NormalizeSemantic(attribute.semantic));
+        mesh->components.push_back(attribute.components);
+        mesh->values.push_back(std::vector<float>(attribute.values, attribute.values + attribute.components * desc.numVertices));
+    }
+    return mesh;
+}
+
+static SoftwareTexture* NewTexture(int width, int height, bool cube, bool target, RenderFormat format)
+{
+    SoftwareTexture* texture = new SoftwareTexture;
+    texture->width = width;
+    texture->height = height;
+    texture->cube = cube;
+    texture->target = target;
+    texture->format = format;
+    texture->texels.resize((size_t)width * height * (cube ? 6 : 1) * 4, 0.0f);
+    if (target)
+    {
+        texture->depth.resize((size_t)width * height, 1.0f);
+    }
+
+    texture->shaderTexture.width = width;
+    texture->shaderTexture.height = height;
+    texture->shaderTexture.cube = cube;
+    texture->shaderTexture.texels = &texture->texels[0];
+    return texture;
+}
+
+static RenderTexture* CreateTexture(int width, int height, bool cube, const unsigned char* rgba)
+{
+    SoftwareTexture* texture = NewTexture(width, height, cube, false, RENDER_FORMAT_RGBA8);
+    for (size_t i = 0; i < texture->texels.size(); ++i)
+    {
+        texture->texels[i] = rgba[i] * (1.0f / 255.0f);
+    }
+    return texture;
+}
+
+static RenderTexture* CreateTarget(int width, int height, RenderFormat format)
+{
+    return NewTexture(width, height, false, true, format);
+}
+
+static void ReleaseMesh(RenderMesh* mesh)
+{
+    delete (SoftwareMesh*)mesh;
+}
+
+static void ReleaseTexture(RenderTexture* texture)
+{
+    delete (SoftwareTexture*)texture;
+}
+
+// the vertex shader inputs of mesh for pipeline, one row of the mesh's
+// vertices per component; what the mesh lacks is D3D9's (0, 0, 0, 1)
+static const float* GetVertexInputs(SoftwareMesh* mesh, const SoftwarePipeline* pipeline)
+{
+    std::vector<float>& inputs = mesh->inputs[pipeline->inputSignature];
+    if (!inputs.empty() || pipeline->vertexShader.inputRegisters.empty())
+    {
+        return inputs.empty() ? NULL : &inputs[0];
+    }
+
+    int numVertices = mesh->numVertices;
+    inputs.resize(pipeline->vertexShader.inputRegisters.size() * numVertices);
+    float* row = &inputs[0];
+
+    const std::vector<ShaderVariable>& variables = pipeline->vertexShader.inputs;
+    for (size_t v = 0; v < variables.size(); ++v)
+    {
+        std::string semantic = NormalizeSemantic(variables[v].semantic);
+        int attribute = -1;
+        for (size_t a = 0; a < mesh->semantics.size(); ++a)
+        {
+            attribute = (mesh->semantics[a] == semantic) ? (int)a : attribute;
+        }
+
+        int components = variables[v].rows * variables[v].columns;
+        for (int c = 0; c < components; ++c, row += numVertices)
+        {
+            bool has = attribute >= 0 && c < mesh->components[attribute];
+            for (int i = 0; i < numVertices; ++i)
+            {
+                row[i] = has ? mesh->values[attribute][i * mesh->components[attribute] + c] : (c == 3) ? 1.0f : 0.0f;
+            }
+        }
+    }
+    return &inputs[0];
+}
+
+//----------------------------------------------------------------------
+// pipelines
+//----------------------------------------------------------------------
+
+// the first component of the variable with semantic among variables'
+// components, or -1
+static int FindComponent(const std::vector<ShaderVariable>& variables, const std::string& semantic)
+{
+    int component = 0;
+    for (size_t i = 0; i < variables.size(); ++i)
+    {
+        if (NormalizeSemantic(variables[i].semantic) == semantic)
+        {
+            return component;
+        }
+        component += variables[i].rows * variables[i].columns;
+    }
+    return -1;
+}
+
+static void BindUniforms(const ShaderProgram& program, const RenderLayout& layout, std::vector<UniformBinding>* bindings)
+{
+    for (size_t u = 0; u < program.uniforms.size(); ++u)
+    {
+        const ShaderVariable& variable = program.uniforms[u];
+        int offset = -1;
+        for (size_t i = 0; i < layout.uniforms.size(); ++i)
+        {
+            offset = (layout.uniforms[i].name == variable.name) ? layout.uniforms[i].offset : offset;
+        }
+
+        for (size_t r = 0; r < variable.registers.size(); ++r)
+        {
+            UniformBinding binding;
+            binding.shaderRegister = variable.registers[r];
+            binding.offset = offset + (int)r / variable.columns * 4 + (int)r % variable.columns;
+            bindings->push_back(binding);
+        }
+    }
+}
+
+static void BindSamplers(const ShaderProgram& program, const RenderLayout& layout, std::vector<int>* samplers)
+{
+    for (size_t s = 0; s < program.samplers.size(); ++s)
+    {
+        int index = -1;
+        for (size_t i = 0; i < layout.samplers.size(); ++i)
+        {
+            index = (layout.samplers[i].name == program.samplers[s].name) ? (int)i : index;
+        }
+        samplers->push_back(index);
+    }
+}
+
+static RenderPipeline* CreatePipeline(const RenderPipeline& compiled)
+{
+    SoftwarePipeline* pipeline = new SoftwarePipeline;
+    *(RenderPipeline*)pipeline = compiled;
+
+    const ShaderProgram& vs = pipeline->vertexShader;
+    const ShaderProgram& ps = pipeline->pixelShader;
+    for (size_t i = 0; i < vs.inputs.size(); ++i)
+    {
+        char size[16];
+        sprintf(size, "%d ", vs.inputs[i].rows * vs.inputs[i].columns);
+        pipeline->inputSignature += NormalizeSemantic(vs.inputs[i].semantic) + size;
+    }
+
+    pipeline->positionOutput = FindComponent(vs.outputs, "POSITION0");
+    pipeline->colorOutput = FindComponent(ps.outputs, "COLOR0");
+    for (size_t i = 0; i < ps.inputs.size(); ++i)
+    {
+        int from = FindComponent(vs.outputs, NormalizeSemantic(ps.inputs[i].semantic));
+        for (int c = 0; c < ps.inputs[i].rows * ps.inputs[i].columns; ++c)
+        {
+            pipeline->varyings.push_back(from >= 0 ? from + c : -1);
+        }
+    }
+
+    BindUniforms(vs, pipeline->layout, &pipeline->vertexUniforms);
+    BindUniforms(ps, pipeline->layout, &pipeline->pixelUniforms);
+    BindSamplers(vs, pipeline->layout, &pipeline->vertexSamplers);
+    BindSamplers(ps, pipeline->layout, &pipeline->pixelSamplers);
+
+    bool valid = pipeline->positionOutput >= 0 && pipeline->colorOutput >= 0 &&
+        pipeline->varyings.size() <= SOFTWARE_MAX_VARYINGS;
+    bool created = CreateShaderContext(vs, &pipeline->vertexContext);
+    for (int b = 0; b < SOFTWARE_BANDS; ++b)
+    {
+        created = CreateShaderContext(ps, &pipeline->pixelContexts[b]) && created;
+    }
+
+    if (!valid || !created)
+    {
+        ReleaseShaderContext(&pipeline->vertexContext);
+        for (int b = 0; b < SOFTWARE_BANDS; ++b)
+        {
+            ReleaseShaderContext(&pipeline->pixelContexts[b]);
+        }
+        delete pipeline;
+        return NULL;
+    }
+    return pipeline;
+}
+
+static void ReleasePipeline(RenderPipeline* pipeline)
+{
+    SoftwarePipeline* software = (SoftwarePipeline*)pipeline;
+    ReleaseShaderContext(&software->vertexContext);
+    for (int b = 0; b < SOFTWARE_BANDS; ++b)
+    {
+        ReleaseShaderContext(&software->pixelContexts[b]);
+    }
+    delete software;
+}
+
+// the draw's uniforms and textures into context
+static void LoadContext(ShaderContext* context, const std::vector<UniformBinding>& uniforms,
+    const std::vector<int>& samplers, const float* values, const RenderDraw& draw)
+{
+    for (size_t i = 0; i < uniforms.size(); ++i)
+    {
+        float* reg = context->registers + uniforms[i].shaderRegister * SHADER_LANES;
+        float value = values[uniforms[i].offset];
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            reg[l] = value;
+        }
+    }
+
+    for (size_t s = 0; s < samplers.size(); ++s)
+    {
+        const SoftwareTexture* texture = (samplers[s] >= 0) ? (const SoftwareTexture*)draw.textures[samplers[s]] : NULL;
+        context->textures[s] = texture ? &texture->shaderTexture : gpWhite;
+    }
+}
+
+//----------------------------------------------------------------------
+// rasterizing
+//----------------------------------------------------------------------
+
+// clip space position and varyings of a corner being clipped
+struct ClipVertex
+{
+    float position[4];
+    float varyings[SOFTWARE_MAX_VARYINGS];
+};
+
+static void LerpVertex(const ClipVertex& a, const ClipVertex& b, float t, int numVaryings, ClipVertex* result)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        result->position[i] = a.position[i] + (b.position[i] - a.position[i]) * t;
+    }
+    for (int i = 0; i < numVaryings; ++i)
+    {
+        result->varyings[i] = a.varyings[i] + (b.varyings[i] - a.varyings[i]) * t;
+    }
+}
+
+// adds the triangle a, b, c, already in front of the near plane, to
+// gDraw.triangles unless it is culled or off the target
+static void AddTriangle(const ClipVertex* corners[3], RenderCull cull, int numVaryings)
+{
+    const SoftwareTexture* target = gDraw.target;
+    SetupTriangle triangle;
+    for (int i = 0; i < 3; ++i)
+    {
+        const float* p = corners[i]->position;
+        float invW = 1.0f / p[3];
+        triangle.x[i] = (p[0] * invW * 0.5f + 0.5f) * target->width;
+        triangle.y[i] = (0.5f - p[1] * invW * 0.5f) * target->height;
+        triangle.z[i] = p[2] * invW;
+        triangle.invW[i] = invW;
+    }
+
+    // positive when clockwise on screen, which D3D9 calls front facing
+    triangle.area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+        (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+    if (triangle.area == 0.0f || (cull == RENDER_CULL_CCW && triangle.area < 0.0f) ||
+        (cull == RENDER_CULL_CW && triangle.area > 0.0f))
+    {
+        return;
+    }
+
+    float minY = triangle.y[0] < triangle.y[1] ? triangle.y[0] : triangle.y[1];
+    float maxY = triangle.y[0] > triangle.y[1] ? triangle.y[0] : triangle.y[1];
+    minY = (triangle.y[2] < minY) ? triangle.y[2] : minY;
+    maxY = (triangle.y[2] > maxY) ? triangle.y[2] : maxY;
+    triangle.top = (minY > 0.0f) ? (int)(minY - 0.5f) : 0;
+    triangle.bottom = (maxY < (float)target->height) ? (int)(maxY + 0.5f) + 1 : target->height;
+    if (triangle.top >= triangle.bottom)
+    {
+        return;
+    }
+
+    triangle.varyings = (int)gDraw.varyings.size();
+    for (int i = 0; i < 3; ++i)
+    {
+        gDraw.varyings.insert(gDraw.varyings.end(), corners[i]->varyings, corners[i]->varyings + numVaryings);
+    }
+    gDraw.triangles.push_back(triangle);
+}
+
+// clips a triangle to z >= 0 and sets up what is left of it
+static void SetupTriangles(const float* outputs, int numVertices, const unsigned int* indices, int numIndices)
+{
+    const SoftwarePipeline* pipeline = gDraw.pipeline;
+    int numVaryings = (int)pipeline->varyings.size();
+    RenderCull cull = pipeline->states.cull;
+
+    ClipVertex corners[3];
+    ClipVertex clipped[4];
+    for (int t = 0; t + 2 < numIndices; t += 3)
+    {
+        // D3D9's clip volume is -w <= x, y <= w, 0 <= z <= w
+        int outside[6] = { 0, 0, 0, 0, 0, 0 };
+        for (int i = 0; i < 3; ++i)
+        {
+            int vertex = indices[t + i];
+            for (int c = 0; c < 4; ++c)
+            {
+                corners[i].position[c] = outputs[(pipeline->positionOutput + c) * numVertices + vertex];
+            }
+            for (int v = 0; v < numVaryings; ++v)
+            {
+                int from = pipeline->varyings[v];
+                corners[i].varyings[v] = (from >= 0) ? outputs[from * numVertices + vertex] : 0.0f;
+            }
+
+            const float* p = corners[i].position;
+            outside[0] += (p[0] < -p[3]) ? 1 : 0;
+            outside[1] += (p[0] > p[3]) ? 1 : 0;
+            outside[2] += (p[1] < -p[3]) ? 1 : 0;
+            outside[3] += (p[1] > p[3]) ? 1 : 0;
+            outside[4] += (p[2] < 0.0f) ? 1 : 0;
+            outside[5] += (p[2] > p[3]) ? 1 : 0;
+        }
+
+        bool rejected = false;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            rejected = rejected || outside[plane] == 3;
+        }
+        if (rejected)
+        {
+            continue;
+        }
+
+        if (outside[4] == 0)
+        {
+            const ClipVertex* triangle[3] = { &corners[0], &corners[1], &corners[2] };
+            AddTriangle(triangle, cull, numVaryings);
+            continue;
+        }
+
+        // one or two corners behind the near plane leave a quad or a triangle
+        int count = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const ClipVertex& a = corners[i];
+            const ClipVertex& b = corners[(i + 1) % 3];
+            if (a.position[2] >= 0.0f)
+            {
+                clipped[count++] = a;
+            }
+            if ((a.position[2] >= 0.0f) != (b.position[2] >= 0.0f))
+            {
+                float t = a.position[2] / (a.position[2] - b.position[2]);
+                LerpVertex(a, b, t, numVaryings, &clipped[count++]);
+            }
+        }
+        for (int i = 1; i + 1 < count; ++i)
+        {
+            const ClipVertex* triangle[3] = { &clipped[0], &clipped[i], &clipped[i + 1] };
+            AddTriangle(triangle, cull, numVaryings);
+        }
+    }
+}
+
+// runs the pixel shader for the queued pixels and writes their colours
+static void ShadePixels(ShaderContext* context, const QueuedPixel* pixels, int count)
+{
+    int numVaryings = gDraw.numVaryings;
+    int numOutputs = (int)gDraw.pipeline->pixelShader.outputRegisters.size();
+    float inputs[SOFTWARE_MAX_VARYINGS * SOFTWARE_PIXEL_BATCH];
+    float outputs[8 * SOFTWARE_PIXEL_BATCH];
+    std::vector<float> spill;
+    float* out = outputs;
+    if (numOutputs > 8)
+    {
+        spill.resize(numOutputs * count);
+        out = &spill[0];
+    }
+
+    for (int p = 0; p < count; ++p)
+    {
+        const QueuedPixel& pixel = pixels[p];
+        const float* corners = &gDraw.varyings[gDraw.triangles[pixel.triangle].varyings];
+        for (int v = 0; v < numVaryings; ++v)
+        {
+            inputs[v * count + p] = pixel.b[0] * corners[v] + pixel.b[1] * corners[numVaryings + v] +
+                pixel.b[2] * corners[2 * numVaryings + v];
+        }
+    }
+
+    RunShader(context, inputs, out, count);
+
+    SoftwareTexture* target = gDraw.target;
+    const float* color = out + gDraw.pipeline->colorOutput * count;
+    for (int p = 0; p < count; ++p)
+    {
+        float* texel = &target->texels[((size_t)pixels[p].y * target->width + pixels[p].x) * 4];
+        if (target->format == RENDER_FORMAT_R32F)
+        {
+            // what a D3DFMT_R32F texture samples as
+            texel[0] = color[p];
+            texel[1] = texel[2] = texel[3] = 1.0f;
+            continue;
+        }
+
+        // as an 8 bit target would store it
+        for (int c = 0; c < 4; ++c)
+        {
+            float value = color[c * count + p];
+            value = (value < 0.0f) ? 0.0f : (value > 1.0f) ? 1.0f : value;
+            texel[c] = floorf(value * 255.0f + 0.5f) * (1.0f / 255.0f);
+        }
+    }
+}
+
+// the rows of band of every triangle
+static void RasterizeBand(void*, int begin, int end)
+{
+    const SoftwarePipeline* pipeline = gDraw.pipeline;
+    SoftwareTexture* target = gDraw.target;
+    bool depthTest = pipeline->states.depthTest;
+    bool depthWrite = pipeline->states.depthTest && pipeline->states.depthWrite;
+    long long shaded = 0;
+
+    for (int band = begin; band < end; ++band)
+    {
+        int bandTop = band * gDraw.bandHeight;
+        int bandBottom = (bandTop + gDraw.bandHeight < target->height) ? bandTop + gDraw.bandHeight : target->height;
+        if (bandTop >= bandBottom)
+        {
+            continue;
+        }
+
+        ShaderContext* context = (ShaderContext*)&pipeline->pixelContexts[band];
+        LoadContext(context, pipeline->pixelUniforms, pipeline->pixelSamplers, gDraw.uniforms, *gDraw.draw);
+
+        QueuedPixel queue[SOFTWARE_PIXEL_BATCH];
+        int queued = 0;
+        for (size_t t = 0; t < gDraw.triangles.size(); ++t)
+        {
+            const SetupTriangle& triangle = gDraw.triangles[t];
+            int top = (triangle.top > bandTop) ? triangle.top : bandTop;
+            int bottom = (triangle.bottom < bandBottom) ? triangle.bottom : bandBottom;
+            if (top >= bottom)
+            {
+                continue;
+            }
+
+            // counter-clockwise triangles swap two corners to be clockwise
+            int order[3] = { 0, 1, 2 };
+            float area = triangle.area;
+            if (area < 0.0f)
+            {
+                order[1] = 2;
+                order[2] = 1;
+                area = -area;
+            }
+            float invArea = 1.0f / area;
+
+            // edge e runs from corner e + 1 to corner e + 2, so it is
+            // zero at both and weighs corner e
+            float stepX[3], stepY[3], bias[3];
+            float left = (float)target->width;
+            float right = 0.0f;
+            for (int e = 0; e < 3; ++e)
+            {
+                int a = order[(e + 1) % 3];
+                int b = order[(e + 2) % 3];
+                float dx = triangle.x[b] - triangle.x[a];
+                float dy = triangle.y[b] - triangle.y[a];
+                stepX[e] = -dy;
+                stepY[e] = dx;
+                bias[e] = -(dx * triangle.y[a] - dy * triangle.x[a]);
+
+                // pixels on a top or left edge belong to the triangle
+                bool topLeft = (dy < 0.0f) || (dy == 0.0f && dx > 0.0f);
+                bias[e] -= topLeft ? 0.0f : 1e-7f * (fabsf(dx) + fabsf(dy));
+
+                left = (triangle.x[e] < left) ? triangle.x[e] : left;
+                right = (triangle.x[e] > right) ? triangle.x[e] : right;
+            }
+            int minX = (left > 0.0f) ? (int)(left - 0.5f) : 0;
+            int maxX = (right < (float)target->width) ? (int)(right + 0.5f) : target->width - 1;
+            minX = (minX < 0) ? 0 : minX;
+
+            for (int y = top; y < bottom; ++y)
+            {
+                float py = y + 0.5f;
+                float px = minX + 0.5f;
+                float edge[3];
+                for (int e = 0; e < 3; ++e)
+                {
+                    edge[e] = stepX[e] * px + stepY[e] * py + bias[e];
+                }
+
+                float* depthRow = &target->depth[(size_t)y * target->width];
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    if (edge[0] >= 0.0f && edge[1] >= 0.0f && edge[2] >= 0.0f)
+                    {
+                        float weight[3];
+                        weight[order[0]] = edge[0] * invArea;
+                        weight[order[1]] = edge[1] * invArea;
+                        weight[order[2]] = edge[2] * invArea;
+
+                        float z = weight[0] * triangle.z[0] + weight[1] * triangle.z[1] + weight[2] * triangle.z[2];
+                        if (!depthTest || z <= depthRow[x])
+                        {
+                            if (depthWrite)
+                            {
+                                depthRow[x] = z;
+                            }
+
+                            QueuedPixel& pixel = queue[queued++];
+                            pixel.x = x;
+                            pixel.y = y;
+                            pixel.triangle = (int)t;
+                            float q0 = weight[0] * triangle.invW[0];
+                            float q1 = weight[1] * triangle.invW[1];
+                            float q2 = weight[2] * triangle.invW[2];
+                            float invSum = 1.0f / (q0 + q1 + q2);
+                            pixel.b[0] = q0 * invSum;
+                            pixel.b[1] = q1 * invSum;
+                            pixel.b[2] = q2 * invSum;
+
+                            if (queued == SOFTWARE_PIXEL_BATCH)
+                            {
+                                ShadePixels(context, queue, queued);
+                                shaded += queued;
+                                queued = 0;
+                            }
+                        }
+                    }
+
+                    edge[0] += stepX[0];
+                    edge[1] += stepX[1];
+                    edge[2] += stepX[2];
+                }
+            }
+        }
+
+        if (queued > 0)
+        {
+            ShadePixels(context, queue, queued);
+            shaded += queued;
+        }
+    }
+
+    gDraw.pixels += shaded;
+}
+
+//----------------------------------------------------------------------
+// frames
+//----------------------------------------------------------------------
+
+static void ClearBand(void* data, int begin, int end)
+{
+    const ClearJob* job = (const ClearJob*)data;
+    SoftwareTexture* target = job->target;
+    for (int band = begin; band < end; ++band)
+    {
+        int top = band * job->bandHeight;
+        int bottom = (top + job->bandHeight < target->height) ? top + job->bandHeight : target->height;
+        for (int y = top; y < bottom; ++y)
+        {
+            if (job->color)
+            {
+                float* texel = &target->texels[(size_t)y * target->width * 4];
+                for (int x = 0; x < target->width; ++x, texel += 4)
+                {
+                    texel[0] = job->color[0];
+                    texel[1] = job->color[1];
+                    texel[2] = job->color[2];
+                    texel[3] = job->color[3];
+                }
+            }
+            if (job->depth)
+            {
+                float* depth = &target->depth[(size_t)y * target->width];
+                for (int x = 0; x < target->width; ++x)
+                {
+                    depth[x] = 1.0f;
+                }
+            }
+        }
+    }
+}
+
+static bool Init(int width, int height)
+{
+    gWhite.width = 1;
+    gWhite.height = 1;
+    gWhite.cube = false;
+    gWhite.texels = gWhiteTexel;
+    gpWhite = &gWhite;
+
+    gpFrame = NewTexture(width, height, false, true, RENDER_FORMAT_RGBA8);
+    gUniformsUsed = 0;
+    memset(&gStats, 0, sizeof(gStats));
+    return true;
+}
+
+static void Release()
+{
+    delete gpFrame;
+    gpFrame = NULL;
+    gpTarget = NULL;
+    for (size_t i = 0; i < gUniformBlocks.size(); ++i)
+    {
+        delete[] gUniformBlocks[i];
+    }
+    gUniformBlocks.clear();
+    gVertexOutputs.clear();
+}
+
+static void BeginFrame()
+{
+    gUniformsUsed = 0;
+    memset(&gStats, 0, sizeof(gStats));
+}
+
+// draws are done as they are submitted, so a frame's uniforms are free
+// again as soon as the next one begins
+static float* AllocateUniforms(int size, int* offset)
+{
+    if (size > SOFTWARE_UNIFORM_BLOCK)
+    {
+        return NULL;
+    }
+
+    int block = gUniformsUsed / SOFTWARE_UNIFORM_BLOCK;
+    if (gUniformsUsed % SOFTWARE_UNIFORM_BLOCK + size > SOFTWARE_UNIFORM_BLOCK)
+    {
+        ++block;
+        gUniformsUsed = block * SOFTWARE_UNIFORM_BLOCK;
+    }
+    if (block >= (int)gUniformBlocks.size())
+    {
+        gUniformBlocks.push_back(new float[SOFTWARE_UNIFORM_BLOCK]);
+    }
+
+    *offset = gUniformsUsed;
+    gUniformsUsed += size;
+    gStats.uniformBytes += size * sizeof(float);
+    return gUniformBlocks[block] + *offset % SOFTWARE_UNIFORM_BLOCK;
+}
+
+static void BeginPass(RenderTexture* target, const float* clearColor, bool clearDepth)
+{
+    gpTarget = target ? (SoftwareTexture*)target : gpFrame;
+    gStats.passes++;
+
+    if (clearColor || clearDepth)
+    {
+        ClearJob job;
+        job.target = gpTarget;
+        job.color = clearColor;
+        job.depth = clearDepth;
+        job.bandHeight = (gpTarget->height + SOFTWARE_BANDS - 1) / SOFTWARE_BANDS;
+        ParallelFor(0, SOFTWARE_BANDS, 1, ClearBand, &job);
+    }
+}
+
+static void Draw(const RenderDraw& draw)
+{
+    const SoftwarePipeline* pipeline = (const SoftwarePipeline*)draw.pipeline;
+    SoftwareMesh* mesh = (SoftwareMesh*)draw.mesh;
+    if (!gpTarget || !pipeline || !mesh)
+    {
+        return;
+    }
+
+    int block = draw.uniforms / SOFTWARE_UNIFORM_BLOCK;
+    const float* uniforms = (pipeline->layout.size > 0 && block < (int)gUniformBlocks.size()) ?
+        gUniformBlocks[block] + draw.uniforms % SOFTWARE_UNIFORM_BLOCK : NULL;
+    if (pipeline->layout.size > 0 && !uniforms)
+    {
+        return;
+    }
+
+    // every vertex of the mesh, on this thread
+    ShaderContext* vertexContext = (ShaderContext*)&pipeline->vertexContext;
+    LoadContext(vertexContext, pipeline->vertexUniforms, pipeline->vertexSamplers, uniforms, draw);
+    gVertexOutputs.resize(pipeline->vertexShader.outputRegisters.size() * mesh->numVertices);
+    RunShader(vertexContext, GetVertexInputs(mesh, pipeline), &gVertexOutputs[0], mesh->numVertices);
+
+    gDraw.pipeline = pipeline;
+    gDraw.draw = &draw;
+    gDraw.uniforms = uniforms;
+    gDraw.target = gpTarget;
+    gDraw.triangles.clear();
+    gDraw.varyings.clear();
+    gDraw.numVaryings = (int)pipeline->varyings.size();
+    gDraw.bandHeight = (gpTarget->height + SOFTWARE_BANDS - 1) / SOFTWARE_BANDS;
+    gDraw.pixels = 0;
+    SetupTriangles(&gVertexOutputs[0], mesh->numVertices, &mesh->indices[0], mesh->numIndices);
+
+    ParallelFor(0, SOFTWARE_BANDS, 1, RasterizeBand, NULL);
+
+    gStats.draws++;
+    gStats.triangles += mesh->numIndices / 3;
+    gStats.pixels += gDraw.pixels;
+}
+
+static void EndPass()
+{
+    gpTarget = NULL;
+}
+
+static void EndFrame()
+{
+}
+
+static bool ReadFrame(unsigned char* rgba)
+{
+    const std::vector<float>& texels = gpFrame->texels;
+    for (size_t i = 0; i < texels.size(); ++i)
+    {
+        float value = texels[i];
+        value = (value < 0.0f) ? 0.0f : (value > 1.0f) ? 1.0f : value;
+        rgba[i] = (unsigned char)(value * 255.0f + 0.5f);
+    }
+    return true;
+}
+
+static RenderStats GetStats()
+{
+    return gStats;
+}
+
+const RenderBackend* GetSoftwareRenderBackend()
+{
+    static const RenderBackend backend =
+    {
+        "software",
+        Init,
+        Release,
+        CreateMesh,
+        CreateTexture,
+        CreateTarget,
+        CreatePipeline,
+        ReleaseMesh,
+        ReleaseTexture,
+        ReleasePipeline,
+        BeginFrame,
+        AllocateUniforms,
+        BeginPass,
+        Draw,
+        EndPass,
+        EndFrame,
+        ReadFrame,
+        GetStats
+    };
+    return &backend;
+}
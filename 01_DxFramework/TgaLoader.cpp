@@ -0,0 +1,383 @@
+//**********************************************************************
+//
+// TgaLoader.cpp
+//
+// Native TGA loader (uncompressed and RLE, 8/24/32-bit).
+// Decodes straight into the caller's 32-bit BGRA buffer, e.g. the
+// locked level 0 of a D3DFMT_A8R8G8B8 texture.
+//
+//**********************************************************************
+
+#include "TgaLoader.h"
+#include "CpuFeatures.h"
+#include <string.h>
+
+#define TGA_HEADER_SIZE 18
+
+typedef void(*ExpandFunc)(const unsigned char* src, unsigned char* dst, int count);
+
+
+//----------------------------------------------------------------------
+// header
+//----------------------------------------------------------------------
+bool ReadTgaHeader(const unsigned char* file, size_t fileSize, TgaInfo* info)
+{
+    if (!file || fileSize < TGA_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    int idLength = file[0];
+    int colorMapType = file[1];
+    int imageType = file[2];
+    int bitsPerPixel = file[16];
+    int descriptor = file[17];
+
+    // color-mapped images are not used by any sample
+    if (colorMapType != 0)
+    {
+        return false;
+    }
+
+    switch (imageType)
+    {
+    case TGA_TYPE_TRUECOLOR:
+    case TGA_TYPE_RLE_TRUECOLOR:
+        if (bitsPerPixel != 24 && bitsPerPixel != 32)
+        {
+            return false;
+        }
+        break;
+    case TGA_TYPE_GRAYSCALE:
+    case TGA_TYPE_RLE_GRAYSCALE:
+        if (bitsPerPixel != 8)
+        {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    // right-to-left images are not supported
+    if (descriptor & 0x10)
+    {
+        return false;
+    }
+
+    info->width = file[12] | (file[13] << 8);
+    info->height = file[14] | (file[15] << 8);
+    info->bitsPerPixel = bitsPerPixel;
+    info->imageType = imageType;
+    info->topDown = (descriptor & 0x20) != 0;
+    info->dataOffset = TGA_HEADER_SIZE + idLength;
+
+    return info->width > 0 && info->height > 0 && info->dataOffset <= fileSize;
+}
+
+//----------------------------------------------------------------------
+// pixel expand kernels
+//----------------------------------------------------------------------
+
+// BGR -> BGRA with opaque alpha, one pixel at a time
+static void ExpandBgrScalar(const unsigned char* src, unsigned char* dst, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xFF;
+
+        src += 3;
+        dst += 4;
+    }
+}
+
+static void CopyBgra(const unsigned char* src, unsigned char* dst, int count)
+{
+    memcpy(dst, src, count * 4);
+}
+
+static void ExpandGray(const unsigned char* src, unsigned char* dst, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        dst[0] = dst[1] = dst[2] = src[i];
+        dst[3] = 0xFF;
+        dst += 4;
+    }
+}
+
+#if CPU_X86_SIMD
+
+// 16 pixels (48 bytes in, 64 bytes out) per iteration. the three input
+// loads are re-aligned so that every 16-byte lane holds 4 whole pixels,
+// then one pshufb spreads them out and an OR fills in alpha.
+CPU_TARGET("ssse3")
+static void ExpandBgrSsse3(const unsigned char* src, unsigned char* dst, int count)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128,
+                                          6, 7, 8, -128, 9, 10, 11, -128);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const unsigned char* s = src + i * 3;
+        __m128i* d = (__m128i*)(dst + i * 4);
+
+        __m128i a = _mm_loadu_si128((const __m128i*)s);
+        __m128i b = _mm_loadu_si128((const __m128i*)(s + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(s + 32));
+
+        __m128i p0 = a;
+        __m128i p1 = _mm_alignr_epi8(b, a, 12);
+        __m128i p2 = _mm_alignr_epi8(c, b, 8);
+        __m128i p3 = _mm_srli_si128(c, 4);
+
+        _mm_storeu_si128(d + 0, _mm_or_si128(_mm_shuffle_epi8(p0, shuffle), alpha));
+        _mm_storeu_si128(d + 1, _mm_or_si128(_mm_shuffle_epi8(p1, shuffle), alpha));
+        _mm_storeu_si128(d + 2, _mm_or_si128(_mm_shuffle_epi8(p2, shuffle), alpha));
+        _mm_storeu_si128(d + 3, _mm_or_si128(_mm_shuffle_epi8(p3, shuffle), alpha));
+    }
+
+    ExpandBgrScalar(src + i * 3, dst + i * 4, count - i);
+}
+
+// 8 pixels per iteration. vpermd moves pixels 0-3 into the low lane and
+// 4-7 into the high lane so the in-lane vpshufb can do the rest. the
+// 32-byte load reads 8 bytes past the last pixel, hence the loop bound.
+CPU_TARGET("avx2")
+static void ExpandBgrAvx2(const unsigned char* src, unsigned char* dst, int count)
+{
+    const __m256i permute = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128,
+                                             6, 7, 8, -128, 9, 10, 11, -128,
+                                             0, 1, 2, -128, 3, 4, 5, -128,
+                                             6, 7, 8, -128, 9, 10, 11, -128);
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+    int i = 0;
+    for (; i + 11 <= count; i += 8)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(src + i * 3));
+        in = _mm256_permutevar8x32_epi32(in, permute);
+        in = _mm256_shuffle_epi8(in, shuffle);
+        _mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_or_si256(in, alpha));
+    }
+
+    ExpandBgrSsse3(src + i * 3, dst + i * 4, count - i);
+}
+
+#endif // CPU_X86_SIMD
+
+TgaExpandKernel GetBestTgaExpandKernel()
+{
+    if (CpuHasAvx2())
+    {
+        return TGA_KERNEL_AVX2;
+    }
+
+    if (CpuHasSsse3())
+    {
+        return TGA_KERNEL_SSSE3;
+    }
+
+    return TGA_KERNEL_SCALAR;
+}
+
+static ExpandFunc GetExpandFunc(const TgaInfo& info, TgaExpandKernel kernel)
+{
+    if (info.bitsPerPixel == 8)
+    {
+        return ExpandGray;
+    }
+
+    if (info.bitsPerPixel == 32)
+    {
+        return CopyBgra;
+    }
+
+    if (kernel == TGA_KERNEL_AUTO)
+    {
+        kernel = GetBestTgaExpandKernel();
+    }
+
+#if CPU_X86_SIMD
+    // never run a kernel the CPU cannot execute, even if asked to
+    if (kernel > GetBestTgaExpandKernel())
+    {
+        kernel = GetBestTgaExpandKernel();
+    }
+
+    if (kernel == TGA_KERNEL_AVX2)
+    {
+        return ExpandBgrAvx2;
+    }
+
+    if (kernel == TGA_KERNEL_SSSE3)
+    {
+        return ExpandBgrSsse3;
+    }
+#endif
+
+    return ExpandBgrScalar;
+}
+
+//----------------------------------------------------------------------
+// decoding
+//----------------------------------------------------------------------
+
+// walks the destination in file order, flipping bottom-up images on the fly
+struct TgaCursor
+{
+    unsigned char* dest;
+    int pitch;
+    int width;
+    int height;
+    bool topDown;
+    int x;
+    int y;
+
+    unsigned char* Row() const
+    {
+        int row = topDown ? y : (height - 1 - y);
+        return dest + row * pitch;
+    }
+
+    // number of pixels left on the current row
+    int Remaining() const
+    {
+        return width - x;
+    }
+
+    void Advance(int count)
+    {
+        x += count;
+        if (x == width)
+        {
+            x = 0;
+            ++y;
+        }
+    }
+
+    bool Done() const
+    {
+        return y >= height;
+    }
+};
+
+static bool DecodeUncompressed(const unsigned char* src, const unsigned char* end,
+    const TgaInfo& info, TgaCursor& cursor, ExpandFunc expand)
+{
+    int bytesPerPixel = info.bitsPerPixel / 8;
+    size_t rowBytes = (size_t)info.width * bytesPerPixel;
+
+    if ((size_t)(end - src) < rowBytes * info.height)
+    {
+        return false;
+    }
+
+    for (; !cursor.Done(); cursor.Advance(info.width))
+    {
+        expand(src, cursor.Row(), info.width);
+        src += rowBytes;
+    }
+
+    return true;
+}
+
+static bool DecodeRle(const unsigned char* src, const unsigned char* end,
+    const TgaInfo& info, TgaCursor& cursor, ExpandFunc expand)
+{
+    int bytesPerPixel = info.bitsPerPixel / 8;
+
+    while (!cursor.Done())
+    {
+        if (src >= end)
+        {
+            return false;
+        }
+
+        unsigned char packet = *src++;
+        int count = (packet & 0x7F) + 1;
+
+        if (packet & 0x80)
+        {
+            // run-length packet: one pixel repeated
+            if (end - src < bytesPerPixel)
+            {
+                return false;
+            }
+
+            unsigned char pixel[4];
+            expand(src, pixel, 1);
+            src += bytesPerPixel;
+
+            unsigned int value;
+            memcpy(&value, pixel, 4);
+
+            // packets may cross scanlines
+            while (count > 0 && !cursor.Done())
+            {
+                int n = count < cursor.Remaining() ? count : cursor.Remaining();
+                unsigned int* dst = (unsigned int*)cursor.Row() + cursor.x;
+                for (int i = 0; i < n; ++i)
+                {
+                    dst[i] = value;
+                }
+                cursor.Advance(n);
+                count -= n;
+            }
+        }
+        else
+        {
+            // raw packet: count literal pixels
+            if (end - src < count * bytesPerPixel)
+            {
+                return false;
+            }
+
+            while (count > 0 && !cursor.Done())
+            {
+                int n = count < cursor.Remaining() ? count : cursor.Remaining();
+                expand(src, cursor.Row() + cursor.x * 4, n);
+                src += n * bytesPerPixel;
+                cursor.Advance(n);
+                count -= n;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool DecodeTga(const unsigned char* file, size_t fileSize, const TgaInfo& info,
+    unsigned char* dest, int destPitch, TgaExpandKernel kernel)
+{
+    if (!file || !dest || destPitch < info.width * 4)
+    {
+        return false;
+    }
+
+    TgaCursor cursor;
+    cursor.dest = dest;
+    cursor.pitch = destPitch;
+    cursor.width = info.width;
+    cursor.height = info.height;
+    cursor.topDown = info.topDown;
+    cursor.x = 0;
+    cursor.y = 0;
+
+    const unsigned char* src = file + info.dataOffset;
+    const unsigned char* end = file + fileSize;
+    ExpandFunc expand = GetExpandFunc(info, kernel);
+
+    if (info.imageType == TGA_TYPE_RLE_TRUECOLOR || info.imageType == TGA_TYPE_RLE_GRAYSCALE)
+    {
+        return DecodeRle(src, end, info, cursor, expand);
+    }
+
+    return DecodeUncompressed(src, end, info, cursor, expand);
+}
@@ -0,0 +1,53 @@
+//**********************************************************************
+//
+// TgaLoader.h
+//
+// Native TGA loader (uncompressed and RLE, 8/24/32-bit).
+// Decodes straight into the caller's 32-bit BGRA buffer, e.g. the
+// locked level 0 of a D3DFMT_A8R8G8B8 texture.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <stddef.h>
+
+// ---------- constants ------------------------------------
+#define TGA_TYPE_TRUECOLOR		2
+#define TGA_TYPE_GRAYSCALE		3
+#define TGA_TYPE_RLE_TRUECOLOR	10
+#define TGA_TYPE_RLE_GRAYSCALE	11
+
+// kernel used to expand 24-bit BGR pixels into 32-bit BGRA
+enum TgaExpandKernel
+{
+    TGA_KERNEL_SCALAR = 0,
+    TGA_KERNEL_SSSE3,
+    TGA_KERNEL_AVX2,
+    TGA_KERNEL_AUTO         // pick the best one the CPU supports
+};
+
+// ---------- types ------------------------------------
+struct TgaInfo
+{
+    int width;
+    int height;
+    int bitsPerPixel;       // 8, 24 or 32
+    int imageType;          // one of TGA_TYPE_*
+    bool topDown;           // true if the first pixel in the file is the top-left one
+    size_t dataOffset;      // offset of the pixel data from the start of the file
+};
+
+// ---------------- function prototype  ------------------------
+
+// parses the 18-byte header. fails on anything this loader cannot decode.
+bool ReadTgaHeader(const unsigned char* file, size_t fileSize, TgaInfo* info);
+
+// decodes the whole image into dest as 32-bit BGRA rows (top row first),
+// destPitch bytes apart.
+bool DecodeTga(const unsigned char* file, size_t fileSize, const TgaInfo& info,
+    unsigned char* dest, int destPitch, TgaExpandKernel kernel = TGA_KERNEL_AUTO);
+
+// best expand kernel available on this CPU
+TgaExpandKernel GetBestTgaExpandKernel();
@@ -0,0 +1,485 @@
+//**********************************************************************
+//
+// XMeshLoader.cpp
+//
+// A text .x file is objects of the form  Type [name] { data children }
+// where the data is numbers separated by ';' and ','. Templates are
+// skipped; every other object is read generically into its numbers and
+// the numbers of its children, and what a Mesh's numbers mean is only
+// looked at once the whole Mesh is read.
+//
+//**********************************************************************
+
+#include "XMeshLoader.h"
+#include "FileUtil.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+// D3DDECLTYPE and D3DDECLUSAGE values in a DeclData block
+#define X_DECLTYPE_FLOAT1       0
+#define X_DECLTYPE_FLOAT3       2
+#define X_DECLTYPE_FLOAT4       3
+#define X_DECLUSAGE_TANGENT     6
+#define X_DECLUSAGE_BINORMAL    7
+
+enum XTokenType
+{
+    X_TOKEN_END,
+    X_TOKEN_NUMBER,
+    X_TOKEN_NAME,
+    X_TOKEN_STRING,
+    X_TOKEN_OPEN,
+    X_TOKEN_CLOSE
+};
+
+struct XToken
+{
+    XTokenType type;
+    double number;
+    std::string name;
+};
+
+struct XReader
+{
+    const char* at;
+    const char* end;
+};
+
+// the objects in a Mesh or Frame, by type; only the first of each
+typedef std::map<std::string, std::vector<double> > XChildren;
+
+
+//----------------------------------------------------------------------
+// tokens
+//----------------------------------------------------------------------
+
+// ';' and ',' separate the data and are skipped, as are GUIDs
+static void NextToken(XReader* reader, XToken* token)
+{
+    const char* at = reader->at;
+    for (;;)
+    {
+        while (at < reader->end && (isspace((unsigned char)*at) || *at == ';' || *at == ','))
+        {
+            ++at;
+        }
+
+        if (at < reader->end && (*at == '#' || (*at == '/' && at + 1 < reader->end && at[1] == '/')))
+        {
+            while (at < reader->end && *at != '\n')
+            {
+                ++at;
+            }
+        }
+        else if (at < reader->end && *at == '<')
+        {
+            while (at < reader->end && *at != '>')
+            {
+                ++at;
+            }
+            at += (at < reader->end) ? 1 : 0;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    token->name.clear();
+    if (at >= reader->end)
+    {
+        token->type = X_TOKEN_END;
+    }
+    else if (*at == '{' || *at == '}')
+    {
+        token->type = (*at == '{') ? X_TOKEN_OPEN : X_TOKEN_CLOSE;
+        ++at;
+    }
+    else if (*at == '"')
+    {
+        token->type = X_TOKEN_STRING;
+        for (++at; at < reader->end && *at != '"'; ++at)
+        {
+        }
+        at += (at < reader->end) ? 1 : 0;
+    }
+    else if (isdigit((unsigned char)*at) || *at == '-' || *at == '+' || *at == '.')
+    {
+        // the file is read with a terminating zero, so strtod stops in it
+        char* numberEnd = NULL;
+        token->type = X_TOKEN_NUMBER;
+        token->number = strtod(at, &numberEnd);
+        at = (numberEnd > at) ? numberEnd : at + 1;
+    }
+    else
+    {
+        const char* begin = at;
+        while (at < reader->end && (isalnum((unsigned char)*at) || *at == '_' || *at == '-' || *at == '.'))
+        {
+            ++at;
+        }
+        at += (at == begin) ? 1 : 0;
+
+        token->type = X_TOKEN_NAME;
+        token->name.assign(begin, at);
+    }
+    reader->at = at;
+}
+
+// true if the next token is an object's '{', after its name if it has one
+static bool OpensObject(XReader* reader)
+{
+    XReader peek = *reader;
+    XToken token;
+    NextToken(&peek, &token);
+    if (token.type == X_TOKEN_NAME)
+    {
+        NextToken(&peek, &token);
+    }
+    if (token.type != X_TOKEN_OPEN)
+    {
+        return false;
+    }
+
+    *reader = peek;
+    return true;
+}
+
+// past the '}' that closes the object whose '{' was just read
+static bool SkipObject(XReader* reader)
+{
+    XToken token;
+    for (int depth = 1; depth > 0;)
+    {
+        NextToken(reader, &token);
+        if (token.type == X_TOKEN_END)
+        {
+            return false;
+        }
+        depth += (token.type == X_TOKEN_OPEN) ? 1 : (token.type == X_TOKEN_CLOSE) ? -1 : 0;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------
+// meshes
+//----------------------------------------------------------------------
+
+// a * b, both row by row as a D3DXMATRIX
+static void MultiplyMatrix(const float* a, const float* b, float* result)
+{
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            result[r * 4 + c] = a[r * 4 + 0] * b[0 * 4 + c] + a[r * 4 + 1] * b[1 * 4 + c] +
+                a[r * 4 + 2] * b[2 * 4 + c] + a[r * 4 + 3] * b[3 * 4 + c];
+        }
+    }
+}
+
+static void TransformVector(const float* matrix, const double* v, float w, std::vector<float>* dest)
+{
+    for (int c = 0; c < 3; ++c)
+    {
+        dest->push_back((float)(v[0] * matrix[c] + v[1] * matrix[4 + c] + v[2] * matrix[8 + c] + w * matrix[12 + c]));
+    }
+}
+
+// the corners of the faces in numbers from at on: a count, then that many
+// vertex indices per face. false if they run past the end.
+static bool ReadFaces(const std::vector<double>& numbers, size_t at, std::vector<int>* faceSizes, std::vector<int>* corners)
+{
+    if (at >= numbers.size())
+    {
+        return false;
+    }
+
+    int numFaces = (int)numbers[at++];
+    for (int f = 0; f < numFaces; ++f)
+    {
+        int size = (at < numbers.size()) ? (int)numbers[at++] : 0;
+        if (size < 3 || at + size > numbers.size())
+        {
+            return false;
+        }
+
+        faceSizes->push_back(size);
+        for (int i = 0; i < size; ++i)
+        {
+            corners->push_back((int)numbers[at++]);
+        }
+    }
+    return true;
+}
+
+// the float3 with usage of every vertex from a DeclData block, or false
+static bool ReadDeclData(const std::vector<double>& numbers, int numVertices, int usage, std::vector<double>* values)
+{
+    if (numbers.empty())
+    {
+        return false;
+    }
+
+    int numElements = (int)numbers[0];
+    size_t dataAt = 1 + (size_t)numElements * 4;
+    if (dataAt >= numbers.size())
+    {
+        return false;
+    }
+
+    int stride = 0;
+    int offset = -1;
+    for (int e = 0; e < numElements; ++e)
+    {
+        int type = (int)numbers[1 + e * 4];
+        if ((int)numbers[1 + e * 4 + 2] == usage && (int)numbers[1 + e * 4 + 3] == 0 && type == X_DECLTYPE_FLOAT3)
+        {
+            offset = stride;
+        }
+        if (type < X_DECLTYPE_FLOAT1 || type > X_DECLTYPE_FLOAT4)
+        {
+            return false;           // only float elements are read
+        }
+        stride += type - X_DECLTYPE_FLOAT1 + 1;
+    }
+
+    size_t numDwords = (size_t)numbers[dataAt];
+    if (offset < 0 || numDwords < (size_t)stride * numVertices || dataAt + 1 + numDwords > numbers.size())
+    {
+        return false;
+    }
+
+    for (int v = 0; v < numVertices; ++v)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            unsigned int bits = (unsigned int)numbers[dataAt + 1 + v * stride + offset + c];
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            values->push_back(value);
+        }
+    }
+    return true;
+}
+
+// appends the Mesh object read into numbers and children to mesh
+static bool AddMesh(const std::vector<double>& numbers, XChildren& children, const float* transform, XMesh* mesh)
+{
+    int numPositions = numbers.empty() ? 0 : (int)numbers[0];
+    std::vector<int> faceSizes, corners;
+    if (numPositions <= 0 || !ReadFaces(numbers, 1 + (size_t)numPositions * 3, &faceSizes, &corners))
+    {
+        return false;
+    }
+
+    // normals have faces of their own; the same position with another
+    // normal is another vertex
+    const std::vector<double>& normals = children["MeshNormals"];
+    std::vector<int> normalFaceSizes, normalCorners;
+    int numNormals = normals.empty() ? 0 : (int)normals[0];
+    bool hasNormals = numNormals > 0 && ReadFaces(normals, 1 + (size_t)numNormals * 3, &normalFaceSizes, &normalCorners) &&
+        normalCorners.size() == corners.size();
+
+    const std::vector<double>& texCoords = children["MeshTextureCoords"];
+    bool hasTexCoords = !texCoords.empty() && (int)texCoords[0] == numPositions && texCoords.size() >= 1 + (size_t)numPositions * 2;
+
+    std::vector<double> tangents, binormals;
+    bool hasTangents = ReadDeclData(children["DeclData"], numPositions, X_DECLUSAGE_TANGENT, &tangents) &&
+        ReadDeclData(children["DeclData"], numPositions, X_DECLUSAGE_BINORMAL, &binormals);
+
+    // an earlier mesh without them makes them useless for the whole file
+    bool first = (mesh->numVertices == 0);
+    hasNormals = hasNormals && (first || !mesh->normals.empty());
+    hasTexCoords = hasTexCoords && (first || !mesh->texCoords.empty());
+    hasTangents = hasTangents && (first || !mesh->tangents.empty());
+    if (!hasNormals)
+    {
+        mesh->normals.clear();
+    }
+    if (!hasTexCoords)
+    {
+        mesh->texCoords.clear();
+    }
+    if (!hasTangents)
+    {
+        mesh->tangents.clear();
+        mesh->binormals.clear();
+    }
+
+    std::map<long long, unsigned int> vertices;     // by position and normal
+    std::vector<unsigned int> faceVertices;
+    size_t corner = 0;
+    for (size_t f = 0; f < faceSizes.size(); ++f)
+    {
+        faceVertices.clear();
+        for (int i = 0; i < faceSizes[f]; ++i, ++corner)
+        {
+            int position = corners[corner];
+            int normal = hasNormals ? normalCorners[corner] : 0;
+            if (position < 0 || position >= numPositions || normal < 0 || (hasNormals && normal >= numNormals))
+            {
+                return false;
+            }
+
+            long long key = (long long)position * (numNormals + 1) + normal;
+            std::map<long long, unsigned int>::iterator found = vertices.find(key);
+            if (found != vertices.end())
+            {
+                faceVertices.push_back(found->second);
+                continue;
+            }
+
+            unsigned int vertex = (unsigned int)mesh->numVertices++;
+            vertices[key] = vertex;
+            faceVertices.push_back(vertex);
+
+            TransformVector(transform, &numbers[1 + position * 3], 1.0f, &mesh->positions);
+            if (hasNormals)
+            {
+                TransformVector(transform, &normals[1 + normal * 3], 0.0f, &mesh->normals);
+            }
+            if (hasTexCoords)
+            {
+                mesh->texCoords.push_back((float)texCoords[1 + position * 2]);
+                mesh->texCoords.push_back((float)texCoords[1 + position * 2 + 1]);
+            }
+            if (hasTangents)
+            {
+                TransformVector(transform, &tangents[position * 3], 0.0f, &mesh->tangents);
+                TransformVector(transform, &binormals[position * 3], 0.0f, &mesh->binormals);
+            }
+        }
+
+        // a fan for faces of more than three corners
+        for (size_t i = 1; i + 1 < faceVertices.size(); ++i)
+        {
+            mesh->indices.push_back(faceVertices[0]);
+            mesh->indices.push_back(faceVertices[i]);
+            mesh->indices.push_back(faceVertices[i + 1]);
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------
+// objects
+//----------------------------------------------------------------------
+
+// reads the rest of an object of type whose '{' was just read into its
+// numbers and its children's. the meshes in it are added to mesh under
+// transform, those in frames under the frames' transforms too.
+static bool ReadObject(XReader* reader, const std::string& type, const float* transform, XMesh* mesh,
+    std::vector<double>* numbers, XChildren* children)
+{
+    XToken token;
+    for (;;)
+    {
+        NextToken(reader, &token);
+        if (token.type == X_TOKEN_END)
+        {
+            return type == "xof";   // only the file itself ends there
+        }
+        if (token.type == X_TOKEN_CLOSE)
+        {
+            return true;
+        }
+
+        if (token.type == X_TOKEN_NUMBER)
+        {
+            numbers->push_back(token.number);
+            continue;
+        }
+
+        // { name } refers to an object elsewhere
+        std::string childType = token.name;
+        bool opens = (token.type == X_TOKEN_OPEN) || (token.type == X_TOKEN_NAME && OpensObject(reader));
+        if (!opens)
+        {
+            continue;
+        }
+        if (childType == "template")
+        {
+            if (!SkipObject(reader))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // a frame's transform comes before what it moves
+        float frameTransform[16];
+        const float* childTransform = transform;
+        XChildren::const_iterator local = children->find("FrameTransformMatrix");
+        if (type == "Frame" && local != children->end() && local->second.size() >= 16)
+        {
+            float matrix[16];
+            for (int i = 0; i < 16; ++i)
+            {
+                matrix[i] = (float)local->second[i];
+            }
+            MultiplyMatrix(matrix, transform, frameTransform);
+            childTransform = frameTransform;
+        }
+
+        std::vector<double> childNumbers;
+        XChildren grandChildren;
+        if (!ReadObject(reader, childType, childTransform, mesh, &childNumbers, &grandChildren))
+        {
+            return false;
+        }
+
+        if (childType == "Mesh")
+        {
+            if (!AddMesh(childNumbers, grandChildren, childTransform, mesh))
+            {
+                return false;
+            }
+        }
+        else if (!childType.empty() && children->find(childType) == children->end())
+        {
+            (*children)[childType].swap(childNumbers);
+        }
+    }
+}
+
+bool LoadXMesh(const char* filename, XMesh* mesh)
+{
+    mesh->numVertices = 0;
+    mesh->positions.clear();
+    mesh->normals.clear();
+    mesh->texCoords.clear();
+    mesh->tangents.clear();
+    mesh->binormals.clear();
+    mesh->indices.clear();
+
+    size_t size = 0;
+    unsigned char* file = ReadWholeFile(filename, &size);
+    if (!file)
+    {
+        return false;
+    }
+
+    // "xof 0303txt 0032"; binary and compressed files are not read
+    std::string text((const char*)file, size);
+    delete[] file;
+    if (size < 16 || memcmp(text.c_str(), "xof ", 4) != 0 || memcmp(text.c_str() + 8, "txt ", 4) != 0)
+    {
+        return false;
+    }
+
+    const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    XReader reader;
+    reader.at = text.c_str() + 16;
+    reader.end = text.c_str() + text.size();
+
+    // the file is the inside of an object without a '}'
+    std::vector<double> numbers;
+    XChildren children;
+    bool read = ReadObject(&reader, "xof", identity, mesh, &numbers, &children);
+
+    return read && mesh->numVertices > 0 && !mesh->indices.empty();
+}
@@ -0,0 +1,37 @@
+//**********************************************************************
+//
+// XMeshLoader.h
+//
+// Reads the text .x files the samples' models are in without D3DX, for
+// the renderers that do not run on D3D9. As D3DXLoadMeshFromX does,
+// every mesh of the file is merged into one with its frames' transforms
+// applied, and a vertex whose corners have different normals is split.
+// Tangents and binormals come from a DeclData block, as in
+// SphereWithTangent.x and TeapotWithTangent.x. Materials are ignored.
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include <vector>
+
+// ---------- types ------------------------------------
+
+// per vertex; normals, texCoords, tangents and binormals are empty if
+// the file has none
+struct XMesh
+{
+    int numVertices;
+    std::vector<float> positions;       // 3 per vertex
+    std::vector<float> normals;         // 3
+    std::vector<float> texCoords;       // 2
+    std::vector<float> tangents;        // 3
+    std::vector<float> binormals;       // 3
+    std::vector<unsigned int> indices;  // triangle list
+};
+
+// ---------------- function prototype  ------------------------
+
+// false if the file cannot be read, is binary or has no mesh
+bool LoadXMesh(const char* filename, XMesh* mesh);
@@ -20,11 +20,8 @@
 //--------------------------------------------------------------//
 // Pass 0
 //--------------------------------------------------------------//
-string ColorShader_Pass_0_Model : ModelData = ".\\sphere.x";
 
-float4x4 gWorldMatrix : World;
-float4x4 gViewMatrix : View;
-float4x4 gProjectionMatrix : Projection;
+float4x4 gWorldViewProjectionMatrix : WorldViewProjection;
 
 
 struct VS_INPUT
@@ -42,9 +39,7 @@ VS_OUTPUT ColorShader_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 {
 	VS_OUTPUT Output;
 
-	Output.mPosition = mul(Input.mPosition, gWorldMatrix);
-	Output.mPosition = mul(Output.mPosition, gViewMatrix);
-	Output.mPosition = mul(Output.mPosition, gProjectionMatrix);
+	Output.mPosition = mul(Input.mPosition, gWorldViewProjectionMatrix);
 
 	return Output;
 }
@@ -20,11 +20,9 @@
 //--------------------------------------------------------------//
 // Pass 0
 //--------------------------------------------------------------//
-string Lighting_Pass_0_Model : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\Sphere.3ds";
 
 float4x4 gWorldMatrix : World;
-float4x4 gViewMatrix : View;
-float4x4 gProjectionMatrix : Projection;
+float4x4 gViewProjectionMatrix : ViewProjection;
 
 float4 gWorldLightPosition
 <
@@ -63,8 +61,7 @@ VS_OUTPUT Lighting_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 
 	Output.mViewDir = Output.mPosition.xyz - gWorldCameraPosition.xyz;
 
-	Output.mPosition = mul(Output.mPosition, gViewMatrix);
-	Output.mPosition = mul(Output.mPosition, gProjectionMatrix);
+	Output.mPosition = mul(Output.mPosition, gViewProjectionMatrix);
 
 	float3 worldNormal = mul(Input.mNormal, (float3x3)gWorldMatrix);
 	worldNormal = normalize(worldNormal);
@@ -20,11 +20,15 @@
 //--------------------------------------------------------------//
 // Pass 0
 //--------------------------------------------------------------//
-string SpecularMapping_Pass_0_Model : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\Sphere.3ds";
+
+// feature toggles; ShaderVariants.cpp compiles one effect for each
+// combination the scene asks for. the defaults are the original shader.
+#ifndef SPECULAR
+#define SPECULAR 1              // 0 lights with the diffuse term only
+#endif
 
 float4x4 gWorldMatrix : World;
-float4x4 gViewMatrix : View;
-float4x4 gProjectionMatrix : Projection;
+float4x4 gViewProjectionMatrix : ViewProjection;
 
 float4 gWorldLightPosition
 <
@@ -49,8 +53,10 @@ struct VS_OUTPUT
 	float4 mPosition : POSITION;
 	float2 mUV: TEXCOORD0;
 	float3 mDiffuse : TEXCOORD1;
+#if SPECULAR
 	float3 mViewDir: TEXCOORD2;
 	float3 mReflection: TEXCOORD3;
+#endif
 };
 
 VS_OUTPUT SpecularMapping_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
@@ -63,16 +69,19 @@ VS_OUTPUT SpecularMapping_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 	float3 lightDirUnnorm = lightDir;
 	lightDir = normalize(lightDir);
 
+#if SPECULAR
 	Output.mViewDir = Output.mPosition.xyz - gWorldCameraPosition.xyz;
+#endif
 
-	Output.mPosition = mul(Output.mPosition, gViewMatrix);
-	Output.mPosition = mul(Output.mPosition, gProjectionMatrix);
+	Output.mPosition = mul(Output.mPosition, gViewProjectionMatrix);
 
 	float3 worldNormal = mul(Input.mNormal, (float3x3)gWorldMatrix);
 	worldNormal = normalize(worldNormal);
 
 	Output.mDiffuse = dot(-lightDir, worldNormal);
+#if SPECULAR
 	Output.mReflection = reflect(lightDirUnnorm, worldNormal);
+#endif
 
 	Output.mUV = Input.mUV;
 
@@ -83,8 +92,10 @@ struct PS_INPUT
 {
 	float2 mUV : TEXCOORD0;
 	float3 mDiffuse : TEXCOORD1;
+#if SPECULAR
 	float3 mViewDir: TEXCOORD2;
 	float3 mReflection: TEXCOORD3;
+#endif
 };
 
 texture DiffuseMap_Tex
@@ -118,9 +129,12 @@ float4 SpecularMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
 	float4 albedo = tex2D(DiffuseSampler, Input.mUV);
 	float3 diffuse = gLightColor * albedo.rgb * saturate(Input.mDiffuse);
 
+#if SPECULAR
 	float3 reflection = normalize(Input.mReflection);
 	float3 viewDir = normalize(Input.mViewDir);
+#endif
 	float3 specular = 0;
+#if SPECULAR
 	if (diffuse.x > 0)
 	{
 		specular = saturate(dot(reflection, -viewDir));
@@ -129,6 +143,7 @@ float4 SpecularMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
 		float4 specularIntensity = tex2D(SpecularSampler, Input.mUV);
 			specular *= specularIntensity.rgb * gLightColor;
 	}
+#endif
 
 	float3 ambient = float3(0.1f, 0.1f, 0.1f);
 
@@ -11,13 +11,20 @@
 //**********************************************************************
 
 #include "ShaderFramework.h"
+#include "../01_DxFramework/AssetLoaders.h"
+#include "../01_DxFramework/AssetRegistry.h"
+#include "../01_DxFramework/FrameBenchmark.h"
+#include "../01_DxFramework/GoldenTest.h"
+#include "../01_DxFramework/SimulationClock.h"
 #include <stdio.h>
+#include <string.h>
 
 #define PI           3.14159265f
 #define FOV          (PI/4.0f)							// Field of View
 #define ASPECT_RATIO (WIN_WIDTH/(float)WIN_HEIGHT)		// aspect ratio of screen
 #define NEAR_PLANE   1									
 #define FAR_PLANE    10000								
+#define ROTATION_SPEED (24.0f * PI / 180.0f)			// radians per second
 
 
 //----------------------------------------------------------------------
@@ -44,6 +51,7 @@ const char*				gAppName = "Super Simple Shader Demo Framework";
 
 // Rotation around UP vector
 float					gRotationY = 0.0f;
+float					gPreviousRotationY = 0.0f;	// at the previous simulation step
 
 // Light Position
 D3DXVECTOR4				gWorldLightPosition = D3DXVECTOR4(500.0f, 500.0f, -500.0f, 1.0f);
@@ -56,8 +64,15 @@ D3DXVECTOR4				gSurfaceColor = D3DXVECTOR4(0, 1, 0, 1);
 //-----------------------------------------------------------------------
 
 // entry point
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -benchmark and -golden run headless and quit
+	InitBenchmark(lpCmdLine);
+	InitGoldenTest(lpCmdLine);
+
+	// -record and -replay capture and play back frame times
+	InitSimulationClock(lpCmdLine, gBenchmark.enabled || gGoldenTest.enabled);
+
 	// register windows class
 	WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, MsgProc, 0L, 0L,
 		GetModuleHandle(NULL), NULL, NULL, NULL, NULL,
@@ -80,12 +95,22 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	ptDiff.y = (rcWindow.bottom - rcWindow.top) - rcClient.bottom;
 	MoveWindow(hWnd, rcWindow.left, rcWindow.top, WIN_WIDTH + ptDiff.x, WIN_HEIGHT + ptDiff.y, TRUE);
 
-	ShowWindow(hWnd, SW_SHOWDEFAULT);
+	ShowWindow(hWnd, (gBenchmark.enabled || gGoldenTest.enabled) ? SW_HIDE : SW_SHOWDEFAULT);
 	UpdateWindow(hWnd);
 
 	// Initialize everything including D3D
 	if (!InitEverything(hWnd))
 		PostQuitMessage(1);
+	else if (gBenchmark.enabled)
+	{
+		RunBenchmark(PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
+	else if (gGoldenTest.enabled)
+	{
+		RunGoldenTest(gpD3DDevice, PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
 
 	// Message Loop
 	MSG msg;
@@ -104,7 +129,7 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	}
 
 	UnregisterClass(gAppName, wc.hInstance);
-	return 0;
+	return GetGoldenTestExitCode();
 }
 
 // Message procedure
@@ -142,13 +167,27 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 //------------------------------------------------------------
 void PlayDemo()
 {
-	Update();
+	// run as many fixed steps as the elapsed time covers
+	int numSteps = AdvanceSimulationClock();
+	for (int i = 0; i < numSteps; ++i)
+	{
+		Update();
+	}
 	RenderFrame();
 }
 
-// Game logic update
+// Game logic update, run once per simulation step
 void Update()
 {
+	// rotate 24 degrees per second
+	gPreviousRotationY = gRotationY;
+	gRotationY += ROTATION_SPEED * SIMULATION_TIMESTEP;
+	if (gRotationY > 2 * PI)
+	{
+		// wrap both, so interpolating between them stays smooth
+		gRotationY -= 2 * PI;
+		gPreviousRotationY -= 2 * PI;
+	}
 }
 
 //------------------------------------------------------------
@@ -186,16 +225,18 @@ void RenderScene()
 	D3DXMATRIXA16			matProjection;
 	D3DXMatrixPerspectiveFovLH(&matProjection, FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
 
-	// for each frame, we roate 0.4 degree
-	gRotationY += 0.4f * PI / 180.0f;
-	if (gRotationY > 2 * PI)
+	// interpolate between the last two simulation steps
+	float rotationY = gPreviousRotationY + (gRotationY - gPreviousRotationY) * GetSimulationAlpha();
+
+	// golden image tests render fixed rotations
+	if (gGoldenTest.enabled)
 	{
-		gRotationY -= 2 * PI;
+		rotationY = GetGoldenRotation();
 	}
 
 	// world matrix
 	D3DXMATRIXA16			matWorld;
-	D3DXMatrixRotationY(&matWorld, gRotationY);
+	D3DXMatrixRotationY(&matWorld, rotationY);
 
 	// find inverse matrix of the world matrix
 	D3DXMATRIXA16 matInvWorld;
@@ -209,9 +250,12 @@ void RenderScene()
 
 	// set shader global variables
 	gpToonShader->SetMatrix("gWorldViewProjectionMatrix", &matWorldViewProjection);
-	gpToonShader->SetMatrix("gInvWorldMatrix", &matInvWorld);
 
-	gpToonShader->SetVector("gWorldLightPosition", &gWorldLightPosition);
+	// the light in object space is the same for every vertex
+	D3DXVECTOR4 objectLightPosition;
+	D3DXVec4Transform(&objectLightPosition, &gWorldLightPosition, &matInvWorld);
+	gpToonShader->SetVector("gObjectLightPosition", &objectLightPosition);
+
 	gpToonShader->SetVector("gSurfaceColor", &gSurfaceColor);
 
 	// start a shader
@@ -260,6 +304,7 @@ bool InitEverything(HWND hWnd)
 	}
 
 	// loading models, shaders and textures
+	InitAssetRegistry();
 	if (!LoadAssets())
 	{
 		return false;
@@ -296,14 +341,14 @@ bool InitD3D(HWND hWnd)
 	d3dpp.BackBufferCount = 1;
 	d3dpp.MultiSampleType = D3DMULTISAMPLE_NONE;
 	d3dpp.MultiSampleQuality = 0;
-	d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	d3dpp.SwapEffect = gGoldenTest.enabled ? D3DSWAPEFFECT_COPY : D3DSWAPEFFECT_DISCARD;
 	d3dpp.hDeviceWindow = hWnd;
 	d3dpp.Windowed = TRUE;
 	d3dpp.EnableAutoDepthStencil = TRUE;
 	d3dpp.AutoDepthStencilFormat = D3DFMT_D24X8;
 	d3dpp.Flags = D3DPRESENTFLAG_DISCARD_DEPTHSTENCIL;
 	d3dpp.FullScreen_RefreshRateInHz = 0;
-	d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_ONE;
+	d3dpp.PresentationInterval = gBenchmark.enabled ? D3DPRESENT_INTERVAL_IMMEDIATE : D3DPRESENT_INTERVAL_ONE;
 
 	// create a D3D device
 	if (FAILED(gpD3D->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, hWnd,
@@ -337,66 +382,21 @@ bool LoadAssets()
 	return true;
 }
 
-// loading shaders
+// loading shaders, models and textures, through the shared asset cache
+// (see ..\01_DxFramework\AssetLoaders.h)
 LPD3DXEFFECT LoadShader(const char * filename)
 {
-	LPD3DXEFFECT ret = NULL;
-
-	LPD3DXBUFFER pError = NULL;
-	DWORD dwShaderFlags = 0;
-
-#if _DEBUG
-	dwShaderFlags |= D3DXSHADER_DEBUG;
-#endif
-
-	D3DXCreateEffectFromFile(gpD3DDevice, filename,
-		NULL, NULL, dwShaderFlags, NULL, &ret, &pError);
-
-	// if failed at loading shaders, display compile error
-	// to output window
-	if (!ret && pError)
-	{
-		int size = pError->GetBufferSize();
-		void *ack = pError->GetBufferPointer();
-
-		if (ack)
-		{
-			char* str = new char[size];
-			sprintf(str, (const char*)ack, size);
-			OutputDebugString(str);
-			delete[] str;
-		}
-	}
-
-	return ret;
+	return LoadCachedEffect(gpD3DDevice, filename);
 }
 
-// loading models
 LPD3DXMESH LoadModel(const char * filename)
 {
-	LPD3DXMESH ret = NULL;
-	if (FAILED(D3DXLoadMeshFromX(filename, D3DXMESH_SYSTEMMEM, gpD3DDevice, NULL, NULL, NULL, NULL, &ret)))
-	{
-		OutputDebugString("failed at loading a model: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	};
-
-	return ret;
+	return LoadCachedMesh(gpD3DDevice, filename);
 }
 
-// loading textures
 LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 {
-	LPDIRECT3DTEXTURE9 ret = NULL;
-	if (FAILED(D3DXCreateTextureFromFile(gpD3DDevice, filename, &ret)))
-	{
-		OutputDebugString("failed at loading a texture: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	}
-
-	return ret;
+	return LoadCachedTexture(gpD3DDevice, filename, NULL);
 }
 //------------------------------------------------------------
 // cleanup code
@@ -404,6 +404,11 @@ LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 
 void Cleanup()
 {
+	// write the recorded frame times
+	ReleaseSimulationClock();
+
+	ReportAssetStats();
+
 	// release fonts
 	if (gpFont)
 	{
@@ -427,6 +432,9 @@ void Cleanup()
 
 	// release textures
 
+	// release the registry's references to shared assets
+	ReleaseAssetRegistry();
+
 	// release D3D
 	if (gpD3DDevice)
 	{
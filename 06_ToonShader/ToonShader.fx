@@ -20,14 +20,14 @@
 //--------------------------------------------------------------//
 // Pass 0
 //--------------------------------------------------------------//
-string ToonShader_Pass_0_Model : ModelData = ".\\teapot.x";
 
 float4x4 gWorldViewProjectionMatrix : WorldViewProjection;
-float4x4 gInvWorldMatrix : WorldInverse;
 
-float4 gWorldLightPosition
+// the light position in object space: gWorldLightPosition times the
+// inverse world matrix, worked out per draw
+float4 gObjectLightPosition
 <
-	string UIName = "gWorldLightPosition";
+	string UIName = "gObjectLightPosition";
 	string UIWidget = "Direction";
 	bool UIVisible = false;
 	float4 UIMin = float4(-10.00, -10.00, -10.00, -10.00);
@@ -53,8 +53,7 @@ VS_OUTPUT ToonShader_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 
 	Output.mPosition = mul(Input.mPosition, gWorldViewProjectionMatrix);
 
-	float3 objectLightPosition = mul(gWorldLightPosition, gInvWorldMatrix);
-	float3 lightDir = normalize(Input.mPosition.xyz - objectLightPosition);
+	float3 lightDir = normalize(Input.mPosition.xyz - gObjectLightPosition.xyz);
 
 	Output.mDiffuse = dot(-lightDir, normalize(Input.mNormal));
 
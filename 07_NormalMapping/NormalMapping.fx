@@ -20,7 +20,16 @@
 //--------------------------------------------------------------//
 // Pass 0
 //--------------------------------------------------------------//
-string NormalMapping_Pass_0_Model : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\Sphere.3ds";
+
+// feature toggles; ShaderVariants.cpp compiles one effect for each
+// combination the scene asks for. the defaults are the original shader.
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 1            // 0 lights with the interpolated vertex normal
+#endif
+
+#ifndef SPECULAR
+#define SPECULAR 1              // 0 lights with the diffuse term only
+#endif
 
 float4x4 gWorldMatrix : World;
 float4x4 gWorldViewProjectionMatrix : WorldViewProjection;
@@ -50,9 +59,13 @@ struct VS_OUTPUT
 	float4 mPosition : POSITION;
 	float2 mUV: TEXCOORD0;
 	float3 mLightDir : TEXCOORD1;
+#if SPECULAR
 	float3 mViewDir: TEXCOORD2;
+#endif
+#if NORMAL_MAP
 	float3 T : TEXCOORD3;
 	float3 B : TEXCOORD4;
+#endif
 	float3 N : TEXCOORD5;
 };
 
@@ -65,11 +78,15 @@ VS_OUTPUT NormalMapping_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 
 	float4 worldPosition = mul(Input.mPosition, gWorldMatrix);
 	Output.mLightDir = worldPosition.xyz - gWorldLightPosition.xyz;
+#if SPECULAR
 	Output.mViewDir = worldPosition.xyz - gWorldCameraPosition.xyz;
+#endif
 
 	Output.N = mul(Input.mNormal, (float3x3)gWorldMatrix);
+#if NORMAL_MAP
 	Output.T = mul(Input.mTangent, (float3x3)gWorldMatrix);
 	Output.B = mul(Input.mBinormal, (float3x3)gWorldMatrix);
+#endif
 
 	return Output;
 }
@@ -81,9 +98,13 @@ struct PS_INPUT
 {
 	float2 mUV : TEXCOORD0;
 	float3 mLightDir : TEXCOORD1;
+#if SPECULAR
 	float3 mViewDir: TEXCOORD2;
+#endif
+#if NORMAL_MAP
 	float3 T : TEXCOORD3;
 	float3 B : TEXCOORD4;
+#endif
 	float3 N : TEXCOORD5;
 };
 
@@ -129,12 +150,16 @@ float UIMax = 1.00;
 
 float4 NormalMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
 {
+#if NORMAL_MAP
 	float3 tangentNormal = tex2D(NormalSampler, Input.mUV).xyz;
 	tangentNormal = normalize(tangentNormal * 2 - 1);
 
 	float3x3 TBN = float3x3(normalize(Input.T), normalize(Input.B), normalize(Input.N));
 		TBN = transpose(TBN);
 	float3 wolrdNormal = mul(TBN, tangentNormal);
+#else
+	float3 wolrdNormal = normalize(Input.N);
+#endif
 
 		float4 albedo = tex2D(DiffuseSampler, Input.mUV);
 		float3 lightDir = normalize(Input.mLightDir);
@@ -142,6 +167,7 @@ float4 NormalMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
 		diffuse = gLightColor * albedo.rgb * diffuse;
 
 	float3 specular = 0;
+#if SPECULAR
 	if (diffuse.x > 0)
 	{
 		float3 reflection = reflect(lightDir, wolrdNormal);
@@ -153,6 +179,7 @@ float4 NormalMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
 		float4 specularIntensity = tex2D(SpecularSampler, Input.mUV);
 			specular *= specularIntensity.rgb * gLightColor;
 	}
+#endif
 
 	float3 ambient = float3(0.1f, 0.1f, 0.1f);
 
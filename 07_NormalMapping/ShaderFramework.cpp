@@ -11,13 +11,21 @@
 //**********************************************************************
 
 #include "ShaderFramework.h"
+#include "../01_DxFramework/AssetLoaders.h"
+#include "../01_DxFramework/AssetRegistry.h"
+#include "../01_DxFramework/FrameBenchmark.h"
+#include "../01_DxFramework/GoldenTest.h"
+#include "../01_DxFramework/ShaderVariants.h"
+#include "../01_DxFramework/SimulationClock.h"
 #include <stdio.h>
+#include <string.h>
 
 #define PI           3.14159265f
 #define FOV          (PI/4.0f)							// Field of View
 #define ASPECT_RATIO (WIN_WIDTH/(float)WIN_HEIGHT)		// aspect ratio of screen
 #define NEAR_PLANE   1									
 #define FAR_PLANE    10000								
+#define ROTATION_SPEED (24.0f * PI / 180.0f)			// radians per second
 
 
 //----------------------------------------------------------------------
@@ -35,7 +43,13 @@ ID3DXFont*              gpFont = NULL;
 LPD3DXMESH				gpSphere = NULL;
 
 // Shaders
-LPD3DXEFFECT			gpNormalMappingShader = NULL;
+LPD3DXEFFECT			gpNormalMappingShader = NULL;		// a variant, owned by ShaderVariants
+
+// NormalMapping.fx's toggles
+ShaderFeature			gNormalMappingFeatures[] = { { "NORMAL_MAP", 2 }, { "SPECULAR", 2 } };
+int						gNormalMappingVariants = -1;
+int						gWantedFeatures[2] = { 1, 1 };	// keys 1 and 2 toggle them
+int						gDrawnFeatures[2] = { 1, 1 };	// of gpNormalMappingShader
 
 // Textures
 LPDIRECT3DTEXTURE9		gpStoneDM = NULL;
@@ -47,6 +61,7 @@ const char*				gAppName = "Super Simple Shader Demo Framework";
 
 // Rotation around UP vector
 float					gRotationY = 0.0f;
+float					gPreviousRotationY = 0.0f;	// at the previous simulation step
 
 // world position of the light
 D3DXVECTOR4				gWorldLightPosition(500.0f, 500.0f, -500.0f, 1.0f);
@@ -62,8 +77,15 @@ D3DXVECTOR4				gWorldCameraPosition(0.0f, 0.0f, -200.0f, 1.0f);
 //-----------------------------------------------------------------------
 
 // entry point
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -benchmark and -golden run headless and quit
+	InitBenchmark(lpCmdLine);
+	InitGoldenTest(lpCmdLine);
+
+	// -record and -replay capture and play back frame times
+	InitSimulationClock(lpCmdLine, gBenchmark.enabled || gGoldenTest.enabled);
+
 	// register windows class
 	WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, MsgProc, 0L, 0L,
 		GetModuleHandle(NULL), NULL, NULL, NULL, NULL,
@@ -86,12 +108,22 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	ptDiff.y = (rcWindow.bottom - rcWindow.top) - rcClient.bottom;
 	MoveWindow(hWnd, rcWindow.left, rcWindow.top, WIN_WIDTH + ptDiff.x, WIN_HEIGHT + ptDiff.y, TRUE);
 
-	ShowWindow(hWnd, SW_SHOWDEFAULT);
+	ShowWindow(hWnd, (gBenchmark.enabled || gGoldenTest.enabled) ? SW_HIDE : SW_SHOWDEFAULT);
 	UpdateWindow(hWnd);
 
 	// Initialize everything including D3D
 	if (!InitEverything(hWnd))
 		PostQuitMessage(1);
+	else if (gBenchmark.enabled)
+	{
+		RunBenchmark(PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
+	else if (gGoldenTest.enabled)
+	{
+		RunGoldenTest(gpD3DDevice, PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
 
 	// Message Loop
 	MSG msg;
@@ -110,7 +142,7 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	}
 
 	UnregisterClass(gAppName, wc.hInstance);
-	return 0;
+	return GetGoldenTestExitCode();
 }
 
 // Message procedure
@@ -140,6 +172,16 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 	case VK_ESCAPE:
 		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
 		break;
+
+		// toggle normal mapping and the specular term; the variant is built
+		// when first asked for
+	case '1':
+		gWantedFeatures[0] = !gWantedFeatures[0];
+		break;
+
+	case '2':
+		gWantedFeatures[1] = !gWantedFeatures[1];
+		break;
 	}
 }
 
@@ -148,13 +190,31 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 //------------------------------------------------------------
 void PlayDemo()
 {
-	Update();
+	// run as many fixed steps as the elapsed time covers
+	int numSteps = AdvanceSimulationClock();
+	for (int i = 0; i < numSteps; ++i)
+	{
+		Update();
+	}
+
+	// create the effects of the variants compiled since the last frame
+	PumpShaderVariants();
+
 	RenderFrame();
 }
 
-// Game logic update
+// Game logic update, run once per simulation step
 void Update()
 {
+	// rotate 24 degrees per second
+	gPreviousRotationY = gRotationY;
+	gRotationY += ROTATION_SPEED * SIMULATION_TIMESTEP;
+	if (gRotationY > 2 * PI)
+	{
+		// wrap both, so interpolating between them stays smooth
+		gRotationY -= 2 * PI;
+		gPreviousRotationY -= 2 * PI;
+	}
 }
 
 //------------------------------------------------------------
@@ -181,6 +241,16 @@ void RenderFrame()
 // draw 3D objects and so on
 void RenderScene()
 {
+	// the NormalMapping variant with the wanted features; until it is built
+	// the last one is kept
+	LPD3DXEFFECT variant = GetShaderVariant(gNormalMappingVariants, gWantedFeatures);
+	if (variant)
+	{
+		gpNormalMappingShader = variant;
+		gDrawnFeatures[0] = gWantedFeatures[0];
+		gDrawnFeatures[1] = gWantedFeatures[1];
+	}
+
 	// make the view matrix
 	D3DXMATRIXA16 matView;
 	D3DXVECTOR3 vEyePt(gWorldCameraPosition.x, gWorldCameraPosition.y, gWorldCameraPosition.z);
@@ -192,16 +262,18 @@ void RenderScene()
 	D3DXMATRIXA16			matProjection;
 	D3DXMatrixPerspectiveFovLH(&matProjection, FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
 
-	// for each frame, we roate 0.4 degree
-	gRotationY += 0.4f * PI / 180.0f;
-	if (gRotationY > 2 * PI)
+	// interpolate between the last two simulation steps
+	float rotationY = gPreviousRotationY + (gRotationY - gPreviousRotationY) * GetSimulationAlpha();
+
+	// golden image tests render fixed rotations
+	if (gGoldenTest.enabled)
 	{
-		gRotationY -= 2 * PI;
+		rotationY = GetGoldenRotation();
 	}
 
 	// world matrix
 	D3DXMATRIXA16			matWorld;
-	D3DXMatrixRotationY(&matWorld, gRotationY);
+	D3DXMatrixRotationY(&matWorld, rotationY);
 
 	// concatenate world/view/projection matrices
 	D3DXMATRIXA16 matWorldView;
@@ -251,8 +323,14 @@ void RenderInfo()
 	rct.top = 5;
 	rct.bottom = WIN_HEIGHT / 3;
 
-	// display debug key info
-	gpFont->DrawText(NULL, "Demo Framework\n\nESC: Exit", -1, &rct, 0, fontColor);
+	// display debug key info and what the shader variants cost so far
+	ShaderVariantStats stats = GetShaderVariantStats();
+	char info[256];
+	sprintf(info, "Demo Framework\n\n1: normal map %s\n2: specular %s\nESC: Exit\n\n"
+		"variants: %d of %d built, %.1f ms",
+		gWantedFeatures[0] ? "on" : "off", gWantedFeatures[1] ? "on" : "off",
+		stats.numBuilt, stats.numPossible, stats.compileMs);
+	gpFont->DrawText(NULL, info, -1, &rct, 0, fontColor);
 }
 
 //------------------------------------------------------------
@@ -266,7 +344,14 @@ bool InitEverything(HWND hWnd)
 		return false;
 	}
 
+	// effect variants are compiled on a thread of their own
+	if (!InitShaderVariants(gpD3DDevice))
+	{
+		return false;
+	}
+
 	// loading models, shaders and textures
+	InitAssetRegistry();
 	if (!LoadAssets())
 	{
 		return false;
@@ -303,14 +388,14 @@ bool InitD3D(HWND hWnd)
 	d3dpp.BackBufferCount = 1;
 	d3dpp.MultiSampleType = D3DMULTISAMPLE_NONE;
 	d3dpp.MultiSampleQuality = 0;
-	d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	d3dpp.SwapEffect = gGoldenTest.enabled ? D3DSWAPEFFECT_COPY : D3DSWAPEFFECT_DISCARD;
 	d3dpp.hDeviceWindow = hWnd;
 	d3dpp.Windowed = TRUE;
 	d3dpp.EnableAutoDepthStencil = TRUE;
 	d3dpp.AutoDepthStencilFormat = D3DFMT_D24X8;
 	d3dpp.Flags = D3DPRESENTFLAG_DISCARD_DEPTHSTENCIL;
 	d3dpp.FullScreen_RefreshRateInHz = 0;
-	d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_ONE;
+	d3dpp.PresentationInterval = gBenchmark.enabled ? D3DPRESENT_INTERVAL_IMMEDIATE : D3DPRESENT_INTERVAL_ONE;
 
 	// create a D3D device
 	if (FAILED(gpD3D->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, hWnd,
@@ -344,8 +429,10 @@ bool LoadAssets()
 		return false;
 	}
 
-	// loading shaders
-	gpNormalMappingShader = LoadShader("NormalMapping.fx");
+	// loading shaders; the variant the first frame draws with is built
+	// now, the others when asked for
+	gNormalMappingVariants = AddShaderVariants("NormalMapping.fx", gNormalMappingFeatures, 2);
+	gpNormalMappingShader = LoadShaderVariant(gNormalMappingVariants, gDrawnFeatures);
 	if (!gpNormalMappingShader)
 	{
 		return false;
@@ -361,66 +448,21 @@ bool LoadAssets()
 	return true;
 }
 
-// loading shaders
+// loading shaders, models and textures, through the shared asset cache
+// (see ..\01_DxFramework\AssetLoaders.h)
 LPD3DXEFFECT LoadShader(const char * filename)
 {
-	LPD3DXEFFECT ret = NULL;
-
-	LPD3DXBUFFER pError = NULL;
-	DWORD dwShaderFlags = 0;
-
-#if _DEBUG
-	dwShaderFlags |= D3DXSHADER_DEBUG;
-#endif
-
-	D3DXCreateEffectFromFile(gpD3DDevice, filename,
-		NULL, NULL, dwShaderFlags, NULL, &ret, &pError);
-
-	// if failed at loading shaders, display compile error
-	// to output window
-	if (!ret && pError)
-	{
-		int size = pError->GetBufferSize();
-		void *ack = pError->GetBufferPointer();
-
-		if (ack)
-		{
-			char* str = new char[size];
-			sprintf(str, (const char*)ack, size);
-			OutputDebugString(str);
-			delete[] str;
-		}
-	}
-
-	return ret;
+	return LoadCachedEffect(gpD3DDevice, filename);
 }
 
-// loading models
 LPD3DXMESH LoadModel(const char * filename)
 {
-	LPD3DXMESH ret = NULL;
-	if (FAILED(D3DXLoadMeshFromX(filename, D3DXMESH_SYSTEMMEM, gpD3DDevice, NULL, NULL, NULL, NULL, &ret)))
-	{
-		OutputDebugString("failed at loading a model: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	};
-
-	return ret;
+	return LoadCachedMesh(gpD3DDevice, filename);
 }
 
-// loading textures
 LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 {
-	LPDIRECT3DTEXTURE9 ret = NULL;
-	if (FAILED(D3DXCreateTextureFromFile(gpD3DDevice, filename, &ret)))
-	{
-		OutputDebugString("failed at loading a texture: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	}
-
-	return ret;
+	return LoadCachedTexture(gpD3DDevice, filename, NULL);
 }
 //------------------------------------------------------------
 // cleanup code
@@ -428,6 +470,11 @@ LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 
 void Cleanup()
 {
+	// write the recorded frame times
+	ReleaseSimulationClock();
+
+	ReportAssetStats();
+
 	// release fonts
 	if (gpFont)
 	{
@@ -443,11 +490,8 @@ void Cleanup()
 	}
 
 	// release shaders
-	if (gpNormalMappingShader)
-	{
-		gpNormalMappingShader->Release();
-		gpNormalMappingShader = NULL;
-	}
+	ReleaseShaderVariants();
+	gpNormalMappingShader = NULL;
 
 	// release textures
 	if (gpStoneDM)
@@ -468,6 +512,9 @@ void Cleanup()
 		gpStoneNM = NULL;
 	}
 
+	// release the registry's references to shared assets
+	ReleaseAssetRegistry();
+
 	// release D3D
 	if (gpD3DDevice)
 	{
@@ -11,13 +11,21 @@
 //**********************************************************************
 
 #include "ShaderFramework.h"
+#include "../01_DxFramework/AssetLoaders.h"
+#include "../01_DxFramework/AssetRegistry.h"
+#include "../01_DxFramework/FrameBenchmark.h"
+#include "../01_DxFramework/GoldenTest.h"
+#include "../01_DxFramework/ShaderVariants.h"
+#include "../01_DxFramework/SimulationClock.h"
 #include <stdio.h>
+#include <string.h>
 
 #define PI           3.14159265f
 #define FOV          (PI/4.0f)							// Field of View
 #define ASPECT_RATIO (WIN_WIDTH/(float)WIN_HEIGHT)		// aspect ratio of screen
 #define NEAR_PLANE   1									
 #define FAR_PLANE    10000								
+#define ROTATION_SPEED (24.0f * PI / 180.0f)			// radians per second
 
 
 //----------------------------------------------------------------------
@@ -35,7 +43,13 @@ ID3DXFont*              gpFont = NULL;
 LPD3DXMESH				gpTorus = NULL;
 
 // Shaders
-LPD3DXEFFECT			gpUVAnimationShader = NULL;
+LPD3DXEFFECT			gpUVAnimationShader = NULL;		// a variant, owned by ShaderVariants
+
+// UVAnimation.fx's toggles
+ShaderFeature			gUVAnimationFeatures[] = { { "WAVE", 2 } };
+int						gUVAnimationVariants = -1;
+int						gWantedFeatures[1] = { 1 };	// key 1 toggles it
+int						gDrawnFeatures[1] = { 1 };	// of gpUVAnimationShader
 
 // Textures
 LPDIRECT3DTEXTURE9		gpStoneDM = NULL;
@@ -46,6 +60,7 @@ const char*				gAppName = "Super Simple Shader Demo Framework";
 
 // Rotation around UP vector
 float					gRotationY = 0.0f;
+float					gPreviousRotationY = 0.0f;	// at the previous simulation step
 
 // world position of the light
 D3DXVECTOR4				gWorldLightPosition(500.0f, 500.0f, -500.0f, 1.0f);
@@ -61,8 +76,15 @@ D3DXVECTOR4				gWorldCameraPosition(0.0f, 0.0f, -200.0f, 1.0f);
 //-----------------------------------------------------------------------
 
 // entry point
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -benchmark and -golden run headless and quit
+	InitBenchmark(lpCmdLine);
+	InitGoldenTest(lpCmdLine);
+
+	// -record and -replay capture and play back frame times
+	InitSimulationClock(lpCmdLine, gBenchmark.enabled || gGoldenTest.enabled);
+
 	// register windows class
 	WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, MsgProc, 0L, 0L,
 		GetModuleHandle(NULL), NULL, NULL, NULL, NULL,
@@ -85,12 +107,22 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	ptDiff.y = (rcWindow.bottom - rcWindow.top) - rcClient.bottom;
 	MoveWindow(hWnd, rcWindow.left, rcWindow.top, WIN_WIDTH + ptDiff.x, WIN_HEIGHT + ptDiff.y, TRUE);
 
-	ShowWindow(hWnd, SW_SHOWDEFAULT);
+	ShowWindow(hWnd, (gBenchmark.enabled || gGoldenTest.enabled) ? SW_HIDE : SW_SHOWDEFAULT);
 	UpdateWindow(hWnd);
 
 	// Initialize everything including D3D
 	if (!InitEverything(hWnd))
 		PostQuitMessage(1);
+	else if (gBenchmark.enabled)
+	{
+		RunBenchmark(PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
+	else if (gGoldenTest.enabled)
+	{
+		RunGoldenTest(gpD3DDevice, PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
 
 	// Message Loop
 	MSG msg;
@@ -109,7 +141,7 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	}
 
 	UnregisterClass(gAppName, wc.hInstance);
-	return 0;
+	return GetGoldenTestExitCode();
 }
 
 // Message procedure
@@ -139,6 +171,11 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 	case VK_ESCAPE:
 		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
 		break;
+
+		// toggle the wave; the variant is built when first asked for
+	case '1':
+		gWantedFeatures[0] = !gWantedFeatures[0];
+		break;
 	}
 }
 
@@ -147,13 +184,31 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 //------------------------------------------------------------
 void PlayDemo()
 {
-	Update();
+	// run as many fixed steps as the elapsed time covers
+	int numSteps = AdvanceSimulationClock();
+	for (int i = 0; i < numSteps; ++i)
+	{
+		Update();
+	}
+
+	// create the effects of the variants compiled since the last frame
+	PumpShaderVariants();
+
 	RenderFrame();
 }
 
-// Game logic update
+// Game logic update, run once per simulation step
 void Update()
 {
+	// rotate 24 degrees per second
+	gPreviousRotationY = gRotationY;
+	gRotationY += ROTATION_SPEED * SIMULATION_TIMESTEP;
+	if (gRotationY > 2 * PI)
+	{
+		// wrap both, so interpolating between them stays smooth
+		gRotationY -= 2 * PI;
+		gPreviousRotationY -= 2 * PI;
+	}
 }
 
 //------------------------------------------------------------
@@ -180,6 +235,15 @@ void RenderFrame()
 // draw 3D objects and so on
 void RenderScene()
 {
+	// the UVAnimation variant with the wanted features; until it is built
+	// the last one is kept
+	LPD3DXEFFECT variant = GetShaderVariant(gUVAnimationVariants, gWantedFeatures);
+	if (variant)
+	{
+		gpUVAnimationShader = variant;
+		gDrawnFeatures[0] = gWantedFeatures[0];
+	}
+
 	// make the view matrix
 	D3DXMATRIXA16 matView;
 	D3DXVECTOR3 vEyePt(gWorldCameraPosition.x, gWorldCameraPosition.y, gWorldCameraPosition.z);
@@ -191,21 +255,26 @@ void RenderScene()
 	D3DXMATRIXA16			matProjection;
 	D3DXMatrixPerspectiveFovLH(&matProjection, FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
 
-	// for each frame, we roate 0.4 degree
-	gRotationY += 0.4f * PI / 180.0f;
-	if (gRotationY > 2 * PI)
+	// interpolate between the last two simulation steps
+	float rotationY = gPreviousRotationY + (gRotationY - gPreviousRotationY) * GetSimulationAlpha();
+
+	// golden image tests render fixed rotations
+	if (gGoldenTest.enabled)
 	{
-		gRotationY -= 2 * PI;
+		rotationY = GetGoldenRotation();
 	}
 
 	// world matrix
 	D3DXMATRIXA16			matWorld;
-	D3DXMatrixRotationY(&matWorld, gRotationY);
+	D3DXMatrixRotationY(&matWorld, rotationY);
+
+	// concatenate view/projection matrices
+	D3DXMATRIXA16 matViewProjection;
+	D3DXMatrixMultiply(&matViewProjection, &matView, &matProjection);
 
 	// set shader global variables
 	gpUVAnimationShader->SetMatrix("gWorldMatrix", &matWorld);
-	gpUVAnimationShader->SetMatrix("gViewMatrix", &matView);
-	gpUVAnimationShader->SetMatrix("gProjectionMatrix", &matProjection);
+	gpUVAnimationShader->SetMatrix("gViewProjectionMatrix", &matViewProjection);
 
 	gpUVAnimationShader->SetVector("gWorldLightPosition", &gWorldLightPosition);
 	gpUVAnimationShader->SetVector("gWorldCameraPosition", &gWorldCameraPosition);
@@ -215,13 +284,21 @@ void RenderScene()
 	gpUVAnimationShader->SetTexture("SpecularMap_Tex", gpStoneSM);
 
 	gpUVAnimationShader->SetFloat("gWaveHeight", 3);
-	gpUVAnimationShader->SetFloat("gSpeed", 2);
 	gpUVAnimationShader->SetFloat("gWaveFrequency", 10);
-	gpUVAnimationShader->SetFloat("gUVSpeed", 0.25f);
 
-	// get system time
-	ULONGLONG tick = GetTickCount64();
-	gpUVAnimationShader->SetFloat("gTime", tick / 1000.0f);
+	// simulation time of this frame; golden image tests pin it
+	float time = GetRenderTime();
+	if (gGoldenTest.enabled)
+	{
+		time = GOLDEN_TIME;
+	}
+
+	// the wave phase and the texture scroll are the same for every vertex
+	float speed = 2.0f;
+	float uvSpeed = 0.25f;
+	D3DXVECTOR4 uvOffset(time * uvSpeed, 0.0f, 0.0f, 0.0f);
+	gpUVAnimationShader->SetFloat("gWavePhase", time * speed);
+	gpUVAnimationShader->SetVector("gUVOffset", &uvOffset);
 
 	// start a shader
 	UINT numPasses = 0;
@@ -253,8 +330,14 @@ void RenderInfo()
 	rct.top = 5;
 	rct.bottom = WIN_HEIGHT / 3;
 
-	// display debug key info
-	gpFont->DrawText(NULL, "Demo Framework\n\nESC: Exit", -1, &rct, 0, fontColor);
+	// display debug key info and what the shader variants cost so far
+	ShaderVariantStats stats = GetShaderVariantStats();
+	char info[256];
+	sprintf(info, "Demo Framework\n\n1: wave %s\nESC: Exit\n\n"
+		"variants: %d of %d built, %.1f ms",
+		gWantedFeatures[0] ? "on" : "off",
+		stats.numBuilt, stats.numPossible, stats.compileMs);
+	gpFont->DrawText(NULL, info, -1, &rct, 0, fontColor);
 }
 
 //------------------------------------------------------------
@@ -268,7 +351,14 @@ bool InitEverything(HWND hWnd)
 		return false;
 	}
 
+	// effect variants are compiled on a thread of their own
+	if (!InitShaderVariants(gpD3DDevice))
+	{
+		return false;
+	}
+
 	// loading models, shaders and textures
+	InitAssetRegistry();
 	if (!LoadAssets())
 	{
 		return false;
@@ -305,14 +395,14 @@ bool InitD3D(HWND hWnd)
 	d3dpp.BackBufferCount = 1;
 	d3dpp.MultiSampleType = D3DMULTISAMPLE_NONE;
 	d3dpp.MultiSampleQuality = 0;
-	d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	d3dpp.SwapEffect = gGoldenTest.enabled ? D3DSWAPEFFECT_COPY : D3DSWAPEFFECT_DISCARD;
 	d3dpp.hDeviceWindow = hWnd;
 	d3dpp.Windowed = TRUE;
 	d3dpp.EnableAutoDepthStencil = TRUE;
 	d3dpp.AutoDepthStencilFormat = D3DFMT_D24X8;
 	d3dpp.Flags = D3DPRESENTFLAG_DISCARD_DEPTHSTENCIL;
 	d3dpp.FullScreen_RefreshRateInHz = 0;
-	d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_ONE;
+	d3dpp.PresentationInterval = gBenchmark.enabled ? D3DPRESENT_INTERVAL_IMMEDIATE : D3DPRESENT_INTERVAL_ONE;
 
 	// create a D3D device
 	if (FAILED(gpD3D->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, hWnd,
@@ -340,8 +430,10 @@ bool LoadAssets()
 		return false;
 	}
 
-	// loading shaders
-	gpUVAnimationShader = LoadShader("UVAnimation.fx");
+	// loading shaders; the variant the first frame draws with is built
+	// now, the others when asked for
+	gUVAnimationVariants = AddShaderVariants("UVAnimation.fx", gUVAnimationFeatures, 1);
+	gpUVAnimationShader = LoadShaderVariant(gUVAnimationVariants, gDrawnFeatures);
 	if (!gpUVAnimationShader)
 	{
 		return false;
@@ -357,66 +449,21 @@ bool LoadAssets()
 	return true;
 }
 
-// loading shaders
+// loading shaders, models and textures, through the shared asset cache
+// (see ..\01_DxFramework\AssetLoaders.h)
 LPD3DXEFFECT LoadShader(const char * filename)
 {
-	LPD3DXEFFECT ret = NULL;
-
-	LPD3DXBUFFER pError = NULL;
-	DWORD dwShaderFlags = 0;
-
-#if _DEBUG
-	dwShaderFlags |= D3DXSHADER_DEBUG;
-#endif
-
-	D3DXCreateEffectFromFile(gpD3DDevice, filename,
-		NULL, NULL, dwShaderFlags, NULL, &ret, &pError);
-
-	// if failed at loading shaders, display compile error
-	// to output window
-	if (!ret && pError)
-	{
-		int size = pError->GetBufferSize();
-		void *ack = pError->GetBufferPointer();
-
-		if (ack)
-		{
-			char* str = new char[size];
-			sprintf(str, (const char*)ack, size);
-			OutputDebugString(str);
-			delete[] str;
-		}
-	}
-
-	return ret;
+	return LoadCachedEffect(gpD3DDevice, filename);
 }
 
-// loading models
 LPD3DXMESH LoadModel(const char * filename)
 {
-	LPD3DXMESH ret = NULL;
-	if (FAILED(D3DXLoadMeshFromX(filename, D3DXMESH_SYSTEMMEM, gpD3DDevice, NULL, NULL, NULL, NULL, &ret)))
-	{
-		OutputDebugString("failed at loading a model: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	};
-
-	return ret;
+	return LoadCachedMesh(gpD3DDevice, filename);
 }
 
-// loading textures
 LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 {
-	LPDIRECT3DTEXTURE9 ret = NULL;
-	if (FAILED(D3DXCreateTextureFromFile(gpD3DDevice, filename, &ret)))
-	{
-		OutputDebugString("failed at loading a texture: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	}
-
-	return ret;
+	return LoadCachedTexture(gpD3DDevice, filename, NULL);
 }
 //------------------------------------------------------------
 // cleanup code
@@ -424,6 +471,11 @@ LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 
 void Cleanup()
 {
+	// write the recorded frame times
+	ReleaseSimulationClock();
+
+	ReportAssetStats();
+
 	// release fonts
 	if (gpFont)
 	{
@@ -439,11 +491,8 @@ void Cleanup()
 	}
 
 	// release shaders
-	if (gpUVAnimationShader)
-	{
-		gpUVAnimationShader->Release();
-		gpUVAnimationShader = NULL;
-	}
+	ReleaseShaderVariants();
+	gpUVAnimationShader = NULL;
 
 	// release textures
 	if (gpStoneDM)
@@ -458,6 +507,9 @@ void Cleanup()
 		gpStoneSM = NULL;
 	}
 
+	// release the registry's references to shared assets
+	ReleaseAssetRegistry();
+
 	// release D3D
 	if (gpD3DDevice)
 	{
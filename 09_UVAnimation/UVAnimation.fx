@@ -20,11 +20,15 @@
 //--------------------------------------------------------------//
 // Pass 0
 //--------------------------------------------------------------//
-string UVAnimation_Pass_0_Model : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\Torus.3ds";
+
+// feature toggles; ShaderVariants.cpp compiles one effect for each
+// combination the scene asks for. the defaults are the original shader.
+#ifndef WAVE
+#define WAVE 1                  // 0 leaves the vertices where the mesh has them
+#endif
 
 float4x4 gWorldMatrix : World;
-float4x4 gViewMatrix : View;
-float4x4 gProjectionMatrix : Projection;
+float4x4 gViewProjectionMatrix : ViewProjection;
 
 float4 gWorldLightPosition
 <
@@ -37,7 +41,10 @@ float4 gWorldLightPosition
 > = float4(500.00, 500.00, -500.00, 1.00);
 float4 gWorldCameraPosition : ViewPosition;
 
-float gTime : Time0_X;
+// gTime * gSpeed and float2(gTime * gUVSpeed, 0), worked out per draw
+float gWavePhase;
+float2 gUVOffset;
+
 float gWaveHeight
 <
 	string UIName = "gWaveHeight";
@@ -46,14 +53,6 @@ float gWaveHeight
 	float UIMin = -1.00;
 	float UIMax = 1.00;
 > = float(3.00);
-float gSpeed
-<
-	string UIName = "gSpeed";
-	string UIWidget = "Numeric";
-	bool UIVisible = false;
-	float UIMin = -1.00;
-	float UIMax = 1.00;
-> = float(2.00);
 float gWaveFrequency
 <
 	string UIName = "gWaveFrequency";
@@ -62,14 +61,6 @@ float gWaveFrequency
 	float UIMin = -1.00;
 	float UIMax = 1.00;
 > = float(10.00);
-float gUVSpeed
-<
-	string UIName = "gUVSpeed";
-	string UIWidget = "Numeric";
-	bool UIVisible = false;
-	float UIMin = -1.00;
-	float UIMax = 1.00;
-> = float(0.25);
 
 
 struct VS_INPUT
@@ -92,8 +83,10 @@ VS_OUTPUT UVAnimation_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 {
 	VS_OUTPUT Output;
 
-	float cosTime = gWaveHeight * cos(gTime * gSpeed + Input.mUV.x*gWaveFrequency);
+#if WAVE
+	float cosTime = gWaveHeight * cos(gWavePhase + Input.mUV.x*gWaveFrequency);
 	Input.mPosition.y += cosTime;
+#endif
 
 	Output.mPosition = mul(Input.mPosition, gWorldMatrix);
 
@@ -103,8 +96,7 @@ VS_OUTPUT UVAnimation_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 
 	Output.mViewDir = Output.mPosition.xyz - gWorldCameraPosition.xyz;
 
-	Output.mPosition = mul(Output.mPosition, gViewMatrix);
-	Output.mPosition = mul(Output.mPosition, gProjectionMatrix);
+	Output.mPosition = mul(Output.mPosition, gViewProjectionMatrix);
 
 	float3 worldNormal = mul(Input.mNormal, (float3x3)gWorldMatrix);
 	worldNormal = normalize(worldNormal);
@@ -112,7 +104,7 @@ VS_OUTPUT UVAnimation_Pass_0_Vertex_Shader_vs_main(VS_INPUT Input)
 	Output.mDiffuse = dot(-lightDir, worldNormal);
 	Output.mReflection = reflect(lightDirUnnorm, worldNormal);
 
-	Output.mUV = Input.mUV + float2(gTime * gUVSpeed, 0);
+	Output.mUV = Input.mUV + gUVOffset;
 
 	return Output;
 }
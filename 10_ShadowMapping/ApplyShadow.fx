@@ -20,7 +20,16 @@
 //--------------------------------------------------------------//
 // ApplyShadowTorus
 //--------------------------------------------------------------//
-string ApplyShadowShader_ApplyShadowTorus_Torus : ModelData = ".\\Torus.x";
+
+// feature toggles; ShaderVariants.cpp compiles one effect for each
+// combination the scene asks for. the defaults are the original shader.
+#ifndef SHADOW
+#define SHADOW 1                // 0 draws without the shadow map
+#endif
+
+#ifndef SHADOW_PCF_RADIUS
+#define SHADOW_PCF_RADIUS 0     // texels around the pixel's to filter
+#endif
 
 struct VS_INPUT
 {
@@ -31,18 +40,14 @@ struct VS_INPUT
 struct VS_OUTPUT
 {
 	float4 mPosition: POSITION;
+#if SHADOW
 	float4 mClipPosition: TEXCOORD1;
+#endif
 	float mDiffuse : TEXCOORD2;
 };
 
 float4x4 gWorldMatrix : World;
-float4x4 gLightViewMatrix
-<
-	string UIName = "gLightViewMatrix";
-	string UIWidget = "Numeric";
-	bool UIVisible = false;
-> = float4x4(1.00, 0.00, 0.00, 0.00, 0.00, 1.00, 0.00, 0.00, 0.00, 0.00, 1.00, 0.00, 0.00, 0.00, 0.00, 1.00);
-float4x4 gLightProjectionMatrix : Projection;
+float4x4 gLightViewProjectionMatrix;
 
 float4 gWorldLightPosition
 <
@@ -60,13 +65,12 @@ VS_OUTPUT ApplyShadowShader_ApplyShadowTorus_Vertex_Shader_vs_main(VS_INPUT Inpu
 {
 	VS_OUTPUT Output;
 
-	float4x4 lightViewMatrix = gLightViewMatrix;
-
 	float4 worldPosition = mul(Input.mPosition, gWorldMatrix);
 	Output.mPosition = mul(worldPosition, gViewProjectionMatrix);
 
-	Output.mClipPosition = mul(worldPosition, lightViewMatrix);
-	Output.mClipPosition = mul(Output.mClipPosition, gLightProjectionMatrix);
+#if SHADOW
+	Output.mClipPosition = mul(worldPosition, gLightViewProjectionMatrix);
+#endif
 
 	float3 lightDir = normalize(worldPosition.xyz - gWorldLightPosition.xyz);
 	float3 worldNormal = normalize(mul(Input.mNormal, (float3x3)gWorldMatrix));
@@ -89,9 +93,22 @@ float4 gObjectColor
 	bool UIVisible = true;
 > = float4(1.00, 1.00, 0.00, 1.00);
 
+#if SHADOW
+// the part of the shadow map's surface the map covers, when the frame
+// graph's pool serves it with a larger one
+float2 gShadowMapUVScale : TextureScale = float2(1.0, 1.0);
+#endif
+
+#if SHADOW_PCF_RADIUS > 0
+// the size of a shadow map texel in texture coordinates
+float2 gShadowMapTexelSize = float2(1.0 / 2048.0, 1.0 / 2048.0);
+#endif
+
 struct PS_INPUT
 {
+#if SHADOW
 	float4 mClipPosition: TEXCOORD1;
+#endif
 	float mDiffuse : TEXCOORD2;
 };
 
@@ -99,18 +116,34 @@ float4 ApplyShadowShader_ApplyShadowTorus_Pixel_Shader_ps_main(PS_INPUT Input) :
 {
 	float3 rgb = saturate(Input.mDiffuse) * gObjectColor;
 
+#if SHADOW
 	float currentDepth = Input.mClipPosition.z / Input.mClipPosition.w;
 
 	float2 uv = Input.mClipPosition.xy / Input.mClipPosition.w;
 	uv.y = -uv.y;
-	uv = uv * 0.5 + 0.5;
+	uv = (uv * 0.5 + 0.5) * gShadowMapUVScale;
 
+#if SHADOW_PCF_RADIUS > 0
+	// darken by the share of the nearby texels that are in front
+	float shadow = 0.0f;
+	for (int y = -SHADOW_PCF_RADIUS; y <= SHADOW_PCF_RADIUS; ++y)
+	{
+		for (int x = -SHADOW_PCF_RADIUS; x <= SHADOW_PCF_RADIUS; ++x)
+		{
+			float shadowDepth = tex2D(ShadowSampler, uv + float2(x, y) * gShadowMapTexelSize).r;
+			shadow += (currentDepth > shadowDepth + 0.0000125f);
+		}
+	}
+	rgb *= 1.0f - 0.5f * shadow / ((2 * SHADOW_PCF_RADIUS + 1) * (2 * SHADOW_PCF_RADIUS + 1));
+#else
 	float shadowDepth = tex2D(ShadowSampler, uv).r;
 
 	if (currentDepth > shadowDepth + 0.0000125f)
 	{
 		rgb *= 0.5f;
 	}
+#endif
+#endif
 
 	return(float4(rgb, 1.0f));
 }
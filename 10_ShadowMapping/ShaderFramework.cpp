@@ -11,13 +11,24 @@
 //**********************************************************************
 
 #include "ShaderFramework.h"
+#include "../01_DxFramework/AssetLoaders.h"
+#include "../01_DxFramework/AssetRegistry.h"
+#include "../01_DxFramework/DrawQueue.h"
+#include "../01_DxFramework/FrameBenchmark.h"
+#include "../01_DxFramework/FrameGraph.h"
+#include "../01_DxFramework/GoldenTest.h"
+#include "../01_DxFramework/ShaderVariants.h"
+#include "../01_DxFramework/SimulationClock.h"
 #include <stdio.h>
+#include <string.h>
 
 #define PI           3.14159265f
 #define FOV          (PI/4.0f)							// Field of View
 #define ASPECT_RATIO (WIN_WIDTH/(float)WIN_HEIGHT)		// aspect ratio of screen
 #define NEAR_PLANE   1									
 #define FAR_PLANE    10000								
+#define ROTATION_SPEED (24.0f * PI / 180.0f)			// radians per second
+#define SHADOW_MAP_SIZE 2048
 
 
 //----------------------------------------------------------------------
@@ -36,9 +47,15 @@ LPD3DXMESH				gpTorus = NULL;
 LPD3DXMESH				gpDisc = NULL;
 
 // Shaders
-LPD3DXEFFECT			gpApplyShadowShader = NULL;
+LPD3DXEFFECT			gpApplyShadowShader = NULL;		// a variant, owned by ShaderVariants
 LPD3DXEFFECT			gpCreateShadowShader = NULL;
 
+// ApplyShadow.fx's toggles; ps_2_0 fits a PCF radius of 1
+ShaderFeature			gApplyShadowFeatures[] = { { "SHADOW", 2 }, { "SHADOW_PCF_RADIUS", 2 } };
+int						gApplyShadowVariants = -1;
+int						gWantedFeatures[2] = { 1, 0 };	// keys 1 and 2 toggle them
+int						gDrawnFeatures[2] = { 1, 0 };	// of gpApplyShadowShader
+
 // Textures
 
 // Application Name
@@ -46,6 +63,7 @@ const char*				gAppName = "Super Simple Shader Demo Framework";
 
 // Rotation around UP vector
 float					gRotationY = 0.0f;
+float					gPreviousRotationY = 0.0f;	// at the previous simulation step
 
 // world position of the light
 D3DXVECTOR4				gWorldLightPosition(500.0f, 500.0f, -500.0f, 1.0f);
@@ -57,17 +75,38 @@ D3DXVECTOR4				gWorldCameraPosition(0.0f, 0.0f, -200.0f, 1.0f);
 D3DXVECTOR4				gTorusColor(1, 1, 0, 1);
 D3DXVECTOR4				gDiscColor(0, 1, 1, 1);
 
-// shadowmap render targets
-LPDIRECT3DTEXTURE9		gpShadowRenderTarget = NULL;
-LPDIRECT3DSURFACE9		gpShadowDepthStencil = NULL;
+// what differs between the objects the shadow is applied to
+struct ShadowObject
+{
+	D3DXMATRIXA16 world;
+	D3DXVECTOR4 color;
+};
+
+// what the shadow passes of one frame draw with
+struct ShadowFrame
+{
+	D3DXMATRIXA16 lightViewProjection;
+	D3DXMATRIXA16 viewProjection;
+	ShadowObject torus;
+	ShadowObject disc;
+	bool shadows;
+	FrameResource shadowMap;
+};
 
 //-----------------------------------------------------------------------
 // Program entry point/message loop
 //-----------------------------------------------------------------------
 
 // entry point
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -benchmark and -golden run headless and quit
+	InitBenchmark(lpCmdLine);
+	InitGoldenTest(lpCmdLine);
+
+	// -record and -replay capture and play back frame times
+	InitSimulationClock(lpCmdLine, gBenchmark.enabled || gGoldenTest.enabled);
+
 	// register windows class
 	WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, MsgProc, 0L, 0L,
 		GetModuleHandle(NULL), NULL, NULL, NULL, NULL,
@@ -90,12 +129,22 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	ptDiff.y = (rcWindow.bottom - rcWindow.top) - rcClient.bottom;
 	MoveWindow(hWnd, rcWindow.left, rcWindow.top, WIN_WIDTH + ptDiff.x, WIN_HEIGHT + ptDiff.y, TRUE);
 
-	ShowWindow(hWnd, SW_SHOWDEFAULT);
+	ShowWindow(hWnd, (gBenchmark.enabled || gGoldenTest.enabled) ? SW_HIDE : SW_SHOWDEFAULT);
 	UpdateWindow(hWnd);
 
 	// Initialize everything including D3D
 	if (!InitEverything(hWnd))
 		PostQuitMessage(1);
+	else if (gBenchmark.enabled)
+	{
+		RunBenchmark(PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
+	else if (gGoldenTest.enabled)
+	{
+		RunGoldenTest(gpD3DDevice, PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
 
 	// Message Loop
 	MSG msg;
@@ -114,7 +163,7 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	}
 
 	UnregisterClass(gAppName, wc.hInstance);
-	return 0;
+	return GetGoldenTestExitCode();
 }
 
 // Message procedure
@@ -144,6 +193,15 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 	case VK_ESCAPE:
 		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
 		break;
+
+		// toggle shadows and PCF; the variant is built when first asked for
+	case '1':
+		gWantedFeatures[0] = !gWantedFeatures[0];
+		break;
+
+	case '2':
+		gWantedFeatures[1] = !gWantedFeatures[1];
+		break;
 	}
 }
 
@@ -152,13 +210,31 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 //------------------------------------------------------------
 void PlayDemo()
 {
-	Update();
+	// run as many fixed steps as the elapsed time covers
+	int numSteps = AdvanceSimulationClock();
+	for (int i = 0; i < numSteps; ++i)
+	{
+		Update();
+	}
+
+	// create the effects of the variants compiled since the last frame
+	PumpShaderVariants();
+
 	RenderFrame();
 }
 
-// Game logic update
+// Game logic update, run once per simulation step
 void Update()
 {
+	// rotate 24 degrees per second
+	gPreviousRotationY = gRotationY;
+	gRotationY += ROTATION_SPEED * SIMULATION_TIMESTEP;
+	if (gRotationY > 2 * PI)
+	{
+		// wrap both, so interpolating between them stays smooth
+		gRotationY -= 2 * PI;
+		gPreviousRotationY -= 2 * PI;
+	}
 }
 
 //------------------------------------------------------------
@@ -185,23 +261,35 @@ void RenderFrame()
 // draw 3D objects and so on
 void RenderScene()
 {
-	// create light-view matrix
-	D3DXMATRIXA16 matLightView;
+	ShadowFrame frame;
+
+	// the ApplyShadow variant with the wanted features; PCF makes no
+	// difference without shadows. until it is built the last one is kept.
+	int features[2] = { gWantedFeatures[0], gWantedFeatures[0] ? gWantedFeatures[1] : 0 };
+	LPD3DXEFFECT variant = GetShaderVariant(gApplyShadowVariants, features);
+	if (variant)
 	{
+		gpApplyShadowShader = variant;
+		gDrawnFeatures[0] = features[0];
+		gDrawnFeatures[1] = features[1];
+	}
+	frame.shadows = (gDrawnFeatures[0] != 0);
+
+	// create light-view/projection matrix
+	{
+		D3DXMATRIXA16 matLightView;
 		D3DXVECTOR3 vEyePt(gWorldLightPosition.x, gWorldLightPosition.y, gWorldLightPosition.z);
 		D3DXVECTOR3 vLookatPt(0.0f, 0.0f, 0.0f);
 		D3DXVECTOR3 vUpVec(0.0f, 1.0f, 0.0f);
 		D3DXMatrixLookAtLH(&matLightView, &vEyePt, &vLookatPt, &vUpVec);
-	}
 
-	// create light-projection matrix
-	D3DXMATRIXA16 matLightProjection;
-	{
+		D3DXMATRIXA16 matLightProjection;
 		D3DXMatrixPerspectiveFovLH(&matLightProjection, D3DX_PI / 4.0f, 1, 1, 3000);
+
+		D3DXMatrixMultiply(&frame.lightViewProjection, &matLightView, &matLightProjection);
 	}
 
 	// create view/projection matrix
-	D3DXMATRIXA16 matViewProjection;
 	{
 		// make the view matrix
 		D3DXMATRIXA16 matView;
@@ -214,24 +302,25 @@ void RenderScene()
 		D3DXMATRIXA16			matProjection;
 		D3DXMatrixPerspectiveFovLH(&matProjection, FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
 
-		D3DXMatrixMultiply(&matViewProjection, &matView, &matProjection);
+		D3DXMatrixMultiply(&frame.viewProjection, &matView, &matProjection);
 	}
 
 	// world matrix for torus
-	D3DXMATRIXA16			matTorusWorld;
 	{
-		// for each frame, we roate 0.4 degree
-		gRotationY += 0.4f * PI / 180.0f;
-		if (gRotationY > 2 * PI)
+		// interpolate between the last two simulation steps
+		float rotationY = gPreviousRotationY + (gRotationY - gPreviousRotationY) * GetSimulationAlpha();
+
+		// golden image tests render fixed rotations
+		if (gGoldenTest.enabled)
 		{
-			gRotationY -= 2 * PI;
+			rotationY = GetGoldenRotation();
 		}
 
-		D3DXMatrixRotationY(&matTorusWorld, gRotationY);
+		D3DXMatrixRotationY(&frame.torus.world, rotationY);
+		frame.torus.color = gTorusColor;
 	}
 
 	// world matrix for disc
-	D3DXMATRIXA16			matDiscWorld;
 	{
 		D3DXMATRIXA16 matScale;
 		D3DXMatrixScaling(&matScale, 2, 2, 2);
@@ -239,104 +328,138 @@ void RenderScene()
 		D3DXMATRIXA16 matTrans;
 		D3DXMatrixTranslation(&matTrans, 0, -40, 0);
 
-		D3DXMatrixMultiply(&matDiscWorld, &matScale, &matTrans);
+		D3DXMatrixMultiply(&frame.disc.world, &matScale, &matTrans);
+		frame.disc.color = gDiscColor;
 	}
 
-	// current hardware backbuffer and depth buffer
-	LPDIRECT3DSURFACE9 pHWBackBuffer = NULL;
-	LPDIRECT3DSURFACE9 pHWDepthStencilBuffer = NULL;
-	gpD3DDevice->GetRenderTarget(0, &pHWBackBuffer);
-	gpD3DDevice->GetDepthStencilSurface(&pHWDepthStencilBuffer);
+	// the shadow map and its depth buffer only live between the two passes,
+	// and are not drawn at all without shadows
+	BeginFrameGraph();
+	if (frame.shadows)
+	{
+		frame.shadowMap = CreateFrameTarget("shadow map", SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, D3DFMT_R32F);
+		FrameResource shadowDepth = CreateFrameDepth("shadow depth", SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, D3DFMT_D24X8);
 
-	//////////////////////////////
-	// 1. create shadow
-	//////////////////////////////
+		int createShadow = AddFramePass("create shadow", CreateShadowPass, &frame);
+		WriteFrameResource(createShadow, frame.shadowMap);
+		WriteFrameResource(createShadow, shadowDepth);
+	}
 
-	// use shadow render target and depth buffer
-	LPDIRECT3DSURFACE9 pShadowSurface = NULL;
-	if (SUCCEEDED(gpShadowRenderTarget->GetSurfaceLevel(0, &pShadowSurface)))
+	int applyShadow = AddFramePass("apply shadow", ApplyShadowPass, &frame);
+	if (frame.shadows)
 	{
-		gpD3DDevice->SetRenderTarget(0, pShadowSurface);
-		pShadowSurface->Release();
-		pShadowSurface = NULL;
+		ReadFrameResource(applyShadow, frame.shadowMap);
 	}
-	gpD3DDevice->SetDepthStencilSurface(gpShadowDepthStencil);
+	WriteFrameResource(applyShadow, FRAME_BACK_BUFFER);
+	WriteFrameResource(applyShadow, FRAME_DEPTH_BUFFER);
+
+	ExecuteFrameGraph();
+}
+
+// 1. create shadow
+void CreateShadowPass(void* data)
+{
+	const ShadowFrame* frame = (const ShadowFrame*)data;
 
 	// clears the shadow info from last frame
 	gpD3DDevice->Clear(0, NULL, (D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER), 0xFFFFFFFF, 1.0f, 0);
 
+	// concatenate world/light-view/light-projection matrices
+	D3DXMATRIXA16 matWorldLightViewProjection;
+	D3DXMatrixMultiply(&matWorldLightViewProjection, &frame->torus.world, &frame->lightViewProjection);
+
 	// set global variables for shadow creating shader
-	gpCreateShadowShader->SetMatrix("gWorldMatrix", &matTorusWorld);
-	gpCreateShadowShader->SetMatrix("gLightViewMatrix", &matLightView);
-	gpCreateShadowShader->SetMatrix("gLightProjectionMatrix", &matLightProjection);
+	gpCreateShadowShader->SetMatrix("gWorldLightViewProjectionMatrix", &matWorldLightViewProjection);
 
 	// begin CreateShadow shader
+	UINT numPasses = 0;
+	gpCreateShadowShader->Begin(&numPasses, NULL);
 	{
-		UINT numPasses = 0;
-		gpCreateShadowShader->Begin(&numPasses, NULL);
+		for (UINT i = 0; i < numPasses; ++i)
 		{
-			for (UINT i = 0; i < numPasses; ++i)
+			gpCreateShadowShader->BeginPass(i);
 			{
-				gpCreateShadowShader->BeginPass(i);
-				{
-					// draw the torus
-					gpTorus->DrawSubset(0);
-				}
-				gpCreateShadowShader->EndPass();
+				// draw the torus
+				gpTorus->DrawSubset(0);
 			}
+			gpCreateShadowShader->EndPass();
 		}
-		gpCreateShadowShader->End();
 	}
+	gpCreateShadowShader->End();
+}
 
+// 2. apply shadow
+void ApplyShadowPass(void* data)
+{
+	const ShadowFrame* frame = (const ShadowFrame*)data;
 
-	//////////////////////////////
-	// 2. apply shadow
-	//////////////////////////////
+	// set global variables for ApplyShadow shader; the variant without
+	// shadows has no light view or shadow map
+	gpApplyShadowShader->SetMatrix("gViewProjectionMatrix", &frame->viewProjection);
 
-	// use hardware backbuffer and depth buffer
-	gpD3DDevice->SetRenderTarget(0, pHWBackBuffer);
-	gpD3DDevice->SetDepthStencilSurface(pHWDepthStencilBuffer);
+	// the pool may have given the shadow map a larger surface; the map is
+	// at its top left, and a texel is one of the whole surface
+	float uScale = 1.0f;
+	float vScale = 1.0f;
+	if (frame->shadows)
+	{
+		GetFrameTextureScale(frame->shadowMap, &uScale, &vScale);
 
-	pHWBackBuffer->Release();
-	pHWBackBuffer = NULL;
-	pHWDepthStencilBuffer->Release();
-	pHWDepthStencilBuffer = NULL;
+		D3DXVECTOR4 uvScale(uScale, vScale, 0, 0);
+		gpApplyShadowShader->SetMatrix("gLightViewProjectionMatrix", &frame->lightViewProjection);
+		gpApplyShadowShader->SetVector("gShadowMapUVScale", &uvScale);
+	}
+	if (gDrawnFeatures[1])
+	{
+		D3DXVECTOR4 texelSize(uScale / SHADOW_MAP_SIZE, vScale / SHADOW_MAP_SIZE, 0, 0);
+		gpApplyShadowShader->SetVector("gShadowMapTexelSize", &texelSize);
+	}
 
+	gpApplyShadowShader->SetVector("gWorldLightPosition", &gWorldLightPosition);
 
-	// set global variables for ApplyShadow shader
-	gpApplyShadowShader->SetMatrix("gWorldMatrix", &matTorusWorld);	//torus
-	gpApplyShadowShader->SetMatrix("gViewProjectionMatrix", &matViewProjection);
-	gpApplyShadowShader->SetMatrix("gLightViewMatrix", &matLightView);
-	gpApplyShadowShader->SetMatrix("gLightProjectionMatrix", &matLightProjection);
+	// the torus and the disc share the shader and the shadow map, so the
+	// queue begins the shader and sets the texture once for both
+	DrawItem item;
+	ZeroMemory(&item, sizeof(item));
+	item.effect = gpApplyShadowShader;
+	if (frame->shadows)
+	{
+		item.textureNames[0] = "ShadowMap_Tex";
+		item.textures[0] = GetFrameTexture(frame->shadowMap);
+	}
+	item.setup = SetShadowObject;
 
-	gpApplyShadowShader->SetVector("gWorldLightPosition", &gWorldLightPosition);
+	ClearDrawQueue();
 
-	gpApplyShadowShader->SetVector("gObjectColor", &gTorusColor);
+	item.mesh = gpTorus;
+	item.depth = GetCameraDistance(frame->torus.world);
+	item.data = &frame->torus;
+	AddDrawItem(item);
 
-	gpApplyShadowShader->SetTexture("ShadowMap_Tex", gpShadowRenderTarget);
+	item.mesh = gpDisc;
+	item.depth = GetCameraDistance(frame->disc.world);
+	item.data = &frame->disc;
+	AddDrawItem(item);
 
+	SortDrawQueue();
+	SubmitDrawQueue();
+}
 
-	// start a shader
-	UINT numPasses = 0;
-	gpApplyShadowShader->Begin(&numPasses, NULL);
-	{
-		for (UINT i = 0; i < numPasses; ++i)
-		{
-			gpApplyShadowShader->BeginPass(i);
-			{
-				// draw the torus
-				gpTorus->DrawSubset(0);
+// sets an object's world matrix and colour on the ApplyShadow shader
+void SetShadowObject(LPD3DXEFFECT effect, const void* data)
+{
+	const ShadowObject* object = (const ShadowObject*)data;
+	effect->SetMatrix("gWorldMatrix", &object->world);
+	effect->SetVector("gObjectColor", &object->color);
+}
 
-				// draw the disc
-				gpApplyShadowShader->SetMatrix("gWorldMatrix", &matDiscWorld);
-				gpApplyShadowShader->SetVector("gObjectColor", &gDiscColor);
-				gpApplyShadowShader->CommitChanges();
-				gpDisc->DrawSubset(0);
-			}
-			gpApplyShadowShader->EndPass();
-		}
-	}
-	gpApplyShadowShader->End();
+// distance from the camera to the origin of an object
+float GetCameraDistance(const D3DXMATRIXA16& world)
+{
+	D3DXVECTOR3 toObject(world._41 - gWorldCameraPosition.x,
+		world._42 - gWorldCameraPosition.y,
+		world._43 - gWorldCameraPosition.z);
+	return D3DXVec3Length(&toObject);
 }
 
 // display debug info
@@ -352,8 +475,14 @@ void RenderInfo()
 	rct.top = 5;
 	rct.bottom = WIN_HEIGHT / 3;
 
-	// display debug key info
-	gpFont->DrawText(NULL, "Demo Framework\n\nESC: Exit", -1, &rct, 0, fontColor);
+	// display debug key info and what the shader variants cost so far
+	ShaderVariantStats stats = GetShaderVariantStats();
+	char info[256];
+	sprintf(info, "Demo Framework\n\n1: shadows %s\n2: PCF 3x3 %s\nESC: Exit\n\n"
+		"variants: %d of %d built, %.1f ms",
+		gWantedFeatures[0] ? "on" : "off", gWantedFeatures[1] ? "on" : "off",
+		stats.numBuilt, stats.numPossible, stats.compileMs);
+	gpFont->DrawText(NULL, info, -1, &rct, 0, fontColor);
 }
 
 //------------------------------------------------------------
@@ -367,24 +496,20 @@ bool InitEverything(HWND hWnd)
 		return false;
 	}
 
-	// create a render target
-	const int shadowMapSize = 2048;
-	if (FAILED(gpD3DDevice->CreateTexture(shadowMapSize, shadowMapSize,
-		1, D3DUSAGE_RENDERTARGET, D3DFMT_R32F,
-		D3DPOOL_DEFAULT, &gpShadowRenderTarget, NULL)))
+	// render targets are created by the frame graph when first drawn into
+	if (!InitFrameGraph(gpD3DDevice))
 	{
 		return false;
 	}
 
-	// also need to make a depthbuffer which has same size as shadow map
-	if (FAILED(gpD3DDevice->CreateDepthStencilSurface(shadowMapSize, shadowMapSize,
-		D3DFMT_D24X8, D3DMULTISAMPLE_NONE, 0, TRUE,
-		&gpShadowDepthStencil, NULL)))
+	// effect variants are compiled on a thread of their own
+	if (!InitShaderVariants(gpD3DDevice))
 	{
 		return false;
 	}
 
 	// loading models, shaders and textures
+	InitAssetRegistry();
 	if (!LoadAssets())
 	{
 		return false;
@@ -421,14 +546,14 @@ bool InitD3D(HWND hWnd)
 	d3dpp.BackBufferCount = 1;
 	d3dpp.MultiSampleType = D3DMULTISAMPLE_NONE;
 	d3dpp.MultiSampleQuality = 0;
-	d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	d3dpp.SwapEffect = gGoldenTest.enabled ? D3DSWAPEFFECT_COPY : D3DSWAPEFFECT_DISCARD;
 	d3dpp.hDeviceWindow = hWnd;
 	d3dpp.Windowed = TRUE;
 	d3dpp.EnableAutoDepthStencil = TRUE;
 	d3dpp.AutoDepthStencilFormat = D3DFMT_D24X8;
 	d3dpp.Flags = D3DPRESENTFLAG_DISCARD_DEPTHSTENCIL;
 	d3dpp.FullScreen_RefreshRateInHz = 0;
-	d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_ONE;
+	d3dpp.PresentationInterval = gBenchmark.enabled ? D3DPRESENT_INTERVAL_IMMEDIATE : D3DPRESENT_INTERVAL_ONE;
 
 	// create a D3D device
 	if (FAILED(gpD3D->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, hWnd,
@@ -445,8 +570,10 @@ bool LoadAssets()
 {
 	// loading textures
 
-	// loading shaders
-	gpApplyShadowShader = LoadShader("ApplyShadow.fx");
+	// loading shaders; the ApplyShadow variant the first frame draws
+	// with is built now, the others when asked for
+	gApplyShadowVariants = AddShaderVariants("ApplyShadow.fx", gApplyShadowFeatures, 2);
+	gpApplyShadowShader = LoadShaderVariant(gApplyShadowVariants, gDrawnFeatures);
 	if (!gpApplyShadowShader)
 	{
 		return false;
@@ -475,66 +602,21 @@ bool LoadAssets()
 	return true;
 }
 
-// loading shaders
+// loading shaders, models and textures, through the shared asset cache
+// (see ..\01_DxFramework\AssetLoaders.h)
 LPD3DXEFFECT LoadShader(const char * filename)
 {
-	LPD3DXEFFECT ret = NULL;
-
-	LPD3DXBUFFER pError = NULL;
-	DWORD dwShaderFlags = 0;
-
-#if _DEBUG
-	dwShaderFlags |= D3DXSHADER_DEBUG;
-#endif
-
-	D3DXCreateEffectFromFile(gpD3DDevice, filename,
-		NULL, NULL, dwShaderFlags, NULL, &ret, &pError);
-
-	// if failed at loading shaders, display compile error
-	// to output window
-	if (!ret && pError)
-	{
-		int size = pError->GetBufferSize();
-		void *ack = pError->GetBufferPointer();
-
-		if (ack)
-		{
-			char* str = new char[size];
-			sprintf(str, (const char*)ack, size);
-			OutputDebugString(str);
-			delete[] str;
-		}
-	}
-
-	return ret;
+	return LoadCachedEffect(gpD3DDevice, filename);
 }
 
-// loading models
 LPD3DXMESH LoadModel(const char * filename)
 {
-	LPD3DXMESH ret = NULL;
-	if (FAILED(D3DXLoadMeshFromX(filename, D3DXMESH_SYSTEMMEM, gpD3DDevice, NULL, NULL, NULL, NULL, &ret)))
-	{
-		OutputDebugString("failed at loading a model: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	};
-
-	return ret;
+	return LoadCachedMesh(gpD3DDevice, filename);
 }
 
-// loading textures
 LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 {
-	LPDIRECT3DTEXTURE9 ret = NULL;
-	if (FAILED(D3DXCreateTextureFromFile(gpD3DDevice, filename, &ret)))
-	{
-		OutputDebugString("failed at loading a texture: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	}
-
-	return ret;
+	return LoadCachedTexture(gpD3DDevice, filename, NULL);
 }
 //------------------------------------------------------------
 // cleanup code
@@ -542,6 +624,11 @@ LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 
 void Cleanup()
 {
+	// write the recorded frame times
+	ReleaseSimulationClock();
+
+	ReportAssetStats();
+
 	// release fonts
 	if (gpFont)
 	{
@@ -563,11 +650,8 @@ void Cleanup()
 	}
 
 	// release shaders
-	if (gpApplyShadowShader)
-	{
-		gpApplyShadowShader->Release();
-		gpApplyShadowShader = NULL;
-	}
+	ReleaseShaderVariants();
+	gpApplyShadowShader = NULL;
 
 	if (gpCreateShadowShader)
 	{
@@ -575,18 +659,14 @@ void Cleanup()
 		gpCreateShadowShader = NULL;
 	}
 
-	// release textures
-	if (gpShadowRenderTarget)
-	{
-		gpShadowRenderTarget->Release();
-		gpShadowRenderTarget = NULL;
-	}
+	// release render targets
+	ReleaseFrameGraph();
 
-	if (gpShadowDepthStencil)
-	{
-		gpShadowDepthStencil->Release();
-		gpShadowDepthStencil = NULL;
-	}
+	// release the draw queue
+	ReleaseDrawQueue();
+
+	// release the registry's references to shared assets
+	ReleaseAssetRegistry();
 
 	// release D3D
 	if (gpD3DDevice)
@@ -41,6 +41,10 @@ void Update();
 // Rendering related
 void RenderFrame();
 void RenderScene();
+void CreateShadowPass(void* data);
+void ApplyShadowPass(void* data);
+void SetShadowObject(LPD3DXEFFECT effect, const void* data);
+float GetCameraDistance(const D3DXMATRIXA16& world);
 void RenderInfo();
 
 // cleanup related
@@ -20,7 +20,6 @@
 //--------------------------------------------------------------//
 // Pass 0
 //--------------------------------------------------------------//
-string EnvironmentMapping_Pass_0_Model : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\Teapot.3ds";
 
 float4x4 gWorldMatrix : World;
 float4x4 gWorldViewProjectionMatrix : WorldViewProjection;
@@ -104,16 +103,6 @@ sampler2D SpecularSampler = sampler_state
 	MAGFILTER = LINEAR;
 	MINFILTER = LINEAR;
 };
-texture NormalMap_Tex
-<
-	string ResourceName = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Textures\\FieldstoneBumpDOT3.tga";
->;
-sampler2D NormalSampler = sampler_state
-{
-	Texture = (NormalMap_Tex);
-	MAGFILTER = LINEAR;
-	MINFILTER = LINEAR;
-};
 texture EnvironmentMap_Tex
 <
 	string ResourceName = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Textures\\Snow.dds";
@@ -136,9 +125,7 @@ float3 gLightColor
 
 float4 EnvironmentMapping_Pass_0_Pixel_Shader_ps_main(PS_INPUT Input) : COLOR
 {
-	float3 tangentNormal = tex2D(NormalSampler, Input.mUV).xyz;
-	tangentNormal = normalize(tangentNormal * 2 - 1);
-	tangentNormal = float3(0, 0, 1);
+	float3 tangentNormal = float3(0, 0, 1);
 
 	float3x3 TBN = float3x3(normalize(Input.T), normalize(Input.B), normalize(Input.N));
 	TBN = transpose(TBN);
@@ -20,7 +20,6 @@
 //--------------------------------------------------------------//
 // Grayscale
 //--------------------------------------------------------------//
-string ColorConversion_Grayscale_ScreenAlignedQuad : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\ScreenAlignedQuad.3ds";
 
 struct VS_INPUT
 {
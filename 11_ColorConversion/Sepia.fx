@@ -20,7 +20,6 @@
 //--------------------------------------------------------------//
 // Sepia
 //--------------------------------------------------------------//
-string ColorConversion_Sepia_ScreenAlignedQuad : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\ScreenAlignedQuad.3ds";
 
 struct VS_INPUT
 {
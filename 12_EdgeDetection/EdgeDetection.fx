@@ -20,7 +20,6 @@
 //--------------------------------------------------------------//
 // EdgeDetection
 //--------------------------------------------------------------//
-string EdgeDetection_EdgeDetection_ScreenAlignedQuad : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\ScreenAlignedQuad.3ds";
 
 struct VS_INPUT
 {
@@ -34,12 +33,16 @@ struct VS_OUTPUT
 	float2 mUV : TEXCOORD0;
 };
 
+// the part of the scene texture the scene covers, when the frame
+// graph's pool serves it with a larger surface
+float2 gUVScale : TextureScale = float2(1.0, 1.0);
+
 VS_OUTPUT EdgeDetection_EdgeDetection_Vertex_Shader_vs_main(VS_INPUT Input)
 {
 	VS_OUTPUT Output;
 
 	Output.mPosition = Input.mPosition;
-	Output.mUV = Input.mUV;
+	Output.mUV = Input.mUV * gUVScale;
 
 	return Output;
 }
@@ -20,7 +20,6 @@
 //--------------------------------------------------------------//
 // Sepia
 //--------------------------------------------------------------//
-string ColorConversion_Sepia_ScreenAlignedQuad : ModelData = "..\\..\\..\\..\\..\\..\\..\\..\\Program Files (x86)\\AMD\\RenderMonkey 1.82\\Examples\\Media\\Models\\ScreenAlignedQuad.3ds";
 
 struct VS_INPUT
 {
@@ -36,12 +35,16 @@ struct VS_OUTPUT
 };
 
 
+// the part of the scene texture the scene covers, when the frame
+// graph's pool serves it with a larger surface
+float2 gUVScale : TextureScale = float2(1.0, 1.0);
+
 VS_OUTPUT ColorConversion_Sepia_Vertex_Shader_vs_main(VS_INPUT Input)
 {
 	VS_OUTPUT Output;
 
 	Output.mPosition = Input.mPosition;
-	Output.mUV = Input.mUV;
+	Output.mUV = Input.mUV * gUVScale;
 
 	return Output;
 }
@@ -11,13 +11,21 @@
 //**********************************************************************
 
 #include "ShaderFramework.h"
+#include "../01_DxFramework/AssetLoaders.h"
+#include "../01_DxFramework/AssetRegistry.h"
+#include "../01_DxFramework/FrameBenchmark.h"
+#include "../01_DxFramework/FrameGraph.h"
+#include "../01_DxFramework/GoldenTest.h"
+#include "../01_DxFramework/SimulationClock.h"
 #include <stdio.h>
+#include <string.h>
 
 #define PI           3.14159265f
 #define FOV          (PI/4.0f)							// Field of View
 #define ASPECT_RATIO (WIN_WIDTH/(float)WIN_HEIGHT)		// aspect ratio of screen
 #define NEAR_PLANE   1									
 #define FAR_PLANE    10000								
+#define ROTATION_SPEED (24.0f * PI / 180.0f)			// radians per second
 
 
 //----------------------------------------------------------------------
@@ -45,7 +53,6 @@ LPD3DXEFFECT			gpEmboss = NULL;
 // Textures
 LPDIRECT3DTEXTURE9		gpStoneDM = NULL;
 LPDIRECT3DTEXTURE9		gpStoneSM = NULL;
-LPDIRECT3DTEXTURE9		gpStoneNM = NULL;
 LPDIRECT3DCUBETEXTURE9	gpSnowENV = NULL;
 
 // Application Name
@@ -53,6 +60,7 @@ const char*				gAppName = "Super Simple Shader Demo Framework";
 
 // Rotation around UP vector
 float					gRotationY = 0.0f;
+float					gPreviousRotationY = 0.0f;	// at the previous simulation step
 
 // world position of the light
 D3DXVECTOR4				gWorldLightPosition(500.0f, 500.0f, -500.0f, 1.0f);
@@ -68,8 +76,14 @@ LPDIRECT3DVERTEXDECLARATION9	gpFullscreenQuadDecl = NULL;
 LPDIRECT3DVERTEXBUFFER9			gpFullscreenQuadVB = NULL;
 LPDIRECT3DINDEXBUFFER9			gpFullscreenQuadIB = NULL;
 
-// scene render target
-LPDIRECT3DTEXTURE9		gpSceneRenderTarget = NULL;
+// what the passes of one frame draw with
+struct PostProcessFrame
+{
+	D3DXMATRIXA16 world;
+	D3DXMATRIXA16 worldViewProjection;
+	LPD3DXEFFECT postProcess;
+	FrameResource scene;
+};
 
 // index of postprocess shader to use
 int gPostProcessIndex = 0;
@@ -79,8 +93,15 @@ int gPostProcessIndex = 0;
 //-----------------------------------------------------------------------
 
 // entry point
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -benchmark and -golden run headless and quit
+	InitBenchmark(lpCmdLine);
+	InitGoldenTest(lpCmdLine);
+
+	// -record and -replay capture and play back frame times
+	InitSimulationClock(lpCmdLine, gBenchmark.enabled || gGoldenTest.enabled);
+
 	// register windows class
 	WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, MsgProc, 0L, 0L,
 		GetModuleHandle(NULL), NULL, NULL, NULL, NULL,
@@ -103,12 +124,22 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	ptDiff.y = (rcWindow.bottom - rcWindow.top) - rcClient.bottom;
 	MoveWindow(hWnd, rcWindow.left, rcWindow.top, WIN_WIDTH + ptDiff.x, WIN_HEIGHT + ptDiff.y, TRUE);
 
-	ShowWindow(hWnd, SW_SHOWDEFAULT);
+	ShowWindow(hWnd, (gBenchmark.enabled || gGoldenTest.enabled) ? SW_HIDE : SW_SHOWDEFAULT);
 	UpdateWindow(hWnd);
 
 	// Initialize everything including D3D
 	if (!InitEverything(hWnd))
 		PostQuitMessage(1);
+	else if (gBenchmark.enabled)
+	{
+		RunBenchmark(PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
+	else if (gGoldenTest.enabled)
+	{
+		RunGoldenTest(gpD3DDevice, PlayDemo);
+		PostMessage(hWnd, WM_DESTROY, 0L, 0L);
+	}
 
 	// Message Loop
 	MSG msg;
@@ -127,7 +158,7 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
 	}
 
 	UnregisterClass(gAppName, wc.hInstance);
-	return 0;
+	return GetGoldenTestExitCode();
 }
 
 // Message procedure
@@ -172,13 +203,27 @@ void ProcessInput(HWND hWnd, WPARAM keyPress)
 //------------------------------------------------------------
 void PlayDemo()
 {
-	Update();
+	// run as many fixed steps as the elapsed time covers
+	int numSteps = AdvanceSimulationClock();
+	for (int i = 0; i < numSteps; ++i)
+	{
+		Update();
+	}
 	RenderFrame();
 }
 
-// Game logic update
+// Game logic update, run once per simulation step
 void Update()
 {
+	// rotate 24 degrees per second
+	gPreviousRotationY = gRotationY;
+	gRotationY += ROTATION_SPEED * SIMULATION_TIMESTEP;
+	if (gRotationY > 2 * PI)
+	{
+		// wrap both, so interpolating between them stays smooth
+		gRotationY -= 2 * PI;
+		gPreviousRotationY -= 2 * PI;
+	}
 }
 
 //------------------------------------------------------------
@@ -205,24 +250,7 @@ void RenderFrame()
 // draw 3D objects and so on
 void RenderScene()
 {
-	/////////////////////////
-	// 1. draw the scene into the render target
-	/////////////////////////
-	// current hardware backbuffer
-	LPDIRECT3DSURFACE9 pHWBackBuffer = NULL;
-	gpD3DDevice->GetRenderTarget(0, &pHWBackBuffer);
-
-	// draw onto the render target
-	LPDIRECT3DSURFACE9 pSceneSurface = NULL;
-	if (SUCCEEDED(gpSceneRenderTarget->GetSurfaceLevel(0, &pSceneSurface)))
-	{
-		gpD3DDevice->SetRenderTarget(0, pSceneSurface);
-		pSceneSurface->Release();
-		pSceneSurface = NULL;
-	}
-
-	// clear what's drawn in the last frame
-	gpD3DDevice->Clear(0, NULL, D3DCLEAR_TARGET, 0xFF000000, 1.0f, 0);
+	PostProcessFrame frame;
 
 	// make the view matrix
 	D3DXMATRIXA16 matView;
@@ -235,26 +263,68 @@ void RenderScene()
 	D3DXMATRIXA16			matProjection;
 	D3DXMatrixPerspectiveFovLH(&matProjection, FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
 
-	// for each frame, we roate 0.4 degree
-	gRotationY += 0.4f * PI / 180.0f;
-	if (gRotationY > 2 * PI)
+	// interpolate between the last two simulation steps
+	float rotationY = gPreviousRotationY + (gRotationY - gPreviousRotationY) * GetSimulationAlpha();
+
+	// golden image tests render fixed rotations
+	if (gGoldenTest.enabled)
 	{
-		gRotationY -= 2 * PI;
+		rotationY = GetGoldenRotation();
 	}
 
 	// world matrix
-	D3DXMATRIXA16			matWorld;
-	D3DXMatrixRotationY(&matWorld, gRotationY);
+	D3DXMatrixRotationY(&frame.world, rotationY);
 
 	// concatenate world/view/projection matrices
 	D3DXMATRIXA16 matWorldView;
-	D3DXMATRIXA16 matWorldViewProjection;
-	D3DXMatrixMultiply(&matWorldView, &matWorld, &matView);
-	D3DXMatrixMultiply(&matWorldViewProjection, &matWorldView, &matProjection);
+	D3DXMatrixMultiply(&matWorldView, &frame.world, &matView);
+	D3DXMatrixMultiply(&frame.worldViewProjection, &matWorldView, &matProjection);
+
+	// post process effect to use
+	frame.postProcess = gpNoEffect;
+	if (gPostProcessIndex == 1)
+	{
+		frame.postProcess = gpGrayScale;
+	}
+	else if (gPostProcessIndex == 2)
+	{
+		frame.postProcess = gpSepia;
+	}
+	else if (gPostProcessIndex == 3)
+	{
+		frame.postProcess = gpEdgeDetection;
+	}
+	else if (gPostProcessIndex == 4)
+	{
+		frame.postProcess = gpEmboss;
+	}
+
+	// the scene target only lives between the two passes
+	BeginFrameGraph();
+	frame.scene = CreateFrameTarget("scene", WIN_WIDTH, WIN_HEIGHT, D3DFMT_X8R8G8B8);
+
+	int drawScene = AddFramePass("scene", DrawScenePass, &frame);
+	WriteFrameResource(drawScene, frame.scene);
+	WriteFrameResource(drawScene, FRAME_DEPTH_BUFFER);
+
+	int postProcess = AddFramePass("post process", PostProcessPass, &frame);
+	ReadFrameResource(postProcess, frame.scene);
+	WriteFrameResource(postProcess, FRAME_BACK_BUFFER);
+
+	ExecuteFrameGraph();
+}
+
+// 1. draw the scene into the render target
+void DrawScenePass(void* data)
+{
+	const PostProcessFrame* frame = (const PostProcessFrame*)data;
+
+	// clear what's drawn in the last frame
+	gpD3DDevice->Clear(0, NULL, D3DCLEAR_TARGET, 0xFF000000, 1.0f, 0);
 
 	// set shader global variables
-	gpEnvironmentMappingShader->SetMatrix("gWorldMatrix", &matWorld);
-	gpEnvironmentMappingShader->SetMatrix("gWorldViewProjectionMatrix", &matWorldViewProjection);
+	gpEnvironmentMappingShader->SetMatrix("gWorldMatrix", &frame->world);
+	gpEnvironmentMappingShader->SetMatrix("gWorldViewProjectionMatrix", &frame->worldViewProjection);
 
 	gpEnvironmentMappingShader->SetVector("gWorldLightPosition", &gWorldLightPosition);
 	gpEnvironmentMappingShader->SetVector("gWorldCameraPosition", &gWorldCameraPosition);
@@ -262,7 +332,6 @@ void RenderScene()
 	gpEnvironmentMappingShader->SetVector("gLightColor", &gLightColor);
 	gpEnvironmentMappingShader->SetTexture("DiffuseMap_Tex", gpStoneDM);
 	gpEnvironmentMappingShader->SetTexture("SpecularMap_Tex", gpStoneSM);
-	gpEnvironmentMappingShader->SetTexture("NormalMap_Tex", gpStoneNM);
 	gpEnvironmentMappingShader->SetTexture("EnvironmentMap_Tex", gpSnowENV);
 
 	// start a shader
@@ -280,42 +349,31 @@ void RenderScene()
 		}
 	}
 	gpEnvironmentMappingShader->End();
+}
 
+// 2. apply post-processing
+void PostProcessPass(void* data)
+{
+	const PostProcessFrame* frame = (const PostProcessFrame*)data;
+	LPD3DXEFFECT effectToUse = frame->postProcess;
 
-	/////////////////////////
-	// 2. apply post-processing
-	/////////////////////////
-	// use hardware backbuffer
-	gpD3DDevice->SetRenderTarget(0, pHWBackBuffer);
-	pHWBackBuffer->Release();
-	pHWBackBuffer = NULL;
+	// the pool may have given the scene a larger surface; the scene is
+	// at its top left, and a pixel is a texel of the whole surface
+	float uScale, vScale;
+	GetFrameTextureScale(frame->scene, &uScale, &vScale);
 
-	// post process effect to use
-	LPD3DXEFFECT effectToUse = gpNoEffect;
-	if (gPostProcessIndex == 1)
-	{
-		effectToUse = gpGrayScale;
-	}
-	else if (gPostProcessIndex == 2)
-	{
-		effectToUse = gpSepia;
-	}
-	else if (gPostProcessIndex == 3)
-	{
-		effectToUse = gpEdgeDetection;
-	}
-	else if (gPostProcessIndex == 4)
-	{
-		effectToUse = gpEmboss;
-	}
+	D3DXVECTOR4 uvScale(uScale, vScale, 0, 0);
+	effectToUse->SetVector("gUVScale", &uvScale);
 
-	D3DXVECTOR4 pixelOffset(1 / (float)WIN_WIDTH, 1 / (float)WIN_HEIGHT, 0, 0);
+	D3DXVECTOR4 pixelOffset(uScale / WIN_WIDTH, vScale / WIN_HEIGHT, 0, 0);
 	if (effectToUse == gpEdgeDetection || effectToUse == gpEmboss)
 	{
 		effectToUse->SetVector("gPixelOffset", &pixelOffset);
 	}
 
-	effectToUse->SetTexture("SceneTexture_Tex", gpSceneRenderTarget);
+	effectToUse->SetTexture("SceneTexture_Tex", GetFrameTexture(frame->scene));
+
+	UINT numPasses = 0;
 	effectToUse->Begin(&numPasses, NULL);
 	{
 		for (UINT i = 0; i < numPasses; ++i)
@@ -332,7 +390,6 @@ void RenderScene()
 		}
 	}
 	effectToUse->End();
-
 }
 
 // display debug info
@@ -366,15 +423,14 @@ bool InitEverything(HWND hWnd)
 	// create a fullscreen quad
 	InitFullScreenQuad();
 
-	// create a render target
-	if (FAILED(gpD3DDevice->CreateTexture(WIN_WIDTH, WIN_HEIGHT,
-		1, D3DUSAGE_RENDERTARGET, D3DFMT_X8R8G8B8,
-		D3DPOOL_DEFAULT, &gpSceneRenderTarget, NULL)))
+	// render targets are created by the frame graph when first drawn into
+	if (!InitFrameGraph(gpD3DDevice))
 	{
 		return false;
 	}
 
 	// loading models, shaders and textures
+	InitAssetRegistry();
 	if (!LoadAssets())
 	{
 		return false;
@@ -411,14 +467,14 @@ bool InitD3D(HWND hWnd)
 	d3dpp.BackBufferCount = 1;
 	d3dpp.MultiSampleType = D3DMULTISAMPLE_NONE;
 	d3dpp.MultiSampleQuality = 0;
-	d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	d3dpp.SwapEffect = gGoldenTest.enabled ? D3DSWAPEFFECT_COPY : D3DSWAPEFFECT_DISCARD;
 	d3dpp.hDeviceWindow = hWnd;
 	d3dpp.Windowed = TRUE;
 	d3dpp.EnableAutoDepthStencil = TRUE;
 	d3dpp.AutoDepthStencilFormat = D3DFMT_D24X8;
 	d3dpp.Flags = D3DPRESENTFLAG_DISCARD_DEPTHSTENCIL;
 	d3dpp.FullScreen_RefreshRateInHz = 0;
-	d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_ONE;
+	d3dpp.PresentationInterval = gBenchmark.enabled ? D3DPRESENT_INTERVAL_IMMEDIATE : D3DPRESENT_INTERVAL_ONE;
 
 	// create a D3D device
 	if (FAILED(gpD3D->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, hWnd,
@@ -446,12 +502,6 @@ bool LoadAssets()
 		return false;
 	}
 
-	gpStoneNM = LoadTexture("Fieldstone_NM.tga");
-	if (!gpStoneNM)
-	{
-		return false;
-	}
-
 	D3DXCreateCubeTextureFromFile(gpD3DDevice, "Snow_ENV.dds", &gpSnowENV);
 	if (!gpSnowENV)
 	{
@@ -505,66 +555,21 @@ bool LoadAssets()
 	return true;
 }
 
-// loading shaders
+// loading shaders, models and textures, through the shared asset cache
+// (see ..\01_DxFramework\AssetLoaders.h)
 LPD3DXEFFECT LoadShader(const char * filename)
 {
-	LPD3DXEFFECT ret = NULL;
-
-	LPD3DXBUFFER pError = NULL;
-	DWORD dwShaderFlags = 0;
-
-#if _DEBUG
-	dwShaderFlags |= D3DXSHADER_DEBUG;
-#endif
-
-	D3DXCreateEffectFromFile(gpD3DDevice, filename,
-		NULL, NULL, dwShaderFlags, NULL, &ret, &pError);
-
-	// if failed at loading shaders, display compile error
-	// to output window
-	if (!ret && pError)
-	{
-		int size = pError->GetBufferSize();
-		void *ack = pError->GetBufferPointer();
-
-		if (ack)
-		{
-			char* str = new char[size];
-			sprintf(str, (const char*)ack, size);
-			OutputDebugString(str);
-			delete[] str;
-		}
-	}
-
-	return ret;
+	return LoadCachedEffect(gpD3DDevice, filename);
 }
 
-// loading models
 LPD3DXMESH LoadModel(const char * filename)
 {
-	LPD3DXMESH ret = NULL;
-	if (FAILED(D3DXLoadMeshFromX(filename, D3DXMESH_SYSTEMMEM, gpD3DDevice, NULL, NULL, NULL, NULL, &ret)))
-	{
-		OutputDebugString("failed at loading a model: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	};
-
-	return ret;
+	return LoadCachedMesh(gpD3DDevice, filename);
 }
 
-// loading textures
 LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 {
-	LPDIRECT3DTEXTURE9 ret = NULL;
-	if (FAILED(D3DXCreateTextureFromFile(gpD3DDevice, filename, &ret)))
-	{
-		OutputDebugString("failed at loading a texture: ");
-		OutputDebugString(filename);
-		OutputDebugString("\n");
-	}
-
-	return ret;
+	return LoadCachedTexture(gpD3DDevice, filename, NULL);
 }
 //------------------------------------------------------------
 // cleanup code
@@ -572,6 +577,11 @@ LPDIRECT3DTEXTURE9 LoadTexture(const char * filename)
 
 void Cleanup()
 {
+	// write the recorded frame times
+	ReleaseSimulationClock();
+
+	ReportAssetStats();
+
 	// release fonts
 	if (gpFont)
 	{
@@ -635,12 +645,6 @@ void Cleanup()
 		gpStoneSM = NULL;
 	}
 
-	if (gpStoneNM)
-	{
-		gpStoneNM->Release();
-		gpStoneNM = NULL;
-	}
-
 	if (gpSnowENV)
 	{
 		gpSnowENV->Release();
@@ -666,12 +670,11 @@ void Cleanup()
 		gpFullscreenQuadIB = NULL;
 	}
 
-	// release the render target
-	if (gpSceneRenderTarget)
-	{
-		gpSceneRenderTarget->Release();
-		gpSceneRenderTarget = NULL;
-	}
+	// release the render targets
+	ReleaseFrameGraph();
+
+	// release the registry's references to shared assets
+	ReleaseAssetRegistry();
 
 	// release D3D
 	if (gpD3DDevice)
@@ -40,6 +40,8 @@ void Update();
 // Rendering related
 void RenderFrame();
 void RenderScene();
+void DrawScenePass(void* data);
+void PostProcessPass(void* data);
 void RenderInfo();
 
 // cleanup related
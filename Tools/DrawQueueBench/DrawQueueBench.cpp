@@ -0,0 +1,178 @@
+//**********************************************************************
+//
+// DrawQueueBench.cpp
+//
+// Counts the state changes of drawing a scene of mixed teapots and tori
+// (see DrawQueue.h) three ways:
+//
+//   per draw     every draw begins its effect and sets all its textures,
+//                as the samples' RenderScene functions do
+//   queued       the draw queue in the order the items were added
+//   sorted       the draw queue after sorting by key
+//
+// and times building the keys and sorting them. No device is needed:
+// StandIns holds a d3d9.h and d3dx9.h of its own, ahead of the SDK on
+// the include path, whose effects, textures and meshes do nothing, so
+// neither Windows nor the DirectX SDK is.
+//
+// usage: DrawQueueBench [-items 10000] [-effects 4] [-materials 8] [-reps 100]
+//
+// on Linux, from the repository root (one line):
+//   g++ -O2 -std=c++11 -ITools/DrawQueueBench/StandIns -I01_DxFramework -o DrawQueueBench
+//       Tools/DrawQueueBench/DrawQueueBench.cpp 01_DxFramework/DrawQueue.cpp
+//
+//**********************************************************************
+
+#include "DrawQueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define NUM_MESHES      2       // teapot and torus
+#define NUM_TEXTURES    2       // diffuse and normal map per material
+
+static const char* gTextureNames[NUM_TEXTURES] = { "DiffuseMap_Tex", "NormalMap_Tex" };
+
+#define MAX_EFFECTS     64
+#define MAX_MATERIALS   256
+
+// the objects; the queue only compares their addresses when counting
+static ID3DXEffect gEffects[MAX_EFFECTS];
+static IDirect3DBaseTexture9 gTextures[MAX_MATERIALS * NUM_TEXTURES];
+static ID3DXMesh gMeshes[NUM_MESHES];
+
+
+static double NowMs()
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the world matrix of every object differs
+static void SetObjectConstants(LPD3DXEFFECT, const void*)
+{
+}
+
+// the same scene for every run
+static void MakeScene(std::vector<DrawItem>& items, int numEffects, int numMaterials)
+{
+    srand(1234);
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        DrawItem& item = items[i];
+        memset(&item, 0, sizeof(item));
+
+        int material = rand() % numMaterials;
+        for (int t = 0; t < NUM_TEXTURES; ++t)
+        {
+            item.textureNames[t] = gTextureNames[t];
+            item.textures[t] = &gTextures[material * NUM_TEXTURES + t];
+        }
+
+        item.effect = &gEffects[rand() % numEffects];
+        item.mesh = &gMeshes[rand() % NUM_MESHES];
+        item.depth = 10.0f + (rand() % 10000) * 0.1f;
+        item.setup = SetObjectConstants;
+    }
+}
+
+static void PrintStats(const char* name, const DrawQueueStats& stats)
+{
+    int total = stats.effectChanges + stats.passChanges + stats.textureChanges + stats.commits;
+    printf("%-10s %8d %8d %8d %8d %8d %8d %9d\n", name, stats.draws, stats.effectChanges,
+        stats.passChanges, stats.textureChanges, stats.meshChanges, stats.commits, total);
+}
+
+int main(int argc, char** argv)
+{
+    int numItems = 10000;
+    int numEffects = 4;
+    int numMaterials = 8;
+    int reps = 100;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "-items") == 0 && hasValue)
+        {
+            numItems = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-effects") == 0 && hasValue)
+        {
+            numEffects = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-materials") == 0 && hasValue)
+        {
+            numMaterials = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-reps") == 0 && hasValue)
+        {
+            reps = atoi(argv[++i]);
+        }
+        else
+        {
+            printf("usage: DrawQueueBench [-items 10000] [-effects 4] [-materials 8] [-reps 100]\n");
+            return 1;
+        }
+    }
+
+    numEffects = (numEffects < 1) ? 1 : (numEffects > MAX_EFFECTS) ? MAX_EFFECTS : numEffects;
+    numMaterials = (numMaterials < 1) ? 1 : (numMaterials > MAX_MATERIALS) ? MAX_MATERIALS : numMaterials;
+    numItems = (numItems < 1) ? 1 : numItems;
+
+    std::vector<DrawItem> items(numItems);
+    MakeScene(items, numEffects, numMaterials);
+
+    printf("%d teapots and tori, %d effects, %d materials\n\n", numItems, numEffects, numMaterials);
+    printf("%-10s %8s %8s %8s %8s %8s %8s %9s\n", "", "draws", "effects", "passes", "textures", "meshes", "commits", "changes");
+
+    // what beginning the effect for every draw costs
+    DrawQueueStats perDraw;
+    memset(&perDraw, 0, sizeof(perDraw));
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        ++perDraw.draws;
+        ++perDraw.effectChanges;
+        ++perDraw.passChanges;
+        perDraw.textureChanges += NUM_TEXTURES;
+        perDraw.meshChanges += (i == 0 || items[i].mesh != items[i - 1].mesh) ? 1 : 0;
+    }
+    PrintStats("per draw", perDraw);
+
+    ClearDrawQueue();
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        AddDrawItem(items[i]);
+    }
+    PrintStats("queued", CountDrawQueueChanges());
+
+    SortDrawQueue();
+    PrintStats("sorted", CountDrawQueueChanges());
+
+    // best of reps
+    double bestAddMs = 1e30;
+    double bestSortMs = 1e30;
+    for (int r = 0; r < reps; ++r)
+    {
+        double start = NowMs();
+        ClearDrawQueue();
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            AddDrawItem(items[i]);
+        }
+        double added = NowMs();
+        SortDrawQueue();
+        double sorted = NowMs();
+
+        bestAddMs = (added - start < bestAddMs) ? added - start : bestAddMs;
+        bestSortMs = (sorted - added < bestSortMs) ? sorted - added : bestSortMs;
+    }
+
+    printf("\nkeys %.3f ms, sort %.3f ms per frame (best of %d)\n", bestAddMs, bestSortMs, reps);
+
+    ReleaseDrawQueue();
+    return 0;
+}
@@ -0,0 +1,23 @@
+//**********************************************************************
+//
+// d3d9.h
+//
+// DrawQueueBench's stand-in for the DirectX SDK header: only what
+// DrawQueue.h and DrawQueue.cpp use, and textures that do nothing. On
+// the bench's include path ahead of the SDK, so the draw queue builds
+// unchanged without Windows or the SDK.
+//
+//**********************************************************************
+
+
+#pragma once
+
+typedef unsigned int UINT;
+typedef unsigned long DWORD;
+
+// the queue only compares their addresses
+struct IDirect3DBaseTexture9
+{
+};
+
+typedef IDirect3DBaseTexture9* LPDIRECT3DBASETEXTURE9;
@@ -0,0 +1,33 @@
+//**********************************************************************
+//
+// d3dx9.h
+//
+// DrawQueueBench's stand-in for the DirectX SDK header: effects and
+// meshes whose calls do nothing (see d3d9.h here).
+//
+//**********************************************************************
+
+
+#pragma once
+
+#include "d3d9.h"
+
+typedef const char* D3DXHANDLE;
+
+struct ID3DXEffect
+{
+    void Begin(UINT* numPasses, DWORD) { *numPasses = 1; }
+    void BeginPass(UINT) {}
+    void SetTexture(D3DXHANDLE, LPDIRECT3DBASETEXTURE9) {}
+    void CommitChanges() {}
+    void EndPass() {}
+    void End() {}
+};
+
+struct ID3DXMesh
+{
+    void DrawSubset(DWORD) {}
+};
+
+typedef ID3DXEffect* LPD3DXEFFECT;
+typedef ID3DXMesh* LPD3DXMESH;
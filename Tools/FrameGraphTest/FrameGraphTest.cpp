@@ -0,0 +1,356 @@
+//**********************************************************************
+//
+// FrameGraphTest.cpp
+//
+// Checks what the frame graph (see FrameGraph.h) does with a graph the
+// samples are too small to show: a bloom-like post chain of six passes
+//
+//   scene      writes scene (full size, A16B16G16R16F) and the depth buffer
+//   debug      reads scene, writes debug (full size, A8R8G8B8); unused
+//   bright     reads scene, writes bright (half size)
+//   blurH      reads bright, writes blurH (half size)
+//   blurV      reads blurH, writes blurV (half size)
+//   composite  reads scene and blurV, writes the back buffer
+//
+// and prints, for every pass, whether it ran and the surface it drew
+// into, then the render target memory the graph used against one
+// surface per declared target. The passes draw nothing; they only note
+// what the graph bound. It fails unless the debug pass is culled and
+// blurV is given bright's surface, bright being done by then.
+//
+// -resize runs the same graph for 300 frames instead, the way a window
+// being dragged smaller and then maximized asks for it: 800x600 down to
+// 651x488 a pixel a frame, then 950x712. Shrinking must be served by the
+// targets already there and the jump must allocate only what does not
+// fit in them: 3 targets at the start, 2 at the jump, and the 2 the jump
+// left too small freed once they have been idle long enough.
+//
+// A device is created on a hidden window, so the surfaces are real.
+//
+// usage: FrameGraphTest [-resize]
+//
+//**********************************************************************
+
+#include "FrameGraph.h"
+#include "RenderTargetPool.h"
+#include <windows.h>
+#include <d3d9.h>
+#include <stdio.h>
+#include <string.h>
+
+#define WIN_WIDTH       800
+#define WIN_HEIGHT      600
+#define MAX_SURFACES    16
+
+// the resize test's
+#define RESIZE_FRAMES           300
+#define RESIZE_SHRINK_FRAMES    150     // then the jump
+#define RESIZE_WIDTH            950
+#define RESIZE_HEIGHT           712
+
+// what the graph bound for one pass
+struct PassRecord
+{
+    const char* name;
+    bool ran;
+    LPDIRECT3DSURFACE9 surface;     // render target 0
+};
+
+enum TestPass
+{
+    PASS_SCENE,
+    PASS_DEBUG,
+    PASS_BRIGHT,
+    PASS_BLUR_H,
+    PASS_BLUR_V,
+    PASS_COMPOSITE,
+    NUM_TEST_PASSES
+};
+
+static LPDIRECT3D9 gpD3D = NULL;
+static LPDIRECT3DDEVICE9 gpD3DDevice = NULL;
+static HWND gWindow = NULL;
+
+static PassRecord gPasses[NUM_TEST_PASSES] =
+{
+    { "scene", false, NULL },
+    { "debug", false, NULL },
+    { "bright", false, NULL },
+    { "blurH", false, NULL },
+    { "blurV", false, NULL },
+    { "composite", false, NULL }
+};
+
+// surfaces in the order they were first seen, to number them
+static LPDIRECT3DSURFACE9 gSurfaces[MAX_SURFACES];
+static int gNumSurfaces = 0;
+
+
+//----------------------------------------------------------------------
+// device
+//----------------------------------------------------------------------
+
+static bool InitDevice()
+{
+    gWindow = CreateWindow("STATIC", "FrameGraphTest", WS_OVERLAPPED, 0, 0, WIN_WIDTH, WIN_HEIGHT,
+        NULL, NULL, GetModuleHandle(NULL), NULL);
+    gpD3D = Direct3DCreate9(D3D_SDK_VERSION);
+    if (!gWindow || !gpD3D)
+    {
+        return false;
+    }
+
+    D3DPRESENT_PARAMETERS d3dpp;
+    ZeroMemory(&d3dpp, sizeof(d3dpp));
+    d3dpp.BackBufferWidth = WIN_WIDTH;
+    d3dpp.BackBufferHeight = WIN_HEIGHT;
+    d3dpp.BackBufferFormat = D3DFMT_X8R8G8B8;
+    d3dpp.BackBufferCount = 1;
+    d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+    d3dpp.hDeviceWindow = gWindow;
+    d3dpp.Windowed = TRUE;
+    d3dpp.EnableAutoDepthStencil = TRUE;
+    d3dpp.AutoDepthStencilFormat = D3DFMT_D24X8;
+    d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_IMMEDIATE;
+
+    return SUCCEEDED(gpD3D->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, gWindow,
+        D3DCREATE_SOFTWARE_VERTEXPROCESSING, &d3dpp, &gpD3DDevice));
+}
+
+static void ReleaseDevice()
+{
+    if (gpD3DDevice)
+    {
+        gpD3DDevice->Release();
+        gpD3DDevice = NULL;
+    }
+
+    if (gpD3D)
+    {
+        gpD3D->Release();
+        gpD3D = NULL;
+    }
+
+    if (gWindow)
+    {
+        DestroyWindow(gWindow);
+        gWindow = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// passes
+//----------------------------------------------------------------------
+
+static void RecordPass(void* data)
+{
+    PassRecord* record = (PassRecord*)data;
+    record->ran = true;
+
+    // the graph still holds the surface, so the reference can go at once
+    gpD3DDevice->GetRenderTarget(0, &record->surface);
+    record->surface->Release();
+}
+
+// 1 for the back buffer, 2... for the graph's surfaces
+static int GetSurfaceNumber(LPDIRECT3DSURFACE9 surface)
+{
+    for (int i = 0; i < gNumSurfaces; ++i)
+    {
+        if (gSurfaces[i] == surface)
+        {
+            return i + 1;
+        }
+    }
+
+    if (gNumSurfaces == MAX_SURFACES)
+    {
+        return 0;
+    }
+    gSurfaces[gNumSurfaces++] = surface;
+    return gNumSurfaces;
+}
+
+//----------------------------------------------------------------------
+// test
+//----------------------------------------------------------------------
+
+// declares the six passes for a width x height frame and runs them
+static bool ExecuteTestGraph(UINT width, UINT height)
+{
+    BeginFrameGraph();
+
+    FrameResource scene = CreateFrameTarget("scene", width, height, D3DFMT_A16B16G16R16F);
+    FrameResource debug = CreateFrameTarget("debug", width, height, D3DFMT_A8R8G8B8);
+    FrameResource bright = CreateFrameTarget("bright", width / 2, height / 2, D3DFMT_A16B16G16R16F);
+    FrameResource blurH = CreateFrameTarget("blurH", width / 2, height / 2, D3DFMT_A16B16G16R16F);
+    FrameResource blurV = CreateFrameTarget("blurV", width / 2, height / 2, D3DFMT_A16B16G16R16F);
+
+    int pass = AddFramePass("scene", RecordPass, &gPasses[PASS_SCENE]);
+    WriteFrameResource(pass, scene);
+    WriteFrameResource(pass, FRAME_DEPTH_BUFFER);
+
+    pass = AddFramePass("debug", RecordPass, &gPasses[PASS_DEBUG]);
+    ReadFrameResource(pass, scene);
+    WriteFrameResource(pass, debug);
+
+    pass = AddFramePass("bright", RecordPass, &gPasses[PASS_BRIGHT]);
+    ReadFrameResource(pass, scene);
+    WriteFrameResource(pass, bright);
+
+    pass = AddFramePass("blurH", RecordPass, &gPasses[PASS_BLUR_H]);
+    ReadFrameResource(pass, bright);
+    WriteFrameResource(pass, blurH);
+
+    pass = AddFramePass("blurV", RecordPass, &gPasses[PASS_BLUR_V]);
+    ReadFrameResource(pass, blurH);
+    WriteFrameResource(pass, blurV);
+
+    pass = AddFramePass("composite", RecordPass, &gPasses[PASS_COMPOSITE]);
+    ReadFrameResource(pass, scene);
+    ReadFrameResource(pass, blurV);
+    WriteFrameResource(pass, FRAME_BACK_BUFFER);
+
+    return ExecuteFrameGraph();
+}
+
+static bool RunAliasingTest()
+{
+    UINT width = WIN_WIDTH;
+    UINT height = WIN_HEIGHT;
+
+    // the back buffer is surface 1
+    LPDIRECT3DSURFACE9 backBuffer = NULL;
+    gpD3DDevice->GetRenderTarget(0, &backBuffer);
+    GetSurfaceNumber(backBuffer);
+    backBuffer->Release();
+
+    if (!ExecuteTestGraph(width, height))
+    {
+        printf("failed at allocating the render targets\n");
+        return false;
+    }
+
+    printf("%-10s %5s %8s\n", "pass", "ran", "surface");
+    for (int i = 0; i < NUM_TEST_PASSES; ++i)
+    {
+        const PassRecord& record = gPasses[i];
+        if (record.ran)
+        {
+            printf("%-10s %5s %8d\n", record.name, "yes", GetSurfaceNumber(record.surface));
+        }
+        else
+        {
+            printf("%-10s %5s %8s\n", record.name, "no", "-");
+        }
+    }
+
+    UINT declaredBytes = GetRenderTargetBytes(width, height, D3DFMT_A16B16G16R16F) +
+        GetRenderTargetBytes(width, height, D3DFMT_A8R8G8B8) +
+        3 * GetRenderTargetBytes(width / 2, height / 2, D3DFMT_A16B16G16R16F);
+    RenderTargetPoolStats stats = GetRenderTargetPoolStats();
+
+    printf("\nrender targets %u KB in %d surfaces, %u KB if each had its own\n",
+        stats.peakBytesResident / 1024, stats.numTargets, declaredBytes / 1024);
+
+    bool succeeded = true;
+    if (gPasses[PASS_DEBUG].ran)
+    {
+        printf("FAILED: the debug pass, which nothing reads, was run\n");
+        succeeded = false;
+    }
+    if (!gPasses[PASS_BRIGHT].ran || !gPasses[PASS_BLUR_V].ran ||
+        gPasses[PASS_BLUR_V].surface != gPasses[PASS_BRIGHT].surface)
+    {
+        printf("FAILED: blurV was not given bright's surface\n");
+        succeeded = false;
+    }
+
+    return succeeded;
+}
+
+static bool RunResizeTest()
+{
+    printf("%-6s %9s %7s %6s %6s %8s\n", "frame", "size", "targets", "hits", "misses", "freed");
+
+    RenderTargetPoolStats last;
+    memset(&last, 0, sizeof(last));
+    for (int frame = 0; frame < RESIZE_FRAMES; ++frame)
+    {
+        UINT width = RESIZE_WIDTH;
+        UINT height = RESIZE_HEIGHT;
+        if (frame < RESIZE_SHRINK_FRAMES)
+        {
+            width = WIN_WIDTH - frame;
+            height = width * 3 / 4;
+        }
+
+        if (!ExecuteTestGraph(width, height))
+        {
+            printf("failed at allocating the render targets at frame %d\n", frame);
+            return false;
+        }
+
+        // a line for every frame the pool changed in
+        RenderTargetPoolStats stats = GetRenderTargetPoolStats();
+        if (frame == 0 || stats.misses != last.misses || stats.freed != last.freed)
+        {
+            printf("%-6d %4ux%-4u %7d %6lld %6lld %8lld\n", frame, width, height,
+                stats.numTargets, stats.hits, stats.misses, stats.freed);
+        }
+        last = stats;
+    }
+
+    printf("\nrender targets: %lld requests served from the pool, %lld allocated, %lld freed, "
+        "%u KB at most\n", last.hits, last.misses, last.freed, last.peakBytesResident / 1024);
+
+    bool succeeded = true;
+    if (last.misses != 5)
+    {
+        printf("FAILED: %lld targets allocated, not 3 at the start and 2 at the jump\n", last.misses);
+        succeeded = false;
+    }
+    if (last.freed != 2)
+    {
+        printf("FAILED: %lld targets freed, not the 2 the jump left too small\n", last.freed);
+        succeeded = false;
+    }
+
+    return succeeded;
+}
+
+//----------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    bool resize = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-resize") == 0)
+        {
+            resize = true;
+        }
+        else
+        {
+            printf("usage: FrameGraphTest [-resize]\n");
+            return 1;
+        }
+    }
+
+    if (!InitDevice() || !InitFrameGraph(gpD3DDevice))
+    {
+        printf("failed at creating a device\n");
+        ReleaseDevice();
+        return 1;
+    }
+
+    bool succeeded = resize ? RunResizeTest() : RunAliasingTest();
+    printf("%s\n", succeeded ? "ok" : "FAILED");
+
+    ReleaseFrameGraph();
+    ReleaseDevice();
+
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,498 @@
+//**********************************************************************
+//
+// FxBench.cpp
+//
+// Runs the vertex and pixel shaders of the samples' effects on the CPU
+// (see ShaderInterpreter.h) and reports how many vertices or pixels per
+// second each one gets through on one thread.
+//
+// The inputs are random, except that positions have w = 1 and texture
+// coordinates walk the texture row by row, as a rasterizer would; the
+// matrices left at zero by the effect are set to identity and every
+// sampler gets a generated 256 x 256 texture. The numbers are for
+// comparing effects and the interpreter against itself, not for what a
+// frame costs.
+//
+// A shader FxKernel translated to C++ (ShaderKernels.cpp) is run on the
+// same inputs too; its rate, speedup over the interpreter and largest
+// difference from the interpreter's outputs are reported, and outputs
+// further off than KERNEL_TOLERANCE fail the run.
+//
+// usage: FxBench [-items 65536] [-reps 5] [-d] file.fx ...
+//        FxBench [-items 65536] [-reps 5] [-d] -root ..\..
+//
+//        -d   also prints each shader's bytecode
+//
+//**********************************************************************
+
+#include "ShaderInterpreter.h"
+#include <windows.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define TEXTURE_SIZE 256
+
+// largest difference allowed between a kernel and the interpreter,
+// relative for values above 1; they differ only in rounding
+#define KERNEL_TOLERANCE 1e-4f
+
+static const char* gSamples[] =
+{
+    "01_DxFramework",
+    "02_ColorShader",
+    "03_TextureMapping",
+    "04_Lighting",
+    "05_DiffuseSpecularMapping",
+    "06_ToonShader",
+    "07_NormalMapping",
+    "08_EnvironmentMapping",
+    "09_UVAnimation",
+    "10_ShadowMapping",
+    "11_ColorConversion",
+    "12_EdgeDetection"
+};
+
+#define NUM_SAMPLES (sizeof(gSamples) / sizeof(gSamples[0]))
+
+struct BenchOptions
+{
+    int items;
+    int reps;
+    bool disassemble;
+};
+
+// in ShaderKernels.cpp, written by FxKernel
+extern const ShaderKernel gShaderKernels[];
+extern const int gNumShaderKernels;
+
+static std::vector<float> gTexels;
+static std::vector<float> gCubeTexels;
+static ShaderTexture gTexture;
+static ShaderTexture gCubeTexture;
+
+
+static double NowMs()
+{
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+
+    return now.QuadPart * 1000.0 / frequency.QuadPart;
+}
+
+static float RandomFloat(float low, float high)
+{
+    return low + (high - low) * (float)rand() / (float)RAND_MAX;
+}
+
+//----------------------------------------------------------------------
+// inputs
+//----------------------------------------------------------------------
+
+// smooth gradients with a little noise, so neighbouring texels differ
+static void FillTexels(float* texels, int faces)
+{
+    for (int f = 0; f < faces; ++f)
+    {
+        for (int y = 0; y < TEXTURE_SIZE; ++y)
+        {
+            for (int x = 0; x < TEXTURE_SIZE; ++x)
+            {
+                float* texel = texels + ((f * TEXTURE_SIZE + y) * TEXTURE_SIZE + x) * 4;
+                texel[0] = (float)x / TEXTURE_SIZE;
+                texel[1] = (float)y / TEXTURE_SIZE;
+                texel[2] = (float)(f + 1) / faces * RandomFloat(0.8f, 1.0f);
+                texel[3] = 1.0f;
+            }
+        }
+    }
+}
+
+static void CreateTextures()
+{
+    gTexels.resize(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    gCubeTexels.resize(TEXTURE_SIZE * TEXTURE_SIZE * 4 * 6);
+    FillTexels(&gTexels[0], 1);
+    FillTexels(&gCubeTexels[0], 6);
+
+    gTexture.width = TEXTURE_SIZE;
+    gTexture.height = TEXTURE_SIZE;
+    gTexture.cube = false;
+    gTexture.texels = &gTexels[0];
+
+    gCubeTexture = gTexture;
+    gCubeTexture.cube = true;
+    gCubeTexture.texels = &gCubeTexels[0];
+}
+
+// one row of items floats per input component, as RunShader takes them
+static void FillInputs(const ShaderProgram& program, int items, std::vector<float>* inputs)
+{
+    inputs->resize(program.inputRegisters.size() * items);
+
+    float* row = inputs->empty() ? NULL : &(*inputs)[0];
+    for (size_t i = 0; i < program.inputs.size(); ++i)
+    {
+        const ShaderVariable& input = program.inputs[i];
+        bool position = _strnicmp(input.semantic.c_str(), "POSITION", 8) == 0;
+        bool texcoord = _strnicmp(input.semantic.c_str(), "TEXCOORD", 8) == 0;
+
+        for (size_t c = 0; c < input.registers.size(); ++c)
+        {
+            for (int n = 0; n < items; ++n)
+            {
+                if (position && c == 3)
+                {
+                    row[n] = 1.0f;
+                }
+                else if (texcoord && c == 0)
+                {
+                    row[n] = (n % TEXTURE_SIZE + 0.5f) / TEXTURE_SIZE;
+                }
+                else if (texcoord && c == 1)
+                {
+                    row[n] = (n / TEXTURE_SIZE % TEXTURE_SIZE + 0.5f) / TEXTURE_SIZE;
+                }
+                else
+                {
+                    row[n] = RandomFloat(-1.0f, 1.0f);
+                }
+            }
+            row += items;
+        }
+    }
+}
+
+// the uniforms' initial values, except that matrices left at zero, for
+// the application to set, are identity
+static void GetUniformValues(const ShaderProgram& program, std::vector<std::vector<float> >* values)
+{
+    values->resize(program.uniforms.size());
+    for (size_t i = 0; i < program.uniforms.size(); ++i)
+    {
+        const ShaderVariable& uniform = program.uniforms[i];
+        std::vector<float>& value = (*values)[i];
+        value = uniform.values;
+        if (uniform.rows < 2 || uniform.rows != uniform.columns)
+        {
+            continue;
+        }
+
+        bool zero = true;
+        for (size_t v = 0; v < value.size(); ++v)
+        {
+            zero = zero && (value[v] == 0.0f);
+        }
+        for (int r = 0; r < uniform.rows && zero; ++r)
+        {
+            value[r * uniform.columns + r] = 1.0f;
+        }
+    }
+}
+
+static const ShaderKernel* FindKernel(const std::string& effect, const std::string& function)
+{
+    for (int i = 0; i < gNumShaderKernels; ++i)
+    {
+        if (gShaderKernels[i].function && effect == gShaderKernels[i].effect &&
+            function == gShaderKernels[i].function)
+        {
+            return &gShaderKernels[i];
+        }
+    }
+    return NULL;
+}
+
+// the sample folder and file, e.g. 12_EdgeDetection/Sepia.fx, as the
+// kernel table names them
+static std::string EffectName(const std::string& filename)
+{
+    std::string name = filename;
+    std::replace(name.begin(), name.end(), '\\', '/');
+    size_t file = name.rfind('/');
+    size_t folder = (file == std::string::npos || file == 0) ? std::string::npos : name.rfind('/', file - 1);
+    return (folder == std::string::npos) ? name : name.substr(folder + 1);
+}
+
+//----------------------------------------------------------------------
+// benchmark
+//----------------------------------------------------------------------
+
+struct BenchResult
+{
+    double interpreted;         // millions of items a second
+    double kernel;              // 0 without a kernel
+    float error;                // largest difference, relative above 1
+};
+
+// best of reps, in milliseconds
+static double TimeInterpreter(ShaderContext* context, const float* inputs, float* outputs, int items, int reps)
+{
+    double best = 1e30;
+    for (int rep = 0; rep < reps; ++rep)
+    {
+        double start = NowMs();
+        RunShader(context, inputs, outputs, items);
+        double elapsed = NowMs() - start;
+        best = (elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+static double TimeKernel(const ShaderKernel& kernel, const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int items, int reps)
+{
+    double best = 1e30;
+    for (int rep = 0; rep < reps; ++rep)
+    {
+        double start = NowMs();
+        kernel.run(uniforms, textures, inputs, outputs, items);
+        double elapsed = NowMs() - start;
+        best = (elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+// runs the kernel on the same uniforms, textures and inputs as the
+// interpreter, and how far its outputs are from the interpreter's
+static bool BenchKernel(const ShaderKernel& kernel, const ShaderProgram& program,
+    const std::vector<std::vector<float> >& uniformValues, const float* inputs,
+    const std::vector<float>& expected, const BenchOptions& options, BenchResult* result)
+{
+    if (kernel.inputCount != (int)program.inputRegisters.size() ||
+        kernel.outputCount != (int)program.outputRegisters.size())
+    {
+        return false;
+    }
+
+    std::vector<float> uniforms;
+    for (int i = 0; kernel.uniforms[i]; ++i)
+    {
+        size_t u = 0;
+        while (u < program.uniforms.size() && program.uniforms[u].name != kernel.uniforms[i])
+        {
+            ++u;
+        }
+        if (u == program.uniforms.size())
+        {
+            return false;
+        }
+        uniforms.insert(uniforms.end(), uniformValues[u].begin(), uniformValues[u].end());
+    }
+
+    std::vector<const ShaderTexture*> textures;
+    for (int i = 0; kernel.samplers[i]; ++i)
+    {
+        size_t s = 0;
+        while (s < program.samplers.size() && program.samplers[s].name != kernel.samplers[i])
+        {
+            ++s;
+        }
+        textures.push_back((s < program.samplers.size() && program.samplers[s].cube) ? &gCubeTexture : &gTexture);
+    }
+    textures.push_back(NULL);
+
+    std::vector<float> outputs(expected.size());
+    double best = TimeKernel(kernel, uniforms.empty() ? NULL : &uniforms[0], &textures[0], inputs, &outputs[0],
+        options.items, options.reps);
+    result->kernel = options.items / (best * 1000.0 + 1e-9);
+
+    result->error = 0.0f;
+    for (size_t i = 0; i + 1 < outputs.size(); ++i)
+    {
+        float difference = fabsf(outputs[i] - expected[i]) / ((fabsf(expected[i]) > 1.0f) ? fabsf(expected[i]) : 1.0f);
+        result->error = (difference > result->error || difference != difference) ? difference : result->error;
+    }
+    return true;
+}
+
+// false if it does not compile; the kernel is run too if there is one
+static bool BenchShader(const EffectSource& effect, const Function& function, const ShaderKernel* kernel,
+    const BenchOptions& options, ShaderProgram* program, BenchResult* result)
+{
+    if (!CompileShader(effect, function, program))
+    {
+        return false;
+    }
+
+    ShaderContext context;
+    if (!CreateShaderContext(*program, &context))
+    {
+        program->error = "out of memory";
+        return false;
+    }
+
+    std::vector<std::vector<float> > uniformValues;
+    GetUniformValues(*program, &uniformValues);
+    for (size_t i = 0; i < program->uniforms.size(); ++i)
+    {
+        const std::vector<float>& values = uniformValues[i];
+        SetShaderUniform(&context, program->uniforms[i].name.c_str(), &values[0], (int)values.size());
+    }
+    for (size_t i = 0; i < program->samplers.size(); ++i)
+    {
+        const ShaderSampler& sampler = program->samplers[i];
+        SetShaderTexture(&context, sampler.name.c_str(), sampler.cube ? &gCubeTexture : &gTexture);
+    }
+
+    std::vector<float> inputs;
+    FillInputs(*program, options.items, &inputs);
+    std::vector<float> outputs(program->outputRegisters.size() * options.items + 1);
+
+    const float* in = inputs.empty() ? NULL : &inputs[0];
+    double best = TimeInterpreter(&context, in, &outputs[0], options.items, options.reps);
+    result->interpreted = options.items / (best * 1000.0 + 1e-9);
+
+    ReleaseShaderContext(&context);
+
+    result->kernel = 0.0;
+    result->error = 0.0f;
+    if (kernel && !BenchKernel(*kernel, *program, uniformValues, in, outputs, options, result))
+    {
+        program->error = "the kernel does not match the shader; run FxKernel again";
+        return false;
+    }
+    return true;
+}
+
+// false if a shader could not be read or compiled
+static bool BenchFile(const char* filename, const BenchOptions& options)
+{
+    EffectSource effect;
+    if (!LoadEffectSource(filename, &effect))
+    {
+        printf("%s: cannot read\n", filename);
+        return false;
+    }
+
+    printf("%s\n", filename);
+
+    bool succeeded = true;
+    std::string lastPass;
+    for (size_t u = 0; u < effect.shaders.size(); ++u)
+    {
+        const ShaderUse& use = effect.shaders[u];
+        std::string pass = use.technique + " / " + use.pass;
+        if (pass != lastPass)
+        {
+            printf("  %s\n", pass.c_str());
+            lastPass = pass;
+        }
+
+        const Function* function = FindEffectFunction(effect, use.function);
+        if (!function)
+        {
+            printf("    %s  %s not found\n", use.stage.c_str(), use.function.c_str());
+            succeeded = false;
+            continue;
+        }
+
+        ShaderProgram program;
+        BenchResult result;
+        const ShaderKernel* kernel = FindKernel(EffectName(filename), use.function);
+        if (!BenchShader(effect, *function, kernel, options, &program, &result))
+        {
+            printf("    %s  %s: %s\n", use.stage.c_str(), use.function.c_str(), program.error.c_str());
+            succeeded = false;
+            continue;
+        }
+
+        const char* unit = (use.stage == "vs") ? "Mverts/s" : "Mpixels/s";
+        printf("    %s  %4d instructions %4d registers %9.2f %s", use.stage.c_str(),
+            (int)program.code.size(), program.registerCount, result.interpreted, unit);
+        if (kernel)
+        {
+            bool matches = result.error <= KERNEL_TOLERANCE;
+            printf("%*s  kernel %9.2f %-9s %6.1fx  error %.1e%s", 9 - (int)strlen(unit), "", result.kernel, unit,
+                result.kernel / result.interpreted, result.error, matches ? "" : "  MISMATCH");
+            succeeded = succeeded && matches;
+        }
+        printf("\n");
+        if (options.disassemble)
+        {
+            printf("%s", DisassembleShader(program).c_str());
+        }
+    }
+
+    ReleaseEffectSource(&effect);
+
+    return succeeded;
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    options.items = 65536;
+    options.reps = 5;
+    options.disassemble = false;
+
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-items") == 0 && i + 1 < argc)
+        {
+            options.items = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-reps") == 0 && i + 1 < argc)
+        {
+            options.reps = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-d") == 0)
+        {
+            options.disassemble = true;
+        }
+        else if (strcmp(argv[i], "-root") == 0 && i + 1 < argc)
+        {
+            const char* root = argv[++i];
+            for (size_t s = 0; s < NUM_SAMPLES; ++s)
+            {
+                char pattern[MAX_PATH];
+                _snprintf(pattern, MAX_PATH, "%s\\%s\\*.fx", root, gSamples[s]);
+
+                WIN32_FIND_DATA found;
+                HANDLE find = FindFirstFile(pattern, &found);
+                if (find == INVALID_HANDLE_VALUE)
+                {
+                    continue;
+                }
+                do
+                {
+                    files.push_back(std::string(root) + "\\" + gSamples[s] + "\\" + found.cFileName);
+                } while (FindNextFile(find, &found));
+                FindClose(find);
+            }
+        }
+        else if (argv[i][0] != '-')
+        {
+            files.push_back(argv[i]);
+        }
+        else
+        {
+            printf("usage: FxBench [-items 65536] [-reps 5] [-d] file.fx ...\n"
+                   "       FxBench [-items 65536] [-reps 5] [-d] -root ..\\..\n");
+            return 1;
+        }
+    }
+
+    if (options.items < 1 || options.reps < 1)
+    {
+        printf("-items and -reps must be at least 1\n");
+        return 1;
+    }
+
+    srand(1);
+    CreateTextures();
+
+    bool failed = false;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        failed = !BenchFile(files[i].c_str(), options) || failed;
+    }
+
+    printf("\n%d files, %d items, %d lanes\n", (int)files.size(), options.items, SHADER_LANES);
+    return failed ? 1 : 0;
+}
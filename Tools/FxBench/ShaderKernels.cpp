@@ -0,0 +1,3316 @@
+//**********************************************************************
+//
+// ShaderKernels.cpp
+//
+// Written by FxKernel from the samples' effects; do not edit. From
+// Tools\FxBench, FxKernel -root ..\.. -o ShaderKernels.cpp writes it
+// again after a shader changes.
+//
+//**********************************************************************
+
+#include "ShaderInterpreter.h"
+#include <math.h>
+#include <stddef.h>
+
+static float Saturate(float x)
+{
+    return (x < 0.0f) ? 0.0f : (x > 1.0f) ? 1.0f : x;
+}
+
+static bool AnyLane(const float* mask)
+{
+    bool any = false;
+    for (int l = 0; l < SHADER_LANES; ++l)
+    {
+        any = any || mask[l] != 0.0f;
+    }
+    return any;
+}
+
+//----------------------------------------------------------------------
+// ColorShader_Pass_0_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms0[] = { "gWorldViewProjectionMatrix", NULL };
+static const char* const gSamplers0[] = { NULL };
+
+static void ColorShader_Pass_0_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float v24[SHADER_LANES];
+    float v28[SHADER_LANES];
+    float v32[SHADER_LANES];
+    float v36[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v21 = r0[l] * u0;
+            float v22 = r1[l] * u4 + v21;
+            float v23 = r2[l] * u8 + v22;
+            v24[l] = r3[l] * u12 + v23;
+            float v25 = r0[l] * u1;
+            float v26 = r1[l] * u5 + v25;
+            float v27 = r2[l] * u9 + v26;
+            v28[l] = r3[l] * u13 + v27;
+            float v29 = r0[l] * u2;
+            float v30 = r1[l] * u6 + v29;
+            float v31 = r2[l] * u10 + v30;
+            v32[l] = r3[l] * u14 + v31;
+            float v33 = r0[l] * u3;
+            float v34 = r1[l] * u7 + v33;
+            float v35 = r2[l] * u11 + v34;
+            v36[l] = r3[l] * u15 + v35;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v24[l];
+            outputs[1 * count + base + l] = v28[l];
+            outputs[2 * count + base + l] = v32[l];
+            outputs[3 * count + base + l] = v36[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ColorShader_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms1[] = { NULL };
+static const char* const gSamplers1[] = { NULL };
+
+static void ColorShader_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = 1.0f;
+            outputs[1 * count + base + l] = 0.0f;
+            outputs[2 * count + base + l] = 0.0f;
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// TextureMapping_Pass_0_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms2[] = { "gWorldViewProjectionMatrix", NULL };
+static const char* const gSamplers2[] = { NULL };
+
+static void TextureMapping_Pass_0_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float v26[SHADER_LANES];
+    float v30[SHADER_LANES];
+    float v34[SHADER_LANES];
+    float v38[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v23 = r0[l] * u0;
+            float v24 = r1[l] * u4 + v23;
+            float v25 = r2[l] * u8 + v24;
+            v26[l] = r3[l] * u12 + v25;
+            float v27 = r0[l] * u1;
+            float v28 = r1[l] * u5 + v27;
+            float v29 = r2[l] * u9 + v28;
+            v30[l] = r3[l] * u13 + v29;
+            float v31 = r0[l] * u2;
+            float v32 = r1[l] * u6 + v31;
+            float v33 = r2[l] * u10 + v32;
+            v34[l] = r3[l] * u14 + v33;
+            float v35 = r0[l] * u3;
+            float v36 = r1[l] * u7 + v35;
+            float v37 = r2[l] * u11 + v36;
+            v38[l] = r3[l] * u15 + v37;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v26[l];
+            outputs[1 * count + base + l] = v30[l];
+            outputs[2 * count + base + l] = v34[l];
+            outputs[3 * count + base + l] = v38[l];
+            outputs[4 * count + base + l] = r4[l];
+            outputs[5 * count + base + l] = r5[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// TextureMapping_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms3[] = { NULL };
+static const char* const gSamplers3[] = { "DiffuseSampler", NULL };
+
+static void TextureMapping_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float v3[SHADER_LANES];
+    float v4[SHADER_LANES];
+    float v5[SHADER_LANES];
+    float v6[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v3[l] = rgba[0];
+            v4[l] = rgba[1];
+            v5[l] = rgba[2];
+            v6[l] = rgba[3];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v3[l];
+            outputs[1 * count + base + l] = v4[l];
+            outputs[2 * count + base + l] = v5[l];
+            outputs[3 * count + base + l] = v6[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// Lighting_Pass_0_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms4[] = { "gWorldMatrix", "gWorldLightPosition", "gWorldCameraPosition", "gViewProjectionMatrix", NULL };
+static const char* const gSamplers4[] = { NULL };
+
+static void Lighting_Pass_0_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    const float u16 = uniforms[16];
+    const float u17 = uniforms[17];
+    const float u18 = uniforms[18];
+    const float u20 = uniforms[20];
+    const float u21 = uniforms[21];
+    const float u22 = uniforms[22];
+    const float u24 = uniforms[24];
+    const float u25 = uniforms[25];
+    const float u26 = uniforms[26];
+    const float u27 = uniforms[27];
+    const float u28 = uniforms[28];
+    const float u29 = uniforms[29];
+    const float u30 = uniforms[30];
+    const float u31 = uniforms[31];
+    const float u32 = uniforms[32];
+    const float u33 = uniforms[33];
+    const float u34 = uniforms[34];
+    const float u35 = uniforms[35];
+    const float u36 = uniforms[36];
+    const float u37 = uniforms[37];
+    const float u38 = uniforms[38];
+    const float u39 = uniforms[39];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float v78[SHADER_LANES];
+    float v79[SHADER_LANES];
+    float v80[SHADER_LANES];
+    float v92[SHADER_LANES];
+    float v96[SHADER_LANES];
+    float v97[SHADER_LANES];
+    float v98[SHADER_LANES];
+    float v120[SHADER_LANES];
+    float v125[SHADER_LANES];
+    float v126[SHADER_LANES];
+    float v127[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v49 = r0[l] * u0;
+            float v50 = r1[l] * u4 + v49;
+            float v51 = r2[l] * u8 + v50;
+            float v52 = r3[l] * u12 + v51;
+            float v53 = r0[l] * u1;
+            float v54 = r1[l] * u5 + v53;
+            float v55 = r2[l] * u9 + v54;
+            float v56 = r3[l] * u13 + v55;
+            float v57 = r0[l] * u2;
+            float v58 = r1[l] * u6 + v57;
+            float v59 = r2[l] * u10 + v58;
+            float v60 = r3[l] * u14 + v59;
+            float v61 = r0[l] * u3;
+            float v62 = r1[l] * u7 + v61;
+            float v63 = r2[l] * u11 + v62;
+            float v64 = r3[l] * u15 + v63;
+            float v65 = v52 - u16;
+            float v66 = v56 - u17;
+            float v67 = v60 - u18;
+            float v68 = v65;
+            float v69 = v66;
+            float v70 = v67;
+            float v71 = v65 * v65;
+            float v72 = v66 * v66 + v71;
+            float v73 = v67 * v67 + v72;
+            float v74 = 1.0f / sqrtf(v73);
+            float v75 = v65 * v74;
+            float v76 = v66 * v74;
+            float v77 = v67 * v74;
+            v78[l] = v52 - u20;
+            v79[l] = v56 - u21;
+            v80[l] = v60 - u22;
+            float v81 = v52 * u24;
+            float v82 = v56 * u28 + v81;
+            float v83 = v60 * u32 + v82;
+            float v84 = v64 * u36 + v83;
+            float v85 = v52 * u25;
+            float v86 = v56 * u29 + v85;
+            float v87 = v60 * u33 + v86;
+            float v88 = v64 * u37 + v87;
+            float v89 = v52 * u26;
+            float v90 = v56 * u30 + v89;
+            float v91 = v60 * u34 + v90;
+            v92[l] = v64 * u38 + v91;
+            float v93 = v52 * u27;
+            float v94 = v56 * u31 + v93;
+            float v95 = v60 * u35 + v94;
+            v96[l] = v64 * u39 + v95;
+            v97[l] = v84;
+            v98[l] = v88;
+            float v99 = r4[l] * u0;
+            float v100 = r5[l] * u4 + v99;
+            float v101 = r6[l] * u8 + v100;
+            float v102 = r4[l] * u1;
+            float v103 = r5[l] * u5 + v102;
+            float v104 = r6[l] * u9 + v103;
+            float v105 = r4[l] * u2;
+            float v106 = r5[l] * u6 + v105;
+            float v107 = r6[l] * u10 + v106;
+            float v108 = v101 * v101;
+            float v109 = v104 * v104 + v108;
+            float v110 = v107 * v107 + v109;
+            float v111 = 1.0f / sqrtf(v110);
+            float v112 = v101 * v111;
+            float v113 = v104 * v111;
+            float v114 = v107 * v111;
+            float v115 = -v75;
+            float v116 = -v76;
+            float v117 = -v77;
+            float v118 = v115 * v112;
+            float v119 = v116 * v113 + v118;
+            v120[l] = v117 * v114 + v119;
+            float v121 = v112 * v68;
+            float v122 = v113 * v69 + v121;
+            float v123 = v114 * v70 + v122;
+            float v124 = v123 * (-2.0f);
+            v125[l] = v124 * v112 + v68;
+            v126[l] = v124 * v113 + v69;
+            v127[l] = v124 * v114 + v70;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v97[l];
+            outputs[1 * count + base + l] = v98[l];
+            outputs[2 * count + base + l] = v92[l];
+            outputs[3 * count + base + l] = v96[l];
+            outputs[4 * count + base + l] = v120[l];
+            outputs[5 * count + base + l] = v120[l];
+            outputs[6 * count + base + l] = v120[l];
+            outputs[7 * count + base + l] = v78[l];
+            outputs[8 * count + base + l] = v79[l];
+            outputs[9 * count + base + l] = v80[l];
+            outputs[10 * count + base + l] = v125[l];
+            outputs[11 * count + base + l] = v126[l];
+            outputs[12 * count + base + l] = v127[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// Lighting_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms5[] = { NULL };
+static const char* const gSamplers5[] = { NULL };
+
+static void Lighting_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r18[SHADER_LANES] = { 0.0f };
+    float r19[SHADER_LANES] = { 0.0f };
+    float r20[SHADER_LANES] = { 0.0f };
+    float r22[SHADER_LANES] = { 0.0f };
+    float r23[SHADER_LANES] = { 0.0f };
+    float r24[SHADER_LANES] = { 0.0f };
+    float r25[SHADER_LANES] = { 0.0f };
+    float r26[SHADER_LANES] = { 0.0f };
+    float r27[SHADER_LANES] = { 0.0f };
+    float r28[SHADER_LANES] = { 0.0f };
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r8[SHADER_LANES] = { 0.0f };
+    float v24[SHADER_LANES];
+    float v25[SHADER_LANES];
+    float v26[SHADER_LANES];
+    float v30[SHADER_LANES];
+    float v31[SHADER_LANES];
+    float v32[SHADER_LANES];
+    float v34[SHADER_LANES];
+    float v35[SHADER_LANES];
+    float v36[SHADER_LANES];
+    float v37[SHADER_LANES];
+    float v38[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r8[l] = inputs[8 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            v24[l] = Saturate(r0[l]);
+            v25[l] = Saturate(r1[l]);
+            v26[l] = Saturate(r2[l]);
+            float v27 = r6[l] * r6[l];
+            float v28 = r7[l] * r7[l] + v27;
+            float v29 = r8[l] * r8[l] + v28;
+            r18[l] = 1.0f / sqrtf(v29);
+            v30[l] = r6[l] * r18[l];
+            v31[l] = r7[l] * r18[l];
+            v32[l] = r8[l] * r18[l];
+            r18[l] = r3[l] * r3[l];
+            r19[l] = r4[l] * r4[l] + r18[l];
+            r20[l] = r5[l] * r5[l] + r19[l];
+            float v33 = 1.0f / sqrtf(r20[l]);
+            v34[l] = r3[l] * v33;
+            v35[l] = r4[l] * v33;
+            v36[l] = r5[l] * v33;
+            v37[l] = (0.0f < v24[l]) ? 1.0f : 0.0f;
+            r18[l] = 0.0f;
+            r19[l] = 0.0f;
+            r20[l] = 0.0f;
+        }
+        if (!AnyLane(v37))
+            goto skip38;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r22[l] = -v34[l];
+            r23[l] = -v35[l];
+            r24[l] = -v36[l];
+            r25[l] = v30[l] * r22[l];
+            r26[l] = v31[l] * r23[l] + r25[l];
+            r27[l] = v32[l] * r24[l] + r26[l];
+            r28[l] = Saturate(r27[l]);
+            r18[l] = (v37[l] != 0.0f) ? r28[l] : r18[l];
+            r19[l] = (v37[l] != 0.0f) ? r28[l] : r19[l];
+            r20[l] = (v37[l] != 0.0f) ? r28[l] : r20[l];
+            r22[l] = powf(r18[l], 20.0f);
+            r23[l] = powf(r19[l], 20.0f);
+            r24[l] = powf(r20[l], 20.0f);
+            r18[l] = (v37[l] != 0.0f) ? r22[l] : r18[l];
+            r19[l] = (v37[l] != 0.0f) ? r23[l] : r19[l];
+            r20[l] = (v37[l] != 0.0f) ? r24[l] : r20[l];
+        }
+    skip38:
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r24[l] = 0.100000001f + v24[l];
+            r25[l] = 0.100000001f + v25[l];
+            r26[l] = 0.100000001f + v26[l];
+            r27[l] = r24[l] + r18[l];
+            r28[l] = r25[l] + r19[l];
+            v38[l] = r26[l] + r20[l];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = r27[l];
+            outputs[1 * count + base + l] = r28[l];
+            outputs[2 * count + base + l] = v38[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// SpecularMapping_Pass_0_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms6[] = { "gWorldMatrix", "gWorldLightPosition", "gWorldCameraPosition", "gViewProjectionMatrix", NULL };
+static const char* const gSamplers6[] = { NULL };
+
+static void SpecularMapping_Pass_0_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    const float u16 = uniforms[16];
+    const float u17 = uniforms[17];
+    const float u18 = uniforms[18];
+    const float u20 = uniforms[20];
+    const float u21 = uniforms[21];
+    const float u22 = uniforms[22];
+    const float u24 = uniforms[24];
+    const float u25 = uniforms[25];
+    const float u26 = uniforms[26];
+    const float u27 = uniforms[27];
+    const float u28 = uniforms[28];
+    const float u29 = uniforms[29];
+    const float u30 = uniforms[30];
+    const float u31 = uniforms[31];
+    const float u32 = uniforms[32];
+    const float u33 = uniforms[33];
+    const float u34 = uniforms[34];
+    const float u35 = uniforms[35];
+    const float u36 = uniforms[36];
+    const float u37 = uniforms[37];
+    const float u38 = uniforms[38];
+    const float u39 = uniforms[39];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r8[SHADER_LANES] = { 0.0f };
+    float v80[SHADER_LANES];
+    float v81[SHADER_LANES];
+    float v82[SHADER_LANES];
+    float v94[SHADER_LANES];
+    float v98[SHADER_LANES];
+    float v99[SHADER_LANES];
+    float v100[SHADER_LANES];
+    float v122[SHADER_LANES];
+    float v127[SHADER_LANES];
+    float v128[SHADER_LANES];
+    float v129[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r8[l] = inputs[8 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v51 = r0[l] * u0;
+            float v52 = r1[l] * u4 + v51;
+            float v53 = r2[l] * u8 + v52;
+            float v54 = r3[l] * u12 + v53;
+            float v55 = r0[l] * u1;
+            float v56 = r1[l] * u5 + v55;
+            float v57 = r2[l] * u9 + v56;
+            float v58 = r3[l] * u13 + v57;
+            float v59 = r0[l] * u2;
+            float v60 = r1[l] * u6 + v59;
+            float v61 = r2[l] * u10 + v60;
+            float v62 = r3[l] * u14 + v61;
+            float v63 = r0[l] * u3;
+            float v64 = r1[l] * u7 + v63;
+            float v65 = r2[l] * u11 + v64;
+            float v66 = r3[l] * u15 + v65;
+            float v67 = v54 - u16;
+            float v68 = v58 - u17;
+            float v69 = v62 - u18;
+            float v70 = v67;
+            float v71 = v68;
+            float v72 = v69;
+            float v73 = v67 * v67;
+            float v74 = v68 * v68 + v73;
+            float v75 = v69 * v69 + v74;
+            float v76 = 1.0f / sqrtf(v75);
+            float v77 = v67 * v76;
+            float v78 = v68 * v76;
+            float v79 = v69 * v76;
+            v80[l] = v54 - u20;
+            v81[l] = v58 - u21;
+            v82[l] = v62 - u22;
+            float v83 = v54 * u24;
+            float v84 = v58 * u28 + v83;
+            float v85 = v62 * u32 + v84;
+            float v86 = v66 * u36 + v85;
+            float v87 = v54 * u25;
+            float v88 = v58 * u29 + v87;
+            float v89 = v62 * u33 + v88;
+            float v90 = v66 * u37 + v89;
+            float v91 = v54 * u26;
+            float v92 = v58 * u30 + v91;
+            float v93 = v62 * u34 + v92;
+            v94[l] = v66 * u38 + v93;
+            float v95 = v54 * u27;
+            float v96 = v58 * u31 + v95;
+            float v97 = v62 * u35 + v96;
+            v98[l] = v66 * u39 + v97;
+            v99[l] = v86;
+            v100[l] = v90;
+            float v101 = r4[l] * u0;
+            float v102 = r5[l] * u4 + v101;
+            float v103 = r6[l] * u8 + v102;
+            float v104 = r4[l] * u1;
+            float v105 = r5[l] * u5 + v104;
+            float v106 = r6[l] * u9 + v105;
+            float v107 = r4[l] * u2;
+            float v108 = r5[l] * u6 + v107;
+            float v109 = r6[l] * u10 + v108;
+            float v110 = v103 * v103;
+            float v111 = v106 * v106 + v110;
+            float v112 = v109 * v109 + v111;
+            float v113 = 1.0f / sqrtf(v112);
+            float v114 = v103 * v113;
+            float v115 = v106 * v113;
+            float v116 = v109 * v113;
+            float v117 = -v77;
+            float v118 = -v78;
+            float v119 = -v79;
+            float v120 = v117 * v114;
+            float v121 = v118 * v115 + v120;
+            v122[l] = v119 * v116 + v121;
+            float v123 = v114 * v70;
+            float v124 = v115 * v71 + v123;
+            float v125 = v116 * v72 + v124;
+            float v126 = v125 * (-2.0f);
+            v127[l] = v126 * v114 + v70;
+            v128[l] = v126 * v115 + v71;
+            v129[l] = v126 * v116 + v72;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v99[l];
+            outputs[1 * count + base + l] = v100[l];
+            outputs[2 * count + base + l] = v94[l];
+            outputs[3 * count + base + l] = v98[l];
+            outputs[4 * count + base + l] = r7[l];
+            outputs[5 * count + base + l] = r8[l];
+            outputs[6 * count + base + l] = v122[l];
+            outputs[7 * count + base + l] = v122[l];
+            outputs[8 * count + base + l] = v122[l];
+            outputs[9 * count + base + l] = v80[l];
+            outputs[10 * count + base + l] = v81[l];
+            outputs[11 * count + base + l] = v82[l];
+            outputs[12 * count + base + l] = v127[l];
+            outputs[13 * count + base + l] = v128[l];
+            outputs[14 * count + base + l] = v129[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// SpecularMapping_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms7[] = { "gLightColor", NULL };
+static const char* const gSamplers7[] = { "DiffuseSampler", "SpecularSampler", NULL };
+
+static void SpecularMapping_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    float r27[SHADER_LANES] = { 0.0f };
+    float r28[SHADER_LANES] = { 0.0f };
+    float r29[SHADER_LANES] = { 0.0f };
+    float r31[SHADER_LANES] = { 0.0f };
+    float r32[SHADER_LANES] = { 0.0f };
+    float r33[SHADER_LANES] = { 0.0f };
+    float r34[SHADER_LANES] = { 0.0f };
+    float r35[SHADER_LANES] = { 0.0f };
+    float r36[SHADER_LANES] = { 0.0f };
+    float r37[SHADER_LANES] = { 0.0f };
+    float r38[SHADER_LANES] = { 0.0f };
+    float r39[SHADER_LANES] = { 0.0f };
+    float r40[SHADER_LANES] = { 0.0f };
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r8[SHADER_LANES] = { 0.0f };
+    float r9[SHADER_LANES] = { 0.0f };
+    float r10[SHADER_LANES] = { 0.0f };
+    float v32[SHADER_LANES];
+    float v33[SHADER_LANES];
+    float v34[SHADER_LANES];
+    float v42[SHADER_LANES];
+    float v43[SHADER_LANES];
+    float v44[SHADER_LANES];
+    float v48[SHADER_LANES];
+    float v49[SHADER_LANES];
+    float v50[SHADER_LANES];
+    float v52[SHADER_LANES];
+    float v53[SHADER_LANES];
+    float v54[SHADER_LANES];
+    float v55[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r8[l] = inputs[8 * count + n];
+            r9[l] = inputs[9 * count + n];
+            r10[l] = inputs[10 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v32[l] = rgba[0];
+            v33[l] = rgba[1];
+            v34[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v36 = u0 * v32[l];
+            float v37 = u1 * v33[l];
+            float v38 = u2 * v34[l];
+            float v39 = Saturate(r2[l]);
+            float v40 = Saturate(r3[l]);
+            float v41 = Saturate(r4[l]);
+            v42[l] = v36 * v39;
+            v43[l] = v37 * v40;
+            v44[l] = v38 * v41;
+            float v45 = r8[l] * r8[l];
+            float v46 = r9[l] * r9[l] + v45;
+            float v47 = r10[l] * r10[l] + v46;
+            r27[l] = 1.0f / sqrtf(v47);
+            v48[l] = r8[l] * r27[l];
+            v49[l] = r9[l] * r27[l];
+            v50[l] = r10[l] * r27[l];
+            r27[l] = r5[l] * r5[l];
+            r28[l] = r6[l] * r6[l] + r27[l];
+            r29[l] = r7[l] * r7[l] + r28[l];
+            float v51 = 1.0f / sqrtf(r29[l]);
+            v52[l] = r5[l] * v51;
+            v53[l] = r6[l] * v51;
+            v54[l] = r7[l] * v51;
+            v55[l] = (0.0f < v42[l]) ? 1.0f : 0.0f;
+            r27[l] = 0.0f;
+            r28[l] = 0.0f;
+            r29[l] = 0.0f;
+        }
+        if (!AnyLane(v55))
+            goto skip55;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r31[l] = -v52[l];
+            r32[l] = -v53[l];
+            r33[l] = -v54[l];
+            r34[l] = v48[l] * r31[l];
+            r35[l] = v49[l] * r32[l] + r34[l];
+            r36[l] = v50[l] * r33[l] + r35[l];
+            r37[l] = Saturate(r36[l]);
+            r27[l] = (v55[l] != 0.0f) ? r37[l] : r27[l];
+            r28[l] = (v55[l] != 0.0f) ? r37[l] : r28[l];
+            r29[l] = (v55[l] != 0.0f) ? r37[l] : r29[l];
+            r31[l] = powf(r27[l], 20.0f);
+            r32[l] = powf(r28[l], 20.0f);
+            r33[l] = powf(r29[l], 20.0f);
+            r27[l] = (v55[l] != 0.0f) ? r31[l] : r27[l];
+            r28[l] = (v55[l] != 0.0f) ? r32[l] : r28[l];
+            r29[l] = (v55[l] != 0.0f) ? r33[l] : r29[l];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[1], r0[l], r1[l], rgba);
+            r35[l] = rgba[0];
+            r36[l] = rgba[1];
+            r37[l] = rgba[2];
+            r38[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r35[l] = r35[l] * u0;
+            r36[l] = r36[l] * u1;
+            r37[l] = r37[l] * u2;
+            r38[l] = r27[l] * r35[l];
+            r39[l] = r28[l] * r36[l];
+            r40[l] = r29[l] * r37[l];
+            r27[l] = (v55[l] != 0.0f) ? r38[l] : r27[l];
+            r28[l] = (v55[l] != 0.0f) ? r39[l] : r28[l];
+            r29[l] = (v55[l] != 0.0f) ? r40[l] : r29[l];
+        }
+    skip55:
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r33[l] = 0.100000001f + v42[l];
+            r34[l] = 0.100000001f + v43[l];
+            r35[l] = 0.100000001f + v44[l];
+            r36[l] = r33[l] + r27[l];
+            r37[l] = r34[l] + r28[l];
+            r38[l] = r35[l] + r29[l];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = r36[l];
+            outputs[1 * count + base + l] = r37[l];
+            outputs[2 * count + base + l] = r38[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ToonShader_Pass_0_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms8[] = { "gWorldViewProjectionMatrix", "gObjectLightPosition", NULL };
+static const char* const gSamplers8[] = { NULL };
+
+static void ToonShader_Pass_0_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    const float u16 = uniforms[16];
+    const float u17 = uniforms[17];
+    const float u18 = uniforms[18];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float v31[SHADER_LANES];
+    float v35[SHADER_LANES];
+    float v39[SHADER_LANES];
+    float v43[SHADER_LANES];
+    float v66[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v28 = r0[l] * u0;
+            float v29 = r1[l] * u4 + v28;
+            float v30 = r2[l] * u8 + v29;
+            v31[l] = r3[l] * u12 + v30;
+            float v32 = r0[l] * u1;
+            float v33 = r1[l] * u5 + v32;
+            float v34 = r2[l] * u9 + v33;
+            v35[l] = r3[l] * u13 + v34;
+            float v36 = r0[l] * u2;
+            float v37 = r1[l] * u6 + v36;
+            float v38 = r2[l] * u10 + v37;
+            v39[l] = r3[l] * u14 + v38;
+            float v40 = r0[l] * u3;
+            float v41 = r1[l] * u7 + v40;
+            float v42 = r2[l] * u11 + v41;
+            v43[l] = r3[l] * u15 + v42;
+            float v44 = r0[l] - u16;
+            float v45 = r1[l] - u17;
+            float v46 = r2[l] - u18;
+            float v47 = v44 * v44;
+            float v48 = v45 * v45 + v47;
+            float v49 = v46 * v46 + v48;
+            float v50 = 1.0f / sqrtf(v49);
+            float v51 = v44 * v50;
+            float v52 = v45 * v50;
+            float v53 = v46 * v50;
+            float v54 = -v51;
+            float v55 = -v52;
+            float v56 = -v53;
+            float v57 = r4[l] * r4[l];
+            float v58 = r5[l] * r5[l] + v57;
+            float v59 = r6[l] * r6[l] + v58;
+            float v60 = 1.0f / sqrtf(v59);
+            float v61 = r4[l] * v60;
+            float v62 = r5[l] * v60;
+            float v63 = r6[l] * v60;
+            float v64 = v54 * v61;
+            float v65 = v55 * v62 + v64;
+            v66[l] = v56 * v63 + v65;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v31[l];
+            outputs[1 * count + base + l] = v35[l];
+            outputs[2 * count + base + l] = v39[l];
+            outputs[3 * count + base + l] = v43[l];
+            outputs[4 * count + base + l] = v66[l];
+            outputs[5 * count + base + l] = v66[l];
+            outputs[6 * count + base + l] = v66[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ToonShader_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms9[] = { "gSurfaceColor", NULL };
+static const char* const gSamplers9[] = { NULL };
+
+static void ToonShader_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float v22[SHADER_LANES];
+    float v23[SHADER_LANES];
+    float v24[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v10 = Saturate(r0[l]);
+            float v11 = Saturate(r1[l]);
+            float v12 = Saturate(r2[l]);
+            float v13 = v10 * 5.0f;
+            float v14 = v11 * 5.0f;
+            float v15 = v12 * 5.0f;
+            float v16 = ceilf(v13);
+            float v17 = ceilf(v14);
+            float v18 = ceilf(v15);
+            float v19 = v16 * 0.200000003f;
+            float v20 = v17 * 0.200000003f;
+            float v21 = v18 * 0.200000003f;
+            v22[l] = u0 * v19;
+            v23[l] = u1 * v20;
+            v24[l] = u2 * v21;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v22[l];
+            outputs[1 * count + base + l] = v23[l];
+            outputs[2 * count + base + l] = v24[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// NormalMapping_Pass_0_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms10[] = { "gWorldViewProjectionMatrix", "gWorldMatrix", "gWorldLightPosition", "gWorldCameraPosition", NULL };
+static const char* const gSamplers10[] = { NULL };
+
+static void NormalMapping_Pass_0_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    const float u16 = uniforms[16];
+    const float u17 = uniforms[17];
+    const float u18 = uniforms[18];
+    const float u20 = uniforms[20];
+    const float u21 = uniforms[21];
+    const float u22 = uniforms[22];
+    const float u24 = uniforms[24];
+    const float u25 = uniforms[25];
+    const float u26 = uniforms[26];
+    const float u28 = uniforms[28];
+    const float u29 = uniforms[29];
+    const float u30 = uniforms[30];
+    const float u32 = uniforms[32];
+    const float u33 = uniforms[33];
+    const float u34 = uniforms[34];
+    const float u36 = uniforms[36];
+    const float u37 = uniforms[37];
+    const float u38 = uniforms[38];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r8[SHADER_LANES] = { 0.0f };
+    float r9[SHADER_LANES] = { 0.0f };
+    float r10[SHADER_LANES] = { 0.0f };
+    float r11[SHADER_LANES] = { 0.0f };
+    float r12[SHADER_LANES] = { 0.0f };
+    float r13[SHADER_LANES] = { 0.0f };
+    float r14[SHADER_LANES] = { 0.0f };
+    float v59[SHADER_LANES];
+    float v63[SHADER_LANES];
+    float v67[SHADER_LANES];
+    float v71[SHADER_LANES];
+    float v84[SHADER_LANES];
+    float v85[SHADER_LANES];
+    float v86[SHADER_LANES];
+    float v87[SHADER_LANES];
+    float v88[SHADER_LANES];
+    float v89[SHADER_LANES];
+    float v92[SHADER_LANES];
+    float v95[SHADER_LANES];
+    float v98[SHADER_LANES];
+    float v101[SHADER_LANES];
+    float v104[SHADER_LANES];
+    float v107[SHADER_LANES];
+    float v110[SHADER_LANES];
+    float v113[SHADER_LANES];
+    float v116[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r8[l] = inputs[8 * count + n];
+            r9[l] = inputs[9 * count + n];
+            r10[l] = inputs[10 * count + n];
+            r11[l] = inputs[11 * count + n];
+            r12[l] = inputs[12 * count + n];
+            r13[l] = inputs[13 * count + n];
+            r14[l] = inputs[14 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v56 = r0[l] * u0;
+            float v57 = r1[l] * u4 + v56;
+            float v58 = r2[l] * u8 + v57;
+            v59[l] = r3[l] * u12 + v58;
+            float v60 = r0[l] * u1;
+            float v61 = r1[l] * u5 + v60;
+            float v62 = r2[l] * u9 + v61;
+            v63[l] = r3[l] * u13 + v62;
+            float v64 = r0[l] * u2;
+            float v65 = r1[l] * u6 + v64;
+            float v66 = r2[l] * u10 + v65;
+            v67[l] = r3[l] * u14 + v66;
+            float v68 = r0[l] * u3;
+            float v69 = r1[l] * u7 + v68;
+            float v70 = r2[l] * u11 + v69;
+            v71[l] = r3[l] * u15 + v70;
+            float v72 = r0[l] * u16;
+            float v73 = r1[l] * u20 + v72;
+            float v74 = r2[l] * u24 + v73;
+            float v75 = r3[l] * u28 + v74;
+            float v76 = r0[l] * u17;
+            float v77 = r1[l] * u21 + v76;
+            float v78 = r2[l] * u25 + v77;
+            float v79 = r3[l] * u29 + v78;
+            float v80 = r0[l] * u18;
+            float v81 = r1[l] * u22 + v80;
+            float v82 = r2[l] * u26 + v81;
+            float v83 = r3[l] * u30 + v82;
+            v84[l] = v75 - u32;
+            v85[l] = v79 - u33;
+            v86[l] = v83 - u34;
+            v87[l] = v75 - u36;
+            v88[l] = v79 - u37;
+            v89[l] = v83 - u38;
+            float v90 = r4[l] * u16;
+            float v91 = r5[l] * u20 + v90;
+            v92[l] = r6[l] * u24 + v91;
+            float v93 = r4[l] * u17;
+            float v94 = r5[l] * u21 + v93;
+            v95[l] = r6[l] * u25 + v94;
+            float v96 = r4[l] * u18;
+            float v97 = r5[l] * u22 + v96;
+            v98[l] = r6[l] * u26 + v97;
+            float v99 = r7[l] * u16;
+            float v100 = r8[l] * u20 + v99;
+            v101[l] = r9[l] * u24 + v100;
+            float v102 = r7[l] * u17;
+            float v103 = r8[l] * u21 + v102;
+            v104[l] = r9[l] * u25 + v103;
+            float v105 = r7[l] * u18;
+            float v106 = r8[l] * u22 + v105;
+            v107[l] = r9[l] * u26 + v106;
+            float v108 = r10[l] * u16;
+            float v109 = r11[l] * u20 + v108;
+            v110[l] = r12[l] * u24 + v109;
+            float v111 = r10[l] * u17;
+            float v112 = r11[l] * u21 + v111;
+            v113[l] = r12[l] * u25 + v112;
+            float v114 = r10[l] * u18;
+            float v115 = r11[l] * u22 + v114;
+            v116[l] = r12[l] * u26 + v115;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v59[l];
+            outputs[1 * count + base + l] = v63[l];
+            outputs[2 * count + base + l] = v67[l];
+            outputs[3 * count + base + l] = v71[l];
+            outputs[4 * count + base + l] = r13[l];
+            outputs[5 * count + base + l] = r14[l];
+            outputs[6 * count + base + l] = v84[l];
+            outputs[7 * count + base + l] = v85[l];
+            outputs[8 * count + base + l] = v86[l];
+            outputs[9 * count + base + l] = v87[l];
+            outputs[10 * count + base + l] = v88[l];
+            outputs[11 * count + base + l] = v89[l];
+            outputs[12 * count + base + l] = v101[l];
+            outputs[13 * count + base + l] = v104[l];
+            outputs[14 * count + base + l] = v107[l];
+            outputs[15 * count + base + l] = v110[l];
+            outputs[16 * count + base + l] = v113[l];
+            outputs[17 * count + base + l] = v116[l];
+            outputs[18 * count + base + l] = v92[l];
+            outputs[19 * count + base + l] = v95[l];
+            outputs[20 * count + base + l] = v98[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// NormalMapping_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms11[] = { "gLightColor", NULL };
+static const char* const gSamplers11[] = { "NormalSampler", "DiffuseSampler", "SpecularSampler", NULL };
+
+static void NormalMapping_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    float r45[SHADER_LANES] = { 0.0f };
+    float r46[SHADER_LANES] = { 0.0f };
+    float r47[SHADER_LANES] = { 0.0f };
+    float r49[SHADER_LANES] = { 0.0f };
+    float r50[SHADER_LANES] = { 0.0f };
+    float r51[SHADER_LANES] = { 0.0f };
+    float r52[SHADER_LANES] = { 0.0f };
+    float r53[SHADER_LANES] = { 0.0f };
+    float r54[SHADER_LANES] = { 0.0f };
+    float r55[SHADER_LANES] = { 0.0f };
+    float r56[SHADER_LANES] = { 0.0f };
+    float r57[SHADER_LANES] = { 0.0f };
+    float r58[SHADER_LANES] = { 0.0f };
+    float r59[SHADER_LANES] = { 0.0f };
+    float r60[SHADER_LANES] = { 0.0f };
+    float r61[SHADER_LANES] = { 0.0f };
+    float r62[SHADER_LANES] = { 0.0f };
+    float r63[SHADER_LANES] = { 0.0f };
+    float r64[SHADER_LANES] = { 0.0f };
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r8[SHADER_LANES] = { 0.0f };
+    float r9[SHADER_LANES] = { 0.0f };
+    float r10[SHADER_LANES] = { 0.0f };
+    float r11[SHADER_LANES] = { 0.0f };
+    float r12[SHADER_LANES] = { 0.0f };
+    float r13[SHADER_LANES] = { 0.0f };
+    float r14[SHADER_LANES] = { 0.0f };
+    float r15[SHADER_LANES] = { 0.0f };
+    float r16[SHADER_LANES] = { 0.0f };
+    float v46[SHADER_LANES];
+    float v47[SHADER_LANES];
+    float v48[SHADER_LANES];
+    float v90[SHADER_LANES];
+    float v93[SHADER_LANES];
+    float v96[SHADER_LANES];
+    float v97[SHADER_LANES];
+    float v98[SHADER_LANES];
+    float v99[SHADER_LANES];
+    float v107[SHADER_LANES];
+    float v108[SHADER_LANES];
+    float v109[SHADER_LANES];
+    float v111[SHADER_LANES];
+    float v112[SHADER_LANES];
+    float v113[SHADER_LANES];
+    float v114[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r8[l] = inputs[8 * count + n];
+            r9[l] = inputs[9 * count + n];
+            r10[l] = inputs[10 * count + n];
+            r11[l] = inputs[11 * count + n];
+            r12[l] = inputs[12 * count + n];
+            r13[l] = inputs[13 * count + n];
+            r14[l] = inputs[14 * count + n];
+            r15[l] = inputs[15 * count + n];
+            r16[l] = inputs[16 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v46[l] = rgba[0];
+            v47[l] = rgba[1];
+            v48[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v50 = v46[l] * 2.0f;
+            float v51 = v47[l] * 2.0f;
+            float v52 = v48[l] * 2.0f;
+            float v53 = v50 - 1.0f;
+            float v54 = v51 - 1.0f;
+            float v55 = v52 - 1.0f;
+            float v56 = v53 * v53;
+            float v57 = v54 * v54 + v56;
+            float v58 = v55 * v55 + v57;
+            float v59 = 1.0f / sqrtf(v58);
+            float v60 = v53 * v59;
+            float v61 = v54 * v59;
+            float v62 = v55 * v59;
+            float v63 = r8[l] * r8[l];
+            float v64 = r9[l] * r9[l] + v63;
+            float v65 = r10[l] * r10[l] + v64;
+            float v66 = 1.0f / sqrtf(v65);
+            float v67 = r8[l] * v66;
+            float v68 = r9[l] * v66;
+            float v69 = r10[l] * v66;
+            float v70 = r11[l] * r11[l];
+            float v71 = r12[l] * r12[l] + v70;
+            float v72 = r13[l] * r13[l] + v71;
+            float v73 = 1.0f / sqrtf(v72);
+            float v74 = r11[l] * v73;
+            float v75 = r12[l] * v73;
+            float v76 = r13[l] * v73;
+            r46[l] = r14[l] * r14[l];
+            r47[l] = r15[l] * r15[l] + r46[l];
+            float v77 = r16[l] * r16[l] + r47[l];
+            r49[l] = 1.0f / sqrtf(v77);
+            float v78 = r14[l] * r49[l];
+            float v79 = r15[l] * r49[l];
+            float v80 = r16[l] * r49[l];
+            float v81 = v74;
+            float v82 = v78;
+            float v83 = v68;
+            float v84 = v79;
+            float v85 = v69;
+            float v86 = v76;
+            float v87 = v84;
+            float v88 = v67 * v60;
+            float v89 = v81 * v61 + v88;
+            v90[l] = v82 * v62 + v89;
+            float v91 = v83 * v60;
+            float v92 = v75 * v61 + v91;
+            v93[l] = v87 * v62 + v92;
+            float v94 = v85 * v60;
+            float v95 = v86 * v61 + v94;
+            v96[l] = v80 * v62 + v95;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[1], r0[l], r1[l], rgba);
+            v97[l] = rgba[0];
+            v98[l] = rgba[1];
+            v99[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v101 = v97[l];
+            float v102 = v98[l];
+            float v103 = v99[l];
+            float v104 = r2[l] * r2[l];
+            float v105 = r3[l] * r3[l] + v104;
+            float v106 = r4[l] * r4[l] + v105;
+            r45[l] = 1.0f / sqrtf(v106);
+            v107[l] = r2[l] * r45[l];
+            v108[l] = r3[l] * r45[l];
+            v109[l] = r4[l] * r45[l];
+            r45[l] = -v107[l];
+            r46[l] = -v108[l];
+            r47[l] = -v109[l];
+            float v110 = v90[l] * r45[l];
+            r49[l] = v93[l] * r46[l] + v110;
+            r50[l] = v96[l] * r47[l] + r49[l];
+            r51[l] = Saturate(r50[l]);
+            r45[l] = u0 * v101;
+            r46[l] = u1 * v102;
+            r47[l] = u2 * v103;
+            v111[l] = r45[l] * r51[l];
+            v112[l] = r46[l] * r51[l];
+            v113[l] = r47[l] * r51[l];
+            v114[l] = (0.0f < v111[l]) ? 1.0f : 0.0f;
+            r45[l] = 0.0f;
+            r46[l] = 0.0f;
+            r47[l] = 0.0f;
+        }
+        if (!AnyLane(v114))
+            goto skip120;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r52[l] = v90[l] * v107[l];
+            r53[l] = v93[l] * v108[l] + r52[l];
+            r54[l] = v96[l] * v109[l] + r53[l];
+            r55[l] = r54[l] * (-2.0f);
+            r49[l] = r55[l] * v90[l] + v107[l];
+            r50[l] = r55[l] * v93[l] + v108[l];
+            r51[l] = r55[l] * v96[l] + v109[l];
+            r55[l] = r5[l] * r5[l];
+            r56[l] = r6[l] * r6[l] + r55[l];
+            r57[l] = r7[l] * r7[l] + r56[l];
+            r58[l] = 1.0f / sqrtf(r57[l]);
+            r52[l] = r5[l] * r58[l];
+            r53[l] = r6[l] * r58[l];
+            r54[l] = r7[l] * r58[l];
+            r55[l] = -r52[l];
+            r56[l] = -r53[l];
+            r57[l] = -r54[l];
+            r58[l] = r49[l] * r55[l];
+            r59[l] = r50[l] * r56[l] + r58[l];
+            r60[l] = r51[l] * r57[l] + r59[l];
+            r61[l] = Saturate(r60[l]);
+            r45[l] = (v114[l] != 0.0f) ? r61[l] : r45[l];
+            r46[l] = (v114[l] != 0.0f) ? r61[l] : r46[l];
+            r47[l] = (v114[l] != 0.0f) ? r61[l] : r47[l];
+            r55[l] = powf(r45[l], 20.0f);
+            r56[l] = powf(r46[l], 20.0f);
+            r57[l] = powf(r47[l], 20.0f);
+            r45[l] = (v114[l] != 0.0f) ? r55[l] : r45[l];
+            r46[l] = (v114[l] != 0.0f) ? r56[l] : r46[l];
+            r47[l] = (v114[l] != 0.0f) ? r57[l] : r47[l];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[2], r0[l], r1[l], rgba);
+            r59[l] = rgba[0];
+            r60[l] = rgba[1];
+            r61[l] = rgba[2];
+            r62[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r59[l] = r59[l] * u0;
+            r60[l] = r60[l] * u1;
+            r61[l] = r61[l] * u2;
+            r62[l] = r45[l] * r59[l];
+            r63[l] = r46[l] * r60[l];
+            r64[l] = r47[l] * r61[l];
+            r45[l] = (v114[l] != 0.0f) ? r62[l] : r45[l];
+            r46[l] = (v114[l] != 0.0f) ? r63[l] : r46[l];
+            r47[l] = (v114[l] != 0.0f) ? r64[l] : r47[l];
+        }
+    skip120:
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r51[l] = 0.100000001f + v111[l];
+            r52[l] = 0.100000001f + v112[l];
+            r53[l] = 0.100000001f + v113[l];
+            r54[l] = r51[l] + r45[l];
+            r55[l] = r52[l] + r46[l];
+            r56[l] = r53[l] + r47[l];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = r54[l];
+            outputs[1 * count + base + l] = r55[l];
+            outputs[2 * count + base + l] = r56[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// EnvironmentMapping_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms12[] = { "gLightColor", NULL };
+static const char* const gSamplers12[] = { "DiffuseSampler", "SpecularSampler", "EnvironmentSampler", NULL };
+
+static void EnvironmentMapping_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    float r48[SHADER_LANES] = { 0.0f };
+    float r49[SHADER_LANES] = { 0.0f };
+    float r50[SHADER_LANES] = { 0.0f };
+    float r52[SHADER_LANES] = { 0.0f };
+    float r53[SHADER_LANES] = { 0.0f };
+    float r54[SHADER_LANES] = { 0.0f };
+    float r55[SHADER_LANES] = { 0.0f };
+    float r56[SHADER_LANES] = { 0.0f };
+    float r57[SHADER_LANES] = { 0.0f };
+    float r58[SHADER_LANES] = { 0.0f };
+    float r59[SHADER_LANES] = { 0.0f };
+    float r60[SHADER_LANES] = { 0.0f };
+    float r61[SHADER_LANES] = { 0.0f };
+    float r62[SHADER_LANES] = { 0.0f };
+    float r63[SHADER_LANES] = { 0.0f };
+    float r64[SHADER_LANES] = { 0.0f };
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r14[SHADER_LANES] = { 0.0f };
+    float r15[SHADER_LANES] = { 0.0f };
+    float r16[SHADER_LANES] = { 0.0f };
+    float v47[SHADER_LANES];
+    float v50[SHADER_LANES];
+    float v51[SHADER_LANES];
+    float v52[SHADER_LANES];
+    float v53[SHADER_LANES];
+    float v54[SHADER_LANES];
+    float v55[SHADER_LANES];
+    float v57[SHADER_LANES];
+    float v58[SHADER_LANES];
+    float v59[SHADER_LANES];
+    float v64[SHADER_LANES];
+    float v65[SHADER_LANES];
+    float v66[SHADER_LANES];
+    float v74[SHADER_LANES];
+    float v75[SHADER_LANES];
+    float v76[SHADER_LANES];
+    float v78[SHADER_LANES];
+    float v79[SHADER_LANES];
+    float v80[SHADER_LANES];
+    float v81[SHADER_LANES];
+    float v82[SHADER_LANES];
+    float v87[SHADER_LANES];
+    float v88[SHADER_LANES];
+    float v89[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r14[l] = inputs[14 * count + n];
+            r15[l] = inputs[15 * count + n];
+            r16[l] = inputs[16 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v43 = r14[l] * r14[l];
+            float v44 = r15[l] * r15[l] + v43;
+            r48[l] = r16[l] * r16[l] + v44;
+            r49[l] = 1.0f / sqrtf(r48[l]);
+            float v45 = r14[l] * r49[l];
+            float v46 = r15[l] * r49[l];
+            v47[l] = r16[l] * r49[l];
+            float v48 = v45;
+            float v49 = v46;
+            v50[l] = v48;
+            v51[l] = v49;
+            v52[l] = v47[l];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v53[l] = rgba[0];
+            v54[l] = rgba[1];
+            v55[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            v57[l] = v53[l];
+            v58[l] = v54[l];
+            v59[l] = v55[l];
+            float v60 = r2[l] * r2[l];
+            float v61 = r3[l] * r3[l] + v60;
+            float v62 = r4[l] * r4[l] + v61;
+            float v63 = 1.0f / sqrtf(v62);
+            v64[l] = r2[l] * v63;
+            v65[l] = r3[l] * v63;
+            v66[l] = r4[l] * v63;
+            float v67 = -v64[l];
+            float v68 = -v65[l];
+            float v69 = -v66[l];
+            r48[l] = v50[l] * v67;
+            r49[l] = v51[l] * v68 + r48[l];
+            r50[l] = v47[l] * v69 + r49[l];
+            float v70 = Saturate(r50[l]);
+            float v71 = u0 * v57[l];
+            float v72 = u1 * v58[l];
+            float v73 = u2 * v59[l];
+            v74[l] = v71 * v70;
+            v75[l] = v72 * v70;
+            v76[l] = v73 * v70;
+            r48[l] = r5[l] * r5[l];
+            r49[l] = r6[l] * r6[l] + r48[l];
+            r50[l] = r7[l] * r7[l] + r49[l];
+            float v77 = 1.0f / sqrtf(r50[l]);
+            v78[l] = r5[l] * v77;
+            v79[l] = r6[l] * v77;
+            v80[l] = r7[l] * v77;
+            v81[l] = (0.0f < v74[l]) ? 1.0f : 0.0f;
+            r48[l] = 0.0f;
+            r49[l] = 0.0f;
+            r50[l] = 0.0f;
+        }
+        if (!AnyLane(v81))
+            goto skip81;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r55[l] = v50[l] * v64[l];
+            r56[l] = v51[l] * v65[l] + r55[l];
+            r57[l] = v52[l] * v66[l] + r56[l];
+            r58[l] = r57[l] * (-2.0f);
+            r52[l] = r58[l] * v50[l] + v64[l];
+            r53[l] = r58[l] * v51[l] + v65[l];
+            r54[l] = r58[l] * v52[l] + v66[l];
+            r55[l] = -v78[l];
+            r56[l] = -v79[l];
+            r57[l] = -v80[l];
+            r58[l] = r52[l] * r55[l];
+            r59[l] = r53[l] * r56[l] + r58[l];
+            r60[l] = r54[l] * r57[l] + r59[l];
+            r61[l] = Saturate(r60[l]);
+            r48[l] = (v81[l] != 0.0f) ? r61[l] : r48[l];
+            r49[l] = (v81[l] != 0.0f) ? r61[l] : r49[l];
+            r50[l] = (v81[l] != 0.0f) ? r61[l] : r50[l];
+            r55[l] = powf(r48[l], 20.0f);
+            r56[l] = powf(r49[l], 20.0f);
+            r57[l] = powf(r50[l], 20.0f);
+            r48[l] = (v81[l] != 0.0f) ? r55[l] : r48[l];
+            r49[l] = (v81[l] != 0.0f) ? r56[l] : r49[l];
+            r50[l] = (v81[l] != 0.0f) ? r57[l] : r50[l];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[1], r0[l], r1[l], rgba);
+            r59[l] = rgba[0];
+            r60[l] = rgba[1];
+            r61[l] = rgba[2];
+            r62[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r59[l] = r59[l] * u0;
+            r60[l] = r60[l] * u1;
+            r61[l] = r61[l] * u2;
+            r62[l] = r48[l] * r59[l];
+            r63[l] = r49[l] * r60[l];
+            r64[l] = r50[l] * r61[l];
+            r48[l] = (v81[l] != 0.0f) ? r62[l] : r48[l];
+            r49[l] = (v81[l] != 0.0f) ? r63[l] : r49[l];
+            r50[l] = (v81[l] != 0.0f) ? r64[l] : r50[l];
+        }
+    skip81:
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r54[l] = v50[l] * v78[l];
+            r55[l] = v51[l] * v79[l] + r54[l];
+            r56[l] = v52[l] * v80[l] + r55[l];
+            r57[l] = r56[l] * (-2.0f);
+            v82[l] = r57[l] * v50[l] + v78[l];
+            r52[l] = r57[l] * v51[l] + v79[l];
+            r53[l] = r57[l] * v52[l] + v80[l];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTextureCube(textures[2], v82[l], r52[l], r53[l], rgba);
+            r57[l] = rgba[0];
+            r58[l] = rgba[1];
+            r59[l] = rgba[2];
+            r60[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r54[l] = r57[l];
+            r55[l] = r58[l];
+            r56[l] = r59[l];
+            r57[l] = 0.100000001f * v57[l];
+            r58[l] = 0.100000001f * v58[l];
+            r59[l] = 0.100000001f * v59[l];
+            r60[l] = r57[l] + v74[l];
+            r61[l] = r58[l] + v75[l];
+            r62[l] = r59[l] + v76[l];
+            r63[l] = r60[l] + r48[l];
+            r64[l] = r61[l] + r49[l];
+            float v83 = r62[l] + r50[l];
+            float v84 = r54[l] * 0.5f;
+            float v85 = r55[l] * 0.5f;
+            float v86 = r56[l] * 0.5f;
+            v87[l] = r63[l] + v84;
+            v88[l] = r64[l] + v85;
+            v89[l] = v83 + v86;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v87[l];
+            outputs[1 * count + base + l] = v88[l];
+            outputs[2 * count + base + l] = v89[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// UVAnimation_Pass_0_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms13[] = { "gWaveHeight", "gWavePhase", "gWaveFrequency", "gWorldMatrix", "gWorldLightPosition", "gWorldCameraPosition", "gViewProjectionMatrix", "gUVOffset", NULL };
+static const char* const gSamplers13[] = { NULL };
+
+static void UVAnimation_Pass_0_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    const float u16 = uniforms[16];
+    const float u17 = uniforms[17];
+    const float u18 = uniforms[18];
+    const float u19 = uniforms[19];
+    const float u20 = uniforms[20];
+    const float u21 = uniforms[21];
+    const float u23 = uniforms[23];
+    const float u24 = uniforms[24];
+    const float u25 = uniforms[25];
+    const float u27 = uniforms[27];
+    const float u28 = uniforms[28];
+    const float u29 = uniforms[29];
+    const float u30 = uniforms[30];
+    const float u31 = uniforms[31];
+    const float u32 = uniforms[32];
+    const float u33 = uniforms[33];
+    const float u34 = uniforms[34];
+    const float u35 = uniforms[35];
+    const float u36 = uniforms[36];
+    const float u37 = uniforms[37];
+    const float u38 = uniforms[38];
+    const float u39 = uniforms[39];
+    const float u40 = uniforms[40];
+    const float u41 = uniforms[41];
+    const float u42 = uniforms[42];
+    const float u43 = uniforms[43];
+    const float u44 = uniforms[44];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r8[SHADER_LANES] = { 0.0f };
+    float v90[SHADER_LANES];
+    float v91[SHADER_LANES];
+    float v92[SHADER_LANES];
+    float v104[SHADER_LANES];
+    float v108[SHADER_LANES];
+    float v109[SHADER_LANES];
+    float v110[SHADER_LANES];
+    float v132[SHADER_LANES];
+    float v137[SHADER_LANES];
+    float v138[SHADER_LANES];
+    float v139[SHADER_LANES];
+    float v140[SHADER_LANES];
+    float v141[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r8[l] = inputs[8 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v56 = r7[l] * u2;
+            float v57 = u1 + v56;
+            float v58 = cosf(v57);
+            float v59 = u0 * v58;
+            float v60 = r1[l] + v59;
+            float v61 = r0[l] * u3;
+            float v62 = v60 * u7 + v61;
+            float v63 = r2[l] * u11 + v62;
+            float v64 = r3[l] * u15 + v63;
+            float v65 = r0[l] * u4;
+            float v66 = v60 * u8 + v65;
+            float v67 = r2[l] * u12 + v66;
+            float v68 = r3[l] * u16 + v67;
+            float v69 = r0[l] * u5;
+            float v70 = v60 * u9 + v69;
+            float v71 = r2[l] * u13 + v70;
+            float v72 = r3[l] * u17 + v71;
+            float v73 = r0[l] * u6;
+            float v74 = v60 * u10 + v73;
+            float v75 = r2[l] * u14 + v74;
+            float v76 = r3[l] * u18 + v75;
+            float v77 = v64 - u19;
+            float v78 = v68 - u20;
+            float v79 = v72 - u21;
+            float v80 = v77;
+            float v81 = v78;
+            float v82 = v79;
+            float v83 = v77 * v77;
+            float v84 = v78 * v78 + v83;
+            float v85 = v79 * v79 + v84;
+            float v86 = 1.0f / sqrtf(v85);
+            float v87 = v77 * v86;
+            float v88 = v78 * v86;
+            float v89 = v79 * v86;
+            v90[l] = v64 - u23;
+            v91[l] = v68 - u24;
+            v92[l] = v72 - u25;
+            float v93 = v64 * u27;
+            float v94 = v68 * u31 + v93;
+            float v95 = v72 * u35 + v94;
+            float v96 = v76 * u39 + v95;
+            float v97 = v64 * u28;
+            float v98 = v68 * u32 + v97;
+            float v99 = v72 * u36 + v98;
+            float v100 = v76 * u40 + v99;
+            float v101 = v64 * u29;
+            float v102 = v68 * u33 + v101;
+            float v103 = v72 * u37 + v102;
+            v104[l] = v76 * u41 + v103;
+            float v105 = v64 * u30;
+            float v106 = v68 * u34 + v105;
+            float v107 = v72 * u38 + v106;
+            v108[l] = v76 * u42 + v107;
+            v109[l] = v96;
+            v110[l] = v100;
+            float v111 = r4[l] * u3;
+            float v112 = r5[l] * u7 + v111;
+            float v113 = r6[l] * u11 + v112;
+            float v114 = r4[l] * u4;
+            float v115 = r5[l] * u8 + v114;
+            float v116 = r6[l] * u12 + v115;
+            float v117 = r4[l] * u5;
+            float v118 = r5[l] * u9 + v117;
+            float v119 = r6[l] * u13 + v118;
+            float v120 = v113 * v113;
+            float v121 = v116 * v116 + v120;
+            float v122 = v119 * v119 + v121;
+            float v123 = 1.0f / sqrtf(v122);
+            float v124 = v113 * v123;
+            float v125 = v116 * v123;
+            float v126 = v119 * v123;
+            float v127 = -v87;
+            float v128 = -v88;
+            float v129 = -v89;
+            float v130 = v127 * v124;
+            float v131 = v128 * v125 + v130;
+            v132[l] = v129 * v126 + v131;
+            float v133 = v124 * v80;
+            float v134 = v125 * v81 + v133;
+            float v135 = v126 * v82 + v134;
+            float v136 = v135 * (-2.0f);
+            v137[l] = v136 * v124 + v80;
+            v138[l] = v136 * v125 + v81;
+            v139[l] = v136 * v126 + v82;
+            v140[l] = r7[l] + u43;
+            v141[l] = r8[l] + u44;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v109[l];
+            outputs[1 * count + base + l] = v110[l];
+            outputs[2 * count + base + l] = v104[l];
+            outputs[3 * count + base + l] = v108[l];
+            outputs[4 * count + base + l] = v140[l];
+            outputs[5 * count + base + l] = v141[l];
+            outputs[6 * count + base + l] = v132[l];
+            outputs[7 * count + base + l] = v132[l];
+            outputs[8 * count + base + l] = v132[l];
+            outputs[9 * count + base + l] = v90[l];
+            outputs[10 * count + base + l] = v91[l];
+            outputs[11 * count + base + l] = v92[l];
+            outputs[12 * count + base + l] = v137[l];
+            outputs[13 * count + base + l] = v138[l];
+            outputs[14 * count + base + l] = v139[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// UVAnimation_Pass_0_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms14[] = { "gLightColor", NULL };
+static const char* const gSamplers14[] = { "DiffuseSampler", "SpecularSampler", NULL };
+
+static void UVAnimation_Pass_0_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    float r27[SHADER_LANES] = { 0.0f };
+    float r28[SHADER_LANES] = { 0.0f };
+    float r29[SHADER_LANES] = { 0.0f };
+    float r31[SHADER_LANES] = { 0.0f };
+    float r32[SHADER_LANES] = { 0.0f };
+    float r33[SHADER_LANES] = { 0.0f };
+    float r34[SHADER_LANES] = { 0.0f };
+    float r35[SHADER_LANES] = { 0.0f };
+    float r36[SHADER_LANES] = { 0.0f };
+    float r37[SHADER_LANES] = { 0.0f };
+    float r38[SHADER_LANES] = { 0.0f };
+    float r39[SHADER_LANES] = { 0.0f };
+    float r40[SHADER_LANES] = { 0.0f };
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float r7[SHADER_LANES] = { 0.0f };
+    float r8[SHADER_LANES] = { 0.0f };
+    float r9[SHADER_LANES] = { 0.0f };
+    float r10[SHADER_LANES] = { 0.0f };
+    float v32[SHADER_LANES];
+    float v33[SHADER_LANES];
+    float v34[SHADER_LANES];
+    float v36[SHADER_LANES];
+    float v37[SHADER_LANES];
+    float v38[SHADER_LANES];
+    float v45[SHADER_LANES];
+    float v46[SHADER_LANES];
+    float v47[SHADER_LANES];
+    float v51[SHADER_LANES];
+    float v52[SHADER_LANES];
+    float v53[SHADER_LANES];
+    float v55[SHADER_LANES];
+    float v56[SHADER_LANES];
+    float v57[SHADER_LANES];
+    float v58[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+            r7[l] = inputs[7 * count + n];
+            r8[l] = inputs[8 * count + n];
+            r9[l] = inputs[9 * count + n];
+            r10[l] = inputs[10 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v32[l] = rgba[0];
+            v33[l] = rgba[1];
+            v34[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            v36[l] = v32[l];
+            v37[l] = v33[l];
+            v38[l] = v34[l];
+            float v39 = u0 * v32[l];
+            float v40 = u1 * v33[l];
+            float v41 = u2 * v34[l];
+            float v42 = Saturate(r2[l]);
+            float v43 = Saturate(r3[l]);
+            float v44 = Saturate(r4[l]);
+            v45[l] = v39 * v42;
+            v46[l] = v40 * v43;
+            v47[l] = v41 * v44;
+            float v48 = r8[l] * r8[l];
+            float v49 = r9[l] * r9[l] + v48;
+            float v50 = r10[l] * r10[l] + v49;
+            r27[l] = 1.0f / sqrtf(v50);
+            v51[l] = r8[l] * r27[l];
+            v52[l] = r9[l] * r27[l];
+            v53[l] = r10[l] * r27[l];
+            r27[l] = r5[l] * r5[l];
+            r28[l] = r6[l] * r6[l] + r27[l];
+            r29[l] = r7[l] * r7[l] + r28[l];
+            float v54 = 1.0f / sqrtf(r29[l]);
+            v55[l] = r5[l] * v54;
+            v56[l] = r6[l] * v54;
+            v57[l] = r7[l] * v54;
+            v58[l] = (0.0f < v45[l]) ? 1.0f : 0.0f;
+            r27[l] = 0.0f;
+            r28[l] = 0.0f;
+            r29[l] = 0.0f;
+        }
+        if (!AnyLane(v58))
+            goto skip58;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r31[l] = -v55[l];
+            r32[l] = -v56[l];
+            r33[l] = -v57[l];
+            r34[l] = v51[l] * r31[l];
+            r35[l] = v52[l] * r32[l] + r34[l];
+            r36[l] = v53[l] * r33[l] + r35[l];
+            r37[l] = Saturate(r36[l]);
+            r27[l] = (v58[l] != 0.0f) ? r37[l] : r27[l];
+            r28[l] = (v58[l] != 0.0f) ? r37[l] : r28[l];
+            r29[l] = (v58[l] != 0.0f) ? r37[l] : r29[l];
+            r31[l] = powf(r27[l], 20.0f);
+            r32[l] = powf(r28[l], 20.0f);
+            r33[l] = powf(r29[l], 20.0f);
+            r27[l] = (v58[l] != 0.0f) ? r31[l] : r27[l];
+            r28[l] = (v58[l] != 0.0f) ? r32[l] : r28[l];
+            r29[l] = (v58[l] != 0.0f) ? r33[l] : r29[l];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[1], r0[l], r1[l], rgba);
+            r35[l] = rgba[0];
+            r36[l] = rgba[1];
+            r37[l] = rgba[2];
+            r38[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r35[l] = r35[l] * u0;
+            r36[l] = r36[l] * u1;
+            r37[l] = r37[l] * u2;
+            r38[l] = r27[l] * r35[l];
+            r39[l] = r28[l] * r36[l];
+            r40[l] = r29[l] * r37[l];
+            r27[l] = (v58[l] != 0.0f) ? r38[l] : r27[l];
+            r28[l] = (v58[l] != 0.0f) ? r39[l] : r28[l];
+            r29[l] = (v58[l] != 0.0f) ? r40[l] : r29[l];
+        }
+    skip58:
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v59 = 0.100000001f * v36[l];
+            r31[l] = 0.100000001f * v37[l];
+            r32[l] = 0.100000001f * v38[l];
+            r33[l] = v59 + v45[l];
+            r34[l] = r31[l] + v46[l];
+            r35[l] = r32[l] + v47[l];
+            r36[l] = r33[l] + r27[l];
+            r37[l] = r34[l] + r28[l];
+            r38[l] = r35[l] + r29[l];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = r36[l];
+            outputs[1 * count + base + l] = r37[l];
+            outputs[2 * count + base + l] = r38[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ApplyShadowShader_ApplyShadowTorus_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms15[] = { "gWorldMatrix", "gViewProjectionMatrix", "gLightViewProjectionMatrix", "gWorldLightPosition", NULL };
+static const char* const gSamplers15[] = { NULL };
+
+static void ApplyShadowShader_ApplyShadowTorus_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    const float u16 = uniforms[16];
+    const float u17 = uniforms[17];
+    const float u18 = uniforms[18];
+    const float u19 = uniforms[19];
+    const float u20 = uniforms[20];
+    const float u21 = uniforms[21];
+    const float u22 = uniforms[22];
+    const float u23 = uniforms[23];
+    const float u24 = uniforms[24];
+    const float u25 = uniforms[25];
+    const float u26 = uniforms[26];
+    const float u27 = uniforms[27];
+    const float u28 = uniforms[28];
+    const float u29 = uniforms[29];
+    const float u30 = uniforms[30];
+    const float u31 = uniforms[31];
+    const float u32 = uniforms[32];
+    const float u33 = uniforms[33];
+    const float u34 = uniforms[34];
+    const float u35 = uniforms[35];
+    const float u36 = uniforms[36];
+    const float u37 = uniforms[37];
+    const float u38 = uniforms[38];
+    const float u39 = uniforms[39];
+    const float u40 = uniforms[40];
+    const float u41 = uniforms[41];
+    const float u42 = uniforms[42];
+    const float u43 = uniforms[43];
+    const float u44 = uniforms[44];
+    const float u45 = uniforms[45];
+    const float u46 = uniforms[46];
+    const float u47 = uniforms[47];
+    const float u48 = uniforms[48];
+    const float u49 = uniforms[49];
+    const float u50 = uniforms[50];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float r6[SHADER_LANES] = { 0.0f };
+    float v79[SHADER_LANES];
+    float v83[SHADER_LANES];
+    float v87[SHADER_LANES];
+    float v91[SHADER_LANES];
+    float v95[SHADER_LANES];
+    float v99[SHADER_LANES];
+    float v103[SHADER_LANES];
+    float v107[SHADER_LANES];
+    float v139[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+            r6[l] = inputs[6 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v60 = r0[l] * u0;
+            float v61 = r1[l] * u4 + v60;
+            float v62 = r2[l] * u8 + v61;
+            float v63 = r3[l] * u12 + v62;
+            float v64 = r0[l] * u1;
+            float v65 = r1[l] * u5 + v64;
+            float v66 = r2[l] * u9 + v65;
+            float v67 = r3[l] * u13 + v66;
+            float v68 = r0[l] * u2;
+            float v69 = r1[l] * u6 + v68;
+            float v70 = r2[l] * u10 + v69;
+            float v71 = r3[l] * u14 + v70;
+            float v72 = r0[l] * u3;
+            float v73 = r1[l] * u7 + v72;
+            float v74 = r2[l] * u11 + v73;
+            float v75 = r3[l] * u15 + v74;
+            float v76 = v63 * u16;
+            float v77 = v67 * u20 + v76;
+            float v78 = v71 * u24 + v77;
+            v79[l] = v75 * u28 + v78;
+            float v80 = v63 * u17;
+            float v81 = v67 * u21 + v80;
+            float v82 = v71 * u25 + v81;
+            v83[l] = v75 * u29 + v82;
+            float v84 = v63 * u18;
+            float v85 = v67 * u22 + v84;
+            float v86 = v71 * u26 + v85;
+            v87[l] = v75 * u30 + v86;
+            float v88 = v63 * u19;
+            float v89 = v67 * u23 + v88;
+            float v90 = v71 * u27 + v89;
+            v91[l] = v75 * u31 + v90;
+            float v92 = v63 * u32;
+            float v93 = v67 * u36 + v92;
+            float v94 = v71 * u40 + v93;
+            v95[l] = v75 * u44 + v94;
+            float v96 = v63 * u33;
+            float v97 = v67 * u37 + v96;
+            float v98 = v71 * u41 + v97;
+            v99[l] = v75 * u45 + v98;
+            float v100 = v63 * u34;
+            float v101 = v67 * u38 + v100;
+            float v102 = v71 * u42 + v101;
+            v103[l] = v75 * u46 + v102;
+            float v104 = v63 * u35;
+            float v105 = v67 * u39 + v104;
+            float v106 = v71 * u43 + v105;
+            v107[l] = v75 * u47 + v106;
+            float v108 = v63 - u48;
+            float v109 = v67 - u49;
+            float v110 = v71 - u50;
+            float v111 = v108 * v108;
+            float v112 = v109 * v109 + v111;
+            float v113 = v110 * v110 + v112;
+            float v114 = 1.0f / sqrtf(v113);
+            float v115 = v108 * v114;
+            float v116 = v109 * v114;
+            float v117 = v110 * v114;
+            float v118 = r4[l] * u0;
+            float v119 = r5[l] * u4 + v118;
+            float v120 = r6[l] * u8 + v119;
+            float v121 = r4[l] * u1;
+            float v122 = r5[l] * u5 + v121;
+            float v123 = r6[l] * u9 + v122;
+            float v124 = r4[l] * u2;
+            float v125 = r5[l] * u6 + v124;
+            float v126 = r6[l] * u10 + v125;
+            float v127 = v120 * v120;
+            float v128 = v123 * v123 + v127;
+            float v129 = v126 * v126 + v128;
+            float v130 = 1.0f / sqrtf(v129);
+            float v131 = v120 * v130;
+            float v132 = v123 * v130;
+            float v133 = v126 * v130;
+            float v134 = -v115;
+            float v135 = -v116;
+            float v136 = -v117;
+            float v137 = v134 * v131;
+            float v138 = v135 * v132 + v137;
+            v139[l] = v136 * v133 + v138;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v79[l];
+            outputs[1 * count + base + l] = v83[l];
+            outputs[2 * count + base + l] = v87[l];
+            outputs[3 * count + base + l] = v91[l];
+            outputs[4 * count + base + l] = v95[l];
+            outputs[5 * count + base + l] = v99[l];
+            outputs[6 * count + base + l] = v103[l];
+            outputs[7 * count + base + l] = v107[l];
+            outputs[8 * count + base + l] = v139[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ApplyShadowShader_ApplyShadowTorus_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms16[] = { "gObjectColor", "gShadowMapUVScale", NULL };
+static const char* const gSamplers16[] = { "ShadowSampler", NULL };
+
+static void ApplyShadowShader_ApplyShadowTorus_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    float r11[SHADER_LANES] = { 0.0f };
+    float r12[SHADER_LANES] = { 0.0f };
+    float r13[SHADER_LANES] = { 0.0f };
+    float r20[SHADER_LANES] = { 0.0f };
+    float r21[SHADER_LANES] = { 0.0f };
+    float r22[SHADER_LANES] = { 0.0f };
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float v22[SHADER_LANES];
+    float v29[SHADER_LANES];
+    float v30[SHADER_LANES];
+    float v31[SHADER_LANES];
+    float v34[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v21 = Saturate(r4[l]);
+            r11[l] = v21 * u0;
+            r12[l] = v21 * u1;
+            r13[l] = v21 * u2;
+            v22[l] = r2[l] / r3[l];
+            float v23 = r0[l] / r3[l];
+            float v24 = r1[l] / r3[l];
+            float v25 = -v24;
+            float v26 = v23 * 0.5f;
+            float v27 = v25 * 0.5f;
+            float v28 = v26 + 0.5f;
+            r20[l] = v27 + 0.5f;
+            v29[l] = v28 * u4;
+            v30[l] = r20[l] * u5;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v29[l], v30[l], rgba);
+            v31[l] = rgba[0];
+            r20[l] = rgba[2];
+            r21[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v33 = v31[l] + 1.24999997e-05f;
+            v34[l] = (v33 < v22[l]) ? 1.0f : 0.0f;
+        }
+        if (!AnyLane(v34))
+            goto skip24;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            r20[l] = r11[l] * 0.5f;
+            r21[l] = r12[l] * 0.5f;
+            r22[l] = r13[l] * 0.5f;
+            r11[l] = (v34[l] != 0.0f) ? r20[l] : r11[l];
+            r12[l] = (v34[l] != 0.0f) ? r21[l] : r12[l];
+            r13[l] = (v34[l] != 0.0f) ? r22[l] : r13[l];
+        }
+    skip24:
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = r11[l];
+            outputs[1 * count + base + l] = r12[l];
+            outputs[2 * count + base + l] = r13[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// CreateShadowShader_CreateShadow_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms17[] = { "gWorldLightViewProjectionMatrix", NULL };
+static const char* const gSamplers17[] = { NULL };
+
+static void CreateShadowShader_CreateShadow_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float u2 = uniforms[2];
+    const float u3 = uniforms[3];
+    const float u4 = uniforms[4];
+    const float u5 = uniforms[5];
+    const float u6 = uniforms[6];
+    const float u7 = uniforms[7];
+    const float u8 = uniforms[8];
+    const float u9 = uniforms[9];
+    const float u10 = uniforms[10];
+    const float u11 = uniforms[11];
+    const float u12 = uniforms[12];
+    const float u13 = uniforms[13];
+    const float u14 = uniforms[14];
+    const float u15 = uniforms[15];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float v24[SHADER_LANES];
+    float v28[SHADER_LANES];
+    float v32[SHADER_LANES];
+    float v36[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v21 = r0[l] * u0;
+            float v22 = r1[l] * u4 + v21;
+            float v23 = r2[l] * u8 + v22;
+            v24[l] = r3[l] * u12 + v23;
+            float v25 = r0[l] * u1;
+            float v26 = r1[l] * u5 + v25;
+            float v27 = r2[l] * u9 + v26;
+            v28[l] = r3[l] * u13 + v27;
+            float v29 = r0[l] * u2;
+            float v30 = r1[l] * u6 + v29;
+            float v31 = r2[l] * u10 + v30;
+            v32[l] = r3[l] * u14 + v31;
+            float v33 = r0[l] * u3;
+            float v34 = r1[l] * u7 + v33;
+            float v35 = r2[l] * u11 + v34;
+            v36[l] = r3[l] * u15 + v35;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v24[l];
+            outputs[1 * count + base + l] = v28[l];
+            outputs[2 * count + base + l] = v32[l];
+            outputs[3 * count + base + l] = v36[l];
+            outputs[4 * count + base + l] = v24[l];
+            outputs[5 * count + base + l] = v28[l];
+            outputs[6 * count + base + l] = v32[l];
+            outputs[7 * count + base + l] = v36[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// CreateShadowShader_CreateShadow_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms18[] = { NULL };
+static const char* const gSamplers18[] = { NULL };
+
+static void CreateShadowShader_CreateShadow_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float v6[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            v6[l] = r2[l] / r3[l];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v6[l];
+            outputs[1 * count + base + l] = v6[l];
+            outputs[2 * count + base + l] = v6[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ColorConversion_Grayscale_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms19[] = { NULL };
+static const char* const gSamplers19[] = { NULL };
+
+static void ColorConversion_Grayscale_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = r0[l];
+            outputs[1 * count + base + l] = r1[l];
+            outputs[2 * count + base + l] = r2[l];
+            outputs[3 * count + base + l] = r3[l];
+            outputs[4 * count + base + l] = r4[l];
+            outputs[5 * count + base + l] = r5[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ColorConversion_Grayscale_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms20[] = { NULL };
+static const char* const gSamplers20[] = { "SceneSampler", NULL };
+
+static void ColorConversion_Grayscale_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float v6[SHADER_LANES];
+    float v7[SHADER_LANES];
+    float v8[SHADER_LANES];
+    float v9[SHADER_LANES];
+    float v12[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v6[l] = rgba[0];
+            v7[l] = rgba[1];
+            v8[l] = rgba[2];
+            v9[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v10 = v6[l] * 0.300000012f;
+            float v11 = v7[l] * 0.589999974f + v10;
+            v12[l] = v8[l] * 0.109999999f + v11;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v12[l];
+            outputs[1 * count + base + l] = v12[l];
+            outputs[2 * count + base + l] = v12[l];
+            outputs[3 * count + base + l] = v9[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ColorConversion_NoEffect_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms21[] = { NULL };
+static const char* const gSamplers21[] = { "SceneSampler", NULL };
+
+static void ColorConversion_NoEffect_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float v3[SHADER_LANES];
+    float v4[SHADER_LANES];
+    float v5[SHADER_LANES];
+    float v6[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v3[l] = rgba[0];
+            v4[l] = rgba[1];
+            v5[l] = rgba[2];
+            v6[l] = rgba[3];
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v3[l];
+            outputs[1 * count + base + l] = v4[l];
+            outputs[2 * count + base + l] = v5[l];
+            outputs[3 * count + base + l] = v6[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ColorConversion_Sepia_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms22[] = { NULL };
+static const char* const gSamplers22[] = { "SceneSampler", NULL };
+
+static void ColorConversion_Sepia_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float v12[SHADER_LANES];
+    float v13[SHADER_LANES];
+    float v14[SHADER_LANES];
+    float v15[SHADER_LANES];
+    float v19[SHADER_LANES];
+    float v22[SHADER_LANES];
+    float v25[SHADER_LANES];
+    float v28[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v12[l] = rgba[0];
+            v13[l] = rgba[1];
+            v14[l] = rgba[2];
+            v15[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v16 = v12[l];
+            float v17 = v13[l];
+            float v18 = v14[l];
+            v19[l] = v15[l];
+            float v20 = v16 * 0.393000007f;
+            float v21 = v17 * 0.768999994f + v20;
+            v22[l] = v18 * 0.188999996f + v21;
+            float v23 = v16 * 0.349000007f;
+            float v24 = v17 * 0.68599999f + v23;
+            v25[l] = v18 * 0.167999998f + v24;
+            float v26 = v16 * 0.272000015f;
+            float v27 = v17 * 0.533999979f + v26;
+            v28[l] = v18 * 0.130999997f + v27;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v22[l];
+            outputs[1 * count + base + l] = v25[l];
+            outputs[2 * count + base + l] = v28[l];
+            outputs[3 * count + base + l] = v19[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// EdgeDetection_EdgeDetection_Vertex_Shader_vs_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms23[] = { "gUVScale", NULL };
+static const char* const gSamplers23[] = { NULL };
+
+static void EdgeDetection_EdgeDetection_Vertex_Shader_vs_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float r2[SHADER_LANES] = { 0.0f };
+    float r3[SHADER_LANES] = { 0.0f };
+    float r4[SHADER_LANES] = { 0.0f };
+    float r5[SHADER_LANES] = { 0.0f };
+    float v9[SHADER_LANES];
+    float v10[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+            r2[l] = inputs[2 * count + n];
+            r3[l] = inputs[3 * count + n];
+            r4[l] = inputs[4 * count + n];
+            r5[l] = inputs[5 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            v9[l] = r4[l] * u0;
+            v10[l] = r5[l] * u1;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = r0[l];
+            outputs[1 * count + base + l] = r1[l];
+            outputs[2 * count + base + l] = r2[l];
+            outputs[3 * count + base + l] = r3[l];
+            outputs[4 * count + base + l] = v9[l];
+            outputs[5 * count + base + l] = v10[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// EdgeDetection_EdgeDetection_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms24[] = { "gPixelOffset", NULL };
+static const char* const gSamplers24[] = { "SceneSampler", NULL };
+
+static void EdgeDetection_EdgeDetection_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float v11 = -u0;
+    const float v12 = -u1;
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float v13[SHADER_LANES];
+    float v14[SHADER_LANES];
+    float v15[SHADER_LANES];
+    float v16[SHADER_LANES];
+    float v17[SHADER_LANES];
+    float v22[SHADER_LANES];
+    float v23[SHADER_LANES];
+    float v24[SHADER_LANES];
+    float v25[SHADER_LANES];
+    float v26[SHADER_LANES];
+    float v32[SHADER_LANES];
+    float v33[SHADER_LANES];
+    float v34[SHADER_LANES];
+    float v35[SHADER_LANES];
+    float v36[SHADER_LANES];
+    float v41[SHADER_LANES];
+    float v42[SHADER_LANES];
+    float v43[SHADER_LANES];
+    float v44[SHADER_LANES];
+    float v45[SHADER_LANES];
+    float v51[SHADER_LANES];
+    float v52[SHADER_LANES];
+    float v53[SHADER_LANES];
+    float v54[SHADER_LANES];
+    float v60[SHADER_LANES];
+    float v61[SHADER_LANES];
+    float v62[SHADER_LANES];
+    float v63[SHADER_LANES];
+    float v64[SHADER_LANES];
+    float v70[SHADER_LANES];
+    float v71[SHADER_LANES];
+    float v72[SHADER_LANES];
+    float v73[SHADER_LANES];
+    float v74[SHADER_LANES];
+    float v80[SHADER_LANES];
+    float v81[SHADER_LANES];
+    float v82[SHADER_LANES];
+    float v83[SHADER_LANES];
+    float v94[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            v13[l] = r0[l] + v11;
+            v14[l] = r1[l] + v12;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v13[l], v14[l], rgba);
+            v15[l] = rgba[0];
+            v16[l] = rgba[1];
+            v17[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v19 = v15[l] * 0.300000012f;
+            float v20 = v16[l] * 0.589999974f + v19;
+            float v21 = v17[l] * 0.109999999f + v20;
+            v22[l] = -v21;
+            v23[l] = v21;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], v14[l], rgba);
+            v24[l] = rgba[0];
+            v25[l] = rgba[1];
+            v26[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v28 = v24[l] * 0.300000012f;
+            float v29 = v25[l] * 0.589999974f + v28;
+            float v30 = v26[l] * 0.109999999f + v29;
+            float v31 = v30 * 2.0f;
+            v32[l] = v23[l] + v31;
+            v33[l] = r0[l] + u0;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v33[l], v14[l], rgba);
+            v34[l] = rgba[0];
+            v35[l] = rgba[1];
+            v36[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v38 = v34[l] * 0.300000012f;
+            float v39 = v35[l] * 0.589999974f + v38;
+            float v40 = v36[l] * 0.109999999f + v39;
+            v41[l] = v22[l] + v40;
+            v42[l] = v32[l] + v40;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v13[l], r1[l], rgba);
+            v43[l] = rgba[0];
+            v44[l] = rgba[1];
+            v45[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v47 = v43[l] * 0.300000012f;
+            float v48 = v44[l] * 0.589999974f + v47;
+            float v49 = v45[l] * 0.109999999f + v48;
+            float v50 = v49 * (-2.0f);
+            v51[l] = v41[l] + v50;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v33[l], r1[l], rgba);
+            v52[l] = rgba[0];
+            v53[l] = rgba[1];
+            v54[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v56 = v52[l] * 0.300000012f;
+            float v57 = v53[l] * 0.589999974f + v56;
+            float v58 = v54[l] * 0.109999999f + v57;
+            float v59 = v58 * 2.0f;
+            v60[l] = v51[l] + v59;
+            v61[l] = r1[l] + u1;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v13[l], v61[l], rgba);
+            v62[l] = rgba[0];
+            v63[l] = rgba[1];
+            v64[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v66 = v62[l] * 0.300000012f;
+            float v67 = v63[l] * 0.589999974f + v66;
+            float v68 = v64[l] * 0.109999999f + v67;
+            float v69 = -v68;
+            v70[l] = v60[l] + v69;
+            v71[l] = v42[l] + v69;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], v61[l], rgba);
+            v72[l] = rgba[0];
+            v73[l] = rgba[1];
+            v74[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v76 = v72[l] * 0.300000012f;
+            float v77 = v73[l] * 0.589999974f + v76;
+            float v78 = v74[l] * 0.109999999f + v77;
+            float v79 = v78 * (-2.0f);
+            v80[l] = v71[l] + v79;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v33[l], v61[l], rgba);
+            v81[l] = rgba[0];
+            v82[l] = rgba[1];
+            v83[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v85 = v81[l] * 0.300000012f;
+            float v86 = v82[l] * 0.589999974f + v85;
+            float v87 = v83[l] * 0.109999999f + v86;
+            float v88 = v70[l] + v87;
+            float v89 = -v87;
+            float v90 = v80[l] + v89;
+            float v91 = v88 * v88;
+            float v92 = v90 * v90;
+            float v93 = v91 + v92;
+            v94[l] = sqrtf(v93);
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v94[l];
+            outputs[1 * count + base + l] = v94[l];
+            outputs[2 * count + base + l] = v94[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// EdgeDetection_Emboss_Pixel_Shader_ps_main
+//----------------------------------------------------------------------
+
+static const char* const gUniforms25[] = { "gPixelOffset", NULL };
+static const char* const gSamplers25[] = { "SceneSampler", NULL };
+
+static void EdgeDetection_Emboss_Pixel_Shader_ps_main(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    const float u0 = uniforms[0];
+    const float u1 = uniforms[1];
+    const float v12 = -u0;
+    const float v13 = -u1;
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float v14[SHADER_LANES];
+    float v15[SHADER_LANES];
+    float v16[SHADER_LANES];
+    float v17[SHADER_LANES];
+    float v18[SHADER_LANES];
+    float v23[SHADER_LANES];
+    float v24[SHADER_LANES];
+    float v25[SHADER_LANES];
+    float v26[SHADER_LANES];
+    float v32[SHADER_LANES];
+    float v33[SHADER_LANES];
+    float v34[SHADER_LANES];
+    float v35[SHADER_LANES];
+    float v41[SHADER_LANES];
+    float v42[SHADER_LANES];
+    float v43[SHADER_LANES];
+    float v44[SHADER_LANES];
+    float v45[SHADER_LANES];
+    float v50[SHADER_LANES];
+    float v51[SHADER_LANES];
+    float v52[SHADER_LANES];
+    float v53[SHADER_LANES];
+    float v54[SHADER_LANES];
+    float v59[SHADER_LANES];
+    float v60[SHADER_LANES];
+    float v61[SHADER_LANES];
+    float v62[SHADER_LANES];
+    float v69[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            v14[l] = r0[l] + v12;
+            v15[l] = r1[l] + v13;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v14[l], v15[l], rgba);
+            v16[l] = rgba[0];
+            v17[l] = rgba[1];
+            v18[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v20 = v16[l] * 0.300000012f;
+            float v21 = v17[l] * 0.589999974f + v20;
+            float v22 = v18[l] * 0.109999999f + v21;
+            v23[l] = v22 * (-2.0f);
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], v15[l], rgba);
+            v24[l] = rgba[0];
+            v25[l] = rgba[1];
+            v26[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v28 = v24[l] * 0.300000012f;
+            float v29 = v25[l] * 0.589999974f + v28;
+            float v30 = v26[l] * 0.109999999f + v29;
+            float v31 = -v30;
+            v32[l] = v23[l] + v31;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v14[l], r1[l], rgba);
+            v33[l] = rgba[0];
+            v34[l] = rgba[1];
+            v35[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v37 = v33[l] * 0.300000012f;
+            float v38 = v34[l] * 0.589999974f + v37;
+            float v39 = v35[l] * 0.109999999f + v38;
+            float v40 = -v39;
+            v41[l] = v32[l] + v40;
+            v42[l] = r0[l] + u0;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v42[l], r1[l], rgba);
+            v43[l] = rgba[0];
+            v44[l] = rgba[1];
+            v45[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v47 = v43[l] * 0.300000012f;
+            float v48 = v44[l] * 0.589999974f + v47;
+            float v49 = v45[l] * 0.109999999f + v48;
+            v50[l] = v41[l] + v49;
+            v51[l] = r1[l] + u1;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], v51[l], rgba);
+            v52[l] = rgba[0];
+            v53[l] = rgba[1];
+            v54[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v56 = v52[l] * 0.300000012f;
+            float v57 = v53[l] * 0.589999974f + v56;
+            float v58 = v54[l] * 0.109999999f + v57;
+            v59[l] = v50[l] + v58;
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], v42[l], v51[l], rgba);
+            v60[l] = rgba[0];
+            v61[l] = rgba[1];
+            v62[l] = rgba[2];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v64 = v60[l] * 0.300000012f;
+            float v65 = v61[l] * 0.589999974f + v64;
+            float v66 = v62[l] * 0.109999999f + v65;
+            float v67 = v66 * 2.0f;
+            float v68 = v59[l] + v67;
+            v69[l] = v68 + 0.5f;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v69[l];
+            outputs[1 * count + base + l] = v69[l];
+            outputs[2 * count + base + l] = v69[l];
+            outputs[3 * count + base + l] = 1.0f;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// ColorConversion_Sepia_Pixel_Shader_ps_main_26
+//----------------------------------------------------------------------
+
+static const char* const gUniforms26[] = { NULL };
+static const char* const gSamplers26[] = { "SceneSampler", NULL };
+
+static void ColorConversion_Sepia_Pixel_Shader_ps_main_26(const float* uniforms, const ShaderTexture* const* textures,
+    const float* inputs, float* outputs, int count)
+{
+    float r0[SHADER_LANES] = { 0.0f };
+    float r1[SHADER_LANES] = { 0.0f };
+    float v12[SHADER_LANES];
+    float v13[SHADER_LANES];
+    float v14[SHADER_LANES];
+    float v15[SHADER_LANES];
+    float v19[SHADER_LANES];
+    float v22[SHADER_LANES];
+    float v25[SHADER_LANES];
+    float v28[SHADER_LANES];
+
+    for (int base = 0; base < count; base += SHADER_LANES)
+    {
+        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            int n = base + ((l < lanes) ? l : lanes - 1);
+            r0[l] = inputs[0 * count + n];
+            r1[l] = inputs[1 * count + n];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float rgba[4];
+            SampleTexture2D(textures[0], r0[l], r1[l], rgba);
+            v12[l] = rgba[0];
+            v13[l] = rgba[1];
+            v14[l] = rgba[2];
+            v15[l] = rgba[3];
+        }
+        for (int l = 0; l < SHADER_LANES; ++l)
+        {
+            float v16 = v12[l];
+            float v17 = v13[l];
+            float v18 = v14[l];
+            v19[l] = v15[l];
+            float v20 = v16 * 0.393000007f;
+            float v21 = v17 * 0.768999994f + v20;
+            v22[l] = v18 * 0.188999996f + v21;
+            float v23 = v16 * 0.349000007f;
+            float v24 = v17 * 0.68599999f + v23;
+            v25[l] = v18 * 0.167999998f + v24;
+            float v26 = v16 * 0.272000015f;
+            float v27 = v18 * 0.533999979f + v26;
+            v28[l] = v18 * 0.130999997f + v27;
+        }
+        for (int l = 0; l < lanes; ++l)
+        {
+            outputs[0 * count + base + l] = v22[l];
+            outputs[1 * count + base + l] = v25[l];
+            outputs[2 * count + base + l] = v28[l];
+            outputs[3 * count + base + l] = v19[l];
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// table
+//----------------------------------------------------------------------
+
+extern const ShaderKernel gShaderKernels[] =
+{
+    { "02_ColorShader/ColorShader.fx", "ColorShader_Pass_0_Vertex_Shader_vs_main", gUniforms0, gSamplers0, 4, 4, ColorShader_Pass_0_Vertex_Shader_vs_main },
+    { "02_ColorShader/ColorShader.fx", "ColorShader_Pass_0_Pixel_Shader_ps_main", gUniforms1, gSamplers1, 0, 4, ColorShader_Pass_0_Pixel_Shader_ps_main },
+    { "03_TextureMapping/TextureMapping.fx", "TextureMapping_Pass_0_Vertex_Shader_vs_main", gUniforms2, gSamplers2, 6, 6, TextureMapping_Pass_0_Vertex_Shader_vs_main },
+    { "03_TextureMapping/TextureMapping.fx", "TextureMapping_Pass_0_Pixel_Shader_ps_main", gUniforms3, gSamplers3, 2, 4, TextureMapping_Pass_0_Pixel_Shader_ps_main },
+    { "04_Lighting/Lighting.fx", "Lighting_Pass_0_Vertex_Shader_vs_main", gUniforms4, gSamplers4, 7, 13, Lighting_Pass_0_Vertex_Shader_vs_main },
+    { "04_Lighting/Lighting.fx", "Lighting_Pass_0_Pixel_Shader_ps_main", gUniforms5, gSamplers5, 9, 4, Lighting_Pass_0_Pixel_Shader_ps_main },
+    { "05_DiffuseSpecularMapping/SpecularMapping.fx", "SpecularMapping_Pass_0_Vertex_Shader_vs_main", gUniforms6, gSamplers6, 9, 15, SpecularMapping_Pass_0_Vertex_Shader_vs_main },
+    { "05_DiffuseSpecularMapping/SpecularMapping.fx", "SpecularMapping_Pass_0_Pixel_Shader_ps_main", gUniforms7, gSamplers7, 11, 4, SpecularMapping_Pass_0_Pixel_Shader_ps_main },
+    { "06_ToonShader/ToonShader.fx", "ToonShader_Pass_0_Vertex_Shader_vs_main", gUniforms8, gSamplers8, 7, 7, ToonShader_Pass_0_Vertex_Shader_vs_main },
+    { "06_ToonShader/ToonShader.fx", "ToonShader_Pass_0_Pixel_Shader_ps_main", gUniforms9, gSamplers9, 3, 4, ToonShader_Pass_0_Pixel_Shader_ps_main },
+    { "07_NormalMapping/NormalMapping.fx", "NormalMapping_Pass_0_Vertex_Shader_vs_main", gUniforms10, gSamplers10, 15, 21, NormalMapping_Pass_0_Vertex_Shader_vs_main },
+    { "07_NormalMapping/NormalMapping.fx", "NormalMapping_Pass_0_Pixel_Shader_ps_main", gUniforms11, gSamplers11, 17, 4, NormalMapping_Pass_0_Pixel_Shader_ps_main },
+    { "08_EnvironmentMapping/EnvironmentMapping.fx", "EnvironmentMapping_Pass_0_Vertex_Shader_vs_main", gUniforms10, gSamplers10, 15, 21, NormalMapping_Pass_0_Vertex_Shader_vs_main },
+    { "08_EnvironmentMapping/EnvironmentMapping.fx", "EnvironmentMapping_Pass_0_Pixel_Shader_ps_main", gUniforms12, gSamplers12, 17, 4, EnvironmentMapping_Pass_0_Pixel_Shader_ps_main },
+    { "09_UVAnimation/UVAnimation.fx", "UVAnimation_Pass_0_Vertex_Shader_vs_main", gUniforms13, gSamplers13, 9, 15, UVAnimation_Pass_0_Vertex_Shader_vs_main },
+    { "09_UVAnimation/UVAnimation.fx", "UVAnimation_Pass_0_Pixel_Shader_ps_main", gUniforms14, gSamplers14, 11, 4, UVAnimation_Pass_0_Pixel_Shader_ps_main },
+    { "10_ShadowMapping/ApplyShadow.fx", "ApplyShadowShader_ApplyShadowTorus_Vertex_Shader_vs_main", gUniforms15, gSamplers15, 7, 9, ApplyShadowShader_ApplyShadowTorus_Vertex_Shader_vs_main },
+    { "10_ShadowMapping/ApplyShadow.fx", "ApplyShadowShader_ApplyShadowTorus_Pixel_Shader_ps_main", gUniforms16, gSamplers16, 5, 4, ApplyShadowShader_ApplyShadowTorus_Pixel_Shader_ps_main },
+    { "10_ShadowMapping/CreateShadow.fx", "CreateShadowShader_CreateShadow_Vertex_Shader_vs_main", gUniforms17, gSamplers17, 4, 8, CreateShadowShader_CreateShadow_Vertex_Shader_vs_main },
+    { "10_ShadowMapping/CreateShadow.fx", "CreateShadowShader_CreateShadow_Pixel_Shader_ps_main", gUniforms18, gSamplers18, 4, 4, CreateShadowShader_CreateShadow_Pixel_Shader_ps_main },
+    { "11_ColorConversion/EnvironmentMapping.fx", "EnvironmentMapping_Pass_0_Vertex_Shader_vs_main", gUniforms10, gSamplers10, 15, 21, NormalMapping_Pass_0_Vertex_Shader_vs_main },
+    { "11_ColorConversion/EnvironmentMapping.fx", "EnvironmentMapping_Pass_0_Pixel_Shader_ps_main", gUniforms12, gSamplers12, 17, 4, EnvironmentMapping_Pass_0_Pixel_Shader_ps_main },
+    { "11_ColorConversion/Grayscale.fx", "ColorConversion_Grayscale_Vertex_Shader_vs_main", gUniforms19, gSamplers19, 6, 6, ColorConversion_Grayscale_Vertex_Shader_vs_main },
+    { "11_ColorConversion/Grayscale.fx", "ColorConversion_Grayscale_Pixel_Shader_ps_main", gUniforms20, gSamplers20, 2, 4, ColorConversion_Grayscale_Pixel_Shader_ps_main },
+    { "11_ColorConversion/NoEffect.fx", "ColorConversion_NoEffect_Vertex_Shader_vs_main", gUniforms19, gSamplers19, 6, 6, ColorConversion_Grayscale_Vertex_Shader_vs_main },
+    { "11_ColorConversion/NoEffect.fx", "ColorConversion_NoEffect_Pixel_Shader_ps_main", gUniforms21, gSamplers21, 2, 4, ColorConversion_NoEffect_Pixel_Shader_ps_main },
+    { "11_ColorConversion/Sepia.fx", "ColorConversion_Sepia_Vertex_Shader_vs_main", gUniforms19, gSamplers19, 6, 6, ColorConversion_Grayscale_Vertex_Shader_vs_main },
+    { "11_ColorConversion/Sepia.fx", "ColorConversion_Sepia_Pixel_Shader_ps_main", gUniforms22, gSamplers22, 2, 4, ColorConversion_Sepia_Pixel_Shader_ps_main },
+    { "12_EdgeDetection/EdgeDetection.fx", "EdgeDetection_EdgeDetection_Vertex_Shader_vs_main", gUniforms23, gSamplers23, 6, 6, EdgeDetection_EdgeDetection_Vertex_Shader_vs_main },
+    { "12_EdgeDetection/EdgeDetection.fx", "EdgeDetection_EdgeDetection_Pixel_Shader_ps_main", gUniforms24, gSamplers24, 2, 4, EdgeDetection_EdgeDetection_Pixel_Shader_ps_main },
+    { "12_EdgeDetection/Emboss.fx", "EdgeDetection_Emboss_Vertex_Shader_vs_main", gUniforms23, gSamplers23, 6, 6, EdgeDetection_EdgeDetection_Vertex_Shader_vs_main },
+    { "12_EdgeDetection/Emboss.fx", "EdgeDetection_Emboss_Pixel_Shader_ps_main", gUniforms25, gSamplers25, 2, 4, EdgeDetection_Emboss_Pixel_Shader_ps_main },
+    { "12_EdgeDetection/EnvironmentMapping.fx", "EnvironmentMapping_Pass_0_Vertex_Shader_vs_main", gUniforms10, gSamplers10, 15, 21, NormalMapping_Pass_0_Vertex_Shader_vs_main },
+    { "12_EdgeDetection/EnvironmentMapping.fx", "EnvironmentMapping_Pass_0_Pixel_Shader_ps_main", gUniforms12, gSamplers12, 17, 4, EnvironmentMapping_Pass_0_Pixel_Shader_ps_main },
+    { "12_EdgeDetection/Grayscale.fx", "ColorConversion_Grayscale_Vertex_Shader_vs_main", gUniforms23, gSamplers23, 6, 6, EdgeDetection_EdgeDetection_Vertex_Shader_vs_main },
+    { "12_EdgeDetection/Grayscale.fx", "ColorConversion_Grayscale_Pixel_Shader_ps_main", gUniforms20, gSamplers20, 2, 4, ColorConversion_Grayscale_Pixel_Shader_ps_main },
+    { "12_EdgeDetection/NoEffect.fx", "ColorConversion_NoEffect_Vertex_Shader_vs_main", gUniforms23, gSamplers23, 6, 6, EdgeDetection_EdgeDetection_Vertex_Shader_vs_main },
+    { "12_EdgeDetection/NoEffect.fx", "ColorConversion_NoEffect_Pixel_Shader_ps_main", gUniforms21, gSamplers21, 2, 4, ColorConversion_NoEffect_Pixel_Shader_ps_main },
+    { "12_EdgeDetection/Sepia.fx", "ColorConversion_Sepia_Vertex_Shader_vs_main", gUniforms23, gSamplers23, 6, 6, EdgeDetection_EdgeDetection_Vertex_Shader_vs_main },
+    { "12_EdgeDetection/Sepia.fx", "ColorConversion_Sepia_Pixel_Shader_ps_main", gUniforms26, gSamplers26, 2, 4, ColorConversion_Sepia_Pixel_Shader_ps_main_26 },
+};
+
+extern const int gNumShaderKernels = 40;
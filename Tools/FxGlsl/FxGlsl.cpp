@@ -0,0 +1,253 @@
+//**********************************************************************
+//
+// FxGlsl.cpp
+//
+// Translates every pass of the samples' effects into GLSL 3.30 ahead of
+// time (see GlslTranslator.h) and fills the cache an OpenGL backend
+// reads them from. Each pass is compiled as CreateRenderPipeline would,
+// then looked up in the cache under the hash of its bytecode and layout;
+// only the passes not found are translated. For each entry the cache
+// holds the vertex shader (.vert), the pixel shader (.frag) and what
+// binding them takes (.txt): the uniforms' offsets in the block, the
+// samplers' texture units and the attributes' locations.
+//
+// usage: FxGlsl [-cache GlslCache] [-define NAME=VALUE] file.fx ...
+//        FxGlsl [-cache GlslCache] [-define NAME=VALUE] -root ..\..
+//
+// On Linux:
+//   g++ -O2 -std=c++11 -pthread -I01_DxFramework Tools/FxGlsl/FxGlsl.cpp
+//   01_DxFramework/{GlslTranslator,RenderBackend,ShaderInterpreter,
+//   EffectSource,XMeshLoader,FileUtil,TgaLoader,DdsLoader,CpuFeatures,
+//   JobSystem}.cpp -o FxGlsl
+//
+//**********************************************************************
+
+#include "GlslTranslator.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// the .fx files in 01_DxFramework are older copies that no sample
+// loads, so they are not translated
+static const char* gSamples[] =
+{
+    "02_ColorShader",
+    "03_TextureMapping",
+    "04_Lighting",
+    "05_DiffuseSpecularMapping",
+    "06_ToonShader",
+    "07_NormalMapping",
+    "08_EnvironmentMapping",
+    "09_UVAnimation",
+    "10_ShadowMapping",
+    "11_ColorConversion",
+    "12_EdgeDetection"
+};
+
+#define NUM_SAMPLES (sizeof(gSamples) / sizeof(gSamples[0]))
+
+struct Totals
+{
+    int passes;
+    int translated;
+    int cached;
+    int failed;
+    double translateMs;
+};
+
+static double NowMs()
+{
+#ifdef _WIN32
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    return now.QuadPart * 1000.0 / frequency.QuadPart;
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
+
+// the .fx files of one sample folder
+static void FindEffects(const std::string& folder, std::vector<std::string>* files)
+{
+#ifdef _WIN32
+    WIN32_FIND_DATA found;
+    HANDLE find = FindFirstFile((folder + "\\*.fx").c_str(), &found);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    do
+    {
+        files->push_back(folder + "\\" + found.cFileName);
+    } while (FindNextFile(find, &found));
+    FindClose(find);
+#else
+    DIR* dir = opendir(folder.c_str());
+    if (!dir)
+    {
+        return;
+    }
+    std::vector<std::string> names;
+    for (dirent* entry = readdir(dir); entry; entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".fx") == 0)
+        {
+            names.push_back(folder + "/" + name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    files->insert(files->end(), names.begin(), names.end());
+#endif
+}
+
+static void MakeDirectory(const char* directory)
+{
+#ifdef _WIN32
+    CreateDirectory(directory, NULL);
+#else
+    mkdir(directory, 0777);
+#endif
+}
+
+// false if a pass could not be compiled, translated or stored
+static bool TranslateFile(const char* filename, const std::map<std::string, std::string>& defines,
+    const char* cache, Totals* totals)
+{
+    EffectSource effect;
+    if (!LoadEffectSource(filename, &effect, &defines))
+    {
+        printf("%s: cannot read\n", filename);
+        ++totals->failed;
+        return false;
+    }
+
+    printf("%s\n", filename);
+
+    // the passes, in the order the effect has them
+    std::vector<std::pair<std::string, std::string> > passes;
+    for (size_t i = 0; i < effect.shaders.size(); ++i)
+    {
+        std::pair<std::string, std::string> pass(effect.shaders[i].technique, effect.shaders[i].pass);
+        if (std::find(passes.begin(), passes.end(), pass) == passes.end())
+        {
+            passes.push_back(pass);
+        }
+    }
+    ReleaseEffectSource(&effect);
+
+    bool succeeded = true;
+    for (size_t p = 0; p < passes.size(); ++p)
+    {
+        RenderPipelineDesc desc;
+        desc.effect = filename;
+        desc.technique = passes[p].first.c_str();
+        desc.pass = passes[p].second.c_str();
+        desc.defines = &defines;
+        desc.format = RENDER_FORMAT_RGBA8;
+
+        std::string name = passes[p].first + "/" + passes[p].second;
+        ++totals->passes;
+
+        RenderPipeline compiled;
+        if (!CompileRenderPipeline(desc, &compiled))
+        {
+            printf("  %-32s cannot be compiled\n", name.c_str());
+            ++totals->failed;
+            succeeded = false;
+            continue;
+        }
+
+        unsigned long long key = GetGlslKey(compiled);
+        GlslProgram glsl;
+        const char* result = "cached";
+        if (LoadGlslCache(cache, key, &glsl))
+        {
+            ++totals->cached;
+        }
+        else
+        {
+            double start = NowMs();
+            bool translated = TranslateToGlsl(compiled, &glsl);
+            totals->translateMs += NowMs() - start;
+            if (!translated || !StoreGlslCache(cache, key, glsl))
+            {
+                printf("  %-32s %s\n", name.c_str(), translated ? "cannot be stored" : glsl.error.c_str());
+                ++totals->failed;
+                succeeded = false;
+                continue;
+            }
+            ++totals->translated;
+            result = "translated";
+        }
+
+        printf("  %-32s %016llx  %3d vec4s  %d samplers  %d attributes  %s\n", name.c_str(), key,
+            glsl.uniformSize / 4, (int)glsl.samplers.size(), (int)glsl.attributes.size(), result);
+    }
+    return succeeded;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> files;
+    std::map<std::string, std::string> defines;
+    const char* cache = "GlslCache";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc)
+        {
+            cache = argv[++i];
+        }
+        else if (strcmp(argv[i], "-define") == 0 && i + 1 < argc)
+        {
+            std::string define = argv[++i];
+            size_t equals = define.find('=');
+            defines[define.substr(0, equals)] = (equals == std::string::npos) ? "1" : define.substr(equals + 1);
+        }
+        else if (strcmp(argv[i], "-root") == 0 && i + 1 < argc)
+        {
+            std::string root = argv[++i];
+            for (size_t s = 0; s < NUM_SAMPLES; ++s)
+            {
+                FindEffects(root + "/" + gSamples[s], &files);
+            }
+        }
+        else if (argv[i][0] != '-')
+        {
+            files.push_back(argv[i]);
+        }
+        else
+        {
+            printf("usage: FxGlsl [-cache GlslCache] [-define NAME=VALUE] file.fx ...\n"
+                   "       FxGlsl [-cache GlslCache] [-define NAME=VALUE] -root ..\\..\n");
+            return 1;
+        }
+    }
+
+    MakeDirectory(cache);
+
+    Totals totals;
+    memset(&totals, 0, sizeof(totals));
+    bool failed = false;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        failed = !TranslateFile(files[i].c_str(), defines, cache, &totals) || failed;
+    }
+
+    printf("\n%d files, %d passes: %d translated in %.1f ms, %d from %s, %d failed\n", (int)files.size(),
+        totals.passes, totals.translated, totals.translateMs, totals.cached, cache, totals.failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,285 @@
+//**********************************************************************
+//
+// FxHoist.cpp
+//
+// Finds the work in an effect's shaders that is the same for every
+// vertex or pixel of a draw, so it can be done once per draw on the CPU
+// and passed in as a constant instead:
+//
+//   uniform      an expression that only reads uniforms, e.g.
+//                mul(gWorldLightPosition, gInvWorldMatrix)
+//   chain        a vector multiplied by two or more uniform matrices in
+//                a row, e.g. mul(mul(p, gViewMatrix), gProjectionMatrix),
+//                where the matrices can be concatenated on the CPU
+//
+// For every technique and pass it prints the estimated instructions of
+// each shader, what can be hoisted and the instructions that saves.
+// The estimates count one instruction per arithmetic operator and
+// vector-matrix column, a few for the longer intrinsics; they are for
+// comparing effects, not exact.
+//
+// The effect compiler already evaluates uniform expressions on the CPU
+// as a preshader, but it does not reorder multiplications, so chains
+// are only shortened by hand.
+//
+// usage: FxHoist file.fx ...
+//        FxHoist -root ..\..        (every .fx in every sample folder)
+//
+//**********************************************************************
+
+#include "EffectSource.h"
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* gSamples[] =
+{
+    "01_DxFramework",
+    "02_ColorShader",
+    "03_TextureMapping",
+    "04_Lighting",
+    "05_DiffuseSpecularMapping",
+    "06_ToonShader",
+    "07_NormalMapping",
+    "08_EnvironmentMapping",
+    "09_UVAnimation",
+    "10_ShadowMapping",
+    "11_ColorConversion",
+    "12_EdgeDetection"
+};
+
+#define NUM_SAMPLES (sizeof(gSamples) / sizeof(gSamples[0]))
+
+//----------------------------------------------------------------------
+// analysis
+//----------------------------------------------------------------------
+
+struct ShaderReport
+{
+    int instructions;
+    int saved;
+    std::vector<std::string> findings;
+};
+
+static bool HasUniformName(const Node* node)
+{
+    if (node->kind == NODE_UNIFORM)
+    {
+        return true;
+    }
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+        if (HasUniformName(node->children[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void CountUses(Node* node, std::map<Node*, int>& uses, std::set<Node*>& visited)
+{
+    if (!visited.insert(node).second)
+    {
+        return;
+    }
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+        ++uses[node->children[i]];
+        CountUses(node->children[i], uses, visited);
+    }
+}
+
+static bool IsMatrixMul(const Node* node)
+{
+    return node->kind == NODE_CALL && node->text == "mul" && node->children.size() == 2 &&
+        node->children[0]->type.rows == 1 && node->children[0]->type.columns > 1 &&
+        node->children[1]->type.rows > 1 && node->children[1]->kind != NODE_CAST;
+}
+
+// walks the shader from its outputs, reporting each hoistable piece once
+static void FindHoistable(Node* node, std::map<Node*, int>& uses, std::set<Node*>& visited,
+    std::set<Node*>& hoisted, ShaderReport& report)
+{
+    if (!visited.insert(node).second)
+    {
+        return;
+    }
+
+    // a uniform expression costing something, at its largest
+    if (node->uniform && node->kind != NODE_OPAQUE && HasUniformName(node))
+    {
+        std::set<Node*> counted;
+        int cost = GetNodeCost(node, counted);
+        if (cost > 0)
+        {
+            char line[512];
+            _snprintf(line, sizeof(line), "uniform  -%-3d %s", cost, PrintNode(node, true).c_str());
+            report.findings.push_back(line);
+            report.saved += cost;
+        }
+        return;
+    }
+
+    // mul(mul(v, A), B): the inner product is only needed for the outer
+    if (IsMatrixMul(node) && node->children[1]->uniform && hoisted.count(node) == 0)
+    {
+        Node* inner = node->children[0];
+        std::string matrices = PrintNode(node->children[1], false);
+        int saved = 0;
+        while (IsMatrixMul(inner) && inner->children[1]->uniform && !inner->children[0]->uniform &&
+            uses[inner] == 1)
+        {
+            saved += inner->cost;
+            matrices = PrintNode(inner->children[1], false) + " * " + matrices;
+            hoisted.insert(inner);
+            inner = inner->children[0];
+        }
+
+        if (saved > 0)
+        {
+            char line[512];
+            _snprintf(line, sizeof(line), "chain    -%-3d mul(%s, %s)", saved,
+                PrintNode(inner, false).c_str(), matrices.c_str());
+            report.findings.push_back(line);
+            report.saved += saved;
+        }
+    }
+
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+        FindHoistable(node->children[i], uses, visited, hoisted, report);
+    }
+}
+
+static ShaderReport AnalyzeFunction(EffectSource& effect, const Function& function)
+{
+    ShaderGraph graph;
+    BuildShaderGraph(effect, function, &graph);
+
+    std::vector<Node*> roots;
+    GetShaderRoots(graph, &roots);
+
+    ShaderReport report;
+    report.instructions = 0;
+    report.saved = 0;
+
+    std::map<Node*, int> uses;
+    std::set<Node*> visited;
+    std::set<Node*> counted;
+    for (size_t i = 0; i < roots.size(); ++i)
+    {
+        CountUses(roots[i], uses, visited);
+        report.instructions += GetNodeCost(roots[i], counted);
+    }
+
+    std::set<Node*> found;
+    std::set<Node*> hoisted;
+    for (size_t i = 0; i < roots.size(); ++i)
+    {
+        FindHoistable(roots[i], uses, found, hoisted, report);
+    }
+
+    return report;
+}
+
+// returns the instructions saved in the whole file, or -1
+static int AnalyzeFile(const char* filename, int* totalInstructions)
+{
+    EffectSource effect;
+    if (!LoadEffectSource(filename, &effect))
+    {
+        printf("%s: cannot read\n", filename);
+        return -1;
+    }
+
+    printf("%s\n", filename);
+
+    int fileSaved = 0;
+    std::string lastPass;
+    for (size_t u = 0; u < effect.shaders.size(); ++u)
+    {
+        const ShaderUse& use = effect.shaders[u];
+        std::string pass = use.technique + " / " + use.pass;
+        if (pass != lastPass)
+        {
+            printf("  %s\n", pass.c_str());
+            lastPass = pass;
+        }
+
+        const Function* function = FindEffectFunction(effect, use.function);
+        if (!function)
+        {
+            printf("    %s  %s not found\n", use.stage.c_str(), use.function.c_str());
+            continue;
+        }
+
+        ShaderReport report = AnalyzeFunction(effect, *function);
+        printf("    %s  %3d -> %3d instructions\n", use.stage.c_str(), report.instructions,
+            report.instructions - report.saved);
+        for (size_t f = 0; f < report.findings.size(); ++f)
+        {
+            printf("          %s\n", report.findings[f].c_str());
+        }
+
+        fileSaved += report.saved;
+        *totalInstructions += report.instructions;
+    }
+
+    ReleaseEffectSource(&effect);
+
+    return fileSaved;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-root") == 0 && i + 1 < argc)
+        {
+            const char* root = argv[++i];
+            for (size_t s = 0; s < NUM_SAMPLES; ++s)
+            {
+                char pattern[MAX_PATH];
+                _snprintf(pattern, MAX_PATH, "%s\\%s\\*.fx", root, gSamples[s]);
+
+                WIN32_FIND_DATA found;
+                HANDLE find = FindFirstFile(pattern, &found);
+                if (find == INVALID_HANDLE_VALUE)
+                {
+                    continue;
+                }
+                do
+                {
+                    files.push_back(std::string(root) + "\\" + gSamples[s] + "\\" + found.cFileName);
+                } while (FindNextFile(find, &found));
+                FindClose(find);
+            }
+        }
+        else if (argv[i][0] != '-')
+        {
+            files.push_back(argv[i]);
+        }
+        else
+        {
+            printf("usage: FxHoist file.fx ...\n"
+                   "       FxHoist -root ..\\..\n");
+            return 1;
+        }
+    }
+
+    int totalSaved = 0;
+    int totalInstructions = 0;
+    bool failed = false;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        int saved = AnalyzeFile(files[i].c_str(), &totalInstructions);
+        failed = failed || (saved < 0);
+        totalSaved += (saved > 0) ? saved : 0;
+    }
+
+    printf("\n%d files, %d instructions, %d can be hoisted\n", (int)files.size(), totalInstructions, totalSaved);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,840 @@
+//**********************************************************************
+//
+// FxKernel.cpp
+//
+// Translates the vertex and pixel shaders of the samples' effects into
+// C++ ahead of time, one function per shader with the same interface as
+// RunShader (see ShaderKernel in ShaderInterpreter.h). Each shader is
+// compiled to bytecode as for the interpreter, then every instruction
+// becomes a line of C++ over the SHADER_LANES lanes, which the compiler
+// can vectorize and optimize across instructions:
+//
+//   baked      a global with an initial value, no semantic and no
+//              annotations, such as the Kx and Ky filters of
+//              EdgeDetection.fx, is compiled in as constants, so the
+//              work it multiplies by zero disappears; -bake adds others
+//   values     every value computed gets its own name, so one computed
+//              twice, like -gPixelOffset.y in each pass of an unrolled
+//              loop, is computed once
+//   uniform    what only depends on uniforms is worked out once per
+//              call instead of once per lane
+//   lanes      runs of instructions go in one loop over the lanes, and
+//              the values only used inside it become locals of the loop
+//
+// The kernels are written to one file with a table of them by effect
+// and function, for FxBench to compare against the interpreter. A shader
+// that is the same in several samples shares one kernel.
+//
+// usage: FxKernel [-o ShaderKernels.cpp] [-bake name] file.fx ...
+//        FxKernel [-o ShaderKernels.cpp] [-bake name] -root ..\..
+//
+//**********************************************************************
+
+#include "ShaderInterpreter.h"
+#include <windows.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// the .fx files in 01_DxFramework are older copies that no sample
+// loads, so they get no kernels
+static const char* gSamples[] =
+{
+    "02_ColorShader",
+    "03_TextureMapping",
+    "04_Lighting",
+    "05_DiffuseSpecularMapping",
+    "06_ToonShader",
+    "07_NormalMapping",
+    "08_EnvironmentMapping",
+    "09_UVAnimation",
+    "10_ShadowMapping",
+    "11_ColorConversion",
+    "12_EdgeDetection"
+};
+
+#define NUM_SAMPLES (sizeof(gSamples) / sizeof(gSamples[0]))
+
+static const char* gHeader =
+    "//**********************************************************************\n"
+    "//\n"
+    "// ShaderKernels.cpp\n"
+    "//\n"
+    "// Written by FxKernel from the samples' effects; do not edit. From\n"
+    "// Tools\\FxBench, FxKernel -root ..\\.. -o ShaderKernels.cpp writes it\n"
+    "// again after a shader changes.\n"
+    "//\n"
+    "//**********************************************************************\n"
+    "\n"
+    "#include \"ShaderInterpreter.h\"\n"
+    "#include <math.h>\n"
+    "#include <stddef.h>\n"
+    "\n"
+    "static float Saturate(float x)\n"
+    "{\n"
+    "    return (x < 0.0f) ? 0.0f : (x > 1.0f) ? 1.0f : x;\n"
+    "}\n"
+    "\n"
+    "static bool AnyLane(const float* mask)\n"
+    "{\n"
+    "    bool any = false;\n"
+    "    for (int l = 0; l < SHADER_LANES; ++l)\n"
+    "    {\n"
+    "        any = any || mask[l] != 0.0f;\n"
+    "    }\n"
+    "    return any;\n"
+    "}\n";
+
+// how a value is held in the kernel
+enum ValueKind
+{
+    VALUE_CONSTANT,             // a literal
+    VALUE_SCALAR,               // the same in every lane
+    VALUE_LANES,                // an array over the lanes, name[l]
+    VALUE_LOCAL                 // a local of the one loop over the lanes using it
+};
+
+// what a register holds at some point: a uniform, a constant, one
+// instruction's result, or a register written where it may be skipped,
+// which keeps one array for all that is written to it
+struct KernelValue
+{
+    ValueKind kind;
+    std::string name;           // or the literal
+    int group;                  // the loop over the lanes writing it, or -1
+    bool used;
+};
+
+struct KernelStep
+{
+    const ShaderInstruction* instruction;
+    int values[4];              // written, four for a texture fetch
+    int sources[3];
+    bool hoisted;               // uniform work, done once per call
+    bool repeated;              // the same as an earlier step
+    int group;                  // loop over the lanes it is in, or -1
+};
+
+struct KernelPlan
+{
+    const ShaderProgram* program;
+    std::vector<KernelValue> values;
+    std::vector<KernelStep> steps;
+    std::vector<bool> landing;          // instructions a skip goes to, or the end
+    std::vector<int> registerValues;    // of each register at the end
+    std::vector<int> uniformValues;     // of each uniform component, or -1
+    std::vector<int> inputValues;       // of each input component
+};
+
+static bool WriteText(const std::string& filename, const std::string& text)
+{
+    FILE* fp = fopen(filename.c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+    fwrite(text.data(), 1, text.size(), fp);
+    fclose(fp);
+    return true;
+}
+
+static std::string Format(const char* format, int value)
+{
+    char text[64];
+    _snprintf(text, sizeof(text), format, value);
+    return text;
+}
+
+// the sample folder and file, e.g. 12_EdgeDetection/Sepia.fx, as the
+// kernel table names them
+static std::string EffectName(const std::string& filename)
+{
+    std::string name = filename;
+    std::replace(name.begin(), name.end(), '\\', '/');
+    size_t file = name.rfind('/');
+    size_t folder = (file == std::string::npos || file == 0) ? std::string::npos : name.rfind('/', file - 1);
+    return (folder == std::string::npos) ? name : name.substr(folder + 1);
+}
+
+//----------------------------------------------------------------------
+// what to bake
+//----------------------------------------------------------------------
+
+// a numeric global with "= value" and neither ": semantic" nor "< ... >"
+static bool IsBakeable(const EffectSource& effect, const Global& global)
+{
+    if (global.type.columns == 0)
+    {
+        return false;
+    }
+
+    bool initialized = false;
+    for (size_t i = global.begin; i < global.end && !initialized; ++i)
+    {
+        const std::string& text = effect.tokens[i].text;
+        if (text == ":" || text == "<")
+        {
+            return false;
+        }
+        initialized = (text == "=");
+    }
+    return initialized;
+}
+
+//----------------------------------------------------------------------
+// planning
+//----------------------------------------------------------------------
+
+static bool IsTexture(const ShaderInstruction& instruction)
+{
+    return instruction.op == SHADER_OP_TEX2D || instruction.op == SHADER_OP_TEXCUBE;
+}
+
+static int Read(const ShaderInstruction& instruction, int s)
+{
+    return (s == 0) ? instruction.a : (s == 1) ? instruction.b : instruction.c;
+}
+
+static int Written(const ShaderInstruction& instruction)
+{
+    return (instruction.op == SHADER_OP_SKIP) ? 0 : IsTexture(instruction) ? 4 : 1;
+}
+
+static std::string FloatLiteral(float value)
+{
+    if (value != value)
+    {
+        return "sqrtf(-1.0f)";
+    }
+    if (value > 3.4e38f || value < -3.4e38f)
+    {
+        return (value > 0.0f) ? "(float)HUGE_VAL" : "(-(float)HUGE_VAL)";
+    }
+
+    char text[64];
+    _snprintf(text, sizeof(text), "%.9g", value);
+    std::string literal = text;
+    if (literal.find_first_of(".e") == std::string::npos)
+    {
+        literal += ".0";
+    }
+    literal += "f";
+    return (literal[0] == '-') ? "(" + literal + ")" : literal;
+}
+
+static int AddValue(KernelPlan* plan, ValueKind kind, const std::string& name)
+{
+    KernelValue value;
+    value.kind = kind;
+    value.name = name;
+    value.group = -1;
+    value.used = false;
+    plan->values.push_back(value);
+    return (int)plan->values.size() - 1;
+}
+
+static bool IsVarying(const KernelPlan& plan, int value)
+{
+    return plan.values[value].kind == VALUE_LANES || plan.values[value].kind == VALUE_LOCAL;
+}
+
+// numbers every value the program computes, so repeats are computed once
+// and uniform work can be moved, then puts runs of per lane steps in one
+// loop over the lanes
+static void PlanKernel(const ShaderProgram& program, KernelPlan* plan)
+{
+    const std::vector<ShaderInstruction>& code = program.code;
+    int registers = program.registerCount;
+
+    plan->program = &program;
+    plan->values.clear();
+    plan->steps.clear();
+    plan->landing.assign(code.size() + 1, false);
+
+    // registers written where a skip may pass over them keep one array
+    std::vector<bool> skippable(registers, false);
+    size_t skippedUntil = 0;
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        if (code[i].op == SHADER_OP_SKIP)
+        {
+            plan->landing[code[i].dst] = true;
+            skippedUntil = (code[i].dst > skippedUntil) ? code[i].dst : skippedUntil;
+            continue;
+        }
+        for (int w = 0; w < Written(code[i]) && i < skippedUntil; ++w)
+        {
+            skippable[code[i].dst + w] = true;
+        }
+    }
+
+    std::vector<int>& current = plan->registerValues;
+    current.assign(registers, -1);
+    std::set<int> inPlace;                      // values of the skippable registers
+    for (int r = 0; r < registers; ++r)
+    {
+        if (r >= program.constantRegister)
+        {
+            current[r] = AddValue(plan, VALUE_CONSTANT, FloatLiteral(program.constants[r - program.constantRegister]));
+        }
+        else if (skippable[r])
+        {
+            current[r] = AddValue(plan, VALUE_LANES, Format("r%d", r));
+            inPlace.insert(current[r]);
+        }
+    }
+    plan->uniformValues.clear();
+    for (size_t u = 0; u < program.uniforms.size(); ++u)
+    {
+        const std::vector<int>& uniformRegisters = program.uniforms[u].registers;
+        for (size_t r = 0; r < uniformRegisters.size(); ++r)
+        {
+            int reg = uniformRegisters[r];
+            if (!skippable[reg])
+            {
+                current[reg] = AddValue(plan, VALUE_SCALAR, Format("u%d", (int)plan->uniformValues.size()));
+            }
+            plan->uniformValues.push_back(current[reg]);
+        }
+    }
+    plan->inputValues.clear();
+    for (size_t i = 0; i < program.inputRegisters.size(); ++i)
+    {
+        int reg = program.inputRegisters[i];
+        if (!skippable[reg])
+        {
+            current[reg] = AddValue(plan, VALUE_LANES, Format("r%d", reg));
+        }
+        plan->inputValues.push_back(current[reg]);
+    }
+    int zero = AddValue(plan, VALUE_CONSTANT, "0.0f");
+
+    std::map<std::string, int> computed;        // op and sources to the step
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        const ShaderInstruction& instruction = code[i];
+        KernelStep step;
+        step.instruction = &instruction;
+        step.hoisted = false;
+        step.repeated = false;
+        step.group = -1;
+
+        bool varies = IsTexture(instruction);
+        bool uniform = !varies;
+        bool skipped = false;
+        std::string key = Format("%d", instruction.op) + Format(" %d", instruction.sampler);
+        for (int s = 0; s < 3; ++s)
+        {
+            int reg = Read(instruction, s);
+            step.sources[s] = (s < GetShaderOpSources(instruction.op)) ? ((current[reg] < 0) ? zero : current[reg]) : -1;
+            if (step.sources[s] >= 0)
+            {
+                KernelValue& source = plan->values[step.sources[s]];
+                varies = varies || IsVarying(*plan, step.sources[s]);
+                uniform = uniform && (source.kind == VALUE_CONSTANT || source.kind == VALUE_SCALAR);
+                key += Format(" %d", step.sources[s]);
+                skipped = skipped || inPlace.count(step.sources[s]) != 0;
+            }
+        }
+
+        // registers a skip may pass over are written in place, so what is
+        // computed from or into them is not reused; only some of a texture
+        // fetch's four may be
+        for (int w = 0; w < Written(instruction); ++w)
+        {
+            skipped = skipped || skippable[instruction.dst + w];
+        }
+        std::map<std::string, int>::iterator found = computed.find(key);
+        for (int w = 0; w < 4; ++w)
+        {
+            step.values[w] = -1;
+        }
+        if (instruction.op == SHADER_OP_SKIP)
+        {
+        }
+        else if (!skipped && found != computed.end())
+        {
+            step.repeated = true;
+            for (int w = 0; w < Written(instruction); ++w)
+            {
+                step.values[w] = plan->steps[found->second].values[w];
+                current[instruction.dst + w] = step.values[w];
+            }
+        }
+        else
+        {
+            for (int w = 0; w < Written(instruction); ++w)
+            {
+                if (skippable[instruction.dst + w])
+                {
+                    step.values[w] = current[instruction.dst + w];
+                    continue;
+                }
+                int value = AddValue(plan, varies ? VALUE_LANES : VALUE_SCALAR,
+                    Format("v%d", (int)plan->values.size()));
+                step.values[w] = value;
+                current[instruction.dst + w] = value;
+            }
+            step.hoisted = uniform && !skipped;
+            if (!skipped)
+            {
+                computed[key] = (int)plan->steps.size();
+            }
+        }
+        plan->steps.push_back(step);
+    }
+
+    // runs of per lane arithmetic share a loop, broken by skips, their
+    // landings and texture fetches; uniform work is not in the way
+    int groups = 0;
+    bool open = false;
+    for (size_t i = 0; i < plan->steps.size(); ++i)
+    {
+        KernelStep& step = plan->steps[i];
+        open = open && !plan->landing[i];
+        if (step.hoisted || step.repeated)
+        {
+            continue;
+        }
+        bool lane = step.instruction->op != SHADER_OP_SKIP && !IsTexture(*step.instruction);
+        open = open && lane && !plan->landing[i];
+        if (lane)
+        {
+            groups += open ? 0 : 1;
+            step.group = groups - 1;
+            plan->values[step.values[0]].group = (plan->values[step.values[0]].group == -1) ? step.group : -2;
+            open = true;
+        }
+    }
+
+    // a value used only in the loop computing it needs no array
+    std::vector<bool> local(plan->values.size(), true);
+    for (size_t i = 0; i < plan->steps.size(); ++i)
+    {
+        const KernelStep& step = plan->steps[i];
+        for (int s = 0; s < 3 && !step.repeated; ++s)
+        {
+            if (step.sources[s] >= 0)
+            {
+                plan->values[step.sources[s]].used = true;
+                local[step.sources[s]] = local[step.sources[s]] && step.group >= 0 &&
+                    step.group == plan->values[step.sources[s]].group;
+            }
+        }
+    }
+    for (size_t i = 0; i < program.outputRegisters.size(); ++i)
+    {
+        int value = current[program.outputRegisters[i]];
+        if (value >= 0)
+        {
+            plan->values[value].used = true;
+            local[value] = false;
+        }
+    }
+    for (size_t v = 0; v < plan->values.size(); ++v)
+    {
+        KernelValue& value = plan->values[v];
+        if (value.kind == VALUE_LANES && value.group >= 0 && local[v] && value.name[0] == 'v')
+        {
+            value.kind = VALUE_LOCAL;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// C++
+//----------------------------------------------------------------------
+
+static std::string Operand(const KernelPlan& plan, int value)
+{
+    const KernelValue& v = plan.values[value];
+    return (v.kind == VALUE_LANES) ? v.name + "[l]" : v.name;
+}
+
+// the value step computes, from its operands
+static std::string Expression(const KernelPlan& plan, const KernelStep& step)
+{
+    int sources = GetShaderOpSources(step.instruction->op);
+    std::string a = Operand(plan, step.sources[0]);
+    std::string b = (sources >= 2) ? Operand(plan, step.sources[1]) : "";
+    std::string c = (sources >= 3) ? Operand(plan, step.sources[2]) : "";
+
+    switch (step.instruction->op)
+    {
+    case SHADER_OP_MOV:     return a;
+    case SHADER_OP_ADD:     return a + " + " + b;
+    case SHADER_OP_SUB:     return a + " - " + b;
+    case SHADER_OP_MUL:     return a + " * " + b;
+    case SHADER_OP_DIV:     return a + " / " + b;
+    case SHADER_OP_MAD:     return a + " * " + b + " + " + c;
+    case SHADER_OP_MIN:     return "(" + a + " < " + b + ") ? " + a + " : " + b;
+    case SHADER_OP_MAX:     return "(" + a + " > " + b + ") ? " + a + " : " + b;
+    case SHADER_OP_NEG:     return "-" + a;
+    case SHADER_OP_ABS:     return "fabsf(" + a + ")";
+    case SHADER_OP_SAT:     return "Saturate(" + a + ")";
+    case SHADER_OP_FLOOR:   return "floorf(" + a + ")";
+    case SHADER_OP_CEIL:    return "ceilf(" + a + ")";
+    case SHADER_OP_FRAC:    return a + " - floorf(" + a + ")";
+    case SHADER_OP_SQRT:    return "sqrtf(" + a + ")";
+    case SHADER_OP_RSQ:     return "1.0f / sqrtf(" + a + ")";
+    case SHADER_OP_RCP:     return "1.0f / " + a;
+    case SHADER_OP_EXP:     return "expf(" + a + ")";
+    case SHADER_OP_LOG:     return "logf(" + a + ")";
+    case SHADER_OP_POW:     return "powf(" + a + ", " + b + ")";
+    case SHADER_OP_SIN:     return "sinf(" + a + ")";
+    case SHADER_OP_COS:     return "cosf(" + a + ")";
+    case SHADER_OP_LT:      return "(" + a + " < " + b + ") ? 1.0f : 0.0f";
+    case SHADER_OP_LE:      return "(" + a + " <= " + b + ") ? 1.0f : 0.0f";
+    case SHADER_OP_EQ:      return "(" + a + " == " + b + ") ? 1.0f : 0.0f";
+    case SHADER_OP_NE:      return "(" + a + " != " + b + ") ? 1.0f : 0.0f";
+    case SHADER_OP_AND:     return "(" + a + " != 0.0f && " + b + " != 0.0f) ? 1.0f : 0.0f";
+    case SHADER_OP_OR:      return "(" + a + " != 0.0f || " + b + " != 0.0f) ? 1.0f : 0.0f";
+    case SHADER_OP_NOT:     return "(" + a + " == 0.0f) ? 1.0f : 0.0f";
+    case SHADER_OP_SEL:     return "(" + a + " != 0.0f) ? " + b + " : " + c;
+    default:                return "0.0f";
+    }
+}
+
+static std::string GenerateKernel(const ShaderProgram& program, const std::string& name, int* hoistedCount)
+{
+    KernelPlan plan;
+    PlanKernel(program, &plan);
+
+    std::string text = "static void " + name + "(const float* uniforms, const ShaderTexture* const* textures,\n"
+        "    const float* inputs, float* outputs, int count)\n{\n";
+
+    // uniforms, then the work on them alone
+    for (size_t u = 0; u < plan.uniformValues.size(); ++u)
+    {
+        int value = plan.uniformValues[u];
+        if (plan.values[value].used && plan.values[value].kind == VALUE_SCALAR)
+        {
+            text += "    const float " + plan.values[value].name + Format(" = uniforms[%d];\n", (int)u);
+        }
+    }
+    *hoistedCount = 0;
+    for (size_t i = 0; i < plan.steps.size(); ++i)
+    {
+        const KernelStep& step = plan.steps[i];
+        if (step.hoisted && plan.values[step.values[0]].used)
+        {
+            text += "    const float " + plan.values[step.values[0]].name + " = " + Expression(plan, step) + ";\n";
+            ++*hoistedCount;
+        }
+    }
+
+    // the arrays; registers a skip may pass over start at zero
+    for (size_t v = 0; v < plan.values.size(); ++v)
+    {
+        const KernelValue& value = plan.values[v];
+        if (value.kind == VALUE_LANES && value.used)
+        {
+            text += "    float " + value.name + ((value.name[0] == 'r') ? "[SHADER_LANES] = { 0.0f };\n" :
+                "[SHADER_LANES];\n");
+        }
+    }
+
+    // a batch of lanes at a time, the last one repeating its last item
+    text += "\n    for (int base = 0; base < count; base += SHADER_LANES)\n    {\n"
+        "        int lanes = (count - base < SHADER_LANES) ? count - base : SHADER_LANES;\n";
+    std::string loads;
+    for (size_t i = 0; i < plan.inputValues.size(); ++i)
+    {
+        const KernelValue& value = plan.values[plan.inputValues[i]];
+        if (value.used)
+        {
+            loads += "            " + value.name + Format("[l] = inputs[%d * count + n];\n", (int)i);
+        }
+    }
+    if (!loads.empty())
+    {
+        text += "        for (int l = 0; l < SHADER_LANES; ++l)\n        {\n"
+            "            int n = base + ((l < lanes) ? l : lanes - 1);\n" + loads + "        }\n";
+    }
+
+    for (size_t i = 0; i <= plan.steps.size(); ++i)
+    {
+        // one level out, so they stand out
+        if (plan.landing[i])
+        {
+            text += Format("    skip%d:\n", (int)i);
+        }
+        if (i == plan.steps.size())
+        {
+            break;
+        }
+
+        const KernelStep& step = plan.steps[i];
+        const ShaderInstruction& instruction = *step.instruction;
+        if (step.hoisted || step.repeated)
+        {
+            continue;
+        }
+
+        if (step.group >= 0)
+        {
+            text += "        for (int l = 0; l < SHADER_LANES; ++l)\n        {\n";
+            int group = step.group;
+            size_t first = i;
+            for (; i < plan.steps.size() && (i == first || !plan.landing[i]) &&
+                (plan.steps[i].group == group || plan.steps[i].hoisted || plan.steps[i].repeated); ++i)
+            {
+                const KernelStep& member = plan.steps[i];
+                const KernelValue& value = plan.values[member.values[0]];
+                if (member.group != group || !value.used)
+                {
+                    continue;
+                }
+                text += std::string("            ") + ((value.kind == VALUE_LOCAL) ? "float " : "") +
+                    Operand(plan, member.values[0]) + " = " + Expression(plan, member) + ";\n";
+            }
+            text += "        }\n";
+            --i;
+        }
+        else if (instruction.op == SHADER_OP_SKIP)
+        {
+            const KernelValue& mask = plan.values[step.sources[0]];
+            std::string label = Format("skip%d", instruction.dst);
+            if (mask.kind == VALUE_LANES)
+            {
+                text += "        if (!AnyLane(" + mask.name + "))\n            goto " + label + ";\n";
+            }
+            else if (mask.kind == VALUE_SCALAR)
+            {
+                text += "        if (" + mask.name + " == 0.0f)\n            goto " + label + ";\n";
+            }
+            else if (mask.name == "0.0f" || mask.name == "(-0.0f)")
+            {
+                text += "        goto " + label + ";\n";
+            }
+        }
+        else
+        {
+            bool cube = (instruction.op == SHADER_OP_TEXCUBE);
+            std::string coordinates = Operand(plan, step.sources[0]) + ", " + Operand(plan, step.sources[1]) +
+                (cube ? ", " + Operand(plan, step.sources[2]) : "");
+            text += "        for (int l = 0; l < SHADER_LANES; ++l)\n        {\n            float rgba[4];\n";
+            text += std::string("            ") + (cube ? "SampleTextureCube" : "SampleTexture2D") +
+                Format("(textures[%d], ", instruction.sampler) + coordinates + ", rgba);\n";
+            for (int w = 0; w < 4; ++w)
+            {
+                if (plan.values[step.values[w]].used)
+                {
+                    text += "            " + Operand(plan, step.values[w]) + Format(" = rgba[%d];\n", w);
+                }
+            }
+            text += "        }\n";
+        }
+    }
+
+    text += "        for (int l = 0; l < lanes; ++l)\n        {\n";
+    for (size_t i = 0; i < program.outputRegisters.size(); ++i)
+    {
+        int value = plan.registerValues[program.outputRegisters[i]];
+        text += Format("            outputs[%d * count + base + l] = ", (int)i) +
+            ((value < 0) ? std::string("0.0f") : Operand(plan, value)) + ";\n";
+    }
+    text += "        }\n    }\n}\n";
+    return text;
+}
+
+static std::string NameList(const std::string& name, const std::vector<std::string>& names)
+{
+    std::string text = "static const char* const " + name + "[] = { ";
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        text += "\"" + names[i] + "\", ";
+    }
+    return text + "NULL };\n";
+}
+
+//----------------------------------------------------------------------
+// effects
+//----------------------------------------------------------------------
+
+struct Output
+{
+    std::string kernels;
+    std::string table;
+    std::map<std::string, int> generated;   // kernel and interface to its number
+    std::set<std::string> names;            // of the C++ functions
+    std::set<std::string> entries;          // effect and function in the table
+    std::vector<std::string> kernelNames;   // by number
+    int count;
+};
+
+// false if a shader could not be read or compiled
+static bool TranslateFile(const char* filename, const std::vector<std::string>& extraBaked, Output* output)
+{
+    EffectSource effect;
+    if (!LoadEffectSource(filename, &effect))
+    {
+        printf("%s: cannot read\n", filename);
+        return false;
+    }
+
+    printf("%s\n", filename);
+
+    std::set<std::string> baked(extraBaked.begin(), extraBaked.end());
+    for (size_t i = 0; i < effect.globals.size(); ++i)
+    {
+        if (IsBakeable(effect, effect.globals[i]))
+        {
+            baked.insert(effect.globals[i].name);
+        }
+    }
+
+    bool succeeded = true;
+    for (size_t u = 0; u < effect.shaders.size(); ++u)
+    {
+        const ShaderUse& use = effect.shaders[u];
+        const Function* function = FindEffectFunction(effect, use.function);
+        ShaderProgram program;
+        if (!function || !CompileShader(effect, *function, &program, &baked))
+        {
+            printf("  %s  %s: %s\n", use.stage.c_str(), use.function.c_str(),
+                function ? program.error.c_str() : "not found");
+            succeeded = false;
+            continue;
+        }
+
+        std::string entry = EffectName(filename) + " " + use.function;
+        if (!output->entries.insert(entry).second)
+        {
+            continue;
+        }
+
+        std::vector<std::string> uniforms;
+        std::vector<std::string> samplers;
+        for (size_t i = 0; i < program.uniforms.size(); ++i)
+        {
+            uniforms.push_back(program.uniforms[i].name);
+        }
+        for (size_t i = 0; i < program.samplers.size(); ++i)
+        {
+            samplers.push_back(program.samplers[i].name);
+        }
+
+        // the same shader in another sample shares the kernel; one that
+        // differs gets a number after its name
+        int hoisted = 0;
+        std::string kernel = GenerateKernel(program, "@", &hoisted);
+        std::string lists = NameList("gUniforms@", uniforms) + NameList("gSamplers@", samplers);
+        std::map<std::string, int>::iterator found = output->generated.find(kernel + lists);
+        int number = (found != output->generated.end()) ? found->second : output->count;
+        std::string name = use.function;
+        if (found == output->generated.end())
+        {
+            name += output->names.count(use.function) ? Format("_%d", number) : "";
+            output->generated[kernel + lists] = number;
+            output->names.insert(name);
+            ++output->count;
+
+            std::string suffix = Format("%d", number);
+            kernel.replace(kernel.find('@'), 1, name);
+            lists = NameList("gUniforms" + suffix, uniforms) + NameList("gSamplers" + suffix, samplers);
+            output->kernels += "\n//----------------------------------------------------------------------\n// " +
+                name + "\n//----------------------------------------------------------------------\n\n";
+            output->kernels += lists + "\n" + kernel;
+            output->kernelNames.push_back(name);
+        }
+
+        std::string suffix = Format("%d", number);
+        output->table += "    { \"" + EffectName(filename) + "\", \"" + use.function + "\", gUniforms" + suffix +
+            ", gSamplers" + suffix + Format(", %d", (int)program.inputRegisters.size()) +
+            Format(", %d, ", (int)program.outputRegisters.size()) + output->kernelNames[number] + " },\n";
+
+        printf("  %s  %4d instructions, %d once per call\n", use.stage.c_str(), (int)program.code.size(), hoisted);
+    }
+
+    std::string names;
+    for (std::set<std::string>::iterator it = baked.begin(); it != baked.end(); ++it)
+    {
+        names += " " + *it;
+    }
+    if (!names.empty())
+    {
+        printf("  baked:%s\n", names.c_str());
+    }
+
+    ReleaseEffectSource(&effect);
+
+    return succeeded;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> files;
+    std::vector<std::string> baked;
+    std::string outputName = "ShaderKernels.cpp";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            outputName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-bake") == 0 && i + 1 < argc)
+        {
+            baked.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-root") == 0 && i + 1 < argc)
+        {
+            const char* root = argv[++i];
+            for (size_t s = 0; s < NUM_SAMPLES; ++s)
+            {
+                char pattern[MAX_PATH];
+                _snprintf(pattern, MAX_PATH, "%s\\%s\\*.fx", root, gSamples[s]);
+
+                WIN32_FIND_DATA found;
+                HANDLE find = FindFirstFile(pattern, &found);
+                if (find == INVALID_HANDLE_VALUE)
+                {
+                    continue;
+                }
+                do
+                {
+                    files.push_back(std::string(root) + "\\" + gSamples[s] + "\\" + found.cFileName);
+                } while (FindNextFile(find, &found));
+                FindClose(find);
+            }
+        }
+        else if (argv[i][0] != '-')
+        {
+            files.push_back(argv[i]);
+        }
+        else
+        {
+            printf("usage: FxKernel [-o ShaderKernels.cpp] [-bake name] file.fx ...\n"
+                   "       FxKernel [-o ShaderKernels.cpp] [-bake name] -root ..\\..\n");
+            return 1;
+        }
+    }
+
+    Output output;
+    output.count = 0;
+    bool failed = false;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        failed = !TranslateFile(files[i].c_str(), baked, &output) || failed;
+    }
+
+    std::string text = gHeader + output.kernels;
+    text += "\n//----------------------------------------------------------------------\n"
+        "// table\n"
+        "//----------------------------------------------------------------------\n\n";
+    text += "extern const ShaderKernel gShaderKernels[] =\n{\n" + output.table;
+    text += output.table.empty() ? "    { NULL, NULL, NULL, NULL, 0, 0, NULL }\n};\n\n" : "};\n\n";
+    text += Format("extern const int gNumShaderKernels = %d;\n", (int)output.entries.size());
+
+    if (!WriteText(outputName, text))
+    {
+        printf("cannot write %s\n", outputName.c_str());
+        return 1;
+    }
+
+    printf("\n%d files, %d shaders, %d kernels written to %s\n", (int)files.size(), (int)output.entries.size(),
+        output.count, outputName.c_str());
+    return failed ? 1 : 0;
+}
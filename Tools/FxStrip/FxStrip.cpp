@@ -0,0 +1,795 @@
+//**********************************************************************
+//
+// FxStrip.cpp
+//
+// Removes what an effect computes or declares but never uses:
+//
+//   statement    an assignment whose value no output depends on, such as
+//                a texture fetch that is overwritten before it is read
+//   interpolant  a vertex shader output that no pixel shader it is
+//                paired with reads, and the pixel shader input for it
+//   declaration  a parameter, texture, sampler, struct or function that
+//                nothing left refers to, such as the pixel shader
+//                copies of uniforms RenderMonkey exports
+//
+// What an output depends on is followed through the shader graphs of
+// EffectSource.h. The report lists what was removed and the estimated
+// instructions of each shader before and after; with -out the slimmed
+// effects are written to that folder under their own names.
+//
+// usage: FxStrip [-out folder] file.fx ...
+//        FxStrip [-out folder] -root ..\..
+//
+//**********************************************************************
+
+#include "EffectSource.h"
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static const char* gSamples[] =
+{
+    "01_DxFramework",
+    "02_ColorShader",
+    "03_TextureMapping",
+    "04_Lighting",
+    "05_DiffuseSpecularMapping",
+    "06_ToonShader",
+    "07_NormalMapping",
+    "08_EnvironmentMapping",
+    "09_UVAnimation",
+    "10_ShadowMapping",
+    "11_ColorConversion",
+    "12_EdgeDetection"
+};
+
+#define NUM_SAMPLES (sizeof(gSamples) / sizeof(gSamples[0]))
+
+// a shader function and what is left of it
+struct Shader
+{
+    const Function* function;
+    ShaderGraph graph;
+    std::set<Node*> live;
+    std::set<std::string> deadOutputs;      // members of the returned struct
+    std::set<std::string> reads;            // parameter.member paths read
+    bool readsWholeInput;                   // a parameter read in a way not followed
+};
+
+// text to put in place of source[begin, end)
+struct Edit
+{
+    size_t begin;
+    size_t end;
+    std::string text;
+};
+
+static bool EditAfter(const Edit& a, const Edit& b)
+{
+    return a.begin > b.begin;
+}
+
+struct StripTotals
+{
+    int instructionsBefore;
+    int instructionsAfter;
+    int fetches;
+    int statements;
+    int interpolants;
+    int declarations;
+};
+
+
+//----------------------------------------------------------------------
+// liveness
+//----------------------------------------------------------------------
+
+static void MarkLive(Node* node, Shader& shader)
+{
+    if (!shader.live.insert(node).second)
+    {
+        return;
+    }
+
+    if (node->kind == NODE_INPUT)
+    {
+        size_t dot = node->text.find('.');
+        if (dot == std::string::npos)
+        {
+            shader.readsWholeInput = true;
+        }
+        else
+        {
+            size_t second = node->text.find('.', dot + 1);
+            shader.reads.insert(node->text.substr(0, second));
+        }
+    }
+
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+        MarkLive(node->children[i], shader);
+    }
+}
+
+static void ComputeLive(Shader& shader)
+{
+    shader.live.clear();
+    shader.reads.clear();
+    shader.readsWholeInput = false;
+
+    const ShaderGraph& graph = shader.graph;
+    for (std::map<std::string, Node*>::const_iterator i = graph.outputs.begin(); i != graph.outputs.end(); ++i)
+    {
+        if (!shader.deadOutputs.count(i->first))
+        {
+            MarkLive(i->second, shader);
+        }
+    }
+    for (size_t i = 0; i < graph.results.size(); ++i)
+    {
+        MarkLive(graph.results[i], shader);
+    }
+    for (size_t i = 0; i < graph.conditions.size(); ++i)
+    {
+        MarkLive(graph.conditions[i], shader);
+    }
+}
+
+static int CountFetches(const std::set<Node*>& nodes)
+{
+    int fetches = 0;
+    for (std::set<Node*>::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+    {
+        fetches += ((*i)->kind == NODE_CALL && (*i)->text.compare(0, 3, "tex") == 0) ? 1 : 0;
+    }
+    return fetches;
+}
+
+static const StructMember* FindMember(const StructDecl* decl, const std::string& name)
+{
+    for (size_t i = 0; decl && i < decl->members.size(); ++i)
+    {
+        if (decl->members[i].name == name)
+        {
+            return &decl->members[i];
+        }
+    }
+    return NULL;
+}
+
+static bool IsSystemSemantic(const std::string& semantic)
+{
+    // rasterizer inputs, not interpolants
+    return _strnicmp(semantic.c_str(), "POSITION", 8) == 0 || _strnicmp(semantic.c_str(), "PSIZE", 5) == 0 ||
+        _strnicmp(semantic.c_str(), "FOG", 3) == 0;
+}
+
+// the semantics a pixel shader reads through its struct parameters;
+// false if it reads its input in a way that is not followed
+static bool GetReadSemantics(const EffectSource& effect, const Shader& shader, std::set<std::string>& semantics)
+{
+    if (shader.readsWholeInput)
+    {
+        return false;
+    }
+
+    for (std::set<std::string>::const_iterator i = shader.reads.begin(); i != shader.reads.end(); ++i)
+    {
+        size_t dot = i->find('.');
+        std::map<std::string, std::string>::const_iterator parameter = shader.function->parameters.find(i->substr(0, dot));
+        const StructDecl* decl = (parameter != shader.function->parameters.end()) ?
+            FindEffectStruct(effect, parameter->second) : NULL;
+        const StructMember* member = FindMember(decl, i->substr(dot + 1));
+        if (!member)
+        {
+            return false;
+        }
+        semantics.insert(member->semantic);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------
+// stripping
+//----------------------------------------------------------------------
+
+static void RemoveTokens(std::vector<bool>& removed, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        removed[i] = true;
+    }
+}
+
+// the token naming a declaration in [begin, end)
+static size_t FindNameToken(const EffectSource& effect, size_t begin, size_t end, const std::string& name)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (effect.tokens[i].identifier && effect.tokens[i].text == name)
+        {
+            return i;
+        }
+    }
+    return end;
+}
+
+// source[begin, end) widened to whole lines when nothing else is on them
+static void WidenToLines(const std::string& text, size_t& begin, size_t& end)
+{
+    size_t lineBegin = begin;
+    while (lineBegin > 0 && (text[lineBegin - 1] == ' ' || text[lineBegin - 1] == '\t'))
+    {
+        --lineBegin;
+    }
+    size_t lineEnd = end;
+    while (lineEnd < text.size() && (text[lineEnd] == ' ' || text[lineEnd] == '\t' || text[lineEnd] == '\r'))
+    {
+        ++lineEnd;
+    }
+
+    if ((lineBegin == 0 || text[lineBegin - 1] == '\n') && (lineEnd == text.size() || text[lineEnd] == '\n'))
+    {
+        begin = lineBegin;
+        end = (lineEnd < text.size()) ? lineEnd + 1 : lineEnd;
+
+        // do not leave two blank lines where there was one
+        bool blankBefore = (begin >= 2 && text[begin - 1] == '\n' && (text[begin - 2] == '\n' || text[begin - 2] == '\r'));
+        bool blankAfter = (end < text.size() && (text[end] == '\n' || (text[end] == '\r' && end + 1 < text.size() && text[end + 1] == '\n')));
+        if (blankBefore && blankAfter)
+        {
+            end += (text[end] == '\r') ? 2 : 1;
+        }
+    }
+}
+
+static std::string Trim(const std::string& text)
+{
+    std::string result;
+    bool space = false;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        bool isSpace = (text[i] == ' ' || text[i] == '\t' || text[i] == '\r' || text[i] == '\n');
+        if (isSpace)
+        {
+            space = !result.empty();
+            continue;
+        }
+        if (space)
+        {
+            result += ' ';
+            space = false;
+        }
+        result += text[i];
+    }
+    return result;
+}
+
+static std::string TokenText(const EffectSource& effect, size_t begin, size_t end)
+{
+    size_t from = effect.tokens[begin].offset;
+    size_t to = effect.tokens[end - 1].offset + effect.tokens[end - 1].text.size();
+    return Trim(effect.text.substr(from, to - from));
+}
+
+static bool WriteFile(const std::string& filename, const std::string& text)
+{
+    FILE* fp = fopen(filename.c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+    fwrite(text.data(), 1, text.size(), fp);
+    fclose(fp);
+    return true;
+}
+
+// finds the interpolants no pixel shader reads
+static void FindDeadInterpolants(const EffectSource& effect, std::map<std::string, Shader>& shaders,
+    std::set<std::pair<std::string, std::string> >& deadMembers)
+{
+    // semantics each vertex shader's output struct has to keep
+    std::map<std::string, std::set<std::string> > needed;
+    std::set<std::string> keepAll;
+    std::set<std::string> outputStructs;
+
+    for (size_t u = 0; u < effect.shaders.size(); ++u)
+    {
+        const ShaderUse& use = effect.shaders[u];
+        if (use.stage != "vs" || !shaders.count(use.function))
+        {
+            continue;
+        }
+
+        const std::string& structName = shaders[use.function].function->returnType;
+        outputStructs.insert(structName);
+
+        // the pixel shader of the same pass
+        const Shader* pixel = NULL;
+        for (size_t p = 0; p < effect.shaders.size(); ++p)
+        {
+            const ShaderUse& other = effect.shaders[p];
+            if (other.stage == "ps" && other.technique == use.technique && other.pass == use.pass && shaders.count(other.function))
+            {
+                pixel = &shaders[other.function];
+            }
+        }
+
+        std::set<std::string> semantics;
+        if (!pixel || !GetReadSemantics(effect, *pixel, semantics))
+        {
+            keepAll.insert(structName);
+        }
+        needed[structName].insert(semantics.begin(), semantics.end());
+    }
+
+    // pixel shader inputs nothing reads
+    std::map<std::string, std::set<std::string> > readMembers;
+    std::set<std::string> inputStructs;
+    for (std::map<std::string, Shader>::iterator s = shaders.begin(); s != shaders.end(); ++s)
+    {
+        const Function* function = s->second.function;
+        for (std::map<std::string, std::string>::const_iterator p = function->parameters.begin();
+            p != function->parameters.end(); ++p)
+        {
+            inputStructs.insert(p->second);
+            if (s->second.readsWholeInput)
+            {
+                keepAll.insert(p->second);
+            }
+            for (std::set<std::string>::iterator r = s->second.reads.begin(); r != s->second.reads.end(); ++r)
+            {
+                if (r->compare(0, p->first.size() + 1, p->first + ".") == 0)
+                {
+                    readMembers[p->second].insert(r->substr(p->first.size() + 1));
+                }
+            }
+        }
+    }
+
+    // vertex shader inputs are the mesh's, so only structs between the
+    // stages are stripped
+    std::set<std::string> vertexInputs;
+    for (size_t u = 0; u < effect.shaders.size(); ++u)
+    {
+        const ShaderUse& use = effect.shaders[u];
+        if (use.stage == "vs" && shaders.count(use.function))
+        {
+            const Function* function = shaders[use.function].function;
+            for (std::map<std::string, std::string>::const_iterator p = function->parameters.begin();
+                p != function->parameters.end(); ++p)
+            {
+                vertexInputs.insert(p->second);
+            }
+        }
+    }
+
+    for (size_t s = 0; s < effect.structs.size(); ++s)
+    {
+        const StructDecl& decl = effect.structs[s];
+        bool isOutput = outputStructs.count(decl.name) > 0;
+        bool isInput = inputStructs.count(decl.name) > 0;
+        if ((!isOutput && !isInput) || vertexInputs.count(decl.name) || keepAll.count(decl.name))
+        {
+            continue;
+        }
+
+        for (size_t m = 0; m < decl.members.size(); ++m)
+        {
+            const StructMember& member = decl.members[m];
+            bool keep = IsSystemSemantic(member.semantic) ||
+                (isOutput && needed[decl.name].count(member.semantic)) ||
+                (isInput && !isOutput && readMembers[decl.name].count(member.name));
+            if (!keep)
+            {
+                deadMembers.insert(std::make_pair(decl.name, member.name));
+            }
+        }
+    }
+
+    for (std::map<std::string, Shader>::iterator s = shaders.begin(); s != shaders.end(); ++s)
+    {
+        const std::string& structName = s->second.function->returnType;
+        for (std::map<std::string, Node*>::iterator o = s->second.graph.outputs.begin(); o != s->second.graph.outputs.end(); ++o)
+        {
+            if (deadMembers.count(std::make_pair(structName, o->first)))
+            {
+                s->second.deadOutputs.insert(o->first);
+            }
+        }
+    }
+}
+
+// the statements of a shader to remove, and how declarations they held
+// are kept for the statements after them
+static void StripStatements(const EffectSource& effect, Shader& shader, std::vector<bool>& removed,
+    std::vector<Edit>& edits, std::vector<std::string>& report)
+{
+    const std::vector<Statement>& statements = shader.graph.statements;
+
+    std::vector<bool> dead(statements.size(), false);
+    for (size_t s = 0; s < statements.size(); ++s)
+    {
+        const Statement& statement = statements[s];
+
+        std::string member;
+        std::string prefix = shader.graph.outputName + ".";
+        if (statement.target.compare(0, prefix.size(), prefix) == 0)
+        {
+            member = statement.target.substr(prefix.size());
+            member = member.substr(0, member.find('.'));
+        }
+
+        dead[s] = !shader.live.count(statement.value) || (!member.empty() && shader.deadOutputs.count(member));
+    }
+
+    for (size_t s = 0; s < statements.size(); ++s)
+    {
+        const Statement& statement = statements[s];
+        if (!dead[s])
+        {
+            continue;
+        }
+
+        RemoveTokens(removed, statement.begin, statement.end);
+        report.push_back("statement   " + TokenText(effect, statement.begin, statement.end));
+
+        // float3 n = tex2D(...); ... n = float3(0, 0, 1); keeps the declaration
+        const Token& first = effect.tokens[statement.begin];
+        if (first.text == statement.target)
+        {
+            continue;
+        }
+        for (size_t later = s + 1; later < statements.size(); ++later)
+        {
+            const Statement& next = statements[later];
+            if (dead[later] || next.target.compare(0, statement.target.size(), statement.target) != 0 ||
+                (next.target.size() > statement.target.size() && next.target[statement.target.size()] != '.'))
+            {
+                continue;
+            }
+
+            Edit edit;
+            if (next.target == statement.target && effect.tokens[next.begin + 1].text == "=")
+            {
+                // becomes the declaration
+                edit.begin = effect.tokens[next.begin].offset;
+                edit.end = edit.begin;
+                edit.text = first.text + " ";
+            }
+            else
+            {
+                // only the initializer goes
+                const Token& name = effect.tokens[statement.begin + 1];
+                for (size_t i = statement.begin; i < statement.end; ++i)
+                {
+                    removed[i] = false;
+                }
+                edit.begin = name.offset + name.text.size();
+                edit.end = effect.tokens[statement.end - 1].offset;
+            }
+            edits.push_back(edit);
+            break;
+        }
+    }
+}
+
+// drops declarations nothing outside them refers to, until none is left
+static void StripDeclarations(const EffectSource& effect, const std::set<std::string>& entryPoints,
+    std::vector<bool>& removed, std::vector<std::string>& report)
+{
+    struct Declaration
+    {
+        const char* kind;
+        std::string name;
+        size_t begin;
+        size_t end;
+        size_t nameToken;
+    };
+
+    std::vector<Declaration> declarations;
+    for (size_t i = 0; i < effect.globals.size(); ++i)
+    {
+        const Global& global = effect.globals[i];
+        Declaration declaration = { "parameter", global.name, global.begin, global.end,
+            FindNameToken(effect, global.begin, global.end, global.name) };
+        declarations.push_back(declaration);
+    }
+    for (size_t i = 0; i < effect.structs.size(); ++i)
+    {
+        const StructDecl& decl = effect.structs[i];
+        Declaration declaration = { "struct", decl.name, decl.begin, decl.end, decl.begin + 1 };
+        declarations.push_back(declaration);
+    }
+    for (size_t i = 0; i < effect.functions.size(); ++i)
+    {
+        const Function& function = effect.functions[i];
+        if (!entryPoints.count(function.name))
+        {
+            Declaration declaration = { "function", function.name, function.begin, function.end, function.begin + 1 };
+            declarations.push_back(declaration);
+        }
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+
+        std::map<std::string, int> references;
+        for (size_t i = 0; i < effect.tokens.size(); ++i)
+        {
+            if (!removed[i] && effect.tokens[i].identifier)
+            {
+                ++references[effect.tokens[i].text];
+            }
+        }
+
+        for (size_t d = 0; d < declarations.size(); ++d)
+        {
+            const Declaration& declaration = declarations[d];
+            if (removed[declaration.nameToken] || references[declaration.name] > 1)
+            {
+                continue;
+            }
+
+            RemoveTokens(removed, declaration.begin, declaration.end);
+            report.push_back(std::string(declaration.kind) + std::string(12 - strlen(declaration.kind), ' ') + declaration.name);
+            changed = true;
+        }
+    }
+}
+
+// the source without the removed tokens
+static std::string Emit(const EffectSource& effect, const std::vector<bool>& removed, std::vector<Edit> edits)
+{
+    for (size_t i = 0; i < removed.size(); )
+    {
+        if (!removed[i])
+        {
+            ++i;
+            continue;
+        }
+
+        size_t end = i;
+        while (end < removed.size() && removed[end])
+        {
+            ++end;
+        }
+
+        Edit edit;
+        edit.begin = effect.tokens[i].offset;
+        edit.end = effect.tokens[end - 1].offset + effect.tokens[end - 1].text.size();
+        WidenToLines(effect.text, edit.begin, edit.end);
+        edits.push_back(edit);
+        i = end;
+    }
+
+    std::stable_sort(edits.begin(), edits.end(), EditAfter);
+
+    std::string text = effect.text;
+    size_t limit = text.size();
+    for (size_t e = 0; e < edits.size(); ++e)
+    {
+        // ranges widened over the same blank line
+        size_t end = (edits[e].end > limit) ? limit : edits[e].end;
+        size_t begin = (edits[e].begin > end) ? end : edits[e].begin;
+        text.replace(begin, end - begin, edits[e].text);
+        limit = begin;
+    }
+    return text;
+}
+
+static bool StripFile(const std::string& filename, const char* outFolder, StripTotals& totals)
+{
+    EffectSource effect;
+    if (!LoadEffectSource(filename.c_str(), &effect))
+    {
+        printf("%s: cannot read\n", filename.c_str());
+        return false;
+    }
+
+    printf("%s\n", filename.c_str());
+
+    std::map<std::string, Shader> shaders;
+    std::set<std::string> entryPoints;
+    for (size_t u = 0; u < effect.shaders.size(); ++u)
+    {
+        const std::string& name = effect.shaders[u].function;
+        const Function* function = FindEffectFunction(effect, name);
+        if (!function || shaders.count(name))
+        {
+            continue;
+        }
+
+        Shader& shader = shaders[name];
+        shader.function = function;
+        BuildShaderGraph(effect, *function, &shader.graph);
+        ComputeLive(shader);
+        entryPoints.insert(name);
+    }
+
+    // what every shader computes now, statements included
+    std::map<std::string, int> before;
+    std::map<std::string, int> fetchesBefore;
+    for (std::map<std::string, Shader>::iterator s = shaders.begin(); s != shaders.end(); ++s)
+    {
+        std::vector<Node*> roots;
+        GetShaderRoots(s->second.graph, &roots);
+        for (size_t i = 0; i < s->second.graph.statements.size(); ++i)
+        {
+            roots.push_back(s->second.graph.statements[i].value);
+        }
+
+        std::set<Node*> counted;
+        int cost = 0;
+        for (size_t i = 0; i < roots.size(); ++i)
+        {
+            cost += GetNodeCost(roots[i], counted);
+        }
+        before[s->first] = cost;
+        fetchesBefore[s->first] = CountFetches(counted);
+    }
+
+    std::set<std::pair<std::string, std::string> > deadMembers;
+    FindDeadInterpolants(effect, shaders, deadMembers);
+
+    std::vector<bool> removed(effect.tokens.size(), false);
+    std::vector<Edit> edits;
+    std::map<std::string, std::vector<std::string> > shaderReports;
+    for (std::map<std::string, Shader>::iterator s = shaders.begin(); s != shaders.end(); ++s)
+    {
+        ComputeLive(s->second);
+        StripStatements(effect, s->second, removed, edits, shaderReports[s->first]);
+    }
+
+    std::vector<std::string> fileReport;
+    for (size_t s = 0; s < effect.structs.size(); ++s)
+    {
+        const StructDecl& decl = effect.structs[s];
+        for (size_t m = 0; m < decl.members.size(); ++m)
+        {
+            const StructMember& member = decl.members[m];
+            if (deadMembers.count(std::make_pair(decl.name, member.name)))
+            {
+                RemoveTokens(removed, member.begin, member.end);
+                fileReport.push_back("interpolant " + decl.name + "." + member.name + " : " + member.semantic);
+                ++totals.interpolants;
+            }
+        }
+    }
+
+    size_t numInterpolants = fileReport.size();
+    StripDeclarations(effect, entryPoints, removed, fileReport);
+    totals.declarations += (int)(fileReport.size() - numInterpolants);
+
+    // per technique and pass
+    std::string lastPass;
+    std::set<std::string> printed;
+    for (size_t u = 0; u < effect.shaders.size(); ++u)
+    {
+        const ShaderUse& use = effect.shaders[u];
+        std::string pass = use.technique + " / " + use.pass;
+        if (pass != lastPass)
+        {
+            printf("  %s\n", pass.c_str());
+            lastPass = pass;
+        }
+        if (!shaders.count(use.function))
+        {
+            printf("    %s  %s not found\n", use.stage.c_str(), use.function.c_str());
+            continue;
+        }
+
+        Shader& shader = shaders[use.function];
+        std::set<Node*> counted;
+        int after = 0;
+        for (std::set<Node*>::iterator i = shader.live.begin(); i != shader.live.end(); ++i)
+        {
+            after += GetNodeCost(*i, counted);
+        }
+        int fetches = fetchesBefore[use.function] - CountFetches(shader.live);
+
+        printf("    %s  %3d -> %3d instructions", use.stage.c_str(), before[use.function], after);
+        if (fetches > 0)
+        {
+            printf(", %d texture fetch%s removed", fetches, (fetches > 1) ? "es" : "");
+        }
+        printf("\n");
+
+        // a function used by several passes is stripped once
+        if (printed.insert(use.function).second)
+        {
+            const std::vector<std::string>& lines = shaderReports[use.function];
+            for (size_t l = 0; l < lines.size(); ++l)
+            {
+                printf("          %s\n", lines[l].c_str());
+            }
+            totals.instructionsBefore += before[use.function];
+            totals.instructionsAfter += after;
+            totals.fetches += fetches;
+            totals.statements += (int)lines.size();
+        }
+    }
+
+    for (size_t l = 0; l < fileReport.size(); ++l)
+    {
+        printf("      %s\n", fileReport[l].c_str());
+    }
+
+    bool written = true;
+    if (outFolder)
+    {
+        size_t slash = filename.find_last_of("\\/");
+        std::string name = (slash == std::string::npos) ? filename : filename.substr(slash + 1);
+        std::string outName = std::string(outFolder) + "\\" + name;
+        written = WriteFile(outName, Emit(effect, removed, edits));
+        if (!written)
+        {
+            printf("%s: cannot write\n", outName.c_str());
+        }
+    }
+
+    ReleaseEffectSource(&effect);
+    return written;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> files;
+    const char* outFolder = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-out") == 0 && i + 1 < argc)
+        {
+            outFolder = argv[++i];
+        }
+        else if (strcmp(argv[i], "-root") == 0 && i + 1 < argc)
+        {
+            const char* root = argv[++i];
+            for (size_t s = 0; s < NUM_SAMPLES; ++s)
+            {
+                char pattern[MAX_PATH];
+                _snprintf(pattern, MAX_PATH, "%s\\%s\\*.fx", root, gSamples[s]);
+
+                WIN32_FIND_DATA found;
+                HANDLE find = FindFirstFile(pattern, &found);
+                if (find == INVALID_HANDLE_VALUE)
+                {
+                    continue;
+                }
+                do
+                {
+                    files.push_back(std::string(root) + "\\" + gSamples[s] + "\\" + found.cFileName);
+                } while (FindNextFile(find, &found));
+                FindClose(find);
+            }
+        }
+        else if (argv[i][0] != '-')
+        {
+            files.push_back(argv[i]);
+        }
+        else
+        {
+            printf("usage: FxStrip [-out folder] file.fx ...\n"
+                   "       FxStrip [-out folder] -root ..\\..\n");
+            return 1;
+        }
+    }
+
+    StripTotals totals;
+    memset(&totals, 0, sizeof(totals));
+
+    bool failed = false;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        failed = !StripFile(files[i], outFolder, totals) || failed;
+    }
+
+    printf("\n%d files: %d -> %d instructions, %d texture fetches, %d statements, %d interpolants, %d declarations removed\n",
+        (int)files.size(), totals.instructionsBefore, totals.instructionsAfter, totals.fetches, totals.statements,
+        totals.interpolants, totals.declarations);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+//**********************************************************************
+//
+// FxVariants.cpp
+//
+// Compiles every combination of an effect's feature toggles (see
+// ShaderVariants.h) with the shader interpreter and reports what each
+// variant's vertex and pixel shaders cost: instructions and texture
+// fetches, and how many of them it saves over the variant with every
+// feature at its highest setting. Variants whose shaders come out the
+// same are pointed out; the game never needs to build more than one of
+// them.
+//
+// The counts are the interpreter's scalar instructions, not fxc's, but
+// what a feature adds or saves is in proportion.
+//
+// usage: FxVariants -feature NAME=N [-feature NAME=N ...] file.fx ...
+//
+//        -feature NAME=N  NAME is #defined to 0 .. N-1 in turn
+//
+//**********************************************************************
+
+#include "ShaderInterpreter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Feature
+{
+    std::string name;
+    int numValues;
+};
+
+// what one shader of a variant costs
+struct ShaderCost
+{
+    std::string stage;
+    int instructions;
+    int fetches;
+    std::string code;           // disassembly, to find variants that are the same
+};
+
+struct Variant
+{
+    std::string name;           // e.g. SHADOW=1 SHADOW_PCF_RADIUS=0
+    std::vector<ShaderCost> shaders;
+    int sameAs;                 // an earlier variant with the same shaders, or -1
+};
+
+
+//----------------------------------------------------------------------
+// variants
+//----------------------------------------------------------------------
+
+static int CountFetches(const ShaderProgram& program)
+{
+    int fetches = 0;
+    for (size_t i = 0; i < program.code.size(); ++i)
+    {
+        int op = program.code[i].op;
+        fetches += (op == SHADER_OP_TEX2D || op == SHADER_OP_TEXCUBE) ? 1 : 0;
+    }
+    return fetches;
+}
+
+// false if a shader could not be read or compiled
+static bool CompileVariant(const char* filename, const std::map<std::string, std::string>& defines, Variant* variant)
+{
+    EffectSource effect;
+    if (!LoadEffectSource(filename, &effect, &defines))
+    {
+        printf("  %s: cannot read %s\n", variant->name.c_str(), filename);
+        return false;
+    }
+
+    bool succeeded = true;
+    for (size_t s = 0; s < effect.shaders.size(); ++s)
+    {
+        const ShaderUse& use = effect.shaders[s];
+        const Function* function = FindEffectFunction(effect, use.function);
+        ShaderProgram program;
+        if (!function || !CompileShader(effect, *function, &program))
+        {
+            printf("  %s: %s %s: %s\n", variant->name.c_str(), use.stage.c_str(), use.function.c_str(),
+                function ? program.error.c_str() : "not found");
+            succeeded = false;
+            continue;
+        }
+
+        ShaderCost cost;
+        cost.stage = use.stage;
+        cost.instructions = (int)program.code.size();
+        cost.fetches = CountFetches(program);
+        cost.code = DisassembleShader(program);
+        variant->shaders.push_back(cost);
+    }
+
+    ReleaseEffectSource(&effect);
+    return succeeded;
+}
+
+static bool ReportFile(const char* filename, const std::vector<Feature>& features)
+{
+    int numVariants = 1;
+    for (size_t f = 0; f < features.size(); ++f)
+    {
+        numVariants *= features[f].numValues;
+    }
+
+    // the first feature changes slowest, so the last variant has every
+    // feature at its highest setting
+    std::vector<Variant> variants(numVariants);
+    bool succeeded = true;
+    for (int v = 0; v < numVariants; ++v)
+    {
+        std::map<std::string, std::string> defines;
+        int rest = v;
+        for (int f = (int)features.size() - 1; f >= 0; --f)
+        {
+            char value[16];
+            _snprintf(value, sizeof(value), "%d", rest % features[f].numValues);
+            rest /= features[f].numValues;
+            defines[features[f].name] = value;
+        }
+        for (size_t f = 0; f < features.size(); ++f)
+        {
+            variants[v].name += (f ? " " : "") + features[f].name + "=" + defines[features[f].name];
+        }
+
+        succeeded = CompileVariant(filename, defines, &variants[v]) && succeeded;
+    }
+    if (!succeeded)
+    {
+        return false;
+    }
+
+    int distinct = 0;
+    for (int v = 0; v < numVariants; ++v)
+    {
+        variants[v].sameAs = -1;
+        for (int w = 0; w < v && variants[v].sameAs < 0; ++w)
+        {
+            bool same = variants[w].shaders.size() == variants[v].shaders.size();
+            for (size_t s = 0; s < variants[v].shaders.size() && same; ++s)
+            {
+                same = variants[w].shaders[s].code == variants[v].shaders[s].code;
+            }
+            variants[v].sameAs = same ? w : -1;
+        }
+        distinct += (variants[v].sameAs < 0) ? 1 : 0;
+    }
+
+    printf("%s: %d variants, %d different\n", filename, numVariants, distinct);
+    const Variant& full = variants[numVariants - 1];
+    for (int v = 0; v < numVariants; ++v)
+    {
+        const Variant& variant = variants[v];
+        printf("  %s", variant.name.c_str());
+        if (variant.sameAs >= 0)
+        {
+            printf("  same as %s\n", variants[variant.sameAs].name.c_str());
+            continue;
+        }
+        printf("\n");
+
+        for (size_t s = 0; s < variant.shaders.size(); ++s)
+        {
+            const ShaderCost& cost = variant.shaders[s];
+            const ShaderCost& most = full.shaders[s];
+            printf("    %s  %4d instructions %3d fetches  saves %4d instructions %3d fetches per %s\n",
+                cost.stage.c_str(), cost.instructions, cost.fetches,
+                most.instructions - cost.instructions, most.fetches - cost.fetches,
+                (cost.stage == "vs") ? "vertex" : "pixel");
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    std::vector<Feature> features;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* equals = (i + 1 < argc) ? strchr(argv[i + 1], '=') : NULL;
+        if (strcmp(argv[i], "-feature") == 0 && equals && atoi(equals + 1) > 0)
+        {
+            Feature feature;
+            feature.name = std::string(argv[i + 1], equals - argv[i + 1]);
+            feature.numValues = atoi(equals + 1);
+            features.push_back(feature);
+            ++i;
+        }
+        else if (argv[i][0] != '-')
+        {
+            files.push_back(argv[i]);
+        }
+        else
+        {
+            files.clear();
+            break;
+        }
+    }
+
+    if (files.empty())
+    {
+        printf("usage: FxVariants -feature NAME=N [-feature NAME=N ...] file.fx ...\n");
+        return 1;
+    }
+
+    bool failed = false;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        failed = !ReportFile(files[i].c_str(), features) || failed;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,975 @@
+//**********************************************************************
+//
+// HeadlessBench.cpp
+//
+// Draws the scenes of the samples through a render backend (see
+// RenderBackend.h) instead of D3D9, with no window, and reports how long
+// a frame takes. Runs on build machines without Windows or a GPU.
+//
+// The scenes are the samples' own: the same models, textures, effects
+// and constants, the object turning by ROTATION_SPEED every 1/60 s.
+// 03_TextureMapping has none, as its texture is a JPEG and the backends
+// only read TGA and DDS.
+// teapots is the toon shader sample's effect on a wall of 432 teapots,
+// each a draw with uniforms of its own, for what a frame of many draws
+// costs to submit. The last frame of every scene is written to
+// <out><scene>.tga.
+//
+// submit ms is the time from the frame beginning to its last draw
+// being submitted, before EndRenderFrame waits for any of it; triangles
+// are as submitted, before clipping and culling, on either backend;
+// uniform B is what the draws wrote into the backend's ring. with
+// -backend gl, the ring is kept mapped, except on llvmpipe, where it is
+// copied in at each draw; GL_UNIFORMS=mapped or copied in the
+// environment picks one either way (see GlBackend.cpp).
+//
+// usage: HeadlessBench [-backend software|gl] [-scene NAME] [-frames 60]
+//                      [-warmup 5] [-threads N] [-root ../..] [-out headless_]
+//
+//        -backend  software, the default, or gl (OpenGL 3.3 through EGL,
+//                  on llvmpipe where there is no GPU; not on Windows)
+//        -scene    color, lighting, specular, normal, environment, uv,
+//                  shadow, grayscale, sepia, edge, emboss or teapots; all
+//                  if not given
+//        -threads  threads drawing, the calling one included; every
+//                  hardware thread if not given
+//
+// on Linux, from the repository root (one line):
+//   g++ -O2 -std=c++11 -pthread -I01_DxFramework -o HeadlessBench
+//       Tools/HeadlessBench/HeadlessBench.cpp 01_DxFramework/RenderBackend.cpp
+//       01_DxFramework/SoftwareBackend.cpp 01_DxFramework/ShaderInterpreter.cpp
+//       01_DxFramework/EffectSource.cpp 01_DxFramework/XMeshLoader.cpp
+//       01_DxFramework/FileUtil.cpp 01_DxFramework/TgaLoader.cpp
+//       01_DxFramework/DdsLoader.cpp 01_DxFramework/CpuFeatures.cpp
+//       01_DxFramework/JobSystem.cpp 01_DxFramework/GlBackend.cpp
+//       01_DxFramework/GlslTranslator.cpp -lEGL -lGL
+//
+//**********************************************************************
+
+#include "RenderBackend.h"
+#include "JobSystem.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define WIN_WIDTH       800
+#define WIN_HEIGHT      600
+#define PI              3.14159265f
+#define FOV             (PI/4.0f)
+#define ASPECT_RATIO    (WIN_WIDTH/(float)WIN_HEIGHT)
+#define NEAR_PLANE      1
+#define FAR_PLANE       10000
+#define ROTATION_SPEED  (24.0f * PI / 180.0f)      // radians per second
+#define FRAME_SECONDS   (1.0f / 60.0f)
+#define SHADOW_MAP_SIZE 2048
+#define TEAPOT_COLUMNS  24
+#define TEAPOT_ROWS     18
+#define TEAPOT_SCALE    0.2f
+#define TEAPOT_SPACING  40.0f
+#define MAX_OBJECT_TEXTURES 3
+
+// row by row, as a D3DXMATRIX
+struct Matrix
+{
+    float m[16];
+};
+
+// a sample that draws one object with one effect, from its folder
+struct ObjectScene
+{
+    const char* folder;
+    const char* effect;
+    const char* mesh;
+    const char* textures[MAX_OBJECT_TEXTURES];  // NULL for unused slots
+    const char* samplers[MAX_OBJECT_TEXTURES];  // the effect's names for them
+};
+
+struct Scene
+{
+    const char* name;
+    const char* effect;         // the post-process effect, for the post-process scenes
+    const ObjectScene* object;  // for the one-object scenes
+    bool (*load)(const Scene& scene, const std::string& root);
+    void (*draw)(float rotationY);
+    void (*release)();
+};
+
+struct SceneResult
+{
+    std::vector<double> frameMs;
+    std::vector<double> submitMs;       // of the draws, until the frame ends
+    RenderStats stats;          // of the last frame
+};
+
+
+static double NowMs()
+{
+#ifdef _WIN32
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+
+    return now.QuadPart * 1000.0 / frequency.QuadPart;
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
+
+//----------------------------------------------------------------------
+// matrices, as D3DX makes them
+//----------------------------------------------------------------------
+
+static Matrix Identity()
+{
+    Matrix result;
+    memset(&result, 0, sizeof(result));
+    result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.0f;
+    return result;
+}
+
+static Matrix Multiply(const Matrix& a, const Matrix& b)
+{
+    Matrix result;
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            result.m[r * 4 + c] = a.m[r * 4 + 0] * b.m[0 * 4 + c] + a.m[r * 4 + 1] * b.m[1 * 4 + c] +
+                a.m[r * 4 + 2] * b.m[2 * 4 + c] + a.m[r * 4 + 3] * b.m[3 * 4 + c];
+        }
+    }
+    return result;
+}
+
+static void Normalize(float* v)
+{
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+}
+
+static void Cross(const float* a, const float* b, float* result)
+{
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// D3DXMatrixLookAtLH looking at the origin with y up
+static Matrix LookAtOrigin(const float* eye)
+{
+    float up[3] = { 0.0f, 1.0f, 0.0f };
+    float z[3] = { -eye[0], -eye[1], -eye[2] };
+    float x[3], y[3];
+    Normalize(z);
+    Cross(up, z, x);
+    Normalize(x);
+    Cross(z, x, y);
+
+    Matrix result = Identity();
+    for (int i = 0; i < 3; ++i)
+    {
+        result.m[i * 4 + 0] = x[i];
+        result.m[i * 4 + 1] = y[i];
+        result.m[i * 4 + 2] = z[i];
+    }
+    result.m[12] = -(x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2]);
+    result.m[13] = -(y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2]);
+    result.m[14] = -(z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2]);
+    return result;
+}
+
+// D3DXMatrixPerspectiveFovLH
+static Matrix Perspective(float fov, float aspect, float zn, float zf)
+{
+    float yScale = 1.0f / tanf(fov / 2.0f);
+
+    Matrix result;
+    memset(&result, 0, sizeof(result));
+    result.m[0] = yScale / aspect;
+    result.m[5] = yScale;
+    result.m[10] = zf / (zf - zn);
+    result.m[11] = 1.0f;
+    result.m[14] = -zn * zf / (zf - zn);
+    return result;
+}
+
+static Matrix RotationY(float angle)
+{
+    Matrix result = Identity();
+    result.m[0] = cosf(angle);
+    result.m[2] = -sinf(angle);
+    result.m[8] = sinf(angle);
+    result.m[10] = cosf(angle);
+    return result;
+}
+
+static Matrix ScaleAndTranslate(float scale, float x, float y, float z)
+{
+    Matrix result = Identity();
+    result.m[0] = result.m[5] = result.m[10] = scale;
+    result.m[12] = x;
+    result.m[13] = y;
+    result.m[14] = z;
+    return result;
+}
+
+// values into the uniform at offset, if the pipeline has it
+static void SetUniform(float* uniforms, int offset, const float* values, int count)
+{
+    if (offset >= 0)
+    {
+        memcpy(uniforms + offset, values, count * sizeof(float));
+    }
+}
+
+static float gLightPosition[4] = { 500.0f, 500.0f, -500.0f, 1.0f };
+static float gCameraPosition[4] = { 0.0f, 0.0f, -200.0f, 1.0f };
+static float gLightColor[4] = { 0.7f, 0.7f, 1.0f, 1.0f };
+static float gBlue[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+//----------------------------------------------------------------------
+// one object (02_ColorShader, 04_Lighting, 05_DiffuseSpecularMapping,
+// 07_NormalMapping, 08_EnvironmentMapping, 09_UVAnimation)
+//----------------------------------------------------------------------
+
+static const ObjectScene gColorObject =
+{
+    "02_ColorShader", "ColorShader.fx", "sphere.x", { NULL }, { NULL }
+};
+
+static const ObjectScene gLightingObject =
+{
+    "04_Lighting", "Lighting.fx", "Sphere.x", { NULL }, { NULL }
+};
+
+static const ObjectScene gSpecularObject =
+{
+    "05_DiffuseSpecularMapping", "SpecularMapping.fx", "Sphere.x",
+    { "Fieldstone_DM.tga", "fieldstone_SM.tga" }, { "DiffuseMap_Tex", "SpecularMap_Tex" }
+};
+
+static const ObjectScene gNormalObject =
+{
+    "07_NormalMapping", "NormalMapping.fx", "SphereWithTangent.x",
+    { "Fieldstone_DM.tga", "fieldstone_SM.tga", "fieldstone_NM.tga" },
+    { "DiffuseMap_Tex", "SpecularMap_Tex", "NormalMap_Tex" }
+};
+
+static const ObjectScene gEnvironmentObject =
+{
+    "08_EnvironmentMapping", "EnvironmentMapping.fx", "TeapotWithTangent.x",
+    { "Fieldstone_DM.tga", "fieldstone_SM.tga", "Snow_ENV.dds" },
+    { "DiffuseMap_Tex", "SpecularMap_Tex", "EnvironmentMap_Tex" }
+};
+
+static const ObjectScene gUVObject =
+{
+    "09_UVAnimation", "UVAnimation.fx", "torus.x",
+    { "Fieldstone_DM.tga", "fieldstone_SM.tga" }, { "DiffuseMap_Tex", "SpecularMap_Tex" }
+};
+
+static RenderMesh* gpObject = NULL;
+static RenderTexture* gpObjectTextures[MAX_OBJECT_TEXTURES] = { NULL, NULL, NULL };
+static RenderPipeline* gpObjectEffect = NULL;
+
+// whichever of them the effect has
+static int gObjectWorld = -1;
+static int gObjectWorldViewProjection = -1;
+static int gObjectViewProjection = -1;
+static int gObjectLightPosition = -1;
+static int gObjectCameraPosition = -1;
+static int gObjectLightColor = -1;
+static int gObjectWaveHeight = -1;
+static int gObjectWaveFrequency = -1;
+static int gObjectWavePhase = -1;
+static int gObjectUVOffset = -1;
+static int gObjectSamplers[MAX_OBJECT_TEXTURES] = { -1, -1, -1 };
+
+static bool LoadObjectScene(const Scene& scene, const std::string& root)
+{
+    const ObjectScene& object = *scene.object;
+    std::string folder = root + "/" + object.folder + "/";
+    gpObject = LoadRenderMesh((folder + object.mesh).c_str());
+
+    bool loaded = (gpObject != NULL);
+    for (int i = 0; i < MAX_OBJECT_TEXTURES && object.textures[i]; ++i)
+    {
+        gpObjectTextures[i] = LoadRenderTexture((folder + object.textures[i]).c_str());
+        loaded = loaded && gpObjectTextures[i];
+    }
+
+    std::string effect = folder + object.effect;
+    RenderPipelineDesc desc = { effect.c_str(), NULL, NULL, NULL, RENDER_FORMAT_RGBA8 };
+    gpObjectEffect = CreateRenderPipeline(desc);
+
+    if (!loaded || !gpObjectEffect)
+    {
+        return false;
+    }
+
+    gObjectWorld = GetRenderUniform(gpObjectEffect, "gWorldMatrix");
+    gObjectWorldViewProjection = GetRenderUniform(gpObjectEffect, "gWorldViewProjectionMatrix");
+    gObjectViewProjection = GetRenderUniform(gpObjectEffect, "gViewProjectionMatrix");
+    gObjectLightPosition = GetRenderUniform(gpObjectEffect, "gWorldLightPosition");
+    gObjectCameraPosition = GetRenderUniform(gpObjectEffect, "gWorldCameraPosition");
+    gObjectLightColor = GetRenderUniform(gpObjectEffect, "gLightColor");
+    gObjectWaveHeight = GetRenderUniform(gpObjectEffect, "gWaveHeight");
+    gObjectWaveFrequency = GetRenderUniform(gpObjectEffect, "gWaveFrequency");
+    gObjectWavePhase = GetRenderUniform(gpObjectEffect, "gWavePhase");
+    gObjectUVOffset = GetRenderUniform(gpObjectEffect, "gUVOffset");
+    for (int i = 0; i < MAX_OBJECT_TEXTURES; ++i)
+    {
+        gObjectSamplers[i] = object.samplers[i] ? GetRenderSampler(gpObjectEffect, object.samplers[i]) : -1;
+    }
+    return true;
+}
+
+static void DrawObjectScene(float rotationY)
+{
+    Matrix world = RotationY(rotationY);
+    Matrix viewProjection = Multiply(LookAtOrigin(gCameraPosition), Perspective(FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE));
+    Matrix worldViewProjection = Multiply(world, viewProjection);
+
+    // 09's wave and texture scroll, at the time the rotation stands for
+    float time = rotationY / ROTATION_SPEED;
+    float waveHeight[4] = { 3.0f, 0.0f, 0.0f, 0.0f };
+    float waveFrequency[4] = { 10.0f, 0.0f, 0.0f, 0.0f };
+    float wavePhase[4] = { time * 2.0f, 0.0f, 0.0f, 0.0f };
+    float uvOffset[4] = { time * 0.25f, 0.0f, 0.0f, 0.0f };
+
+    BeginRenderPass(NULL, gBlue, true);
+    {
+        RenderDraw draw;
+        memset(&draw, 0, sizeof(draw));
+        draw.pipeline = gpObjectEffect;
+        draw.mesh = gpObject;
+        for (int i = 0; i < MAX_OBJECT_TEXTURES; ++i)
+        {
+            if (gObjectSamplers[i] >= 0)
+            {
+                draw.textures[gObjectSamplers[i]] = gpObjectTextures[i];
+            }
+        }
+
+        float* uniforms = AllocateRenderUniforms(gpObjectEffect, &draw.uniforms);
+        SetUniform(uniforms, gObjectWorld, world.m, 16);
+        SetUniform(uniforms, gObjectWorldViewProjection, worldViewProjection.m, 16);
+        SetUniform(uniforms, gObjectViewProjection, viewProjection.m, 16);
+        SetUniform(uniforms, gObjectLightPosition, gLightPosition, 4);
+        SetUniform(uniforms, gObjectCameraPosition, gCameraPosition, 4);
+        SetUniform(uniforms, gObjectLightColor, gLightColor, 4);
+        SetUniform(uniforms, gObjectWaveHeight, waveHeight, 4);
+        SetUniform(uniforms, gObjectWaveFrequency, waveFrequency, 4);
+        SetUniform(uniforms, gObjectWavePhase, wavePhase, 4);
+        SetUniform(uniforms, gObjectUVOffset, uvOffset, 4);
+        SubmitRenderDraw(draw);
+    }
+    EndRenderPass();
+}
+
+static void ReleaseObjectScene()
+{
+    ReleaseRenderPipeline(gpObjectEffect);
+    for (int i = 0; i < MAX_OBJECT_TEXTURES; ++i)
+    {
+        ReleaseRenderTexture(gpObjectTextures[i]);
+        gpObjectTextures[i] = NULL;
+    }
+    ReleaseRenderMesh(gpObject);
+    gpObjectEffect = NULL;
+    gpObject = NULL;
+}
+
+//----------------------------------------------------------------------
+// shadow mapping (10_ShadowMapping)
+//----------------------------------------------------------------------
+
+static float gTorusColor[4] = { 1.0f, 1.0f, 0.0f, 1.0f };
+static float gDiscColor[4] = { 0.0f, 1.0f, 1.0f, 1.0f };
+static float gBlack[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+static float gWhite[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+static RenderMesh* gpTorus = NULL;
+static RenderMesh* gpDisc = NULL;
+static RenderTexture* gpShadowMap = NULL;
+static RenderPipeline* gpCreateShadow = NULL;
+static RenderPipeline* gpApplyShadow = NULL;
+
+// looked up once, at load
+static int gCreateShadowMatrix = -1;
+static int gApplyWorld = -1;
+static int gApplyLightViewProjection = -1;
+static int gApplyViewProjection = -1;
+static int gApplyLightPosition = -1;
+static int gApplyColor = -1;
+static int gApplyShadowMap = -1;
+
+static bool LoadShadowScene(const Scene&, const std::string& root)
+{
+    std::string folder = root + "/10_ShadowMapping/";
+    gpTorus = LoadRenderMesh((folder + "Torus.x").c_str());
+    gpDisc = LoadRenderMesh((folder + "Disc.x").c_str());
+    gpShadowMap = CreateRenderTarget(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, RENDER_FORMAT_R32F);
+
+    std::string createShadow = folder + "CreateShadow.fx";
+    std::string applyShadow = folder + "ApplyShadow.fx";
+    RenderPipelineDesc desc = { createShadow.c_str(), NULL, NULL, NULL, RENDER_FORMAT_R32F };
+    gpCreateShadow = CreateRenderPipeline(desc);
+    desc.effect = applyShadow.c_str();
+    desc.format = RENDER_FORMAT_RGBA8;
+    gpApplyShadow = CreateRenderPipeline(desc);
+
+    if (!gpTorus || !gpDisc || !gpShadowMap || !gpCreateShadow || !gpApplyShadow)
+    {
+        return false;
+    }
+
+    gCreateShadowMatrix = GetRenderUniform(gpCreateShadow, "gWorldLightViewProjectionMatrix");
+    gApplyWorld = GetRenderUniform(gpApplyShadow, "gWorldMatrix");
+    gApplyLightViewProjection = GetRenderUniform(gpApplyShadow, "gLightViewProjectionMatrix");
+    gApplyViewProjection = GetRenderUniform(gpApplyShadow, "gViewProjectionMatrix");
+    gApplyLightPosition = GetRenderUniform(gpApplyShadow, "gWorldLightPosition");
+    gApplyColor = GetRenderUniform(gpApplyShadow, "gObjectColor");
+    gApplyShadowMap = GetRenderSampler(gpApplyShadow, "ShadowMap_Tex");
+    return true;
+}
+
+static void DrawShadowObject(const RenderMesh* mesh, const Matrix& world, const float* color,
+    const Matrix& lightViewProjection, const Matrix& viewProjection)
+{
+    RenderDraw draw;
+    memset(&draw, 0, sizeof(draw));
+    draw.pipeline = gpApplyShadow;
+    draw.mesh = mesh;
+    if (gApplyShadowMap >= 0)
+    {
+        draw.textures[gApplyShadowMap] = gpShadowMap;
+    }
+
+    float* uniforms = AllocateRenderUniforms(gpApplyShadow, &draw.uniforms);
+    SetUniform(uniforms, gApplyWorld, world.m, 16);
+    SetUniform(uniforms, gApplyLightViewProjection, lightViewProjection.m, 16);
+    SetUniform(uniforms, gApplyViewProjection, viewProjection.m, 16);
+    SetUniform(uniforms, gApplyLightPosition, gLightPosition, 4);
+    SetUniform(uniforms, gApplyColor, color, 4);
+    SubmitRenderDraw(draw);
+}
+
+static void DrawShadowScene(float rotationY)
+{
+    Matrix lightViewProjection = Multiply(LookAtOrigin(gLightPosition), Perspective(PI / 4.0f, 1, 1, 3000));
+    Matrix viewProjection = Multiply(LookAtOrigin(gCameraPosition), Perspective(FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE));
+    Matrix torusWorld = RotationY(rotationY);
+    Matrix discWorld = ScaleAndTranslate(2.0f, 0.0f, -40.0f, 0.0f);
+
+    // 1. create shadow
+    BeginRenderPass(gpShadowMap, gWhite, true);
+    {
+        RenderDraw draw;
+        memset(&draw, 0, sizeof(draw));
+        draw.pipeline = gpCreateShadow;
+        draw.mesh = gpTorus;
+
+        Matrix worldLightViewProjection = Multiply(torusWorld, lightViewProjection);
+        float* uniforms = AllocateRenderUniforms(gpCreateShadow, &draw.uniforms);
+        SetUniform(uniforms, gCreateShadowMatrix, worldLightViewProjection.m, 16);
+        SubmitRenderDraw(draw);
+    }
+    EndRenderPass();
+
+    // 2. apply shadow
+    BeginRenderPass(NULL, gBlue, true);
+    {
+        DrawShadowObject(gpTorus, torusWorld, gTorusColor, lightViewProjection, viewProjection);
+        DrawShadowObject(gpDisc, discWorld, gDiscColor, lightViewProjection, viewProjection);
+    }
+    EndRenderPass();
+}
+
+static void ReleaseShadowScene()
+{
+    ReleaseRenderPipeline(gpApplyShadow);
+    ReleaseRenderPipeline(gpCreateShadow);
+    ReleaseRenderTexture(gpShadowMap);
+    ReleaseRenderMesh(gpDisc);
+    ReleaseRenderMesh(gpTorus);
+    gpApplyShadow = gpCreateShadow = NULL;
+    gpShadowMap = NULL;
+    gpDisc = gpTorus = NULL;
+}
+
+//----------------------------------------------------------------------
+// post-processing (11_ColorConversion, 12_EdgeDetection)
+//----------------------------------------------------------------------
+
+static RenderMesh* gpTeapot = NULL;
+static RenderMesh* gpQuad = NULL;
+static RenderTexture* gpStoneDM = NULL;
+static RenderTexture* gpStoneSM = NULL;
+static RenderTexture* gpSnowENV = NULL;
+static RenderTexture* gpSceneTarget = NULL;
+static RenderPipeline* gpEnvironmentMapping = NULL;
+static RenderPipeline* gpPostProcess = NULL;
+
+static int gEnvironmentWorld = -1;
+static int gEnvironmentWorldViewProjection = -1;
+static int gEnvironmentLightPosition = -1;
+static int gEnvironmentCameraPosition = -1;
+static int gEnvironmentLightColor = -1;
+static int gEnvironmentSamplers[3] = { -1, -1, -1 };
+static int gPostPixelOffset = -1;
+static int gPostScene = -1;
+
+static RenderMesh* CreateFullScreenQuad()
+{
+    // as InitFullScreenQuad makes it
+    const float positions[] = { -1, 1, 0, 1, 1, 0, 1, -1, 0, -1, -1, 0 };
+    const float texCoords[] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+    const unsigned int indices[] = { 0, 1, 3, 3, 1, 2 };
+
+    RenderMeshDesc desc;
+    desc.numVertices = 4;
+    desc.numAttributes = 2;
+    desc.attributes[0].semantic = "POSITION";
+    desc.attributes[0].components = 3;
+    desc.attributes[0].values = positions;
+    desc.attributes[1].semantic = "TEXCOORD0";
+    desc.attributes[1].components = 2;
+    desc.attributes[1].values = texCoords;
+    desc.numIndices = 6;
+    desc.indices = indices;
+    return CreateRenderMesh(desc);
+}
+
+static bool LoadPostProcessScene(const Scene& scene, const std::string& root)
+{
+    std::string folder = root + "/12_EdgeDetection/";
+    gpTeapot = LoadRenderMesh((folder + "TeapotWithTangent.x").c_str());
+    gpQuad = CreateFullScreenQuad();
+    gpStoneDM = LoadRenderTexture((folder + "Fieldstone_DM.tga").c_str());
+    gpStoneSM = LoadRenderTexture((folder + "fieldstone_SM.tga").c_str());
+    gpSnowENV = LoadRenderTexture((folder + "Snow_ENV.dds").c_str());
+    gpSceneTarget = CreateRenderTarget(WIN_WIDTH, WIN_HEIGHT, RENDER_FORMAT_RGBA8);
+
+    std::string environmentMapping = folder + "EnvironmentMapping.fx";
+    std::string postProcess = root + "/" + scene.effect;
+    RenderPipelineDesc desc = { environmentMapping.c_str(), NULL, NULL, NULL, RENDER_FORMAT_RGBA8 };
+    gpEnvironmentMapping = CreateRenderPipeline(desc);
+    desc.effect = postProcess.c_str();
+    gpPostProcess = CreateRenderPipeline(desc);
+
+    if (!gpTeapot || !gpQuad || !gpStoneDM || !gpStoneSM || !gpSnowENV || !gpSceneTarget ||
+        !gpEnvironmentMapping || !gpPostProcess)
+    {
+        return false;
+    }
+
+    gEnvironmentWorld = GetRenderUniform(gpEnvironmentMapping, "gWorldMatrix");
+    gEnvironmentWorldViewProjection = GetRenderUniform(gpEnvironmentMapping, "gWorldViewProjectionMatrix");
+    gEnvironmentLightPosition = GetRenderUniform(gpEnvironmentMapping, "gWorldLightPosition");
+    gEnvironmentCameraPosition = GetRenderUniform(gpEnvironmentMapping, "gWorldCameraPosition");
+    gEnvironmentLightColor = GetRenderUniform(gpEnvironmentMapping, "gLightColor");
+    gEnvironmentSamplers[0] = GetRenderSampler(gpEnvironmentMapping, "DiffuseMap_Tex");
+    gEnvironmentSamplers[1] = GetRenderSampler(gpEnvironmentMapping, "SpecularMap_Tex");
+    gEnvironmentSamplers[2] = GetRenderSampler(gpEnvironmentMapping, "EnvironmentMap_Tex");
+    gPostPixelOffset = GetRenderUniform(gpPostProcess, "gPixelOffset");
+    gPostScene = GetRenderSampler(gpPostProcess, "SceneTexture_Tex");
+    return true;
+}
+
+static void DrawPostProcessScene(float rotationY)
+{
+    Matrix world = RotationY(rotationY);
+    Matrix viewProjection = Multiply(LookAtOrigin(gCameraPosition), Perspective(FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE));
+    Matrix worldViewProjection = Multiply(world, viewProjection);
+
+    // 1. draw the scene into the render target
+    BeginRenderPass(gpSceneTarget, gBlack, true);
+    {
+        RenderDraw draw;
+        memset(&draw, 0, sizeof(draw));
+        draw.pipeline = gpEnvironmentMapping;
+        draw.mesh = gpTeapot;
+        RenderTexture* textures[3] = { gpStoneDM, gpStoneSM, gpSnowENV };
+        for (int i = 0; i < 3; ++i)
+        {
+            if (gEnvironmentSamplers[i] >= 0)
+            {
+                draw.textures[gEnvironmentSamplers[i]] = textures[i];
+            }
+        }
+
+        float* uniforms = AllocateRenderUniforms(gpEnvironmentMapping, &draw.uniforms);
+        SetUniform(uniforms, gEnvironmentWorld, world.m, 16);
+        SetUniform(uniforms, gEnvironmentWorldViewProjection, worldViewProjection.m, 16);
+        SetUniform(uniforms, gEnvironmentLightPosition, gLightPosition, 4);
+        SetUniform(uniforms, gEnvironmentCameraPosition, gCameraPosition, 4);
+        SetUniform(uniforms, gEnvironmentLightColor, gLightColor, 4);
+        SubmitRenderDraw(draw);
+    }
+    EndRenderPass();
+
+    // 2. apply post-processing
+    BeginRenderPass(NULL, gBlue, true);
+    {
+        RenderDraw draw;
+        memset(&draw, 0, sizeof(draw));
+        draw.pipeline = gpPostProcess;
+        draw.mesh = gpQuad;
+        if (gPostScene >= 0)
+        {
+            draw.textures[gPostScene] = gpSceneTarget;
+        }
+
+        float pixelOffset[4] = { 1 / (float)WIN_WIDTH, 1 / (float)WIN_HEIGHT, 0, 0 };
+        float* uniforms = AllocateRenderUniforms(gpPostProcess, &draw.uniforms);
+        SetUniform(uniforms, gPostPixelOffset, pixelOffset, 4);
+        SubmitRenderDraw(draw);
+    }
+    EndRenderPass();
+}
+
+static void ReleasePostProcessScene()
+{
+    ReleaseRenderPipeline(gpPostProcess);
+    ReleaseRenderPipeline(gpEnvironmentMapping);
+    ReleaseRenderTexture(gpSceneTarget);
+    ReleaseRenderTexture(gpSnowENV);
+    ReleaseRenderTexture(gpStoneSM);
+    ReleaseRenderTexture(gpStoneDM);
+    ReleaseRenderMesh(gpQuad);
+    ReleaseRenderMesh(gpTeapot);
+    gpPostProcess = gpEnvironmentMapping = NULL;
+    gpSceneTarget = gpSnowENV = gpStoneSM = gpStoneDM = NULL;
+    gpQuad = gpTeapot = NULL;
+}
+
+//----------------------------------------------------------------------
+// many teapots (06_ToonShader)
+//----------------------------------------------------------------------
+
+static float gTeapotCameraPosition[4] = { 0.0f, 0.0f, -950.0f, 1.0f };
+
+static RenderPipeline* gpToonShader = NULL;
+
+static int gToonWorldViewProjection = -1;
+static int gToonLightPosition = -1;
+static int gToonColor = -1;
+
+static bool LoadTeapotScene(const Scene&, const std::string& root)
+{
+    gpTeapot = LoadRenderMesh((root + "/08_EnvironmentMapping/TeapotWithTangent.x").c_str());
+
+    std::string toonShader = root + "/06_ToonShader/ToonShader.fx";
+    RenderPipelineDesc desc = { toonShader.c_str(), NULL, NULL, NULL, RENDER_FORMAT_RGBA8 };
+    gpToonShader = CreateRenderPipeline(desc);
+
+    if (!gpTeapot || !gpToonShader)
+    {
+        return false;
+    }
+
+    gToonWorldViewProjection = GetRenderUniform(gpToonShader, "gWorldViewProjectionMatrix");
+    gToonLightPosition = GetRenderUniform(gpToonShader, "gObjectLightPosition");
+    gToonColor = GetRenderUniform(gpToonShader, "gSurfaceColor");
+    return true;
+}
+
+// a wall of TEAPOT_COLUMNS x TEAPOT_ROWS teapots, each turned by its own
+// angle and in its own color, one draw apiece as the sample draws one
+static void DrawTeapotScene(float rotationY)
+{
+    Matrix viewProjection = Multiply(LookAtOrigin(gTeapotCameraPosition), Perspective(FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE));
+
+    BeginRenderPass(NULL, gBlue, true);
+    for (int row = 0; row < TEAPOT_ROWS; ++row)
+    {
+        for (int column = 0; column < TEAPOT_COLUMNS; ++column)
+        {
+            int i = row * TEAPOT_COLUMNS + column;
+            float x = (column - (TEAPOT_COLUMNS - 1) / 2.0f) * TEAPOT_SPACING;
+            float y = (row - (TEAPOT_ROWS - 1) / 2.0f) * TEAPOT_SPACING - 39.0f * TEAPOT_SCALE;
+            Matrix rotation = RotationY(rotationY + i * 0.5f);
+            Matrix world = Multiply(rotation, ScaleAndTranslate(TEAPOT_SCALE, x, y, 0.0f));
+
+            // the light in object space: moved back, scaled down and
+            // turned back by the transposed rotation
+            float light[3] = { (gLightPosition[0] - x) / TEAPOT_SCALE, (gLightPosition[1] - y) / TEAPOT_SCALE,
+                gLightPosition[2] / TEAPOT_SCALE };
+            float objectLight[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            for (int c = 0; c < 3; ++c)
+            {
+                objectLight[c] = light[0] * rotation.m[c * 4 + 0] + light[1] * rotation.m[c * 4 + 1] +
+                    light[2] * rotation.m[c * 4 + 2];
+            }
+            float color[4] = { (i % 5) / 4.0f, 1.0f - (i % 3) / 2.0f, (i % 7) / 6.0f, 1.0f };
+
+            RenderDraw draw;
+            memset(&draw, 0, sizeof(draw));
+            draw.pipeline = gpToonShader;
+            draw.mesh = gpTeapot;
+
+            Matrix worldViewProjection = Multiply(world, viewProjection);
+            float* uniforms = AllocateRenderUniforms(gpToonShader, &draw.uniforms);
+            SetUniform(uniforms, gToonWorldViewProjection, worldViewProjection.m, 16);
+            SetUniform(uniforms, gToonLightPosition, objectLight, 4);
+            SetUniform(uniforms, gToonColor, color, 4);
+            SubmitRenderDraw(draw);
+        }
+    }
+    EndRenderPass();
+}
+
+static void ReleaseTeapotScene()
+{
+    ReleaseRenderPipeline(gpToonShader);
+    ReleaseRenderMesh(gpTeapot);
+    gpToonShader = NULL;
+    gpTeapot = NULL;
+}
+
+static const Scene gScenes[] =
+{
+    { "color", NULL, &gColorObject, LoadObjectScene, DrawObjectScene, ReleaseObjectScene },
+    { "lighting", NULL, &gLightingObject, LoadObjectScene, DrawObjectScene, ReleaseObjectScene },
+    { "specular", NULL, &gSpecularObject, LoadObjectScene, DrawObjectScene, ReleaseObjectScene },
+    { "normal", NULL, &gNormalObject, LoadObjectScene, DrawObjectScene, ReleaseObjectScene },
+    { "environment", NULL, &gEnvironmentObject, LoadObjectScene, DrawObjectScene, ReleaseObjectScene },
+    { "uv", NULL, &gUVObject, LoadObjectScene, DrawObjectScene, ReleaseObjectScene },
+    { "shadow", NULL, NULL, LoadShadowScene, DrawShadowScene, ReleaseShadowScene },
+    { "grayscale", "11_ColorConversion/Grayscale.fx", NULL, LoadPostProcessScene, DrawPostProcessScene, ReleasePostProcessScene },
+    { "sepia", "11_ColorConversion/Sepia.fx", NULL, LoadPostProcessScene, DrawPostProcessScene, ReleasePostProcessScene },
+    { "edge", "12_EdgeDetection/EdgeDetection.fx", NULL, LoadPostProcessScene, DrawPostProcessScene, ReleasePostProcessScene },
+    { "emboss", "12_EdgeDetection/Emboss.fx", NULL, LoadPostProcessScene, DrawPostProcessScene, ReleasePostProcessScene },
+    { "teapots", NULL, NULL, LoadTeapotScene, DrawTeapotScene, ReleaseTeapotScene },
+};
+
+#define NUM_SCENES (sizeof(gScenes) / sizeof(gScenes[0]))
+
+//----------------------------------------------------------------------
+// benchmark
+//----------------------------------------------------------------------
+
+static bool WriteTga(const char* filename, const unsigned char* rgba, int width, int height)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    // uncompressed 32 bit, top row first
+    unsigned char header[18];
+    memset(header, 0, sizeof(header));
+    header[2] = 2;
+    header[12] = (unsigned char)(width & 0xFF);
+    header[13] = (unsigned char)(width >> 8);
+    header[14] = (unsigned char)(height & 0xFF);
+    header[15] = (unsigned char)(height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;
+    fwrite(header, 1, sizeof(header), fp);
+
+    std::vector<unsigned char> bgra(rgba, rgba + width * height * 4);
+    for (size_t i = 0; i < bgra.size(); i += 4)
+    {
+        std::swap(bgra[i], bgra[i + 2]);
+    }
+    bool written = fwrite(&bgra[0], 1, bgra.size(), fp) == bgra.size();
+    fclose(fp);
+    return written;
+}
+
+static double Percentile(std::vector<double> values, double percent)
+{
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(percent / 100.0 * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static bool RunScene(const Scene& scene, const std::string& root, int warmup, int frames, const std::string& out,
+    SceneResult* result)
+{
+    if (!scene.load(scene, root))
+    {
+        printf("%s: failed at loading\n", scene.name);
+        scene.release();
+        return false;
+    }
+
+    float rotationY = 0.0f;
+    for (int frame = 0; frame < warmup + frames; ++frame)
+    {
+        double start = NowMs();
+        BeginRenderFrame();
+        scene.draw(rotationY);
+        double submitted = NowMs();
+        EndRenderFrame();
+        double end = NowMs();
+
+        if (frame >= warmup)
+        {
+            result->frameMs.push_back(end - start);
+            result->submitMs.push_back(submitted - start);
+        }
+        rotationY += ROTATION_SPEED * FRAME_SECONDS;
+    }
+    result->stats = GetRenderStats();
+
+    std::vector<unsigned char> rgba(WIN_WIDTH * WIN_HEIGHT * 4);
+    std::string filename = out + scene.name + ".tga";
+    bool written = ReadRenderFrame(&rgba[0]) && WriteTga(filename.c_str(), &rgba[0], WIN_WIDTH, WIN_HEIGHT);
+    if (!written)
+    {
+        printf("%s: failed at writing %s\n", scene.name, filename.c_str());
+    }
+
+    scene.release();
+    return written;
+}
+
+int main(int argc, char** argv)
+{
+    const char* backendName = "software";
+    const char* sceneName = NULL;
+    int frames = 60;
+    int warmup = 5;
+    int threads = 0;
+    std::string root = "../..";
+    std::string out = "headless_";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-backend") == 0 && i + 1 < argc)
+        {
+            backendName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-scene") == 0 && i + 1 < argc)
+        {
+            sceneName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+        {
+            frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-warmup") == 0 && i + 1 < argc)
+        {
+            warmup = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-root") == 0 && i + 1 < argc)
+        {
+            root = argv[++i];
+        }
+        else if (strcmp(argv[i], "-out") == 0 && i + 1 < argc)
+        {
+            out = argv[++i];
+        }
+        else
+        {
+            printf("usage: HeadlessBench [-backend software|gl] [-scene NAME] [-frames 60]\n"
+                   "                     [-warmup 5] [-threads N] [-root ../..] [-out headless_]\n");
+            return 1;
+        }
+    }
+
+    if (frames < 1 || warmup < 0 || threads < 0)
+    {
+        printf("-frames must be at least 1, -warmup and -threads at least 0\n");
+        return 1;
+    }
+
+    const RenderBackend* backend = NULL;
+    if (strcmp(backendName, "software") == 0)
+    {
+        backend = GetSoftwareRenderBackend();
+    }
+    else if (strcmp(backendName, "gl") == 0)
+    {
+        backend = GetGlRenderBackend();
+    }
+    if (!backend)
+    {
+        printf("no backend called %s\n", backendName);
+        return 1;
+    }
+
+    // one thread draws alone; otherwise the job system gets the rest
+    if (threads != 1)
+    {
+        InitJobSystem(threads - 1);
+    }
+    if (!InitRenderBackend(backend, WIN_WIDTH, WIN_HEIGHT))
+    {
+        printf("failed at starting the %s backend\n", backendName);
+        if (threads != 1)
+        {
+            ReleaseJobSystem();
+        }
+        return 1;
+    }
+
+    printf("backend %s, %d threads, %d frames of %dx%d\n", backendName,
+        (threads != 1) ? GetJobWorkerCount() + 1 : 1, frames, WIN_WIDTH, WIN_HEIGHT);
+    printf("%-10s %9s %9s %9s %9s %8s %6s %9s %10s %12s\n", "scene", "mean ms", "p50 ms", "p95 ms",
+        "submit ms", "fps", "draws", "triangles", "pixels", "uniform B");
+
+    bool failed = false;
+    bool ran = false;
+    for (size_t s = 0; s < NUM_SCENES; ++s)
+    {
+        if (sceneName && strcmp(sceneName, gScenes[s].name) != 0)
+        {
+            continue;
+        }
+        ran = true;
+
+        SceneResult result;
+        if (!RunScene(gScenes[s], root, warmup, frames, out, &result))
+        {
+            failed = true;
+            continue;
+        }
+
+        double total = 0.0;
+        double submitTotal = 0.0;
+        for (size_t f = 0; f < result.frameMs.size(); ++f)
+        {
+            total += result.frameMs[f];
+            submitTotal += result.submitMs[f];
+        }
+        double mean = total / result.frameMs.size();
+        printf("%-10s %9.3f %9.3f %9.3f %9.3f %8.1f %6d %9d %10lld %12lld\n", gScenes[s].name, mean,
+            Percentile(result.frameMs, 50.0), Percentile(result.frameMs, 95.0), submitTotal / result.frameMs.size(),
+            1000.0 / mean, result.stats.draws, result.stats.triangles, result.stats.pixels,
+            result.stats.uniformBytes);
+    }
+
+    if (!ran)
+    {
+        printf("no scene called %s\n", sceneName);
+        failed = true;
+    }
+
+    ReleaseRenderBackend();
+    if (threads != 1)
+    {
+        ReleaseJobSystem();
+    }
+    return failed ? 1 : 0;
+}
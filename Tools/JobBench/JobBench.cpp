@@ -0,0 +1,208 @@
+//**********************************************************************
+//
+// JobBench.cpp
+//
+// Microbenchmarks for the job system (see JobSystem.h):
+//
+//   spawn     cost of starting, running and waiting for an empty job
+//   steal     share of the jobs of a parallel-for that were stolen
+//   scaling   a parallel-for over 10M items on 0, 1, 2, 4... workers
+//             (the thread starting it works too)
+//
+// usage: JobBench [-items 10000000] [-grain 4096] [-spawns 1000000] [-reps 5]
+//
+//**********************************************************************
+
+#include "JobSystem.h"
+#include <windows.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// jobs spawned before waiting for them in the spawn test
+#define SPAWN_BATCH 1024
+
+struct SpawnTest
+{
+    int numJobs;
+};
+
+struct ItemsTest
+{
+    float* values;
+};
+
+
+static double NowMs()
+{
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+
+    return now.QuadPart * 1000.0 / frequency.QuadPart;
+}
+
+//----------------------------------------------------------------------
+// jobs
+//----------------------------------------------------------------------
+
+static void EmptyJob(void*, int, int)
+{
+}
+
+// spawns from a worker, so the jobs go through its own deque
+static void SpawnJobs(void* data, int, int)
+{
+    SpawnTest* test = (SpawnTest*)data;
+
+    JobCounter counter;
+    counter.count = 0;
+
+    for (int i = 0; i < test->numJobs; i += SPAWN_BATCH)
+    {
+        int batch = (test->numJobs - i < SPAWN_BATCH) ? test->numJobs - i : SPAWN_BATCH;
+        for (int j = 0; j < batch; ++j)
+        {
+            RunJob(EmptyJob, NULL, 0, 1, &counter);
+        }
+        WaitForCounter(&counter);
+    }
+}
+
+// a little arithmetic per item, so the test is not only memory bound
+static void ProcessItems(void* data, int begin, int end)
+{
+    ItemsTest* test = (ItemsTest*)data;
+
+    for (int i = begin; i < end; ++i)
+    {
+        float x = (float)i;
+        test->values[i] = sqrtf(x) * sinf(x * 0.001f) + cosf(x * 0.002f);
+    }
+}
+
+//----------------------------------------------------------------------
+// tests
+//----------------------------------------------------------------------
+
+// nanoseconds per job
+static double RunSpawnTest(int numJobs)
+{
+    SpawnTest test = { numJobs };
+
+    JobCounter counter;
+    counter.count = 0;
+
+    double start = NowMs();
+    RunJob(SpawnJobs, &test, 0, 1, &counter);
+    WaitForCounter(&counter);
+
+    return (NowMs() - start) * 1000000.0 / numJobs;
+}
+
+// best of reps, in milliseconds
+static double RunParallelFor(std::vector<float>& values, int grainSize, int reps)
+{
+    ItemsTest test = { &values[0] };
+    double best = 1e30;
+
+    for (int r = 0; r < reps; ++r)
+    {
+        double start = NowMs();
+        ParallelFor(0, (int)values.size(), grainSize, ProcessItems, &test);
+        double ms = NowMs() - start;
+        best = (ms < best) ? ms : best;
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    int numItems = 10000000;
+    int grainSize = 4096;
+    int numSpawns = 1000000;
+    int reps = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "-items") == 0 && hasValue)
+        {
+            numItems = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-grain") == 0 && hasValue)
+        {
+            grainSize = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-spawns") == 0 && hasValue)
+        {
+            numSpawns = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-reps") == 0 && hasValue)
+        {
+            reps = atoi(argv[++i]);
+        }
+        else
+        {
+            printf("usage: JobBench [-items 10000000] [-grain 4096] [-spawns 1000000] [-reps 5]\n");
+            return 1;
+        }
+    }
+
+    int maxWorkers = (int)std::thread::hardware_concurrency() - 1;
+    maxWorkers = (maxWorkers < 1) ? 1 : maxWorkers;
+
+    std::vector<float> values(numItems);
+
+    // spawn and steal with every worker
+    InitJobSystem(maxWorkers);
+    {
+        printf("spawn     %.1f ns per job (%d jobs, %d workers)\n", RunSpawnTest(numSpawns), numSpawns, maxWorkers);
+
+        JobSystemStats before = GetJobSystemStats();
+        RunParallelFor(values, grainSize, reps);
+        JobSystemStats after = GetJobSystemStats();
+
+        long long run = after.jobsRun - before.jobsRun;
+        long long stolen = after.jobsStolen - before.jobsStolen;
+        printf("steal     %lld of %lld jobs stolen (%.1f%%)\n", stolen, run, (run > 0) ? 100.0 * stolen / run : 0.0);
+    }
+    ReleaseJobSystem();
+
+    // scaling; no workers runs the whole range on this thread
+    printf("\nscaling   %d items, grain %d\n", numItems, grainSize);
+    printf("%9s %10s %9s\n", "workers", "ms", "speedup");
+
+    // 0, 1, 2, 4... and every worker
+    std::vector<int> workerCounts(1, 0);
+    for (int workers = 1; workers < maxWorkers; workers *= 2)
+    {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(maxWorkers);
+
+    double serialMs = 0;
+    for (size_t i = 0; i < workerCounts.size(); ++i)
+    {
+        int workers = workerCounts[i];
+        if (workers > 0)
+        {
+            InitJobSystem(workers);
+        }
+
+        double ms = RunParallelFor(values, grainSize, reps);
+        serialMs = (workers == 0) ? ms : serialMs;
+        printf("%9d %10.2f %8.2fx\n", workers, ms, serialMs / ms);
+
+        if (workers > 0)
+        {
+            ReleaseJobSystem();
+        }
+    }
+
+    return 0;
+}
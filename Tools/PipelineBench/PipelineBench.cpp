@@ -0,0 +1,353 @@
+//**********************************************************************
+//
+// PipelineBench.cpp
+//
+// Stand-in for measuring the frame pipeline (see FramePipeline.h)
+// without a device. The frames are built and rendered the way
+// FramePipeline does it: two frame slots, a worker building frame N+1
+// while the render thread renders frame N, and after each frame the
+// render thread waits for the GPU to finish the frame issued
+// MAX_FRAMES_IN_FLIGHT frames before. The stages are stand-ins that
+// take a given time each:
+//
+//   build     the worker's share (simulation, matrices)
+//   render    the render thread's share (effect calls, draws, Present)
+//   gpu       a thread that takes the presented frames one at a time
+//
+// build and render spin, so on one core the two stages cannot overlap;
+// -idle makes them sleep instead, as if the time went to waiting on the
+// driver. The gpu stage always sleeps.
+//
+// Each run is done serially (as the samples do unless started with
+// -pipelined) and pipelined, and prints frames per second, mean latency
+// from the start of a frame's build to its Present, and the time per
+// frame spent waiting for the build and for the GPU.
+//
+// usage: PipelineBench [-build 3] [-render 3] [-gpu 0] [-frames 600] [-idle]
+//
+// on Linux, from the repository root:
+//   g++ -O2 -std=c++11 -pthread -o PipelineBench Tools/PipelineBench/PipelineBench.cpp
+//
+//**********************************************************************
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// the same as FramePipeline's
+#define NUM_FRAME_SLOTS         2
+#define MAX_FRAMES_IN_FLIGHT    2
+
+struct StageTimes
+{
+    double buildMs;
+    double renderMs;
+    double gpuMs;
+    bool idle;
+};
+
+struct PipelineResult
+{
+    double fps;
+    double latencyMs;
+    double buildWaitMs;     // per frame
+    double gpuWaitMs;
+};
+
+static StageTimes gTimes;
+static bool gPipelined = false;
+
+// frame slots; a frame's data here is only when its build began
+static double gBuildStart[NUM_FRAME_SLOTS];
+static int gRenderSlot = 0;
+static long long gFrameIndex = 0;
+
+// worker
+static std::mutex gMutex;
+static std::condition_variable gCondition;
+static int gBuildSlot = -1;
+static bool gQuit = false;
+
+// gpu, counting frames presented to it and frames it finished
+static std::mutex gGpuMutex;
+static std::condition_variable gGpuCondition;
+static long long gGpuPresented = 0;
+static long long gGpuFinished = 0;
+static bool gGpuQuit = false;
+
+
+static double NowMs()
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// time this thread ran for, so a busy stage that is preempted still
+// takes its full time. on Windows the thread times are too coarse and
+// the wall clock is used.
+static double ThreadMs()
+{
+#ifdef _WIN32
+    return NowMs();
+#else
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
+
+// takes ms of this thread's time, busy or not
+static void RunStage(double ms, bool idle)
+{
+    if (idle)
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms));
+        return;
+    }
+
+    double end = ThreadMs() + ms;
+    while (ThreadMs() < end)
+    {
+    }
+}
+
+//----------------------------------------------------------------------
+// stages
+//----------------------------------------------------------------------
+
+static void BuildSlot(int slot)
+{
+    gBuildStart[slot] = NowMs();
+    RunStage(gTimes.buildMs, gTimes.idle);
+}
+
+static void WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(gMutex);
+    while (true)
+    {
+        while (gBuildSlot < 0 && !gQuit)
+        {
+            gCondition.wait(lock);
+        }
+        if (gQuit)
+        {
+            break;
+        }
+
+        int slot = gBuildSlot;
+        lock.unlock();
+        BuildSlot(slot);
+        lock.lock();
+
+        gBuildSlot = -1;
+        gCondition.notify_all();
+    }
+}
+
+static void GpuThread()
+{
+    std::unique_lock<std::mutex> lock(gGpuMutex);
+    while (true)
+    {
+        while (gGpuFinished == gGpuPresented && !gGpuQuit)
+        {
+            gGpuCondition.wait(lock);
+        }
+        if (gGpuFinished == gGpuPresented)
+        {
+            break;
+        }
+
+        lock.unlock();
+        RunStage(gTimes.gpuMs, true);
+        lock.lock();
+
+        ++gGpuFinished;
+        gGpuCondition.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------
+// the pipeline, as in FramePipeline.cpp
+//----------------------------------------------------------------------
+
+static void BeginFrame(double* buildWaitMs)
+{
+    if (!gPipelined || gFrameIndex == 0)
+    {
+        BuildSlot(gRenderSlot);
+    }
+    else
+    {
+        double start = NowMs();
+        {
+            std::unique_lock<std::mutex> lock(gMutex);
+            while (gBuildSlot >= 0)
+            {
+                gCondition.wait(lock);
+            }
+        }
+        *buildWaitMs += NowMs() - start;
+
+        gRenderSlot = (gRenderSlot + 1) % NUM_FRAME_SLOTS;
+    }
+
+    if (gPipelined)
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gBuildSlot = (gRenderSlot + 1) % NUM_FRAME_SLOTS;
+        gCondition.notify_all();
+    }
+}
+
+static void EndFrame(double* latencyMs, double* gpuWaitMs)
+{
+    double now = NowMs();
+    *latencyMs += now - gBuildStart[gRenderSlot];
+
+    std::unique_lock<std::mutex> lock(gGpuMutex);
+
+    // the fence FramePipeline waits on was issued after the frame
+    // MAX_FRAMES_IN_FLIGHT frames ago
+    if (gFrameIndex >= MAX_FRAMES_IN_FLIGHT)
+    {
+        while (gGpuFinished < gFrameIndex - MAX_FRAMES_IN_FLIGHT + 1)
+        {
+            gGpuCondition.wait(lock);
+        }
+        *gpuWaitMs += NowMs() - now;
+    }
+
+    ++gGpuPresented;
+    gGpuCondition.notify_all();
+
+    ++gFrameIndex;
+}
+
+static PipelineResult RunPipeline(bool pipelined, int frames)
+{
+    gPipelined = pipelined;
+    gRenderSlot = 0;
+    gFrameIndex = 0;
+    gBuildSlot = -1;
+    gQuit = false;
+    gGpuPresented = 0;
+    gGpuFinished = 0;
+    gGpuQuit = false;
+
+    std::thread worker;
+    if (pipelined)
+    {
+        worker = std::thread(WorkerThread);
+    }
+    std::thread gpu(GpuThread);
+
+    double latencyMs = 0;
+    double buildWaitMs = 0;
+    double gpuWaitMs = 0;
+    double start = NowMs();
+
+    for (int i = 0; i < frames; ++i)
+    {
+        BeginFrame(&buildWaitMs);
+        RunStage(gTimes.renderMs, gTimes.idle);
+        EndFrame(&latencyMs, &gpuWaitMs);
+    }
+
+    double totalMs = NowMs() - start;
+
+    if (worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(gMutex);
+            gQuit = true;
+            gCondition.notify_all();
+        }
+        worker.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(gGpuMutex);
+        gGpuQuit = true;
+        gGpuCondition.notify_all();
+    }
+    gpu.join();
+
+    PipelineResult result;
+    result.fps = frames * 1000.0 / totalMs;
+    result.latencyMs = latencyMs / frames;
+    result.buildWaitMs = buildWaitMs / frames;
+    result.gpuWaitMs = gpuWaitMs / frames;
+    return result;
+}
+
+//----------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    int frames = 600;
+    gTimes.buildMs = 3;
+    gTimes.renderMs = 3;
+    gTimes.gpuMs = 0;
+    gTimes.idle = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-build") == 0 && i + 1 < argc)
+        {
+            gTimes.buildMs = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-render") == 0 && i + 1 < argc)
+        {
+            gTimes.renderMs = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-gpu") == 0 && i + 1 < argc)
+        {
+            gTimes.gpuMs = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+        {
+            frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-idle") == 0)
+        {
+            gTimes.idle = true;
+        }
+        else
+        {
+            printf("usage: PipelineBench [-build 3] [-render 3] [-gpu 0] [-frames 600] [-idle]\n");
+            return 1;
+        }
+    }
+
+    if (frames < 1 || gTimes.buildMs < 0 || gTimes.renderMs < 0 || gTimes.gpuMs < 0)
+    {
+        printf("-frames must be at least 1, the stage times at least 0\n");
+        return 1;
+    }
+
+    printf("build %.2f ms, render %.2f ms (%s), gpu %.2f ms, %d frames, %u hardware threads\n\n",
+        gTimes.buildMs, gTimes.renderMs, gTimes.idle ? "idle" : "busy", gTimes.gpuMs, frames,
+        std::thread::hardware_concurrency());
+    printf("%-10s %9s %12s %13s %11s\n", "", "fps", "latency ms", "build wait", "gpu wait");
+
+    const char* names[2] = { "serial", "pipelined" };
+    for (int i = 0; i < 2; ++i)
+    {
+        PipelineResult result = RunPipeline(i == 1, frames);
+        printf("%-10s %9.1f %12.2f %13.3f %11.3f\n", names[i],
+            result.fps, result.latencyMs, result.buildWaitMs, result.gpuWaitMs);
+    }
+
+    return 0;
+}
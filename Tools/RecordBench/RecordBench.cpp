@@ -0,0 +1,683 @@
+//**********************************************************************
+//
+// RecordBench.cpp
+//
+// How fast a frame of many objects is recorded into command buffers
+// (see RenderCommands.h) on 1, 2, 4... threads. The scene is a grid of
+// spinning cubes over a floor, drawn with the shadow mapping sample's
+// effects: every cube is drawn into the shadow map, then into the frame.
+//
+// With T threads the cubes are split into T ranges. The job recording a
+// range records its shadow map draws into one buffer and its frame draws
+// into another, and the buffers are submitted shadow map ones first,
+// each pass in the order of the ranges, so every thread count draws the
+// same thing in the same order; the hash of what is submitted shows it.
+// Recording is timed apart from submitting, which always happens on one
+// thread. The last frame is written to <out>.
+//
+// usage: RecordBench [-backend software|gl] [-objects 10000] [-frames 30]
+//                    [-threads N] [-root ../..] [-out recordbench.tga]
+//
+//        -threads  the most threads recording, the calling one included;
+//                  every hardware thread if not given
+//
+// on Linux, from the repository root (one line):
+//   g++ -O2 -std=c++11 -pthread -I01_DxFramework -o RecordBench
+//       Tools/RecordBench/RecordBench.cpp 01_DxFramework/RenderCommands.cpp
+//       01_DxFramework/RenderBackend.cpp 01_DxFramework/SoftwareBackend.cpp
+//       01_DxFramework/ShaderInterpreter.cpp 01_DxFramework/EffectSource.cpp
+//       01_DxFramework/XMeshLoader.cpp 01_DxFramework/FileUtil.cpp
+//       01_DxFramework/TgaLoader.cpp 01_DxFramework/DdsLoader.cpp
+//       01_DxFramework/CpuFeatures.cpp 01_DxFramework/JobSystem.cpp
+//       01_DxFramework/GlBackend.cpp 01_DxFramework/GlslTranslator.cpp
+//       -lEGL -lGL
+//
+//**********************************************************************
+
+#include "RenderCommands.h"
+#include "JobSystem.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+#define WIN_WIDTH       800
+#define WIN_HEIGHT      600
+#define PI              3.14159265f
+#define FOV             (PI/4.0f)
+#define ASPECT_RATIO    (WIN_WIDTH/(float)WIN_HEIGHT)
+#define NEAR_PLANE      1
+#define FAR_PLANE       10000
+#define ROTATION_SPEED  (24.0f * PI / 180.0f)      // radians per second
+#define FRAME_SECONDS   (1.0f / 60.0f)
+#define SHADOW_MAP_SIZE 2048
+#define CUBE_SPACING    6.0f
+#define SUBMIT_FRAMES   5
+
+// row by row, as a D3DXMATRIX
+struct Matrix
+{
+    float m[16];
+};
+
+// what the recording jobs share
+struct RecordJob
+{
+    int numObjects;
+    int numRanges;
+    float rotationY;
+    Matrix lightViewProjection;
+    Matrix viewProjection;
+    RenderCommandBuffer* shadowBuffers;     // one per range
+    RenderCommandBuffer* sceneBuffers;
+};
+
+struct ThreadResult
+{
+    int threads;
+    double recordMs;            // mean per frame
+    unsigned long long hash;    // of the last frame
+};
+
+
+static double NowMs()
+{
+#ifdef _WIN32
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+
+    return now.QuadPart * 1000.0 / frequency.QuadPart;
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
+
+//----------------------------------------------------------------------
+// matrices, as D3DX makes them
+//----------------------------------------------------------------------
+
+static Matrix Identity()
+{
+    Matrix result;
+    memset(&result, 0, sizeof(result));
+    result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.0f;
+    return result;
+}
+
+static Matrix Multiply(const Matrix& a, const Matrix& b)
+{
+    Matrix result;
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            result.m[r * 4 + c] = a.m[r * 4 + 0] * b.m[0 * 4 + c] + a.m[r * 4 + 1] * b.m[1 * 4 + c] +
+                a.m[r * 4 + 2] * b.m[2 * 4 + c] + a.m[r * 4 + 3] * b.m[3 * 4 + c];
+        }
+    }
+    return result;
+}
+
+static void Normalize(float* v)
+{
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+}
+
+static void Cross(const float* a, const float* b, float* result)
+{
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// D3DXMatrixLookAtLH looking at the origin with y up
+static Matrix LookAtOrigin(const float* eye)
+{
+    float up[3] = { 0.0f, 1.0f, 0.0f };
+    float z[3] = { -eye[0], -eye[1], -eye[2] };
+    float x[3], y[3];
+    Normalize(z);
+    Cross(up, z, x);
+    Normalize(x);
+    Cross(z, x, y);
+
+    Matrix result = Identity();
+    for (int i = 0; i < 3; ++i)
+    {
+        result.m[i * 4 + 0] = x[i];
+        result.m[i * 4 + 1] = y[i];
+        result.m[i * 4 + 2] = z[i];
+    }
+    result.m[12] = -(x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2]);
+    result.m[13] = -(y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2]);
+    result.m[14] = -(z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2]);
+    return result;
+}
+
+// D3DXMatrixPerspectiveFovLH
+static Matrix Perspective(float fov, float aspect, float zn, float zf)
+{
+    float yScale = 1.0f / tanf(fov / 2.0f);
+
+    Matrix result;
+    memset(&result, 0, sizeof(result));
+    result.m[0] = yScale / aspect;
+    result.m[5] = yScale;
+    result.m[10] = zf / (zf - zn);
+    result.m[11] = 1.0f;
+    result.m[14] = -zn * zf / (zf - zn);
+    return result;
+}
+
+// scaled, turned about y, then moved
+static Matrix Transform(float scaleX, float scaleY, float scaleZ, float angle, float x, float y, float z)
+{
+    Matrix result = Identity();
+    result.m[0] = scaleX * cosf(angle);
+    result.m[2] = -scaleX * sinf(angle);
+    result.m[5] = scaleY;
+    result.m[8] = scaleZ * sinf(angle);
+    result.m[10] = scaleZ * cosf(angle);
+    result.m[12] = x;
+    result.m[13] = y;
+    result.m[14] = z;
+    return result;
+}
+
+//----------------------------------------------------------------------
+// the scene
+//----------------------------------------------------------------------
+
+static float gLightPosition[4] = { 500.0f, 500.0f, -500.0f, 1.0f };
+static float gCameraPosition[4] = { 0.0f, 350.0f, -450.0f, 1.0f };
+static float gFloorColor[4] = { 0.0f, 1.0f, 1.0f, 1.0f };
+static float gBlue[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+static float gWhite[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+static RenderMesh* gpCube = NULL;
+static RenderTexture* gpShadowMap = NULL;
+static RenderPipeline* gpCreateShadow = NULL;
+static RenderPipeline* gpApplyShadow = NULL;
+
+// looked up once, at load
+static int gCreateShadowMatrix = -1;
+static int gApplyWorld = -1;
+static int gApplyLightViewProjection = -1;
+static int gApplyViewProjection = -1;
+static int gApplyLightPosition = -1;
+static int gApplyColor = -1;
+static int gApplyShadowMap = -1;
+
+// a unit cube, faces wound clockwise seen from outside
+static RenderMesh* CreateCube()
+{
+    float positions[24 * 3];
+    float normals[24 * 3];
+    unsigned int indices[36];
+    int vertex = 0;
+    int index = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (int side = -1; side <= 1; side += 2)
+        {
+            float n[3] = { 0.0f, 0.0f, 0.0f };
+            float u[3] = { 0.0f, 0.0f, 0.0f };
+            float v[3] = { 0.0f, 0.0f, 0.0f };
+            n[axis] = (float)side;
+            u[(axis + 1) % 3] = (float)side;
+            v[(axis + 2) % 3] = 1.0f;
+
+            static const float corners[4][2] = { { -1, -1 }, { -1, 1 }, { 1, 1 }, { 1, -1 } };
+            for (int c = 0; c < 4; ++c)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    positions[(vertex + c) * 3 + i] = n[i] + corners[c][0] * u[i] + corners[c][1] * v[i];
+                    normals[(vertex + c) * 3 + i] = n[i];
+                }
+            }
+
+            static const int quad[6] = { 0, 2, 1, 0, 3, 2 };
+            for (int i = 0; i < 6; ++i)
+            {
+                indices[index++] = vertex + quad[i];
+            }
+            vertex += 4;
+        }
+    }
+
+    RenderMeshDesc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.numVertices = 24;
+    desc.numAttributes = 2;
+    desc.attributes[0].semantic = "POSITION";
+    desc.attributes[0].components = 3;
+    desc.attributes[0].values = positions;
+    desc.attributes[1].semantic = "NORMAL";
+    desc.attributes[1].components = 3;
+    desc.attributes[1].values = normals;
+    desc.numIndices = 36;
+    desc.indices = indices;
+    return CreateRenderMesh(desc);
+}
+
+static bool LoadScene(const std::string& root)
+{
+    std::string folder = root + "/10_ShadowMapping/";
+    gpCube = CreateCube();
+    gpShadowMap = CreateRenderTarget(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, RENDER_FORMAT_R32F);
+
+    std::string createShadow = folder + "CreateShadow.fx";
+    std::string applyShadow = folder + "ApplyShadow.fx";
+    RenderPipelineDesc desc = { createShadow.c_str(), NULL, NULL, NULL, RENDER_FORMAT_R32F };
+    gpCreateShadow = CreateRenderPipeline(desc);
+    desc.effect = applyShadow.c_str();
+    desc.format = RENDER_FORMAT_RGBA8;
+    gpApplyShadow = CreateRenderPipeline(desc);
+
+    if (!gpCube || !gpShadowMap || !gpCreateShadow || !gpApplyShadow)
+    {
+        return false;
+    }
+
+    gCreateShadowMatrix = GetRenderUniform(gpCreateShadow, "gWorldLightViewProjectionMatrix");
+    gApplyWorld = GetRenderUniform(gpApplyShadow, "gWorldMatrix");
+    gApplyLightViewProjection = GetRenderUniform(gpApplyShadow, "gLightViewProjectionMatrix");
+    gApplyViewProjection = GetRenderUniform(gpApplyShadow, "gViewProjectionMatrix");
+    gApplyLightPosition = GetRenderUniform(gpApplyShadow, "gWorldLightPosition");
+    gApplyColor = GetRenderUniform(gpApplyShadow, "gObjectColor");
+    gApplyShadowMap = GetRenderSampler(gpApplyShadow, "ShadowMap_Tex");
+    return true;
+}
+
+static void ReleaseScene()
+{
+    ReleaseRenderPipeline(gpApplyShadow);
+    ReleaseRenderPipeline(gpCreateShadow);
+    ReleaseRenderTexture(gpShadowMap);
+    ReleaseRenderMesh(gpCube);
+    gpApplyShadow = gpCreateShadow = NULL;
+    gpShadowMap = NULL;
+    gpCube = NULL;
+}
+
+// values into the uniform at offset, if the pipeline has it
+static void SetUniform(float* uniforms, int offset, const float* values, int count)
+{
+    if (offset >= 0)
+    {
+        memcpy(uniforms + offset, values, count * sizeof(float));
+    }
+}
+
+static void RecordShadowDraw(RenderCommandBuffer* buffer, const Matrix& world, const RecordJob& job)
+{
+    RenderDraw draw;
+    memset(&draw, 0, sizeof(draw));
+    draw.pipeline = gpCreateShadow;
+    draw.mesh = gpCube;
+
+    Matrix worldLightViewProjection = Multiply(world, job.lightViewProjection);
+    float* uniforms = RecordRenderUniforms(buffer, gpCreateShadow, &draw.uniforms);
+    SetUniform(uniforms, gCreateShadowMatrix, worldLightViewProjection.m, 16);
+    RecordRenderDraw(buffer, draw);
+}
+
+static void RecordSceneDraw(RenderCommandBuffer* buffer, const Matrix& world, const float* color,
+    const RecordJob& job)
+{
+    RenderDraw draw;
+    memset(&draw, 0, sizeof(draw));
+    draw.pipeline = gpApplyShadow;
+    draw.mesh = gpCube;
+    if (gApplyShadowMap >= 0)
+    {
+        draw.textures[gApplyShadowMap] = gpShadowMap;
+    }
+
+    float* uniforms = RecordRenderUniforms(buffer, gpApplyShadow, &draw.uniforms);
+    SetUniform(uniforms, gApplyWorld, world.m, 16);
+    SetUniform(uniforms, gApplyLightViewProjection, job.lightViewProjection.m, 16);
+    SetUniform(uniforms, gApplyViewProjection, job.viewProjection.m, 16);
+    SetUniform(uniforms, gApplyLightPosition, gLightPosition, 4);
+    SetUniform(uniforms, gApplyColor, color, 4);
+    RecordRenderDraw(buffer, draw);
+}
+
+// records the cubes of ranges [begin, end); the first range begins
+// both passes and draws the floor
+static void RecordRanges(void* data, int begin, int end)
+{
+    const RecordJob& job = *(const RecordJob*)data;
+    int side = (int)ceilf(sqrtf((float)job.numObjects));
+    float half = (side - 1) * CUBE_SPACING / 2.0f;
+
+    for (int range = begin; range < end; ++range)
+    {
+        RenderCommandBuffer* shadowBuffer = &job.shadowBuffers[range];
+        RenderCommandBuffer* sceneBuffer = &job.sceneBuffers[range];
+        ResetRenderCommands(shadowBuffer);
+        ResetRenderCommands(sceneBuffer);
+
+        if (range == 0)
+        {
+            RecordRenderPass(shadowBuffer, gpShadowMap, gWhite, true);
+            RecordRenderPass(sceneBuffer, NULL, gBlue, true);
+            RecordSceneDraw(sceneBuffer, Transform(half + CUBE_SPACING, 1.0f, half + CUBE_SPACING, 0.0f,
+                0.0f, -3.0f, 0.0f), gFloorColor, job);
+        }
+
+        int first = (int)((long long)job.numObjects * range / job.numRanges);
+        int last = (int)((long long)job.numObjects * (range + 1) / job.numRanges);
+        for (int i = first; i < last; ++i)
+        {
+            float x = (i % side) * CUBE_SPACING - half;
+            float z = (i / side) * CUBE_SPACING - half;
+            Matrix world = Transform(1.0f, 1.0f + (i % 7) * 0.25f, 1.0f, job.rotationY + i * 0.1f, x, 1.0f, z);
+            float color[4] = { (i % 5) / 4.0f, 1.0f - (i % 3) / 2.0f, 0.0f, 1.0f };
+
+            RecordShadowDraw(shadowBuffer, world, job);
+            RecordSceneDraw(sceneBuffer, world, color, job);
+        }
+    }
+}
+
+// a frame of the scene in threads ranges, the calling thread recording
+// one of them
+static void RecordFrame(RecordJob* job, int threads)
+{
+    job->numRanges = threads;
+    if (threads == 1)
+    {
+        RecordRanges(job, 0, 1);
+        return;
+    }
+
+    JobCounter counter;
+    counter.count = 0;
+    for (int range = 1; range < threads; ++range)
+    {
+        RunJob(RecordRanges, job, range, range + 1, &counter);
+    }
+    RecordRanges(job, 0, 1);
+    WaitForCounter(&counter);
+}
+
+// the buffers in the order they are submitted
+static std::vector<RenderCommandBuffer*> SubmitOrder(const RecordJob& job)
+{
+    std::vector<RenderCommandBuffer*> buffers;
+    for (int range = 0; range < job.numRanges; ++range)
+    {
+        buffers.push_back(&job.shadowBuffers[range]);
+    }
+    for (int range = 0; range < job.numRanges; ++range)
+    {
+        buffers.push_back(&job.sceneBuffers[range]);
+    }
+    return buffers;
+}
+
+static void HashBytes(unsigned long long* hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        *hash = (*hash ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+// FNV-1a of the passes and draws as they would be submitted, the
+// uniforms' values rather than their offsets in the buffers
+static unsigned long long HashCommands(const std::vector<RenderCommandBuffer*>& buffers)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t b = 0; b < buffers.size(); ++b)
+    {
+        const RenderCommandBuffer& buffer = *buffers[b];
+        for (size_t c = 0; c < buffer.commands.size(); ++c)
+        {
+            RenderCommand command = buffer.commands[c];
+            int size = (command.type == RENDER_COMMAND_DRAW) ? command.draw.pipeline->layout.size : 0;
+            if (size > 0)
+            {
+                HashBytes(&hash, &buffer.uniforms[command.draw.uniforms], size * sizeof(float));
+            }
+            command.draw.uniforms = 0;
+            HashBytes(&hash, &command, sizeof(command));
+        }
+    }
+    return hash;
+}
+
+//----------------------------------------------------------------------
+// benchmark
+//----------------------------------------------------------------------
+
+static bool WriteTga(const char* filename, const unsigned char* rgba, int width, int height)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    // uncompressed 32 bit, top row first
+    unsigned char header[18];
+    memset(header, 0, sizeof(header));
+    header[2] = 2;
+    header[12] = (unsigned char)(width & 0xFF);
+    header[13] = (unsigned char)(width >> 8);
+    header[14] = (unsigned char)(height & 0xFF);
+    header[15] = (unsigned char)(height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;
+    fwrite(header, 1, sizeof(header), fp);
+
+    std::vector<unsigned char> bgra(rgba, rgba + width * height * 4);
+    for (size_t i = 0; i < bgra.size(); i += 4)
+    {
+        std::swap(bgra[i], bgra[i + 2]);
+    }
+    bool written = fwrite(&bgra[0], 1, bgra.size(), fp) == bgra.size();
+    fclose(fp);
+    return written;
+}
+
+// records frames frames on threads threads
+static ThreadResult RunRecording(RecordJob* job, int threads, int frames)
+{
+    if (threads > 1)
+    {
+        InitJobSystem(threads - 1);
+    }
+
+    // one frame before timing, so the buffers have grown to their size
+    job->rotationY = 0.0f;
+    RecordFrame(job, threads);
+
+    double total = 0.0;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        job->rotationY = frame * ROTATION_SPEED * FRAME_SECONDS;
+        double start = NowMs();
+        RecordFrame(job, threads);
+        total += NowMs() - start;
+    }
+
+    if (threads > 1)
+    {
+        ReleaseJobSystem();
+    }
+
+    ThreadResult result;
+    result.threads = threads;
+    result.recordMs = total / frames;
+    result.hash = HashCommands(SubmitOrder(*job));
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const char* backendName = "software";
+    int numObjects = 10000;
+    int frames = 30;
+    int maxThreads = 0;
+    std::string root = "../..";
+    std::string out = "recordbench.tga";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-backend") == 0 && i + 1 < argc)
+        {
+            backendName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-objects") == 0 && i + 1 < argc)
+        {
+            numObjects = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+        {
+            frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+        {
+            maxThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-root") == 0 && i + 1 < argc)
+        {
+            root = argv[++i];
+        }
+        else if (strcmp(argv[i], "-out") == 0 && i + 1 < argc)
+        {
+            out = argv[++i];
+        }
+        else
+        {
+            printf("usage: RecordBench [-backend software|gl] [-objects 10000] [-frames 30]\n"
+                   "                   [-threads N] [-root ../..] [-out recordbench.tga]\n");
+            return 1;
+        }
+    }
+
+    if (numObjects < 1 || frames < 1 || maxThreads < 0)
+    {
+        printf("-objects and -frames must be at least 1, -threads at least 0\n");
+        return 1;
+    }
+    if (maxThreads == 0)
+    {
+        maxThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+    }
+
+    const RenderBackend* backend = NULL;
+    if (strcmp(backendName, "software") == 0)
+    {
+        backend = GetSoftwareRenderBackend();
+    }
+    else if (strcmp(backendName, "gl") == 0)
+    {
+        backend = GetGlRenderBackend();
+    }
+    if (!backend)
+    {
+        printf("no backend called %s\n", backendName);
+        return 1;
+    }
+    if (!InitRenderBackend(backend, WIN_WIDTH, WIN_HEIGHT))
+    {
+        printf("failed at starting the %s backend\n", backendName);
+        return 1;
+    }
+    if (!LoadScene(root))
+    {
+        printf("failed at loading the scene\n");
+        ReleaseScene();
+        ReleaseRenderBackend();
+        return 1;
+    }
+
+    std::vector<RenderCommandBuffer> shadowBuffers(maxThreads);
+    std::vector<RenderCommandBuffer> sceneBuffers(maxThreads);
+
+    RecordJob job;
+    job.numObjects = numObjects;
+    job.numRanges = 1;
+    job.rotationY = 0.0f;
+    job.lightViewProjection = Multiply(LookAtOrigin(gLightPosition), Perspective(PI / 4.0f, 1, 1, 3000));
+    job.viewProjection = Multiply(LookAtOrigin(gCameraPosition), Perspective(FOV, ASPECT_RATIO, NEAR_PLANE, FAR_PLANE));
+    job.shadowBuffers = &shadowBuffers[0];
+    job.sceneBuffers = &sceneBuffers[0];
+
+    // recording; 1, 2, 4... and the most threads
+    printf("recording %d objects, 2 passes, %d frames\n", numObjects, frames);
+    printf("%9s %10s %12s %9s %18s\n", "threads", "ms", "draws/ms", "speedup", "hash");
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    bool failed = false;
+    double serialMs = 0.0;
+    unsigned long long serialHash = 0;
+    for (size_t i = 0; i < threadCounts.size(); ++i)
+    {
+        ThreadResult result = RunRecording(&job, threadCounts[i], frames);
+        if (i == 0)
+        {
+            serialMs = result.recordMs;
+            serialHash = result.hash;
+        }
+
+        bool same = (result.hash == serialHash);
+        failed = failed || !same;
+        printf("%9d %10.3f %12.1f %8.2fx   %016llx%s\n", result.threads, result.recordMs,
+            (2.0 * numObjects + 1) / result.recordMs, serialMs / result.recordMs, result.hash,
+            same ? "" : "  differs");
+    }
+
+    // submitting what the most threads recorded, on this thread
+    std::vector<RenderCommandBuffer*> buffers = SubmitOrder(job);
+    RenderCommandStats commandStats;
+    double submitMs = 0.0;
+    for (int frame = 0; frame < SUBMIT_FRAMES; ++frame)
+    {
+        double start = NowMs();
+        BeginRenderFrame();
+        commandStats = SubmitRenderCommands(&buffers[0], (int)buffers.size());
+        EndRenderFrame();
+        submitMs += NowMs() - start;
+    }
+    RenderStats stats = GetRenderStats();
+    printf("\nsubmitting (%s): %.3f ms, %d passes, %d draws, %lld uniform bytes, %d triangles\n",
+        backendName, submitMs / SUBMIT_FRAMES, commandStats.passes, commandStats.draws,
+        commandStats.uniformBytes, stats.triangles);
+
+    std::vector<unsigned char> rgba(WIN_WIDTH * WIN_HEIGHT * 4);
+    if (!ReadRenderFrame(&rgba[0]) || !WriteTga(out.c_str(), &rgba[0], WIN_WIDTH, WIN_HEIGHT))
+    {
+        printf("failed at writing %s\n", out.c_str());
+        failed = true;
+    }
+
+    ReleaseScene();
+    ReleaseRenderBackend();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+//**********************************************************************
+//
+// SampleBench.cpp
+//
+// Runs every sample in benchmark mode (see FrameBenchmark.h) and
+// collects the results into one JSON file. Given the results of an
+// earlier run, it fails when a sample's frame times regress.
+//
+// usage: SampleBench [-frames N] [-config Release] [-root ..\..]
+//                    [-out results.json] [-baseline old.json] [-tolerance 5]
+//        SampleBench -golden [update] [-config Release] [-root ..\..]
+//
+// the samples have to be built in the given configuration first.
+// exits with 1 if a sample fails to run or is slower than the baseline
+// by more than the tolerance (in percent) at p50 or p95.
+//
+// with -golden every sample runs its golden-image test instead (see
+// GoldenTest.h); exits with 1 if any of them fails. a sample without
+// golden images is reported as having no baselines, not as failing.
+//
+//**********************************************************************
+
+#include "FileUtil.h"
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define RUN_TIMEOUT_MS (10 * 60 * 1000)
+
+// the same as GoldenTest.h's
+#define GOLDEN_EXIT_NO_BASELINES 2
+
+static const char* gSamples[] =
+{
+    "01_DxFramework",
+    "02_ColorShader",
+    "03_TextureMapping",
+    "04_Lighting",
+    "05_DiffuseSpecularMapping",
+    "06_ToonShader",
+    "07_NormalMapping",
+    "08_EnvironmentMapping",
+    "09_UVAnimation",
+    "10_ShadowMapping",
+    "11_ColorConversion",
+    "12_EdgeDetection"
+};
+
+#define NUM_SAMPLES (sizeof(gSamples) / sizeof(gSamples[0]))
+
+
+// runs a sample's exe with the given arguments in the sample's folder.
+// returns its exit code, or -1 if it did not run to the end.
+static int RunProcess(const char* root, const char* sample, const char* config, const char* arguments)
+{
+    char directory[MAX_PATH];
+    char exe[MAX_PATH];
+    _snprintf(directory, MAX_PATH, "%s\\%s", root, sample);
+    _snprintf(exe, MAX_PATH, "%s\\%s\\BasicFramework.exe", directory, config);
+
+    char cmdLine[MAX_PATH * 2];
+    _snprintf(cmdLine, sizeof(cmdLine), "\"%s\" %s", exe, arguments);
+
+    STARTUPINFO startup;
+    ZeroMemory(&startup, sizeof(startup));
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION process;
+
+    // the samples load their assets relative to their own folder
+    if (!CreateProcess(exe, cmdLine, NULL, NULL, FALSE, 0, NULL, directory, &startup, &process))
+    {
+        printf("  %s: cannot start %s\n", sample, exe);
+        return -1;
+    }
+
+    DWORD exitCode = (DWORD)-1;
+    if (WaitForSingleObject(process.hProcess, RUN_TIMEOUT_MS) == WAIT_OBJECT_0)
+    {
+        GetExitCodeProcess(process.hProcess, &exitCode);
+    }
+    else
+    {
+        TerminateProcess(process.hProcess, 1);
+        printf("  %s: timed out\n", sample);
+    }
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+
+    return (int)exitCode;
+}
+
+// runs one sample's benchmark and returns the JSON it wrote, or "" on failure
+static std::string RunSample(const char* root, const char* sample, const char* config, int frames)
+{
+    char resultFile[MAX_PATH];
+    _snprintf(resultFile, MAX_PATH, "%s\\%s\\benchmark.json", root, sample);
+    DeleteFile(resultFile);
+
+    char arguments[64];
+    _snprintf(arguments, sizeof(arguments), "-benchmark %d -out benchmark.json", frames);
+
+    if (RunProcess(root, sample, config, arguments) != 0)
+    {
+        return "";
+    }
+
+    size_t size = 0;
+    unsigned char* data = ReadWholeFile(resultFile, &size);
+    if (!data)
+    {
+        printf("  %s: no results\n", sample);
+        return "";
+    }
+
+    std::string json((const char*)data, size);
+    delete[] data;
+    DeleteFile(resultFile);
+
+    return json;
+}
+
+// value of "key" in the first object after "sample": "name" in json;
+// enough for the files this tool and FrameBenchmark write
+static double FindValue(const std::string& json, const char* sample, const char* key)
+{
+    std::string sampleKey = std::string("\"sample\": \"") + sample + "\"";
+    size_t at = json.find(sampleKey);
+    if (at == std::string::npos)
+    {
+        return -1;
+    }
+
+    size_t end = json.find("\"sample\"", at + sampleKey.size());
+    size_t value = json.find(std::string("\"") + key + "\":", at);
+    if (value == std::string::npos || (end != std::string::npos && value > end))
+    {
+        return -1;
+    }
+
+    return atof(json.c_str() + value + strlen(key) + 3);
+}
+
+// runs every sample's golden-image test
+static int RunGoldenTests(const char* root, const char* config, bool update)
+{
+    bool failed = false;
+
+    for (size_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        int exitCode = RunProcess(root, gSamples[i], config, update ? "-golden update" : "-golden");
+        const char* result = "FAIL";
+        if (exitCode == 0)
+        {
+            result = update ? "updated" : "pass";
+        }
+        else if (exitCode == GOLDEN_EXIT_NO_BASELINES)
+        {
+            result = "no baselines";
+        }
+        printf("%-28s %s\n", gSamples[i], result);
+        failed = failed || (exitCode != 0 && exitCode != GOLDEN_EXIT_NO_BASELINES);
+    }
+
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 1000;
+    const char* config = "Release";
+    const char* root = "..\\..";
+    const char* output = "results.json";
+    const char* baselineFile = NULL;
+    double tolerance = 5.0;
+    bool golden = false;
+    bool goldenUpdate = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "-frames") == 0 && hasValue)
+        {
+            frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-config") == 0 && hasValue)
+        {
+            config = argv[++i];
+        }
+        else if (strcmp(argv[i], "-root") == 0 && hasValue)
+        {
+            root = argv[++i];
+        }
+        else if (strcmp(argv[i], "-out") == 0 && hasValue)
+        {
+            output = argv[++i];
+        }
+        else if (strcmp(argv[i], "-baseline") == 0 && hasValue)
+        {
+            baselineFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "-tolerance") == 0 && hasValue)
+        {
+            tolerance = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-golden") == 0)
+        {
+            golden = true;
+            if (hasValue && strcmp(argv[i + 1], "update") == 0)
+            {
+                goldenUpdate = true;
+                ++i;
+            }
+        }
+        else
+        {
+            printf("usage: SampleBench [-frames N] [-config Release] [-root ..\\..]\n"
+                   "                   [-out results.json] [-baseline old.json] [-tolerance 5]\n"
+                   "       SampleBench -golden [update] [-config Release] [-root ..\\..]\n");
+            return 1;
+        }
+    }
+
+    if (golden)
+    {
+        return RunGoldenTests(root, config, goldenUpdate);
+    }
+
+    std::string baseline;
+    if (baselineFile)
+    {
+        size_t size = 0;
+        unsigned char* data = ReadWholeFile(baselineFile, &size);
+        if (!data)
+        {
+            printf("failed at loading the baseline: %s\n", baselineFile);
+            return 1;
+        }
+        baseline.assign((const char*)data, size);
+        delete[] data;
+    }
+
+    std::string results = "{\n\"config\": \"" + std::string(config) + "\",\n\"samples\": [\n";
+    bool failed = false;
+
+    printf("%-28s %9s %9s %9s %9s %10s\n", "sample", "p50 ms", "p95 ms", "p99 ms", "fps", "peak KB");
+
+    for (size_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        std::string json = RunSample(root, gSamples[i], config, frames);
+        if (json.empty())
+        {
+            failed = true;
+            continue;
+        }
+
+        if (results[results.size() - 2] == '}')
+        {
+            results.insert(results.size() - 1, ",");
+        }
+        results += json;
+
+        double p50 = FindValue(json, gSamples[i], "p50");
+        double p95 = FindValue(json, gSamples[i], "p95");
+        printf("%-28s %9.3f %9.3f %9.3f %9.1f %10.0f\n", gSamples[i], p50, p95,
+            FindValue(json, gSamples[i], "p99"), FindValue(json, gSamples[i], "framesPerSecond"),
+            FindValue(json, gSamples[i], "peakRssKB"));
+
+        if (!baseline.empty())
+        {
+            double baseP50 = FindValue(baseline, gSamples[i], "p50");
+            double baseP95 = FindValue(baseline, gSamples[i], "p95");
+            double limit = 1.0 + tolerance / 100.0;
+
+            if ((baseP50 > 0 && p50 > baseP50 * limit) || (baseP95 > 0 && p95 > baseP95 * limit))
+            {
+                printf("  REGRESSION: p50 %.3f -> %.3f ms, p95 %.3f -> %.3f ms\n", baseP50, p50, baseP95, p95);
+                failed = true;
+            }
+        }
+    }
+
+    results += "]\n}\n";
+
+    FILE* fp = fopen(output, "w");
+    if (!fp)
+    {
+        printf("failed at writing: %s\n", output);
+        return 1;
+    }
+    fwrite(results.c_str(), 1, results.size(), fp);
+    fclose(fp);
+
+    return failed ? 1 : 0;
+}
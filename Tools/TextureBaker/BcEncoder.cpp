@@ -0,0 +1,312 @@
+//**********************************************************************
+//
+// BcEncoder.cpp
+//
+// Block encoders for the offline texture baker.
+// BC1 for color, BC4 for single-channel and BC5 for two-channel data.
+//
+//**********************************************************************
+
+#include "BcEncoder.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BC1_REFINE_ITERATIONS 2
+
+
+//----------------------------------------------------------------------
+// BC1
+//----------------------------------------------------------------------
+
+static int Clamp(int v, int lo, int hi)
+{
+    return (v < lo) ? lo : ((v > hi) ? hi : v);
+}
+
+static unsigned int Quantize565(const float rgb[3])
+{
+    int r = Clamp((int)(rgb[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = Clamp((int)(rgb[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = Clamp((int)(rgb[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+
+    return (r << 11) | (g << 5) | b;
+}
+
+// same expansion the decoder uses
+static void Expand565(unsigned int c, int rgb[3])
+{
+    int r = (c >> 11) & 0x1F;
+    int g = (c >> 5) & 0x3F;
+    int b = c & 0x1F;
+
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// picks the nearest of the 4 palette entries for every pixel and
+// returns the total squared error
+static int PickColorIndices(const int pixels[16][3], unsigned int c0, unsigned int c1, int indices[16])
+{
+    int palette[4][3];
+    Expand565(c0, palette[0]);
+    Expand565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    int totalError = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestError = 0x7FFFFFFF;
+        for (int p = 0; p < 4; ++p)
+        {
+            int dr = pixels[i][0] - palette[p][0];
+            int dg = pixels[i][1] - palette[p][1];
+            int db = pixels[i][2] - palette[p][2];
+            int error = dr * dr + dg * dg + db * db;
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[i] = p;
+            }
+        }
+        totalError += bestError;
+    }
+
+    return totalError;
+}
+
+// least-squares endpoints for fixed indices. index 0/1/2/3 puts the
+// pixel at 1, 0, 2/3, 1/3 of the way from end1 to end0.
+static bool SolveEndpoints(const int pixels[16][3], const int indices[16], float end0[3], float end1[3])
+{
+    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    float aa = 0, bb = 0, ab = 0;
+    float ax[3] = { 0, 0, 0 };
+    float bx[3] = { 0, 0, 0 };
+
+    for (int i = 0; i < 16; ++i)
+    {
+        float a = weights[indices[i]];
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; ++c)
+        {
+            ax[c] += a * pixels[i][c];
+            bx[c] += b * pixels[i][c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (fabsf(det) < 1e-6f)
+    {
+        return false;
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        end0[c] = (ax[c] * bb - bx[c] * ab) / det;
+        end1[c] = (bx[c] * aa - ax[c] * ab) / det;
+    }
+
+    return true;
+}
+
+static void WriteBc1Block(unsigned int c0, unsigned int c1, const int indices[16], unsigned char block[8])
+{
+    // 4-color mode needs c0 > c1; swapping the endpoints flips 0<->1 and 2<->3
+    bool swap = c0 < c1;
+    if (swap)
+    {
+        unsigned int t = c0;
+        c0 = c1;
+        c1 = t;
+    }
+
+    block[0] = (unsigned char)(c0 & 0xFF);
+    block[1] = (unsigned char)(c0 >> 8);
+    block[2] = (unsigned char)(c1 & 0xFF);
+    block[3] = (unsigned char)(c1 >> 8);
+
+    for (int y = 0; y < 4; ++y)
+    {
+        unsigned int bits = 0;
+        for (int x = 0; x < 4; ++x)
+        {
+            unsigned int index = (c0 == c1) ? 0 : (unsigned int)indices[y * 4 + x];
+            if (swap)
+            {
+                index ^= 1;
+            }
+            bits |= index << (2 * x);
+        }
+        block[4 + y] = (unsigned char)bits;
+    }
+}
+
+// endpoints start on the principal axis of the block's colors, then a
+// couple of least-squares passes refit them to the chosen indices
+void EncodeBc1Block(const unsigned char pixels[64], unsigned char block[8])
+{
+    int colors[16][3];
+    float mean[3] = { 0, 0, 0 };
+
+    for (int i = 0; i < 16; ++i)
+    {
+        colors[i][0] = pixels[i * 4 + 2];
+        colors[i][1] = pixels[i * 4 + 1];
+        colors[i][2] = pixels[i * 4 + 0];
+        for (int c = 0; c < 3; ++c)
+        {
+            mean[c] += colors[i][c] / 16.0f;
+        }
+    }
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i < 16; ++i)
+    {
+        float r = colors[i][0] - mean[0];
+        float g = colors[i][1] - mean[1];
+        float b = colors[i][2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    // power iteration for the principal axis
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float length = sqrtf(x * x + y * y + z * z);
+        if (length < 1e-6f)
+        {
+            break;
+        }
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    float minProj = 1e30f;
+    float maxProj = -1e30f;
+    for (int i = 0; i < 16; ++i)
+    {
+        float proj = (colors[i][0] - mean[0]) * axis[0] + (colors[i][1] - mean[1]) * axis[1] + (colors[i][2] - mean[2]) * axis[2];
+        minProj = (proj < minProj) ? proj : minProj;
+        maxProj = (proj > maxProj) ? proj : maxProj;
+    }
+
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        end0[c] = mean[c] + axis[c] * maxProj;
+        end1[c] = mean[c] + axis[c] * minProj;
+    }
+
+    unsigned int bestC0 = Quantize565(end0);
+    unsigned int bestC1 = Quantize565(end1);
+    int bestIndices[16];
+    int bestError = PickColorIndices(colors, bestC0, bestC1, bestIndices);
+
+    int indices[16];
+    memcpy(indices, bestIndices, sizeof(indices));
+
+    for (int iteration = 0; iteration < BC1_REFINE_ITERATIONS && bestError > 0; ++iteration)
+    {
+        if (!SolveEndpoints(colors, indices, end0, end1))
+        {
+            break;
+        }
+
+        unsigned int c0 = Quantize565(end0);
+        unsigned int c1 = Quantize565(end1);
+        int error = PickColorIndices(colors, c0, c1, indices);
+
+        if (error >= bestError)
+        {
+            break;
+        }
+
+        bestError = error;
+        bestC0 = c0;
+        bestC1 = c1;
+        memcpy(bestIndices, indices, sizeof(indices));
+    }
+
+    WriteBc1Block(bestC0, bestC1, bestIndices, block);
+}
+
+//----------------------------------------------------------------------
+// BC4 / BC5
+//----------------------------------------------------------------------
+
+// 8-value mode between the block's min and max, nearest index per value
+void EncodeBc4Block(const unsigned char values[16], unsigned char block[8])
+{
+    int maxValue = 0;
+    int minValue = 255;
+    for (int i = 0; i < 16; ++i)
+    {
+        maxValue = (values[i] > maxValue) ? values[i] : maxValue;
+        minValue = (values[i] < minValue) ? values[i] : minValue;
+    }
+
+    block[0] = (unsigned char)maxValue;
+    block[1] = (unsigned char)minValue;
+
+    int palette[8];
+    palette[0] = maxValue;
+    palette[1] = minValue;
+    for (int i = 1; i < 7; ++i)
+    {
+        palette[i + 1] = ((7 - i) * maxValue + i * minValue) / 7;
+    }
+
+    unsigned long long bits = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestIndex = 0;
+        int bestError = 0x7FFFFFFF;
+        for (int p = 0; p < 8; ++p)
+        {
+            int error = abs(values[i] - palette[p]);
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+
+        // a flat block decodes to a0 from index 0 in either mode
+        if (maxValue == minValue)
+        {
+            bestIndex = 0;
+        }
+
+        bits |= (unsigned long long)bestIndex << (3 * i);
+    }
+
+    for (int i = 0; i < 6; ++i)
+    {
+        block[2 + i] = (unsigned char)(bits >> (8 * i));
+    }
+}
+
+void EncodeBc5Block(const unsigned char red[16], const unsigned char green[16], unsigned char block[16])
+{
+    EncodeBc4Block(red, block);
+    EncodeBc4Block(green, block + 8);
+}
@@ -0,0 +1,22 @@
+//**********************************************************************
+//
+// BcEncoder.h
+//
+// Block encoders for the offline texture baker.
+// BC1 for color, BC4 for single-channel and BC5 for two-channel data.
+//
+//**********************************************************************
+
+
+#pragma once
+
+// ---------------- function prototype  ------------------------
+
+// 16 BGRA pixels (row by row) -> one 8-byte BC1 block, always 4-color mode
+void EncodeBc1Block(const unsigned char pixels[64], unsigned char block[8]);
+
+// 16 values -> one 8-byte BC4 block
+void EncodeBc4Block(const unsigned char values[16], unsigned char block[8]);
+
+// 16 red and 16 green values -> one 16-byte BC5 block (red first)
+void EncodeBc5Block(const unsigned char red[16], const unsigned char green[16], unsigned char block[16]);
@@ -0,0 +1,452 @@
+//**********************************************************************
+//
+// TextureBaker.cpp
+//
+// Offline texture baker. Builds a mip chain from a TGA and encodes it
+// into a block-compressed DDS that LoadTexture() can read.
+//
+// usage: TextureBaker <input.tga> <output.dds> <diffuse|specular|normal>
+//
+//   diffuse  -> BC1, mips filtered in linear space (gamma-correct)
+//   specular -> BC4, red channel only
+//   normal   -> BC5, X and Y only; shaders rebuild Z
+//
+//**********************************************************************
+
+#include "BcEncoder.h"
+#include "DdsLoader.h"
+#include "FileUtil.h"
+#include "JobSystem.h"
+#include "TgaLoader.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define MAX_MIPS 16
+
+enum TextureKind
+{
+    TEXTURE_DIFFUSE,
+    TEXTURE_SPECULAR,
+    TEXTURE_NORMAL
+};
+
+// one BGRA8 mip level
+struct MipLevel
+{
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+// one row of blocks to encode, and where it goes in the output
+struct BlockRow
+{
+    int mip;
+    int blockRow;
+    size_t offset;
+};
+
+struct EncodeJob
+{
+    const std::vector<MipLevel>* mips;
+    TextureKind kind;
+    const std::vector<BlockRow>* rows;
+    unsigned char* data;
+};
+
+
+//----------------------------------------------------------------------
+// mip generation
+//----------------------------------------------------------------------
+
+static float SrgbToLinear(float c)
+{
+    return (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSrgb(float c)
+{
+    return (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+}
+
+static unsigned char ToByte(float v)
+{
+    int i = (int)(v * 255.0f + 0.5f);
+    return (unsigned char)((i < 0) ? 0 : ((i > 255) ? 255 : i));
+}
+
+// 2x2 box filter. diffuse is averaged in linear space, normals are
+// averaged as vectors and renormalized, specular is plain linear data.
+static void Downsample(const MipLevel& src, MipLevel& dst, TextureKind kind)
+{
+    dst.width = (src.width > 1) ? src.width / 2 : 1;
+    dst.height = (src.height > 1) ? src.height / 2 : 1;
+    dst.pixels.resize(dst.width * dst.height * 4);
+
+    static float srgbTable[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            srgbTable[i] = SrgbToLinear(i / 255.0f);
+        }
+        tableReady = true;
+    }
+
+    for (int y = 0; y < dst.height; ++y)
+    {
+        for (int x = 0; x < dst.width; ++x)
+        {
+            float sum[3] = { 0, 0, 0 };
+
+            for (int s = 0; s < 4; ++s)
+            {
+                int sx = x * 2 + (s & 1);
+                int sy = y * 2 + (s >> 1);
+                sx = (sx < src.width) ? sx : src.width - 1;
+                sy = (sy < src.height) ? sy : src.height - 1;
+
+                const unsigned char* p = &src.pixels[(sy * src.width + sx) * 4];
+                for (int c = 0; c < 3; ++c)
+                {
+                    if (kind == TEXTURE_DIFFUSE)
+                    {
+                        sum[c] += srgbTable[p[c]];
+                    }
+                    else if (kind == TEXTURE_NORMAL)
+                    {
+                        sum[c] += p[c] / 127.5f - 1.0f;
+                    }
+                    else
+                    {
+                        sum[c] += p[c] / 255.0f;
+                    }
+                }
+            }
+
+            unsigned char* out = &dst.pixels[(y * dst.width + x) * 4];
+
+            if (kind == TEXTURE_NORMAL)
+            {
+                float length = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                if (length < 1e-6f)
+                {
+                    sum[0] = sum[1] = 0.0f;
+                    sum[2] = length = 1.0f;
+                }
+                for (int c = 0; c < 3; ++c)
+                {
+                    out[c] = ToByte(sum[c] / length * 0.5f + 0.5f);
+                }
+            }
+            else
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    float v = sum[c] * 0.25f;
+                    out[c] = ToByte((kind == TEXTURE_DIFFUSE) ? LinearToSrgb(v) : v);
+                }
+            }
+            out[3] = 0xFF;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// encoding
+//----------------------------------------------------------------------
+
+static DdsFormat GetFormat(TextureKind kind)
+{
+    switch (kind)
+    {
+    case TEXTURE_SPECULAR:
+        return DDS_FORMAT_BC4;
+    case TEXTURE_NORMAL:
+        return DDS_FORMAT_BC5;
+    default:
+        return DDS_FORMAT_BC1;
+    }
+}
+
+// encodes one row of blocks of a mip. edge blocks of mips smaller than 4x4
+// repeat the last row/column.
+static void EncodeBlockRow(const MipLevel& mip, int by, TextureKind kind, unsigned char* out)
+{
+    int blocksWide = (mip.width + 3) / 4;
+    int blockSize = GetBlockSize(GetFormat(kind));
+
+    for (int bx = 0; bx < blocksWide; ++bx)
+    {
+        unsigned char pixels[64];
+        unsigned char red[16];
+        unsigned char green[16];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int x = bx * 4 + (i & 3);
+            int y = by * 4 + (i >> 2);
+            x = (x < mip.width) ? x : mip.width - 1;
+            y = (y < mip.height) ? y : mip.height - 1;
+
+            const unsigned char* p = &mip.pixels[(y * mip.width + x) * 4];
+            memcpy(pixels + i * 4, p, 4);
+            red[i] = p[2];
+            green[i] = p[1];
+        }
+
+        unsigned char* block = out + bx * blockSize;
+
+        switch (kind)
+        {
+        case TEXTURE_DIFFUSE:
+            EncodeBc1Block(pixels, block);
+            break;
+        case TEXTURE_SPECULAR:
+            EncodeBc4Block(red, block);
+            break;
+        case TEXTURE_NORMAL:
+            EncodeBc5Block(red, green, block);
+            break;
+        }
+    }
+}
+
+static void EncodeBlockRows(void* data, int begin, int end)
+{
+    EncodeJob* job = (EncodeJob*)data;
+
+    for (int i = begin; i < end; ++i)
+    {
+        const BlockRow& row = (*job->rows)[i];
+        EncodeBlockRow((*job->mips)[row.mip], row.blockRow, job->kind, job->data + row.offset);
+    }
+}
+
+// block rows of every mip are handed out to the job system
+static void EncodeMips(const std::vector<MipLevel>& mips, TextureKind kind, std::vector<unsigned char>& data,
+    std::vector<size_t>& offsets)
+{
+    int blockSize = GetBlockSize(GetFormat(kind));
+
+    std::vector<BlockRow> rows;
+
+    size_t size = 0;
+    for (size_t m = 0; m < mips.size(); ++m)
+    {
+        offsets.push_back(size);
+
+        int blocksWide = (mips[m].width + 3) / 4;
+        int blocksHigh = (mips[m].height + 3) / 4;
+        for (int by = 0; by < blocksHigh; ++by)
+        {
+            BlockRow row = { (int)m, by, size };
+            rows.push_back(row);
+            size += blocksWide * blockSize;
+        }
+    }
+    data.resize(size);
+
+    EncodeJob job = { &mips, kind, &rows, &data[0] };
+    ParallelFor(0, (int)rows.size(), 1, EncodeBlockRows, &job);
+}
+
+//----------------------------------------------------------------------
+// output
+//----------------------------------------------------------------------
+
+static void WriteU32(FILE* fp, unsigned int v)
+{
+    unsigned char b[4] = { (unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+    fwrite(b, 1, 4, fp);
+}
+
+static bool WriteDds(const char* filename, const std::vector<MipLevel>& mips, TextureKind kind,
+    const std::vector<unsigned char>& data, size_t topMipSize)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    static const char* fourCCs[] = { "DXT1", "ATI1", "ATI2" };
+    const char* fourCC = fourCCs[kind];
+
+    WriteU32(fp, 0x20534444);                           // "DDS "
+    WriteU32(fp, 124);                                  // header size
+    WriteU32(fp, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000); // caps, height, width, pixelformat, mipmapcount, linearsize
+    WriteU32(fp, mips[0].height);
+    WriteU32(fp, mips[0].width);
+    WriteU32(fp, (unsigned int)topMipSize);
+    WriteU32(fp, 0);                                    // depth
+    WriteU32(fp, (unsigned int)mips.size());
+    for (int i = 0; i < 11; ++i)
+    {
+        WriteU32(fp, 0);                                // reserved
+    }
+    WriteU32(fp, 32);                                   // pixel format size
+    WriteU32(fp, 0x4);                                  // DDPF_FOURCC
+    fwrite(fourCC, 1, 4, fp);
+    for (int i = 0; i < 5; ++i)
+    {
+        WriteU32(fp, 0);                                // bit count and masks
+    }
+    WriteU32(fp, 0x1000 | 0x400000 | 0x8);              // texture, mipmap, complex
+    for (int i = 0; i < 4; ++i)
+    {
+        WriteU32(fp, 0);                                // caps2-4, reserved
+    }
+
+    bool ok = fwrite(&data[0], 1, data.size(), fp) == data.size();
+    fclose(fp);
+
+    return ok;
+}
+
+//----------------------------------------------------------------------
+// report
+//----------------------------------------------------------------------
+
+// PSNR of the decoded top mip against the source. normal maps are
+// compared after rebuilding Z the way the shaders do.
+static double ComputePsnr(const MipLevel& source, const unsigned char* blocks, TextureKind kind)
+{
+    DdsFormat format = GetFormat(kind);
+
+    DdsSurface surface;
+    surface.width = source.width;
+    surface.height = source.height;
+    surface.blocksWide = (source.width + 3) / 4;
+    surface.blocksHigh = (source.height + 3) / 4;
+    surface.rowPitch = surface.blocksWide * GetBlockSize(format);
+    surface.data = blocks;
+    surface.size = (size_t)surface.rowPitch * surface.blocksHigh;
+
+    std::vector<unsigned char> decoded(source.width * source.height * 4);
+    DecodeDdsSurface(format, surface, &decoded[0], source.width * 4);
+
+    double sum = 0;
+    int count = 0;
+
+    for (int i = 0; i < source.width * source.height; ++i)
+    {
+        const unsigned char* s = &source.pixels[i * 4];
+        unsigned char* d = &decoded[i * 4];
+
+        if (kind == TEXTURE_NORMAL)
+        {
+            float x = d[2] / 127.5f - 1.0f;
+            float y = d[1] / 127.5f - 1.0f;
+            float zz = 1.0f - x * x - y * y;
+            d[0] = ToByte(sqrtf((zz > 0.0f) ? zz : 0.0f) * 0.5f + 0.5f);
+        }
+
+        int channels = (kind == TEXTURE_SPECULAR) ? 1 : 3;
+        for (int c = 0; c < channels; ++c)
+        {
+            int channel = (kind == TEXTURE_SPECULAR) ? 2 : c;
+            double diff = (double)s[channel] - d[channel];
+            sum += diff * diff;
+            ++count;
+        }
+    }
+
+    double mse = sum / count;
+    return (mse > 0) ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        printf("usage: TextureBaker <input.tga> <output.dds> <diffuse|specular|normal>\n");
+        return 1;
+    }
+
+    TextureKind kind;
+    if (strcmp(argv[3], "diffuse") == 0)
+    {
+        kind = TEXTURE_DIFFUSE;
+    }
+    else if (strcmp(argv[3], "specular") == 0)
+    {
+        kind = TEXTURE_SPECULAR;
+    }
+    else if (strcmp(argv[3], "normal") == 0)
+    {
+        kind = TEXTURE_NORMAL;
+    }
+    else
+    {
+        printf("unknown texture kind: %s\n", argv[3]);
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    size_t fileSize = 0;
+    unsigned char* file = ReadWholeFile(argv[1], &fileSize);
+    TgaInfo info;
+    if (!file || !ReadTgaHeader(file, fileSize, &info))
+    {
+        printf("failed at loading a texture: %s\n", argv[1]);
+        delete[] file;
+        return 1;
+    }
+
+    std::vector<MipLevel> mips(1);
+    mips[0].width = info.width;
+    mips[0].height = info.height;
+    mips[0].pixels.resize(info.width * info.height * 4);
+    bool decoded = DecodeTga(file, fileSize, info, &mips[0].pixels[0], info.width * 4);
+    delete[] file;
+
+    if (!decoded)
+    {
+        printf("failed at decoding a texture: %s\n", argv[1]);
+        return 1;
+    }
+
+    while ((mips.back().width > 1 || mips.back().height > 1) && mips.size() < MAX_MIPS)
+    {
+        mips.push_back(MipLevel());
+        Downsample(mips[mips.size() - 2], mips.back(), kind);
+    }
+
+    std::vector<unsigned char> data;
+    std::vector<size_t> offsets;
+    InitJobSystem(0);
+    EncodeMips(mips, kind, data, offsets);
+    ReleaseJobSystem();
+
+    size_t topMipSize = (mips.size() > 1) ? offsets[1] : data.size();
+    if (!WriteDds(argv[2], mips, kind, data, topMipSize))
+    {
+        printf("failed at writing: %s\n", argv[2]);
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // what the TGA costs once D3D expands it to X8R8G8B8 with mips
+    size_t uncompressedSize = 0;
+    for (size_t m = 0; m < mips.size(); ++m)
+    {
+        uncompressedSize += mips[m].width * mips[m].height * 4;
+    }
+
+    printf("%s -> %s (%s, %d mips, %.2f s)\n", argv[1], argv[2], (kind == TEXTURE_DIFFUSE) ? "BC1" :
+        ((kind == TEXTURE_SPECULAR) ? "BC4" : "BC5"), (int)mips.size(), seconds);
+    printf("  source file     %8u KB\n", (unsigned int)(fileSize / 1024));
+    printf("  GPU, 32bpp      %8u KB\n", (unsigned int)(uncompressedSize / 1024));
+    printf("  GPU, baked      %8u KB (%.1f%% saved)\n", (unsigned int)(data.size() / 1024),
+        100.0 * (1.0 - (double)data.size() / uncompressedSize));
+    printf("  PSNR            %8.2f dB\n", ComputePsnr(mips[0], &data[0], kind));
+
+    return 0;
+}